@@ -2352,6 +2352,7 @@ declare class TileMap extends Asset {
   static readonly Base64Zlib: unique symbol
   static readonly Base64Zstandard: unique symbol
   static readonly CSV: unique symbol
+  static readonly DeltaVLQ: unique symbol
 
   static readonly RightDown: unique symbol
   static readonly RightUp: unique symbol
@@ -2435,7 +2436,7 @@ declare class TileMap extends Asset {
   /**
    * The format in which the layer data is stored, taken into account by TMX, JSON and Lua map formats.
    */
-  layerDataFormat : typeof TileMap.XML | typeof TileMap.Base64 | typeof TileMap.Base64Gzip | typeof TileMap.Base64Zlib | typeof TileMap.Base64Zstandard | typeof TileMap.CSV
+  layerDataFormat : typeof TileMap.XML | typeof TileMap.Base64 | typeof TileMap.Base64Gzip | typeof TileMap.Base64Zlib | typeof TileMap.Base64Zstandard | typeof TileMap.CSV | typeof TileMap.DeltaVLQ
 
   /**
    * Number of top-level layers the map has.
@@ -2611,6 +2612,61 @@ declare class TileMap extends Asset {
    */
   public toImage(size?: size): Image;
 
+  /**
+   * Returns a read-only snapshot of this map.
+   *
+   * The snapshot is detached from the document, so it is unaffected by any
+   * edits made after it was taken. This is useful for long-running analysis
+   * scripts, which can take a snapshot and traverse it without worrying about
+   * the map changing under their feet. Since the tile layer data is
+   * copy-on-write, taking a snapshot is cheap even for large maps.
+   *
+   * @since 1.10
+   */
+  public snapshot(): TileMap;
+
+  /**
+   * Returns a detached copy of this map reduced to the given tile area.
+   *
+   * Tile layers are clipped to the area and objects outside of it are
+   * dropped, so writing the result with a map format stays fast regardless
+   * of the size of this map. Useful for exporting a small, playable part of
+   * a large map.
+   *
+   * @since 1.10
+   */
+  public clipped(tileArea: rect): TileMap;
+
+  /**
+   * Returns the sequence number that the next change to this map will get
+   * in the change journal. Pass it to {@link changesSince} later to
+   * retrieve only the changes made in between.
+   *
+   * Only maps open in the editor keep a journal; for detached maps 0 is
+   * returned.
+   *
+   * @since 1.10
+   */
+  public changeSequence(): number;
+
+  /**
+   * Returns the journal entries recorded since the given sequence number,
+   * oldest first. Each entry is an object with a `seq` number, a `type`
+   * string (like `region-edited`, `objects-changed` or `layer-added`) and
+   * type-specific details such as layer and object IDs or the edited
+   * rectangles.
+   *
+   * The journal is bounded: when the first returned entry has a higher
+   * sequence number than requested, changes were dropped and a full sync is
+   * needed.
+   *
+   * This allows external tooling to consume incremental updates instead of
+   * re-parsing full exports, by reading only the changed parts of the map.
+   *
+   * @since 1.10
+   */
+  public changesSince(sequence: number): object[];
+
   /**
    * Converts the given position from screen to tile coordinates.
    */
@@ -2808,6 +2864,35 @@ interface TileLayerEdit {
    */
   setTile(x : number, y : number, tile : Tile | null, flags? : number) : void
 
+  /**
+   * Sets all cells in the given area from {@link tiles}, a row-major array
+   * with one entry per cell. Entries can be `null` to erase cells.
+   *
+   * Like {@link setTile}, the changes are only staged until {@link apply} is
+   * called, but the array is decoded in a single native pass, which is much
+   * faster than calling {@link setTile} for each cell.
+   *
+   * @since 1.10
+   */
+  setTiles(rect : rect, tiles : (Tile | null)[]) : void
+
+  /**
+   * Applies packed cell values from {@link cells}, an `ArrayBuffer` as
+   * written through a `Uint32Array`, to the given area as a single undo
+   * command.
+   *
+   * The lower 28 bits of each value hold a tile ID from the given tileset,
+   * while any flip flags (see {@link setTile}) are shifted into the upper
+   * four bits (`flags * 0x10000000`). The value `0xFFFFFFFF` erases the
+   * cell.
+   *
+   * This is the fastest way to write large amounts of tiles from a script,
+   * since the buffer is decoded without any per-cell scripting overhead.
+   *
+   * @since 1.10
+   */
+  applyCells(rect : rect, cells : ArrayBuffer, tileset : Tileset) : void
+
   /**
    * Applies all changes made through this object. This object can be reused to make further changes.
    */
@@ -3936,6 +4021,46 @@ declare namespace tiled {
    */
   export function decompress(data: ArrayBuffer | string, method?: Tiled.CompressionMethod): ArrayBuffer;
 
+  /**
+   * Renders each map in `mapFiles` to the corresponding image file in
+   * `imageFiles`, using the same rendering as {@link TileMap.toImage}.
+   *
+   * The maps are read one at a time, sharing any external tilesets between
+   * them, while the rendering and image encoding run in parallel on a
+   * thread pool. The optional `rendered` callback is called once for each
+   * map, with the map file name and an error string that is empty on
+   * success. The optional `size` sets the size of the rendered images and
+   * defaults to the full size of each map.
+   *
+   * Only a single batch render can be in progress at a time.
+   *
+   * @example
+   * Example that renders all maps in a folder to PNG files:
+   * ```js
+   * const maps = File.directoryEntries(path).filter(f => f.endsWith(".tmx")).map(f => path + "/" + f);
+   * const images = maps.map(f => f.replace(/\.tmx$/, ".png"));
+   * tiled.renderMaps(maps, images, function (mapFile, error) {
+   *     if (error)
+   *         tiled.error(mapFile + ": " + error);
+   * });
+   * ```
+   *
+   * @since 1.10.1
+   */
+  export function renderMaps(mapFiles: string[], imageFiles: string[], rendered?: (mapFile: string, error: string) => void, size?: size): void;
+
+  /**
+   * Returns the number of times maps, layers and objects have been cloned
+   * since the application started.
+   *
+   * Useful for checking whether an operation copies more data than
+   * expected, by comparing the counters before and after triggering it
+   * from the console.
+   *
+   * @since 1.10.1
+   */
+  export function cloneStatistics(): { mapClones: number, layerClones: number, objectClones: number };
+
   /**
    * A new asset has been created.
    */
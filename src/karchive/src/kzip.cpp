@@ -382,6 +382,51 @@ static bool seekToNextHeaderToken(QIODevice *dev, bool dataDescriptor)
     return true;
 }
 
+/**
+ * Locates the central directory via the 'end of central directory' record,
+ * which sits at the very end of the file, optionally followed by an archive
+ * comment of up to 64K.
+ * @param dev random-access device to search in
+ * @return the offset of the first central directory record, or -1 when it
+ *         could not be determined (multi-volume or ZIP64 archives, or a
+ *         missing record)
+ */
+static qint64 findCentralDirectoryStart(QIODevice *dev)
+{
+    const qint64 fileSize = dev->size();
+    const qint64 maxScan = qMin(fileSize, qint64(22 + 65535));
+    if (maxScan < 22) {
+        return -1;
+    }
+
+    if (!dev->seek(fileSize - maxScan)) {
+        return -1;
+    }
+
+    const QByteArray tail = dev->read(maxScan);
+    const int pos = tail.lastIndexOf(QByteArray("PK\x05\x06", 4));
+    if (pos < 0 || pos + 22 > tail.size()) {
+        return -1;
+    }
+
+    const uchar *p = reinterpret_cast<const uchar *>(tail.constData()) + pos;
+
+    // the number of this disk must be 0, multi-volume archives are not supported
+    const uint diskNumber = uint(p[4]) | uint(p[5]) << 8;
+    if (diskNumber != 0) {
+        return -1;
+    }
+
+    // offset of the start of the central directory
+    const uint offset = uint(p[16]) | uint(p[17]) << 8 |
+                        uint(p[18]) << 16 | uint(p[19]) << 24;
+    if (offset == 0xFFFFFFFF) { // ZIP64, not supported here
+        return -1;
+    }
+
+    return qint64(offset);
+}
+
 ////////////////////////////////////////////////////////////////////////
 /////////////////////////// KZip ///////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
@@ -453,6 +498,30 @@ bool KZip::openArchive(QIODevice::OpenMode mode)
 
     QIODevice *dev = device();
 
+    // Try to jump straight to the central directory, which contains all the
+    // information needed to build the entries. This avoids reading through
+    // every local file header (and, for entries with a data descriptor, all
+    // of the compressed data), which dominates the time needed to open large
+    // archives. When the central directory cannot be located, for example
+    // for self-extracting or damaged files, fall back to the sequential scan.
+    bool skippedLocalHeaders = false;
+    if (!(mode & QIODevice::WriteOnly) && !dev->isSequential()) {
+        const qint64 centralDirStart = findCentralDirectoryStart(dev);
+        if (centralDirStart >= 0 && dev->seek(centralDirStart)) {
+            char signature[4];
+            if (dev->read(signature, 4) == 4
+                    && (!memcmp(signature, "PK\1\2", 4)      // first entry
+                        || !memcmp(signature, "PK\5\6", 4))  // empty archive
+                    && dev->seek(centralDirStart)) {
+                skippedLocalHeaders = true;
+            }
+        }
+        if (!skippedLocalHeaders && !dev->seek(0)) {
+            setErrorString(tr("Could not seek to beginning of file"));
+            return false;
+        }
+    }
+
     // We set a bool for knowing if we are allowed to skip the start of the file
     bool startOfFile = true;
 
@@ -676,6 +745,23 @@ bool KZip::openArchive(QIODevice::OpenMode mode)
             uint localheaderoffset = (uchar)buffer[45] << 24 | (uchar)buffer[44] << 16 |
                                      (uchar)buffer[43] << 8 | (uchar)buffer[42];
 
+            // When the local file headers were not scanned, the extra field
+            // length and the modification time are read from this entry's
+            // local header instead.
+            if (skippedLocalHeaders) {
+                char localBuffer[30];
+                if (!dev->seek(localheaderoffset)
+                        || dev->read(localBuffer, 30) < 30
+                        || memcmp(localBuffer, "PK\3\4", 4) != 0) {
+                    setErrorString(tr(
+                        "Invalid ZIP file. Broken local header at offset %1")
+                        .arg(localheaderoffset));
+                    return false;
+                }
+                pfi.mtime = transformFromMsDos(localBuffer + 10);
+                pfi.extralen = (uchar)localBuffer[29] << 8 | (uchar)localBuffer[28];
+            }
+
             // some clever people use different extra field lengths
             // in the central header and in the local header... funny.
             // so we need to get the localextralen to calculate the offset
@@ -736,6 +822,18 @@ bool KZip::openArchive(QIODevice::OpenMode mode)
                     //qCDebug(KArchiveLog) << "KArchiveDirectory created, entryName= " << entryName << ", name=" << name;
                 }
             } else {
+                // The symlink target is normally picked up while scanning
+                // the local headers; read it on demand when they were
+                // skipped.
+                if (skippedLocalHeaders
+                        && (access & QT_STAT_MASK) == QT_STAT_LNK
+                        && cmethod == NoCompression
+                        && qint64(ucsize) <= max_path_len && ucsize > 0) {
+                    if (dev->seek(dataoffset)) {
+                        pfi.guessed_symlink = dev->read(ucsize);
+                    }
+                }
+
                 QString symlink;
                 if ((access & QT_STAT_MASK) == QT_STAT_LNK) {
                     symlink = QFile::decodeName(pfi.guessed_symlink);
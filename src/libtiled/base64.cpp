@@ -0,0 +1,181 @@
+/*
+ * base64.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base64.h"
+
+namespace Tiled {
+
+static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+namespace {
+
+/**
+ * Maps every 12-bit group to its two base64 characters, so the encoder
+ * does two table lookups per three input bytes instead of four.
+ */
+struct EncodeTable
+{
+    char pairs[4096][2];
+
+    EncodeTable()
+    {
+        for (int i = 0; i < 4096; ++i) {
+            pairs[i][0] = alphabet[i >> 6];
+            pairs[i][1] = alphabet[i & 63];
+        }
+    }
+};
+
+/**
+ * Pre-shifted decode tables, one per character position within a group of
+ * four. A group decodes as d0[c0] | d1[c1] | d2[c2] | d3[c3], with the
+ * high bit acting as marker for characters outside of the alphabet.
+ */
+struct DecodeTable
+{
+    quint32 d0[256];
+    quint32 d1[256];
+    quint32 d2[256];
+    quint32 d3[256];
+
+    enum { Invalid = 0x80000000u };
+
+    DecodeTable()
+    {
+        for (int i = 0; i < 256; ++i)
+            d0[i] = d1[i] = d2[i] = d3[i] = Invalid;
+
+        for (quint32 i = 0; i < 64; ++i) {
+            const auto c = static_cast<unsigned char>(alphabet[i]);
+            d0[c] = i << 18;
+            d1[c] = i << 12;
+            d2[c] = i << 6;
+            d3[c] = i;
+        }
+    }
+};
+
+} // anonymous namespace
+
+QByteArray toBase64(const QByteArray &data)
+{
+    static const EncodeTable table;
+
+    const auto *src = reinterpret_cast<const unsigned char*>(data.constData());
+    const int srcLen = data.size();
+
+    QByteArray result((srcLen + 2) / 3 * 4, Qt::Uninitialized);
+    char *dst = result.data();
+
+    int i = 0;
+    for (; i + 3 <= srcLen; i += 3) {
+        const quint32 t = src[i] << 16 | src[i + 1] << 8 | src[i + 2];
+        dst[0] = table.pairs[t >> 12][0];
+        dst[1] = table.pairs[t >> 12][1];
+        dst[2] = table.pairs[t & 0xfff][0];
+        dst[3] = table.pairs[t & 0xfff][1];
+        dst += 4;
+    }
+
+    if (i < srcLen) {
+        const quint32 b0 = src[i];
+        const quint32 b1 = i + 1 < srcLen ? src[i + 1] : 0;
+        dst[0] = alphabet[b0 >> 2];
+        dst[1] = alphabet[(b0 & 0x03) << 4 | b1 >> 4];
+        dst[2] = i + 1 < srcLen ? alphabet[(b1 & 0x0f) << 2] : '=';
+        dst[3] = '=';
+    }
+
+    return result;
+}
+
+QByteArray fromBase64(const QByteArray &data)
+{
+    static const DecodeTable table;
+
+    const auto *src = reinterpret_cast<const unsigned char*>(data.constData());
+    const int srcLen = data.size();
+
+    // The fast path requires well-formed input. Whitespace or other
+    // characters outside of the alphabet bail out to the byte-wise but
+    // tolerant Qt implementation.
+    if (srcLen % 4 != 0)
+        return QByteArray::fromBase64(data);
+
+    QByteArray result(srcLen / 4 * 3, Qt::Uninitialized);
+    char *dst = result.data();
+
+    int i = 0;
+
+    // Decode all groups but the last, which may contain padding
+    for (; i + 4 < srcLen; i += 4) {
+        const quint32 t = table.d0[src[i]] | table.d1[src[i + 1]] |
+                          table.d2[src[i + 2]] | table.d3[src[i + 3]];
+        if (t & DecodeTable::Invalid)
+            return QByteArray::fromBase64(data);
+
+        dst[0] = static_cast<char>(t >> 16);
+        dst[1] = static_cast<char>(t >> 8);
+        dst[2] = static_cast<char>(t);
+        dst += 3;
+    }
+
+    if (i < srcLen) {
+        const quint32 c0 = table.d0[src[i]];
+        const quint32 c1 = table.d1[src[i + 1]];
+        if ((c0 | c1) & DecodeTable::Invalid)
+            return QByteArray::fromBase64(data);
+
+        if (src[i + 2] == '=') {
+            if (src[i + 3] != '=')
+                return QByteArray::fromBase64(data);
+            *dst++ = static_cast<char>((c0 | c1) >> 16);
+        } else if (src[i + 3] == '=') {
+            const quint32 c2 = table.d2[src[i + 2]];
+            if (c2 & DecodeTable::Invalid)
+                return QByteArray::fromBase64(data);
+            const quint32 t = c0 | c1 | c2;
+            *dst++ = static_cast<char>(t >> 16);
+            *dst++ = static_cast<char>(t >> 8);
+        } else {
+            const quint32 t = c0 | c1 | table.d2[src[i + 2]] |
+                              table.d3[src[i + 3]];
+            if (t & DecodeTable::Invalid)
+                return QByteArray::fromBase64(data);
+            *dst++ = static_cast<char>(t >> 16);
+            *dst++ = static_cast<char>(t >> 8);
+            *dst++ = static_cast<char>(t);
+        }
+    }
+
+    result.resize(static_cast<int>(dst - result.data()));
+    return result;
+}
+
+} // namespace Tiled
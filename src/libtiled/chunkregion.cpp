@@ -0,0 +1,125 @@
+/*
+ * chunkregion.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "chunkregion.h"
+
+namespace Tiled {
+
+static quint16 rowMask(int left, int right)
+{
+    return quint16(((1u << (right - left + 1)) - 1) << left);
+}
+
+void ChunkRegion::add(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    for (int cy = rect.top() >> CHUNK_BITS; cy <= rect.bottom() >> CHUNK_BITS; ++cy) {
+        for (int cx = rect.left() >> CHUNK_BITS; cx <= rect.right() >> CHUNK_BITS; ++cx) {
+            Chunk &chunk = mChunks[QPoint(cx, cy)];
+
+            const int left = qMax(rect.left() - cx * CHUNK_SIZE, 0);
+            const int right = qMin(rect.right() - cx * CHUNK_SIZE, CHUNK_SIZE - 1);
+            const int top = qMax(rect.top() - cy * CHUNK_SIZE, 0);
+            const int bottom = qMin(rect.bottom() - cy * CHUNK_SIZE, CHUNK_SIZE - 1);
+
+            const quint16 mask = rowMask(left, right);
+            for (int y = top; y <= bottom; ++y)
+                chunk.rows[y] |= mask;
+        }
+    }
+}
+
+bool ChunkRegion::intersects(const QRect &rect) const
+{
+    if (rect.isEmpty() || mChunks.isEmpty())
+        return false;
+
+    for (int cy = rect.top() >> CHUNK_BITS; cy <= rect.bottom() >> CHUNK_BITS; ++cy) {
+        for (int cx = rect.left() >> CHUNK_BITS; cx <= rect.right() >> CHUNK_BITS; ++cx) {
+            const auto it = mChunks.constFind(QPoint(cx, cy));
+            if (it == mChunks.constEnd())
+                continue;
+
+            const int left = qMax(rect.left() - cx * CHUNK_SIZE, 0);
+            const int right = qMin(rect.right() - cx * CHUNK_SIZE, CHUNK_SIZE - 1);
+            const int top = qMax(rect.top() - cy * CHUNK_SIZE, 0);
+            const int bottom = qMin(rect.bottom() - cy * CHUNK_SIZE, CHUNK_SIZE - 1);
+
+            const quint16 mask = rowMask(left, right);
+            for (int y = top; y <= bottom; ++y)
+                if (it->rows[y] & mask)
+                    return true;
+        }
+    }
+
+    return false;
+}
+
+ChunkRegion &ChunkRegion::operator|=(const ChunkRegion &other)
+{
+    for (auto it = other.mChunks.cbegin(); it != other.mChunks.cend(); ++it) {
+        Chunk &chunk = mChunks[it.key()];
+        for (int y = 0; y < CHUNK_SIZE; ++y)
+            chunk.rows[y] |= it->rows[y];
+    }
+    return *this;
+}
+
+QRegion ChunkRegion::toRegion() const
+{
+    QRegion region;
+
+    for (auto it = mChunks.cbegin(); it != mChunks.cend(); ++it) {
+        const int originX = it.key().x() * CHUNK_SIZE;
+        const int originY = it.key().y() * CHUNK_SIZE;
+
+        for (int y = 0; y < CHUNK_SIZE; ++y) {
+            quint16 row = it->rows[y];
+            int x = 0;
+
+            while (row) {
+                while (!(row & 1)) {
+                    row >>= 1;
+                    ++x;
+                }
+                const int start = x;
+                while (row & 1) {
+                    row >>= 1;
+                    ++x;
+                }
+                region += QRect(originX + start, originY + y, x - start, 1);
+            }
+        }
+    }
+
+    return region;
+}
+
+} // namespace Tiled
@@ -0,0 +1,104 @@
+/*
+ * chunkregion.h
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tilelayer.h"
+
+#include <QHash>
+#include <QPoint>
+#include <QRect>
+#include <QRegion>
+
+namespace Tiled {
+
+/**
+ * A set of tile positions, stored as a bitmap per CHUNK_SIZE x CHUNK_SIZE
+ * chunk.
+ *
+ * QRegion keeps a sorted list of rectangles, which makes repeatedly adding
+ * small rectangles in arbitrary order degrade quadratically. This class
+ * trades the compact rectangle representation for constant-time insertion
+ * and lookup, using the same chunked layout as TileLayer. It is meant for
+ * accumulating coverage in hot paths, with a single conversion back to
+ * QRegion at the end when needed.
+ */
+class TILEDSHARED_EXPORT ChunkRegion
+{
+public:
+    bool isEmpty() const { return mChunks.isEmpty(); }
+    void clear() { mChunks.clear(); }
+
+    void add(QPoint point);
+    void add(const QRect &rect);
+    void add(const QRegion &region);
+
+    bool contains(QPoint point) const;
+    bool intersects(const QRect &rect) const;
+    bool intersects(const QRegion &region) const;
+
+    ChunkRegion &operator|=(const ChunkRegion &other);
+
+    QRegion toRegion() const;
+
+private:
+    static_assert(CHUNK_SIZE <= 16, "chunk rows are stored as 16-bit masks");
+
+    struct Chunk
+    {
+        quint16 rows[CHUNK_SIZE] = {};
+    };
+
+    QHash<QPoint, Chunk> mChunks;
+};
+
+inline void ChunkRegion::add(QPoint point)
+{
+    add(QRect(point, point));
+}
+
+inline void ChunkRegion::add(const QRegion &region)
+{
+    for (const QRect &rect : region)
+        add(rect);
+}
+
+inline bool ChunkRegion::contains(QPoint point) const
+{
+    return intersects(QRect(point, point));
+}
+
+inline bool ChunkRegion::intersects(const QRegion &region) const
+{
+    for (const QRect &rect : region)
+        if (intersects(rect))
+            return true;
+    return false;
+}
+
+} // namespace Tiled
@@ -39,6 +39,7 @@
 
 #include <QByteArray>
 #include <QDebug>
+#include <QThread>
 
 #ifdef Z_PREFIX
 #undef compress
@@ -229,7 +230,23 @@ QByteArray Tiled::compress(const QByteArray &data,
         QByteArray out;
         out.resize(cBuffSize);
 
-        size_t const cSize = ZSTD_compress(out.data(), cBuffSize, data.constData(), data.size(), compressionLevel);
+        ZSTD_CCtx *cctx = ZSTD_createCCtx();
+        if (!cctx) {
+            qDebug() << "error compressing: failed to create ZSTD context";
+            return QByteArray();
+        }
+
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, compressionLevel);
+
+        // Compress large payloads block-parallel on all cores. Ignored when
+        // libzstd was built without multi-threading support.
+        if (data.size() >= 256 * 1024)
+            ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, QThread::idealThreadCount());
+
+        size_t const cSize = ZSTD_compress2(cctx, out.data(), cBuffSize,
+                                            data.constData(), data.size());
+        ZSTD_freeCCtx(cctx);
+
         if (ZSTD_isError(cSize)) {
             qDebug() << "error compressing:" << ZSTD_getErrorName(cSize);
             return QByteArray();
@@ -44,7 +44,15 @@ public:
         NoCapability    = 0x0,
         Read            = 0x1,
         Write           = 0x2,
-        ReadWrite       = Read | Write
+        ReadWrite       = Read | Write,
+
+        /**
+         * The format writes back editor-only data like the export target
+         * settings of a map or tileset. Exporting to such a format requires
+         * those settings to be stripped from a copy first, whereas other
+         * formats can write straight from the live document.
+         */
+        PreservesExportTarget = 0x4
     };
     Q_DECLARE_FLAGS(Capabilities, Capability)
 
@@ -28,20 +28,96 @@
 
 #include "filesystemwatcher.h"
 
+#include <QDateTime>
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
 #include <QFileSystemWatcher>
+#include <QHash>
 #include <QStringList>
 
 namespace Tiled {
 
+/**
+ * Stats reported paths on a worker thread, so that checking a big batch of
+ * changes doesn't block the UI, and filters out events for paths whose
+ * modification time and size did not change since they were last reported.
+ */
+class PathVerifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    void verify(const QStringList &paths);
+    void forget(const QStringList &paths);
+    void clear();
+
+signals:
+    void verified(const QStringList &changedPaths,
+                  const QStringList &existingPaths);
+
+private:
+    struct State
+    {
+        QDateTime lastModified;
+        qint64 size = -1;
+    };
+
+    QHash<QString, State> mStates;
+};
+
+void PathVerifier::verify(const QStringList &paths)
+{
+    QStringList changedPaths;
+    QStringList existingPaths;
+
+    for (const QString &path : paths) {
+        const QFileInfo info(path);
+        if (info.exists())
+            existingPaths.append(path);
+
+        const State state { info.lastModified(),
+                            info.isDir() ? -1 : info.size() };
+
+        auto it = mStates.find(path);
+        if (it == mStates.end()) {
+            mStates.insert(path, state);
+            changedPaths.append(path);
+        } else if (it->lastModified != state.lastModified || it->size != state.size) {
+            *it = state;
+            changedPaths.append(path);
+        }
+    }
+
+    emit verified(changedPaths, existingPaths);
+}
+
+void PathVerifier::forget(const QStringList &paths)
+{
+    for (const QString &path : paths)
+        mStates.remove(path);
+}
+
+void PathVerifier::clear()
+{
+    mStates.clear();
+}
+
+
 FileSystemWatcher::FileSystemWatcher(QObject *parent) :
     QObject(parent),
-    mWatcher(new QFileSystemWatcher(this))
+    mWatcher(new QFileSystemWatcher(this)),
+    mVerifier(new PathVerifier)
 {
     mChangedPathsTimer.setInterval(500);
     mChangedPathsTimer.setSingleShot(true);
 
+    mVerifier->moveToThread(&mVerifierThread);
+    connect(&mVerifierThread, &QThread::finished, mVerifier, &QObject::deleteLater);
+    connect(mVerifier, &PathVerifier::verified,
+            this, &FileSystemWatcher::pathsVerified);
+    mVerifierThread.start();
+
     connect(mWatcher, &QFileSystemWatcher::fileChanged,
             this, &FileSystemWatcher::onFileChanged);
     connect(mWatcher, &QFileSystemWatcher::directoryChanged,
@@ -51,6 +127,12 @@ FileSystemWatcher::FileSystemWatcher(QObject *parent) :
             this, &FileSystemWatcher::pathsChangedTimeout);
 }
 
+FileSystemWatcher::~FileSystemWatcher()
+{
+    mVerifierThread.quit();
+    mVerifierThread.wait();
+}
+
 void FileSystemWatcher::addPaths(const QStringList &paths)
 {
     QStringList pathsToAdd;
@@ -97,8 +179,13 @@ void FileSystemWatcher::removePaths(const QStringList &paths)
         }
     }
 
-    if (!pathsToRemove.isEmpty())
+    if (!pathsToRemove.isEmpty()) {
         mWatcher->removePaths(pathsToRemove);
+
+        QMetaObject::invokeMethod(mVerifier, [verifier = mVerifier, pathsToRemove] {
+            verifier->forget(pathsToRemove);
+        });
+    }
 }
 
 void FileSystemWatcher::clear()
@@ -112,6 +199,10 @@ void FileSystemWatcher::clear()
         mWatcher->removePaths(directories);
 
     mWatchCount.clear();
+
+    QMetaObject::invokeMethod(mVerifier, [verifier = mVerifier] {
+        verifier->clear();
+    });
 }
 
 void FileSystemWatcher::onFileChanged(const QString &path)
@@ -132,24 +223,40 @@ void FileSystemWatcher::onDirectoryChanged(const QString &path)
 
 void FileSystemWatcher::pathsChangedTimeout()
 {
-    const auto changedPaths = mChangedPaths.values();
+    const QStringList changedPaths = mChangedPaths.values();
+    mChangedPaths.clear();
 
-    // If the file was replaced, the watcher is automatically removed and needs
+    QMetaObject::invokeMethod(mVerifier, [verifier = mVerifier, changedPaths] {
+        verifier->verify(changedPaths);
+    });
+}
+
+void FileSystemWatcher::pathsVerified(const QStringList &changedPaths,
+                                      const QStringList &existingPaths)
+{
+    // If a file was replaced, the watcher is automatically removed and needs
     // to be re-added to keep watching it for changes. This happens commonly
     // with applications that do atomic saving.
-    for (const QString &path : changedPaths) {
-        if (mWatchCount.contains(path) && !mWatcher->files().contains(path)) {
-            if (QFile::exists(path))
-                mWatcher->addPath(path);
-        }
-    }
+    const QStringList files = mWatcher->files();
+#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
+    const QSet<QString> watchedFiles = files.toSet();
+#else
+    const auto watchedFiles = QSet<QString>(files.begin(), files.end());
+#endif
 
+    QStringList pathsToAddBack;
+    for (const QString &path : existingPaths)
+        if (mWatchCount.contains(path) && !watchedFiles.contains(path))
+            pathsToAddBack.append(path);
 
-    emit pathsChanged(changedPaths);
+    if (!pathsToAddBack.isEmpty())
+        mWatcher->addPaths(pathsToAddBack);
 
-    mChangedPaths.clear();
+    if (!changedPaths.isEmpty())
+        emit pathsChanged(changedPaths);
 }
 
 } // namespace Tiled
 
+#include "filesystemwatcher.moc"
 #include "moc_filesystemwatcher.cpp"
@@ -33,12 +33,15 @@
 #include <QMap>
 #include <QObject>
 #include <QSet>
+#include <QThread>
 #include <QTimer>
 
 class QFileSystemWatcher;
 
 namespace Tiled {
 
+class PathVerifier;
+
 /**
  * A wrapper around QFileSystemWatcher that deals gracefully with files being
  * watched multiple times. It also doesn't start complaining when a file
@@ -48,7 +51,10 @@ namespace Tiled {
  *
  * Optionally, the 'pathsChanged' signal can be used, which triggers at a delay
  * to avoid problems occurring when trying to reload only partially written
- * files, as well as avoiding fast consecutive reloads.
+ * files, as well as avoiding fast consecutive reloads. Reported paths are
+ * checked on a worker thread and events that did not change a file's
+ * modification time or size are filtered out, so mass asset refreshes don't
+ * block the UI with spurious reloads.
  */
 class TILEDSHARED_EXPORT FileSystemWatcher : public QObject
 {
@@ -56,6 +62,7 @@ class TILEDSHARED_EXPORT FileSystemWatcher : public QObject
 
 public:
     explicit FileSystemWatcher(QObject *parent = nullptr);
+    ~FileSystemWatcher() override;
 
     void addPath(const QString &path);
     void addPaths(const QStringList &paths);
@@ -79,12 +86,17 @@ private:
     void onFileChanged(const QString &path);
     void onDirectoryChanged(const QString &path);
     void pathsChangedTimeout();
+    void pathsVerified(const QStringList &changedPaths,
+                       const QStringList &existingPaths);
 
     QFileSystemWatcher *mWatcher;
     QMap<QString, int> mWatchCount;
 
     QSet<QString> mChangedPaths;
     QTimer mChangedPathsTimer;
+
+    PathVerifier *mVerifier;
+    QThread mVerifierThread;
 };
 
 inline void FileSystemWatcher::addPath(const QString &path)
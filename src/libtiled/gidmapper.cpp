@@ -28,12 +28,19 @@
 
 #include "gidmapper.h"
 
+#include "base64.h"
 #include "compression.h"
 #include "tile.h"
 #include "tiled.h"
 #include "tileset.h"
 
+#include <QCache>
+#include <QCryptographicHash>
+#include <QMutex>
+#include <QtEndian>
+
 #include <algorithm>
+#include <limits>
 
 using namespace Tiled;
 
@@ -88,6 +95,18 @@ Cell GidMapper::gidToCell(unsigned gid, bool &ok) const
 
     if (gid == 0) {
         ok = true;
+    } else if (gid >= mCachedFirstGid && gid < mCachedGidLimit) {
+        // Fast path for the common case of the previous cell referring to
+        // the same tileset, avoiding the binary search.
+        const int tileId = gid - mCachedFirstGid;
+        Tileset * const tileset = mCachedTileset;
+
+        result.setTile(tileset, tileId);
+        ok = true;
+
+        // Adjust the next tile ID, in order to preserve tile references
+        // even to tilesets that failed to load.
+        tileset->setNextTileId(std::max(tileset->nextTileId(), tileId + 1));
     } else if (isEmpty()) {
         ok = false;
     } else {
@@ -97,10 +116,16 @@ Cell GidMapper::gidToCell(unsigned gid, bool &ok) const
             // Invalid global tile ID, since it lies before the first tileset
             ok = false;
         } else {
+            mCachedGidLimit = (i == mFirstGidToTileset.constEnd())
+                    ? std::numeric_limits<unsigned>::max() : i.key();
+
             --i; // Navigate one tileset back since upper bound finds the next
             int tileId = gid - i.key();
             const SharedTileset &tileset = i.value();
 
+            mCachedFirstGid = i.key();
+            mCachedTileset = tileset.data();
+
             result.setTile(tileset.data(), tileId);
             ok = true;
 
@@ -122,18 +147,12 @@ unsigned GidMapper::cellToGid(const Cell &cell) const
     if (cell.isEmpty())
         return 0;
 
-    const Tileset *tileset = cell.tileset();
-
-    // Find the first GID for the tileset
-    QMap<unsigned, SharedTileset>::const_iterator i = mFirstGidToTileset.begin();
-    QMap<unsigned, SharedTileset>::const_iterator i_end = mFirstGidToTileset.end();
-    while (i != i_end && i.value() != tileset)
-        ++i;
-
-    if (i == i_end) // tileset not found
+    // Find the first GID for the tileset (always at least 1 when known)
+    const unsigned firstGid = mTilesetToFirstGid.value(cell.tileset());
+    if (firstGid == 0) // tileset not found
         return 0;
 
-    unsigned gid = i.key() + cell.tileId();
+    unsigned gid = firstGid + cell.tileId();
     if (cell.flippedHorizontally())
         gid |= FlippedHorizontallyFlag;
     if (cell.flippedVertically())
@@ -146,6 +165,26 @@ unsigned GidMapper::cellToGid(const Cell &cell) const
     return gid;
 }
 
+// Compressing a chunk is far more expensive than hashing it, and most chunks
+// are unchanged from one save to the next. The compressed and base64-encoded
+// bytes are therefore kept in a content-addressed cache, so that repeatedly
+// saving a mostly unchanged map only compresses the edited chunks. Since the
+// GID buffer is hashed after the tileset mapping is applied, a cache hit
+// yields exactly the bytes that would have been produced.
+static QMutex encodedChunkCacheMutex;
+static QCache<QByteArray, QByteArray> encodedChunkCache(16 * 1024 * 1024);
+
+static QByteArray encodedChunkCacheKey(const QByteArray &tileData,
+                                       Map::LayerDataFormat format,
+                                       int compressionLevel)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(tileData);
+    const char tail[2] = { char(format), char(compressionLevel) };
+    hash.addData(tail, 2);
+    return hash.result();
+}
+
 /**
  * Encodes the tile layer data of the given \a tileLayer in the given
  * \a format. This function should only be used for base64 encoding, with or
@@ -157,23 +196,41 @@ QByteArray GidMapper::encodeLayerData(const TileLayer &tileLayer,
 {
     Q_ASSERT(format != Map::XML);
     Q_ASSERT(format != Map::CSV);
+    Q_ASSERT(format != Map::DeltaVLQ);
 
     if (bounds.isEmpty())
         bounds = QRect(0, 0, tileLayer.width(), tileLayer.height());
 
-    QByteArray tileData;
-    tileData.reserve(bounds.width() * bounds.height() * 4);
+    QByteArray tileData(bounds.width() * bounds.height() * 4, Qt::Uninitialized);
+    quint32 *out = reinterpret_cast<quint32*>(tileData.data());
+
+    // The reverse mapping scans the tileset list, so runs of the same cell
+    // reuse the GID of the previous one
+    Cell previousCell;
+    unsigned previousGid = 0;
 
     for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
         for (int x = bounds.left(); x <= bounds.right(); ++x) {
-            const unsigned gid = cellToGid(tileLayer.cellAt(x, y));
-            tileData.append(static_cast<char>(gid));
-            tileData.append(static_cast<char>(gid >> 8));
-            tileData.append(static_cast<char>(gid >> 16));
-            tileData.append(static_cast<char>(gid >> 24));
+            const Cell &cell = tileLayer.cellAt(x, y);
+            if (cell != previousCell) {
+                previousGid = cellToGid(cell);
+                previousCell = cell;
+            }
+            *out++ = qToLittleEndian(quint32(previousGid));
         }
     }
 
+    if (format == Map::Base64)
+        return Tiled::toBase64(tileData);
+
+    const QByteArray cacheKey = encodedChunkCacheKey(tileData, format,
+                                                     compressionLevel);
+    {
+        QMutexLocker locker(&encodedChunkCacheMutex);
+        if (const QByteArray *cached = encodedChunkCache.object(cacheKey))
+            return *cached;
+    }
+
     if (format == Map::Base64Gzip)
         tileData = compress(tileData, Gzip, compressionLevel);
     else if (format == Map::Base64Zlib)
@@ -181,7 +238,12 @@ QByteArray GidMapper::encodeLayerData(const TileLayer &tileLayer,
     else if (format == Map::Base64Zstandard)
         tileData = compress(tileData, Zstandard, compressionLevel);
 
-    return tileData.toBase64();
+    QByteArray encoded = Tiled::toBase64(tileData);
+
+    QMutexLocker locker(&encodedChunkCacheMutex);
+    encodedChunkCache.insert(cacheKey, new QByteArray(encoded),
+                             encoded.size());
+    return encoded;
 }
 
 GidMapper::DecodeError GidMapper::decodeLayerData(TileLayer &tileLayer,
@@ -191,8 +253,9 @@ GidMapper::DecodeError GidMapper::decodeLayerData(TileLayer &tileLayer,
 {
     Q_ASSERT(format != Map::XML);
     Q_ASSERT(format != Map::CSV);
+    Q_ASSERT(format != Map::DeltaVLQ);
 
-    QByteArray decodedData = QByteArray::fromBase64(layerData);
+    QByteArray decodedData = Tiled::fromBase64(layerData);
     const int size = bounds.width() * bounds.height() * 4;
 
     if (format == Map::Base64Gzip)
@@ -205,24 +268,37 @@ GidMapper::DecodeError GidMapper::decodeLayerData(TileLayer &tileLayer,
     if (size != decodedData.length())
         return CorruptLayerData;
 
-    const unsigned char *data = reinterpret_cast<const unsigned char*>(decodedData.constData());
+    // Byte-order conversion done in bulk over the whole buffer instead of
+    // per GID; on little-endian hosts it compiles down to nothing
+    quint32 *gids = reinterpret_cast<quint32*>(decodedData.data());
+    const int count = size / 4;
+    qFromLittleEndian<quint32>(gids, count, gids);
+
     int x = bounds.x();
     int y = bounds.y();
     bool ok;
 
-    for (int i = 0; i < size - 3; i += 4) {
-        const unsigned gid = data[i] |
-                             data[i + 1] << 8 |
-                             data[i + 2] << 16 |
-                             data[i + 3] << 24;
-
-        const Cell result = gidToCell(gid, ok);
-        if (!ok) {
-            mInvalidTile = gid;
-            return isEmpty() ? TileButNoTilesets : InvalidTile;
+    // Tile layers tend to contain long runs of the same GID, so the
+    // conversion of the previous GID is reused whenever it repeats. The
+    // cells are written through a CellWriter, which resolves the target
+    // chunk once per run of positions instead of once per cell.
+    TileLayer::CellWriter writer(tileLayer);
+    quint32 previousGid = 0;
+    Cell previousCell;
+
+    for (int i = 0; i < count; ++i) {
+        const quint32 gid = gids[i];
+
+        if (gid != previousGid) {
+            previousCell = gidToCell(gid, ok);
+            if (!ok) {
+                mInvalidTile = gid;
+                return isEmpty() ? TileButNoTilesets : InvalidTile;
+            }
+            previousGid = gid;
         }
 
-        tileLayer.setCell(x, y, result);
+        writer.setCell(x, y, previousCell);
 
         x++;
         if (x > bounds.right()) {
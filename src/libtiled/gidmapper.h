@@ -31,6 +31,7 @@
 #include "map.h"
 #include "tilelayer.h"
 
+#include <QHash>
 #include <QMap>
 
 namespace Tiled {
@@ -73,6 +74,16 @@ public:
 private:
     QMap<unsigned, SharedTileset> mFirstGidToTileset;
 
+    // Reverse index so that cellToGid doesn't have to scan the tileset list
+    // for every distinct cell
+    QHash<const Tileset*, unsigned> mTilesetToFirstGid;
+
+    // Caches the range matched by the last gidToCell call, since long runs
+    // of tiles from the same tileset are the common case.
+    mutable unsigned mCachedFirstGid = 1;
+    mutable unsigned mCachedGidLimit = 0;
+    mutable Tileset *mCachedTileset = nullptr;
+
     mutable unsigned mInvalidTile = 0;
 };
 
@@ -83,6 +94,8 @@ private:
 inline void GidMapper::insert(unsigned firstGid, const SharedTileset &tileset)
 {
     mFirstGidToTileset.insert(firstGid, tileset);
+    mTilesetToFirstGid.insert(tileset.data(), firstGid);
+    mCachedGidLimit = 0;
 }
 
 /**
@@ -91,6 +104,8 @@ inline void GidMapper::insert(unsigned firstGid, const SharedTileset &tileset)
 inline void GidMapper::clear()
 {
     mFirstGidToTileset.clear();
+    mTilesetToFirstGid.clear();
+    mCachedGidLimit = 0;
 }
 
 /**
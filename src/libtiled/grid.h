@@ -30,18 +30,23 @@
 
 #include "tiled_global.h"
 
-#include <QHash>
 #include <QPoint>
 #include <QRect>
+#include <QVector>
+
+#include <utility>
+#include <vector>
 
 namespace Tiled {
 
 /**
  * An infinite grid of values.
  *
- * The values are stored in chunks that are allocated on-demand. The idea is to
- * be more efficient than a simple QHash<QPoint, T> due to the memory-locality
- * of neighboring values.
+ * The values are stored in chunks that are allocated on-demand. The chunks
+ * themselves are kept in an open-addressing hash table with linear probing,
+ * so a chunk lookup touches a single flat array instead of chasing
+ * node-based hash buckets. The most recently accessed chunk is remembered,
+ * which makes runs of nearby lookups resolve without probing at all.
  */
 template <typename T, int CHUNK_BITS = 4>
 class Grid
@@ -129,8 +134,8 @@ public:
      */
     bool isEmpty() const
     {
-        for (const Chunk &chunk : mChunks)
-            if (!chunk.isEmpty())
+        for (const Bucket &bucket : mBuckets)
+            if (bucket.used && !bucket.chunk.isEmpty())
                 return false;
 
         return true;
@@ -142,30 +147,105 @@ public:
     QRect bounds() const
     {
         QRect bounds;
-        for (auto it = mChunks.keyBegin(); it != mChunks.keyEnd(); ++it)
-            bounds |= QRect(it->x(), it->y(), CHUNK_SIZE, CHUNK_SIZE);
+        for (const Bucket &bucket : mBuckets)
+            if (bucket.used)
+                bounds |= QRect(bucket.key.x(), bucket.key.y(), CHUNK_SIZE, CHUNK_SIZE);
         return bounds;
     }
 
 private:
+    struct Bucket
+    {
+        QPoint key;
+        Chunk chunk;
+        bool used = false;
+    };
+
+    static size_t hashKey(QPoint key)
+    {
+        uint h = uint(key.x()) * 0x9E3779B9u + uint(key.y()) * 0x85EBCA6Bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    /**
+     * Returns the chunk at the given coordinates, inserting it first. Only
+     * called when the chunk is known to be absent.
+     */
     Chunk &chunk(int x, int y)
     {
-        return mChunks[QPoint(x >> CHUNK_BITS, y >> CHUNK_BITS)];
+        // Grow when the table would get more than two thirds full, keeping
+        // probe sequences short.
+        if ((mCount + 1) * 3 > mBuckets.size() * 2)
+            rehash(mBuckets.empty() ? 16 : mBuckets.size() * 2);
+
+        const QPoint key(x >> CHUNK_BITS, y >> CHUNK_BITS);
+        const size_t mask = mBuckets.size() - 1;
+        size_t index = hashKey(key) & mask;
+
+        while (mBuckets[index].used)
+            index = (index + 1) & mask;
+
+        Bucket &bucket = mBuckets[index];
+        bucket.key = key;
+        bucket.used = true;
+        ++mCount;
+        mLastBucket = index;
+        return bucket.chunk;
     }
 
     Chunk *findChunk(int x, int y)
     {
-        auto it = mChunks.find(QPoint(x >> CHUNK_BITS, y >> CHUNK_BITS));
-        return it != mChunks.end() ? &it.value() : nullptr;
+        return const_cast<Chunk*>(std::as_const(*this).findChunk(x, y));
     }
 
     const Chunk *findChunk(int x, int y) const
     {
-        auto it = mChunks.find(QPoint(x >> CHUNK_BITS, y >> CHUNK_BITS));
-        return it != mChunks.end() ? &it.value() : nullptr;
+        if (mBuckets.empty())
+            return nullptr;
+
+        const QPoint key(x >> CHUNK_BITS, y >> CHUNK_BITS);
+
+        const Bucket &last = mBuckets[mLastBucket];
+        if (last.used && last.key == key)
+            return &last.chunk;
+
+        const size_t mask = mBuckets.size() - 1;
+        size_t index = hashKey(key) & mask;
+
+        while (mBuckets[index].used) {
+            if (mBuckets[index].key == key) {
+                mLastBucket = index;
+                return &mBuckets[index].chunk;
+            }
+            index = (index + 1) & mask;
+        }
+
+        return nullptr;
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<Bucket> oldBuckets(capacity);
+        mBuckets.swap(oldBuckets);
+        mLastBucket = 0;
+
+        const size_t mask = capacity - 1;
+        for (Bucket &bucket : oldBuckets) {
+            if (!bucket.used)
+                continue;
+
+            size_t index = hashKey(bucket.key) & mask;
+            while (mBuckets[index].used)
+                index = (index + 1) & mask;
+
+            mBuckets[index] = std::move(bucket);
+        }
     }
 
-    QHash<QPoint, Chunk> mChunks;
+    std::vector<Bucket> mBuckets;
+    size_t mCount = 0;
+    mutable size_t mLastBucket = 0;
 };
 
 } // namespace Tiled
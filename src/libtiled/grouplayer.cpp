@@ -92,7 +92,8 @@ void GroupLayer::replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTil
 {
     const auto &children = mLayers;
     for (Layer *layer : children)
-        layer->replaceReferencesToTileset(oldTileset, newTileset);
+        if (layer->referencesTileset(oldTileset))
+            layer->replaceReferencesToTileset(oldTileset, newTileset);
 }
 
 bool GroupLayer::canMergeWith(const Layer *) const
@@ -126,6 +127,14 @@ void GroupLayer::setMap(Map *map)
     }
 }
 
+void GroupLayer::invalidateResolvedTransform()
+{
+    Layer::invalidateResolvedTransform();
+
+    for (Layer *layer : std::as_const(mLayers))
+        layer->invalidateResolvedTransform();
+}
+
 GroupLayer *GroupLayer::initializeClone(GroupLayer *clone) const
 {
     Layer::initializeClone(clone);
@@ -58,6 +58,7 @@ public:
 
 protected:
     void setMap(Map *map) override;
+    void invalidateResolvedTransform() override;
     GroupLayer *initializeClone(GroupLayer *clone) const;
 
 private:
@@ -28,6 +28,8 @@
 
 #include "hexagonalrenderer.h"
 
+#include "maprenderer_p.h"
+
 #include "map.h"
 
 #include <QVarLengthArray>
@@ -38,6 +40,19 @@
 
 using namespace Tiled;
 
+static constexpr QPoint offsetsStaggerX[4] = {
+    QPoint( 0,  0),
+    QPoint(+1, -1),
+    QPoint(+1,  0),
+    QPoint(+2,  0),
+};
+static constexpr QPoint offsetsStaggerY[4] = {
+    QPoint( 0,  0),
+    QPoint(-1, +1),
+    QPoint( 0, +1),
+    QPoint( 0, +2),
+};
+
 HexagonalRenderer::RenderParams::RenderParams(const Map *map)
     : tileWidth(map->tileWidth() & ~1)
     , tileHeight(map->tileHeight() & ~1)
@@ -58,13 +73,42 @@ HexagonalRenderer::RenderParams::RenderParams(const Map *map)
 
     columnWidth = sideOffsetX + sideLengthX;
     rowHeight = sideOffsetY + sideLengthY;
+
+    if (columnWidth > 0)
+        invColumnWidth2 = 1.0 / (columnWidth * 2);
+    if (rowHeight > 0)
+        invRowHeight2 = 1.0 / (rowHeight * 2);
+
+    if (staggerX) {
+        const int left = sideLengthX / 2;
+        const int centerX = left + columnWidth;
+        const int centerY = tileHeight / 2;
+
+        centers[0] = QVector2D(left,                  centerY);
+        centers[1] = QVector2D(centerX,               centerY - rowHeight);
+        centers[2] = QVector2D(centerX,               centerY + rowHeight);
+        centers[3] = QVector2D(centerX + columnWidth, centerY);
+
+        neighborOffsets = offsetsStaggerX;
+    } else {
+        const int top = sideLengthY / 2;
+        const int centerX = tileWidth / 2;
+        const int centerY = top + rowHeight;
+
+        centers[0] = QVector2D(centerX,               top);
+        centers[1] = QVector2D(centerX - columnWidth, centerY);
+        centers[2] = QVector2D(centerX + columnWidth, centerY);
+        centers[3] = QVector2D(centerX,               centerY + rowHeight);
+
+        neighborOffsets = offsetsStaggerY;
+    }
 }
 
 QRect HexagonalRenderer::boundingRect(const QRect &rect) const
 {
     const RenderParams p(map());
 
-    QPoint topLeft = tileToScreenCoords(rect.topLeft()).toPoint();
+    QPoint topLeft = tileToScreenCoords(p, rect.x(), rect.y()).toPoint();
     int width, height;
 
     if (p.staggerX) {
@@ -104,7 +148,7 @@ void HexagonalRenderer::drawGrid(QPainter *painter, const QRectF &exposed,
 
     // Determine the tile and pixel coordinates to start at
     QPoint startTile = screenToTileCoords(rect.topLeft()).toPoint();
-    QPoint startPos = tileToScreenCoords(startTile).toPoint();
+    QPoint startPos = tileToScreenCoords(p, startTile.x(), startTile.y()).toPoint();
 
     /* Determine in which half of the tile the top-left corner of the area we
      * need to draw is. If we're in the upper half, we need to start one row
@@ -124,7 +168,7 @@ void HexagonalRenderer::drawGrid(QPainter *painter, const QRectF &exposed,
         startTile.setY(qMax(0, startTile.y()));
     }
 
-    startPos = tileToScreenCoords(startTile).toPoint();
+    startPos = tileToScreenCoords(p, startTile.x(), startTile.y()).toPoint();
 
     const QPoint oct[5] = {
         QPoint(0,                           p.tileHeight - p.sideOffsetY),
@@ -270,8 +314,10 @@ void HexagonalRenderer::drawGrid(QPainter *painter, const QRectF &exposed,
 
 QPointF HexagonalRenderer::snapToGrid(const QPointF &pixelCoords, int subdivisions) const
 {
-    const QPoint tileCoords = pixelToTileCoords(pixelCoords).toPoint();
-    QPolygonF hex = tileToScreenPolygon(tileCoords);
+    const RenderParams p(map());
+    const QPoint tileCoords = screenToTileCoords(p, pixelCoords.x(),
+                                                 pixelCoords.y()).toPoint();
+    QPolygonF hex = tileToScreenPolygon(p, tileCoords.x(), tileCoords.y());
 
     if (subdivisions > 1) {
         const QPointF center = (hex[0] + hex[4]) / 2;
@@ -293,14 +339,30 @@ QPointF HexagonalRenderer::snapToGrid(const QPointF &pixelCoords, int subdivisio
     return nearest;
 }
 
+void HexagonalRenderer::drawTileLayer(QPainter *painter, const TileLayer *layer,
+                                      const QRectF &exposed) const
+{
+    renderTileLayer(*this, painter, layer, exposed,
+                    [this] (const auto &renderTile, const QRectF &rect) {
+        drawTileLayerImpl(renderTile, rect);
+    });
+}
+
 void HexagonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
                                       const QRectF &exposed) const
+{
+    drawTileLayerImpl(renderTile, exposed);
+}
+
+template <typename RenderTile>
+void HexagonalRenderer::drawTileLayerImpl(RenderTile renderTile,
+                                          const QRectF &exposed) const
 {
     const RenderParams p(map());
 
     // Determine the tile and pixel coordinates to start at
     QPoint startTile = screenToTileCoords(exposed.topLeft()).toPoint();
-    QPoint startPos = tileToScreenCoords(startTile).toPoint();
+    QPoint startPos = tileToScreenCoords(p, startTile.x(), startTile.y()).toPoint();
 
     /* Determine in which half of the tile the top-left corner of the area we
      * need to draw is. If we're in the upper half, we need to start one row
@@ -316,7 +378,7 @@ void HexagonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
         startTile.rx()--;
 
     if (p.staggerX) {
-        startPos = tileToScreenCoords(startTile).toPoint();
+        startPos = tileToScreenCoords(p, startTile.x(), startTile.y()).toPoint();
         startPos.ry() += p.tileHeight;
 
         bool staggeredRow = p.doStaggerX(startTile.x());
@@ -345,7 +407,7 @@ void HexagonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
             startPos.ry() += p.rowHeight;
         }
     } else {
-        startPos = tileToScreenCoords(startTile).toPoint();
+        startPos = tileToScreenCoords(p, startTile.x(), startTile.y()).toPoint();
         startPos.ry() += p.tileHeight;
 
         // Odd row shifting is applied in the rendering loop, so un-apply it here
@@ -376,11 +438,12 @@ void HexagonalRenderer::drawTileSelection(QPainter *painter,
                                           const QRectF &exposed) const
 {
     QPainterPath path;
+    const RenderParams p(map());
 
     for (const QRect &r : region) {
         for (int y = r.top(); y <= r.bottom(); ++y) {
             for (int x = r.left(); x <= r.right(); ++x) {
-                const QPolygonF polygon = tileToScreenPolygon(x, y);
+                const QPolygonF polygon = tileToScreenPolygon(p, x, y);
                 if (QRectF(polygon.boundingRect()).intersects(exposed))
                     path.addPolygon(polygon);
             }
@@ -415,16 +478,20 @@ QPointF HexagonalRenderer::pixelToTileCoords(qreal x, qreal y) const
  */
 QPointF HexagonalRenderer::screenToTileCoords(qreal x, qreal y) const
 {
-    const RenderParams p(map());
+    return screenToTileCoords(RenderParams(map()), x, y);
+}
 
+QPointF HexagonalRenderer::screenToTileCoords(const RenderParams &p,
+                                              qreal x, qreal y)
+{
     if (p.staggerX)
         x -= p.staggerEven ? p.tileWidth : p.sideOffsetX;
     else
         y -= p.staggerEven ? p.tileHeight : p.sideOffsetY;
 
     // Start with the coordinates of a grid-aligned tile
-    QPoint referencePoint = QPoint(qFloor(x / (p.columnWidth * 2)),
-                                   qFloor(y / (p.rowHeight * 2)));
+    QPoint referencePoint = QPoint(qFloor(x * p.invColumnWidth2),
+                                   qFloor(y * p.invRowHeight2));
 
     // Relative x and y position on the base square of the grid-aligned tile
     const QVector2D rel(x - referencePoint.x() * (p.columnWidth * 2),
@@ -437,33 +504,11 @@ QPointF HexagonalRenderer::screenToTileCoords(qreal x, qreal y) const
         ++staggerAxisIndex;
 
     // Determine the nearest hexagon tile by the distance to the center
-    QVector2D centers[4];
-
-    if (p.staggerX) {
-        const int left = p.sideLengthX / 2;
-        const int centerX = left + p.columnWidth;
-        const int centerY = p.tileHeight / 2;
-
-        centers[0] = QVector2D(left,                    centerY);
-        centers[1] = QVector2D(centerX,                 centerY - p.rowHeight);
-        centers[2] = QVector2D(centerX,                 centerY + p.rowHeight);
-        centers[3] = QVector2D(centerX + p.columnWidth, centerY);
-    } else {
-        const int top = p.sideLengthY / 2;
-        const int centerX = p.tileWidth / 2;
-        const int centerY = top + p.rowHeight;
-
-        centers[0] = QVector2D(centerX,                 top);
-        centers[1] = QVector2D(centerX - p.columnWidth, centerY);
-        centers[2] = QVector2D(centerX + p.columnWidth, centerY);
-        centers[3] = QVector2D(centerX,                 centerY + p.rowHeight);
-    }
-
     int nearest = 0;
     float minDist = std::numeric_limits<float>::max();
 
     for (int i = 0; i < 4; ++i) {
-        const QVector2D &center = centers[i];
+        const QVector2D &center = p.centers[i];
         const float dc = (center - rel).lengthSquared();
         if (dc < minDist) {
             minDist = dc;
@@ -471,21 +516,7 @@ QPointF HexagonalRenderer::screenToTileCoords(qreal x, qreal y) const
         }
     }
 
-    static constexpr QPoint offsetsStaggerX[4] = {
-        QPoint( 0,  0),
-        QPoint(+1, -1),
-        QPoint(+1,  0),
-        QPoint(+2,  0),
-    };
-    static constexpr QPoint offsetsStaggerY[4] = {
-        QPoint( 0,  0),
-        QPoint(-1, +1),
-        QPoint( 0, +1),
-        QPoint( 0, +2),
-    };
-
-    const QPoint *offsets = p.staggerX ? offsetsStaggerX : offsetsStaggerY;
-    return referencePoint + offsets[nearest];
+    return referencePoint + p.neighborOffsets[nearest];
 }
 
 /**
@@ -494,7 +525,12 @@ QPointF HexagonalRenderer::screenToTileCoords(qreal x, qreal y) const
  */
 QPointF HexagonalRenderer::tileToScreenCoords(qreal x, qreal y) const
 {
-    const RenderParams p(map());
+    return tileToScreenCoords(RenderParams(map()), x, y);
+}
+
+QPointF HexagonalRenderer::tileToScreenCoords(const RenderParams &p,
+                                              qreal x, qreal y)
+{
     const int tileX = qFloor(x);
     const int tileY = qFloor(y);
     int pixelX, pixelY;
@@ -578,8 +614,13 @@ QPoint HexagonalRenderer::bottomRight(int x, int y) const
 
 QPolygonF HexagonalRenderer::tileToScreenPolygon(int x, int y) const
 {
-    const RenderParams p(map());
-    const QPointF topRight = tileToScreenCoords(x, y);
+    return tileToScreenPolygon(RenderParams(map()), x, y);
+}
+
+QPolygonF HexagonalRenderer::tileToScreenPolygon(const RenderParams &p,
+                                                 int x, int y)
+{
+    const QPointF topRight = tileToScreenCoords(p, x, y);
 
     QPolygonF polygon(8);
     polygon[0] = topRight + QPoint(0,                           p.tileHeight - p.sideOffsetY);
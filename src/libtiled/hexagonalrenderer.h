@@ -30,6 +30,8 @@
 
 #include "orthogonalrenderer.h"
 
+#include <QVector2D>
+
 namespace Tiled {
 
 /**
@@ -44,6 +46,11 @@ namespace Tiled {
 class TILEDSHARED_EXPORT HexagonalRenderer : public OrthogonalRenderer
 {
 protected:
+    /**
+     * The derived values needed by the coordinate conversions, computed once
+     * so that loops converting many coordinates don't repeat the divisions
+     * and stagger branches per tile.
+     */
     struct RenderParams
     {
         RenderParams(const Map *map);
@@ -64,8 +71,24 @@ protected:
         int columnWidth;
         const bool staggerX;
         const bool staggerEven;
+
+        // Reciprocals of the base square dimensions, used to replace the
+        // divisions in screenToTileCoords by multiplications
+        qreal invColumnWidth2 = 0.0;
+        qreal invRowHeight2 = 0.0;
+
+        // Centers of the hexagons neighboring the base square, and the tile
+        // coordinate offsets they correspond to
+        QVector2D centers[4];
+        const QPoint *neighborOffsets = nullptr;
     };
 
+    // Overloads that take previously computed render parameters, for use in
+    // loops that convert many coordinates
+    static QPointF screenToTileCoords(const RenderParams &p, qreal x, qreal y);
+    static QPointF tileToScreenCoords(const RenderParams &p, qreal x, qreal y);
+    static QPolygonF tileToScreenPolygon(const RenderParams &p, int x, int y);
+
 public:
     HexagonalRenderer(const Map *map)
         : OrthogonalRenderer(map)
@@ -82,6 +105,8 @@ public:
                        int subdivisions) const override;
 
     using MapRenderer::drawTileLayer;
+    void drawTileLayer(QPainter *painter, const TileLayer *layer,
+                       const QRectF &exposed = QRectF()) const override;
     void drawTileLayer(const RenderTileCallback &renderTile,
                        const QRectF &exposed) const override;
 
@@ -111,6 +136,10 @@ public:
     QPolygonF tileToScreenPolygon(int x, int y) const;
     QPolygonF tileToScreenPolygon(QPoint tileCoords) const
     { return tileToScreenPolygon(tileCoords.x(), tileCoords.y()); }
+
+private:
+    template <typename RenderTile>
+    void drawTileLayerImpl(RenderTile renderTile, const QRectF &exposed) const;
 };
 
 } // namespace Tiled
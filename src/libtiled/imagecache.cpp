@@ -29,13 +29,31 @@
 #include "imagecache.h"
 
 #include "logginginterface.h"
+#include "memorybudget.h"
+
+#ifndef TILED_HEADLESS
 #include "map.h"
 #include "mapformat.h"
 #include "minimaprenderer.h"
+#endif
 
 #include <QBitmap>
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFileInfo>
+#include <QMutex>
+#include <QSemaphore>
+#include <QSet>
+#include <QSharedMemory>
+#include <QStandardPaths>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <memory>
 
 namespace Tiled {
 
@@ -47,8 +65,18 @@ struct LoadedPixmap
 
     QPixmap pixmap;
     QDateTime lastModified;
+    quint64 lastUsed = 0;   // access stamp used for LRU trimming
 };
 
+// Monotonic counter stamped onto entries on each access, so that trimming
+// can evict the least-recently-used ones first
+static quint64 sUseCounter = 0;
+
+static qint64 pixmapBytes(const QPixmap &pixmap)
+{
+    return static_cast<qint64>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
 
 LoadedImage::LoadedImage()
     : LoadedImage(QImage(), QDateTime())
@@ -68,32 +96,361 @@ LoadedPixmap::LoadedPixmap(const LoadedImage &cachedImage)
 
 QHash<QString, LoadedImage> ImageCache::sLoadedImages;
 QHash<QString, LoadedPixmap> ImageCache::sLoadedPixmaps;
+QHash<QString, std::vector<std::function<void (const LoadedImage &)>>> ImageCache::sPendingCallbacks;
+
+// Guards the hashes above and sUseCounter. The cache is reached from worker
+// threads as well (background reloads, batch rendering), so every access
+// goes through this lock. Decoding always happens outside of it; when two
+// threads race to load the same file, the later insert simply wins.
+static QMutex sCacheMutex;
+
+static bool sProcessSharingEnabled = false;
+
+/**
+ * Layout of a shared image segment: this header, directly followed by the
+ * pixel data. The header size is a multiple of 4 bytes, which keeps the
+ * pixel data 32-bit aligned as required for wrapping it in a QImage.
+ */
+struct SharedImageHeader
+{
+    quint32 ready;      // set to 1 once the pixel data is complete
+    qint32 width;
+    qint32 height;
+    qint32 bytesPerLine;
+    qint32 format;      // QImage::Format
+};
+
+// Segments this process has attached, by key. They are kept attached for the
+// lifetime of the process, so that QImage instances wrapping their pixel data
+// stay valid and re-wrapping an image after cache eviction is free.
+static QHash<QString, QSharedMemory*> sAttachedSegments;
+static QMutex sAttachedSegmentsMutex;
+
+static QString sharedImageKey(const QString &fileName, const QDateTime &lastModified)
+{
+    // Keyed on the absolute path and modification time rather than the image
+    // contents, so that deciding whether a segment matches does not require
+    // reading the file.
+    const QByteArray identity = QFileInfo(fileName).absoluteFilePath().toUtf8()
+            + '\n' + QByteArray::number(lastModified.toMSecsSinceEpoch());
+
+    return QLatin1String("tiled-image-")
+            + QString::fromLatin1(QCryptographicHash::hash(identity, QCryptographicHash::Sha1).toHex());
+}
+
+static QImage imageFromSegment(const QSharedMemory *segment)
+{
+    const auto header = static_cast<const SharedImageHeader*>(segment->constData());
+    const auto bits = reinterpret_cast<const uchar*>(header + 1);
+
+    // The read-only constructor never writes to the buffer; modifications
+    // detach into a private copy.
+    return QImage(bits, header->width, header->height, header->bytesPerLine,
+                  QImage::Format(header->format));
+}
+
+/**
+ * Decodes the image in \a fileName, going through the process-shared segment
+ * for it when sharing is enabled. The first process to get here decodes the
+ * image and publishes the pixel data, later ones map it read-only.
+ *
+ * Any failure on the shared memory side falls back to a plain local decode.
+ */
+static QImage readImage(const QString &fileName, const QDateTime &lastModified)
+{
+    if (!sProcessSharingEnabled)
+        return QImage(fileName);
+
+    const QString key = sharedImageKey(fileName, lastModified);
+
+    {
+        QMutexLocker locker(&sAttachedSegmentsMutex);
+        if (const QSharedMemory *segment = sAttachedSegments.value(key))
+            return imageFromSegment(segment);
+    }
+
+    auto segment = std::make_unique<QSharedMemory>(key);
+
+    if (segment->attach(QSharedMemory::ReadOnly)) {
+        segment->lock();
+        const bool ready = static_cast<const SharedImageHeader*>(segment->constData())->ready;
+        segment->unlock();
+
+        if (!ready) {
+            // Another process is still copying in the pixel data; decode
+            // locally rather than waiting on it.
+            segment->detach();
+            return QImage(fileName);
+        }
+
+        QMutexLocker locker(&sAttachedSegmentsMutex);
+        QSharedMemory *&entry = sAttachedSegments[key];
+        if (!entry)
+            entry = segment.release();
+        return imageFromSegment(entry);
+    }
+
+    QImage image(fileName);
+    if (image.isNull())
+        return image;
+
+    // Indexed and mono images need their color table, which the segment does
+    // not carry
+    switch (image.format()) {
+    case QImage::Format_Mono:
+    case QImage::Format_MonoLSB:
+    case QImage::Format_Indexed8:
+        image = image.convertToFormat(QImage::Format_ARGB32);
+        break;
+    default:
+        break;
+    }
+
+    const qint64 segmentSize = qint64(sizeof(SharedImageHeader)) + image.sizeInBytes();
+    if (segmentSize > std::numeric_limits<int>::max())
+        return image;
+
+    if (!segment->create(int(segmentSize))) {
+        // A racing process created the segment first, or shared memory is
+        // not available. The next request for this image will attach.
+        return image;
+    }
+
+    segment->lock();
+    auto header = static_cast<SharedImageHeader*>(segment->data());
+    header->ready = 0;
+    header->width = image.width();
+    header->height = image.height();
+    header->bytesPerLine = qint32(image.bytesPerLine());
+    header->format = image.format();
+    memcpy(header + 1, image.constBits(), size_t(image.sizeInBytes()));
+    header->ready = 1;
+    segment->unlock();
+
+    // Return a wrap of the published copy, so this process does not keep a
+    // second private copy of the pixel data alive.
+    QMutexLocker locker(&sAttachedSegmentsMutex);
+    QSharedMemory *&entry = sAttachedSegments[key];
+    if (!entry)
+        entry = segment.release();
+    return imageFromSegment(entry);
+}
+
+void ImageCache::setProcessSharingEnabled(bool enabled)
+{
+    sProcessSharingEnabled = enabled;
+}
 
 LoadedImage ImageCache::loadImage(const QString &fileName)
 {
     if (fileName.isEmpty())
         return {};
 
-    auto it = sLoadedImages.find(fileName);
+    ensureRegistered();
+
+    const QFileInfo info(fileName);
+
+    {
+        QMutexLocker locker(&sCacheMutex);
+        auto it = sLoadedImages.find(fileName);
+        if (it != sLoadedImages.end()) {
+            if (!(it.value().lastModified < info.lastModified())) {
+                it.value().lastUsed = ++sUseCounter;
+                return it.value();
+            }
+            sLoadedImages.erase(it);
+            sLoadedPixmaps.remove(fileName);
+        }
+    }
+
+    QImage image = readImage(fileName, info.lastModified());
+
+    // If the image failed to load, try to load and render a map file
+    if (image.isNull())
+        image = renderMap(fileName);
+
+    LoadedImage loaded(std::move(image), info.lastModified());
+
+    {
+        QMutexLocker locker(&sCacheMutex);
+        loaded.lastUsed = ++sUseCounter;
+        sLoadedImages.insert(fileName, loaded);
+    }
+
+    MemoryBudget::enforce();
+    return loaded;
+}
+
+void ImageCache::loadImageAsync(const QString &fileName,
+                                std::function<void (const LoadedImage &)> callback)
+{
+    if (fileName.isEmpty()) {
+        if (callback)
+            callback(LoadedImage());
+        return;
+    }
+
+    ensureRegistered();
 
-    QFileInfo info(fileName);
-    bool found = it != sLoadedImages.end();
-    bool old = found && it.value().lastModified < info.lastModified();
+    const QFileInfo info(fileName);
 
-    if (old)
-        remove(fileName);
+    {
+        QMutexLocker locker(&sCacheMutex);
+        auto it = sLoadedImages.find(fileName);
 
-    if (old || !found) {
-        QImage image(fileName);
+        if (it != sLoadedImages.end() && !(it.value().lastModified < info.lastModified())) {
+            it.value().lastUsed = ++sUseCounter;
+            const LoadedImage loaded = it.value();
+            locker.unlock();
+            if (callback)
+                callback(loaded);
+            return;
+        }
 
-        // If the image failed to load, try to load and render a map file
-        if (image.isNull())
-            image = renderMap(fileName);
+        auto &callbacks = sPendingCallbacks[fileName];
+        if (callback)
+            callbacks.push_back(std::move(callback));
 
-        it = sLoadedImages.insert(fileName, LoadedImage(image, info.lastModified()));
+        // A second request for a file that is already decoding only registers
+        // its callback
+        if (callbacks.size() > 1)
+            return;
     }
 
-    return it.value();
+    const QDateTime lastModified = info.lastModified();
+
+    QThreadPool::globalInstance()->start([fileName, lastModified] {
+        const QImage image = readImage(fileName, lastModified);
+
+        // Hop back to the main thread to fill the cache and notify waiters
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [fileName, lastModified, image] {
+            imageDecoded(fileName, lastModified, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ImageCache::imageDecoded(const QString &fileName,
+                              const QDateTime &lastModified,
+                              const QImage &image)
+{
+    // Maps used as images still need the synchronous fallback
+    LoadedImage loaded(image.isNull() ? renderMap(fileName) : image,
+                       lastModified);
+
+    std::vector<std::function<void (const LoadedImage &)>> callbacks;
+
+    {
+        QMutexLocker locker(&sCacheMutex);
+        loaded.lastUsed = ++sUseCounter;
+
+        sLoadedImages.insert(fileName, loaded);
+        sLoadedPixmaps.remove(fileName);
+
+        callbacks = std::move(sPendingCallbacks[fileName]);
+        sPendingCallbacks.remove(fileName);
+    }
+
+    for (const auto &callback : callbacks)
+        callback(loaded);
+
+    MemoryBudget::enforce();
+}
+
+void ImageCache::preloadImages(const QStringList &fileNames)
+{
+    ensureRegistered();
+
+    struct Job {
+        QString fileName;
+        QDateTime lastModified;
+        QImage image;
+    };
+
+    QVector<Job> jobs;
+    QSet<QString> seen;
+
+    {
+        QMutexLocker locker(&sCacheMutex);
+        for (const QString &fileName : fileNames) {
+            if (fileName.isEmpty() || seen.contains(fileName))
+                continue;
+            seen.insert(fileName);
+
+            const QFileInfo info(fileName);
+            const auto it = sLoadedImages.constFind(fileName);
+            if (it != sLoadedImages.constEnd() && !(it.value().lastModified < info.lastModified()))
+                continue;
+
+            jobs.append({ fileName, info.lastModified(), QImage() });
+        }
+    }
+
+    if (jobs.isEmpty())
+        return;
+
+    // Decode in parallel, with the calling thread taking jobs itself and
+    // helpers only claimed from the pool when a thread is free right now
+    // (tryStart). Queuing the jobs and blocking on them instead can
+    // deadlock: when the callers are pool workers themselves, the whole
+    // pool may end up waiting on jobs that are stuck behind the waiters.
+    if (jobs.size() == 1) {
+        Job &job = jobs.first();
+        job.image = readImage(job.fileName, job.lastModified);
+    } else {
+        auto threadPool = QThreadPool::globalInstance();
+
+        std::atomic<int> nextJob { 0 };
+        const auto decodeJobs = [&jobs, &nextJob] {
+            int i;
+            while ((i = nextJob.fetch_add(1)) < jobs.size()) {
+                Job &job = jobs[i];
+                job.image = readImage(job.fileName, job.lastModified);
+            }
+        };
+
+        QSemaphore finished;
+        int helpers = 0;
+        const int maxHelpers = qMin(jobs.size() - 1,
+                                    threadPool->maxThreadCount());
+        for (; helpers < maxHelpers; ++helpers) {
+            if (!threadPool->tryStart([&decodeJobs, &finished] {
+                decodeJobs();
+                finished.release();
+            }))
+                break;
+        }
+
+        decodeJobs();
+
+        // Wait for the helpers to leave the loop, since they reference
+        // state on this stack
+        finished.acquire(helpers);
+    }
+
+    for (Job &job : jobs) {
+        // Maps used as images still need the synchronous fallback
+        if (job.image.isNull())
+            job.image = renderMap(job.fileName);
+    }
+
+    {
+        QMutexLocker locker(&sCacheMutex);
+        for (Job &job : jobs) {
+            LoadedImage loaded(std::move(job.image), job.lastModified);
+            loaded.lastUsed = ++sUseCounter;
+
+            sLoadedImages.insert(job.fileName, loaded);
+            sLoadedPixmaps.remove(job.fileName);
+        }
+    }
+
+    MemoryBudget::enforce();
+}
+
+bool ImageCache::isCached(const QString &fileName)
+{
+    QMutexLocker locker(&sCacheMutex);
+    return sLoadedImages.contains(fileName);
 }
 
 QPixmap ImageCache::loadPixmap(const QString &fileName)
@@ -101,31 +458,163 @@ QPixmap ImageCache::loadPixmap(const QString &fileName)
     if (fileName.isEmpty())
         return {};
 
-    auto it = sLoadedPixmaps.find(fileName);
+    ensureRegistered();
+
+    const QDateTime lastModified = QFileInfo(fileName).lastModified();
+
+    {
+        QMutexLocker locker(&sCacheMutex);
+        auto it = sLoadedPixmaps.find(fileName);
+        if (it != sLoadedPixmaps.end()) {
+            if (!(it.value().lastModified < lastModified)) {
+                it.value().lastUsed = ++sUseCounter;
+                return it.value();
+            }
+            sLoadedImages.remove(fileName);
+            sLoadedPixmaps.erase(it);
+        }
+    }
 
-    bool found = it != sLoadedPixmaps.end();
-    bool old = found && it.value().lastModified < QFileInfo(fileName).lastModified();
+    LoadedPixmap loaded(loadImage(fileName));
+    const QPixmap result = loaded.pixmap;
 
-    if (old)
-        remove(fileName);
-    if (old || !found)
-        it = sLoadedPixmaps.insert(fileName, LoadedPixmap(loadImage(fileName)));
+    {
+        QMutexLocker locker(&sCacheMutex);
+        loaded.lastUsed = ++sUseCounter;
+        sLoadedPixmaps.insert(fileName, loaded);
+    }
 
-    return it.value();
+    MemoryBudget::enforce();
+    return result;
 }
 
 void ImageCache::remove(const QString &fileName)
 {
+    QMutexLocker locker(&sCacheMutex);
     sLoadedImages.remove(fileName);
     sLoadedPixmaps.remove(fileName);
 }
 
+qint64 ImageCache::memoryUsage()
+{
+    QMutexLocker locker(&sCacheMutex);
+    qint64 total = 0;
+    for (const LoadedImage &loaded : std::as_const(sLoadedImages))
+        total += loaded.image.sizeInBytes();
+    for (const LoadedPixmap &loaded : std::as_const(sLoadedPixmaps))
+        total += pixmapBytes(loaded.pixmap);
+    return total;
+}
+
+void ImageCache::trim(qint64 targetBytes)
+{
+    struct Entry {
+        quint64 lastUsed;
+        qint64 bytes;
+        QString fileName;
+    };
+
+    QMutexLocker locker(&sCacheMutex);
+
+    QHash<QString, Entry> merged;
+
+    for (auto it = sLoadedImages.cbegin(); it != sLoadedImages.cend(); ++it)
+        merged.insert(it.key(), { it.value().lastUsed,
+                                  static_cast<qint64>(it.value().image.sizeInBytes()),
+                                  it.key() });
+
+    // Pixmaps are dropped together with their image, counting the latest
+    // access of either
+    for (auto it = sLoadedPixmaps.cbegin(); it != sLoadedPixmaps.cend(); ++it) {
+        Entry &entry = merged[it.key()];
+        entry.lastUsed = qMax(entry.lastUsed, it.value().lastUsed);
+        entry.bytes += pixmapBytes(it.value().pixmap);
+        entry.fileName = it.key();
+    }
+
+    QVector<Entry> entries;
+    entries.reserve(merged.size());
+    qint64 usage = 0;
+    for (const Entry &entry : std::as_const(merged)) {
+        entries.append(entry);
+        usage += entry.bytes;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [] (const Entry &a, const Entry &b) { return a.lastUsed < b.lastUsed; });
+
+    for (const Entry &entry : std::as_const(entries)) {
+        if (usage <= targetBytes)
+            break;
+
+        // Not through remove(), which takes the lock we already hold
+        sLoadedImages.remove(entry.fileName);
+        sLoadedPixmaps.remove(entry.fileName);
+        usage -= entry.bytes;
+    }
+}
+
+void ImageCache::ensureRegistered()
+{
+    static const bool registered = [] {
+        MemoryBudget::registerCache(QStringLiteral("images"),
+                                    &ImageCache::memoryUsage,
+                                    &ImageCache::trim);
+        return true;
+    }();
+    Q_UNUSED(registered)
+}
+
+#ifndef TILED_HEADLESS
+/**
+ * Returns the directory in the user's cache location where rendered maps are
+ * stored, or an empty string when there is no writable cache location.
+ */
+static QString renderedMapCacheDirectory()
+{
+    static const QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheLocation.isEmpty())
+        return QString();
+    return cacheLocation + QLatin1String("/rendered-maps");
+}
+#endif // TILED_HEADLESS
+
 QImage ImageCache::renderMap(const QString &fileName)
 {
+#ifdef TILED_HEADLESS
+    // Rendering metatile maps needs the map renderers, which are not part
+    // of a headless build
+    Q_UNUSED(fileName)
+    return {};
+#else
     if (fileName.isEmpty())
         return {};
 
-    static QSet<QString> loadingMaps;
+    // Rendering a map is expensive, so the result is kept on disk across
+    // sessions, keyed on the file path and validated by its modification
+    // time. Note that this does not cover changes to external tilesets
+    // referenced by the map; those require touching the map file.
+    const QString cacheDir = renderedMapCacheDirectory();
+    QString pathHash;
+    QString cacheFile;
+
+    if (!cacheDir.isEmpty()) {
+        const QFileInfo fileInfo(fileName);
+        pathHash = QString::fromLatin1(
+                    QCryptographicHash::hash(fileInfo.absoluteFilePath().toUtf8(),
+                                             QCryptographicHash::Sha1).toHex());
+        cacheFile = cacheDir + QLatin1Char('/') + pathHash + QLatin1Char('-')
+                + QString::number(fileInfo.lastModified().toMSecsSinceEpoch(), 16)
+                + QLatin1String(".png");
+
+        const QImage cached(cacheFile);
+        if (!cached.isNull())
+            return cached;
+    }
+
+    // Detects recursion within the current call stack, hence per-thread.
+    // Concurrent loads of the same map from different threads are fine.
+    static thread_local QSet<QString> loadingMaps;
 
     if (loadingMaps.contains(fileName)) {
         ERROR(QCoreApplication::translate("Tiled::ImageCache",
@@ -157,7 +646,47 @@ QImage ImageCache::renderMap(const QString &fileName)
                                                    MiniMapRenderer::IgnoreInvisibleLayer |
                                                    MiniMapRenderer::DrawBackground);
     const QSize mapSize = miniMapRenderer.mapSize();
-    return miniMapRenderer.render(mapSize, renderFlags);
+    const QImage image = miniMapRenderer.render(mapSize, renderFlags);
+
+    if (!cacheFile.isEmpty() && !image.isNull()) {
+        QDir dir(cacheDir);
+        dir.mkpath(QStringLiteral("."));
+
+        // Drop renders of older versions of this map
+        const auto staleEntries = dir.entryList({ pathHash + QLatin1String("-*") },
+                                                QDir::Files);
+        for (const QString &staleEntry : staleEntries)
+            dir.remove(staleEntry);
+
+        image.save(cacheFile, "PNG");
+    }
+
+    return image;
+#endif // TILED_HEADLESS
+}
+
+/**
+ * Returns \a pixmap with all pixels matching \a color made fully transparent.
+ *
+ * This used to be done with QPixmap::createMaskFromColor followed by setMask,
+ * which needs a 1-bpp bitmap and several format conversions. Doing the color
+ * key in a single pass over 32-bit pixel data is much faster on large tileset
+ * images, since the inner loop is simple enough for the compiler to
+ * vectorize.
+ */
+QPixmap applyColorKey(const QPixmap &pixmap, const QColor &color)
+{
+    QImage image = pixmap.toImage().convertToFormat(QImage::Format_ARGB32);
+    const QRgb key = color.rgb();
+
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *pixel = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (QRgb * const end = pixel + image.width(); pixel != end; ++pixel)
+            if (*pixel == key)
+                *pixel = 0;
+    }
+
+    return QPixmap::fromImage(std::move(image));
 }
 
 } // namespace Tiled
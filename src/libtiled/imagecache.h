@@ -36,6 +36,9 @@
 #include <QImage>
 #include <QPixmap>
 #include <QString>
+#include <QStringList>
+
+#include <functional>
 
 namespace Tiled {
 
@@ -48,24 +51,87 @@ struct LoadedImage
 
     QImage image;
     QDateTime lastModified;
+    quint64 lastUsed = 0;   // access stamp used for LRU trimming
 };
 
 struct LoadedPixmap;
 class Map;
 
+/**
+ * A process-wide cache of images loaded from files.
+ *
+ * All functions are thread-safe; images may be loaded from worker threads
+ * as well as the GUI thread. Note that loadPixmap() still requires a
+ * platform plugin that supports threaded pixmaps when called off the GUI
+ * thread, which holds for the raster-based platforms Tiled runs on.
+ */
 class TILEDSHARED_EXPORT ImageCache
 {
 public:
     static LoadedImage loadImage(const QString &fileName);
     static QPixmap loadPixmap(const QString &fileName);
 
+    /**
+     * Decodes the image on a background thread and invokes \a callback on
+     * the main thread once it is in the cache. When the image is already
+     * cached the callback is invoked immediately. Requests for the same
+     * file are coalesced, so views can request an image each time they
+     * need it and repaint progressively as images arrive.
+     */
+    static void loadImageAsync(const QString &fileName,
+                               std::function<void (const LoadedImage &)> callback);
+
+    /**
+     * Decodes the given images in parallel and adds them to the cache,
+     * blocking until all of them are available. Already cached images are
+     * skipped. Used to warm up the cache before a batch of loadImage or
+     * loadPixmap calls, like the tileset images of a freshly loaded map.
+     *
+     * The calling thread participates in the decoding and idle global
+     * thread pool workers are recruited to help, so this is safe to call
+     * from a pool worker without risking pool starvation.
+     */
+    static void preloadImages(const QStringList &fileNames);
+
+    /**
+     * Enables sharing decoded images with other Tiled processes through
+     * named shared memory segments, keyed on the image file and its
+     * modification time. The first process to need an image decodes and
+     * publishes it; the others map the pixel data read-only.
+     *
+     * Meant for batch exports running many processes against the same
+     * tilesets. Off by default, since the segments live as long as any
+     * participating process keeps an image mapped.
+     */
+    static void setProcessSharingEnabled(bool enabled);
+
+    static bool isCached(const QString &fileName);
+
     static void remove(const QString &fileName);
 
+    static qint64 memoryUsage();
+
+    /**
+     * Drops least-recently-used entries until the cache holds at most
+     * \a targetBytes. Evicted images are transparently reloaded from disk
+     * when they are requested again.
+     */
+    static void trim(qint64 targetBytes);
+
 private:
+    static void ensureRegistered();
+
     static QImage renderMap(const QString &fileName);
+    static void imageDecoded(const QString &fileName,
+                             const QDateTime &lastModified,
+                             const QImage &image);
 
     static QHash<QString, LoadedImage> sLoadedImages;
     static QHash<QString, LoadedPixmap> sLoadedPixmaps;
+    static QHash<QString, std::vector<std::function<void (const LoadedImage &)>>> sPendingCallbacks;
 };
 
+TILEDSHARED_EXPORT QPixmap applyColorKey(const QPixmap &pixmap,
+                                         const QColor &color);
+
 } // namespace Tiled
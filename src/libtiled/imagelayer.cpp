@@ -32,8 +32,6 @@
 #include "imagecache.h"
 #include "map.h"
 
-#include <QBitmap>
-
 using namespace Tiled;
 
 ImageLayer::ImageLayer(const QString &name, int x, int y):
@@ -59,10 +57,8 @@ bool ImageLayer::loadFromImage(const QPixmap &image, const QUrl &source)
     if (image.isNull())
         return false;
 
-    if (mTransparentColor.isValid()) {
-        const QBitmap mask = image.createMaskFromColor(mTransparentColor.rgb());
-        mImage.setMask(mask);
-    }
+    if (mTransparentColor.isValid())
+        mImage = applyColorKey(image, mTransparentColor);
 
     return true;
 }
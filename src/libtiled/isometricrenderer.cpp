@@ -28,6 +28,8 @@
 
 #include "isometricrenderer.h"
 
+#include "maprenderer_p.h"
+
 #include "map.h"
 #include "mapobject.h"
 #include "tile.h"
@@ -237,8 +239,24 @@ void IsometricRenderer::drawGrid(QPainter *painter, const QRectF &rect,
     }
 }
 
+void IsometricRenderer::drawTileLayer(QPainter *painter, const TileLayer *layer,
+                                      const QRectF &exposed) const
+{
+    renderTileLayer(*this, painter, layer, exposed,
+                    [this] (const auto &renderTile, const QRectF &rect) {
+        drawTileLayerImpl(renderTile, rect);
+    });
+}
+
 void IsometricRenderer::drawTileLayer(const RenderTileCallback &renderTile,
                                       const QRectF &exposed) const
+{
+    drawTileLayerImpl(renderTile, exposed);
+}
+
+template <typename RenderTile>
+void IsometricRenderer::drawTileLayerImpl(RenderTile renderTile,
+                                          const QRectF &exposed) const
 {
     const int tileWidth = map()->tileWidth();
     const int tileHeight = map()->tileHeight();
@@ -374,13 +392,7 @@ void IsometricRenderer::drawMapObject(QPainter *painter,
         QRectF bounds = { pixelToScreenCoords(object->position()), object->size() };
         bounds.translate(-alignmentOffset(bounds, object->alignment(map())));
 
-        const auto& textData = object->textData();
-
-        painter->setFont(textData.font);
-        painter->setPen(textData.color);
-        painter->drawText(bounds,
-                          textData.text,
-                          textData.textOption());
+        drawTextObject(painter, object->textData(), bounds);
     } else {
         const qreal lineWidth = objectLineWidth();
         const qreal scale = painterScale();
@@ -54,6 +54,8 @@ public:
                   QColor grid, QSize gridMajor) const override;
 
     using MapRenderer::drawTileLayer;
+    void drawTileLayer(QPainter *painter, const TileLayer *layer,
+                       const QRectF &exposed = QRectF()) const override;
     void drawTileLayer(const RenderTileCallback &renderTile,
                        const QRectF &exposed) const override;
 
@@ -85,6 +87,9 @@ public:
     QPointF pixelToScreenCoords(qreal x, qreal y) const override;
 
 private:
+    template <typename RenderTile>
+    void drawTileLayerImpl(RenderTile renderTile, const QRectF &exposed) const;
+
     QTransform transform() const;
     QPolygonF pixelRectToScreenPolygon(const QRectF &rect) const;
     QPolygonF tileRectToScreenPolygon(const QRect &rect) const;
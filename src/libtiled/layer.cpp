@@ -155,27 +155,59 @@ QList<Layer *> Layer::siblings() const
 }
 
 /**
- * Computes the total offset. which is the offset including the offset of all
+ * Returns the total offset, which is the offset including the offset of all
  * parent layers.
+ *
+ * The value is cached, so repeated calls are cheap until the offset of this
+ * layer or one of its parents changes.
  */
 QPointF Layer::totalOffset() const
 {
-    auto offset = mOffset;
-    const Layer *layer = this;
-    while ((layer = layer->parentLayer()))
-        offset += layer->offset();
-    return offset;
+    if (mResolvedTransformDirty)
+        resolveTransform();
+    return mTotalOffset;
 }
 
+/**
+ * Returns the parallax factor multiplied by the parallax factor of all parent
+ * layers.
+ *
+ * The value is cached, so repeated calls are cheap until the parallax factor
+ * of this layer or one of its parents changes.
+ */
 QPointF Layer::effectiveParallaxFactor() const
 {
-    auto factor = mParallaxFactor;
-    const Layer *layer = this;
-    while ((layer = layer->parentLayer())) {
-        factor.rx() *= layer->parallaxFactor().rx();
-        factor.ry() *= layer->parallaxFactor().ry();
+    if (mResolvedTransformDirty)
+        resolveTransform();
+    return mEffectiveParallaxFactor;
+}
+
+/**
+ * Resolves the cached total offset and effective parallax factor, based on
+ * the cached values of the parent layer.
+ */
+void Layer::resolveTransform() const
+{
+    if (const Layer *parent = mParentLayer) {
+        mTotalOffset = mOffset + parent->totalOffset();
+        const QPointF parentFactor = parent->effectiveParallaxFactor();
+        mEffectiveParallaxFactor = { mParallaxFactor.x() * parentFactor.x(),
+                                     mParallaxFactor.y() * parentFactor.y() };
+    } else {
+        mTotalOffset = mOffset;
+        mEffectiveParallaxFactor = mParallaxFactor;
     }
-    return factor;
+    mResolvedTransformDirty = false;
+}
+
+/**
+ * Marks the cached resolved transform of this layer as dirty. Called when the
+ * offset or parallax factor of this layer changes, or when it is moved to a
+ * different parent. GroupLayer extends this to also invalidate its children.
+ */
+void Layer::invalidateResolvedTransform()
+{
+    mResolvedTransformDirty = true;
 }
 
 /**
@@ -204,6 +236,8 @@ bool Layer::canMergeDown() const
  */
 Layer *Layer::initializeClone(Layer *clone) const
 {
+    ++CloneStatistics::layerClones;
+
     clone->setClassName(className());
     clone->mId = mId;
     clone->mOffset = mOffset;
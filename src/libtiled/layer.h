@@ -252,7 +252,14 @@ protected:
      * Map class.
      */
     virtual void setMap(Map *map) { mMap = map; }
-    void setParentLayer(GroupLayer *groupLayer) { mParentLayer = groupLayer; }
+
+    void setParentLayer(GroupLayer *groupLayer)
+    {
+        mParentLayer = groupLayer;
+        invalidateResolvedTransform();
+    }
+
+    virtual void invalidateResolvedTransform();
 
     Layer *initializeClone(Layer *clone) const;
 
@@ -270,6 +277,14 @@ protected:
     GroupLayer *mParentLayer = nullptr;
     bool mLocked = false;
 
+private:
+    void resolveTransform() const;
+
+    // Cached resolved transform, taking into account all parent layers
+    mutable QPointF mTotalOffset;
+    mutable QPointF mEffectiveParallaxFactor = { 1.0, 1.0 };
+    mutable bool mResolvedTransformDirty = true;
+
     friend class Map;
     friend class GroupLayer;
 };
@@ -281,6 +296,7 @@ protected:
 inline void Layer::setOffset(const QPointF &offset)
 {
     mOffset = offset;
+    invalidateResolvedTransform();
 }
 
 /**
@@ -297,6 +313,7 @@ inline QPointF Layer::offset() const
 inline void Layer::setParallaxFactor(const QPointF &factor)
 {
     mParallaxFactor = factor;
+    invalidateResolvedTransform();
 }
 
 /**
@@ -30,9 +30,11 @@
 
 #include "map.h"
 
+#include "grouplayer.h"
 #include "imagelayer.h"
 #include "layer.h"
 #include "mapobject.h"
+#include "maprenderer.h"
 #include "objectgroup.h"
 #include "objecttemplate.h"
 #include "tile.h"
@@ -272,6 +274,43 @@ void Map::insertTileset(int index, const SharedTileset &tileset)
     invalidateDrawMargins();
 }
 
+/**
+ * Returns the first global tile ID assigned to each tileset when writing
+ * out this map, with the tilesets occupying consecutive GID ranges in map
+ * order.
+ *
+ * The layout is cached across saves. Since the tileset list can change in
+ * many ways and a tileset can also grow new tiles without the map itself
+ * being touched, the cache is validated on access against the sequence of
+ * (tileset, nextTileId) pairs it was computed from, rather than being
+ * invalidated from every mutator.
+ */
+const QVector<unsigned> &Map::tilesetFirstGids() const
+{
+    const int count = mTilesets.size();
+
+    bool upToDate = mTilesetFirstGidsKey.size() == count;
+    for (int i = 0; upToDate && i < count; ++i) {
+        upToDate = mTilesetFirstGidsKey.at(i).first == mTilesets.at(i).data()
+                && mTilesetFirstGidsKey.at(i).second == mTilesets.at(i)->nextTileId();
+    }
+
+    if (!upToDate) {
+        mTilesetFirstGids.resize(count);
+        mTilesetFirstGidsKey.resize(count);
+
+        unsigned firstGid = 1;
+        for (int i = 0; i < count; ++i) {
+            const SharedTileset &tileset = mTilesets.at(i);
+            mTilesetFirstGids[i] = firstGid;
+            mTilesetFirstGidsKey[i] = { tileset.data(), tileset->nextTileId() };
+            firstGid += tileset->nextTileId();
+        }
+    }
+
+    return mTilesetFirstGids;
+}
+
 /**
  * Returns the index of the given \a tileset, or -1 if it is not used in
  * this map.
@@ -312,8 +351,12 @@ bool Map::replaceTileset(const SharedTileset &oldTileset,
 
     const auto &layers = mLayers;
     for (Layer *layer : layers) {
-        layer->replaceReferencesToTileset(oldTileset.data(),
-                                          newTileset.data());
+        // Leave layers that don't use the tileset alone, so their possibly
+        // shared tile data doesn't get detached for nothing.
+        if (layer->referencesTileset(oldTileset.data())) {
+            layer->replaceReferencesToTileset(oldTileset.data(),
+                                              newTileset.data());
+        }
     }
 
     invalidateDrawMargins();
@@ -355,8 +398,14 @@ bool Map::isTilesetUsed(const Tileset *tileset) const
     return false;
 }
 
+std::atomic<quint64> CloneStatistics::mapClones { 0 };
+std::atomic<quint64> CloneStatistics::layerClones { 0 };
+std::atomic<quint64> CloneStatistics::objectClones { 0 };
+
 std::unique_ptr<Map> Map::clone() const
 {
+    ++CloneStatistics::mapClones;
+
     auto o = std::make_unique<Map>(mParameters);
     o->setClassName(className());
     o->setProperties(properties());
@@ -418,6 +467,123 @@ void Map::copyLayers(const QList<Layer *> &layers,
     }
 }
 
+static void copyLayerAttributes(const Layer &source, Layer &target)
+{
+    target.setId(source.id());
+    target.setName(source.name());
+    target.setClassName(source.className());
+    target.setProperties(source.properties());
+    target.setOffset(source.offset());
+    target.setParallaxFactor(source.parallaxFactor());
+    target.setOpacity(source.opacity());
+    target.setTintColor(source.tintColor());
+    target.setVisible(source.isVisible());
+    target.setLocked(source.isLocked());
+}
+
+/**
+ * Returns a copy of \a layer reduced to \a tileArea, for Map::clipped. The
+ * \a pixelArea is the same area in pixel coordinates, used to filter objects.
+ */
+static std::unique_ptr<Layer> clippedLayer(const Layer *layer,
+                                           const QRect &tileArea,
+                                           const QRectF &pixelArea)
+{
+    switch (layer->layerType()) {
+    case Layer::TileLayerType: {
+        auto tileLayer = static_cast<const TileLayer*>(layer);
+        const QRegion area = QRegion(tileArea).intersected(tileLayer->bounds());
+
+        auto clipped = tileLayer->copy(area.translated(-tileLayer->position()));
+        copyLayerAttributes(*tileLayer, *clipped);
+        clipped->setPosition(area.boundingRect().topLeft() - tileArea.topLeft());
+        return clipped;
+    }
+    case Layer::ObjectGroupType: {
+        auto objectGroup = static_cast<const ObjectGroup*>(layer);
+
+        auto clipped = std::make_unique<ObjectGroup>();
+        copyLayerAttributes(*objectGroup, *clipped);
+        clipped->setColor(objectGroup->color());
+        clipped->setDrawOrder(objectGroup->drawOrder());
+
+        // The object index provides the objects touching the area without
+        // iterating the whole group
+        const auto objects = objectGroup->objectsIntersecting(pixelArea);
+        for (const MapObject *object : objects) {
+            auto clone = std::unique_ptr<MapObject>(object->clone());
+            clone->setPosition(clone->position() - pixelArea.topLeft());
+            clipped->addObject(std::move(clone));
+        }
+        return clipped;
+    }
+    case Layer::ImageLayerType:
+        return std::unique_ptr<Layer>(layer->clone());
+    case Layer::GroupLayerType: {
+        auto groupLayer = static_cast<const GroupLayer*>(layer);
+
+        auto clipped = std::make_unique<GroupLayer>(QString(), 0, 0);
+        copyLayerAttributes(*groupLayer, *clipped);
+
+        for (const Layer *child : groupLayer->layers())
+            clipped->addLayer(clippedLayer(child, tileArea, pixelArea));
+        return clipped;
+    }
+    }
+
+    return nullptr;
+}
+
+/**
+ * Returns a copy of this map reduced to the given \a tileArea.
+ *
+ * Tile layers are clipped to the area, which copies cells a run at a time
+ * rather than one by one, and objects are filtered through the spatial index
+ * of their group. Everything is repositioned so that the top-left corner of
+ * the area becomes the origin of the returned map.
+ *
+ * This makes exporting a small part of a huge map cheap, since the cost
+ * depends on the area rather than on the size of the map.
+ */
+std::unique_ptr<Map> Map::clipped(const QRect &tileArea) const
+{
+    Parameters parameters = mParameters;
+    parameters.width = tileArea.width();
+    parameters.height = tileArea.height();
+    parameters.infinite = false;
+
+    auto clipped = std::make_unique<Map>(parameters);
+    clipped->setClassName(className());
+    clipped->setProperties(properties());
+    clipped->mEditorSettings = mEditorSettings;
+    clipped->mTilesets = mTilesets;
+    clipped->mNextLayerId = mNextLayerId;
+    clipped->mNextObjectId = mNextObjectId;
+
+    // Objects are positioned in pixel coordinates
+    const auto renderer = MapRenderer::create(this);
+    const QRectF pixelArea(renderer->tileToPixelCoords(QPointF(tileArea.topLeft())),
+                           renderer->tileToPixelCoords(QPointF(tileArea.bottomRight() + QPoint(1, 1))));
+
+    for (const Layer *layer : mLayers)
+        clipped->addLayer(clippedLayer(layer, tileArea, pixelArea));
+
+    return clipped;
+}
+
+/**
+ * Converts the chunks of all tile layers to their packed form (see
+ * PackedChunk), which takes a quarter of the memory. Chunks are transparently
+ * expanded again when their cells are accessed, so this is most useful for
+ * maps the user is not currently interacting with.
+ */
+void Map::compactLayers()
+{
+    LayerIterator it(this, Layer::TileLayerType);
+    while (auto tileLayer = static_cast<TileLayer*>(it.next()))
+        tileLayer->compact();
+}
+
 /**
  * Determines the unified content area of all tile layers and then repositions
  * those layers to eliminate unnecessary offset. Also sets the size of the map
@@ -487,6 +653,12 @@ Layer *Map::findLayerById(int layerId) const
     return nullptr;
 }
 
+/**
+ * Returns the object with the given \a objectId, searching all object groups.
+ *
+ * This is a linear search. Editor code that has a MapDocument available
+ * should prefer MapObjectModel::findObjectById, which is backed by an index.
+ */
 MapObject *Map::findObjectById(int objectId) const
 {
     for (Layer *layer : objectGroups()) {
@@ -605,6 +777,7 @@ QString Tiled::compressionToString(Map::LayerDataFormat layerDataFormat)
     case Map::XML:
     case Map::Base64:
     case Map::CSV:
+    case Map::DeltaVLQ:
         return QString();
     case Map::Base64Gzip:
         return QStringLiteral("gzip");
@@ -37,10 +37,12 @@
 #include <QColor>
 #include <QList>
 #include <QMargins>
+#include <QPair>
 #include <QSharedPointer>
 #include <QSize>
 #include <QVector>
 
+#include <atomic>
 #include <memory>
 
 namespace Tiled {
@@ -50,6 +52,19 @@ class ObjectGroup;
 class ObjectTemplate;
 class Tile;
 
+/**
+ * Counters tracking how often the cloning paths run. Useful for profiling
+ * operations that are expected to share rather than copy their data, such as
+ * taking snapshots for undo commands or exports. Queryable from the script
+ * console through tiled.cloneStatistics().
+ */
+struct TILEDSHARED_EXPORT CloneStatistics
+{
+    static std::atomic<quint64> mapClones;
+    static std::atomic<quint64> layerClones;
+    static std::atomic<quint64> objectClones;
+};
+
 /**
  * A tile map. Consists of a stack of layers.
  *
@@ -117,7 +132,14 @@ public:
         Base64Gzip      = 2,
         Base64Zlib      = 3,
         Base64Zstandard = 4,
-        CSV             = 5
+        CSV             = 5,
+
+        /**
+         * Plain text lines of delta-encoded base64 VLQ values, one line per
+         * row. Produces line-level diffs in version control and parses
+         * without number-to-string conversions.
+         */
+        DeltaVLQ        = 6
     };
 
     /**
@@ -170,6 +192,7 @@ public:
         int compressionLevel = -1;
         QSize chunkSize = QSize(CHUNK_SIZE, CHUNK_SIZE);
         LayerDataFormat layerDataFormat = Base64Zlib;
+        bool compactCellStorage = false;
     };
 
     Map();
@@ -274,6 +297,7 @@ public:
     int tilesetCount() const;
     SharedTileset tilesetAt(int index) const;
     const QVector<SharedTileset> &tilesets() const;
+    const QVector<unsigned> &tilesetFirstGids() const;
 
     QSet<SharedTileset> usedTilesets() const;
 
@@ -285,11 +309,19 @@ public:
 
     QSize chunkSize() const;
     void setChunkSize(QSize size);
-    
+
+    bool compactCellStorage() const;
+    void setCompactCellStorage(bool compact);
+
+    void compactLayers();
+
+
     bool isTilesetUsed(const Tileset *tileset) const;
 
     std::unique_ptr<Map> clone() const;
 
+    std::unique_ptr<Map> clipped(const QRect &tileArea) const;
+
     void copyLayers(const QList<Layer*> &layers,
                     const QRegion &tileRegion,
                     Map &targetMap) const;
@@ -329,6 +361,10 @@ private:
     mutable QMargins mDrawMargins;
     mutable bool mDrawMarginsDirty = true;
 
+    // Cached GID layout for saving (see tilesetFirstGids)
+    mutable QVector<unsigned> mTilesetFirstGids;
+    mutable QVector<QPair<Tileset*, int>> mTilesetFirstGidsKey;
+
     QList<Layer*> mLayers;
     QVector<SharedTileset> mTilesets;
 
@@ -642,6 +678,20 @@ inline void Map::setChunkSize(QSize size)
     mEditorSettings.chunkSize = size;
 }
 
+/**
+ * Returns whether tile layers of this map should keep their chunks in the
+ * packed structure-of-arrays form when possible (see TileLayer::compact).
+ */
+inline bool Map::compactCellStorage() const
+{
+    return mEditorSettings.compactCellStorage;
+}
+
+inline void Map::setCompactCellStorage(bool compact)
+{
+    mEditorSettings.compactCellStorage = compact;
+}
+
 /**
  * Returns whether the map is staggered.
  */
@@ -41,6 +41,8 @@
 #include <QString>
 #include <QTextOption>
 
+#include <cstddef>
+
 namespace Tiled {
 
 class MapRenderer;
@@ -131,6 +133,11 @@ public:
                        const QPointF &pos = QPointF(),
                        const QSizeF &size = QSizeF(0, 0));
 
+    // Map objects are allocated from a pool, since object-heavy maps create
+    // and destroy them by the million (see mapobject.cpp)
+    void *operator new(std::size_t size);
+    void operator delete(void *ptr, std::size_t size);
+
     int id() const;
     void setId(int id);
     void resetId();
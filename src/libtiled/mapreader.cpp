@@ -30,16 +30,20 @@
 
 #include "mapreader.h"
 
+#include "base64.h"
 #include "compression.h"
 #include "gidmapper.h"
 #include "grouplayer.h"
+#include "imagecache.h"
 #include "imagelayer.h"
 #include "objectgroup.h"
 #include "objecttemplate.h"
 #include "map.h"
+#include "profiler.h"
 #include "mapobject.h"
 #include "templatemanager.h"
 #include "tile.h"
+#include "tiled.h"
 #include "tilelayer.h"
 #include "tilesetmanager.h"
 #include "wangset.h"
@@ -109,9 +113,16 @@ private:
                                const QByteArray &data,
                                Map::LayerDataFormat format,
                                QRect bounds);
+    void deferBinaryLayerData(TileLayer &tileLayer,
+                              const QByteArray &data,
+                              Map::LayerDataFormat format,
+                              QRect bounds);
     void decodeCSVLayerData(TileLayer &tileLayer,
                             QStringRef text,
                             QRect bounds);
+    void decodeDeltaVLQLayerData(TileLayer &tileLayer,
+                                 QStringRef text,
+                                 QRect bounds);
 
     /**
      * Returns the cell for the given global tile ID. Errors are raised with
@@ -144,7 +155,9 @@ private:
     QDir mPath;
     std::unique_ptr<Map> mMap;
     GidMapper mGidMapper;
+    QHash<QString, ObjectTemplate*> mResolvedTemplates;
     bool mReadingExternalTileset;
+    bool mDeferredChunkDecoding = false;
 
     QXmlStreamReader xml;
 };
@@ -156,6 +169,7 @@ std::unique_ptr<Map> MapReaderPrivate::readMap(QIODevice *device, const QString
 {
     mError.clear();
     mPath.setPath(path);
+    mResolvedTemplates.clear();
     std::unique_ptr<Map> map;
 
     xml.setDevice(device);
@@ -174,6 +188,7 @@ SharedTileset MapReaderPrivate::readTileset(QIODevice *device, const QString &pa
 {
     mError.clear();
     mPath.setPath(path);
+    mResolvedTemplates.clear();
     SharedTileset tileset;
     mReadingExternalTileset = true;
 
@@ -192,6 +207,7 @@ std::unique_ptr<ObjectTemplate> MapReaderPrivate::readObjectTemplate(QIODevice *
 {
     mError.clear();
     mPath.setPath(path);
+    mResolvedTemplates.clear();
     std::unique_ptr<ObjectTemplate> objectTemplate;
 
     xml.setDevice(device);
@@ -280,7 +296,7 @@ std::unique_ptr<Map> MapReaderPrivate::readMap()
 
     mMap = std::make_unique<Map>(mapParameters);
 
-    mMap->setClassName(atts.value(QLatin1String("class")).toString());
+    mMap->setClassName(internString(atts.value(QLatin1String("class")).toString()));
 
     if (const int compressionLevel = atts.value(QLatin1String("compressionlevel")).toInt(&ok); ok)
         mMap->setCompressionLevel(compressionLevel);
@@ -306,11 +322,22 @@ std::unique_ptr<Map> MapReaderPrivate::readMap()
     if (xml.hasError()) {
         mMap.reset();
     } else {
-        // Try to load the tileset images for embedded tilesets
+#ifndef TILED_HEADLESS
+        // Try to load the tileset images for embedded tilesets, warming up
+        // the image cache in parallel first
         auto tilesets = mMap->tilesets();
-        for (SharedTileset &tileset : tilesets) {
-            if (!tileset->isCollection() && tileset->fileName().isEmpty())
-                tileset->loadImage();
+
+        if (!TilesetManager::instance()->deferredImageLoading()) {
+            QStringList imageSources;
+            for (const SharedTileset &tileset : std::as_const(tilesets))
+                if (!tileset->isCollection() && tileset->fileName().isEmpty())
+                    imageSources.append(Tiled::urlToLocalFileOrQrc(tileset->imageSource()));
+            ImageCache::preloadImages(imageSources);
+
+            for (SharedTileset &tileset : tilesets) {
+                if (!tileset->isCollection() && tileset->fileName().isEmpty())
+                    tileset->loadImage();
+            }
         }
 
         // Fix up sizes of tile objects. This is for backwards compatibility.
@@ -318,6 +345,17 @@ std::unique_ptr<Map> MapReaderPrivate::readMap()
         while (Layer *layer = iterator.next()) {
             if (ObjectGroup *objectGroup = layer->asObjectGroup()) {
                 for (MapObject *object : *objectGroup) {
+                    if (object->width() > 0 && object->height() > 0)
+                        continue;
+
+                    // A sizeless tile object takes the size of its tile,
+                    // whose geometry only exists once the tileset image is
+                    // loaded. With deferred image loading this is the one
+                    // case that still needs the image up front.
+                    if (Tileset *tileset = object->cell().tileset())
+                        if (!tileset->isCollection() && tileset->imageStatus() == LoadingPending)
+                            tileset->loadImage();
+
                     if (const Tile *tile = object->cell().tile()) {
                         const QSizeF tileSize = tile->size();
                         if (object->width() == 0)
@@ -328,6 +366,7 @@ std::unique_ptr<Map> MapReaderPrivate::readMap()
                 }
             }
         }
+#endif // TILED_HEADLESS
     }
 
     return std::move(mMap);
@@ -388,7 +427,7 @@ SharedTileset MapReaderPrivate::readTileset()
             return {};
         }
 
-        const QString className = atts.value(QLatin1String("class")).toString();
+        const QString className = internString(atts.value(QLatin1String("class")).toString());
         const int tileSpacing = atts.value(QLatin1String("spacing")).toInt();
         const int margin = atts.value(QLatin1String("margin")).toInt();
         const int columns = atts.value(QLatin1String("columns")).toInt();
@@ -508,7 +547,7 @@ void MapReaderPrivate::readTilesetTile(Tileset &tileset)
     QString className = atts.value(QLatin1String("class")).toString();
     if (className.isEmpty())    // fallback for compatibility
         className = atts.value(QLatin1String("type")).toString();
-    tile->setClassName(className);
+    tile->setClassName(internString(className));
 
     // Read tile quadrant terrain ids as Wang IDs. This is possible because the
     // terrain types (loaded as WangSet) are always stored before the tiles.
@@ -671,7 +710,7 @@ ImageReference MapReaderPrivate::readImage()
 
                 image.data = xml.readElementText().toLatin1();
                 if (encoding == QLatin1String("base64"))
-                    image.data = QByteArray::fromBase64(image.data);
+                    image.data = fromBase64(image.data);
             } else {
                 readUnknownElement();
             }
@@ -861,7 +900,7 @@ void MapReaderPrivate::readTilesetWangSets(Tileset &tileset)
 static void readLayerAttributes(Layer &layer,
                                 const QXmlStreamAttributes &atts)
 {
-    layer.setClassName(atts.value(QLatin1String("class")).toString());
+    layer.setClassName(internString(atts.value(QLatin1String("class")).toString()));
 
     bool ok;
     if (const int id = atts.value(QLatin1String("id")).toInt(&ok); ok)
@@ -900,7 +939,7 @@ std::unique_ptr<TileLayer> MapReaderPrivate::readTileLayer()
     Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("layer"));
 
     const QXmlStreamAttributes atts = xml.attributes();
-    const QString name = atts.value(QLatin1String("name")).toString();
+    const QString name = internString(atts.value(QLatin1String("name")).toString());
     const int x = atts.value(QLatin1String("x")).toInt();
     const int y = atts.value(QLatin1String("y")).toInt();
     const int width = atts.value(QLatin1String("width")).toInt();
@@ -934,6 +973,8 @@ void MapReaderPrivate::readTileLayerData(TileLayer &tileLayer)
         layerDataFormat = Map::XML;
     } else if (encoding == QLatin1String("csv")) {
         layerDataFormat = Map::CSV;
+    } else if (encoding == QLatin1String("delta-vlq")) {
+        layerDataFormat = Map::DeltaVLQ;
     } else if (encoding == QLatin1String("base64")) {
         if (compression.isEmpty()) {
             layerDataFormat = Map::Base64;
@@ -1008,12 +1049,27 @@ void MapReaderPrivate::readTileLayerRect(TileLayer &tileLayer,
             }
         } else if (xml.isCharacters() && !xml.isWhitespace()) {
             if (encoding == QLatin1String("base64")) {
-                decodeBinaryLayerData(tileLayer,
-                                      xml.text().toLatin1(),
-                                      layerDataFormat,
-                                      bounds);
+                // Only whole chunks aligned to the internal chunk grid can
+                // have their decoding deferred
+                if (mDeferredChunkDecoding
+                        && bounds.width() == CHUNK_SIZE
+                        && bounds.height() == CHUNK_SIZE
+                        && (bounds.x() & CHUNK_MASK) == 0
+                        && (bounds.y() & CHUNK_MASK) == 0) {
+                    deferBinaryLayerData(tileLayer,
+                                         xml.text().toLatin1(),
+                                         layerDataFormat,
+                                         bounds);
+                } else {
+                    decodeBinaryLayerData(tileLayer,
+                                          xml.text().toLatin1(),
+                                          layerDataFormat,
+                                          bounds);
+                }
             } else if (encoding == QLatin1String("csv")) {
                 decodeCSVLayerData(tileLayer, xml.text(), bounds);
+            } else if (encoding == QLatin1String("delta-vlq")) {
+                decodeDeltaVLQLayerData(tileLayer, xml.text(), bounds);
             }
         }
     }
@@ -1043,6 +1099,27 @@ void MapReaderPrivate::decodeBinaryLayerData(TileLayer &tileLayer,
     }
 }
 
+/**
+ * Hands the raw chunk data to the tile layer, to be decoded when one of the
+ * chunk's cells is first accessed. The decoder snapshots the GID mapping,
+ * which keeps the referenced tilesets alive through their shared pointers.
+ */
+void MapReaderPrivate::deferBinaryLayerData(TileLayer &tileLayer,
+                                            const QByteArray &data,
+                                            Map::LayerDataFormat format,
+                                            QRect bounds)
+{
+    const GidMapper gidMapper = mGidMapper;
+
+    tileLayer.setChunkDecoder([gidMapper, format] (TileLayer &layer,
+                                                   const QByteArray &data,
+                                                   QRect bounds) {
+        gidMapper.decodeLayerData(layer, data, format, bounds);
+    });
+
+    tileLayer.addDeferredChunk(bounds.topLeft(), data);
+}
+
 void MapReaderPrivate::decodeCSVLayerData(TileLayer &tileLayer,
                                           QStringRef text,
                                           QRect bounds)
@@ -1089,6 +1166,95 @@ void MapReaderPrivate::decodeCSVLayerData(TileLayer &tileLayer,
     }
 }
 
+static int base64VLQDigit(char32_t c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+        return c - '0' + 52;
+    if (c == '+')
+        return 62;
+    if (c == '/')
+        return 63;
+    return -1;
+}
+
+/**
+ * Decodes plain text lines of delta-encoded base64 VLQ values, one line per
+ * row of the area. Each value holds the zigzag-encoded difference to the
+ * previous GID on the same line, in groups of five bits per character with
+ * the sixth bit marking continuation.
+ *
+ * The scan works on character values directly, without splitting the text
+ * or converting numbers from strings.
+ */
+void MapReaderPrivate::decodeDeltaVLQLayerData(TileLayer &tileLayer,
+                                               QStringRef text,
+                                               QRect bounds)
+{
+    int x = bounds.left();
+    int y = bounds.top();
+    unsigned previousGid = 0;
+    quint64 value = 0;
+    int shift = 0;
+
+    for (int i = 0, i_end = text.length(); i < i_end; ++i) {
+        const QChar currentChar = text.at(i);
+
+        if (currentChar == QLatin1Char('\n')) {
+            // Each row is delta-encoded independently
+            previousGid = 0;
+            continue;
+        }
+        if (currentChar.isSpace())
+            continue;
+
+        const int digit = base64VLQDigit(currentChar.unicode());
+        if (digit < 0) {
+            xml.raiseError(
+                    tr("Unable to parse tile at (%1,%2) on layer '%3': \"%4\"")
+                           .arg(x + 1).arg(y + 1).arg(tileLayer.name()).arg(currentChar));
+            return;
+        }
+
+        value |= quint64(digit & 0x1f) << shift;
+        if (digit & 0x20) {
+            shift += 5;
+            continue;
+        }
+
+        const qint64 delta = (value & 1) ? -qint64(value >> 1)
+                                         : qint64(value >> 1);
+        const unsigned gid = unsigned(qint64(previousGid) + delta);
+        previousGid = gid;
+        value = 0;
+        shift = 0;
+
+        if (y > bounds.bottom()) {
+            xml.raiseError(tr("Corrupt layer data for layer '%1'")
+                           .arg(tileLayer.name()));
+            return;
+        }
+
+        tileLayer.setCell(x, y, cellForGid(gid));
+
+        x++;
+        if (x > bounds.right()) {
+            x = bounds.left();
+            y++;
+        }
+    }
+
+    // A truncated value or too few cells also mean corrupt data
+    if (shift != 0 || y <= bounds.bottom()) {
+        xml.raiseError(tr("Corrupt layer data for layer '%1'")
+                       .arg(tileLayer.name()));
+        return;
+    }
+}
+
 Cell MapReaderPrivate::cellForGid(unsigned gid)
 {
     bool ok;
@@ -1109,7 +1275,7 @@ std::unique_ptr<ObjectGroup> MapReaderPrivate::readObjectGroup()
     Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("objectgroup"));
 
     const QXmlStreamAttributes atts = xml.attributes();
-    const QString name = atts.value(QLatin1String("name")).toString();
+    const QString name = internString(atts.value(QLatin1String("name")).toString());
     const int x = atts.value(QLatin1String("x")).toInt();
     const int y = atts.value(QLatin1String("y")).toInt();
 
@@ -1147,7 +1313,7 @@ std::unique_ptr<ImageLayer> MapReaderPrivate::readImageLayer()
     Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("imagelayer"));
 
     const QXmlStreamAttributes atts = xml.attributes();
-    const QString name = atts.value(QLatin1String("name")).toString();
+    const QString name = internString(atts.value(QLatin1String("name")).toString());
     const int x = atts.value(QLatin1String("x")).toInt();
     const int y = atts.value(QLatin1String("y")).toInt();
 
@@ -1187,7 +1353,7 @@ std::unique_ptr<MapObject> MapReaderPrivate::readObject()
 
     const QXmlStreamAttributes atts = xml.attributes();
     const int id = atts.value(QLatin1String("id")).toInt();
-    const QString name = atts.value(QLatin1String("name")).toString();
+    const QString name = internString(atts.value(QLatin1String("name")).toString());
     const unsigned gid = atts.value(QLatin1String("gid")).toUInt();
     const QString templateFileName = atts.value(QLatin1String("template")).toString();
     const qreal x = atts.value(QLatin1String("x")).toDouble();
@@ -1203,11 +1369,17 @@ std::unique_ptr<MapObject> MapReaderPrivate::readObject()
     const QPointF pos(x, y);
     const QSizeF size(width, height);
 
-    auto object = std::make_unique<MapObject>(name, className, pos, size);
+    auto object = std::make_unique<MapObject>(name, internString(className), pos, size);
 
     if (!templateFileName.isEmpty()) { // This object is a template instance
-        const QString absoluteFileName = p->resolveReference(templateFileName, mPath);
-        auto objectTemplate = TemplateManager::instance()->loadObjectTemplate(absoluteFileName);
+        // Cache the resolved template by its raw reference, since maps tend
+        // to instantiate the same few templates many times and resolving the
+        // path is relatively expensive.
+        ObjectTemplate *&objectTemplate = mResolvedTemplates[templateFileName];
+        if (!objectTemplate) {
+            const QString absoluteFileName = p->resolveReference(templateFileName, mPath);
+            objectTemplate = TemplateManager::instance()->loadObjectTemplate(absoluteFileName);
+        }
         object->setObjectTemplate(objectTemplate);
     }
 
@@ -1382,7 +1554,7 @@ std::unique_ptr<GroupLayer> MapReaderPrivate::readGroupLayer()
     Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("group"));
 
     const QXmlStreamAttributes atts = xml.attributes();
-    const QString name = atts.value(QLatin1String("name")).toString();
+    const QString name = internString(atts.value(QLatin1String("name")).toString());
     const int x = atts.value(QLatin1String("x")).toInt();
     const int y = atts.value(QLatin1String("y")).toInt();
 
@@ -1470,7 +1642,9 @@ void MapReaderPrivate::readProperty(Properties *properties, const ExportContext
         }
     }
 
-    properties->insert(propertyName, context.toPropertyValue(exportValue));
+    // Intern the name, since the same properties tend to be present on many
+    // objects.
+    properties->insert(internString(propertyName), context.toPropertyValue(exportValue));
 }
 
 
@@ -1486,6 +1660,7 @@ MapReader::~MapReader()
 
 std::unique_ptr<Map> MapReader::readMap(QIODevice *device, const QString &path)
 {
+    TILED_PROFILE_SCOPE("MapReader::readMap");
     return d->readMap(device, path);
 }
 
@@ -1501,8 +1676,11 @@ std::unique_ptr<Map> MapReader::readMap(const QString &fileName)
 SharedTileset MapReader::readTileset(QIODevice *device, const QString &path)
 {
     SharedTileset tileset = d->readTileset(device, path);
-    if (tileset && !tileset->isCollection())
+#ifndef TILED_HEADLESS
+    if (tileset && !tileset->isCollection()
+            && !TilesetManager::instance()->deferredImageLoading())
         tileset->loadImage();
+#endif
 
     return tileset;
 }
@@ -1539,6 +1717,16 @@ QString MapReader::errorString() const
     return d->errorString();
 }
 
+void MapReader::setDeferredChunkDecoding(bool deferred)
+{
+    d->mDeferredChunkDecoding = deferred;
+}
+
+bool MapReader::deferredChunkDecoding() const
+{
+    return d->mDeferredChunkDecoding;
+}
+
 QString MapReader::resolveReference(const QString &reference,
                                     const QDir &mapDir)
 {
@@ -95,6 +95,18 @@ public:
      */
     QString errorString() const;
 
+    /**
+     * Sets whether base64-encoded chunk data is kept as-is and only decoded
+     * when the cells of a chunk are first accessed. Disabled by default.
+     *
+     * This avoids decompressing and converting off-screen chunks when
+     * opening large maps, at the cost of delayed error detection: invalid
+     * tile references in deferred chunks no longer fail the load but
+     * resolve to empty cells once the chunk is decoded.
+     */
+    void setDeferredChunkDecoding(bool deferred);
+    bool deferredChunkDecoding() const;
+
     std::unique_ptr<ObjectTemplate> readObjectTemplate(QIODevice *device, const QString &path = QString());
     std::unique_ptr<ObjectTemplate> readObjectTemplate(const QString &fileName);
 
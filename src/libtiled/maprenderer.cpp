@@ -27,26 +27,40 @@
  */
 
 #include "maprenderer.h"
+#include "maprenderer_p.h"
 
 #include "imagelayer.h"
 #include "isometricrenderer.h"
 #include "map.h"
 #include "mapobject.h"
+#include "memorybudget.h"
 #include "objectgroup.h"
 #include "orthogonalrenderer.h"
+#include "profiler.h"
 #include "staggeredrenderer.h"
 #include "tile.h"
 #include "tilelayer.h"
 
 #include <QCache>
+#include <QMutex>
 #include <QPaintEngine>
 #include <QPainter>
+#include <QStaticText>
 #include <QVector2D>
 
 #include <cmath>
 
 using namespace Tiled;
 
+bool RenderStatistics::enabled = false;
+
+std::atomic<qint64> RenderStatistics::cellsDrawn { 0 };
+std::atomic<qint64> RenderStatistics::batchesDrawn { 0 };
+std::atomic<qint64> RenderStatistics::pixmapCacheHits { 0 };
+std::atomic<qint64> RenderStatistics::pixmapCacheMisses { 0 };
+std::atomic<qint64> RenderStatistics::chunkBlits { 0 };
+std::atomic<qint64> RenderStatistics::chunkRenders { 0 };
+
 struct TintedKey
 {
     const qint64 key;
@@ -69,6 +83,34 @@ size_t qHash(const TintedKey &key, size_t seed) Q_DECL_NOTHROW
     return h;
 }
 
+// Guards the static pixmap caches below. They are shared by every thread
+// that renders through a MapRenderer (parallel rasterization bands,
+// background map rendering), and QCache is not thread-safe. The lock is
+// never held while computing a missing entry or while enforcing the memory
+// budget, only around the cache accesses themselves.
+static QMutex sPixmapCacheMutex;
+
+/**
+ * Registers a pixmap cache with the memory budget. Trimming temporarily
+ * lowers the maximum cost, which makes the QCache evict its
+ * least-recently-used entries.
+ */
+template <typename Key>
+static void registerPixmapCache(const QString &name, QCache<Key, QPixmap> &cache)
+{
+    MemoryBudget::registerCache(name,
+                                [&cache] {
+        const QMutexLocker locker(&sPixmapCacheMutex);
+        return static_cast<qint64>(cache.totalCost()) * 1024;
+    },
+                                [&cache] (qint64 targetBytes) {
+        const QMutexLocker locker(&sPixmapCacheMutex);
+        const auto maxCost = cache.maxCost();
+        cache.setMaxCost(qMax(0, int(targetBytes / 1024)));
+        cache.setMaxCost(maxCost);
+    });
+}
+
 // Borrowed from qpixmapcache.cpp
 static inline qsizetype cost(const QPixmap &pixmap)
 {
@@ -80,6 +122,140 @@ static inline qsizetype cost(const QPixmap &pixmap)
     return static_cast<qsizetype>(qBound(1LL, costKb, costMax));
 }
 
+struct TextKey
+{
+    const QString text;
+    const QString fontKey;
+    const int alignment;
+    const bool wordWrap;
+    const qreal width;
+
+    bool operator==(const TextKey &o) const
+    {
+        return text == o.text
+                && fontKey == o.fontKey
+                && alignment == o.alignment
+                && wordWrap == o.wordWrap
+                && width == o.width;
+    }
+};
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+uint qHash(const TextKey &key, uint seed) Q_DECL_NOTHROW
+#else
+size_t qHash(const TextKey &key, size_t seed) Q_DECL_NOTHROW
+#endif
+{
+    auto h = ::qHash(key.text, seed);
+    h = ::qHash(key.fontKey, h);
+    h = ::qHash(key.alignment, h);
+    h = ::qHash(key.wordWrap, h);
+    h = ::qHash(key.width, h);
+    return h;
+}
+
+struct MipKey {
+    const qint64 key;
+    const int level;
+
+    bool operator==(const MipKey &o) const
+    {
+        return key == o.key && level == o.level;
+    }
+};
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+uint qHash(const MipKey &key, uint seed) Q_DECL_NOTHROW
+#else
+size_t qHash(const MipKey &key, size_t seed) Q_DECL_NOTHROW
+#endif
+{
+    auto h = ::qHash(key.key, seed);
+    h = ::qHash(key.level, h);
+    return h;
+}
+
+/**
+ * Returns the given \a pixmap downscaled by a factor of 2^level, built by
+ * successive halving. The levels are cached, to avoid smoothly minifying
+ * full-resolution tileset images over and over while the map is zoomed out.
+ */
+static QPixmap mipmapped(const QPixmap &pixmap, int level)
+{
+    if (level <= 0 || pixmap.isNull())
+        return pixmap;
+
+    // Cache for up to 50 MB of downscaled pixmaps
+    static QCache<MipKey, QPixmap> cache { 50 * 1024 };
+    static const bool registered = [] {
+        registerPixmapCache(QStringLiteral("mipmaps"), cache);
+        return true;
+    }();
+    Q_UNUSED(registered)
+
+    const MipKey mipKey { pixmap.cacheKey(), level };
+    {
+        const QMutexLocker locker(&sPixmapCacheMutex);
+        if (auto cached = cache.object(mipKey)) {
+            if (RenderStatistics::enabled)
+                ++RenderStatistics::pixmapCacheHits;
+            return *cached;
+        }
+    }
+
+    if (RenderStatistics::enabled)
+        ++RenderStatistics::pixmapCacheMisses;
+
+    const QPixmap lower = mipmapped(pixmap, level - 1);
+    if (lower.width() <= 1 && lower.height() <= 1)
+        return lower;
+
+    // Scaling happens outside the lock. Two threads may race to produce the
+    // same level, in which case the later insert simply replaces the entry.
+    const QPixmap result = lower.scaled((lower.width() + 1) / 2,
+                                        (lower.height() + 1) / 2,
+                                        Qt::IgnoreAspectRatio,
+                                        Qt::SmoothTransformation);
+
+    {
+        const QMutexLocker locker(&sPixmapCacheMutex);
+        cache.insert(mipKey, new QPixmap(result), cost(result));
+    }
+    MemoryBudget::enforce();
+    return result;
+}
+
+/**
+ * Returns the mipmap level suited for drawing pixmaps with the given
+ * \a painter, or 0 when the painter's transform doesn't minify or mipmaps
+ * shouldn't be used (nearest-neighbor scaling was requested, or the
+ * transform involves rotation or shearing).
+ *
+ * Takes the device pixel ratio into account, since on high-DPI displays the
+ * device covers more pixels than the world transform suggests.
+ */
+static int mipLevelForPainter(const QPainter *painter)
+{
+    if (!painter->renderHints().testFlag(QPainter::SmoothPixmapTransform))
+        return 0;
+
+    const QTransform &transform = painter->worldTransform();
+    if (transform.type() > QTransform::TxScale)
+        return 0;
+
+    qreal scale = qMin(qAbs(transform.m11()), qAbs(transform.m22()));
+    if (const QPaintDevice *device = painter->device())
+        scale *= device->devicePixelRatioF();
+
+    if (scale <= 0)
+        return 0;
+
+    int level = 0;
+    while (level < 3 && scale * (1 << (level + 1)) <= 1.0)
+        ++level;
+    return level;
+}
+
 static QPixmap tinted(const QPixmap &pixmap, const QColor &color)
 {
     if (!color.isValid() || color == QColor(255, 255, 255, 255) || pixmap.isNull())
@@ -87,10 +263,24 @@ static QPixmap tinted(const QPixmap &pixmap, const QColor &color)
 
     // Cache for up to 100 MB of tinted pixmaps, since tinting is expensive
     static QCache<TintedKey, QPixmap> cache { 100 * 1024 };
+    static const bool registered = [] {
+        registerPixmapCache(QStringLiteral("tinted"), cache);
+        return true;
+    }();
+    Q_UNUSED(registered)
 
     const TintedKey tintedKey { pixmap.cacheKey(), color };
-    if (auto cached = cache.object(tintedKey))
-        return *cached;
+    {
+        const QMutexLocker locker(&sPixmapCacheMutex);
+        if (auto cached = cache.object(tintedKey)) {
+            if (RenderStatistics::enabled)
+                ++RenderStatistics::pixmapCacheHits;
+            return *cached;
+        }
+    }
+
+    if (RenderStatistics::enabled)
+        ++RenderStatistics::pixmapCacheMisses;
 
     QPixmap resultImage = pixmap;
     QPainter painter(&resultImage);
@@ -113,7 +303,11 @@ static QPixmap tinted(const QPixmap &pixmap, const QColor &color)
 
     painter.end();
 
-    cache.insert(tintedKey, new QPixmap(resultImage), cost(resultImage));
+    {
+        const QMutexLocker locker(&sPixmapCacheMutex);
+        cache.insert(tintedKey, new QPixmap(resultImage), cost(resultImage));
+    }
+    MemoryBudget::enforce();
 
     return resultImage;
 }
@@ -227,6 +421,52 @@ void MapRenderer::drawPointObject(QPainter *painter, const QColor &color) const
     painter->drawEllipse(QRectF(-smallRadius, -smallRadius, smallRadius * 2, smallRadius * 2));
 }
 
+/**
+ * Draws the text of a text object within \a bounds using the \a painter.
+ *
+ * The laid out text is kept in a cache of QStaticText instances, so that
+ * repainting a text object does not repeat the font shaping and line
+ * breaking every frame. The cache is keyed on the text contents and style,
+ * which also takes care of invalidation when a text object is edited. The
+ * layout is resolution-independent, so it remains valid across zoom levels.
+ */
+void MapRenderer::drawTextObject(QPainter *painter,
+                                 const TextData &textData,
+                                 const QRectF &bounds)
+{
+    // Cache the layout of up to 4096 distinct texts. Per-thread rather than
+    // mutex-guarded, because QStaticText lazily lays itself out when drawn
+    // and therefore cannot be shared between render threads.
+    static thread_local QCache<TextKey, QStaticText> cache { 4096 };
+
+    const TextKey textKey { textData.text, textData.font.key(),
+                            int(textData.alignment), textData.wordWrap,
+                            bounds.width() };
+
+    QStaticText *staticText = cache.object(textKey);
+    if (!staticText) {
+        staticText = new QStaticText(textData.text);
+        staticText->setTextOption(textData.textOption());
+        staticText->setTextWidth(bounds.width());
+        cache.insert(textKey, staticText);
+    }
+
+    // QStaticText only handles horizontal alignment, so the vertical
+    // alignment is applied by offsetting the draw position.
+    qreal dy = 0.0;
+    if (textData.alignment & Qt::AlignBottom)
+        dy = bounds.height() - staticText->size().height();
+    else if (textData.alignment & Qt::AlignVCenter)
+        dy = (bounds.height() - staticText->size().height()) / 2;
+
+    painter->save();
+    painter->setClipRect(bounds, Qt::IntersectClip);
+    painter->setFont(textData.font);
+    painter->setPen(textData.color);
+    painter->drawStaticText(bounds.topLeft() + QPointF(0, dy), *staticText);
+    painter->restore();
+}
+
 QPainterPath MapRenderer::pointInteractionShape(const MapObject *object) const
 {
     Q_ASSERT(object->shape() == MapObject::Point);
@@ -250,42 +490,11 @@ QPointF MapRenderer::snapToGrid(const QPointF &pixelCoords, int subdivisions) co
 
 void MapRenderer::drawTileLayer(QPainter *painter, const TileLayer *layer, const QRectF &exposed) const
 {
-    const QSize tileSize = map()->tileSize();
-
-    // Don't draw more than the bounding rectangle of the given layer,
-    // intersected with the exposed rectangle.
-    QRect rect = boundingRect(layer->bounds());
-    if (!exposed.isNull())
-        rect &= exposed.toAlignedRect();
-
-    // Draw margins extend the rendered area on the opposite side. We subtract
-    // the grid size because this has already been taken into account by
-    // boundingRect.
-    QMargins drawMargins = layer->drawMargins();
-    drawMargins.setTop(qMax(0, drawMargins.top() - tileSize.height()));
-    drawMargins.setRight(qMax(0, drawMargins.right() - tileSize.width()));
-    rect.adjust(-drawMargins.right(),
-                -drawMargins.bottom(),
-                drawMargins.left(),
-                drawMargins.top());
-
-    CellRenderer renderer(painter, this, layer->effectiveTintColor());
-
-    auto tileRenderFunction = [layer, &renderer, tileSize](QPoint tilePos, const QPointF &screenPos) {
-        const Cell &cell = layer->cellAt(tilePos - layer->position());
-        if (!cell.isEmpty()) {
-            QSize size = tileSize;
-
-            if (cell.tileset()->tileRenderSize() == Tileset::TileSize) {
-                if (const Tile *tile = cell.tile())
-                    size = tile->size();
-            }
-
-            renderer.render(cell, screenPos, size, CellRenderer::BottomLeft);
-        }
-    };
-
-    drawTileLayer(tileRenderFunction, rect);
+    TILED_PROFILE_SCOPE("MapRenderer::drawTileLayer");
+    renderTileLayer(*this, painter, layer, exposed,
+                    [this] (const RenderTileCallback &renderTile, const QRectF &rect) {
+        drawTileLayer(renderTile, rect);
+    });
 }
 
 void MapRenderer::setFlag(RenderFlag flag, bool enabled)
@@ -378,6 +587,48 @@ static void renderMissingImageMarker(QPainter &painter, const QRectF &rect)
     painter.restore();
 }
 
+/**
+ * Per flip-state constants for building a pixmap fragment. A cell has only
+ * 16 visual flag combinations, so the branchy decoding of its flags into a
+ * rotation and scale signs is done once in these tables instead of per
+ * rendered cell.
+ */
+struct FlipState
+{
+    qint16 rotation;
+    qint8 signX;
+    qint8 signY;
+    bool swapsHalfSize;     // the 90° rotation swaps the image dimensions
+};
+
+// Indexed by Cell::flags() for rectangular and isometric cells, where the
+// anti-diagonal flag (bit 4) means a 90° rotation combined with remapped
+// horizontal and vertical flips. The hexagonal 120° rotation flag (bit 8)
+// does not apply and is ignored.
+static constexpr FlipState orthogonalFlipStates[16] = {
+    {  0,  1,  1, false }, {  0, -1,  1, false },
+    {  0,  1, -1, false }, {  0, -1, -1, false },
+    { 90,  1, -1, true  }, { 90,  1,  1, true  },
+    { 90, -1, -1, true  }, { 90, -1,  1, true  },
+    {  0,  1,  1, false }, {  0, -1,  1, false },
+    {  0,  1, -1, false }, {  0, -1, -1, false },
+    { 90,  1, -1, true  }, { 90,  1,  1, true  },
+    { 90, -1, -1, true  }, { 90, -1,  1, true  },
+};
+
+// Indexed by Cell::flags() for hexagonal cells, where the anti-diagonal
+// flag (bit 4) means a 60° rotation and bit 8 adds a 120° rotation
+static constexpr FlipState hexagonalFlipStates[16] = {
+    {   0,  1,  1, false }, {   0, -1,  1, false },
+    {   0,  1, -1, false }, {   0, -1, -1, false },
+    {  60,  1,  1, false }, {  60, -1,  1, false },
+    {  60,  1, -1, false }, {  60, -1, -1, false },
+    { 120,  1,  1, false }, { 120, -1,  1, false },
+    { 120,  1, -1, false }, { 120, -1, -1, false },
+    { 180,  1,  1, false }, { 180, -1,  1, false },
+    { 180,  1, -1, false }, { 180, -1, -1, false },
+};
+
 static bool hasOpenGLEngine(const QPainter *painter)
 {
     if (auto paintEngine = painter->paintEngine()) {
@@ -394,6 +645,7 @@ CellRenderer::CellRenderer(QPainter *painter, const MapRenderer *renderer, const
     , mTile(nullptr)
     , mIsOpenGL(hasOpenGLEngine(painter))
     , mTintColor(tintColor)
+    , mMipLevel(mipLevelForPainter(painter))
 {
 }
 
@@ -425,11 +677,6 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
         return;
     }
 
-    // The USHRT_MAX limit is rather arbitrary but avoids a crash in
-    // drawPixmapFragments for a large number of fragments.
-    if (mTile != tile || mFragments.size() == USHRT_MAX)
-        flush();
-
     const QPixmap &image = tile->image();
     const QRect imageRect = tile->imageRect();
     if (imageRect.isEmpty())
@@ -438,9 +685,6 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
     const QPoint offset = tile->offset();
     const QPointF sizeHalf { size.width() / 2, size.height() / 2 };
 
-    bool flippedHorizontally = cell.flippedHorizontally();
-    bool flippedVertically = cell.flippedVertically();
-
     QPainter::PixmapFragment fragment;
     // Calculate the position as if the origin is TopLeft, and correct it later.
     fragment.x = screenPos.x() + sizeHalf.x();
@@ -468,38 +712,91 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
     if (origin == BottomLeft)
         fragment.y -= size.height();
 
-    if (mRenderer->cellType() == MapRenderer::HexagonalCells) {
+    const FlipState &flip =
+            (mRenderer->cellType() == MapRenderer::HexagonalCells
+             ? hexagonalFlipStates
+             : orthogonalFlipStates)[cell.flags()];
 
-        if (cell.flippedAntiDiagonally())
-            fragment.rotation += 60;
-
-        if (cell.rotatedHexagonal120())
-            fragment.rotation += 120;
-
-    } else if (cell.flippedAntiDiagonally()) {
-        fragment.rotation = 90;
-
-        flippedHorizontally = flippedVertically;
-        flippedVertically = !cell.flippedHorizontally();
+    fragment.rotation = flip.rotation;
 
+    if (flip.swapsHalfSize) {
         // Compensate for the swap of image dimensions
         const qreal halfDiff = sizeHalf.y() - sizeHalf.x();
         fragment.y += halfDiff;
         fragment.x += halfDiff;
     }
 
-    fragment.scaleX *= flippedHorizontally ? -1 : 1;
-    fragment.scaleY *= flippedVertically ? -1 : 1;
+    fragment.scaleX *= flip.signX;
+    fragment.scaleY *= flip.signY;
 
     // Avoid using drawPixmapFragments with OpenGL in Qt 6.4.1 and above
     // (https://bugreports.qt.io/browse/QTBUG-111416)
 #if QT_VERSION < QT_VERSION_CHECK(6, 4, 1)
-    if (mIsOpenGL || (fragment.scaleX > 0 && fragment.scaleY > 0)) {
+    const bool drawableFragment = mIsOpenGL || (fragment.scaleX > 0 && fragment.scaleY > 0);
 #else
-    if (!mIsOpenGL && fragment.scaleX > 0 && fragment.scaleY > 0) {
+    const bool drawableFragment = !mIsOpenGL && fragment.scaleX > 0 && fragment.scaleY > 0;
 #endif
-        mTile = tile;
-        mFragments.append(fragment);
+
+    if (drawableFragment) {
+        // The collision shape overlay derives its shapes from the batch
+        // tile, so it needs batches that never span different tiles
+        const bool perTileBatches = mRenderer->flags().testFlag(ShowTileCollisionShapes);
+
+        // A fragment that exactly covers its grid cell cannot overlap any
+        // other such fragment, so those can be drawn in any order. They are
+        // gathered into one batch per tileset image, so that layers
+        // interleaving tiles from several tilesets still submit a handful
+        // of batches per paint instead of flushing at every switch. The
+        // flip state is encoded per fragment and never splits a batch.
+        //
+        // Only orthogonal maps have non-overlapping grid cells; isometric
+        // and staggered cells overlap their neighbors even at grid size
+        // (note that both of those use OrthogonalCells, which is about flip
+        // handling rather than the projection).
+        const bool reorderSafe = !perTileBatches
+                && mRenderer->map()->orientation() == Map::Orthogonal
+                && fragment.rotation == 0
+                && offset.isNull()
+                && size == QSizeF(mRenderer->map()->tileSize());
+
+        const qint64 cacheKey = image.cacheKey();
+
+        // At most one of the two batch stores holds fragments at any time,
+        // which keeps the draw order between reorderable and fixed-order
+        // fragments intact.
+        if (reorderSafe) {
+            if (mTile)
+                flush();
+
+            Batch *batch = nullptr;
+            for (Batch &candidate : mBatches) {
+                if (candidate.cacheKey == cacheKey) {
+                    batch = &candidate;
+                    break;
+                }
+            }
+            if (!batch) {
+                mBatches.append(Batch { cacheKey, tile, {} });
+                batch = &mBatches.last();
+            }
+
+            batch->fragments.append(fragment);
+
+            // The USHRT_MAX limit is rather arbitrary but avoids a crash
+            // in drawPixmapFragments for a large number of fragments.
+            if (batch->fragments.size() == USHRT_MAX)
+                flushBatches();
+        } else {
+            flushBatches();
+
+            if (mFragments.size() == USHRT_MAX
+                    || (perTileBatches ? mTile != tile
+                                       : !mTile || mTile->image().cacheKey() != cacheKey))
+                flush();
+
+            mTile = tile;
+            mFragments.append(fragment);
+        }
         return;
     }
 
@@ -519,10 +816,29 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
     const QRectF source(fragment.sourceLeft, fragment.sourceTop,
                         fragment.width, fragment.height);
 
+    QPixmap drawImage = tinted(image, mTintColor);
+    QRectF drawSource = source;
+
+    if (mMipLevel > 0) {
+        const QPixmap mip = mipmapped(drawImage, mMipLevel);
+        if (!mip.isNull() && mip.width() < drawImage.width()) {
+            const qreal fx = qreal(mip.width()) / drawImage.width();
+            const qreal fy = qreal(mip.height()) / drawImage.height();
+            drawSource = QRectF(source.x() * fx, source.y() * fy,
+                                source.width() * fx, source.height() * fy);
+            drawImage = mip;
+        }
+    }
+
     mPainter->setTransform(transform);
-    mPainter->drawPixmap(target, tinted(image, mTintColor), source);
+    mPainter->drawPixmap(target, drawImage, drawSource);
     mPainter->setTransform(oldTransform);
 
+    if (RenderStatistics::enabled) {
+        ++RenderStatistics::cellsDrawn;
+        ++RenderStatistics::batchesDrawn;
+    }
+
     // A bit of a hack to still draw tile collision shapes when requested
     if (mRenderer->flags().testFlag(ShowTileCollisionShapes)
             && tile->objectGroup()
@@ -540,12 +856,12 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
  */
 void CellRenderer::flush()
 {
+    flushBatches();
+
     if (!mTile)
         return;
 
-    mPainter->drawPixmapFragments(mFragments.constData(),
-                                  mFragments.size(),
-                                  tinted(mTile->image(), mTintColor));
+    drawFragments(mFragments, mTile);
 
     if (mRenderer->flags().testFlag(ShowTileCollisionShapes)
             && mTile->objectGroup()
@@ -558,30 +874,62 @@ void CellRenderer::flush()
 }
 
 /**
- * Returns a transform that rotates by \a rotation degrees around the given
- * \a position.
+ * Submits the pending per-tileset batches, in the order in which their
+ * first fragment arrived.
  */
-static QTransform rotateAt(const QPointF &position, qreal rotation)
+void CellRenderer::flushBatches()
 {
-    QTransform transform;
-    transform.translate(position.x(), position.y());
-    transform.rotate(rotation);
-    transform.translate(-position.x(), -position.y());
-    return transform;
+    for (const Batch &batch : std::as_const(mBatches))
+        drawFragments(batch.fragments, batch.tile);
+    mBatches.clear();
+}
+
+void CellRenderer::drawFragments(const QVector<QPainter::PixmapFragment> &fragments,
+                                 const Tile *tile)
+{
+    if (RenderStatistics::enabled) {
+        RenderStatistics::cellsDrawn += fragments.size();
+        ++RenderStatistics::batchesDrawn;
+    }
+
+    const QPixmap image = tinted(tile->image(), mTintColor);
+
+    if (mMipLevel > 0) {
+        const QPixmap mip = mipmapped(image, mMipLevel);
+        if (!mip.isNull() && mip.width() < image.width()) {
+            const qreal fx = qreal(mip.width()) / image.width();
+            const qreal fy = qreal(mip.height()) / image.height();
+
+            // Adjusted on a copy, since paintTileCollisionShapes reads the
+            // original fragment geometry
+            QVector<QPainter::PixmapFragment> adjusted = fragments;
+            for (QPainter::PixmapFragment &fragment : adjusted) {
+                fragment.sourceLeft *= fx;
+                fragment.sourceTop *= fy;
+                fragment.width *= fx;
+                fragment.height *= fy;
+                fragment.scaleX /= fx;
+                fragment.scaleY /= fy;
+            }
+
+            mPainter->drawPixmapFragments(adjusted.constData(),
+                                          adjusted.size(), mip);
+            return;
+        }
+    }
+
+    mPainter->drawPixmapFragments(fragments.constData(),
+                                  fragments.size(), image);
 }
 
 void CellRenderer::paintTileCollisionShapes()
 {
     const Tileset *tileset = mTile->tileset();
     const bool isIsometric = tileset->orientation() == Tileset::Isometric;
-    Map::Parameters mapParameters;
-    mapParameters.orientation = isIsometric ? Map::Isometric : Map::Orthogonal;
-    mapParameters.width = 1;
-    mapParameters.height = 1;
-    mapParameters.tileWidth = tileset->gridSize().width();
-    mapParameters.tileHeight = tileset->gridSize().height();
-    const Map map(mapParameters);
-    const auto renderer = MapRenderer::create(&map);
+
+    // Built once per tile and cached, rather than derived again per paint
+    const QVector<QPainterPath> &shapes = mTile->collisionShapes();
+    const auto &objects = mTile->objectGroup()->objects();
 
     const qreal lineWidth = mRenderer->objectLineWidth();
     const qreal shadowDist = (lineWidth == 0 ? 1 : lineWidth) / mRenderer->painterScale();
@@ -606,7 +954,8 @@ void CellRenderer::paintTileCollisionShapes()
         if (isIsometric)
             tileTransform.translate(0, fragment.height - tileset->gridSize().height());
 
-        for (MapObject *object : mTile->objectGroup()->objects()) {
+        for (int i = 0; i < shapes.size(); ++i) {
+            MapObject *object = objects.at(i);
             QColor penColor = object->effectiveColor();
             QColor brushColor = penColor;
             brushColor.setAlpha(50);
@@ -616,11 +965,7 @@ void CellRenderer::paintTileCollisionShapes()
             mPainter->setPen(colorPen);
             mPainter->setBrush(brushColor);
 
-            auto transform = rotateAt(renderer->pixelToScreenCoords(object->position()),
-                                      object->rotation());
-            transform *= tileTransform;
-
-            const auto shape = transform.map(renderer->shape(object));
+            const auto shape = tileTransform.map(shapes.at(i));
 
             mPainter->strokePath(shape.translated(shadowOffset), shadowPen);
 
@@ -31,6 +31,7 @@
 #include "mapobject.h"
 #include "tiled_global.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
 
@@ -55,6 +56,26 @@ enum RenderFlag {
 
 Q_DECLARE_FLAGS(RenderFlags, RenderFlag)
 
+/**
+ * Counters over the work done by CellRenderer, used by diagnostics like the
+ * render statistics overlay in the map view.
+ *
+ * Collection is skipped entirely unless \a enabled is set. The counters are
+ * atomic since rendering may happen on multiple threads, but \a enabled
+ * should only be toggled from the main thread.
+ */
+struct TILEDSHARED_EXPORT RenderStatistics
+{
+    static bool enabled;
+
+    static std::atomic<qint64> cellsDrawn;
+    static std::atomic<qint64> batchesDrawn;
+    static std::atomic<qint64> pixmapCacheHits;
+    static std::atomic<qint64> pixmapCacheMisses;
+    static std::atomic<qint64> chunkBlits;
+    static std::atomic<qint64> chunkRenders;
+};
+
 /**
  * This interface is used for rendering tile layers and retrieving associated
  * metrics. The different implementations deal with different map
@@ -148,9 +169,12 @@ public:
      *
      * Optionally, you can pass in the \a exposed rect (of pixels), so that
      * only tiles that can be visible in this area will be drawn.
+     *
+     * Concrete renderers override this to instantiate their tile loop with
+     * the cell rendering inlined, saving an indirect call per tile.
      */
-    void drawTileLayer(QPainter *painter, const TileLayer *layer,
-                       const QRectF &exposed = QRectF()) const;
+    virtual void drawTileLayer(QPainter *painter, const TileLayer *layer,
+                               const QRectF &exposed = QRectF()) const;
 
     /**
      * Calls the given \a renderTile callback for each tile in the given
@@ -189,6 +213,13 @@ public:
      */
     void drawPointObject(QPainter *painter, const QColor &color) const;
 
+    /**
+     * Draws the text of a text object within \a bounds using the \a painter.
+     */
+    static void drawTextObject(QPainter *painter,
+                               const TextData &textData,
+                               const QRectF &bounds);
+
     /**
      * Draws the given image \a layer using the given \a painter.
      */
@@ -340,14 +371,27 @@ public:
     void flush();
 
 private:
+    void flushBatches();
+    void drawFragments(const QVector<QPainter::PixmapFragment> &fragments,
+                       const Tile *tile);
     void paintTileCollisionShapes();
 
+    // One pending batch of freely reorderable fragments per tileset image
+    // (see the reorder-safe handling in render)
+    struct Batch {
+        qint64 cacheKey;
+        const Tile *tile;
+        QVector<QPainter::PixmapFragment> fragments;
+    };
+
     QPainter * const mPainter;
     const MapRenderer * const mRenderer;
     const Tile *mTile;
     QVector<QPainter::PixmapFragment> mFragments;
+    QVector<Batch> mBatches;
     const bool mIsOpenGL;
     const QColor mTintColor;
+    const int mMipLevel;
 };
 
 } // namespace Tiled
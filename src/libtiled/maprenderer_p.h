@@ -0,0 +1,94 @@
+/*
+ * maprenderer_p.h
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "map.h"
+#include "maprenderer.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+namespace Tiled {
+
+/**
+ * Shared implementation of the QPainter-based tile layer drawing.
+ *
+ * This is the preamble common to all map orientations: limiting the drawn
+ * area based on the layer bounds and draw margins, and turning each visited
+ * cell into a CellRenderer call. The per-orientation tile loop is passed in
+ * as \a drawTileLayer, which receives the render function as a concrete
+ * functor. This way the concrete renderers can instantiate their loops with
+ * the render function inlined, avoiding an indirect call per tile.
+ */
+template <typename DrawTileLayer>
+void renderTileLayer(const MapRenderer &renderer,
+                     QPainter *painter,
+                     const TileLayer *layer,
+                     const QRectF &exposed,
+                     DrawTileLayer &&drawTileLayer)
+{
+    const QSize tileSize = renderer.map()->tileSize();
+
+    // Don't draw more than the bounding rectangle of the given layer,
+    // intersected with the exposed rectangle.
+    QRect rect = renderer.boundingRect(layer->bounds());
+    if (!exposed.isNull())
+        rect &= exposed.toAlignedRect();
+
+    // Draw margins extend the rendered area on the opposite side. We subtract
+    // the grid size because this has already been taken into account by
+    // boundingRect.
+    QMargins drawMargins = layer->drawMargins();
+    drawMargins.setTop(qMax(0, drawMargins.top() - tileSize.height()));
+    drawMargins.setRight(qMax(0, drawMargins.right() - tileSize.width()));
+    rect.adjust(-drawMargins.right(),
+                -drawMargins.bottom(),
+                drawMargins.left(),
+                drawMargins.top());
+
+    CellRenderer cellRenderer(painter, &renderer, layer->effectiveTintColor());
+
+    auto tileRenderFunction = [layer, &cellRenderer, tileSize](QPoint tilePos, const QPointF &screenPos) {
+        const Cell &cell = layer->cellAt(tilePos - layer->position());
+        if (!cell.isEmpty()) {
+            QSize size = tileSize;
+
+            if (cell.tileset()->tileRenderSize() == Tileset::TileSize) {
+                if (const Tile *tile = cell.tile())
+                    size = tile->size();
+            }
+
+            cellRenderer.render(cell, screenPos, size, CellRenderer::BottomLeft);
+        }
+    };
+
+    drawTileLayer(tileRenderFunction, rect);
+}
+
+} // namespace Tiled
@@ -111,11 +111,13 @@ QVariant MapToVariantConverter::toVariant(const Map &map, const QDir &mapDir)
 
     QVariantList tilesetVariants;
 
-    unsigned firstGid = 1;
-    for (const SharedTileset &tileset : map.tilesets()) {
-        tilesetVariants << toVariant(*tileset, firstGid);
-        mGidMapper.insert(firstGid, tileset);
-        firstGid += tileset->nextTileId();
+    // Reuse the firstGid assignment cached on the map, so that saving again
+    // without tileset changes skips recomputing the layout
+    const QVector<unsigned> &firstGids = map.tilesetFirstGids();
+    const QVector<SharedTileset> &tilesets = map.tilesets();
+    for (int i = 0; i < tilesets.size(); ++i) {
+        tilesetVariants << toVariant(*tilesets.at(i), firstGids.at(i));
+        mGidMapper.insert(firstGids.at(i), tilesets.at(i));
     }
     mapVariant[QStringLiteral("tilesets")] = tilesetVariants;
 
@@ -488,6 +490,7 @@ QVariant MapToVariantConverter::toVariant(const TileLayer &tileLayer,
     switch (format) {
     case Map::XML:
     case Map::CSV:
+    case Map::DeltaVLQ:
         break;
     case Map::Base64:
     case Map::Base64Zlib:
@@ -731,7 +734,19 @@ void MapToVariantConverter::addTileLayerData(QVariantMap &variant,
 {
     switch (format) {
     case Map::XML:
-    case Map::CSV: {
+    case Map::CSV:
+    case Map::DeltaVLQ: {
+        if (mTypedTileData) {
+            QVector<unsigned> gids;
+            gids.reserve(bounds.width() * bounds.height());
+            for (int y = bounds.top(); y <= bounds.bottom(); ++y)
+                for (int x = bounds.left(); x <= bounds.right(); ++x)
+                    gids.append(mGidMapper.cellToGid(tileLayer.cellAt(x, y)));
+
+            variant[QStringLiteral("data")] = QVariant::fromValue(gids);
+            break;
+        }
+
         QVariantList tileVariants;
         for (int y = bounds.top(); y <= bounds.bottom(); ++y)
             for (int x = bounds.left(); x <= bounds.right(); ++x)
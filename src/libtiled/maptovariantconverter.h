@@ -49,6 +49,18 @@ public:
         : mVersion(version)
     {}
 
+    /**
+     * Sets whether tile layer data for the text-based formats is stored as
+     * a QVector<unsigned> in a single QVariant, rather than as a
+     * QVariantList boxing every GID separately. This avoids the dominant
+     * allocation cost when converting large maps, but is only suitable for
+     * consumers that handle the typed vector, like the JsonWriter used by
+     * the JSON map formats. Generic consumers (QJsonValue::fromVariant,
+     * QCborValue::fromVariant) should leave it disabled.
+     */
+    void setTypedTileData(bool typedTileData)
+    { mTypedTileData = typedTileData; }
+
     /**
      * Converts the given \a map to a QVariant. The \a mapDir is used to
      * construct relative paths to external resources.
@@ -88,6 +100,7 @@ private:
                        const Properties &properties) const;
 
     int mVersion;
+    bool mTypedTileData = false;
     QDir mDir;
     GidMapper mGidMapper;
 };
@@ -30,6 +30,7 @@
 
 #include "mapwriter.h"
 
+#include "base64.h"
 #include "compression.h"
 #include "gidmapper.h"
 #include "grouplayer.h"
@@ -38,6 +39,7 @@
 #include "imagelayer.h"
 #include "objectgroup.h"
 #include "objecttemplate.h"
+#include "profiler.h"
 #include "savefile.h"
 #include "tile.h"
 #include "tiled.h"
@@ -98,6 +100,7 @@ private:
 
     QDir mDir;      // The directory in which the file is being saved
     GidMapper mGidMapper;
+    QString mChunkData;     // Reused buffer for writing out CSV tile data
     bool mUseAbsolutePaths { false };
 };
 
@@ -264,11 +267,14 @@ void MapWriterPrivate::writeMap(QXmlStreamWriter &w, const Map &map)
     writeProperties(w, map.properties());
 
     mGidMapper.clear();
-    unsigned firstGid = 1;
-    for (const SharedTileset &tileset : map.tilesets()) {
-        writeTileset(w, *tileset, firstGid);
-        mGidMapper.insert(firstGid, tileset);
-        firstGid += tileset->nextTileId();
+
+    // Reuse the firstGid assignment cached on the map, so that saving again
+    // without tileset changes skips recomputing the layout
+    const QVector<unsigned> &firstGids = map.tilesetFirstGids();
+    const QVector<SharedTileset> &tilesets = map.tilesets();
+    for (int i = 0; i < tilesets.size(); ++i) {
+        writeTileset(w, *tilesets.at(i), firstGids.at(i));
+        mGidMapper.insert(firstGids.at(i), tilesets.at(i));
     }
 
     writeLayers(w, map.layers());
@@ -473,7 +479,7 @@ void MapWriterPrivate::writeTileset(QXmlStreamWriter &w, const Tileset &tileset,
 
                     QBuffer buffer;
                     tile->image().save(&buffer, "png");
-                    w.writeCharacters(QString::fromLatin1(buffer.data().toBase64()));
+                    w.writeCharacters(QString::fromLatin1(toBase64(buffer.data())));
                     w.writeEndElement(); // </data>
                 } else {
                     QString source = toFileReference(tile->imageSource(), mUseAbsolutePaths ? QString()
@@ -591,6 +597,9 @@ void MapWriterPrivate::writeTileLayer(QXmlStreamWriter &w,
     case Map::CSV:
         encoding = QStringLiteral("csv");
         break;
+    case Map::DeltaVLQ:
+        encoding = QStringLiteral("delta-vlq");
+        break;
     }
 
     w.writeStartElement(QStringLiteral("data"));
@@ -636,22 +645,81 @@ void MapWriterPrivate::writeTileLayerData(QXmlStreamWriter &w,
             }
         }
     } else if (mLayerDataFormat == Map::CSV) {
-        QString chunkData;
+        QString &chunkData = mChunkData;
+        chunkData.clear();
+
+        // Enough space for ten digits plus separator per cell
+        chunkData.reserve(qint64(bounds.width()) * bounds.height() * 11);
 
         if (!mMinimize)
             chunkData.append(QLatin1Char('\n'));
 
+        char gidText[11];
+        gidText[10] = ',';
+
         for (int y = bounds.top(); y <= bounds.bottom(); y++) {
             for (int x = bounds.left(); x <= bounds.right(); x++) {
-                const unsigned gid = mGidMapper.cellToGid(tileLayer.cellAt(x, y));
-                chunkData.append(QString::number(gid));
-                if (x != bounds.right() || y != bounds.bottom())
-                    chunkData.append(QLatin1Char(','));
+                unsigned gid = mGidMapper.cellToGid(tileLayer.cellAt(x, y));
+
+                // Formatting the GID in-place avoids the temporary
+                // allocations of QString::number
+                char *begin = gidText + 10;
+                do {
+                    *--begin = char('0' + gid % 10);
+                    gid /= 10;
+                } while (gid);
+
+                const bool last = x == bounds.right() && y == bounds.bottom();
+                chunkData.append(QLatin1String(begin, gidText + (last ? 10 : 11)));
             }
             if (!mMinimize)
                 chunkData.append(QLatin1Char('\n'));
         }
 
+        w.writeCharacters(chunkData);
+    } else if (mLayerDataFormat == Map::DeltaVLQ) {
+        static const char base64VLQAlphabet[] =
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        QString &chunkData = mChunkData;
+        chunkData.clear();
+
+        // Seven VLQ digits cover the full 32-bit GID range, but most deltas
+        // take a single digit
+        chunkData.reserve(qint64(bounds.width()) * bounds.height() * 2);
+
+        // The newline terminating each row is part of the format, since it
+        // resets the delta; only the leading one is optional
+        if (!mMinimize)
+            chunkData.append(QLatin1Char('\n'));
+
+        for (int y = bounds.top(); y <= bounds.bottom(); y++) {
+            // Each row is delta-encoded independently, so that editing one
+            // row doesn't change how the following rows are encoded and
+            // version control sees line-level diffs
+            unsigned previousGid = 0;
+
+            for (int x = bounds.left(); x <= bounds.right(); x++) {
+                const unsigned gid = mGidMapper.cellToGid(tileLayer.cellAt(x, y));
+                const qint64 delta = qint64(gid) - qint64(previousGid);
+                previousGid = gid;
+
+                // Zigzag encoding puts the sign in the lowest bit
+                quint64 value = delta < 0 ? (quint64(-delta) << 1) | 1
+                                          : quint64(delta) << 1;
+                for (;;) {
+                    quint64 digit = value & 0x1f;
+                    value >>= 5;
+                    if (value)
+                        digit |= 0x20;
+                    chunkData.append(QLatin1Char(base64VLQAlphabet[digit]));
+                    if (!value)
+                        break;
+                }
+            }
+            chunkData.append(QLatin1Char('\n'));
+        }
+
         w.writeCharacters(chunkData);
     } else {
         QByteArray chunkData = mGidMapper.encodeLayerData(tileLayer,
@@ -1001,6 +1069,7 @@ MapWriter::~MapWriter() = default;
 void MapWriter::writeMap(const Map *map, QIODevice *device,
                          const QString &path)
 {
+    TILED_PROFILE_SCOPE("MapWriter::writeMap");
     d->writeMap(map, device, path);
 }
 
@@ -0,0 +1,139 @@
+/*
+ * memorybudget.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "memorybudget.h"
+
+#include <QMutex>
+
+#include <atomic>
+
+namespace Tiled {
+
+namespace {
+
+struct RegisteredCache
+{
+    QString name;
+    std::function<qint64 ()> usedBytes;
+    std::function<void (qint64 targetBytes)> trim;
+};
+
+} // anonymous namespace
+
+static QMutex sRegistryMutex;
+
+static QVector<RegisteredCache> &registeredCaches()
+{
+    static QVector<RegisteredCache> caches;
+    return caches;
+}
+
+// Snapshots the registry, so that callbacks can be invoked without holding
+// the lock. Registration only ever appends, hence a copy stays valid.
+static QVector<RegisteredCache> cachesSnapshot()
+{
+    const QMutexLocker locker(&sRegistryMutex);
+    return registeredCaches();
+}
+
+static std::atomic<qint64> sBudget { 0 };
+
+void MemoryBudget::registerCache(const QString &name,
+                                 std::function<qint64 ()> usedBytes,
+                                 std::function<void (qint64 targetBytes)> trim)
+{
+    const QMutexLocker locker(&sRegistryMutex);
+    registeredCaches().append({ name,
+                                std::move(usedBytes),
+                                std::move(trim) });
+}
+
+void MemoryBudget::setBudget(qint64 bytes)
+{
+    sBudget = bytes;
+}
+
+qint64 MemoryBudget::budget()
+{
+    return sBudget;
+}
+
+qint64 MemoryBudget::totalUsage()
+{
+    qint64 total = 0;
+    const auto caches = cachesSnapshot();
+    for (const RegisteredCache &cache : caches)
+        total += cache.usedBytes();
+    return total;
+}
+
+QVector<MemoryBudget::Usage> MemoryBudget::usageReport()
+{
+    const auto caches = cachesSnapshot();
+    QVector<Usage> report;
+    report.reserve(caches.size());
+    for (const RegisteredCache &cache : caches)
+        report.append({ cache.name, cache.usedBytes() });
+    return report;
+}
+
+void MemoryBudget::enforce()
+{
+    const qint64 budget = sBudget;
+    if (budget <= 0)
+        return;
+
+    // A trimmed cache may refill another one while evicting, so guard
+    // against recursing into enforcement.
+    static thread_local bool enforcing = false;
+    if (enforcing)
+        return;
+    enforcing = true;
+
+    const auto caches = cachesSnapshot();
+    qint64 total = 0;
+    for (const RegisteredCache &cache : caches)
+        total += cache.usedBytes();
+
+    for (const RegisteredCache &cache : caches) {
+        const qint64 excess = total - budget;
+        if (excess <= 0)
+            break;
+
+        const qint64 used = cache.usedBytes();
+        if (used <= 0)
+            continue;
+
+        cache.trim(qMax<qint64>(0, used - excess));
+        total -= used - cache.usedBytes();
+    }
+
+    enforcing = false;
+}
+
+} // namespace Tiled
@@ -0,0 +1,92 @@
+/*
+ * memorybudget.h
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+namespace Tiled {
+
+/**
+ * Central accounting of the memory held by the various caches, with an
+ * optional overall budget.
+ *
+ * Caches register themselves with a callback reporting their current usage
+ * and a callback trimming them down to a requested size. When a budget is
+ * set and the combined usage exceeds it, enforce() trims the registered
+ * caches in registration order until the usage fits again. Without a budget
+ * the registry only provides the usage report.
+ *
+ * The registry itself is thread-safe, since caches may register and call
+ * enforce() from render threads. The usage and trim callbacks are invoked
+ * without any lock held, so each cache is responsible for its own locking.
+ */
+class TILEDSHARED_EXPORT MemoryBudget
+{
+public:
+    struct Usage
+    {
+        QString name;
+        qint64 bytes;
+    };
+
+    /**
+     * Registers a cache. \a usedBytes reports the cache's current memory
+     * usage, while \a trim asks the cache to reduce its usage to at most
+     * the given number of bytes, dropping least-recently-used entries.
+     *
+     * Caches are trimmed in registration order, so caches that are cheap to
+     * rebuild should register before expensive ones.
+     */
+    static void registerCache(const QString &name,
+                              std::function<qint64 ()> usedBytes,
+                              std::function<void (qint64 targetBytes)> trim);
+
+    /**
+     * Sets the overall budget in bytes. A budget of 0 disables enforcement.
+     */
+    static void setBudget(qint64 bytes);
+    static qint64 budget();
+
+    static qint64 totalUsage();
+    static QVector<Usage> usageReport();
+
+    /**
+     * Trims registered caches until the total usage fits the budget. Cheap
+     * to call when no budget is set or the budget isn't exceeded; caches
+     * call this after growing.
+     */
+    static void enforce();
+};
+
+} // namespace Tiled
@@ -52,11 +52,21 @@ MiniMapRenderer::~MiniMapRenderer()
 {
 }
 
-QSize MiniMapRenderer::mapSize() const
+/**
+ * Returns the bounding rectangle that the map is rendered into, in map
+ * pixel coordinates. Exposed rectangles passed to renderToImage() are in
+ * this coordinate space.
+ */
+QRect MiniMapRenderer::mapBoundingRect() const
 {
     QRect mapBoundingRect = mRenderer->mapBoundingRect();
     mMap->adjustBoundingRectForOffsetsAndImageLayers(mapBoundingRect);
-    return mapBoundingRect.size();
+    return mapBoundingRect;
+}
+
+QSize MiniMapRenderer::mapSize() const
+{
+    return mapBoundingRect().size();
 }
 
 QImage MiniMapRenderer::render(QSize size, RenderFlags renderFlags) const
@@ -120,7 +130,34 @@ static void extendMapRect(QRect &mapBoundingRect, const MapRenderer &renderer)
     mapBoundingRect = rect.toAlignedRect();
 }
 
-void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) const
+/**
+ * Renders the map into the given \a image.
+ *
+ * When a valid \a exposed rectangle is given, in map pixel coordinates,
+ * only that part of the image is cleared and re-rendered and the rest is
+ * left as-is. This requires the image size and the map bounding rectangle
+ * to be unchanged since the previous render.
+ */
+void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags,
+                                    const QRectF &exposed) const
+{
+    renderToImage(image, image.size(), QPoint(), renderFlags, exposed);
+}
+
+/**
+ * Renders a horizontal band of the map into the given \a image, which
+ * represents the part of the full image of size \a fullSize starting at
+ * \a offset. Rendering a large image band by band avoids having to allocate
+ * it in one piece.
+ */
+void MiniMapRenderer::renderToImage(QImage &image, QSize fullSize, QPoint offset,
+                                    RenderFlags renderFlags) const
+{
+    renderToImage(image, fullSize, offset, renderFlags, QRectF());
+}
+
+void MiniMapRenderer::renderToImage(QImage &image, QSize fullSize, QPoint offset,
+                                    RenderFlags renderFlags, const QRectF &exposed) const
 {
     if (!mMap)
         return;
@@ -144,26 +181,50 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
     QSize mapSize = mapBoundingRect.size();
 
     // Determine the largest possible scale
-    const qreal scale = qMin(static_cast<qreal>(image.width()) / mapSize.width(),
-                             static_cast<qreal>(image.height()) / mapSize.height());
+    const qreal scale = qMin(static_cast<qreal>(fullSize.width()) / mapSize.width(),
+                             static_cast<qreal>(fullSize.height()) / mapSize.height());
 
-    if (renderFlags.testFlag(DrawBackground) && mMap->backgroundColor().isValid())
-        image.fill(mMap->backgroundColor());
-    else
-        image.fill(Qt::transparent);
-
-    QPainter painter(&image);
-    painter.setRenderHints(QPainter::SmoothPixmapTransform, renderFlags.testFlag(SmoothPixmapTransform));
+    const QColor clearColor = renderFlags.testFlag(DrawBackground) && mMap->backgroundColor().isValid()
+            ? mMap->backgroundColor()
+            : QColor(Qt::transparent);
 
     // Center the map in the requested size
     const QSize scaledMapSize = mapSize * scale;
-    const QPointF centerOffset((image.width() - scaledMapSize.width()) / 2,
-                               (image.height() - scaledMapSize.height()) / 2);
+    const QPointF centerOffset((fullSize.width() - scaledMapSize.width()) / 2,
+                               (fullSize.height() - scaledMapSize.height()) / 2);
+
+    QRectF exposedRect = exposed;
+
+    // When rendering a band of a bigger image, limit rendering to the part of
+    // the map covered by the band.
+    const bool isBand = !offset.isNull() || image.size() != fullSize;
+    if (isBand && !exposedRect.isValid()) {
+        QRectF bandRect(QPointF(offset) - centerOffset, QSizeF(image.size()));
+        exposedRect = QRectF(bandRect.topLeft() / scale, bandRect.size() / scale)
+                .translated(mapBoundingRect.topLeft())
+                .adjusted(-1, -1, 1, 1);
+    }
+
+    if (!exposedRect.isValid())
+        image.fill(clearColor);
 
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::SmoothPixmapTransform, renderFlags.testFlag(SmoothPixmapTransform));
+
+    painter.translate(-offset);
     painter.translate(centerOffset);
     painter.scale(scale, scale);
     painter.translate(-mapBoundingRect.topLeft());
 
+    if (exposedRect.isValid()) {
+        painter.setClipRect(exposedRect);
+
+        // Clear only the exposed part, keeping the rest of the image
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(exposedRect, clearColor);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    }
+
     mRenderer->setPainterScale(scale);
 
     LayerIterator iterator(mMap);
@@ -171,16 +232,18 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
         if (visibleLayersOnly && layer->isHidden())
             continue;
 
-        const auto offset = layer->totalOffset();
+        const auto layerOffset = layer->totalOffset();
 
         painter.setOpacity(layer->effectiveOpacity());
-        painter.translate(offset);
+        painter.translate(layerOffset);
 
         switch (layer->layerType()) {
         case Layer::TileLayerType: {
             if (drawTileLayers) {
                 const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
-                mRenderer->drawTileLayer(&painter, tileLayer);
+                mRenderer->drawTileLayer(&painter, tileLayer,
+                                         exposedRect.isValid() ? exposedRect.translated(-layerOffset)
+                                                               : QRectF());
             }
             break;
         }
@@ -225,7 +288,7 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
             break;
         }
 
-        painter.translate(-offset);
+        painter.translate(-layerOffset);
     }
 
     if (drawTileGrid)
@@ -68,13 +68,20 @@ public:
     void setGridColor(const QColor &color);
     void setRenderObjectLabelCallback(const RenderObjectLabelCallback &cb);
 
+    QRect mapBoundingRect() const;
     QSize mapSize() const;
 
     QImage render(QSize size, RenderFlags renderFlags) const;
 
-    void renderToImage(QImage &image, RenderFlags renderFlags) const;
+    void renderToImage(QImage &image, RenderFlags renderFlags,
+                       const QRectF &exposed = QRectF()) const;
+    void renderToImage(QImage &image, QSize fullSize, QPoint offset,
+                       RenderFlags renderFlags) const;
 
 private:
+    void renderToImage(QImage &image, QSize fullSize, QPoint offset,
+                       RenderFlags renderFlags, const QRectF &exposed) const;
+
     const Map *mMap;
     std::unique_ptr<MapRenderer> mRenderer;
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
@@ -35,6 +35,11 @@
 #include "mapobject.h"
 #include "tile.h"
 
+#include <QLineF>
+#include <QVarLengthArray>
+#include <QtMath>
+
+#include <algorithm>
 #include <cmath>
 
 using namespace Tiled;
@@ -68,6 +73,7 @@ void ObjectGroup::insertObject(int index, MapObject *object)
 {
     mObjects.insert(index, object);
     object->setObjectGroup(this);
+    invalidateObjectIndex();
     if (mMap && object->id() == 0)
         object->setId(mMap->takeNextObjectId());
 }
@@ -86,6 +92,7 @@ void ObjectGroup::removeObjectAt(int index)
 {
     MapObject *object = mObjects.takeAt(index);
     object->setObjectGroup(nullptr);
+    invalidateObjectIndex();
 }
 
 void ObjectGroup::moveObjects(int from, int to, int count)
@@ -108,6 +115,8 @@ void ObjectGroup::moveObjects(int from, int to, int count)
 
     for (int i = 0; i < count; ++i)
         mObjects.insert(to + i, movingObjects.at(i));
+
+    invalidateObjectIndex();
 }
 
 QRectF ObjectGroup::objectsBoundingRect() const
@@ -118,6 +127,109 @@ QRectF ObjectGroup::objectsBoundingRect() const
     return boundingRect;
 }
 
+static const qreal objectIndexCellSize = 256.0;
+
+static quint64 objectIndexCell(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
+/**
+ * Returns a conservative pixel-space bounding rect for the given object.
+ * Rotation is accounted for by expanding to the circumscribed square, since
+ * this rect is only used as a broad phase.
+ */
+static QRectF conservativeBounds(const MapObject *object)
+{
+    QRectF bounds = object->bounds();
+
+    // Point-like objects still occupy a grid cell
+    if (bounds.isEmpty())
+        bounds.adjust(-1, -1, 1, 1);
+
+    if (object->rotation() != 0.0) {
+        const qreal radius = QLineF(bounds.topLeft(), bounds.bottomRight()).length();
+        const QPointF pos = object->position();
+        bounds = QRectF(pos.x() - radius, pos.y() - radius,
+                        radius * 2, radius * 2);
+    }
+
+    return bounds;
+}
+
+void ObjectGroup::rebuildObjectIndex() const
+{
+    mObjectIndex.clear();
+
+    for (int i = 0; i < mObjects.size(); ++i) {
+        const QRectF bounds = conservativeBounds(mObjects.at(i));
+
+        const int left = qFloor(bounds.left() / objectIndexCellSize);
+        const int top = qFloor(bounds.top() / objectIndexCellSize);
+        const int right = qFloor(bounds.right() / objectIndexCellSize);
+        const int bottom = qFloor(bounds.bottom() / objectIndexCellSize);
+
+        for (int y = top; y <= bottom; ++y)
+            for (int x = left; x <= right; ++x)
+                mObjectIndex[objectIndexCell(x, y)].append(i);
+    }
+
+    mObjectIndexDirty = false;
+}
+
+/**
+ * Returns the objects whose conservative bounds intersect \a bounds, in
+ * object order. Since rotation and rendering offsets are only approximated,
+ * callers that need exact results should refine the returned candidates.
+ *
+ * The underlying index is rebuilt lazily. Code that changes object geometry
+ * directly needs to call invalidateObjectIndex().
+ */
+QList<MapObject*> ObjectGroup::objectsIntersecting(const QRectF &bounds) const
+{
+    if (mObjectIndexDirty)
+        rebuildObjectIndex();
+
+    const int left = qFloor(bounds.left() / objectIndexCellSize);
+    const int top = qFloor(bounds.top() / objectIndexCellSize);
+    const int right = qFloor(bounds.right() / objectIndexCellSize);
+    const int bottom = qFloor(bounds.bottom() / objectIndexCellSize);
+
+    QVarLengthArray<int, 64> candidates;
+
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            auto it = mObjectIndex.constFind(objectIndexCell(x, y));
+            if (it != mObjectIndex.constEnd())
+                candidates.append(it.value().constData(), it.value().size());
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+
+    QList<MapObject*> result;
+    for (const int index : candidates) {
+        MapObject *object = mObjects.at(index);
+        if (conservativeBounds(object).intersects(bounds))
+            result.append(object);
+    }
+
+    return result;
+}
+
+QList<MapObject*> ObjectGroup::objectsAt(const QPointF &pos) const
+{
+    return objectsIntersecting(QRectF(pos.x() - 0.5, pos.y() - 0.5, 1, 1));
+}
+
+void ObjectGroup::invalidateObjectIndex()
+{
+    mObjectIndex.clear();
+    mObjectIndexDirty = true;
+}
+
 bool ObjectGroup::isEmpty() const
 {
     return mObjects.isEmpty();
@@ -163,6 +275,8 @@ void ObjectGroup::offsetObjects(const QPointF &offset,
     if (offset.isNull())
         return;
 
+    invalidateObjectIndex();
+
     const bool boundsValid = bounds.isValid();
 
     for (MapObject *object : std::as_const(mObjects)) {
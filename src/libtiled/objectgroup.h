@@ -119,6 +119,11 @@ public:
      */
     void moveObjects(int from, int to, int count);
 
+    QList<MapObject*> objectsIntersecting(const QRectF &bounds) const;
+    QList<MapObject*> objectsAt(const QPointF &pos) const;
+
+    void invalidateObjectIndex();
+
     /**
      * Returns the bounding rect around all objects in this object group.
      */
@@ -181,9 +186,16 @@ protected:
     ObjectGroup *initializeClone(ObjectGroup *clone) const;
 
 private:
+    void rebuildObjectIndex() const;
+
     QList<MapObject*> mObjects;
     QColor mColor;
     DrawOrder mDrawOrder = TopDownOrder;
+
+    // Uniform grid over conservative object bounds, used as a broad phase
+    // for hit-testing and view culling. Built lazily, keyed by grid cell.
+    mutable QHash<quint64, QVector<int>> mObjectIndex;
+    mutable bool mObjectIndexDirty = true;
 };
 
 
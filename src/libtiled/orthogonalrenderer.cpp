@@ -28,16 +28,81 @@
 
 #include "orthogonalrenderer.h"
 
+#include "maprenderer_p.h"
+
 #include "map.h"
 #include "mapobject.h"
 #include "tile.h"
 #include "tilelayer.h"
 #include "objectgroup.h"
 
+#include <QCache>
 #include <QtCore/qmath.h>
 
 using namespace Tiled;
 
+struct AverageColorKey {
+    const qint64 key;
+    const QRect rect;
+
+    bool operator==(const AverageColorKey &o) const
+    {
+        return key == o.key && rect == o.rect;
+    }
+};
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+uint qHash(const AverageColorKey &key, uint seed) Q_DECL_NOTHROW
+#else
+size_t qHash(const AverageColorKey &key, size_t seed) Q_DECL_NOTHROW
+#endif
+{
+    auto h = ::qHash(key.key, seed);
+    h = ::qHash(key.rect.x(), h);
+    h = ::qHash(key.rect.y(), h);
+    h = ::qHash(key.rect.width(), h);
+    h = ::qHash(key.rect.height(), h);
+    return h;
+}
+
+/**
+ * Returns the average color of the given \a tile's image, or an invalid
+ * color when no image is available. The results are cached, keyed on the
+ * source pixmap and sub-rectangle since tiles cut from a tileset sheet
+ * share a single pixmap.
+ */
+static QColor averageTileColor(const Tile *tile)
+{
+    const QPixmap &image = tile->image();
+    if (image.isNull())
+        return QColor();
+
+    static QCache<AverageColorKey, QColor> cache { 8192 };
+
+    const AverageColorKey colorKey { image.cacheKey(), tile->imageRect() };
+    if (auto cached = cache.object(colorKey)) {
+        if (RenderStatistics::enabled)
+            ++RenderStatistics::pixmapCacheHits;
+        return *cached;
+    }
+
+    if (RenderStatistics::enabled)
+        ++RenderStatistics::pixmapCacheMisses;
+
+    QRect rect = tile->imageRect();
+    if (rect.isEmpty())
+        rect = image.rect();
+
+    // Smoothly scaling down to a single pixel averages the source area
+    const QColor color = image.copy(rect).toImage()
+            .scaled(1, 1, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+            .convertToFormat(QImage::Format_ARGB32)
+            .pixelColor(0, 0);
+
+    cache.insert(colorKey, new QColor(color));
+    return color;
+}
+
 QRect OrthogonalRenderer::boundingRect(const QRect &rect) const
 {
     const int tileWidth = map()->tileWidth();
@@ -259,8 +324,141 @@ void OrthogonalRenderer::drawGrid(QPainter *painter, const QRectF &rect,
     }
 }
 
+void OrthogonalRenderer::drawTileLayer(QPainter *painter, const TileLayer *layer,
+                                       const QRectF &exposed) const
+{
+    if (drawTileLayerLod(painter, layer, exposed))
+        return;
+
+    renderTileLayer(*this, painter, layer, exposed,
+                    [this] (const auto &renderTile, const QRectF &rect) {
+        drawTileLayerImpl(renderTile, rect);
+    });
+}
+
+/**
+ * Draws the given tile layer as one pixel per cell, using the average color
+ * of each tile's image. This level-of-detail path takes over when the view
+ * is zoomed out so far that an entire tile covers less than a couple of
+ * device pixels, where rendering the actual tile images is wasted work.
+ *
+ * The cells are rasterized chunk by chunk into a small image, so a full
+ * overview of a huge map touches each cell only once per repaint, without
+ * any per-cell painter calls.
+ *
+ * Returns false when this path does not apply, in which case the regular
+ * tile drawing should be used.
+ */
+bool OrthogonalRenderer::drawTileLayerLod(QPainter *painter,
+                                          const TileLayer *layer,
+                                          const QRectF &exposed) const
+{
+    if (!painter->renderHints().testFlag(QPainter::SmoothPixmapTransform))
+        return false;
+
+    const QTransform &transform = painter->worldTransform();
+    if (transform.type() > QTransform::TxScale)
+        return false;
+
+    const int tileWidth = map()->tileWidth();
+    const int tileHeight = map()->tileHeight();
+    if (tileWidth <= 0 || tileHeight <= 0)
+        return false;
+
+    qreal scale = qMin(qAbs(transform.m11()), qAbs(transform.m22()));
+    if (const QPaintDevice *device = painter->device())
+        scale *= device->devicePixelRatioF();
+
+    // Switch to average colors once a tile covers less than about two
+    // device pixels, where individual tile images are indistinguishable
+    if (scale <= 0 || scale * qMin(tileWidth, tileHeight) >= 2.0)
+        return false;
+
+    QRect rect = boundingRect(layer->bounds());
+    if (!exposed.isNull())
+        rect &= exposed.toAlignedRect();
+    if (rect.isEmpty())
+        return true;
+
+    // The range of cells to draw, in layer-local coordinates
+    const QPoint layerPos = layer->position();
+    const int startX = qFloor(qreal(rect.left()) / tileWidth) - layerPos.x();
+    const int startY = qFloor(qreal(rect.top()) / tileHeight) - layerPos.y();
+    const int endX = qCeil(qreal(rect.right() + 1) / tileWidth) - layerPos.x();
+    const int endY = qCeil(qreal(rect.bottom() + 1) / tileHeight) - layerPos.y();
+
+    const QColor tintColor = layer->effectiveTintColor();
+    const bool applyTint = tintColor.isValid()
+            && tintColor != QColor(255, 255, 255, 255);
+
+    QImage chunkImage(CHUNK_SIZE, CHUNK_SIZE,
+                      QImage::Format_ARGB32_Premultiplied);
+
+    const int firstChunkX = startX >> CHUNK_BITS;
+    const int firstChunkY = startY >> CHUNK_BITS;
+    const int lastChunkX = (endX - 1) >> CHUNK_BITS;
+    const int lastChunkY = (endY - 1) >> CHUNK_BITS;
+
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            const Chunk *chunk = layer->findChunk(chunkX * CHUNK_SIZE,
+                                                  chunkY * CHUNK_SIZE);
+            if (!chunk || chunk->isEmpty())
+                continue;
+
+            chunkImage.fill(Qt::transparent);
+
+            for (int y = 0; y < CHUNK_SIZE; ++y) {
+                quint16 occupied = chunk->occupiedRow(y);
+                if (!occupied)
+                    continue;
+
+                QRgb *scanLine = reinterpret_cast<QRgb*>(chunkImage.scanLine(y));
+
+                for (int x = 0; occupied; ++x, occupied >>= 1) {
+                    if (!(occupied & 1))
+                        continue;
+
+                    const Tile *tile = chunk->cellAt(x, y).tile();
+                    if (!tile)
+                        continue;
+
+                    QColor color = averageTileColor(tile);
+                    if (!color.isValid())
+                        continue;
+
+                    if (applyTint) {
+                        color.setRedF(color.redF() * tintColor.redF());
+                        color.setGreenF(color.greenF() * tintColor.greenF());
+                        color.setBlueF(color.blueF() * tintColor.blueF());
+                        color.setAlphaF(color.alphaF() * tintColor.alphaF());
+                    }
+
+                    scanLine[x] = qPremultiply(color.rgba());
+                }
+            }
+
+            const QRectF target((chunkX * CHUNK_SIZE + layerPos.x()) * tileWidth,
+                                (chunkY * CHUNK_SIZE + layerPos.y()) * tileHeight,
+                                CHUNK_SIZE * tileWidth,
+                                CHUNK_SIZE * tileHeight);
+
+            painter->drawImage(target, chunkImage);
+        }
+    }
+
+    return true;
+}
+
 void OrthogonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
                                        const QRectF &exposed) const
+{
+    drawTileLayerImpl(renderTile, exposed);
+}
+
+template <typename RenderTile>
+void OrthogonalRenderer::drawTileLayerImpl(RenderTile renderTile,
+                                           const QRectF &exposed) const
 {
     const int tileWidth = map()->tileWidth();
     const int tileHeight = map()->tileHeight();
@@ -300,9 +498,22 @@ void OrthogonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
     endX += incX;
     endY += incY;
 
-    for (int y = startY; y != endY; y += incY)
-        for (int x = startX; x != endX; x += incX)
-            renderTile(QPoint(x, y), QPointF(x * tileWidth, (y + 1) * tileHeight));
+    // Tile positions are integer pixel amounts, so they are stepped with
+    // integer additions in the loop rather than multiplied per cell. The
+    // zoom level does not matter here since scaling is applied through the
+    // painter transform.
+    const int stepX = incX * tileWidth;
+    const int firstPixelX = startX * tileWidth;
+
+    for (int y = startY; y != endY; y += incY) {
+        const int pixelY = (y + 1) * tileHeight;
+        int pixelX = firstPixelX;
+
+        for (int x = startX; x != endX; x += incX) {
+            renderTile(QPoint(x, y), QPointF(pixelX, pixelY));
+            pixelX += stepX;
+        }
+    }
 }
 
 void OrthogonalRenderer::drawTileSelection(QPainter *painter,
@@ -459,10 +670,7 @@ void OrthogonalRenderer::drawMapObject(QPainter *painter,
         }
 
         case MapObject::Text: {
-            const auto& textData = object->textData();
-            painter->setFont(textData.font);
-            painter->setPen(textData.color);
-            painter->drawText(bounds, textData.text, textData.textOption());
+            drawTextObject(painter, object->textData(), bounds);
             break;
         }
         case MapObject::Point: {
@@ -51,6 +51,8 @@ public:
                   QColor gridColor, QSize gridMajor = QSize()) const override;
 
     using MapRenderer::drawTileLayer;
+    void drawTileLayer(QPainter *painter, const TileLayer *layer,
+                       const QRectF &exposed = QRectF()) const override;
     void drawTileLayer(const RenderTileCallback &renderTile,
                        const QRectF &exposed) const override;
 
@@ -80,6 +82,13 @@ public:
 
     using MapRenderer::pixelToScreenCoords;
     QPointF pixelToScreenCoords(qreal x, qreal y) const override;
+
+private:
+    bool drawTileLayerLod(QPainter *painter, const TileLayer *layer,
+                          const QRectF &exposed) const;
+
+    template <typename RenderTile>
+    void drawTileLayerImpl(RenderTile renderTile, const QRectF &exposed) const;
 };
 
 } // namespace Tiled
@@ -49,7 +49,7 @@ QString PluginFile::fileName() const
 
 bool PluginFile::hasError() const
 {
-    if (instance)
+    if (instance || !loadAttempted)
         return false;
 
     return state == PluginEnabled || (defaultEnable && state == PluginDefault);
@@ -110,6 +110,7 @@ bool PluginManager::setPluginState(const QString &fileName, PluginState state)
 
 bool PluginManager::loadPlugin(PluginFile *plugin)
 {
+    plugin->loadAttempted = true;
     plugin->instance = plugin->loader->instance();
 
     if (plugin->instance) {
@@ -215,25 +216,40 @@ void PluginManager::loadPlugins()
 
         bool enable = state == PluginEnabled || (defaultEnable && state != PluginDisabled);
 
-        QObject *instance = nullptr;
+        // Only the meta data is read at this point. The plugin itself is
+        // loaded on the first query for plugin objects, so that showing the
+        // main window does not wait for every plugin to load.
+        mPlugins.append(PluginFile(state, nullptr, loader, defaultEnable));
 
-        if (enable) {
-            instance = loader->instance();
+        if (enable)
+            mHasPendingPlugins = true;
+    }
+}
 
-            if (!instance)
-                qWarning().noquote() << "Error:" << loader->errorString();
-        }
+/**
+ * Loads any enabled plugins that have not been loaded yet. This is triggered
+ * by the first query for plugin objects after loadPlugins().
+ */
+void PluginManager::loadPendingPlugins()
+{
+    // A plugin's initialization can trigger further object queries
+    if (!mHasPendingPlugins || mLoadingPendingPlugins)
+        return;
 
-        mPlugins.append(PluginFile(state, instance, loader, defaultEnable));
+    mLoadingPendingPlugins = true;
+    mHasPendingPlugins = false;
 
-        if (!instance)
+    for (PluginFile &plugin : mPlugins) {
+        if (plugin.instance || !plugin.loader || plugin.loadAttempted)
             continue;
 
-        if (Plugin *plugin = qobject_cast<Plugin*>(instance))
-            plugin->initialize();
-        else
-            addObject(instance);
+        const bool enable = plugin.state == PluginEnabled ||
+                (plugin.defaultEnable && plugin.state != PluginDisabled);
+        if (enable)
+            loadPlugin(&plugin);
     }
+
+    mLoadingPendingPlugins = false;
 }
 
 PluginFile *PluginManager::pluginByFileName(const QString &fileName)
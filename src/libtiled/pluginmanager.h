@@ -69,6 +69,7 @@ struct TILEDSHARED_EXPORT PluginFile
     QObject *instance;
     QPluginLoader *loader;
     bool defaultEnable;
+    bool loadAttempted = false;
 };
 
 
@@ -88,7 +89,9 @@ public:
     static void deleteInstance();
 
     /**
-     * Scans the plugin directory for plugins and attempts to load them.
+     * Scans the plugin directory for plugins, reading only their meta data.
+     * Enabled plugins are actually loaded on the first query for plugin
+     * objects, which keeps their load cost out of the editor startup.
      */
     void loadPlugins();
 
@@ -115,10 +118,12 @@ public:
     static QList<T*> objects()
     {
         QList<T*> results;
-        if (mInstance)
+        if (mInstance) {
+            mInstance->loadPendingPlugins();
             for (QObject *object : std::as_const(mInstance->mObjects))
                 if (T *result = qobject_cast<T*>(object))
                     results.append(result);
+        }
         return results;
     }
 
@@ -128,10 +133,12 @@ public:
     template<typename T>
     static void each(std::function<void(T*)> function)
     {
-        if (mInstance)
+        if (mInstance) {
+            mInstance->loadPendingPlugins();
             for (QObject *object : std::as_const(mInstance->mObjects))
                 if (T *result = qobject_cast<T*>(object))
                     function(result);
+        }
     }
 
     /**
@@ -141,11 +148,13 @@ public:
     template<typename T>
     static T *find(std::function<bool(T*)> function)
     {
-        if (mInstance)
+        if (mInstance) {
+            mInstance->loadPendingPlugins();
             for (QObject *object : std::as_const(mInstance->mObjects))
                 if (T *result = qobject_cast<T*>(object))
                     if (function(result))
                         return result;
+        }
         return nullptr;
     }
 
@@ -164,6 +173,7 @@ private:
     PluginManager();
     ~PluginManager() override;
 
+    void loadPendingPlugins();
     bool loadPlugin(PluginFile *plugin);
     bool unloadPlugin(PluginFile *plugin);
 
@@ -172,6 +182,8 @@ private:
     QList<PluginFile> mPlugins;
     QMap<QString, PluginState> mPluginStates;
     QObjectList mObjects;
+    bool mHasPendingPlugins = false;
+    bool mLoadingPendingPlugins = false;
 };
 
 
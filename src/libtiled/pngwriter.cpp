@@ -0,0 +1,200 @@
+/*
+ * pngwriter.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "pngwriter.h"
+
+#if (defined(Q_OS_WIN) && defined(Q_CC_MSVC)) || defined(Q_OS_WASM)
+#include "QtZlib/zlib.h"
+#else
+#include <zlib.h>
+#endif
+
+#include <QIODevice>
+#include <QtEndian>
+
+#include <cstring>
+
+using namespace Tiled;
+
+PngWriter::PngWriter(QIODevice *device)
+    : mDevice(device)
+{
+}
+
+/**
+ * Writes the PNG signature and the IHDR chunk for an 8-bit RGBA image with
+ * the given \a size. Must be called before writing any bands.
+ */
+bool PngWriter::writeHeader(QSize size)
+{
+    static const uchar signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+    if (mDevice->write(reinterpret_cast<const char*>(signature), 8) != 8)
+        return false;
+
+    QByteArray ihdr;
+    ihdr.resize(13);
+    uchar *data = reinterpret_cast<uchar*>(ihdr.data());
+    qToBigEndian(quint32(size.width()), data);
+    qToBigEndian(quint32(size.height()), data + 4);
+    data[8] = 8;    // bit depth
+    data[9] = 6;    // color type: truecolor with alpha
+    data[10] = 0;   // compression method: deflate
+    data[11] = 0;   // filter method: adaptive
+    data[12] = 0;   // interlace method: none
+
+    return writeChunk("IHDR", ihdr);
+}
+
+/**
+ * Filters and compresses the given \a band. Thread-safe, so bands can be
+ * compressed concurrently. Set \a last only for the final band, which closes
+ * the deflate stream.
+ */
+PngWriter::CompressedBand PngWriter::compressBand(QImage band, bool last)
+{
+    CompressedBand result;
+
+    if (band.format() != QImage::Format_RGBA8888)
+        band = band.convertToFormat(QImage::Format_RGBA8888);
+    if (band.isNull())
+        return result;
+
+    const int bytesPerLine = band.width() * 4;
+
+    // Each scanline is prefixed with a filter type. The first line of a band
+    // can't refer to the previous band, so it uses the None filter, while the
+    // other lines use the Up filter.
+    QByteArray filtered;
+    filtered.resize((bytesPerLine + 1) * band.height());
+    uchar *out = reinterpret_cast<uchar*>(filtered.data());
+
+    for (int y = 0; y < band.height(); ++y) {
+        const uchar *line = band.constScanLine(y);
+
+        if (y == 0) {
+            *out++ = 0;     // None
+            std::memcpy(out, line, bytesPerLine);
+            out += bytesPerLine;
+        } else {
+            const uchar *prev = band.constScanLine(y - 1);
+            *out++ = 2;     // Up
+            for (int i = 0; i < bytesPerLine; ++i)
+                *out++ = uchar(line[i] - prev[i]);
+        }
+    }
+
+    result.adler = quint32(adler32(adler32(0, Z_NULL, 0),
+                                   reinterpret_cast<const Bytef*>(filtered.constData()),
+                                   uInt(filtered.size())));
+    result.rawLength = filtered.size();
+
+    // Compress as a raw deflate stream. Ending each band with a full flush
+    // makes the concatenated bands a valid stream, at a slight cost in
+    // compression ratio since bands don't share their window.
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                     -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return result;
+
+    QByteArray compressed;
+    compressed.resize(int(deflateBound(&stream, uLong(filtered.size()))) + 16);
+
+    stream.next_in = reinterpret_cast<Bytef*>(filtered.data());
+    stream.avail_in = uInt(filtered.size());
+    stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+    stream.avail_out = uInt(compressed.size());
+
+    const int ret = deflate(&stream, last ? Z_FINISH : Z_FULL_FLUSH);
+    if ((last && ret == Z_STREAM_END) || (!last && ret == Z_OK)) {
+        compressed.truncate(compressed.size() - int(stream.avail_out));
+        result.data = compressed;
+    }
+
+    deflateEnd(&stream);
+    return result;
+}
+
+/**
+ * Writes a compressed band as an IDAT chunk. Bands need to be written in
+ * order, from top to bottom.
+ */
+bool PngWriter::writeCompressedBand(const CompressedBand &band)
+{
+    if (band.data.isEmpty())
+        return false;
+
+    QByteArray data = band.data;
+
+    if (mFirstBand) {
+        // The raw deflate stream needs to be wrapped in a zlib header
+        data.prepend("\x78\x9C", 2);
+        mAdler = band.adler;
+        mFirstBand = false;
+    } else {
+        mAdler = quint32(adler32_combine(mAdler, band.adler, band.rawLength));
+    }
+
+    return writeChunk("IDAT", data);
+}
+
+/**
+ * Writes the trailing Adler-32 checksum of the zlib stream and the IEND
+ * chunk.
+ */
+bool PngWriter::finish()
+{
+    QByteArray adler;
+    adler.resize(4);
+    qToBigEndian(mAdler, adler.data());
+
+    return writeChunk("IDAT", adler)
+            && writeChunk("IEND", QByteArray());
+}
+
+bool PngWriter::writeChunk(const char *type, const QByteArray &data)
+{
+    uchar lengthBytes[4];
+    qToBigEndian(quint32(data.size()), lengthBytes);
+
+    quint32 crc = quint32(crc32(crc32(0, Z_NULL, 0),
+                                reinterpret_cast<const Bytef*>(type), 4));
+    crc = quint32(crc32(crc,
+                        reinterpret_cast<const Bytef*>(data.constData()),
+                        uInt(data.size())));
+
+    uchar crcBytes[4];
+    qToBigEndian(crc, crcBytes);
+
+    return mDevice->write(reinterpret_cast<const char*>(lengthBytes), 4) == 4
+            && mDevice->write(type, 4) == 4
+            && mDevice->write(data) == data.size()
+            && mDevice->write(reinterpret_cast<const char*>(crcBytes), 4) == 4;
+}
@@ -0,0 +1,77 @@
+/*
+ * pngwriter.h
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QByteArray>
+#include <QImage>
+
+class QIODevice;
+
+namespace Tiled {
+
+/**
+ * A minimal PNG encoder that writes an image in horizontal bands, so that a
+ * large image never needs to be held in memory in one piece.
+ *
+ * Each band is filtered and compressed into its own IDAT chunk. The bands are
+ * compressed independently, so compressBand() can run on worker threads, as
+ * long as the results are passed to writeCompressedBand() in order, with only
+ * the last band compressed with \a last set.
+ *
+ * Always writes 8-bit RGBA images, without interlacing.
+ */
+class TILEDSHARED_EXPORT PngWriter
+{
+public:
+    struct CompressedBand
+    {
+        QByteArray data;
+        quint32 adler = 0;
+        qint64 rawLength = 0;
+    };
+
+    explicit PngWriter(QIODevice *device);
+
+    bool writeHeader(QSize size);
+    bool writeCompressedBand(const CompressedBand &band);
+    bool finish();
+
+    static CompressedBand compressBand(QImage band, bool last);
+
+private:
+    bool writeChunk(const char *type, const QByteArray &data);
+
+    QIODevice *mDevice;
+    quint32 mAdler = 0;
+    bool mFirstBand = true;
+};
+
+} // namespace Tiled
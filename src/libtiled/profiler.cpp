@@ -0,0 +1,137 @@
+/*
+ * profiler.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "profiler.h"
+
+#ifdef TILED_PROFILING
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+
+namespace Tiled {
+
+namespace {
+
+struct Zone
+{
+    const char *name;
+    qint64 start;       // nanoseconds since program start
+    qint64 end;
+    quintptr threadId;
+};
+
+struct ProfilerData
+{
+    ProfilerData() { timer.start(); }
+    ~ProfilerData();
+
+    QElapsedTimer timer;
+    QMutex mutex;
+    QVector<Zone> zones;
+};
+
+ProfilerData &profilerData()
+{
+    static ProfilerData data;
+    return data;
+}
+
+ProfilerData::~ProfilerData()
+{
+    // Write out the collected trace at exit when requested
+    const QByteArray traceFile = qgetenv("TILED_TRACE_FILE");
+    if (!traceFile.isEmpty())
+        Profiler::writeTrace(QString::fromLocal8Bit(traceFile));
+}
+
+} // anonymous namespace
+
+/**
+ * Returns the current timestamp in nanoseconds since program start.
+ */
+qint64 Profiler::now()
+{
+    return profilerData().timer.nsecsElapsed();
+}
+
+void Profiler::recordZone(const char *name, qint64 start, qint64 end)
+{
+    auto &data = profilerData();
+    const auto threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+    QMutexLocker locker(&data.mutex);
+    data.zones.append({ name, start, end, threadId });
+}
+
+/**
+ * Writes the zones collected so far to the given file, in the JSON trace
+ * event format understood by chrome://tracing.
+ */
+bool Profiler::writeTrace(const QString &fileName)
+{
+    auto &data = profilerData();
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    QByteArray line;
+    file.write("{\"traceEvents\":[\n");
+
+    QMutexLocker locker(&data.mutex);
+
+    for (int i = 0, i_end = data.zones.size(); i < i_end; ++i) {
+        const Zone &zone = data.zones.at(i);
+
+        line.clear();
+        line.append("{\"name\":\"");
+        line.append(zone.name);
+        line.append("\",\"cat\":\"tiled\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+        line.append(QByteArray::number(qulonglong(zone.threadId)));
+        line.append(",\"ts\":");
+        line.append(QByteArray::number(zone.start / 1000.0, 'f', 3));
+        line.append(",\"dur\":");
+        line.append(QByteArray::number((zone.end - zone.start) / 1000.0, 'f', 3));
+        line.append(i + 1 < i_end ? "},\n" : "}\n");
+
+        file.write(line);
+    }
+
+    locker.unlock();
+
+    file.write("]}\n");
+    return file.commit();
+}
+
+} // namespace Tiled
+
+#endif // TILED_PROFILING
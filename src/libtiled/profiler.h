@@ -0,0 +1,84 @@
+/*
+ * profiler.h
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+/**
+ * Lightweight scoped-zone instrumentation.
+ *
+ * TILED_PROFILE_SCOPE(name) records the time spent in the enclosing scope
+ * under the given name, which needs to be a string literal. The zones of all
+ * threads are collected in memory and can be written out as a trace in the
+ * JSON format understood by chrome://tracing (and by the tooling built on
+ * it, like Perfetto), so traces can be attached to bug reports.
+ *
+ * The instrumentation is compiled out by default. It is enabled by building
+ * with the "profiling" qbs project property, and a trace is written at exit
+ * when the TILED_TRACE_FILE environment variable names a target file.
+ */
+#ifdef TILED_PROFILING
+
+#include <QString>
+
+namespace Tiled {
+
+class TILEDSHARED_EXPORT Profiler
+{
+public:
+    static qint64 now();
+    static void recordZone(const char *name, qint64 start, qint64 end);
+    static bool writeTrace(const QString &fileName);
+};
+
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char *name)
+        : mName(name)
+        , mStart(Profiler::now())
+    {}
+
+    ~ProfileZone()
+    { Profiler::recordZone(mName, mStart, Profiler::now()); }
+
+private:
+    const char * const mName;
+    const qint64 mStart;
+};
+
+} // namespace Tiled
+
+#define TILED_PROFILE_SCOPE(name) Tiled::ProfileZone tiledProfileZone(name)
+
+#else
+
+#define TILED_PROFILE_SCOPE(name)
+
+#endif // TILED_PROFILING
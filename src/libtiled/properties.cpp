@@ -34,7 +34,9 @@
 #include "tiled.h"
 
 #include <QColor>
+#include <QHash>
 #include <QJsonObject>
+#include <QMutex>
 #include <QVector>
 
 namespace Tiled {
@@ -49,6 +51,15 @@ FilePath FilePath::fromString(const QString &string)
     return { Tiled::toUrl(string) };
 }
 
+QString internString(const QString &string)
+{
+    static StringInterner interner;
+    static QMutex mutex;
+
+    const QMutexLocker locker(&mutex);
+    return interner.intern(string);
+}
+
 
 bool setClassPropertyMemberValue(QVariant &classValue,
                                  int depth,
@@ -238,18 +249,23 @@ QString typeToName(int type)
 
 static int nameToType(const QString &name)
 {
-    if (name == QLatin1String("string"))
-        return QMetaType::QString;
-    if (name == QLatin1String("float"))
-        return QMetaType::Double;
-    if (name == QLatin1String("color"))
-        return QMetaType::QColor;
-    if (name == QLatin1String("file"))
-        return filePathTypeId();
-    if (name == QLatin1String("object"))
-        return objectRefTypeId();
-    if (name == QLatin1String("class"))
-        return QMetaType::QVariantMap;
+    // Covers every type name written by the supported formats, so that the
+    // common case is a single hash lookup instead of a scan over the names
+    // followed by a search of Qt's meta type registry.
+    static const QHash<QString, int> typeByName {
+        { QStringLiteral("string"), QMetaType::QString },
+        { QStringLiteral("int"),    QMetaType::Int },
+        { QStringLiteral("float"),  QMetaType::Double },
+        { QStringLiteral("bool"),   QMetaType::Bool },
+        { QStringLiteral("color"),  QMetaType::QColor },
+        { QStringLiteral("file"),   filePathTypeId() },
+        { QStringLiteral("object"), objectRefTypeId() },
+        { QStringLiteral("class"),  QMetaType::QVariantMap },
+    };
+
+    const auto it = typeByName.constFind(name);
+    if (it != typeByName.constEnd())
+        return it.value();
 
     return QVariant::nameToType(name.toLatin1().constData());
 }
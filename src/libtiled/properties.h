@@ -32,6 +32,7 @@
 
 #include <QJsonArray>
 #include <QObject>
+#include <QSet>
 #include <QUrl>
 #include <QVariantMap>
 
@@ -149,6 +150,30 @@ private:
  */
 using Properties = QVariantMap;
 
+/**
+ * Interns strings, making repeated occurrences share a single allocation.
+ *
+ * Used through internString by the map readers for strings that tend to
+ * repeat on a large number of layers and objects.
+ */
+class TILEDSHARED_EXPORT StringInterner
+{
+public:
+    QString intern(const QString &string) { return *mStrings.insert(string); }
+    void clear() { mStrings.clear(); }
+
+private:
+    QSet<QString> mStrings;
+};
+
+/**
+ * Returns the given \a string from a process-wide pool, so that repeated
+ * occurrences share a single allocation. Meant for strings that repeat a lot
+ * within and across files, like layer and object names, class names and
+ * custom property names. Thread-safe.
+ */
+TILEDSHARED_EXPORT QString internString(const QString &string);
+
 
 /**
  * Collection of properties with information about the consistency of their
@@ -34,6 +34,7 @@
 #include "objecttypes.h"
 #include "properties.h"
 
+#include <QHash>
 #include <QVector>
 
 #include <algorithm>
@@ -560,10 +561,51 @@ const ClassPropertyType *PropertyTypes::findClassFor(const QString &name, const
     if (name.isEmpty())
         return nullptr;
 
+    // The result depends only on the name and the kind of object, and the
+    // Properties view and the exporters query it once per object per field.
+    // Resolved lookups are therefore cached, versioned by the revision so
+    // that any change to the types starts over with an empty cache. The
+    // cache is thread-local since object colors are also resolved while
+    // rendering maps on worker threads.
+    struct LookupCache {
+        const PropertyTypes *types = nullptr;
+        quint64 revision = 0;
+        QHash<QPair<QString, int>, const ClassPropertyType*> entries;
+    };
+    thread_local LookupCache cache;
+
+    const quint64 revision = mRevision.load(std::memory_order_relaxed);
+    if (cache.types != this || cache.revision != revision) {
+        cache.types = this;
+        cache.revision = revision;
+        cache.entries.clear();
+    }
+
+    const QPair<QString, int> key(name, object.typeId());
+    const auto cached = cache.entries.constFind(key);
+    if (cached != cache.entries.constEnd())
+        return cached.value();
+
     auto it = std::find_if(mTypes.begin(), mTypes.end(), [&] (const PropertyType *type) {
         return type->name == name && type->isClass() && static_cast<const ClassPropertyType*>(type)->isClassFor(object);
     });
-    return static_cast<const ClassPropertyType*>(it == mTypes.end() ? nullptr : *it);
+    const auto result = static_cast<const ClassPropertyType*>(it == mTypes.end() ? nullptr : *it);
+
+    cache.entries.insert(key, result);
+    return result;
+}
+
+/**
+ * Invalidates the cached class lookups kept by findClassFor.
+ *
+ * All mutating members call this already. It needs to be called explicitly
+ * by code that adjusts a previously obtained PropertyType in place, like the
+ * property types editor.
+ */
+void PropertyTypes::invalidateClassLookupCache()
+{
+    static std::atomic<quint64> counter { 0 };
+    mRevision.store(++counter, std::memory_order_relaxed);
 }
 
 PropertyType *PropertyTypes::findTypeByNamePriv(const QString &name, int usageFlags)
@@ -39,6 +39,7 @@
 
 #include "tiled_global.h"
 
+#include <atomic>
 #include <memory>
 
 namespace Tiled {
@@ -182,11 +183,22 @@ class TILEDSHARED_EXPORT PropertyTypes
     using Types = QVector<PropertyType*>;
 
 public:
-    PropertyTypes() = default;
-    PropertyTypes(PropertyTypes&& other) = default;
+    PropertyTypes() { invalidateClassLookupCache(); }
+
+    PropertyTypes(PropertyTypes&& other)
+        : mTypes(std::move(other.mTypes))
+        , mNextId(other.mNextId)
+    { invalidateClassLookupCache(); }
+
     ~PropertyTypes();
 
-    PropertyTypes& operator=(PropertyTypes&& other) = default;
+    PropertyTypes& operator=(PropertyTypes&& other)
+    {
+        mTypes = std::move(other.mTypes);
+        mNextId = other.mNextId;
+        invalidateClassLookupCache();
+        return *this;
+    }
 
     PropertyType &add(std::unique_ptr<PropertyType> type);
     void clear();
@@ -207,6 +219,8 @@ public:
     void loadFromJson(const QJsonArray &list, const QString &path = QString());
     QJsonArray toJson(const QString &path = QString()) const;
 
+    void invalidateClassLookupCache();
+
     // Enable easy iteration over types with range-based for
     Types::iterator begin() { return mTypes.begin(); }
     Types::iterator end() { return mTypes.end(); }
@@ -221,6 +235,10 @@ private:
 
     Types mTypes;
     int mNextId = 0;
+
+    // Versions the class lookup cache kept by findClassFor. Assigned from a
+    // global counter so that no two container instances ever share a value.
+    std::atomic<quint64> mRevision { 0 };
 };
 
 inline PropertyType &PropertyTypes::add(std::unique_ptr<PropertyType> type)
@@ -231,12 +249,14 @@ inline PropertyType &PropertyTypes::add(std::unique_ptr<PropertyType> type)
         mNextId = std::max(mNextId, type->id);
 
     mTypes.append(type.release());
+    invalidateClassLookupCache();
     return *mTypes.last();
 }
 
 inline void PropertyTypes::clear()
 {
     mTypes.clear();
+    invalidateClassLookupCache();
 }
 
 inline size_t PropertyTypes::count() const
@@ -247,21 +267,26 @@ inline size_t PropertyTypes::count() const
 inline void PropertyTypes::removeAt(int index)
 {
     delete mTypes.takeAt(index);
+    invalidateClassLookupCache();
 }
 
 inline std::unique_ptr<PropertyType> PropertyTypes::takeAt(int index)
 {
+    invalidateClassLookupCache();
     return std::unique_ptr<PropertyType> { mTypes.takeAt(index) };
 }
 
 inline PropertyType &PropertyTypes::typeAt(int index)
 {
+    // The caller may adjust the type in place
+    invalidateClassLookupCache();
     return *mTypes.at(index);
 }
 
 inline void PropertyTypes::moveType(int from, int to)
 {
     mTypes.move(from, to);
+    invalidateClassLookupCache();
 }
 
 using SharedPropertyTypes = QSharedPointer<PropertyTypes>;
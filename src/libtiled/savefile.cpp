@@ -30,14 +30,19 @@
 
 #include <QFile>
 #include <QSaveFile>
+#include <QTemporaryFile>
 
 namespace Tiled {
 
 bool SaveFile::mSafeSavingEnabled = true;
+bool SaveFile::mSkipUnchangedEnabled = false;
 
 SaveFile::SaveFile(const QString &name)
+    : mFileName(name)
 {
-    if (mSafeSavingEnabled)
+    if (mSkipUnchangedEnabled)
+        mFileDevice = std::make_unique<QTemporaryFile>(name + QStringLiteral(".XXXXXX"));
+    else if (mSafeSavingEnabled)
         mFileDevice = std::make_unique<QSaveFile>(name);
     else
         mFileDevice = std::make_unique<QFile>(name);
@@ -45,12 +50,58 @@ SaveFile::SaveFile(const QString &name)
 
 bool SaveFile::commit()
 {
+    if (auto tempFile = qobject_cast<QTemporaryFile*>(mFileDevice.get()))
+        return commitIfChanged(*tempFile);
+
     if (auto saveFile = qobject_cast<QSaveFile*>(mFileDevice.get()))
         return saveFile->commit();
 
     return mFileDevice->error() == QFileDevice::NoError;
 }
 
+/**
+ * Compares the data written to \a tempFile with the target file, only
+ * replacing the target when the contents differ. The temporary file is
+ * removed either way when this SaveFile is destroyed.
+ */
+bool SaveFile::commitIfChanged(QTemporaryFile &tempFile)
+{
+    if (tempFile.error() != QFileDevice::NoError)
+        return false;
+
+    if (!tempFile.isOpen() && !tempFile.open())
+        return false;
+    if (!tempFile.seek(0))
+        return false;
+
+    const QByteArray contents = tempFile.readAll();
+    tempFile.close();
+
+    QFile existingFile(mFileName);
+    if (existingFile.open(QIODevice::ReadOnly)
+            && existingFile.size() == contents.size()
+            && existingFile.readAll() == contents) {
+        mUnchanged = true;
+        return true;
+    }
+    existingFile.close();
+
+    if (mSafeSavingEnabled) {
+        QSaveFile saveFile(mFileName);
+        if (!saveFile.open(QIODevice::WriteOnly))
+            return false;
+        saveFile.write(contents);
+        return saveFile.commit();
+    }
+
+    QFile file(mFileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(contents);
+    file.close();
+    return file.error() == QFileDevice::NoError;
+}
+
 bool SaveFile::safeSavingEnabled()
 {
     return mSafeSavingEnabled;
@@ -61,4 +112,14 @@ void SaveFile::setSafeSavingEnabled(bool enabled)
     mSafeSavingEnabled = enabled;
 }
 
+bool SaveFile::skipUnchangedEnabled()
+{
+    return mSkipUnchangedEnabled;
+}
+
+void SaveFile::setSkipUnchangedEnabled(bool enabled)
+{
+    mSkipUnchangedEnabled = enabled;
+}
+
 } // namespace Tiled
@@ -35,11 +35,17 @@
 
 #include <memory>
 
+class QTemporaryFile;
+
 namespace Tiled {
 
 /**
  * A wrapper around QSaveFile and QFile. Allows safe writing of files to be
  * turned off globally.
+ *
+ * When skipping of unchanged files is enabled, the data is written to a
+ * temporary file first and the target file is left untouched when its
+ * contents already match, preserving its modification time.
  */
 class TILEDSHARED_EXPORT SaveFile
 {
@@ -51,16 +57,30 @@ public:
     bool open(QIODevice::OpenMode mode);
     bool commit();
 
+    /**
+     * Returns whether the last commit left the target file untouched
+     * because its contents already matched the written data.
+     */
+    bool unchanged() const;
+
     QFileDevice::FileError error() const;
     QString errorString() const;
 
     static bool safeSavingEnabled();
     static void setSafeSavingEnabled(bool enabled);
 
+    static bool skipUnchangedEnabled();
+    static void setSkipUnchangedEnabled(bool enabled);
+
 private:
+    bool commitIfChanged(QTemporaryFile &tempFile);
+
     std::unique_ptr<QFileDevice> mFileDevice;
+    QString mFileName;
+    bool mUnchanged = false;
 
     static bool mSafeSavingEnabled;
+    static bool mSkipUnchangedEnabled;
 };
 
 
@@ -74,6 +94,11 @@ inline bool SaveFile::open(QIODevice::OpenMode mode)
     return mFileDevice->open(mode);
 }
 
+inline bool SaveFile::unchanged() const
+{
+    return mUnchanged;
+}
+
 inline QFileDevice::FileError SaveFile::error() const
 {
     return mFileDevice->error();
@@ -0,0 +1,86 @@
+/*
+ * streamedtilereader.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "streamedtilereader.h"
+
+#include <QIODevice>
+
+namespace Tiled {
+
+StreamedTileReader::StreamedTileReader(QIODevice &device, int bufferSize)
+    : mDevice(device)
+    , mBuffer(qMax(1, bufferSize), Qt::Uninitialized)
+{
+}
+
+/**
+ * Refills the buffer from the device, reading at most \a maxBytes so that
+ * the device position never moves past the requested data. Returns false
+ * when no more data is available.
+ */
+bool StreamedTileReader::refill(qint64 maxBytes)
+{
+    const qint64 read = mDevice.read(mBuffer.data(),
+                                     qMin<qint64>(mBuffer.size(), maxBytes));
+    if (read <= 0)
+        return false;
+
+    mPos = 0;
+    mEnd = int(read);
+    return true;
+}
+
+/**
+ * Skips the given number of \a bytes, for example over an interleaved
+ * section that is not tile data. Returns false when the stream ends early.
+ */
+bool StreamedTileReader::skip(qint64 bytes)
+{
+    while (bytes > 0) {
+        if (mPos == mEnd && !refill(bytes))
+            return false;
+
+        const qint64 n = qMin<qint64>(mEnd - mPos, bytes);
+        mPos += int(n);
+        mBytesRead += n;
+        bytes -= n;
+    }
+
+    return true;
+}
+
+/**
+ * Returns whether all data has been consumed, taking both the buffer and
+ * the device into account.
+ */
+bool StreamedTileReader::atEnd()
+{
+    return mPos == mEnd && mDevice.atEnd();
+}
+
+} // namespace Tiled
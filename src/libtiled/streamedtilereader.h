@@ -0,0 +1,122 @@
+/*
+ * streamedtilereader.h
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tilelayer.h"
+
+#include <QByteArray>
+
+class QIODevice;
+
+namespace Tiled {
+
+/**
+ * Reads the tile data of a layer from a binary stream in row-major order.
+ *
+ * Binary map formats commonly store one record per cell. Reading them used
+ * to mean loading the whole layer into a QByteArray and then calling
+ * TileLayer::setCell() per cell. This helper instead pulls the stream
+ * through a fixed-size buffer and writes the decoded cells with a
+ * TileLayer::CellWriter, so imports run in O(buffer) memory and do one
+ * chunk lookup per run of cells rather than one per cell.
+ *
+ * The decode functor turns a raw record into a Cell. Cells it reports as
+ * empty are skipped, which leaves the corresponding chunks unallocated.
+ *
+ * The reader never consumes more from the device than was requested, so
+ * readLayer() and skip() can be freely interleaved with other reads from
+ * the same device, such as parsing layer headers through a QDataStream.
+ */
+class TILEDSHARED_EXPORT StreamedTileReader
+{
+public:
+    explicit StreamedTileReader(QIODevice &device,
+                                int bufferSize = DefaultBufferSize);
+
+    /**
+     * Reads area.width() * area.height() single-byte records into \a layer,
+     * calling \a decode on each. Returns false when the stream ends early.
+     */
+    template <typename Decode>
+    bool readLayer(TileLayer &layer, const QRect &area, Decode &&decode);
+
+    bool skip(qint64 bytes);
+    bool atEnd();
+
+    qint64 bytesRead() const { return mBytesRead; }
+
+    static constexpr int DefaultBufferSize = 64 * 1024;
+
+private:
+    bool refill(qint64 maxBytes);
+
+    QIODevice &mDevice;
+    QByteArray mBuffer;
+    int mPos = 0;
+    int mEnd = 0;
+    qint64 mBytesRead = 0;
+};
+
+template <typename Decode>
+bool StreamedTileReader::readLayer(TileLayer &layer, const QRect &area,
+                                   Decode &&decode)
+{
+    TileLayer::CellWriter writer(layer);
+
+    int x = area.x();
+    int y = area.y();
+    qint64 remaining = qint64(area.width()) * area.height();
+
+    while (remaining > 0) {
+        if (mPos == mEnd && !refill(remaining))
+            return false;
+
+        const auto *p = reinterpret_cast<const quint8*>(mBuffer.constData() + mPos);
+        const int n = int(qMin<qint64>(mEnd - mPos, remaining));
+
+        for (int i = 0; i < n; ++i) {
+            const Cell cell = decode(p[i]);
+            if (!cell.isEmpty())
+                writer.setCell(x, y, cell);
+
+            if (++x == area.x() + area.width()) {
+                x = area.x();
+                ++y;
+            }
+        }
+
+        mPos += n;
+        mBytesRead += n;
+        remaining -= n;
+    }
+
+    return true;
+}
+
+} // namespace Tiled
@@ -28,6 +28,9 @@
 
 #include "tile.h"
 
+#include "map.h"
+#include "mapobject.h"
+#include "maprenderer.h"
 #include "objectgroup.h"
 #include "tileset.h"
 
@@ -170,6 +173,7 @@ void Tile::setObjectGroup(std::unique_ptr<ObjectGroup> objectGroup)
         return;
 
     mObjectGroup = std::move(objectGroup);
+    mCollisionShapes.reset();
 }
 
 /**
@@ -180,6 +184,82 @@ void Tile::setObjectGroup(std::unique_ptr<ObjectGroup> objectGroup)
 void Tile::swapObjectGroup(std::unique_ptr<ObjectGroup> &objectGroup)
 {
     std::swap(mObjectGroup, objectGroup);
+    mCollisionShapes.reset();
+}
+
+/**
+ * Returns a transform that rotates by \a rotation degrees around the given
+ * \a position.
+ */
+static QTransform rotateAt(const QPointF &position, qreal rotation)
+{
+    QTransform transform;
+    transform.translate(position.x(), position.y());
+    transform.rotate(rotation);
+    transform.translate(-position.x(), -position.y());
+    return transform;
+}
+
+/**
+ * Returns the collision shapes of this tile, in tile coordinates and with
+ * object rotation applied. The returned vector is parallel to the objects of
+ * the tile's object group, and empty when the tile has none.
+ *
+ * The shapes are built on first use and cached until the object group
+ * changes, since deriving them again for every paint made the tile collision
+ * overlay expensive on dense maps.
+ */
+const QVector<QPainterPath> &Tile::collisionShapes() const
+{
+    if (!mCollisionShapes.has_value()) {
+        if (mObjectGroup)
+            mCollisionShapes = buildCollisionShapes(*mObjectGroup, *mTileset);
+        else
+            mCollisionShapes.emplace();
+    }
+    return *mCollisionShapes;
+}
+
+/**
+ * Sets precomputed collision shapes, as built by buildCollisionShapes. Used
+ * to deliver shapes that were built on a worker thread. Ignored when the
+ * shapes don't match the current object group.
+ */
+void Tile::setCollisionShapes(QVector<QPainterPath> shapes)
+{
+    const int objectCount = mObjectGroup ? mObjectGroup->objectCount() : 0;
+    if (shapes.size() == objectCount)
+        mCollisionShapes = std::move(shapes);
+}
+
+/**
+ * Builds the collision shapes for \a objectGroup, interpreted in the context
+ * of \a tileset. A pure function, so that the shapes can be built on a worker
+ * thread before the overlay first paints.
+ */
+QVector<QPainterPath> Tile::buildCollisionShapes(const ObjectGroup &objectGroup,
+                                                 const Tileset &tileset)
+{
+    const bool isIsometric = tileset.orientation() == Tileset::Isometric;
+    Map::Parameters mapParameters;
+    mapParameters.orientation = isIsometric ? Map::Isometric : Map::Orthogonal;
+    mapParameters.width = 1;
+    mapParameters.height = 1;
+    mapParameters.tileWidth = tileset.gridSize().width();
+    mapParameters.tileHeight = tileset.gridSize().height();
+    const Map map(mapParameters);
+    const auto renderer = MapRenderer::create(&map);
+
+    QVector<QPainterPath> shapes;
+    shapes.reserve(objectGroup.objectCount());
+
+    for (MapObject *object : objectGroup) {
+        const auto transform = rotateAt(renderer->pixelToScreenCoords(object->position()),
+                                        object->rotation());
+        shapes.append(transform.map(renderer->shape(object)));
+    }
+
+    return shapes;
 }
 
 /**
@@ -221,6 +301,17 @@ bool Tile::advanceAnimation(int ms)
 
     mUnusedTime += ms;
 
+    // When catching up over a long time, for example after having been
+    // paused while off-screen, skip entire animation loops at once.
+    if (mUnusedTime > 1000) {
+        int totalDuration = 0;
+        for (const Frame &frame : std::as_const(mFrames))
+            totalDuration += frame.duration;
+
+        if (totalDuration > 0 && mUnusedTime > totalDuration)
+            mUnusedTime %= totalDuration;
+    }
+
     Frame frame = mFrames.at(mCurrentFrameIndex);
     const int previousTileId = frame.tileId;
 
@@ -102,6 +102,11 @@ public:
     void setObjectGroup(std::unique_ptr<ObjectGroup> objectGroup);
     void swapObjectGroup(std::unique_ptr<ObjectGroup> &objectGroup);
 
+    const QVector<QPainterPath> &collisionShapes() const;
+    void setCollisionShapes(QVector<QPainterPath> shapes);
+    static QVector<QPainterPath> buildCollisionShapes(const ObjectGroup &objectGroup,
+                                                      const Tileset &tileset);
+
     const QVector<Frame> &frames() const;
     void setFrames(const QVector<Frame> &frames);
     bool isAnimated() const;
@@ -124,6 +129,7 @@ private:
     LoadingStatus mImageStatus;
     qreal mProbability;
     std::unique_ptr<ObjectGroup> mObjectGroup;
+    mutable std::optional<QVector<QPainterPath>> mCollisionShapes;  // cache
 
     QVector<Frame> mFrames;
     int mCurrentFrameIndex;
@@ -29,17 +29,20 @@
 
 #include "tilelayer.h"
 
-#include "containerhelpers.h"
 #include "hex.h"
 #include "tile.h"
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 
 #include <QSet>
+#include <QtAlgorithms>
 
 using namespace Tiled;
 
+static_assert(CHUNK_SIZE <= 16, "Chunk occupancy rows are 16 bits wide");
+
 Cell Cell::empty;
 
 void Cell::rotate(RotateDirection direction)
@@ -83,20 +86,119 @@ QRegion Chunk::region(std::function<bool (const Cell &)> condition) const
     return region;
 }
 
+/**
+ * Calculates the region of this chunk occupied by non-empty cells, emitting
+ * row spans directly from the occupancy bitmasks.
+ */
+QRegion Chunk::region() const
+{
+    if (mOccupiedCount == CHUNK_SIZE * CHUNK_SIZE)
+        return QRegion(0, 0, CHUNK_SIZE, CHUNK_SIZE);
+
+    QRegion region;
+
+    for (int y = 0; y < CHUNK_SIZE; ++y) {
+        quint16 row = mOccupiedRows[y];
+        int x = 0;
+
+        while (row) {
+            while (!(row & 1)) {
+                row >>= 1;
+                ++x;
+            }
+
+            const int rangeStart = x;
+            while (row & 1) {
+                row >>= 1;
+                ++x;
+            }
+
+            region += QRect(rangeStart, y, x - rangeStart, 1);
+        }
+    }
+
+    return region;
+}
+
 void Chunk::setCell(int x, int y, const Cell &cell)
 {
     int index = x + y * CHUNK_SIZE;
 
+    if (mGrid.at(index).isEmpty() != cell.isEmpty()) {
+        const quint16 bit = quint16(1u << x);
+
+        if (cell.isEmpty()) {
+            mOccupiedRows[y] &= ~bit;
+            --mOccupiedCount;
+        } else {
+            mOccupiedRows[y] |= bit;
+            ++mOccupiedCount;
+        }
+    }
+
     mGrid[index] = cell;
 }
 
-bool Chunk::isEmpty() const
+/**
+ * Copies a run of \a count cells into row \a y, starting at column \a x.
+ *
+ * Behaves like calling setCell() for each cell, except that the cells are
+ * copied as one contiguous block and the occupancy bookkeeping is updated
+ * once for the whole run.
+ */
+void Chunk::setCells(int x, int y, const Cell *cells, int count)
 {
+    std::copy(cells, cells + count, mGrid.begin() + (x + y * CHUNK_SIZE));
+
+    quint16 occupied = 0;
+    for (int i = 0; i < count; ++i)
+        if (!cells[i].isEmpty())
+            occupied |= quint16(1u << (x + i));
+
+    const quint16 mask = quint16(((1u << count) - 1) << x);
+    mOccupiedCount += qPopulationCount(occupied) - qPopulationCount(quint16(mOccupiedRows[y] & mask));
+    mOccupiedRows[y] = (mOccupiedRows[y] & ~mask) | occupied;
+}
+
+/**
+ * Clears a run of \a count cells in row \a y, starting at column \a x.
+ */
+void Chunk::eraseCells(int x, int y, int count)
+{
+    const auto first = mGrid.begin() + (x + y * CHUNK_SIZE);
+    std::fill(first, first + count, Cell());
+
+    const quint16 mask = quint16(((1u << count) - 1) << x);
+    mOccupiedCount -= qPopulationCount(quint16(mOccupiedRows[y] & mask));
+    mOccupiedRows[y] &= ~mask;
+}
+
+/**
+ * Returns whether this chunk holds the same cells as \a other.
+ *
+ * The occupancy bitmasks are compared first, which rejects most unequal
+ * chunks without touching any cells and limits the cell comparison to
+ * occupied rows. The cells themselves can't be compared with a plain
+ * memcmp, because the transient Checked flag takes no part in cell
+ * identity.
+ */
+bool Chunk::operator==(const Chunk &other) const
+{
+    if (mOccupiedCount != other.mOccupiedCount)
+        return false;
+    if (memcmp(mOccupiedRows, other.mOccupiedRows, sizeof(mOccupiedRows)) != 0)
+        return false;
+
     for (int y = 0; y < CHUNK_SIZE; ++y) {
-        for (int x = 0; x < CHUNK_SIZE; ++x) {
-            if (!cellAt(x, y).isEmpty())
+        if (!mOccupiedRows[y])
+            continue;
+
+        const Cell *a = mGrid.constData() + y * CHUNK_SIZE;
+        const Cell *b = other.mGrid.constData() + y * CHUNK_SIZE;
+
+        for (int x = 0; x < CHUNK_SIZE; ++x)
+            if (a[x] != b[x])
                 return false;
-        }
     }
 
     return true;
@@ -115,7 +217,7 @@ void Chunk::removeReferencesToTileset(Tileset *tileset)
 {
     for (int i = 0, i_end = mGrid.size(); i < i_end; ++i) {
         if (mGrid.at(i).tileset() == tileset)
-            mGrid.replace(i, Cell::empty);
+            setCell(i & CHUNK_MASK, i >> CHUNK_BITS, Cell::empty);
     }
 }
 
@@ -127,6 +229,114 @@ void Chunk::replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTileset)
     }
 }
 
+/**
+ * Packs the cells of the given \a chunk into this structure-of-arrays form.
+ *
+ * Returns false when the chunk cannot be represented (too many distinct
+ * tilesets or a tile ID out of range), in which case this PackedChunk is
+ * left unmodified.
+ */
+bool PackedChunk::pack(const Chunk &chunk)
+{
+    QVector<quint32> packedCells(CHUNK_SIZE * CHUNK_SIZE);
+    QVarLengthArray<Tileset*, 8> palette;
+
+    int index = 0;
+    for (const Cell &cell : chunk) {
+        quint32 value = 0;
+
+        if (Tileset *tileset = cell.tileset()) {
+            if (cell.tileId() < 0 || cell.tileId() >= TileIdMask - 1)
+                return false;
+
+            int paletteIndex = palette.indexOf(tileset);
+            if (paletteIndex == -1) {
+                if (palette.size() == 256)
+                    return false;
+                paletteIndex = palette.size();
+                palette.append(tileset);
+            }
+
+            value = quint32(cell.tileId() + 1)
+                    | quint32(cell.flags()) << FlagsShift
+                    | quint32(paletteIndex) << PaletteShift;
+        }
+
+        packedCells[index++] = value;
+    }
+
+    mPackedCells.swap(packedCells);
+    mPalette = palette;
+    return true;
+}
+
+Chunk PackedChunk::unpacked() const
+{
+    Chunk chunk;
+
+    for (int index = 0; index < mPackedCells.size(); ++index) {
+        const quint32 value = mPackedCells.at(index);
+
+        if (const quint32 tileIdPlusOne = value & TileIdMask) {
+            Cell cell;
+            cell.setTile(mPalette.at(value >> PaletteShift),
+                         int(tileIdPlusOne) - 1);
+            cell.setFlippedHorizontally(value & (1u << FlagsShift));
+            cell.setFlippedVertically(value & (2u << FlagsShift));
+            cell.setFlippedAntiDiagonally(value & (4u << FlagsShift));
+            cell.setRotatedHexagonal120(value & (8u << FlagsShift));
+
+            chunk.setCell(index & CHUNK_MASK, index >> CHUNK_BITS, cell);
+        }
+    }
+
+    return chunk;
+}
+
+bool PackedChunk::isEmpty() const
+{
+    for (const quint32 value : mPackedCells)
+        if (value & TileIdMask)
+            return false;
+
+    return true;
+}
+
+/**
+ * Adds the number of cells referencing each tileset in this chunk to
+ * \a counts, without unpacking the cells.
+ */
+void PackedChunk::addCellCounts(QHash<Tileset*, int> &counts) const
+{
+    for (const quint32 value : mPackedCells) {
+        if ((value & TileIdMask) == 0)
+            continue;
+
+        if (Tileset *tileset = mPalette.at(value >> PaletteShift))
+            ++counts[tileset];
+    }
+}
+
+void PackedChunk::removeReferencesToTileset(Tileset *tileset)
+{
+    const int paletteIndex = mPalette.indexOf(tileset);
+    if (paletteIndex == -1)
+        return;
+
+    for (quint32 &value : mPackedCells)
+        if ((value & TileIdMask) && int(value >> PaletteShift) == paletteIndex)
+            value = 0;
+
+    mPalette[paletteIndex] = nullptr;
+}
+
+void PackedChunk::replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTileset)
+{
+    const int paletteIndex = mPalette.indexOf(oldTileset);
+    if (paletteIndex != -1)
+        mPalette[paletteIndex] = newTileset;
+}
+
 TileLayer::TileLayer(const QString &name, int x, int y, int width, int height)
     : Layer(TileLayerType, name, x, y)
     , mWidth(width)
@@ -172,9 +382,82 @@ static QMargins computeDrawMargins(const QSet<SharedTileset> &tilesets)
 
 QMargins TileLayer::drawMargins() const
 {
+    // While chunks are still awaiting decoding, which tilesets this layer
+    // uses is not yet known. Compute conservative margins from all tilesets
+    // of the map rather than forcing a full decode before the first paint.
+    if (!mDeferredChunks.isEmpty()) {
+        if (const Map *map = this->map()) {
+            const auto &tilesets = map->tilesets();
+#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
+            return computeDrawMargins(tilesets.toList().toSet());
+#else
+            return computeDrawMargins(QSet<SharedTileset>(tilesets.begin(),
+                                                          tilesets.end()));
+#endif
+        }
+    }
+
     return computeDrawMargins(usedTilesets());
 }
 
+// Spreads the bits of \a v out to the even bit positions.
+static quint64 spreadBits(quint32 v)
+{
+    quint64 x = v;
+    x = (x | (x << 16)) & Q_UINT64_C(0x0000FFFF0000FFFF);
+    x = (x | (x << 8))  & Q_UINT64_C(0x00FF00FF00FF00FF);
+    x = (x | (x << 4))  & Q_UINT64_C(0x0F0F0F0F0F0F0F0F);
+    x = (x | (x << 2))  & Q_UINT64_C(0x3333333333333333);
+    x = (x | (x << 1))  & Q_UINT64_C(0x5555555555555555);
+    return x;
+}
+
+// Z-order curve index of a chunk position. The sign bits are flipped so
+// that negative coordinates sort before positive ones.
+static quint64 mortonCode(QPoint p)
+{
+    const quint32 x = quint32(p.x()) ^ 0x80000000;
+    const quint32 y = quint32(p.y()) ^ 0x80000000;
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+/**
+ * Returns the positions of all chunks of this layer, in units of chunks,
+ * in the given traversal \a order.
+ */
+QVector<QPoint> TileLayer::chunkKeys(ChunkOrder order) const
+{
+    materializeAllChunks();
+
+    QVector<QPoint> keys;
+    keys.reserve(mChunks.size());
+    for (auto it = mChunks.cbegin(); it != mChunks.cend(); ++it)
+        keys.append(it.key());
+
+    switch (order) {
+    case ChunkOrder::Unordered:
+        break;
+    case ChunkOrder::RowMajor:
+        std::sort(keys.begin(), keys.end(), [] (QPoint a, QPoint b) {
+            return a.y() != b.y() ? a.y() < b.y() : a.x() < b.x();
+        });
+        break;
+    case ChunkOrder::Morton:
+        std::sort(keys.begin(), keys.end(), [] (QPoint a, QPoint b) {
+            return mortonCode(a) < mortonCode(b);
+        });
+        break;
+    }
+
+    return keys;
+}
+
+TileLayer::CellRange::CellRange(const TileLayer &layer, ChunkOrder order)
+    : mLayer(layer)
+    , mChunkKeys(layer.chunkKeys(order))
+{
+}
+
 /**
  * Calculates the region of cells in this tile layer for which the given
  * \a condition returns true.
@@ -183,46 +466,326 @@ QRegion TileLayer::region(std::function<bool (const Cell &)> condition) const
 {
     QRegion region;
 
-    QHashIterator<QPoint, Chunk> it(mChunks);
-    while (it.hasNext()) {
-        it.next();
-        region += it.value().region(condition).translated(it.key().x() * CHUNK_SIZE + mX,
-                                                          it.key().y() * CHUNK_SIZE + mY);
+    // Row-major order both makes the result deterministic to compute and
+    // lets QRegion extend its last band instead of merging rectangles that
+    // arrive in random vertical order.
+    const auto keys = chunkKeys(ChunkOrder::RowMajor);
+    for (const QPoint &key : keys) {
+        const Chunk &chunk = mChunks.constFind(key).value();
+        region += chunk.region(condition).translated(key.x() * CHUNK_SIZE + mX,
+                                                     key.y() * CHUNK_SIZE + mY);
     }
 
     return region;
 }
 
+/**
+ * Calculates the region of cells comparing equal to \a match, which needs to
+ * reference a tile. Unlike the condition-based overload, only the chunks
+ * known through the tile occurrence index to contain that tile are scanned.
+ */
+QRegion TileLayer::region(const Cell &match) const
+{
+    Q_ASSERT(!match.isEmpty());
+
+    QRegion region;
+
+    const auto keys = occurrenceChunks(match);
+    for (const QPoint &key : keys) {
+        const Chunk *chunk = findChunk(key.x() * CHUNK_SIZE,
+                                       key.y() * CHUNK_SIZE);
+        if (!chunk)
+            continue;
+
+        const auto condition = [&] (const Cell &cell) { return cell == match; };
+        region += chunk->region(condition).translated(key.x() * CHUNK_SIZE + mX,
+                                                      key.y() * CHUNK_SIZE + mY);
+    }
+
+    return region;
+}
+
+/**
+ * Calculates the region occupied by the tiles of this layer. Similar to
+ * Layer::bounds(), but leaves out the regions without tiles.
+ *
+ * Unlike the condition-based overload, the region is assembled from the
+ * per-chunk occupancy bitmasks, without looking at any cells.
+ */
+QRegion TileLayer::region() const
+{
+    QRegion region;
+
+    const auto keys = chunkKeys(ChunkOrder::RowMajor);
+    for (const QPoint &key : keys) {
+        const Chunk &chunk = mChunks.constFind(key).value();
+        region += chunk.region().translated(key.x() * CHUNK_SIZE + mX,
+                                            key.y() * CHUNK_SIZE + mY);
+    }
+
+    return region;
+}
+
+/**
+ * Called when the chunk at \a chunkPos gained its first cell or lost its
+ * last one (or, for packed and deferred chunks, when it is added or goes
+ * away). Maintains the per-column and per-row occupancy counts and keeps
+ * mBounds in sync, shrinking it when an extreme column or row empties.
+ */
+void TileLayer::chunkOccupancyChanged(QPoint chunkPos, bool occupied)
+{
+    if (occupied) {
+        ++mOccupiedChunkColumns[chunkPos.x()];
+        ++mOccupiedChunkRows[chunkPos.y()];
+        mBounds |= QRect(chunkPos.x() * CHUNK_SIZE,
+                         chunkPos.y() * CHUNK_SIZE,
+                         CHUNK_SIZE, CHUNK_SIZE);
+        return;
+    }
+
+    auto column = mOccupiedChunkColumns.find(chunkPos.x());
+    if (column != mOccupiedChunkColumns.end() && --column.value() == 0)
+        mOccupiedChunkColumns.erase(column);
+
+    auto row = mOccupiedChunkRows.find(chunkPos.y());
+    if (row != mOccupiedChunkRows.end() && --row.value() == 0)
+        mOccupiedChunkRows.erase(row);
+
+    if (mOccupiedChunkColumns.isEmpty() || mOccupiedChunkRows.isEmpty()) {
+        mBounds = QRect();
+        return;
+    }
+
+    mBounds = QRect(QPoint(mOccupiedChunkColumns.firstKey() * CHUNK_SIZE,
+                           mOccupiedChunkRows.firstKey() * CHUNK_SIZE),
+                    QPoint((mOccupiedChunkColumns.lastKey() + 1) * CHUNK_SIZE - 1,
+                           (mOccupiedChunkRows.lastKey() + 1) * CHUNK_SIZE - 1));
+}
+
+/**
+ * Recomputes the occupancy summary and bounds from scratch. Used after
+ * operations that replace or re-key the chunk storage wholesale.
+ */
+void TileLayer::rebuildOccupancySummary()
+{
+    mOccupiedChunkColumns.clear();
+    mOccupiedChunkRows.clear();
+    QRect bounds;
+
+    const auto add = [&] (QPoint chunkPos) {
+        ++mOccupiedChunkColumns[chunkPos.x()];
+        ++mOccupiedChunkRows[chunkPos.y()];
+        bounds |= QRect(chunkPos.x() * CHUNK_SIZE,
+                        chunkPos.y() * CHUNK_SIZE,
+                        CHUNK_SIZE, CHUNK_SIZE);
+    };
+
+    for (auto it = mChunks.constBegin(); it != mChunks.constEnd(); ++it)
+        if (!it.value().isEmpty())
+            add(it.key());
+    for (auto it = mPackedChunks.constBegin(); it != mPackedChunks.constEnd(); ++it)
+        if (!it.value().isEmpty())
+            add(it.key());
+    for (auto it = mDeferredChunks.constBegin(); it != mDeferredChunks.constEnd(); ++it)
+        add(it.key());
+
+    mBounds = bounds;
+}
+
 /**
  * Sets the cell at the given coordinates.
  */
 void Tiled::TileLayer::setCell(int x, int y, const Cell &cell)
 {
     if (!findChunk(x, y)) {
-        if (cell == Cell::empty && !cell.checked()) {
+        // Avoid creating a chunk when erasing where no chunk exists
+        if (cell == Cell::empty && !cell.checked())
             return;
-        } else {
-            mBounds = mBounds.united(QRect(x - (x & CHUNK_MASK),
-                                           y - (y & CHUNK_MASK),
-                                           CHUNK_SIZE,
-                                           CHUNK_SIZE));
-        }
     }
 
     Chunk &_chunk = chunk(x, y);
+    const bool wasEmpty = _chunk.isEmpty();
 
     if (!mUsedTilesetsDirty) {
         Tileset *oldTileset = _chunk.cellAt(x & CHUNK_MASK, y & CHUNK_MASK).tileset();
         Tileset *newTileset = cell.tileset();
-        if (oldTileset != newTileset) {
-            if (oldTileset)
-                mUsedTilesetsDirty = true;
-            else if (newTileset)
-                mUsedTilesets.insert(newTileset->sharedFromThis());
-        }
+        if (oldTileset != newTileset)
+            updateTilesetUsage(oldTileset, newTileset);
     }
 
     _chunk.setCell(x & CHUNK_MASK, y & CHUNK_MASK, cell);
+
+    if (_chunk.isEmpty() != wasEmpty)
+        chunkOccupancyChanged(QPoint(x >> CHUNK_BITS, y >> CHUNK_BITS), wasEmpty);
+}
+
+/**
+ * Adjusts the used tileset reference counts for a cell changing from
+ * \a oldTileset to \a newTileset. Only called while the counts are known to
+ * be up-to-date.
+ */
+void TileLayer::updateTilesetUsage(Tileset *oldTileset, Tileset *newTileset)
+{
+    if (oldTileset) {
+        auto it = mUsedTilesetCounts.find(oldTileset);
+        if (it != mUsedTilesetCounts.end() && --it.value() == 0) {
+            mUsedTilesets.remove(oldTileset->sharedFromThis());
+            mUsedTilesetCounts.erase(it);
+        }
+    }
+    if (newTileset) {
+        if (++mUsedTilesetCounts[newTileset] == 1)
+            mUsedTilesets.insert(newTileset->sharedFromThis());
+    }
+}
+
+/**
+ * Copies a run of \a count cells to (\a x, \a y). The run must lie within a
+ * single chunk row.
+ */
+void TileLayer::copyRun(int x, int y, const Cell *cells, int count)
+{
+    Chunk &destChunk = chunk(x, y);
+    const bool wasEmpty = destChunk.isEmpty();
+    const int cx = x & CHUNK_MASK;
+    const int cy = y & CHUNK_MASK;
+
+    if (!mUsedTilesetsDirty) {
+        for (int i = 0; i < count; ++i) {
+            Tileset *oldTileset = destChunk.cellAt(cx + i, cy).tileset();
+            Tileset *newTileset = cells[i].tileset();
+            if (oldTileset != newTileset)
+                updateTilesetUsage(oldTileset, newTileset);
+        }
+    }
+
+    destChunk.setCells(cx, cy, cells, count);
+
+    if (destChunk.isEmpty() != wasEmpty)
+        chunkOccupancyChanged(QPoint(x >> CHUNK_BITS, y >> CHUNK_BITS), wasEmpty);
+}
+
+/**
+ * Erases a run of \a count cells at (\a x, \a y). The run must lie within a
+ * single chunk row. No chunk is created where none exists.
+ */
+void TileLayer::eraseRun(int x, int y, int count)
+{
+    if (!findChunk(x, y))
+        return;
+
+    Chunk &destChunk = chunk(x, y);
+    const bool wasEmpty = destChunk.isEmpty();
+    const int cx = x & CHUNK_MASK;
+    const int cy = y & CHUNK_MASK;
+
+    if (!mUsedTilesetsDirty)
+        for (int i = 0; i < count; ++i)
+            if (Tileset *oldTileset = destChunk.cellAt(cx + i, cy).tileset())
+                updateTilesetUsage(oldTileset, nullptr);
+
+    destChunk.eraseCells(cx, cy, count);
+
+    if (!wasEmpty && destChunk.isEmpty())
+        chunkOccupancyChanged(QPoint(x >> CHUNK_BITS, y >> CHUNK_BITS), false);
+}
+
+void TileLayer::CellWriter::setCell(int x, int y, const Cell &cell)
+{
+    const QPoint chunkPos(x >> CHUNK_BITS, y >> CHUNK_BITS);
+
+    if (!mChunk || chunkPos != mChunkPos) {
+        if (!mTarget.findChunk(x, y)) {
+            // Avoid creating a chunk when erasing where no chunk exists
+            if (cell == Cell::empty && !cell.checked())
+                return;
+        }
+
+        // Resolving the chunk may insert into the chunk hash, which can move
+        // other chunks around, so the cached pointer is only refreshed here.
+        mChunk = &mTarget.chunk(x, y);
+        mChunkPos = chunkPos;
+    }
+
+    if (!mTarget.mUsedTilesetsDirty) {
+        Tileset *oldTileset = mChunk->cellAt(x & CHUNK_MASK, y & CHUNK_MASK).tileset();
+        Tileset *newTileset = cell.tileset();
+        if (oldTileset != newTileset)
+            mTarget.updateTilesetUsage(oldTileset, newTileset);
+    }
+
+    const bool wasEmpty = mChunk->isEmpty();
+    mChunk->setCell(x & CHUNK_MASK, y & CHUNK_MASK, cell);
+
+    if (mChunk->isEmpty() != wasEmpty)
+        mTarget.chunkOccupancyChanged(chunkPos, wasEmpty);
+}
+
+/**
+ * Resolves the chunk with the given chunk coordinates along with its eight
+ * neighboring chunks. Missing chunks are stored as null, for which reads
+ * return the empty cell.
+ */
+void TileLayer::NeighborhoodReader::resolveChunks(int cx, int cy)
+{
+    // The first pass materializes any packed or deferred chunks, which can
+    // insert into the chunk hash and move existing chunks around. Pointers
+    // are therefore only taken in a second pass, which no longer inserts.
+    for (int dy = -1; dy <= 1; ++dy)
+        for (int dx = -1; dx <= 1; ++dx)
+            mTarget.findChunk((cx + dx) * CHUNK_SIZE, (cy + dy) * CHUNK_SIZE);
+
+    for (int dy = -1; dy <= 1; ++dy)
+        for (int dx = -1; dx <= 1; ++dx)
+            mChunks[dy + 1][dx + 1] = mTarget.findChunk((cx + dx) * CHUNK_SIZE,
+                                                        (cy + dy) * CHUNK_SIZE);
+
+    mChunkPos = QPoint(cx, cy);
+    mResolved = true;
+}
+
+/**
+ * Sets all cells in the given \a rect to \a cell.
+ *
+ * Equivalent to calling setCell() for each position in the rect, but each
+ * crossed chunk is resolved once per row span rather than once per cell, and
+ * the chunk occupancy is checked once per span. When erasing, spans without
+ * a chunk are skipped entirely.
+ */
+void TileLayer::fillRect(QRect rect, const Cell &cell)
+{
+    if (rect.isEmpty())
+        return;
+
+    const bool erasing = cell == Cell::empty && !cell.checked();
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        for (int x = rect.left(); x <= rect.right();) {
+            const int spanEnd = qMin(rect.right(), x | CHUNK_MASK);
+
+            if (erasing && !findChunk(x, y)) {
+                x = spanEnd + 1;
+                continue;
+            }
+
+            Chunk &_chunk = chunk(x, y);
+            const bool wasEmpty = _chunk.isEmpty();
+            const QPoint chunkPos(x >> CHUNK_BITS, y >> CHUNK_BITS);
+
+            for (; x <= spanEnd; ++x) {
+                if (!mUsedTilesetsDirty) {
+                    Tileset *oldTileset = _chunk.cellAt(x & CHUNK_MASK, y & CHUNK_MASK).tileset();
+                    if (oldTileset != cell.tileset())
+                        updateTilesetUsage(oldTileset, cell.tileset());
+                }
+
+                _chunk.setCell(x & CHUNK_MASK, y & CHUNK_MASK, cell);
+            }
+
+            if (_chunk.isEmpty() != wasEmpty)
+                chunkOccupancyChanged(chunkPos, wasEmpty);
+        }
+    }
 }
 
 std::unique_ptr<TileLayer> TileLayer::copy(const QRegion &region) const
@@ -234,13 +797,8 @@ std::unique_ptr<TileLayer> TileLayer::copy(const QRegion &region) const
                                               0, 0,
                                               regionBounds.width(), regionBounds.height());
 
-    for (const QRect &rect : regionWithContents) {
-        for (int x = rect.left(); x <= rect.right(); ++x)
-            for (int y = rect.top(); y <= rect.bottom(); ++y)
-                copied->setCell(x - regionBounds.x(),
-                                y - regionBounds.y(),
-                                cellAt(x, y));
-    }
+    copied->setCells(-regionBounds.x(), -regionBounds.y(), this,
+                     regionWithContents.translated(-regionBounds.topLeft()));
 
     return copied;
 }
@@ -252,11 +810,43 @@ void TileLayer::merge(QPoint pos, const TileLayer *layer)
     area &= QRect(0, 0, width(), height());
 
     for (int y = area.top(); y <= area.bottom(); ++y) {
-        for (int x = area.left(); x <= area.right(); ++x) {
-            const Cell &cell = layer->cellAt(x - pos.x(),
-                                             y - pos.y());
-            if (!cell.isEmpty())
-                setCell(x, y, cell);
+        for (int x = area.left(); x <= area.right();) {
+            // Split each row at destination and source chunk boundaries, so
+            // that every piece is a contiguous run of cells in both grids.
+            const int runEnd = std::min({ area.right(),
+                                          x | CHUNK_MASK,
+                                          ((x - pos.x()) | CHUNK_MASK) + pos.x() });
+
+            const int sx = x - pos.x();
+            const int sy = y - pos.y();
+
+            const Chunk *sourceChunk = layer->findChunk(sx, sy);
+            if (!sourceChunk) {
+                x = runEnd + 1;
+                continue;
+            }
+
+            const int scx = sx & CHUNK_MASK;
+            const int scy = sy & CHUNK_MASK;
+            const int count = runEnd - x + 1;
+
+            // Only non-empty source cells take part in a merge. The
+            // occupancy bits of the source row directly give the runs of
+            // consecutive occupied cells, which are copied as blocks.
+            quint16 occupied = quint16(sourceChunk->occupiedRow(scy)
+                                       & (((1u << count) - 1) << scx));
+            const Cell *sourceRow = &*(sourceChunk->begin() + scy * CHUNK_SIZE);
+
+            while (occupied) {
+                const int start = qCountTrailingZeroBits(occupied);
+                const int length = qCountTrailingZeroBits(quint16(~(occupied >> start)));
+
+                copyRun(x + (start - scx), y, sourceRow + start, length);
+
+                occupied &= quint16(~(((1u << length) - 1) << start));
+            }
+
+            x = runEnd + 1;
         }
     }
 }
@@ -264,10 +854,90 @@ void TileLayer::merge(QPoint pos, const TileLayer *layer)
 void TileLayer::setCells(int x, int y, const TileLayer *layer,
                          const QRegion &area)
 {
-    for (const QRect &rect : area)
-        for (int _x = rect.left(); _x <= rect.right(); ++_x)
-            for (int _y = rect.top(); _y <= rect.bottom(); ++_y)
-                setCell(_x, _y, layer->cellAt(_x - x, _y - y));
+    QRegion remaining = area;
+
+    // When the translation between source and destination is chunk-aligned,
+    // chunks that are entirely covered by the area can be shared with the
+    // source layer instead of copied cell by cell. Since the cell data of a
+    // chunk is implicitly shared, this makes taking snapshots of large
+    // painted regions (as done by undo commands) O(1) per chunk in memory
+    // and time, until either side modifies the chunk.
+    if ((x & CHUNK_MASK) == 0 && (y & CHUNK_MASK) == 0) {
+        const QRect areaBounds = area.boundingRect();
+        const int left = areaBounds.left() & ~CHUNK_MASK;
+        const int top = areaBounds.top() & ~CHUNK_MASK;
+
+        for (int cy = top; cy <= areaBounds.bottom(); cy += CHUNK_SIZE) {
+            for (int cx = left; cx <= areaBounds.right(); cx += CHUNK_SIZE) {
+                const QRect chunkRect(cx, cy, CHUNK_SIZE, CHUNK_SIZE);
+                if (remaining.intersected(chunkRect) != QRegion(chunkRect))
+                    continue;
+
+                const QPoint key(cx >> CHUNK_BITS, cy >> CHUNK_BITS);
+
+                if (const Chunk *sourceChunk = layer->findChunk(cx - x, cy - y)) {
+                    const auto existing = mChunks.constFind(key);
+                    const auto packed = mPackedChunks.constFind(key);
+                    const bool wasOccupied = mDeferredChunks.contains(key)
+                            || (packed != mPackedChunks.constEnd()
+                                && !packed.value().isEmpty())
+                            || (existing != mChunks.constEnd()
+                                && !existing.value().isEmpty());
+
+                    mPackedChunks.remove(key);
+                    mDeferredChunks.remove(key);
+                    mChunks.insert(key, *sourceChunk);
+                    mUsedTilesetsDirty = true;
+                    mTileOccurrencesDirty = true;
+
+                    const bool isOccupied = !sourceChunk->isEmpty();
+                    if (isOccupied != wasOccupied)
+                        chunkOccupancyChanged(key, isOccupied);
+                } else if (findChunk(cx, cy)) {
+                    Chunk &destChunk = chunk(cx, cy);
+                    const bool wasOccupied = !destChunk.isEmpty();
+                    destChunk = Chunk();
+                    mUsedTilesetsDirty = true;
+                    mTileOccurrencesDirty = true;
+
+                    if (wasOccupied)
+                        chunkOccupancyChanged(key, false);
+                }
+
+                remaining -= chunkRect;
+            }
+        }
+    }
+
+    for (const QRect &rect : remaining) {
+        for (int _y = rect.top(); _y <= rect.bottom(); ++_y) {
+            for (int _x = rect.left(); _x <= rect.right();) {
+                // Split each row at destination and source chunk boundaries,
+                // so that every piece is a contiguous run of cells in both
+                // grids and can be copied or erased as a block.
+                const int runEnd = std::min({ rect.right(),
+                                              _x | CHUNK_MASK,
+                                              ((_x - x) | CHUNK_MASK) + x });
+                const int count = runEnd - _x + 1;
+                const int sx = _x - x;
+                const int sy = _y - y;
+
+                const Chunk *sourceChunk = layer->findChunk(sx, sy);
+                const int scx = sx & CHUNK_MASK;
+                const quint16 mask = quint16(((1u << count) - 1) << scx);
+
+                if (sourceChunk && (sourceChunk->occupiedRow((sy & CHUNK_MASK)) & mask)) {
+                    const Cell *source = &*(sourceChunk->begin()
+                                            + (scx + (sy & CHUNK_MASK) * CHUNK_SIZE));
+                    copyRun(_x, _y, source, count);
+                } else {
+                    eraseRun(_x, _y, count);
+                }
+
+                _x = runEnd + 1;
+            }
+        }
+    }
 }
 
 /**
@@ -278,12 +948,14 @@ void TileLayer::setTiles(const QRegion &area, Tile *tile)
 {
     Q_ASSERT(area.subtracted(QRegion(0, 0, mWidth, mHeight)).isEmpty());
 
+    CellWriter writer(*this);
+
     for (const QRect &rect : area) {
-        for (int x = rect.left(); x <= rect.right(); ++x) {
-            for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            for (int x = rect.left(); x <= rect.right(); ++x) {
                 Cell cell = cellAt(x, y);
                 cell.setTile(tile);
-                setCell(x, y, cell);
+                writer.setCell(x, y, cell);
             }
         }
     }
@@ -294,9 +966,7 @@ void TileLayer::erase(const QRegion &region)
     const QRegion regionWithContents = region.intersected(mBounds);
 
     for (const QRect &rect : regionWithContents)
-        for (int x = rect.left(); x <= rect.right(); ++x)
-            for (int y = rect.top(); y <= rect.bottom(); ++y)
-                setCell(x, y, Cell::empty);
+        fillRect(rect, Cell::empty);
 }
 
 /**
@@ -305,36 +975,88 @@ void TileLayer::erase(const QRegion &region)
 void TileLayer::clear()
 {
     mChunks.clear();
+    mPackedChunks.clear();
+    mDeferredChunks.clear();
     mBounds = QRect();
+    mOccupiedChunkColumns.clear();
+    mOccupiedChunkRows.clear();
     mUsedTilesets.clear();
+    mUsedTilesetCounts.clear();
     mUsedTilesetsDirty = false;
+    mTileOccurrences.clear();
+    mTileOccurrencesDirty = false;
 }
 
+namespace Tiled {
+
+/**
+ * Writes cells into the chunks of a freshly created layer, caching the last
+ * used chunk to avoid a hash lookup per cell.
+ *
+ * Bypasses the used-tileset bookkeeping done by TileLayer::setCell, so it is
+ * only suitable for building up temporary layers whose set of used tilesets
+ * does not matter, like the ones used by the transforms below.
+ */
+class ChunkWriter
+{
+public:
+    explicit ChunkWriter(TileLayer &target) : mTarget(target) {}
+
+    void setCell(int x, int y, const Cell &cell)
+    {
+        const QPoint chunkPos(x >> CHUNK_BITS, y >> CHUNK_BITS);
+        if (!mChunk || chunkPos != mChunkPos) {
+            auto it = mTarget.mChunks.find(chunkPos);
+            if (it == mTarget.mChunks.end()) {
+                it = mTarget.mChunks.insert(chunkPos, Chunk());
+                // Exact as long as only non-empty cells are written, which
+                // holds for the occupancy-scanning transforms below
+                mTarget.chunkOccupancyChanged(chunkPos, true);
+            }
+            mChunk = &it.value();
+            mChunkPos = chunkPos;
+        }
+        mChunk->setCell(x & CHUNK_MASK, y & CHUNK_MASK, cell);
+    }
+
+private:
+    TileLayer &mTarget;
+    Chunk *mChunk = nullptr;
+    QPoint mChunkPos;
+};
+
+} // namespace Tiled
+
 void TileLayer::flip(FlipDirection direction)
 {
+    materializeAllChunks();
+
     const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, mWidth, mHeight);
+    ChunkWriter writer(*newLayer);
 
     Q_ASSERT(direction == FlipHorizontally || direction == FlipVertically);
 
     QHashIterator<QPoint, Chunk> it(mChunks);
     while (it.hasNext()) {
         it.next();
-        for (int y = 0; y < CHUNK_SIZE; ++y) {
-            for (int x = 0; x < CHUNK_SIZE; ++x) {
-                int _x = it.key().x() * CHUNK_SIZE + x;
-                int _y = it.key().y() * CHUNK_SIZE + y;
 
-                Cell dest(it.value().cellAt(x, y));
+        const Chunk &sourceChunk = it.value();
+        const int baseX = it.key().x() * CHUNK_SIZE;
+        const int baseY = it.key().y() * CHUNK_SIZE;
 
-                if (dest.isEmpty())
-                    continue;
+        for (int y = 0; y < CHUNK_SIZE; ++y) {
+            // Scan the occupancy bits to visit only the non-empty cells
+            for (quint16 row = sourceChunk.occupiedRow(y); row; row &= row - 1) {
+                const int x = qCountTrailingZeroBits(row);
+
+                Cell dest(sourceChunk.cellAt(x, y));
 
                 if (direction == FlipHorizontally) {
                     dest.setFlippedHorizontally(!dest.flippedHorizontally());
-                    newLayer->setCell(mWidth - _x - 1, _y, dest);
-                } else if (direction == FlipVertically) {
+                    writer.setCell(mWidth - (baseX + x) - 1, baseY + y, dest);
+                } else {
                     dest.setFlippedVertically(!dest.flippedVertically());
-                    newLayer->setCell(_x, mHeight - _y - 1, dest);
+                    writer.setCell(baseX + x, mHeight - (baseY + y) - 1, dest);
                 }
             }
         }
@@ -342,10 +1064,15 @@ void TileLayer::flip(FlipDirection direction)
 
     mChunks = newLayer->mChunks;
     mBounds = newLayer->mBounds;
+    mOccupiedChunkColumns = newLayer->mOccupiedChunkColumns;
+    mOccupiedChunkRows = newLayer->mOccupiedChunkRows;
+    mTileOccurrencesDirty = true;
 }
 
 void TileLayer::flipHexagonal(FlipDirection direction)
 {
+    materializeAllChunks();
+
     const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, mWidth, mHeight);
 
     Q_ASSERT(direction == FlipHorizontally || direction == FlipVertically);
@@ -356,18 +1083,21 @@ void TileLayer::flipHexagonal(FlipDirection direction)
 
     const unsigned char (&flipMask)[16] = (direction == FlipHorizontally ? flipMaskH : flipMaskV);
 
+    ChunkWriter writer(*newLayer);
+
     QHashIterator<QPoint, Chunk> it(mChunks);
     while (it.hasNext()) {
         it.next();
-        for (int y = 0; y < CHUNK_SIZE; ++y) {
-            for (int x = 0; x < CHUNK_SIZE; ++x) {
-                int _x = it.key().x() * CHUNK_SIZE + x;
-                int _y = it.key().y() * CHUNK_SIZE + y;
 
-                Cell dest(it.value().cellAt(x, y));
+        const Chunk &sourceChunk = it.value();
+        const int baseX = it.key().x() * CHUNK_SIZE;
+        const int baseY = it.key().y() * CHUNK_SIZE;
 
-                if (dest.isEmpty())
-                    continue;
+        for (int y = 0; y < CHUNK_SIZE; ++y) {
+            for (quint16 row = sourceChunk.occupiedRow(y); row; row &= row - 1) {
+                const int x = qCountTrailingZeroBits(row);
+
+                Cell dest(sourceChunk.cellAt(x, y));
 
                 unsigned char mask =
                         (static_cast<unsigned char>(dest.flippedHorizontally()) << 3) |
@@ -383,19 +1113,24 @@ void TileLayer::flipHexagonal(FlipDirection direction)
                 dest.setRotatedHexagonal120((mask & 1) != 0);
 
                 if (direction == FlipHorizontally)
-                    newLayer->setCell(mWidth - _x - 1, _y, dest);
+                    writer.setCell(mWidth - (baseX + x) - 1, baseY + y, dest);
                 else
-                    newLayer->setCell(_x, mHeight - _y - 1, dest);
+                    writer.setCell(baseX + x, mHeight - (baseY + y) - 1, dest);
             }
         }
     }
 
     mChunks = newLayer->mChunks;
     mBounds = newLayer->mBounds;
+    mOccupiedChunkColumns = newLayer->mOccupiedChunkColumns;
+    mOccupiedChunkRows = newLayer->mOccupiedChunkRows;
+    mTileOccurrencesDirty = true;
 }
 
 void TileLayer::rotate(RotateDirection direction)
 {
+    materializeAllChunks();
+
     constexpr unsigned char rotateRightMask[8] = { 5, 4, 1, 0, 7, 6, 3, 2 };
     constexpr unsigned char rotateLeftMask[8]  = { 3, 2, 7, 6, 1, 0, 5, 4 };
 
@@ -406,18 +1141,21 @@ void TileLayer::rotate(RotateDirection direction)
     int newHeight = mWidth;
     const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, newWidth, newHeight);
 
+    ChunkWriter writer(*newLayer);
+
     QHashIterator<QPoint, Chunk> it(mChunks);
     while (it.hasNext()) {
         it.next();
-        for (int y = 0; y < CHUNK_SIZE; ++y) {
-            for (int x = 0; x < CHUNK_SIZE; ++x) {
-                int _x = it.key().x() * CHUNK_SIZE + x;
-                int _y = it.key().y() * CHUNK_SIZE + y;
 
-                Cell dest(it.value().cellAt(x, y));
+        const Chunk &sourceChunk = it.value();
+        const int baseX = it.key().x() * CHUNK_SIZE;
+        const int baseY = it.key().y() * CHUNK_SIZE;
 
-                if (dest.isEmpty())
-                    continue;
+        for (int y = 0; y < CHUNK_SIZE; ++y) {
+            for (quint16 row = sourceChunk.occupiedRow(y); row; row &= row - 1) {
+                const int x = qCountTrailingZeroBits(row);
+
+                Cell dest(sourceChunk.cellAt(x, y));
 
                 unsigned char mask =
                         (dest.flippedHorizontally() << 2) |
@@ -431,9 +1169,9 @@ void TileLayer::rotate(RotateDirection direction)
                 dest.setFlippedAntiDiagonally((mask & 1) != 0);
 
                 if (direction == RotateRight)
-                    newLayer->setCell(mHeight - _y - 1, _x, dest);
+                    writer.setCell(mHeight - (baseY + y) - 1, baseX + x, dest);
                 else
-                    newLayer->setCell(_y, mWidth - _x - 1, dest);
+                    writer.setCell(baseY + y, mWidth - (baseX + x) - 1, dest);
             }
         }
     }
@@ -442,10 +1180,15 @@ void TileLayer::rotate(RotateDirection direction)
     mHeight = newHeight;
     mChunks = newLayer->mChunks;
     mBounds = newLayer->mBounds;
+    mOccupiedChunkColumns = newLayer->mOccupiedChunkColumns;
+    mOccupiedChunkRows = newLayer->mOccupiedChunkRows;
+    mTileOccurrencesDirty = true;
 }
 
 void TileLayer::rotateHexagonal(RotateDirection direction, Map *map)
 {
+    materializeAllChunks();
+
     Map::StaggerIndex staggerIndex = map->staggerIndex();
     Map::StaggerAxis staggerAxis = map->staggerAxis();
 
@@ -531,6 +1274,9 @@ void TileLayer::rotateHexagonal(RotateDirection direction, Map *map)
     mHeight = newHeight;
     mChunks = newLayer->mChunks;
     mBounds = newLayer->mBounds;
+    mOccupiedChunkColumns = newLayer->mOccupiedChunkColumns;
+    mOccupiedChunkRows = newLayer->mOccupiedChunkRows;
+    mTileOccurrencesDirty = true;
 
     QRect filledRect = region().boundingRect();
 
@@ -549,14 +1295,27 @@ void TileLayer::rotateHexagonal(RotateDirection direction, Map *map)
 QSet<SharedTileset> TileLayer::usedTilesets() const
 {
     if (mUsedTilesetsDirty) {
-        QSet<SharedTileset> tilesets;
+        // The tilesets used by deferred chunks are only known once they are
+        // decoded
+        while (!mDeferredChunks.isEmpty())
+            materializeChunk(mDeferredChunks.constBegin().key());
+
+        QHash<Tileset*, int> counts;
 
         for (const Chunk &chunk : mChunks) {
             for (const Cell &cell : chunk)
-                if (const Tile *tile = cell.tile())
-                    tilesets.insert(tile->sharedTileset());
+                if (Tileset *tileset = cell.tileset())
+                    ++counts[tileset];
         }
 
+        for (const PackedChunk &chunk : mPackedChunks)
+            chunk.addCellCounts(counts);
+
+        QSet<SharedTileset> tilesets;
+        for (auto it = counts.constBegin(); it != counts.constEnd(); ++it)
+            tilesets.insert(it.key()->sharedFromThis());
+
+        mUsedTilesetCounts.swap(counts);
         mUsedTilesets.swap(tilesets);
         mUsedTilesetsDirty = false;
     }
@@ -566,6 +1325,8 @@ QSet<SharedTileset> TileLayer::usedTilesets() const
 
 bool TileLayer::hasCell(std::function<bool (const Cell &)> condition) const
 {
+    materializeAllChunks();
+
     for (const Chunk &chunk : mChunks) {
         if (chunk.hasCell(condition))
             return true;
@@ -576,42 +1337,154 @@ bool TileLayer::hasCell(std::function<bool (const Cell &)> condition) const
 
 bool TileLayer::referencesTileset(const Tileset *tileset) const
 {
-    return ::contains(usedTilesets(), tileset);
+    return tilesetCellCount(tileset) > 0;
+}
+
+int TileLayer::tilesetCellCount(const Tileset *tileset) const
+{
+    if (mUsedTilesetsDirty)
+        usedTilesets();     // rebuilds the usage index
+
+    return mUsedTilesetCounts.value(const_cast<Tileset*>(tileset));
+}
+
+QVector<QPoint> TileLayer::occurrenceChunks(const Cell &cell) const
+{
+    if (mTileOccurrencesDirty) {
+        materializeAllChunks();
+
+        QHash<QPair<Tileset*, int>, QVector<QPoint>> occurrences;
+
+        // Row-major chunk order makes each occurrence list come out sorted,
+        // so regions assembled from it extend their last band like the
+        // condition-based region() does
+        const auto keys = chunkKeys(ChunkOrder::RowMajor);
+        for (const QPoint &key : keys) {
+            const Chunk &chunk = mChunks.constFind(key).value();
+
+            QPair<Tileset*, int> lastTile { nullptr, -1 };
+            for (const Cell &c : chunk) {
+                if (!c.tileset())
+                    continue;
+
+                const QPair<Tileset*, int> tile { c.tileset(), c.tileId() };
+                if (tile == lastTile)
+                    continue;
+                lastTile = tile;
+
+                QVector<QPoint> &chunks = occurrences[tile];
+                if (chunks.isEmpty() || chunks.last() != key)
+                    chunks.append(key);
+            }
+        }
+
+        mTileOccurrences.swap(occurrences);
+        mTileOccurrencesDirty = false;
+    }
+
+    return mTileOccurrences.value({ cell.tileset(), cell.tileId() });
 }
 
 void TileLayer::removeReferencesToTileset(Tileset *tileset)
 {
+    while (!mDeferredChunks.isEmpty())
+        materializeChunk(mDeferredChunks.constBegin().key());
+
     for (Chunk &chunk : mChunks)
         chunk.removeReferencesToTileset(tileset);
 
+    for (PackedChunk &chunk : mPackedChunks)
+        chunk.removeReferencesToTileset(tileset);
+
     mUsedTilesets.remove(tileset->sharedFromThis());
+    mUsedTilesetCounts.remove(tileset);
+    mTileOccurrencesDirty = true;
 }
 
 void TileLayer::replaceReferencesToTileset(Tileset *oldTileset,
                                            Tileset *newTileset)
 {
+    while (!mDeferredChunks.isEmpty())
+        materializeChunk(mDeferredChunks.constBegin().key());
+
     for (Chunk &chunk : mChunks)
         chunk.replaceReferencesToTileset(oldTileset, newTileset);
 
+    for (PackedChunk &chunk : mPackedChunks)
+        chunk.replaceReferencesToTileset(oldTileset, newTileset);
+
     if (mUsedTilesets.remove(oldTileset->sharedFromThis()))
         mUsedTilesets.insert(newTileset->sharedFromThis());
+
+    auto countIt = mUsedTilesetCounts.find(oldTileset);
+    if (countIt != mUsedTilesetCounts.end()) {
+        mUsedTilesetCounts[newTileset] += countIt.value();
+        mUsedTilesetCounts.erase(countIt);
+    }
+
+    mTileOccurrencesDirty = true;
 }
 
 void TileLayer::resize(QSize size, QPoint offset)
 {
+    materializeAllChunks();
+
     if (this->size() == size && offset.isNull())
         return;
 
+    const QRect newRect(0, 0, size.width(), size.height());
+
+    if ((offset.x() & CHUNK_MASK) == 0 && (offset.y() & CHUNK_MASK) == 0) {
+        // A chunk-aligned offset (usually no offset at all, as when growing
+        // a map at the bottom or right edge) requires no cell copies: the
+        // chunks are re-keyed as-is, keeping any implicit sharing with
+        // clones of this layer intact, and only the cells that fall outside
+        // of the new size are erased.
+        if (!offset.isNull()) {
+            const QPoint chunkOffset(offset.x() >> CHUNK_BITS,
+                                     offset.y() >> CHUNK_BITS);
+
+            QHash<QPoint, Chunk> movedChunks;
+            movedChunks.reserve(mChunks.size());
+            for (auto it = mChunks.begin(); it != mChunks.end(); ++it)
+                movedChunks.insert(it.key() + chunkOffset, std::move(it.value()));
+            mChunks = std::move(movedChunks);
+            rebuildOccupancySummary();
+            mTileOccurrencesDirty = true;
+        }
+
+        setSize(size);
+
+        // The erase shrinks the bounds through the occupancy summary as
+        // chunks empty out; afterwards only the empty chunks are dropped
+        erase(QRegion(mBounds) - newRect);
+
+        for (auto it = mChunks.begin(); it != mChunks.end();) {
+            if (it.value().isEmpty())
+                it = mChunks.erase(it);
+            else
+                ++it;
+        }
+        return;
+    }
+
     const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, size.width(), size.height());
 
     // Copy over the preserved part
-    QRect area = mBounds.translated(offset).intersected(newLayer->rect());
+    const QRect area = mBounds.translated(offset).intersected(newLayer->rect());
+    CellWriter writer(*newLayer);
     for (int y = area.top(); y <= area.bottom(); ++y)
         for (int x = area.left(); x <= area.right(); ++x)
-            newLayer->setCell(x, y, cellAt(x - offset.x(), y - offset.y()));
+            writer.setCell(x, y, cellAt(x - offset.x(), y - offset.y()));
 
     mChunks = newLayer->mChunks;
     mBounds = newLayer->mBounds;
+    mOccupiedChunkColumns = newLayer->mOccupiedChunkColumns;
+    mOccupiedChunkRows = newLayer->mOccupiedChunkRows;
+    mTileOccurrencesDirty = true;
+    mUsedTilesets = newLayer->mUsedTilesets;
+    mUsedTilesetCounts = newLayer->mUsedTilesetCounts;
+    mUsedTilesetsDirty = newLayer->mUsedTilesetsDirty;
     setSize(size);
 }
 
@@ -655,10 +1528,15 @@ void TileLayer::offsetTiles(QPoint offset,
 
     mChunks = newLayer->mChunks;
     mBounds = newLayer->mBounds;
+    mOccupiedChunkColumns = newLayer->mOccupiedChunkColumns;
+    mOccupiedChunkRows = newLayer->mOccupiedChunkRows;
+    mTileOccurrencesDirty = true;
 }
 
 void TileLayer::offsetTiles(QPoint offset)
 {
+    materializeAllChunks();
+
     const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, 0, 0);
 
     // Process only the allocated chunks
@@ -683,6 +1561,9 @@ void TileLayer::offsetTiles(QPoint offset)
 
     mChunks = newLayer->mChunks;
     mBounds = newLayer->mBounds;
+    mOccupiedChunkColumns = newLayer->mOccupiedChunkColumns;
+    mOccupiedChunkRows = newLayer->mOccupiedChunkRows;
+    mTileOccurrencesDirty = true;
 }
 
 bool TileLayer::canMergeWith(const Layer *other) const
@@ -719,6 +1600,56 @@ QRegion TileLayer::computeDiffRegion(const TileLayer &other) const
     const int dx = other.x() - mX;
     const int dy = other.y() - mY;
 
+    // When the layers line up, the chunks of both layers can be walked
+    // directly. This avoids a chunk lookup per cell and skips chunks and
+    // rows that are equal or empty on both sides entirely.
+    if (dx == 0 && dy == 0) {
+        materializeAllChunks();
+        other.materializeAllChunks();
+
+        static const Chunk emptyChunk;
+
+        auto addChunkDiff = [&ret](QPoint key,
+                                   const Chunk &chunkA,
+                                   const Chunk &chunkB) {
+            if (chunkA == chunkB)
+                return;
+
+            const int originX = key.x() * CHUNK_SIZE;
+            const int originY = key.y() * CHUNK_SIZE;
+
+            for (int y = 0; y < CHUNK_SIZE; ++y) {
+                if (!(chunkA.occupiedRow(y) | chunkB.occupiedRow(y)))
+                    continue;
+
+                for (int x = 0; x < CHUNK_SIZE; ++x) {
+                    if (chunkA.cellAt(x, y) != chunkB.cellAt(x, y)) {
+                        const int rangeStart = x;
+                        while (x < CHUNK_SIZE &&
+                               chunkA.cellAt(x, y) != chunkB.cellAt(x, y)) {
+                            ++x;
+                        }
+                        ret += QRect(originX + rangeStart, originY + y,
+                                     x - rangeStart, 1);
+                    }
+                }
+            }
+        };
+
+        for (auto it = mChunks.cbegin(); it != mChunks.cend(); ++it) {
+            const auto otherIt = other.mChunks.constFind(it.key());
+            addChunkDiff(it.key(), it.value(),
+                         otherIt != other.mChunks.cend() ? otherIt.value()
+                                                         : emptyChunk);
+        }
+
+        for (auto it = other.mChunks.cbegin(); it != other.mChunks.cend(); ++it)
+            if (!mChunks.contains(it.key()))
+                addChunkDiff(it.key(), emptyChunk, it.value());
+
+        return ret;
+    }
+
     const QRect r = bounds().united(other.bounds()).translated(-position());
 
     for (int y = r.top(); y <= r.bottom(); ++y) {
@@ -740,10 +1671,19 @@ QRegion TileLayer::computeDiffRegion(const TileLayer &other) const
 
 bool TileLayer::isEmpty() const
 {
+    // Deferred chunks are assumed to contain tiles, since empty chunks are
+    // not written out
+    if (!mDeferredChunks.isEmpty())
+        return false;
+
     for (const Chunk &chunk : mChunks)
         if (!chunk.isEmpty())
             return false;
 
+    for (const PackedChunk &chunk : mPackedChunks)
+        if (!chunk.isEmpty())
+            return false;
+
     return true;
 }
 
@@ -763,14 +1703,31 @@ static bool compareRectPos(const QRect &a, const QRect &b)
  */
 QVector<QRect> TileLayer::sortedChunksToWrite(QSize chunkSize) const
 {
+    materializeAllChunks();
+
     QVector<QRect> chunksToWrite;
     QSet<QPoint> existingChunks;
 
     bool isNativeChunkSize = (chunkSize.width() == CHUNK_SIZE &&
                               chunkSize.height() == CHUNK_SIZE);
 
-    if (isNativeChunkSize)
-        chunksToWrite.reserve(mChunks.size());
+    if (isNativeChunkSize) {
+        // If the desired chunk size is equal to our native chunk size, the
+        // row-major chunk keys directly give the sorted output.
+        const auto keys = chunkKeys(ChunkOrder::RowMajor);
+        chunksToWrite.reserve(keys.size());
+
+        for (const QPoint &p : keys) {
+            if (mChunks.constFind(p).value().isEmpty())
+                continue;
+
+            chunksToWrite.append(QRect(p.x() * CHUNK_SIZE,
+                                       p.y() * CHUNK_SIZE,
+                                       CHUNK_SIZE, CHUNK_SIZE));
+        }
+
+        return chunksToWrite;
+    }
 
     QHashIterator<QPoint, Chunk> it(mChunks);
     while (it.hasNext()) {
@@ -780,50 +1737,41 @@ QVector<QRect> TileLayer::sortedChunksToWrite(QSize chunkSize) const
 
         const QPoint &p = it.key();
 
-        if (isNativeChunkSize) {
-            // If the desired chunk size is equal to our native chunk size,
-            // then we just we just have to iterate our chunk list and return
-            // the bounds of each chunk.
-            chunksToWrite.append(QRect(p.x() * CHUNK_SIZE,
-                                       p.y() * CHUNK_SIZE,
-                                       CHUNK_SIZE, CHUNK_SIZE));
-        } else {
-            // If the desired chunk size is not the native size, we have to do
-            // a bit of extra work and "rearrange" chunks as we iterate our
-            // list. We do this by iterating every cell in a chunk. If it's not
-            // empty, we check what chunk it should go into with the new chunk
-            // size. If that chunk doesn't exist yet, we create it.
-            //
-            // NOTE: Rather than checking every cell in every chunk, we could
-            // also just test which "new" chunks our "old" chunk would
-            // intersect with and return all of those, this would be faster.
-            // However, that way we could end up with completely empty chunks,
-            // so we'll take the slower route and iterate all cells instead to
-            // avoid that.
-            int oldChunkStartX = p.x() * CHUNK_SIZE;
-            int oldChunkStartY = p.y() * CHUNK_SIZE;
+        // Since the desired chunk size is not the native size, we have to do
+        // a bit of extra work and "rearrange" chunks as we iterate our
+        // list. We do this by iterating every cell in a chunk. If it's not
+        // empty, we check what chunk it should go into with the new chunk
+        // size. If that chunk doesn't exist yet, we create it.
+        //
+        // NOTE: Rather than checking every cell in every chunk, we could
+        // also just test which "new" chunks our "old" chunk would
+        // intersect with and return all of those, this would be faster.
+        // However, that way we could end up with completely empty chunks,
+        // so we'll take the slower route and iterate all cells instead to
+        // avoid that.
+        int oldChunkStartX = p.x() * CHUNK_SIZE;
+        int oldChunkStartY = p.y() * CHUNK_SIZE;
 
-            for (int y = 0; y < CHUNK_SIZE; ++y) {
-                for (int x = 0; x < CHUNK_SIZE; ++x) {
-                    const Cell &cell = chunk.cellAt(x, y);
-
-                    if (!cell.isEmpty()) {
-                        int tileX = oldChunkStartX + x;
-                        int tileY = oldChunkStartY + y;
-
-                        // Nasty conditionals because of potentially negative
-                        // chunk start position. Modulo with negative numbers
-                        // is weird and unintuitive in C++...
-                        int moduloX = tileX % chunkSize.width();
-                        int newChunkStartX = tileX - (moduloX < 0 ? moduloX + chunkSize.width() : moduloX);
-                        int moduloY = tileY % chunkSize.height();
-                        int newChunkStartY = tileY - (moduloY < 0 ? moduloY + chunkSize.height() : moduloY);
-                        QPoint startPoint(newChunkStartX, newChunkStartY);
-
-                        if (!existingChunks.contains(startPoint)) {
-                            existingChunks.insert(startPoint);
-                            chunksToWrite.append(QRect(newChunkStartX, newChunkStartY, chunkSize.width(), chunkSize.height()));
-                        }
+        for (int y = 0; y < CHUNK_SIZE; ++y) {
+            for (int x = 0; x < CHUNK_SIZE; ++x) {
+                const Cell &cell = chunk.cellAt(x, y);
+
+                if (!cell.isEmpty()) {
+                    int tileX = oldChunkStartX + x;
+                    int tileY = oldChunkStartY + y;
+
+                    // Nasty conditionals because of potentially negative
+                    // chunk start position. Modulo with negative numbers
+                    // is weird and unintuitive in C++...
+                    int moduloX = tileX % chunkSize.width();
+                    int newChunkStartX = tileX - (moduloX < 0 ? moduloX + chunkSize.width() : moduloX);
+                    int moduloY = tileY % chunkSize.height();
+                    int newChunkStartY = tileY - (moduloY < 0 ? moduloY + chunkSize.height() : moduloY);
+                    QPoint startPoint(newChunkStartX, newChunkStartY);
+
+                    if (!existingChunks.contains(startPoint)) {
+                        existingChunks.insert(startPoint);
+                        chunksToWrite.append(QRect(newChunkStartX, newChunkStartY, chunkSize.width(), chunkSize.height()));
                     }
                 }
             }
@@ -835,6 +1783,93 @@ QVector<QRect> TileLayer::sortedChunksToWrite(QSize chunkSize) const
     return chunksToWrite;
 }
 
+void TileLayer::compact()
+{
+    QMutableHashIterator<QPoint, Chunk> it(mChunks);
+    while (it.hasNext()) {
+        it.next();
+
+        PackedChunk packed;
+        if (packed.pack(it.value())) {
+            mPackedChunks.insert(it.key(), packed);
+            it.remove();
+        }
+    }
+}
+
+/**
+ * Sets the function used to decode chunks added with addDeferredChunk().
+ */
+void TileLayer::setChunkDecoder(ChunkDecoder decoder)
+{
+    mChunkDecoder = std::move(decoder);
+}
+
+/**
+ * Adds a chunk whose raw data is kept as-is and only decoded, using the
+ * decoder set with setChunkDecoder(), when one of its cells is first
+ * accessed. The \a position refers to the top-left of the chunk in tile
+ * coordinates and needs to be aligned to the chunk grid.
+ */
+void TileLayer::addDeferredChunk(QPoint position, QByteArray data)
+{
+    Q_ASSERT((position.x() & CHUNK_MASK) == 0 && (position.y() & CHUNK_MASK) == 0);
+
+    const QPoint key(position.x() >> CHUNK_BITS, position.y() >> CHUNK_BITS);
+    mDeferredChunks.insert(key, std::move(data));
+    chunkOccupancyChanged(key, true);
+    mUsedTilesetsDirty = true;
+    mTileOccurrencesDirty = true;
+}
+
+void TileLayer::materializeAllChunks() const
+{
+    QHashIterator<QPoint, PackedChunk> it(mPackedChunks);
+    while (it.hasNext()) {
+        it.next();
+        mChunks.insert(it.key(), it.value().unpacked());
+    }
+
+    mPackedChunks.clear();
+
+    while (!mDeferredChunks.isEmpty())
+        materializeChunk(mDeferredChunks.constBegin().key());
+}
+
+const Chunk *TileLayer::materializeChunk(QPoint key) const
+{
+    auto it = mPackedChunks.find(key);
+    if (it != mPackedChunks.end()) {
+        auto chunk = mChunks.insert(key, it.value().unpacked());
+        mPackedChunks.erase(it);
+        return &chunk.value();
+    }
+
+    auto deferredIt = mDeferredChunks.find(key);
+    if (deferredIt != mDeferredChunks.end()) {
+        const QByteArray data = deferredIt.value();
+
+        // Erased before decoding, since the decoder writes cells through
+        // setCell, which looks up chunks again. The occupancy count moves
+        // with it: the deferred entry no longer counts, and the decoded
+        // cells count again through the setCell bookkeeping.
+        mDeferredChunks.erase(deferredIt);
+        const_cast<TileLayer*>(this)->chunkOccupancyChanged(key, false);
+
+        if (mChunkDecoder) {
+            mChunkDecoder(const_cast<TileLayer&>(*this), data,
+                          QRect(key.x() * CHUNK_SIZE, key.y() * CHUNK_SIZE,
+                                CHUNK_SIZE, CHUNK_SIZE));
+        }
+
+        auto chunkIt = mChunks.constFind(key);
+        if (chunkIt != mChunks.constEnd())
+            return &chunkIt.value();
+    }
+
+    return nullptr;
+}
+
 /**
  * Returns a duplicate of this TileLayer.
  *
@@ -849,9 +1884,17 @@ TileLayer *TileLayer::initializeClone(TileLayer *clone) const
 {
     Layer::initializeClone(clone);
     clone->mChunks = mChunks;
+    clone->mPackedChunks = mPackedChunks;
+    clone->mDeferredChunks = mDeferredChunks;
+    clone->mChunkDecoder = mChunkDecoder;
     clone->mBounds = mBounds;
+    clone->mOccupiedChunkColumns = mOccupiedChunkColumns;
+    clone->mOccupiedChunkRows = mOccupiedChunkRows;
     clone->mUsedTilesets = mUsedTilesets;
+    clone->mUsedTilesetCounts = mUsedTilesetCounts;
     clone->mUsedTilesetsDirty = mUsedTilesetsDirty;
+    clone->mTileOccurrences = mTileOccurrences;
+    clone->mTileOccurrencesDirty = mTileOccurrencesDirty;
     return clone;
 }
 
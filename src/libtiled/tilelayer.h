@@ -37,10 +37,13 @@
 #include "tileset.h"
 
 #include <QHash>
+#include <QMap>
 #include <QMargins>
+#include <QPair>
 #include <QPoint>
 #include <QSharedPointer>
 #include <QString>
+#include <QVarLengthArray>
 #include <QVector>
 
 #include <functional>
@@ -91,8 +94,10 @@ public:
 
     bool operator == (const Cell &other) const
     {
-        return _tileset == other._tileset
-                && _tileId == other._tileId
+        // The tile ID is compared first: most layers draw from a single
+        // tileset, which makes the ID the field most likely to differ.
+        return _tileId == other._tileId
+                && _tileset == other._tileset
                 && (_flags & VisualFlags) == (other._flags & VisualFlags);
     }
 
@@ -176,13 +181,25 @@ public:
     {}
 
     QRegion region(std::function<bool (const Cell &)> condition) const;
+    QRegion region() const;
 
     const Cell &cellAt(int x, int y) const;
     const Cell &cellAt(QPoint point) const;
 
     void setCell(int x, int y, const Cell &cell);
+    void setCells(int x, int y, const Cell *cells, int count);
+    void eraseCells(int x, int y, int count);
 
-    bool isEmpty() const;
+    bool isEmpty() const { return mOccupiedCount == 0; }
+
+    bool operator==(const Chunk &other) const;
+    bool operator!=(const Chunk &other) const { return !(*this == other); }
+
+    /**
+     * Returns a bitmask of the non-empty cells in row \a y, with bit \c x
+     * referring to the cell at (x, y).
+     */
+    quint16 occupiedRow(int y) const { return mOccupiedRows[y]; }
 
     bool hasCell(std::function<bool (const Cell &)> condition) const;
 
@@ -197,6 +214,12 @@ public:
 
 private:
     QVector<Cell> mGrid;
+
+    // Occupancy of the grid, maintained by setCell: one bit per cell in each
+    // row, plus the total number of non-empty cells. Makes isEmpty() O(1)
+    // and lets region() emit row spans without scanning any cells.
+    quint16 mOccupiedRows[CHUNK_SIZE] = {};
+    int mOccupiedCount = 0;
 };
 
 inline const Cell &Chunk::cellAt(int x, int y) const
@@ -209,6 +232,50 @@ inline const Cell &Chunk::cellAt(QPoint point) const
     return cellAt(point.x(), point.y());
 }
 
+/**
+ * A structure-of-arrays representation of a Chunk. Instead of a Cell per
+ * grid location, it stores one packed 32-bit value per location plus a
+ * small per-chunk tileset palette, which makes whole-chunk scans a linear
+ * walk over 4-byte values.
+ *
+ * Packed value layout (0 means an empty cell):
+ *
+ *   bits 0-19   tile ID plus one
+ *   bits 20-23  visual flip flags
+ *   bits 24-31  index into the tileset palette
+ *
+ * Chunks referencing more than 256 tilesets or tile IDs beyond 2^20 - 2
+ * cannot be packed and stay in their array-of-Cells form.
+ */
+class TILEDSHARED_EXPORT PackedChunk
+{
+public:
+    bool pack(const Chunk &chunk);
+    Chunk unpacked() const;
+
+    const QVector<quint32> &packedCells() const { return mPackedCells; }
+    const QVarLengthArray<Tileset*, 8> &palette() const { return mPalette; }
+
+    void addCellCounts(QHash<Tileset*, int> &counts) const;
+
+    bool isEmpty() const;
+
+    void removeReferencesToTileset(Tileset *tileset);
+    void replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTileset);
+
+private:
+    enum {
+        TileIdBits = 20,
+        TileIdMask = (1 << TileIdBits) - 1,
+        FlagsShift = TileIdBits,
+        FlagsMask = 0xF << FlagsShift,
+        PaletteShift = 24
+    };
+
+    QVector<quint32> mPackedCells;
+    QVarLengthArray<Tileset*, 8> mPalette;
+};
+
 /**
  * A tile layer is a grid of cells. Each cell refers to a specific tile, and
  * stores how the tile is flipped.
@@ -219,6 +286,22 @@ inline const Cell &Chunk::cellAt(QPoint point) const
 class TILEDSHARED_EXPORT TileLayer : public Layer
 {
 public:
+    /**
+     * The order in which chunks are visited by traversals that support an
+     * ordering policy.
+     *
+     * Unordered is the natural QHash order, which is effectively random but
+     * free. RowMajor visits chunks top-to-bottom, left-to-right, which gives
+     * spatially coherent and deterministic scans. Morton visits chunks along
+     * a Z-order curve, which keeps successive chunks close on both axes for
+     * cache-blocked processing.
+     */
+    enum class ChunkOrder {
+        Unordered,
+        RowMajor,
+        Morton
+    };
+
     class iterator
     {
     public:
@@ -331,6 +414,60 @@ public:
         QVector<Cell>::const_iterator mCellPointer;
     };
 
+    /**
+     * A range over the cells of a layer that visits chunks in a given
+     * order, created with cells(). The plain begin()/end() iterators visit
+     * chunks in hash order, which is cheapest; this range makes the
+     * traversal order an explicit policy of the loop. Like them, it visits
+     * every cell of every chunk, including empty ones.
+     *
+     * The layer must not be modified while the range is in use.
+     */
+    class TILEDSHARED_EXPORT CellRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            const Cell &operator*() const { return mCells[mCellIndex]; }
+            iterator &operator++() { advance(); return *this; }
+            iterator operator++(int) { iterator it = *this; advance(); return it; }
+
+            const Cell &value() const { return operator*(); }
+            QPoint key() const;
+
+            friend bool operator==(const iterator &lhs, const iterator &rhs)
+            { return lhs.mChunkIndex == rhs.mChunkIndex && lhs.mCellIndex == rhs.mCellIndex; }
+
+            friend bool operator!=(const iterator &lhs, const iterator &rhs)
+            { return !(lhs == rhs); }
+
+        private:
+            friend class CellRange;
+
+            iterator(const CellRange &range, int chunkIndex);
+
+            void advance();
+            void resolveChunk();
+
+            const CellRange *mRange;
+            int mChunkIndex;
+            int mCellIndex = 0;
+            const Cell *mCells = nullptr;
+        };
+
+        iterator begin() const { return iterator(*this, 0); }
+        iterator end() const { return iterator(*this, mChunkKeys.size()); }
+
+    private:
+        friend class TileLayer;
+
+        CellRange(const TileLayer &layer, ChunkOrder order);
+
+        const TileLayer &mLayer;
+        QVector<QPoint> mChunkKeys;
+    };
+
     /**
      * Constructor.
      */
@@ -358,7 +495,10 @@ public:
     void setSize(QSize size);
 
     /**
-     * Returns the bounds of this layer in map tile coordinates.
+     * Returns the bounds of this layer in map tile coordinates. The bounds
+     * are exact at chunk granularity: they shrink as soon as erasing leaves
+     * chunks empty, tracked through the per-chunk-column and per-chunk-row
+     * occupancy counts.
      */
     QRect bounds() const { return mBounds.translated(mX, mY); }
 
@@ -379,12 +519,68 @@ public:
     const Chunk *findChunk(int x, int y) const;
 
     QRegion region(std::function<bool (const Cell &)> condition) const;
+    QRegion region(const Cell &match) const;
     QRegion region() const;
 
     const Cell &cellAt(int x, int y) const;
     const Cell &cellAt(QPoint point) const;
 
     void setCell(int x, int y, const Cell &cell);
+    void fillRect(QRect rect, const Cell &cell);
+
+    /**
+     * Writes cells through the chunk of the last written cell, so that
+     * painting loops do one chunk lookup per run of cells within the same
+     * chunk instead of one per cell. Behaves like repeated calls to
+     * setCell().
+     */
+    class TILEDSHARED_EXPORT CellWriter
+    {
+    public:
+        explicit CellWriter(TileLayer &target) : mTarget(target) {}
+
+        void setCell(int x, int y, const Cell &cell);
+
+    private:
+        TileLayer &mTarget;
+        Chunk *mChunk = nullptr;
+        QPoint mChunkPos;
+    };
+
+    /**
+     * Reads cells and their neighbors through cached chunk pointers.
+     *
+     * On the first read within a chunk, that chunk and its eight neighboring
+     * chunks are resolved once. While subsequent reads stay within the same
+     * chunk, neighbor() is plain pointer arithmetic instead of a chunk hash
+     * lookup per probe, which matters for algorithms scanning the
+     * neighborhood of every cell. Reads behave like TileLayer::cellAt().
+     *
+     * The layer must not be modified while a reader is in use.
+     */
+    class TILEDSHARED_EXPORT NeighborhoodReader
+    {
+    public:
+        explicit NeighborhoodReader(const TileLayer &target) : mTarget(target) {}
+
+        void centerOn(int x, int y);
+        void centerOn(QPoint point) { centerOn(point.x(), point.y()); }
+
+        const Cell &cellAt(int x, int y);
+        const Cell &cellAt(QPoint point) { return cellAt(point.x(), point.y()); }
+
+        const Cell &neighbor(int dx, int dy) const;
+        const Cell &neighbor(QPoint offset) const { return neighbor(offset.x(), offset.y()); }
+
+    private:
+        void resolveChunks(int cx, int cy);
+
+        const TileLayer &mTarget;
+        const Chunk *mChunks[3][3] = {};
+        QPoint mChunkPos;
+        QPoint mPos;
+        bool mResolved = false;
+    };
 
     /**
      * Returns a copy of the area specified by the given \a region. The
@@ -468,6 +664,22 @@ public:
      */
     bool referencesTileset(const Tileset *tileset) const override;
 
+    /**
+     * Returns the number of cells on this layer that reference the given
+     * \a tileset. The count is maintained incrementally by setCell, so this
+     * is a constant-time query.
+     */
+    int tilesetCellCount(const Tileset *tileset) const;
+
+    /**
+     * Returns the keys of the chunks that contain at least one cell
+     * referencing the same tile as \a cell, in row-major order. The
+     * occurrence lists are built lazily and invalidated by any write to the
+     * layer, so repeated queries against an unchanged layer (as done by the
+     * selection tools while hovering) only pay for the chunks that matter.
+     */
+    QVector<QPoint> occurrenceChunks(const Cell &cell) const;
+
     /**
      * Removes all references to the given tileset. This sets all tiles on this
      * layer that are from the given tileset to null.
@@ -520,23 +732,86 @@ public:
 
     TileLayer *clone() const override;
 
-    iterator begin() { return iterator(mChunks.begin(), mChunks.end()); }
+    /**
+     * Converts the chunks of this layer to their packed structure-of-arrays
+     * form (see PackedChunk), which is selected per-map through
+     * Map::compactCellStorage(). Chunks are transparently expanded again
+     * when cells are accessed.
+     */
+    void compact();
+
+    /**
+     * A function that decodes raw chunk data into the cells of the given
+     * \a bounds of \a layer. Used for chunks whose decoding was deferred
+     * with addDeferredChunk().
+     */
+    using ChunkDecoder = std::function<void (TileLayer &layer,
+                                             const QByteArray &data,
+                                             QRect bounds)>;
+
+    void setChunkDecoder(ChunkDecoder decoder);
+    void addDeferredChunk(QPoint position, QByteArray data);
+
+    iterator begin() { materializeAllChunks(); return iterator(mChunks.begin(), mChunks.end()); }
     iterator end() { return iterator(mChunks.end(), mChunks.end()); }
-    const_iterator begin() const { return const_iterator(mChunks.begin(), mChunks.end()); }
+    const_iterator begin() const { materializeAllChunks(); return const_iterator(mChunks.begin(), mChunks.end()); }
     const_iterator end() const { return const_iterator(mChunks.end(), mChunks.end()); }
 
+    /**
+     * Returns a range over all cells of this layer that visits chunks in
+     * the given \a order.
+     */
+    CellRange cells(ChunkOrder order) const { return CellRange(*this, order); }
+
+    QVector<QPoint> chunkKeys(ChunkOrder order) const;
+
     QVector<QRect> sortedChunksToWrite(QSize chunkSize) const;
 
 protected:
     TileLayer *initializeClone(TileLayer *clone) const;
 
 private:
+    friend class ChunkWriter;
+
+    void updateTilesetUsage(Tileset *oldTileset, Tileset *newTileset);
+
+    void copyRun(int x, int y, const Cell *cells, int count);
+    void eraseRun(int x, int y, int count);
+
+    void chunkOccupancyChanged(QPoint chunkPos, bool occupied);
+    void rebuildOccupancySummary();
+
+    void materializeAllChunks() const;
+    const Chunk *materializeChunk(QPoint key) const;
+
     int mWidth;
     int mHeight;
-    QHash<QPoint, Chunk> mChunks;
+    mutable QHash<QPoint, Chunk> mChunks;
+    mutable QHash<QPoint, PackedChunk> mPackedChunks;
+    mutable QHash<QPoint, QByteArray> mDeferredChunks;
+    ChunkDecoder mChunkDecoder;
     QRect mBounds;
+
+    /**
+     * Number of occupied chunks per chunk column and per chunk row. A
+     * materialized or packed chunk counts while it has any cells, a deferred
+     * chunk always counts since its contents are unknown until decoded. The
+     * ordered keys give the exact chunk-granularity bounds in O(log n), so
+     * mBounds can shrink on erase without a scan over all chunks.
+     */
+    QMap<int, int> mOccupiedChunkColumns;
+    QMap<int, int> mOccupiedChunkRows;
     mutable QSet<SharedTileset> mUsedTilesets;
+    mutable QHash<Tileset*, int> mUsedTilesetCounts;
     mutable bool mUsedTilesetsDirty;
+
+    /**
+     * For each tile (identified by tileset and tile ID), the keys of the
+     * chunks containing at least one cell referencing it, in row-major
+     * order. Rebuilt lazily by occurrenceChunks().
+     */
+    mutable QHash<QPair<Tileset*, int>, QVector<QPoint>> mTileOccurrences;
+    mutable bool mTileOccurrencesDirty = true;
 };
 
 inline QPoint TileLayer::iterator::key() const
@@ -585,6 +860,39 @@ inline void TileLayer::const_iterator::advance()
     }
 }
 
+inline TileLayer::CellRange::iterator::iterator(const CellRange &range, int chunkIndex)
+    : mRange(&range)
+    , mChunkIndex(chunkIndex)
+{
+    resolveChunk();
+}
+
+inline QPoint TileLayer::CellRange::iterator::key() const
+{
+    const QPoint chunkPos = mRange->mChunkKeys.at(mChunkIndex);
+    return QPoint(chunkPos.x() * CHUNK_SIZE + (mCellIndex & CHUNK_MASK),
+                  chunkPos.y() * CHUNK_SIZE + (mCellIndex >> CHUNK_BITS));
+}
+
+inline void TileLayer::CellRange::iterator::advance()
+{
+    if (++mCellIndex == CHUNK_SIZE * CHUNK_SIZE) {
+        mCellIndex = 0;
+        ++mChunkIndex;
+        resolveChunk();
+    }
+}
+
+inline void TileLayer::CellRange::iterator::resolveChunk()
+{
+    if (mChunkIndex < mRange->mChunkKeys.size()) {
+        const QPoint key = mRange->mChunkKeys.at(mChunkIndex);
+        mCells = &*mRange->mLayer.mChunks.constFind(key).value().begin();
+    } else {
+        mCells = nullptr;
+    }
+}
+
 /**
  * Sets the size of this layer.
  */
@@ -606,7 +914,13 @@ inline bool TileLayer::contains(QPoint point) const
 
 inline Chunk& TileLayer::chunk(int x, int y)
 {
+    // Every per-cell write path resolves its chunk through here, making it
+    // the chokepoint that invalidates the tile occurrence index
+    mTileOccurrencesDirty = true;
+
     const QPoint chunkCoordinates(x >> CHUNK_BITS, y >> CHUNK_BITS);
+    if (!mPackedChunks.isEmpty() || !mDeferredChunks.isEmpty())
+        materializeChunk(chunkCoordinates);
     return mChunks[chunkCoordinates];
 }
 
@@ -614,17 +928,13 @@ inline const Chunk* TileLayer::findChunk(int x, int y) const
 {
     const QPoint chunkCoordinates(x >> CHUNK_BITS, y >> CHUNK_BITS);
     auto it = mChunks.find(chunkCoordinates);
-    return it != mChunks.end() ? &it.value() : nullptr;
+    if (it != mChunks.end())
+        return &it.value();
+    if (!mPackedChunks.isEmpty() || !mDeferredChunks.isEmpty())
+        return materializeChunk(chunkCoordinates);
+    return nullptr;
 }
 
-/**
- * Calculates the region occupied by the tiles of this layer. Similar to
- * Layer::bounds(), but leaves out the regions without tiles.
- */
-inline QRegion TileLayer::region() const
-{
-    return region([] (const Cell &cell) { return !cell.isEmpty(); });
-}
 
 /**
  * Returns a read-only reference to the cell at the given coordinates. The
@@ -643,6 +953,51 @@ inline const Cell &TileLayer::cellAt(QPoint point) const
     return cellAt(point.x(), point.y());
 }
 
+/**
+ * Makes the cell at the given coordinates the center of the neighbor()
+ * stencil, resolving the surrounding chunks when the center moved to a
+ * different chunk.
+ */
+inline void TileLayer::NeighborhoodReader::centerOn(int x, int y)
+{
+    const int cx = x >> CHUNK_BITS;
+    const int cy = y >> CHUNK_BITS;
+    if (!mResolved || cx != mChunkPos.x() || cy != mChunkPos.y())
+        resolveChunks(cx, cy);
+    mPos = QPoint(x, y);
+}
+
+/**
+ * Returns the cell at the given coordinates and centers the neighbor()
+ * stencil on it.
+ */
+inline const Cell &TileLayer::NeighborhoodReader::cellAt(int x, int y)
+{
+    centerOn(x, y);
+    if (const Chunk *chunk = mChunks[1][1])
+        return chunk->cellAt(x & CHUNK_MASK, y & CHUNK_MASK);
+    return Cell::empty;
+}
+
+/**
+ * Returns the cell at the given offset from the last centered position. The
+ * offset may not exceed CHUNK_SIZE in either direction, which keeps the
+ * probed cell within the resolved chunks.
+ */
+inline const Cell &TileLayer::NeighborhoodReader::neighbor(int dx, int dy) const
+{
+    Q_ASSERT(mResolved);
+    Q_ASSERT(qAbs(dx) <= CHUNK_SIZE && qAbs(dy) <= CHUNK_SIZE);
+
+    const int x = mPos.x() + dx;
+    const int y = mPos.y() + dy;
+    const Chunk *chunk = mChunks[(y >> CHUNK_BITS) - mChunkPos.y() + 1]
+                                [(x >> CHUNK_BITS) - mChunkPos.x() + 1];
+    if (!chunk)
+        return Cell::empty;
+    return chunk->cellAt(x & CHUNK_MASK, y & CHUNK_MASK);
+}
+
 inline void TileLayer::setCells(int x, int y, const TileLayer *tileLayer)
 {
     setCells(x, y, tileLayer,
@@ -57,8 +57,12 @@ Tileset::Tileset(QString name, int tileWidth, int tileHeight,
 Tileset::~Tileset()
 {
     TilesetManager::instance()->removeTileset(this);
-    qDeleteAll(mTiles);
-    qDeleteAll(mWangSets);
+
+    // Snapshots don't own their tiles and Wang sets
+    if (!mSnapshotSource) {
+        qDeleteAll(mTiles);
+        qDeleteAll(mWangSets);
+    }
 }
 
 void Tileset::setFormat(const QString &format)
@@ -235,6 +239,12 @@ bool Tileset::loadFromImage(const QString &fileName)
  */
 bool Tileset::loadImage()
 {
+#ifdef TILED_HEADLESS
+    // Headless builds work on the GID-level data model only; tiles that
+    // would be cut from the tileset image do not exist in them.
+    mImageReference.status = LoadingError;
+    return false;
+#else
     if (mTileWidth <= 0 || mTileHeight <= 0) {
         mImageReference.status = LoadingError;
         return false;
@@ -249,28 +259,39 @@ bool Tileset::loadImage()
     initializeTilesetTiles();
 
     return true;
+#endif // TILED_HEADLESS
 }
 
 void Tileset::initializeTilesetTiles()
 {
     if (mImageReference.transparentColor.isValid())
-        mImage.setMask(mImage.createMaskFromColor(mImageReference.transparentColor));
+        mImage = applyColorKey(mImage, mImageReference.transparentColor);
 
     QVector<QRect> tileRects;
+    tileRects.reserve((qMax(0, mImage.height() - mMargin - mTileHeight) / (mTileHeight + mTileSpacing) + 1) *
+                      (qMax(0, mImage.width() - mMargin - mTileWidth) / (mTileWidth + mTileSpacing) + 1));
 
     for (int y = mMargin; y <= mImage.height() - mTileHeight; y += mTileHeight + mTileSpacing)
         for (int x = mMargin; x <= mImage.width() - mTileWidth; x += mTileWidth + mTileSpacing)
             tileRects.append(QRect(x, y, mTileWidth, mTileHeight));
 
+    // Walk the existing tiles in ID order alongside the rects, instead of
+    // doing a lookup for each tile. New tiles are inserted with a position
+    // hint, keeping this loop linear even for huge atlases.
+    auto it = mTilesById.begin();
     for (int tileNum = 0; tileNum < tileRects.size(); ++tileNum) {
-        auto it = mTilesById.find(tileNum);
-        if (it != mTilesById.end()) {
+        while (it != mTilesById.end() && it.key() < tileNum)
+            ++it;
+
+        if (it != mTilesById.end() && it.key() == tileNum) {
             it.value()->setImage(QPixmap());    // make sure it uses the tileset's image
             it.value()->setImageRect(tileRects.at(tileNum));
+            ++it;
         } else {
             auto tile = new Tile(tileNum, this);
             tile->setImageRect(tileRects.at(tileNum));
-            mTilesById.insert(tileNum, tile);
+            it = mTilesById.insert(it, tileNum, tile);
+            ++it;
             mTiles.insert(tileNum, tile);
         }
     }
@@ -667,6 +688,49 @@ SharedTileset Tileset::clone() const
     return c;
 }
 
+/**
+ * Returns a lightweight copy of this tileset that shares the tile and Wang
+ * set data with the original, rather than duplicating it like clone() does.
+ *
+ * A snapshot is meant for short-lived, read-only use, such as writing out a
+ * slightly adjusted tileset on export. It keeps a strong reference to the
+ * original tileset and needs to be discarded before the original is
+ * modified. The shared tiles and Wang sets keep pointing to the original
+ * tileset.
+ */
+SharedTileset Tileset::snapshot() const
+{
+    SharedTileset c = create(mName, mTileWidth, mTileHeight, mTileSpacing, mMargin);
+    c->setClassName(className());
+    c->setProperties(properties());
+
+    // mFileName stays empty
+    c->mTileOffset = mTileOffset;
+    c->mObjectAlignment = mObjectAlignment;
+    c->mOrientation = mOrientation;
+    c->mTileRenderSize = mTileRenderSize;
+    c->mFillMode = mFillMode;
+    c->mGridSize = mGridSize;
+    c->mColumnCount = mColumnCount;
+    c->mNextTileId = mNextTileId;
+    c->mStatus = mStatus;
+    c->mBackgroundColor = mBackgroundColor;
+    c->mFormat = mFormat;
+    c->mTransformationFlags = mTransformationFlags;
+
+    c->mTilesById = mTilesById;
+    c->mTiles = mTiles;
+    c->mWangSets = mWangSets;
+    c->mSnapshotSource = const_cast<Tileset*>(this)->sharedFromThis();
+
+    // No need to involve the TilesetManager for watching the image, since
+    // the original tileset is already watched and outlives the snapshot.
+    c->mImageReference = mImageReference;
+    c->mImage = mImage;
+
+    return c;
+}
+
 /**
  * Sets tile size to the maximum size.
  */
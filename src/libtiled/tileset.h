@@ -267,6 +267,7 @@ public:
     void swap(Tileset &other);
 
     SharedTileset clone() const;
+    SharedTileset snapshot() const;
 
     /**
      * Helper function that converts the tileset orientation to a string value.
@@ -324,6 +325,10 @@ private:
     TransformationFlags mTransformationFlags;
 
     QWeakPointer<Tileset> mOriginalTileset;
+
+    // Set on snapshots, which share the tile and Wang set data with the
+    // tileset they were taken from (see snapshot()).
+    SharedTileset mSnapshotSource;
 };
 
 
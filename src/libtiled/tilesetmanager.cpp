@@ -35,6 +35,8 @@
 #include "tileanimationdriver.h"
 #include "tilesetformat.h"
 
+#include <limits>
+
 namespace Tiled {
 
 TilesetManager *TilesetManager::mInstance;
@@ -118,6 +120,7 @@ void TilesetManager::addTileset(Tileset *tileset)
 {
     Q_ASSERT(!mTilesets.contains(tileset));
     mTilesets.append(tileset);
+    mLastAnimationTime.insert(tileset, mAnimationTime);
 }
 
 /**
@@ -128,6 +131,8 @@ void TilesetManager::removeTileset(Tileset *tileset)
 {
     Q_ASSERT(mTilesets.contains(tileset));
     mTilesets.removeOne(tileset);
+    mVisibleTilesets.remove(tileset);
+    mLastAnimationTime.remove(tileset);
 
     if (tileset->imageSource().isLocalFile())
         mWatcher->removePath(tileset->imageSource().toLocalFile());
@@ -158,6 +163,59 @@ void TilesetManager::reloadImages(Tileset *tileset)
     }
 }
 
+/**
+ * Schedules background decoding of the images of the given \a tilesets, in
+ * the given order. Used together with deferred image loading, with the
+ * tilesets whose images are needed first at the front of the list.
+ *
+ * The tilesetImagesChanged signal is emitted for each tileset once its
+ * image has arrived and its tiles have been set up.
+ */
+void TilesetManager::loadTilesetImagesAsync(const QVector<SharedTileset> &tilesets)
+{
+    for (const SharedTileset &tileset : tilesets)
+        scheduleImageLoad(tileset);
+
+    // Also pick up any other tilesets left pending by a read, like those
+    // referenced only by object templates
+    for (Tileset *tileset : std::as_const(mTilesets))
+        if (tileset->imageStatus() == LoadingPending)
+            scheduleImageLoad(tileset->sharedFromThis());
+}
+
+void TilesetManager::scheduleImageLoad(const SharedTileset &tileset)
+{
+    if (tileset->isCollection() || tileset->imageStatus() != LoadingPending)
+        return;
+
+    tileset->setImageStatus(LoadingInProgress);
+
+    const QString fileName = urlToLocalFileOrQrc(tileset->imageSource());
+    ImageCache::loadImageAsync(fileName, [tileset] (const LoadedImage &) {
+        // The tileset may have been loaded or reloaded through another path
+        // in the meantime
+        if (tileset->imageStatus() != LoadingInProgress)
+            return;
+
+        // The decoded image is in the cache at this point, so this only
+        // converts it to a pixmap and sets up the tiles
+        if (tileset->loadImage() && mInstance)
+            emit mInstance->tilesetImagesChanged(tileset.data());
+    });
+}
+
+/**
+ * Sets whether readers should leave tileset images unloaded, keeping their
+ * image status at LoadingPending. Whoever initiated the read is expected to
+ * schedule the loads afterwards through loadTilesetImagesAsync().
+ *
+ * Only meant to be toggled on the main thread, around a read.
+ */
+void TilesetManager::setDeferredImageLoading(bool enabled)
+{
+    mDeferredImageLoading = enabled;
+}
+
 /**
  * Sets whether tilesets are automatically reloaded when their tileset
  * image changes.
@@ -187,6 +245,29 @@ bool TilesetManager::animateTiles() const
     return mAnimationDriver->state() == QAbstractAnimation::Running;
 }
 
+/**
+ * Registers the given \a tileset as currently visible in some view. Calls
+ * can nest, with each call needing to be balanced by a call to
+ * removeVisibleTileset.
+ *
+ * While any visibility information is registered, tile animations are only
+ * advanced for visible tilesets. Animations of hidden tilesets catch up
+ * based on the animation clock when they become visible again.
+ */
+void TilesetManager::addVisibleTileset(Tileset *tileset)
+{
+    if (++mVisibleTilesets[tileset] == 1)
+        advanceTileAnimations(0);   // catch up with the animation clock
+}
+
+void TilesetManager::removeVisibleTileset(Tileset *tileset)
+{
+    auto it = mVisibleTilesets.find(tileset);
+    Q_ASSERT(it != mVisibleTilesets.end());
+    if (it != mVisibleTilesets.end() && --it.value() == 0)
+        mVisibleTilesets.erase(it);
+}
+
 void TilesetManager::tilesetImageSourceChanged(const Tileset &tileset,
                                                const QUrl &oldImageSource)
 {
@@ -232,6 +313,8 @@ void TilesetManager::resetTileAnimations()
         for (Tile *tile : tileset->tiles())
             imageChanged |= tile->resetAnimation();
 
+        mLastAnimationTime.insert(tileset, mAnimationTime);
+
         if (imageChanged)
             emit repaintTileset(tileset);
     }
@@ -242,11 +325,27 @@ void TilesetManager::advanceTileAnimations(int ms)
     // TODO: This could be more optimal by keeping track of the list of
     // actually animated tiles
 
+    mAnimationTime += ms;
+
     for (Tileset *tileset : std::as_const(mTilesets)) {
+        // Skip tilesets that are currently not visible in any view. Their
+        // animations catch up when they become visible again. When no
+        // visibility information is registered at all, all tilesets animate.
+        if (!mVisibleTilesets.isEmpty() && !mVisibleTilesets.contains(tileset))
+            continue;
+
+        qint64 &lastTime = mLastAnimationTime[tileset];
+        const int elapsed = static_cast<int>(qMin<qint64>(mAnimationTime - lastTime,
+                                                          std::numeric_limits<int>::max() / 2));
+        lastTime = mAnimationTime;
+
+        if (elapsed <= 0)
+            continue;
+
         bool imageChanged = false;
 
         for (Tile *tile : tileset->tiles())
-            imageChanged |= tile->advanceAnimation(ms);
+            imageChanged |= tile->advanceAnimation(elapsed);
 
         if (imageChanged)
             emit repaintTileset(tileset);
@@ -31,6 +31,7 @@
 
 #include "tileset.h"
 
+#include <QHash>
 #include <QObject>
 #include <QList>
 #include <QString>
@@ -66,12 +67,20 @@ public:
 
     void reloadImages(Tileset *tileset);
 
+    void loadTilesetImagesAsync(const QVector<SharedTileset> &tilesets);
+
+    void setDeferredImageLoading(bool enabled);
+    bool deferredImageLoading() const;
+
     void setReloadTilesetsOnChange(bool enabled);
     bool reloadTilesetsOnChange() const;
 
     void setAnimateTiles(bool enabled);
     bool animateTiles() const;
 
+    void addVisibleTileset(Tileset *tileset);
+    void removeVisibleTileset(Tileset *tileset);
+
     void advanceTileAnimations(int ms);
     void resetTileAnimations();
 
@@ -92,6 +101,7 @@ signals:
 
 private:
     void filesChanged(const QStringList &fileNames);
+    void scheduleImageLoad(const SharedTileset &tileset);
 
     /**
      * The list of loaded tilesets (weak references).
@@ -100,10 +110,23 @@ private:
     FileSystemWatcher *mWatcher;
     TileAnimationDriver *mAnimationDriver;
     bool mReloadTilesetsOnChange;
+    bool mDeferredImageLoading = false;
+
+    /**
+     * Reference counts of viewers currently showing each tileset, along with
+     * the animation clock and the time each tileset last advanced, used to
+     * skip advancing animations of off-screen tilesets.
+     */
+    QHash<Tileset*, int> mVisibleTilesets;
+    QHash<Tileset*, qint64> mLastAnimationTime;
+    qint64 mAnimationTime = 0;
 
     static TilesetManager *mInstance;
 };
 
+inline bool TilesetManager::deferredImageLoading() const
+{ return mDeferredImageLoading; }
+
 inline bool TilesetManager::reloadTilesetsOnChange() const
 { return mReloadTilesetsOnChange; }
 
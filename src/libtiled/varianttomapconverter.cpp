@@ -22,6 +22,7 @@
 #include "varianttomapconverter.h"
 
 #include "grouplayer.h"
+#include "imagecache.h"
 #include "imagelayer.h"
 #include "map.h"
 #include "objectgroup.h"
@@ -34,6 +35,10 @@
 #include "tilesetmanager.h"
 #include "wangset.h"
 
+#include <QHash>
+#include <QSemaphore>
+#include <QThreadPool>
+
 #include <memory>
 
 namespace Tiled {
@@ -50,6 +55,7 @@ std::unique_ptr<Map> VariantToMapConverter::toMap(const QVariant &variant,
                                                   const QDir &mapDir)
 {
     mGidMapper.clear();
+    mTileDataJobs.clear();
     mDir = mapDir;
 
     const QVariantMap variantMap = variant.toMap();
@@ -99,7 +105,7 @@ std::unique_ptr<Map> VariantToMapConverter::toMap(const QVariant &variant,
     if (nextObjectId)
         map->setNextObjectId(nextObjectId);
 
-    map->setClassName(variantMap[QStringLiteral("class")].toString());
+    map->setClassName(internString(variantMap[QStringLiteral("class")].toString()));
 
     readMapEditorSettings(*map, variantMap[QStringLiteral("editorsettings")].toMap());
 
@@ -124,12 +130,27 @@ std::unique_ptr<Map> VariantToMapConverter::toMap(const QVariant &variant,
         map->addLayer(std::move(layer));
     }
 
-    // Try to load the tileset images
-    auto tilesets = map->tilesets();
-    for (SharedTileset &tileset : tilesets) {
-        if (!tileset->imageSource().isEmpty() && tileset->fileName().isEmpty())
-            tileset->loadImage();
+    if (!decodeDeferredTileData())
+        return nullptr;
+
+#ifndef TILED_HEADLESS
+    // Try to load the tileset images, warming up the image cache in
+    // parallel first
+    if (!TilesetManager::instance()->deferredImageLoading()) {
+        auto tilesets = map->tilesets();
+
+        QStringList imageSources;
+        for (const SharedTileset &tileset : std::as_const(tilesets))
+            if (!tileset->imageSource().isEmpty() && tileset->fileName().isEmpty())
+                imageSources.append(urlToLocalFileOrQrc(tileset->imageSource()));
+        ImageCache::preloadImages(imageSources);
+
+        for (SharedTileset &tileset : tilesets) {
+            if (!tileset->imageSource().isEmpty() && tileset->fileName().isEmpty())
+                tileset->loadImage();
+        }
     }
+#endif // TILED_HEADLESS
 
     const int compressionLevel = variantMap[QStringLiteral("compressionlevel")].toInt(&ok);
     if (ok)
@@ -145,8 +166,11 @@ SharedTileset VariantToMapConverter::toTileset(const QVariant &variant,
     mReadingExternalTileset = true;
 
     SharedTileset tileset = toTileset(variant);
-    if (tileset && !tileset->imageSource().isEmpty())
+#ifndef TILED_HEADLESS
+    if (tileset && !tileset->imageSource().isEmpty()
+            && !TilesetManager::instance()->deferredImageLoading())
         tileset->loadImage();
+#endif
 
     mReadingExternalTileset = false;
     return tileset;
@@ -178,7 +202,7 @@ Properties VariantToMapConverter::toProperties(const QVariant &propertiesVariant
         exportValue.typeName = propertyTypesMap.value(it.key()).toString();
         // TODO: Support for custom property types with customPropertyTypesMap
 
-        properties[it.key()] = context.toPropertyValue(exportValue);
+        properties[internString(it.key())] = context.toPropertyValue(exportValue);
     }
 
     // read array-based format (1.2)
@@ -191,7 +215,7 @@ Properties VariantToMapConverter::toProperties(const QVariant &propertiesVariant
         exportValue.typeName = propertyVariantMap[QStringLiteral("type")].toString();
         exportValue.propertyTypeName = propertyVariantMap[QStringLiteral("propertytype")].toString();
 
-        properties[propertyName] = context.toPropertyValue(exportValue);
+        properties[internString(propertyName)] = context.toPropertyValue(exportValue);
     }
 
     return properties;
@@ -247,7 +271,7 @@ SharedTileset VariantToMapConverter::toTileset(const QVariant &variant)
                                           tileWidth, tileHeight,
                                           spacing, margin));
 
-    tileset->setClassName(className);
+    tileset->setClassName(internString(className));
     tileset->setObjectAlignment(alignmentFromString(objectAlignment));
     tileset->setTileRenderSize(Tileset::tileRenderSizeFromString(tileRenderSize));
     tileset->setFillMode(Tileset::fillModeFromString(fillMode));
@@ -336,7 +360,7 @@ SharedTileset VariantToMapConverter::toTileset(const QVariant &variant)
         QString className = tileVar[QStringLiteral("class")].toString();
         if (className.isEmpty())    // fallback for compatibility
             className = tileVar[QStringLiteral("type")].toString();
-        tile->setClassName(className);
+        tile->setClassName(internString(className));
 
         // Read tile terrain ids as Wang IDs.
         QList<QVariant> terrains = tileVar[QStringLiteral("terrain")].toList();
@@ -577,18 +601,34 @@ std::unique_ptr<Layer> VariantToMapConverter::toLayer(const QVariant &variant)
     const QVariantMap variantMap = variant.toMap();
     std::unique_ptr<Layer> layer;
 
-    if (variantMap[QStringLiteral("type")] == QLatin1String("tilelayer"))
-        layer = toTileLayer(variantMap);
-    else if (variantMap[QStringLiteral("type")] == QLatin1String("objectgroup"))
-        layer = toObjectGroup(variantMap);
-    else if (variantMap[QStringLiteral("type")] == QLatin1String("imagelayer"))
-        layer = toImageLayer(variantMap);
-    else if (variantMap[QStringLiteral("type")] == QLatin1String("group"))
-        layer = toGroupLayer(variantMap);
+    static const QHash<QString, Layer::TypeFlag> layerTypeByName {
+        { QStringLiteral("tilelayer"),   Layer::TileLayerType },
+        { QStringLiteral("objectgroup"), Layer::ObjectGroupType },
+        { QStringLiteral("imagelayer"),  Layer::ImageLayerType },
+        { QStringLiteral("group"),       Layer::GroupLayerType },
+    };
+
+    const auto typeIt = layerTypeByName.constFind(variantMap[QStringLiteral("type")].toString());
+    if (typeIt != layerTypeByName.constEnd()) {
+        switch (typeIt.value()) {
+        case Layer::TileLayerType:
+            layer = toTileLayer(variantMap);
+            break;
+        case Layer::ObjectGroupType:
+            layer = toObjectGroup(variantMap);
+            break;
+        case Layer::ImageLayerType:
+            layer = toImageLayer(variantMap);
+            break;
+        case Layer::GroupLayerType:
+            layer = toGroupLayer(variantMap);
+            break;
+        }
+    }
 
     if (layer) {
         layer->setId(variantMap[QStringLiteral("id")].toInt());
-        layer->setClassName(variantMap[QStringLiteral("class")].toString());
+        layer->setClassName(internString(variantMap[QStringLiteral("class")].toString()));
         layer->setOpacity(variantMap[QStringLiteral("opacity")].toReal());
         layer->setVisible(variantMap[QStringLiteral("visible")].toBool());
         layer->setLocked(variantMap[QStringLiteral("locked")].toBool());
@@ -616,7 +656,7 @@ std::unique_ptr<Layer> VariantToMapConverter::toLayer(const QVariant &variant)
 
 std::unique_ptr<TileLayer> VariantToMapConverter::toTileLayer(const QVariantMap &variantMap)
 {
-    const QString name = variantMap[QStringLiteral("name")].toString();
+    const QString name = internString(variantMap[QStringLiteral("name")].toString());
     const int width = variantMap[QStringLiteral("width")].toInt();
     const int height = variantMap[QStringLiteral("height")].toInt();
     const int startX = variantMap[QStringLiteral("startx")].toInt();
@@ -669,7 +709,8 @@ std::unique_ptr<TileLayer> VariantToMapConverter::toTileLayer(const QVariantMap
             int width = chunkVariantMap[QStringLiteral("width")].toInt();
             int height = chunkVariantMap[QStringLiteral("height")].toInt();
 
-            readTileLayerData(*tileLayer, chunkData, layerDataFormat, QRect(x, y, width, height));
+            readTileLayerData(*tileLayer, chunkData, layerDataFormat,
+                              QRect(x, y, width, height), false);
         }
     }
 
@@ -679,7 +720,7 @@ std::unique_ptr<TileLayer> VariantToMapConverter::toTileLayer(const QVariantMap
 std::unique_ptr<ObjectGroup> VariantToMapConverter::toObjectGroup(const QVariantMap &variantMap)
 {
     using ObjectGroupPtr = std::unique_ptr<ObjectGroup>;
-    ObjectGroupPtr objectGroup(new ObjectGroup(variantMap[QStringLiteral("name")].toString(),
+    ObjectGroupPtr objectGroup(new ObjectGroup(internString(variantMap[QStringLiteral("name")].toString()),
                                                variantMap[QStringLiteral("x")].toInt(),
                                                variantMap[QStringLiteral("y")].toInt()));
 
@@ -703,7 +744,7 @@ std::unique_ptr<ObjectGroup> VariantToMapConverter::toObjectGroup(const QVariant
 
 std::unique_ptr<MapObject> VariantToMapConverter::toMapObject(const QVariantMap &variantMap)
 {
-    const QString name = variantMap[QStringLiteral("name")].toString();
+    const QString name = internString(variantMap[QStringLiteral("name")].toString());
     const int id = variantMap[QStringLiteral("id")].toInt();
     const int gid = variantMap[QStringLiteral("gid")].toInt();
     const QVariant templateVariant = variantMap[QStringLiteral("template")];
@@ -720,7 +761,7 @@ std::unique_ptr<MapObject> VariantToMapConverter::toMapObject(const QVariantMap
     const QPointF pos(x, y);
     const QSizeF size(width, height);
 
-    auto object = std::make_unique<MapObject>(name, className, pos, size);
+    auto object = std::make_unique<MapObject>(name, internString(className), pos, size);
     object->setId(id);
 
     if (variantMap.contains(QLatin1String("rotation"))) {
@@ -743,6 +784,16 @@ std::unique_ptr<MapObject> VariantToMapConverter::toMapObject(const QVariantMap
         bool ok;
         object->setCell(mGidMapper.gidToCell(gid, ok));
 
+        // A sizeless tile object takes the size of its tile, whose geometry
+        // only exists once the tileset image is loaded. With deferred image
+        // loading this is the one case that still needs the image up front.
+#ifndef TILED_HEADLESS
+        if (width == 0 || height == 0)
+            if (Tileset *tileset = object->cell().tileset())
+                if (!tileset->isCollection() && tileset->imageStatus() == LoadingPending)
+                    tileset->loadImage();
+#endif
+
         if (const Tile *tile = object->cell().tile()) {
             const QSizeF &tileSize = tile->size();
             if (width == 0)
@@ -822,7 +873,7 @@ std::unique_ptr<ImageLayer> VariantToMapConverter::toImageLayer(const QVariantMa
 
 std::unique_ptr<GroupLayer> VariantToMapConverter::toGroupLayer(const QVariantMap &variantMap)
 {
-    const QString name = variantMap[QStringLiteral("name")].toString();
+    const QString name = internString(variantMap[QStringLiteral("name")].toString());
     const int x = variantMap[QStringLiteral("x")].toInt();
     const int y = variantMap[QStringLiteral("y")].toInt();
 
@@ -932,11 +983,13 @@ void VariantToMapConverter::readTilesetEditorSettings(Tileset &tileset, const QV
 bool VariantToMapConverter::readTileLayerData(TileLayer &tileLayer,
                                               const QVariant &dataVariant,
                                               Map::LayerDataFormat layerDataFormat,
-                                              QRect bounds)
+                                              QRect bounds,
+                                              bool failOnError)
 {
     switch (layerDataFormat) {
     case Map::XML:
-    case Map::CSV: {
+    case Map::CSV:
+    case Map::DeltaVLQ: {
         const QVariantList dataVariantList = dataVariant.toList();
 
         if (dataVariantList.size() != bounds.width() * bounds.height()) {
@@ -972,32 +1025,107 @@ bool VariantToMapConverter::readTileLayerData(TileLayer &tileLayer,
     case Map::Base64:
     case Map::Base64Zlib:
     case Map::Base64Gzip:
-    case Map::Base64Zstandard:{
-        const QByteArray data = dataVariant.toByteArray();
-        GidMapper::DecodeError error = mGidMapper.decodeLayerData(tileLayer,
-                                                                  data,
-                                                                  layerDataFormat,
-                                                                  bounds);
-
-        switch (error) {
+    case Map::Base64Zstandard: {
+        // Defer the decoding so that all layers can be processed in
+        // parallel by decodeDeferredTileData, once every layer has been
+        // converted.
+        if (mTileDataJobs.isEmpty() || mTileDataJobs.last().tileLayer != &tileLayer)
+            mTileDataJobs.append({ &tileLayer, layerDataFormat, failOnError, {}, {} });
+
+        DeferredTileData &job = mTileDataJobs.last();
+        job.data.append(dataVariant.toByteArray());
+        job.bounds.append(bounds);
+        break;
+    }
+    }
+
+    return true;
+}
+
+/**
+ * Decodes the tile data that was set aside by readTileLayerData, spreading
+ * the layers over the global thread pool. Layers are the unit of work since
+ * TileLayer::setCell is not safe to call concurrently on a single layer.
+ *
+ * Returns false when a layer with a mandatory "data" member failed to
+ * decode, in which case the error can be obtained using errorString().
+ */
+bool VariantToMapConverter::decodeDeferredTileData()
+{
+    if (mTileDataJobs.isEmpty())
+        return true;
+
+    struct Result {
+        GidMapper::DecodeError error = GidMapper::NoError;
+        unsigned invalidTile = 0;
+    };
+
+    QVector<Result> results(mTileDataJobs.size());
+
+    const auto decodeJob = [this, &results] (int i) {
+        const DeferredTileData &job = mTileDataJobs.at(i);
+
+        // Each job decodes through its own copy of the GID mapper, since
+        // the mapper stores the last invalid tile as mutable state.
+        const GidMapper gidMapper = mGidMapper;
+
+        for (int c = 0; c < job.data.size(); ++c) {
+            const auto error = gidMapper.decodeLayerData(*job.tileLayer,
+                                                         job.data.at(c),
+                                                         job.format,
+                                                         job.bounds.at(c));
+            if (error != GidMapper::NoError) {
+                results[i].error = error;
+                results[i].invalidTile = gidMapper.invalidTile();
+                if (job.failOnError)
+                    return;
+            }
+        }
+    };
+
+    if (mTileDataJobs.size() == 1) {
+        decodeJob(0);
+    } else {
+        auto threadPool = QThreadPool::globalInstance();
+        QSemaphore semaphore;
+
+        for (int i = 0; i < mTileDataJobs.size(); ++i) {
+            threadPool->start([=, &semaphore] {
+                decodeJob(i);
+                semaphore.release();
+            });
+        }
+
+        semaphore.acquire(mTileDataJobs.size());
+    }
+
+    bool ok = true;
+
+    for (int i = 0; i < results.size(); ++i) {
+        const DeferredTileData &job = mTileDataJobs.at(i);
+
+        switch (results.at(i).error) {
         case GidMapper::CorruptLayerData:
-            mError = tr("Corrupt layer data for layer '%1'").arg(tileLayer.name());
-            return false;
+            mError = tr("Corrupt layer data for layer '%1'").arg(job.tileLayer->name());
+            break;
         case GidMapper::TileButNoTilesets:
             mError = tr("Tile used but no tilesets specified");
-            return false;
+            break;
         case GidMapper::InvalidTile:
-            mError = tr("Invalid tile: %1").arg(mGidMapper.invalidTile());
-            return false;
-        case GidMapper::NoError:
+            mError = tr("Invalid tile: %1").arg(results.at(i).invalidTile);
             break;
+        case GidMapper::NoError:
+            continue;
         }
 
-        break;
-    }
+        if (job.failOnError) {
+            ok = false;
+            break;
+        }
     }
 
-    return true;
+    mTileDataJobs.clear();
+    return ok;
 }
 
 Properties VariantToMapConverter::extractProperties(const QVariantMap &variantMap) const
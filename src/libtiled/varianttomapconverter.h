@@ -106,14 +106,30 @@ private:
     bool readTileLayerData(TileLayer &tileLayer,
                            const QVariant &dataVariant,
                            Map::LayerDataFormat layerDataFormat,
-                           QRect bounds);
+                           QRect bounds,
+                           bool failOnError = true);
+    bool decodeDeferredTileData();
 
     Properties extractProperties(const QVariantMap &variantMap) const;
 
+    /**
+     * Base64-encoded tile data of a single tile layer, set aside during the
+     * layer pass so that all layers can be decoded in parallel once the
+     * tileset table is complete.
+     */
+    struct DeferredTileData {
+        TileLayer *tileLayer;
+        Map::LayerDataFormat format;
+        bool failOnError;
+        QVector<QByteArray> data;
+        QVector<QRect> bounds;
+    };
+
     Map *mMap;
     QDir mDir;
     bool mReadingExternalTileset;
     GidMapper mGidMapper;
+    QVector<DeferredTileData> mTileDataJobs;
     QString mError;
 };
 
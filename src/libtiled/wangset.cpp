@@ -30,8 +30,13 @@
 
 #include <QDebug>
 #include <QStack>
+#include <QVarLengthArray>
+#include <QtAlgorithms>
 #include <QtMath>
 
+#include <algorithm>
+#include <climits>
+
 namespace Tiled {
 
 /**
@@ -537,12 +542,176 @@ const QVector<WangSet::WangIdAndCell> &WangSet::wangIdsAndCells() const
     return mWangIdAndCells;
 }
 
+/**
+ * Returns a bitmask over the positions in wangIdsAndCells(), with a set bit
+ * for every entry that has the given \a color at the given \a index. Words
+ * beyond the returned vector are all zero. Intersecting the masks of the
+ * constrained indexes narrows down the candidates matching a partial WangId
+ * without looking at any entry.
+ */
+const QVector<quint64> &WangSet::wangIdsAndCellsBits(int index, int color) const
+{
+    static const QVector<quint64> empty;
+
+    wangIdsAndCells();  // make sure the lookup table is up-to-date
+
+    if (color < 0 || color > colorCount())
+        return empty;
+
+    return mWangIdAndCellsBitsByIndexColor.at(index * (colorCount() + 1) + color);
+}
+
+/**
+ * Returns the cells that best match the given constraint signature: of all
+ * assigned WangIds matching \a desired at the indexes constrained by \a mask,
+ * those tied for the lowest total transition penalty at the remaining
+ * indexes, along with their pick probabilities.
+ *
+ * When \a corrections is set, candidates that would require a transition
+ * between colors that have no path to each other are dropped rather than
+ * scored, and the empty cell competes as a candidate so that a tile can be
+ * erased when nothing fits.
+ *
+ * Since many cells share the same constraint signature while filling, the
+ * results are kept in a least-recently-used cache. The cache is cleared
+ * whenever the cells, the color distances or the color probabilities change.
+ */
+WangSet::CellCandidates WangSet::cellCandidates(WangId desired, WangId mask,
+                                                bool corrections) const
+{
+    // Bring the lookup tables up-to-date first, since recalculating them
+    // clears the candidates cache.
+    const auto &wangIdsAndCells = this->wangIdsAndCells();
+    const int unreachablePenalty = maximumColorDistance() + 1;
+
+    const CellCandidatesKey key { desired, mask, corrections };
+    if (const CellCandidates *cached = mCellCandidatesCache.object(key))
+        return *cached;
+
+    CellCandidates candidates;
+    const quint64 maskedWangId = desired & mask;
+    int lowestPenalty = INT_MAX;
+
+    auto processCandidate = [&] (WangId wangId, const Cell &cell) {
+        if ((wangId & mask) != maskedWangId)
+            return;
+
+        int totalPenalty = 0;
+
+        for (int i = 0; i < WangId::NumIndexes; ++i) {
+            const int desiredColor = desired.indexColor(i);
+            const int candidateColor = wangId.indexColor(i);
+
+            if (candidateColor != desiredColor) {
+                int penalty = transitionPenalty(desiredColor, candidateColor);
+
+                // If there is no path to the desired color, this isn't a useful transition
+                if (penalty < 0) {
+                    if (corrections) {
+                        // When we're doing corrections, we'd rather not
+                        // choose this candidate at all because it's
+                        // impossible to transition to the desired color.
+                        return;
+                    } else {
+                        penalty = unreachablePenalty;
+                    }
+                }
+
+                totalPenalty += penalty;
+            }
+        }
+
+        // Add the cell to the candidate list
+        if (totalPenalty <= lowestPenalty) {
+            if (totalPenalty < lowestPenalty) {
+                candidates.cells.clear();
+                candidates.probabilities.clear();
+                lowestPenalty = totalPenalty;
+            }
+
+            qreal probability = wangIdProbability(wangId);
+            if (Tile *tile = cell.tile())
+                probability *= tile->probability();
+
+            candidates.cells.append(cell);
+            candidates.probabilities.append(probability);
+        }
+    };
+
+    // Every fully constrained index restricts the candidates to those that
+    // have the desired color there. The candidate sets of all constrained
+    // indexes are intersected as bitmasks, so that only candidates satisfying
+    // every constraint are enumerated and scored.
+    QVarLengthArray<quint64, 64> candidateBits;
+    bool constrained = false;
+
+    for (int i = 0; i < WangId::NumIndexes; ++i) {
+        if (mask.indexColor(i) != WangId::INDEX_MASK)
+            continue;
+
+        const auto &bits = wangIdsAndCellsBits(i, desired.indexColor(i));
+        if (!constrained) {
+            constrained = true;
+            candidateBits.resize(bits.size());
+            std::copy(bits.begin(), bits.end(), candidateBits.begin());
+        } else {
+            // Words beyond either mask are zero
+            if (candidateBits.size() > bits.size())
+                candidateBits.resize(bits.size());
+            for (int w = 0; w < candidateBits.size(); ++w)
+                candidateBits[w] &= bits.at(w);
+        }
+    }
+
+    if (constrained) {
+        for (int w = 0; w < candidateBits.size(); ++w) {
+            quint64 word = candidateBits[w];
+            while (word) {
+                const int i = w * 64 + qCountTrailingZeroBits(word);
+                word &= word - 1;
+                processCandidate(wangIdsAndCells[i].wangId, wangIdsAndCells[i].cell);
+            }
+        }
+    } else {
+        for (int i = 0, i_end = wangIdsAndCells.size(); i < i_end; ++i)
+            processCandidate(wangIdsAndCells[i].wangId, wangIdsAndCells[i].cell);
+    }
+
+    if (corrections)
+        processCandidate(WangId(), Cell());
+
+    if (!candidates.cells.isEmpty())
+        candidates.penalty = lowestPenalty;
+
+    mCellCandidatesCache.insert(key, new CellCandidates(candidates));
+    return candidates;
+}
+
 void WangSet::recalculateCells()
 {
     mWangIdAndCells.clear();
+    mWangIdAndCellsBitsByIndexColor.clear();
+    mWangIdAndCellsBitsByIndexColor.resize(WangId::NumIndexes * (colorCount() + 1));
+    mCellCandidatesCache.clear();
     mCellsDirty = false;
     mUniqueFullWangIdCount = 0;
 
+    auto appendWangIdAndCell = [this] (WangId wangId, const Cell &cell) {
+        const int position = mWangIdAndCells.size();
+        mWangIdAndCells.append({wangId, cell});
+
+        for (int i = 0; i < WangId::NumIndexes; ++i) {
+            const int color = wangId.indexColor(i);
+            if (color <= colorCount()) {
+                auto &bits = mWangIdAndCellsBitsByIndexColor[i * (colorCount() + 1) + color];
+                const int word = position / 64;
+                if (bits.size() <= word)
+                    bits.resize(word + 1);
+                bits[word] |= quint64(1) << (position % 64);
+            }
+        }
+    };
+
     QSet<WangId> addedWangIds;
 
     // First insert all available tiles
@@ -551,7 +720,7 @@ void WangSet::recalculateCells()
         it.next();
         mUniqueFullWangIdCount += !it.value().hasWildCards() && !addedWangIds.contains(it.value());
         addedWangIds.insert(it.value());
-        mWangIdAndCells.append({it.value(), Cell(mTileset, it.key())});
+        appendWangIdAndCell(it.value(), Cell(mTileset, it.key()));
     }
 
     const auto transformationFlags = tileset()->transformationFlags();
@@ -607,7 +776,7 @@ void WangSet::recalculateCells()
                 continue;
             mUniqueFullWangIdCount += !hasWildCards && !exists;
             addedWangIds.insert(wangIds[i]);
-            mWangIdAndCells.append({wangIds[i], cells[i]});
+            appendWangIdAndCell(wangIds[i], cells[i]);
         }
     }
 }
@@ -696,6 +865,7 @@ void WangSet::recalculateColorDistances()
     } while (newConnections);
 
     mMaximumColorDistance = maximumDistance;
+    mCellCandidatesCache.clear();
     mColorDistancesDirty = false;
 }
 
@@ -31,6 +31,7 @@
 #include "tileset.h"
 #include "tilelayer.h"
 
+#include <QCache>
 #include <QHash>
 #include <QMultiHash>
 #include <QString>
@@ -194,7 +195,7 @@ public:
     void setName(const QString &name) { mName = name; }
     void setColor(const QColor &color) { mColor = color; }
     void setImageId(int imageId) { mImageId = imageId; }
-    void setProbability(qreal probability) { mProbability = probability; }
+    void setProbability(qreal probability);
 
     WangSet *wangSet() const { return mWangSet; }
 
@@ -274,6 +275,21 @@ public:
     };
 
     const QVector<WangIdAndCell> &wangIdsAndCells() const;
+    const QVector<quint64> &wangIdsAndCellsBits(int index, int color) const;
+
+    /**
+     * The cells matching one constraint signature that are tied for the
+     * lowest total transition penalty, along with their pick probabilities.
+     */
+    struct CellCandidates
+    {
+        QVector<Cell> cells;
+        QVector<qreal> probabilities;
+        int penalty = -1;   // the shared total penalty, or -1 when empty
+    };
+
+    CellCandidates cellCandidates(WangId desired, WangId mask,
+                                  bool corrections) const;
 
     QList<WangTile> sortedWangTiles() const;
 
@@ -303,11 +319,39 @@ public:
     WangSet *clone(Tileset *tileset) const;
 
 private:
+    friend class WangColor;
+
     void removeTileId(int tileId);
 
     bool cellsDirty() const;
     void recalculateCells();
     void recalculateColorDistances();
+    void invalidateCellCandidates() { mCellCandidatesCache.clear(); }
+
+    struct CellCandidatesKey
+    {
+        quint64 desired;
+        quint64 mask;
+        bool corrections;
+
+        bool operator==(const CellCandidatesKey &other) const
+        {
+            return desired == other.desired
+                    && mask == other.mask
+                    && corrections == other.corrections;
+        }
+    };
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    friend uint qHash(const CellCandidatesKey &key, uint seed) Q_DECL_NOTHROW
+#else
+    friend size_t qHash(const CellCandidatesKey &key, size_t seed) Q_DECL_NOTHROW
+#endif
+    {
+        auto h = ::qHash(key.desired, seed);
+        h = ::qHash(key.mask, h);
+        return h ^ key.corrections;
+    }
 
     Tileset *mTileset;
     QString mName;
@@ -323,6 +367,15 @@ private:
 
     QVector<WangIdAndCell> mWangIdAndCells;
 
+    // Bitmask over the positions in mWangIdAndCells indexed by (index,
+    // color), used to quickly narrow down candidates matching a partial
+    // WangId by intersecting the masks of the constrained indexes.
+    QVector<QVector<quint64>> mWangIdAndCellsBitsByIndexColor;
+
+    // Ranked candidate lists by constraint signature, kept across fill
+    // operations and cleared whenever anything affecting them changes
+    mutable QCache<CellCandidatesKey, CellCandidates> mCellCandidatesCache { 256 };
+
     int mMaximumColorDistance = 0;
     bool mColorDistancesDirty = true;
     bool mCellsDirty = true;
@@ -401,6 +454,17 @@ inline bool WangSet::cellsDirty() const
     return mCellsDirty || mLastSeenTranslationFlags != mTileset->transformationFlags();
 }
 
+/**
+ * Sets the probability of this color. Invalidates any cached cell
+ * candidates, since they include the pick probabilities.
+ */
+inline void WangColor::setProbability(qreal probability)
+{
+    mProbability = probability;
+    if (mWangSet)
+        mWangSet->invalidateCellCandidates();
+}
+
 TILEDSHARED_EXPORT QString wangSetTypeToString(WangSet::Type type);
 TILEDSHARED_EXPORT WangSet::Type wangSetTypeFromString(const QString &);
 
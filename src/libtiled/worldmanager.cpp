@@ -38,6 +38,8 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QPointer>
+#include <QThreadPool>
 #include <QUrl>
 
 #include <QDebug>
@@ -90,12 +92,29 @@ void WorldManager::reloadWorldFiles(const QStringList &fileNames)
                 std::unique_ptr<World> oldWorld { mWorlds.take(fileName) };
                 oldWorld->clearErrorsAndWarnings();
 
+                if (oldWorld->patterns.isEmpty() != world->patterns.isEmpty()) {
+                    const QString dir = QFileInfo(fileName).path();
+                    if (world->patterns.isEmpty())
+                        mFileSystemWatcher.removePath(dir);
+                    else
+                        mFileSystemWatcher.addPath(dir);
+                }
+
                 mWorlds.insert(fileName, world.release());
+                refreshPatternMapsAsync(fileName);
 
                 changed = true;
                 emit worldReloaded(fileName);
             }
+
+            continue;
         }
+
+        // A change notification for a directory means the cached pattern
+        // matches of the worlds in it may be out of date.
+        for (const World *world : std::as_const(mWorlds))
+            if (!world->patterns.isEmpty() && QFileInfo(world->fileName).path() == fileName)
+                refreshPatternMapsAsync(world->fileName);
     }
 
     if (changed)
@@ -246,7 +265,11 @@ World *WorldManager::loadAndStoreWorld(const QString &fileName, QString *errorSt
     else
         mFileSystemWatcher.addPath(fileName);
 
+    if (!world->patterns.isEmpty())
+        mFileSystemWatcher.addPath(QFileInfo(fileName).path());
+
     mWorlds.insert(fileName, world.release());
+    refreshPatternMapsAsync(fileName);
     emit worldLoaded(fileName);
 
     return mWorlds.value(fileName);
@@ -268,6 +291,94 @@ void WorldManager::loadWorlds(const QStringList &fileNames)
         emit worldsChanged();
 }
 
+/**
+ * Loads all given worlds asynchronously.
+ *
+ * The world files are read and parsed on the global thread pool. Each world
+ * is added as soon as it resolves, emitting worldLoaded and worldsChanged,
+ * so its maps can start to appear while other worlds are still loading.
+ * Once the whole batch has been processed, worldsLoaded is emitted.
+ */
+void WorldManager::loadWorldsAsync(const QStringList &fileNames)
+{
+    if (fileNames.isEmpty()) {
+        emit worldsLoaded();
+        return;
+    }
+
+    const auto remaining = std::make_shared<int>(fileNames.size());
+    const QPointer<WorldManager> self = this;
+
+    for (const QString &fileName : fileNames) {
+        QThreadPool::globalInstance()->start([=] {
+            // Reading and parsing the world file only touches local state
+            const auto world = std::make_shared<std::unique_ptr<World>>(
+                        privateLoadWorld(fileName));
+
+            QMetaObject::invokeMethod(self, [=] {
+                if (*world) {
+                    if (mWorlds.contains(fileName))
+                        delete mWorlds.take(fileName);
+                    else
+                        mFileSystemWatcher.addPath(fileName);
+
+                    if (!(*world)->patterns.isEmpty())
+                        mFileSystemWatcher.addPath(QFileInfo(fileName).path());
+
+                    mWorlds.insert(fileName, world->release());
+                    refreshPatternMapsAsync(fileName);
+                    emit worldLoaded(fileName);
+                    emit worldsChanged();
+                }
+
+                if (--*remaining == 0)
+                    emit worldsLoaded();
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+/**
+ * Re-resolves the pattern-matched maps of the world with the given
+ * \a fileName on the global thread pool.
+ *
+ * Listing the world's directory can be slow on networked drives, so it is
+ * kept off the interactive path: queries keep serving the previous cache
+ * until the refreshed listing arrives, and worldsChanged is only emitted
+ * when the membership actually changed.
+ */
+void WorldManager::refreshPatternMapsAsync(const QString &fileName)
+{
+    World *world = mWorlds.value(fileName);
+    if (!world || world->patterns.isEmpty())
+        return;
+
+    const QString worldFileName = world->fileName;
+    const QVector<World::Pattern> patterns = world->patterns;
+    const QPointer<WorldManager> self = this;
+
+    QThreadPool::globalInstance()->start([=] {
+        // Listing the directory and matching only touches local state
+        const auto entries = std::make_shared<QVector<World::MapEntry>>(
+                    World::resolvePatternMaps(worldFileName, patterns));
+
+        QMetaObject::invokeMethod(self, [=] {
+            World *currentWorld = mWorlds.value(fileName);
+            if (currentWorld != world)  // unloaded or replaced in the meantime
+                return;
+
+            const bool changed = !currentWorld->patternMapsCacheValid
+                    || currentWorld->patternMapsCache != *entries;
+
+            currentWorld->patternMapsCache = *entries;
+            currentWorld->patternMapsCacheValid = true;
+
+            if (changed)
+                emit worldsChanged();
+        }, Qt::QueuedConnection);
+    });
+}
+
 bool WorldManager::saveWorld(const QString &fileName, QString *errorString)
 {
     World *savingWorld = nullptr;
@@ -339,6 +450,8 @@ void WorldManager::unloadWorld(const QString &fileName)
     std::unique_ptr<World> world { mWorlds.take(fileName) };
     if (world) {
         mFileSystemWatcher.removePath(fileName);
+        if (!world->patterns.isEmpty())
+            mFileSystemWatcher.removePath(QFileInfo(fileName).path());
         emit worldsChanged();
         emit worldUnloaded(fileName);
     }
@@ -523,30 +636,63 @@ QRect World::mapRect(const QString &fileName) const
 QVector<World::MapEntry> World::allMaps() const
 {
     QVector<World::MapEntry> all(maps);
+    all += patternMaps();
+    return all;
+}
 
-    if (!patterns.isEmpty()) {
-        const QDir dir(QFileInfo(fileName).dir());
-        const QStringList entries = dir.entryList(QDir::Files | QDir::Readable);
+/**
+ * Returns the maps matched by the patterns of this world.
+ *
+ * The result is cached, since resolving it requires listing the world's
+ * directory. The WorldManager refreshes the cache on a thread pool thread
+ * when the directory changes; the synchronous rebuild here only runs when
+ * the cache is queried before the first refresh has arrived.
+ */
+QVector<World::MapEntry> World::patternMaps() const
+{
+    if (patterns.isEmpty())
+        return {};
 
-        for (const World::Pattern &pattern : patterns) {
-            for (const QString &fileName : entries) {
-                QRegularExpressionMatch match = pattern.regexp.match(fileName);
-                if (match.hasMatch()) {
+    if (!patternMapsCacheValid) {
+        patternMapsCache = resolvePatternMaps(fileName, patterns);
+        patternMapsCacheValid = true;
+    }
+
+    return patternMapsCache;
+}
+
+/**
+ * Lists the directory of the world file with the given \a fileName and
+ * returns the entries matched by the given \a patterns.
+ *
+ * Only touches local state, so it may be called from any thread.
+ */
+QVector<World::MapEntry> World::resolvePatternMaps(const QString &fileName,
+                                                   const QVector<Pattern> &patterns)
+{
+    QVector<World::MapEntry> all;
+
+    const QDir dir(QFileInfo(fileName).dir());
+    const QStringList entries = dir.entryList(QDir::Files | QDir::Readable);
+
+    for (const World::Pattern &pattern : patterns) {
+        for (const QString &entryName : entries) {
+            QRegularExpressionMatch match = pattern.regexp.match(entryName);
+            if (match.hasMatch()) {
 #if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
-                    const int x = match.capturedView(1).toInt();
-                    const int y = match.capturedView(2).toInt();
+                const int x = match.capturedView(1).toInt();
+                const int y = match.capturedView(2).toInt();
 #else
-                    const int x = match.capturedRef(1).toInt();
-                    const int y = match.capturedRef(2).toInt();
+                const int x = match.capturedRef(1).toInt();
+                const int y = match.capturedRef(2).toInt();
 #endif
 
-                    MapEntry entry;
-                    entry.fileName = dir.filePath(fileName);
-                    entry.rect = QRect(QPoint(x * pattern.multiplierX,
-                                              y * pattern.multiplierY) + pattern.offset,
-                                       pattern.mapSize);
-                    all.append(entry);
-                }
+                MapEntry entry;
+                entry.fileName = dir.filePath(entryName);
+                entry.rect = QRect(QPoint(x * pattern.multiplierX,
+                                          y * pattern.multiplierY) + pattern.offset,
+                                   pattern.mapSize);
+                all.append(entry);
             }
         }
     }
@@ -577,18 +723,9 @@ QString World::firstMap() const
     if (!maps.isEmpty())
         return maps.first().fileName;
 
-    if (!patterns.isEmpty()) {
-        const QDir dir(QFileInfo(fileName).dir());
-        const QStringList entries = dir.entryList(QDir::Files | QDir::Readable);
-
-        for (const World::Pattern &pattern : patterns) {
-            for (const QString &fileName : entries) {
-                QRegularExpressionMatch match = pattern.regexp.match(fileName);
-                if (match.hasMatch())
-                    return dir.filePath(fileName);
-            }
-        }
-    }
+    const QVector<MapEntry> matched = patternMaps();
+    if (!matched.isEmpty())
+        return matched.first().fileName;
 
     return QString();
 }
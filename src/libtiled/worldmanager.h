@@ -60,6 +60,9 @@ struct TILEDSHARED_EXPORT World
     {
         QString fileName;
         QRect rect;
+
+        bool operator==(const MapEntry &other) const
+        { return fileName == other.fileName && rect == other.rect; }
     };
 
     QString fileName;
@@ -68,6 +71,14 @@ struct TILEDSHARED_EXPORT World
     bool onlyShowAdjacentMaps = false;
     bool hasUnsavedChanges = false;
 
+    /**
+     * The maps matched by the patterns, cached to avoid re-listing the
+     * world's directory on every query. The WorldManager refreshes the
+     * cache when the directory changes.
+     */
+    mutable QVector<MapEntry> patternMapsCache;
+    mutable bool patternMapsCacheValid = false;
+
     int mapIndex(const QString &fileName) const;
     void setMapRect(int mapIndex, const QRect &rect);
     void addMap(const QString &fileName, const QRect &rect);
@@ -75,6 +86,9 @@ struct TILEDSHARED_EXPORT World
     bool containsMap(const QString &fileName) const;
     QRect mapRect(const QString &fileName) const;
     QVector<MapEntry> allMaps() const;
+    QVector<MapEntry> patternMaps() const;
+    static QVector<MapEntry> resolvePatternMaps(const QString &fileName,
+                                                const QVector<Pattern> &patterns);
     QVector<MapEntry> mapsInRect(const QRect &rect) const;
     QVector<MapEntry> contextMaps(const QString &fileName) const;
     QString firstMap() const;
@@ -107,6 +121,7 @@ public:
     World *addEmptyWorld(const QString &fileName, QString *errorString);
     World *loadWorld(const QString &fileName, QString *errorString = nullptr);
     void loadWorlds(const QStringList &fileNames);
+    void loadWorldsAsync(const QStringList &fileNames);
     void unloadWorld(const QString &fileName);
     void unloadAllWorlds();
     bool saveWorld(const QString &fileName, QString *errorString = nullptr);
@@ -122,6 +137,7 @@ public:
 
 signals:
     void worldsChanged();
+    void worldsLoaded();
     void worldLoaded(const QString &fileName);
     void worldReloaded(const QString &fileName);
     void worldUnloaded(const QString &fileName);
@@ -135,6 +151,8 @@ private:
     std::unique_ptr<World> privateLoadWorld(const QString &fileName,
                                             QString *errorString = nullptr);
 
+    void refreshPatternMapsAsync(const QString &fileName);
+
     QMap<QString, World*> mWorlds;
 
     FileSystemWatcher mFileSystemWatcher;
@@ -25,6 +25,9 @@
 #include "tiled.h"
 #include "tileset.h"
 
+#include <QPointer>
+#include <QThreadPool>
+
 using namespace TiledQuick;
 
 MapLoader::MapLoader(QObject *parent)
@@ -44,27 +47,79 @@ void MapLoader::setSource(const QUrl &source)
         return;
 
     m_source = source;
+    ++m_generation;
+
+    emit sourceChanged(source);
+
+    if (m_map) {
+        m_map.reset();
+        emit mapChanged(nullptr);
+    }
+
+    setProgress(0.0);
+    setError(QString());
+
+    if (source.isEmpty()) {
+        setStatus(Null);
+        return;
+    }
 
-    Tiled::MapReader mapReader;
+    setStatus(Loading);
 
-    std::unique_ptr<Tiled::Map> map(mapReader.readMap(Tiled::urlToLocalFileOrQrc(source)));
-    Status status = map ? Ready : Error;
-    QString error = map ? QString() : mapReader.errorString();
+    // Read and parse the map on the global thread pool, so that the GUI
+    // thread stays responsive while a large map loads. Tile layer data is
+    // decoded lazily per chunk, which lets MapItem show the first visible
+    // regions before the bulk of the layer data has been touched.
+    const int generation = m_generation;
+    const QPointer<MapLoader> self = this;
 
-    const bool mapDiff = m_map != map;
-    const bool statusDiff = m_status != status;
-    const bool errorDiff = m_error != error;
+    QThreadPool::globalInstance()->start([=] {
+        Tiled::MapReader mapReader;
+        mapReader.setDeferredChunkDecoding(true);
+
+        const auto map = std::make_shared<std::unique_ptr<Tiled::Map>>(
+                    mapReader.readMap(Tiled::urlToLocalFileOrQrc(source)));
+        const QString error = *map ? QString() : mapReader.errorString();
+
+        QMetaObject::invokeMethod(self, [=] {
+            // A newer setSource call may have superseded this load
+            if (generation != m_generation)
+                return;
+
+            m_map = std::move(*map);
+
+            setProgress(1.0);
+            setStatus(m_map ? Ready : Error);
+            setError(error);
+
+            emit mapChanged(m_map.get());
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MapLoader::setStatus(Status status)
+{
+    if (m_status == status)
+        return;
 
-    m_map = std::move(map);
     m_status = status;
-    m_error = error;
+    emit statusChanged(status);
+}
 
-    emit sourceChanged(source);
+void MapLoader::setProgress(qreal progress)
+{
+    if (m_progress == progress)
+        return;
 
-    if (mapDiff)
-        emit mapChanged(m_map.get());
-    if (statusDiff)
-        emit statusChanged(status);
-    if (errorDiff)
-        emit errorChanged(error);
+    m_progress = progress;
+    emit progressChanged(progress);
+}
+
+void MapLoader::setError(const QString &error)
+{
+    if (m_error == error)
+        return;
+
+    m_error = error;
+    emit errorChanged(error);
 }
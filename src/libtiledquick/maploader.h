@@ -35,13 +35,15 @@ class TILEDQUICK_SHARED_EXPORT MapLoader : public QObject
     Q_OBJECT
 
     Q_PROPERTY(QUrl source READ source WRITE setSource NOTIFY sourceChanged)
-    Q_PROPERTY(TiledQuick::MapRef map READ map NOTIFY sourceChanged)
+    Q_PROPERTY(TiledQuick::MapRef map READ map NOTIFY mapChanged)
     Q_PROPERTY(Status status READ status NOTIFY statusChanged)
+    Q_PROPERTY(qreal progress READ progress NOTIFY progressChanged)
     Q_PROPERTY(QString error READ error NOTIFY errorChanged)
 
 public:
     enum Status {
         Null,
+        Loading,
         Ready,
         Error
     };
@@ -53,22 +55,30 @@ public:
     QUrl source() const;
     MapRef map() const;
     Status status() const;
+    qreal progress() const;
     QString error() const;
 
 signals:
     void sourceChanged(const QUrl &source);
     void mapChanged(Tiled::Map *map);
     void statusChanged(Status status);
+    void progressChanged(qreal progress);
     void errorChanged(const QString &error);
 
 public slots:
     void setSource(const QUrl &source);
 
 private:
+    void setStatus(Status status);
+    void setProgress(qreal progress);
+    void setError(const QString &error);
+
     QUrl m_source;
     std::unique_ptr<Tiled::Map> m_map;
     Status m_status;
+    qreal m_progress = 0.0;
     QString m_error;
+    int m_generation = 0;
 };
 
 
@@ -82,6 +92,11 @@ inline MapLoader::Status MapLoader::status() const
     return m_status;
 }
 
+inline qreal MapLoader::progress() const
+{
+    return m_progress;
+}
+
 inline QString MapLoader::error() const
 {
     return m_error;
@@ -30,27 +30,78 @@
 #include "tilesnode.h"
 
 #include <QtMath>
+#include <QPolygonF>
 #include <QQuickWindow>
 
+#include <algorithm>
+
 using namespace Tiled;
 using namespace TiledQuick;
 
 namespace {
 
 /**
- * Returns the texture of a given tileset, or 0 if the image has not been
- * loaded yet.
+ * A cache of tileset textures for a single window. Each tileset image is
+ * uploaded once and the resulting texture is shared by all nodes rendered
+ * in that window, regardless of which map item they belong to.
+ *
+ * Textures are graphics resources owned by the scene graph of a specific
+ * window, so each window keeps its own cache and the textures are released
+ * together with the scene graph they were created for.
+ *
+ * The cache is keyed by image source rather than by tileset, so that
+ * tilesets referring to the same image share a single upload and entries
+ * can't go stale when a tileset instance is destroyed.
  */
-static inline QSGTexture *tilesetTexture(Tileset *tileset,
+class TilesetTextureCache : public QObject
+{
+public:
+    static QSGTexture *texture(const Tileset *tileset, QQuickWindow *window);
+
+private:
+    explicit TilesetTextureCache(QQuickWindow *window)
+        : QObject(window)
+    {
+        // Emitted on the render thread, where the textures need to be deleted
+        connect(window, &QQuickWindow::sceneGraphInvalidated,
+                this, &TilesetTextureCache::releaseTextures,
+                Qt::DirectConnection);
+    }
+
+    ~TilesetTextureCache() override
+    {
+        releaseTextures();
+    }
+
+    void releaseTextures()
+    {
+        qDeleteAll(mTextures);
+        mTextures.clear();
+    }
+
+    QHash<QUrl, QSGTexture *> mTextures;
+};
+
+/**
+ * Returns the texture for the image of the given tileset, or null if the
+ * image could not be loaded.
+ */
+QSGTexture *TilesetTextureCache::texture(const Tileset *tileset,
                                          QQuickWindow *window)
 {
-    static QHash<Tileset *, QSGTexture *> cache;
+    static QHash<QQuickWindow *, TilesetTextureCache *> caches;
 
-    QSGTexture *texture = cache.value(tileset);
+    TilesetTextureCache *&cache = caches[window];
+    if (!cache) {
+        cache = new TilesetTextureCache(window);
+        connect(window, &QObject::destroyed,
+                [window] { caches.remove(window); });
+    }
+
+    QSGTexture *&texture = cache->mTextures[tileset->imageSource()];
     if (!texture) {
         const QString imagePath(Tiled::urlToLocalFileOrQrc(tileset->imageSource()));
         texture = window->createTextureFromImage(QImage(imagePath));
-        cache.insert(tileset, texture);
     }
     return texture;
 }
@@ -78,7 +129,7 @@ struct TilesetHelper
     void setTileset(Tileset *tileset)
     {
         mTileset = tileset;
-        mTexture = tilesetTexture(tileset, mWindow);
+        mTexture = TilesetTextureCache::texture(tileset, mWindow);
         if (!mTexture)
             return;
 
@@ -134,36 +185,89 @@ void TileLayerItem::syncWithTileLayer()
     const QRectF boundingRect = mRenderer->boundingRect(mLayer->rect());
     setPosition(boundingRect.topLeft());
     setSize(boundingRect.size());
-}
 
+    mLayerChanged = true;
+    update();
+}
 
 
-QSGNode *TileLayerItem::updatePaintNode(QSGNode *node,
-                                        QQuickItem::UpdatePaintNodeData *)
+/**
+ * Builds the geometry for the given chunk of the tile layer. The tiles are
+ * sorted by tileset, so that each referenced tileset results in a single
+ * geometry node regardless of how the tiles are interleaved.
+ *
+ * Returns null when the chunk contains no renderable tiles.
+ */
+QSGNode *TileLayerItem::createChunkNode(QPoint chunkCoordinates)
 {
-    delete node;
-    node = new QSGNode;
-    node->setFlag(QSGNode::OwnedByParent);
+    const QRect chunkRect(chunkCoordinates.x() * CHUNK_SIZE,
+                          chunkCoordinates.y() * CHUNK_SIZE,
+                          CHUNK_SIZE, CHUNK_SIZE);
 
-    TilesetHelper helper(static_cast<MapItem*>(parentItem()));
+    struct TileEntry {
+        Cell cell;
+        TileData data;
+    };
 
-    QVector<TileData> tileData;
-    tileData.reserve(TilesNode::MaxTileCount);
+    QVector<TileEntry> entries;
+    entries.reserve(CHUNK_SIZE * CHUNK_SIZE);
 
-    /**
-     * Draws the tiles by adding nodes to the scene graph. When sequentially
-     * drawn tiles are using the same tileset, they will share a single
-     * geometry node.
-     */
     auto tileRenderFunction = [&](QPoint tilePos, const QPointF &screenPos) {
+        // Tiles outside of this chunk are picked up by their own chunk
+        if (!chunkRect.contains(tilePos))
+            return;
+
         const Cell &cell = mLayer->cellAt(tilePos);
         Tileset *tileset = cell.tileset();
         if (!tileset)
             return;
 
+        // todo: render "missing tile" marker
+//        if (!cell.tile()) {
+//            return;
+//        }
+
+        const auto offset = tileset->tileOffset();
+        const auto tile = tileset->findTile(cell.tileId());
+        const QSize size = (tile && !tile->image().isNull()) ? tile->size() : mRenderer->map()->tileSize();
+
+        TileEntry entry;
+        entry.cell = cell;
+        entry.data.x = static_cast<float>(screenPos.x()) + offset.x();
+        entry.data.y = static_cast<float>(screenPos.y() - size.height()) + offset.y();
+        entry.data.width = static_cast<float>(size.width());
+        entry.data.height = static_cast<float>(size.height());
+        entry.data.flippedHorizontally = cell.flippedHorizontally();
+        entry.data.flippedVertically = cell.flippedVertically();
+        entries.append(entry);
+    };
+
+    mRenderer->drawTileLayer(tileRenderFunction, mRenderer->boundingRect(chunkRect));
+
+    if (entries.isEmpty())
+        return nullptr;
+
+    // Sort by tileset to get one batch per tileset, keeping the draw order
+    // of tiles within each tileset stable.
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const TileEntry &a, const TileEntry &b) {
+        return a.cell.tileset() < b.cell.tileset();
+    });
+
+    QSGNode *chunkNode = new QSGNode;
+    chunkNode->setFlag(QSGNode::OwnedByParent);
+
+    TilesetHelper helper(static_cast<MapItem*>(parentItem()));
+
+    QVector<TileData> tileData;
+    tileData.reserve(entries.size());
+
+    for (const TileEntry &entry : std::as_const(entries)) {
+        Tileset *tileset = entry.cell.tileset();
+
         if (tileset != helper.tileset() || tileData.size() == TilesNode::MaxTileCount) {
             if (!tileData.isEmpty()) {
-                node->appendChildNode(new TilesNode(helper.texture(), tileData));
+                chunkNode->appendChildNode(new TilesNode(helper.texture(), tileData));
                 tileData.clear();
             }
 
@@ -171,32 +275,105 @@ QSGNode *TileLayerItem::updatePaintNode(QSGNode *node,
         }
 
         if (!helper.texture())
-            return;
+            continue;
 
-        // todo: render "missing tile" marker
-//        if (!cell.tile()) {
-//            return;
-//        }
+        TileData data = entry.data;
+        helper.setTextureCoordinates(data, entry.cell);
+        tileData.append(data);
+    }
 
-        const auto offset = tileset->tileOffset();
-        const auto tile = tileset->findTile(cell.tileId());
-        const QSize size = (tile && !tile->image().isNull()) ? tile->size() : mRenderer->map()->tileSize();
+    if (!tileData.isEmpty())
+        chunkNode->appendChildNode(new TilesNode(helper.texture(), tileData));
 
-        TileData data;
-        data.x = static_cast<float>(screenPos.x()) + offset.x();
-        data.y = static_cast<float>(screenPos.y() - size.height()) + offset.y();
-        data.width = static_cast<float>(size.width());
-        data.height = static_cast<float>(size.height());
-        data.flippedHorizontally = cell.flippedHorizontally();
-        data.flippedVertically = cell.flippedVertically();
-        helper.setTextureCoordinates(data, cell);
-        tileData.append(data);
-    };
+    if (!chunkNode->childCount()) {
+        delete chunkNode;
+        return nullptr;
+    }
 
-    mRenderer->drawTileLayer(tileRenderFunction, mVisibleArea);
+    return chunkNode;
+}
 
-    if (!tileData.isEmpty())
-        node->appendChildNode(new TilesNode(helper.texture(), tileData));
+/**
+ * Returns the range of chunks that can appear in the visible area, in chunk
+ * coordinates. The visible area was already extended by the draw margins of
+ * the layer.
+ */
+QRect TileLayerItem::visibleChunks() const
+{
+    QPolygonF visibleTiles;
+    visibleTiles.append(mRenderer->screenToTileCoords(mVisibleArea.topLeft()));
+    visibleTiles.append(mRenderer->screenToTileCoords(mVisibleArea.topRight()));
+    visibleTiles.append(mRenderer->screenToTileCoords(mVisibleArea.bottomRight()));
+    visibleTiles.append(mRenderer->screenToTileCoords(mVisibleArea.bottomLeft()));
+
+    const QRect tileRect = visibleTiles.boundingRect().toAlignedRect()
+            & mLayer->localBounds();
+
+    if (tileRect.isEmpty())
+        return QRect();
+
+    return QRect(QPoint(tileRect.left() >> CHUNK_BITS,
+                        tileRect.top() >> CHUNK_BITS),
+                 QPoint(tileRect.right() >> CHUNK_BITS,
+                        tileRect.bottom() >> CHUNK_BITS));
+}
+
+QSGNode *TileLayerItem::updatePaintNode(QSGNode *node,
+                                        QQuickItem::UpdatePaintNodeData *)
+{
+    if (!node) {
+        node = new QSGNode;
+        node->setFlag(QSGNode::OwnedByParent);
+        mChunkNodes.clear();
+        mLayerChanged = false;
+    }
+
+    if (mLayerChanged) {
+        // The layer contents changed, so all cached chunk geometry is stale
+        for (QSGNode *chunkNode : std::as_const(mChunkNodes))
+            delete chunkNode;
+        mChunkNodes.clear();
+        mLayerChanged = false;
+    }
+
+    const QRect chunks = visibleChunks();
+
+    // Keep the nodes of chunks that are still visible, creating geometry
+    // only for chunks that newly scrolled into view.
+    QHash<QPoint, QSGNode*> visibleChunkNodes;
+
+    if (!chunks.isEmpty()) {
+        for (int cy = chunks.top(); cy <= chunks.bottom(); ++cy) {
+            for (int cx = chunks.left(); cx <= chunks.right(); ++cx) {
+                const QPoint chunkCoordinates(cx, cy);
+
+                const auto it = mChunkNodes.find(chunkCoordinates);
+                if (it != mChunkNodes.end()) {
+                    visibleChunkNodes.insert(chunkCoordinates, it.value());
+                    mChunkNodes.erase(it);
+                    continue;
+                }
+
+                // Remember empty chunks with a null entry to avoid
+                // re-scanning them on every frame
+                QSGNode *chunkNode = nullptr;
+                if (mLayer->findChunk(cx * CHUNK_SIZE, cy * CHUNK_SIZE))
+                    chunkNode = createChunkNode(chunkCoordinates);
+
+                if (chunkNode)
+                    node->appendChildNode(chunkNode);
+
+                visibleChunkNodes.insert(chunkCoordinates, chunkNode);
+            }
+        }
+    }
+
+    // Drop the geometry of chunks that scrolled out of view. Deleting a
+    // node also removes it from its parent.
+    for (QSGNode *chunkNode : std::as_const(mChunkNodes))
+        delete chunkNode;
+
+    mChunkNodes.swap(visibleChunkNodes);
 
     return node;
 }
@@ -220,7 +397,15 @@ void TileLayerItem::updateVisibleTiles()
 
     if (mVisibleArea != rect) {
         mVisibleArea = rect;
-        update();
+
+        // The chunk nodes only need updating when the set of visible chunks
+        // changes. During a pan this happens when a chunk boundary is
+        // crossed, while the frames in between reuse the scene graph as-is.
+        const QRect chunks = visibleChunks();
+        if (mVisibleChunks != chunks) {
+            mVisibleChunks = chunks;
+            update();
+        }
     }
 }
 
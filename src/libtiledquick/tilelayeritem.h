@@ -67,10 +67,18 @@ public slots:
 
 private:
     void layerVisibilityChanged();
+    QRect visibleChunks() const;
+    QSGNode *createChunkNode(QPoint chunkCoordinates);
 
     Tiled::TileLayer *mLayer;
     Tiled::MapRenderer *mRenderer;
     QRectF mVisibleArea;
+    QRect mVisibleChunks;
+
+    // Cached geometry per chunk, owned by the scene graph. Entries may be
+    // null for chunks without any tiles. Only accessed from updatePaintNode.
+    QHash<QPoint, QSGNode*> mChunkNodes;
+    bool mLayerChanged = true;
 };
 
 /**
@@ -44,6 +44,68 @@ CsvPlugin::CsvPlugin()
 {
 }
 
+namespace {
+
+/**
+ * Accumulates the tile IDs of a layer in a fixed-size buffer, which is
+ * flushed to the target device whenever it runs full. This keeps the export
+ * free of per-cell allocations.
+ */
+class CsvWriter
+{
+public:
+    explicit CsvWriter(QIODevice *device)
+        : mDevice(device)
+    {
+        mBuffer.reserve(BufferSize + MaxChunk);
+    }
+
+    void writeNumber(int value)
+    {
+        char digits[12];
+        char *begin = digits + sizeof(digits);
+        unsigned v = value < 0 ? unsigned(-qint64(value)) : unsigned(value);
+
+        do {
+            *--begin = char('0' + v % 10);
+            v /= 10;
+        } while (v);
+
+        if (value < 0)
+            *--begin = '-';
+
+        write(begin, digits + sizeof(digits) - begin);
+    }
+
+    void write(const char *data, qsizetype length)
+    {
+        mBuffer.append(data, length);
+        if (mBuffer.size() >= BufferSize)
+            flush();
+    }
+
+    void write(const QByteArray &data)
+    {
+        write(data.constData(), data.size());
+    }
+
+    void flush()
+    {
+        mDevice->write(mBuffer);
+        mBuffer.clear();
+    }
+
+private:
+    // Writes of up to MaxChunk bytes never flush mid-value
+    static constexpr int BufferSize = 64 * 1024;
+    static constexpr int MaxChunk = 256;
+
+    QIODevice * const mDevice;
+    QByteArray mBuffer;
+};
+
+} // anonymous namespace
+
 bool CsvPlugin::write(const Map *map, const QString &fileName, Options options)
 {
     Q_UNUSED(options)
@@ -65,7 +127,7 @@ bool CsvPlugin::write(const Map *map, const QString &fileName, Options options)
             return false;
         }
 
-        auto device = file.device();
+        CsvWriter writer(file.device());
 
         QRect bounds = map->infinite() ? tileLayer->region().boundingRect() : tileLayer->rect();
         bounds.translate(-layer->position());
@@ -74,12 +136,12 @@ bool CsvPlugin::write(const Map *map, const QString &fileName, Options options)
         for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
             for (int x = bounds.left(); x <= bounds.right(); ++x) {
                 if (x > bounds.left())
-                    device->write(",", 1);
+                    writer.write(",", 1);
 
                 const Cell &cell = tileLayer->cellAt(x, y);
                 const Tile *tile = cell.tile();
                 if (tile && tile->hasProperty(QLatin1String("name"))) {
-                    device->write(tile->property(QLatin1String("name")).toString().toUtf8());
+                    writer.write(tile->property(QLatin1String("name")).toString().toUtf8());
                 } else {
                     int id = -1;
 
@@ -96,13 +158,15 @@ bool CsvPlugin::write(const Map *map, const QString &fileName, Options options)
                             id |= RotatedHexagonal120Flag;
                     }
 
-                    device->write(QByteArray::number(id));
+                    writer.writeNumber(id);
                 }
             }
 
-            device->write("\n", 1);
+            writer.write("\n", 1);
         }
 
+        writer.flush();
+
         if (file.error() != QFileDevice::NoError) {
             mError = file.errorString();
             return false;
@@ -36,54 +36,33 @@
 
 namespace Defold {
 
-static const char cell_t[] =
-"  cell {\n\
-    x: {{x}}\n\
-    y: {{y}}\n\
-    tile: {{tile}}\n\
-    h_flip: {{h_flip}}\n\
-    v_flip: {{v_flip}}\n\
-    rotate90: {{rotate90}}\n\
-  }\n";
-
-static const char layer_t[] =
-"layers {\n\
-  id: \"{{id}}\"\n\
-  z: {{z}}\n\
-  is_visible: {{is_visible}}\n\
-{{cells}}\
-}\n";
-
-static const char map_t[] =
-"tile_set: \"{{tile_set}}\"\n\
-{{layers}}\n\
-material: \"{{material}}\"\n\
-blend_mode: {{blend_mode}}\n";
-
-static QString replaceTags(QString context, const QVariantHash &map)
+// The .tilemap format has no run or loop construct, so every cell has to be
+// written out individually. Streaming them directly to the file avoids
+// building the whole output in memory.
+static void writeCell(QTextStream &stream, const Tiled::Cell &cell, int x, int y)
 {
-    QHashIterator<QString,QVariant> it{map};
-    while (it.hasNext()) {
-        it.next();
-        context.replace(QLatin1String("{{") + it.key() + QLatin1String("}}"),
-                        it.value().toString());
-    }
-    return context;
-}
-
-static void setCellProperties(QVariantHash &cellHash, const Tiled::Cell &cell)
-{
-    cellHash["tile"] = cell.tileId();
+    int hFlip;
+    int vFlip;
+    int rotate90;
 
     if (cell.flippedAntiDiagonally()) {
-        cellHash["h_flip"] = cell.flippedVertically() ? 1 : 0;
-        cellHash["v_flip"] = cell.flippedHorizontally() ? 0 : 1;
-        cellHash["rotate90"] = 1;
+        hFlip = cell.flippedVertically() ? 1 : 0;
+        vFlip = cell.flippedHorizontally() ? 0 : 1;
+        rotate90 = 1;
     } else {
-        cellHash["h_flip"] = cell.flippedHorizontally() ? 1 : 0;
-        cellHash["v_flip"] = cell.flippedVertically() ? 1 : 0;
-        cellHash["rotate90"] = 0;
+        hFlip = cell.flippedHorizontally() ? 1 : 0;
+        vFlip = cell.flippedVertically() ? 1 : 0;
+        rotate90 = 0;
     }
+
+    stream << "  cell {\n"
+              "    x: " << x << "\n"
+              "    y: " << y << "\n"
+              "    tile: " << cell.tileId() << "\n"
+              "    h_flip: " << hFlip << "\n"
+              "    v_flip: " << vFlip << "\n"
+              "    rotate90: " << rotate90 << "\n"
+              "  }\n";
 }
 
 template <typename T>
@@ -116,9 +95,15 @@ bool DefoldPlugin::write(const Tiled::Map *map, const QString &fileName, Options
 {
     Q_UNUSED(options)
 
-    QVariantHash map_h;
+    Tiled::SaveFile mapFile(fileName);
+    if (!mapFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+        return false;
+    }
+    QTextStream stream(mapFile.device());
+
+    stream << "tile_set: \"" << map->property(QStringLiteral("tile_set")).toString() << "\"\n";
 
-    QString layers;
     Tiled::LayerIterator it(map, Tiled::Layer::TileLayerType);
     double z = 0.0;
 
@@ -127,40 +112,26 @@ bool DefoldPlugin::write(const Tiled::Map *map, const QString &fileName, Options
         // automatic increments should allow up to 10000 layers.
         z = optionalProperty(tileLayer, QStringLiteral("z"), z + 0.0001);
 
-        QVariantHash layer_h;
-        layer_h["id"] = tileLayer->name();
-        layer_h["z"] = z;
-        layer_h["is_visible"] = tileLayer->isVisible() ? 1 : 0;
-        QString cells;
+        stream << "layers {\n"
+                  "  id: \"" << tileLayer->name() << "\"\n"
+                  "  z: " << z << "\n"
+                  "  is_visible: " << (tileLayer->isVisible() ? 1 : 0) << "\n";
 
         for (int x = 0; x < tileLayer->width(); ++x) {
             for (int y = 0; y < tileLayer->height(); ++y) {
                 const Tiled::Cell &cell = tileLayer->cellAt(x, y);
                 if (cell.isEmpty())
                     continue;
-                QVariantHash cell_h;
-                cell_h["x"] = x;
-                cell_h["y"] = tileLayer->height() - y - 1;
-                setCellProperties(cell_h, cell);
-                cells.append(replaceTags(QLatin1String(cell_t), cell_h));
+                writeCell(stream, cell, x, tileLayer->height() - y - 1);
             }
         }
-        layer_h["cells"] = cells;
-        layers.append(replaceTags(QLatin1String(layer_t), layer_h));
-    }
-    map_h["layers"] = layers;
-    map_h["material"] = "/builtins/materials/tile_map.material";
-    map_h["blend_mode"] = "BLEND_MODE_ALPHA";
-    map_h["tile_set"] = map->property(QStringLiteral("tile_set")).toString();
 
-    QString result = replaceTags(QLatin1String(map_t), map_h);
-    Tiled::SaveFile mapFile(fileName);
-    if (!mapFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
-        return false;
+        stream << "}\n";
     }
-    QTextStream stream(mapFile.device());
-    stream << result;
+
+    stream << "\n"
+              "material: \"/builtins/materials/tile_map.material\"\n"
+              "blend_mode: BLEND_MODE_ALPHA\n";
 
     if (mapFile.error() != QFileDevice::NoError) {
         mError = mapFile.errorString();
@@ -36,32 +36,6 @@
 
 namespace DefoldCollection {
 
-static const char cellTemplate[] =
-R"(  cell {
-    x: {{x}}
-    y: {{y}}
-    tile: {{tile}}
-    h_flip: {{h_flip}}
-    v_flip: {{v_flip}}
-    rotate90: {{rotate90}}
-  }
-)";
-
-static const char layerTemplate[] =
-R"(layers {
-  id: "{{id}}"
-  z: {{z}}
-  is_visible: {{is_visible}}
-{{cells}}}
-)";
-
-static const char tileMapTemplate[] =
-R"(tile_set: "{{tile_set}}"
-{{layers}}
-material: "{{material}}"
-blend_mode: {{blend_mode}}
-)";
-
 static const char collectionTemplate[] =
 R"(name: "default"
 scale_along_z: 0
@@ -218,19 +192,48 @@ static float zIndexForLayer(const Tiled::Map &map, const Tiled::Layer &inLayer,
     return 0;
 }
 
-static void setCellProperties(QVariantHash &cellHash, const Tiled::Cell &cell)
+// The .tilemap format has no run or loop construct, so every cell has to be
+// written out individually. Streaming them directly to the file avoids
+// building the whole output in memory.
+static void writeCell(QTextStream &stream, const Tiled::Cell &cell, int x, int y)
 {
-    cellHash["tile"] = cell.tileId();
+    int hFlip;
+    int vFlip;
+    int rotate90;
 
     if (cell.flippedAntiDiagonally()) {
-        cellHash["h_flip"] = cell.flippedVertically() ? 1 : 0;
-        cellHash["v_flip"] = cell.flippedHorizontally() ? 0 : 1;
-        cellHash["rotate90"] = 1;
+        hFlip = cell.flippedVertically() ? 1 : 0;
+        vFlip = cell.flippedHorizontally() ? 0 : 1;
+        rotate90 = 1;
     } else {
-        cellHash["h_flip"] = cell.flippedHorizontally() ? 1 : 0;
-        cellHash["v_flip"] = cell.flippedVertically() ? 1 : 0;
-        cellHash["rotate90"] = 0;
+        hFlip = cell.flippedHorizontally() ? 1 : 0;
+        vFlip = cell.flippedVertically() ? 1 : 0;
+        rotate90 = 0;
     }
+
+    stream << "  cell {\n"
+              "    x: " << x << "\n"
+              "    y: " << y << "\n"
+              "    tile: " << cell.tileId() << "\n"
+              "    h_flip: " << hFlip << "\n"
+              "    v_flip: " << vFlip << "\n"
+              "    rotate90: " << rotate90 << "\n"
+              "  }\n";
+}
+
+static void writeLayerHeader(QTextStream &stream, const QString &id, float z, bool visible)
+{
+    stream << "layers {\n"
+              "  id: \"" << id << "\"\n"
+              "  z: " << z << "\n"
+              "  is_visible: " << (visible ? 1 : 0) << "\n";
+}
+
+static void writeTileMapFooter(QTextStream &stream)
+{
+    stream << "\n"
+              "material: \"/builtins/materials/tile_map.material\"\n"
+              "blend_mode: BLEND_MODE_ALPHA\n";
 }
 
 /*
@@ -268,22 +271,19 @@ bool DefoldCollectionPlugin::write(const Tiled::Map *map, const QString &collect
         componentHash["tilemap_name"] = mapName + "-" + tileset->name();
         componentHash["tilemap_rel_path"] = tilesetRelativePath(tilemapFilePath);
 
-        QVariantHash tileMapHash;
-
-        bool tilemapHasCells = false;
+        // The file is opened lazily when the first cell using this tileset is
+        // found, so that tilemaps without cells produce no file. Cells are
+        // streamed directly instead of accumulated in memory.
+        Tiled::SaveFile mapFile(tilemapFilePath);
+        QTextStream stream;
 
         int componentCells = 0;
-        QString layers;
         for (auto layer : map->layers()) {
             if (layer->layerType() != Tiled::Layer::TileLayerType)
                 continue;
             auto tileLayer = static_cast<Tiled::TileLayer*>(layer);
 
-            QVariantHash layerHash;
-            layerHash["id"] = tileLayer->name();
-            layerHash["z"] = zIndexForLayer(*map, *tileLayer, true);
-            layerHash["is_visible"] = tileLayer->isVisible() ? 1 : 0;
-            QString cells;
+            bool layerStarted = false;
 
             for (int x = 0; x < tileLayer->width(); ++x) {
                 for (int y = 0; y < tileLayer->height(); ++y) {
@@ -293,42 +293,40 @@ bool DefoldCollectionPlugin::write(const Tiled::Map *map, const QString &collect
                     if (cell.tileset() != tileset) // skip cell if it doesn't belong to current tileset
                         continue;
 
-                    tilemapHasCells = true;
                     componentCells++;
-                    QVariantHash cellHash;
-                    cellHash["x"] = x;
-                    cellHash["y"] = tileLayer->height() - y - 1;
-                    setCellProperties(cellHash, cell);
-                    cells.append(replaceTags(QLatin1String(cellTemplate), cellHash));
 
                     // Create a component for this embedded instance only when the first cell of this component is found.
                     // If 0 cells are found, this component is not necessary.
                     // If more than 1 cells are found, recreating it would be redundant.
-                    if (componentCells == 1)
+                    if (componentCells == 1) {
                         topLevelComponents.append(replaceTags(QLatin1String(componentTemplate), componentHash));
+
+                        if (!mapFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+                            mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+                            return false;
+                        }
+                        stream.setDevice(mapFile.device());
+                        stream << "tile_set: \"" << tileSource(*tileset) << "\"\n";
+                    }
+
+                    // only add this layer to the .tilemap if it has any cells
+                    if (!layerStarted) {
+                        writeLayerHeader(stream, tileLayer->name(),
+                                         zIndexForLayer(*map, *tileLayer, true),
+                                         tileLayer->isVisible());
+                        layerStarted = true;
+                    }
+
+                    writeCell(stream, cell, x, tileLayer->height() - y - 1);
                 }
             }
-            layerHash["cells"] = cells;
 
-            // only add this layer to the .tilemap if it has any cells
-            if (!cells.isEmpty())
-                layers.append(replaceTags(QLatin1String(layerTemplate), layerHash));
+            if (layerStarted)
+                stream << "}\n";
         }
         // make a check that this tilemap has cells at all, or no .tilesource file is necessary
-        if (tilemapHasCells) {
-            tileMapHash["layers"] = layers;
-            tileMapHash["material"] = "/builtins/materials/tile_map.material";
-            tileMapHash["blend_mode"] = "BLEND_MODE_ALPHA";
-            tileMapHash["tile_set"] = tileSource(*tileset);
-
-            QString result = replaceTags(QLatin1String(tileMapTemplate), tileMapHash);
-            Tiled::SaveFile mapFile(tilemapFilePath);
-            if (!mapFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
-                return false;
-            }
-            QTextStream stream(mapFile.device());
-            stream << result;
+        if (componentCells > 0) {
+            writeTileMapFooter(stream);
 
             if (mapFile.error() != QFileDevice::NoError) {
                 mError = mapFile.errorString();
@@ -366,8 +364,10 @@ bool DefoldCollectionPlugin::write(const Tiled::Map *map, const QString &collect
             QString tilemapFilePath = tilesetFileDir;
             tilemapFilePath.append(mapName + "-" + layer->name() + "-" + tileset->name() + ".tilemap");
 
-            QVariantHash tileMapHash;
-            QString layers;
+            // As above, the file is opened lazily when the first cell using
+            // this tileset is found and cells are streamed directly.
+            Tiled::SaveFile mapFile(tilemapFilePath);
+            QTextStream stream;
 
             int componentCells = 0;
             for (auto subLayer : groupLayer->layers()) {
@@ -375,12 +375,7 @@ bool DefoldCollectionPlugin::write(const Tiled::Map *map, const QString &collect
                 if (!tileLayer)
                     continue;
 
-                QVariantHash layerHash;
-                layerHash["id"] = tileLayer->name();
-                layerHash["z"] = zIndexForLayer(*map, *subLayer, false);
-
-                layerHash["is_visible"] = layer->isVisible() ? 1 : 0;
-                QString cells;
+                bool layerStarted = false;
 
                 for (int x = 0; x < tileLayer->width(); ++x) {
                     for (int y = 0; y < tileLayer->height(); ++y) {
@@ -388,11 +383,6 @@ bool DefoldCollectionPlugin::write(const Tiled::Map *map, const QString &collect
                         if (cell.isEmpty() || cell.tileset() != tileset) // skip cell if it doesn't belong to current tileset
                             continue;
 
-                        QVariantHash cellHash;
-                        cellHash["x"] = x;
-                        cellHash["y"] = tileLayer->height() - y - 1;
-                        setCellProperties(cellHash, cell);
-                        cells.append(replaceTags(QLatin1String(cellTemplate), cellHash));
                         componentCells++;
 
                         // Create a component for this embedded instance only when the first cell of this component is found.
@@ -403,34 +393,35 @@ bool DefoldCollectionPlugin::write(const Tiled::Map *map, const QString &collect
                             componentHash["tilemap_name"] = mapName + "-" + layer->name() + "-" + tileset->name();
                             componentHash["tilemap_rel_path"] = tilesetRelativePath(tilemapFilePath);
                             components.append(replaceTags(QLatin1String(componentTemplate), componentHash));
+
+                            if (!mapFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+                                mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+                                return false;
+                            }
+                            stream.setDevice(mapFile.device());
+                            stream << "tile_set: \"" << tileSource(*tileset) << "\"\n";
                         }
+
+                        if (!layerStarted) {
+                            writeLayerHeader(stream, tileLayer->name(),
+                                             zIndexForLayer(*map, *subLayer, false),
+                                             layer->isVisible());
+                            layerStarted = true;
+                        }
+
+                        writeCell(stream, cell, x, tileLayer->height() - y - 1);
                     }
                 }
 
-                if (!cells.isEmpty()) {
-                    layerHash["cells"] = cells;
-                    layers.append(replaceTags(QLatin1String(layerTemplate), layerHash));
-                }
+                if (layerStarted)
+                    stream << "}\n";
             }
 
             // no need to save a tilemap with 0 cells
-            if (layers.isEmpty())
+            if (componentCells == 0)
                 continue;
 
-            tileMapHash["layers"] = layers;
-            tileMapHash["material"] = "/builtins/materials/tile_map.material";
-            tileMapHash["blend_mode"] = "BLEND_MODE_ALPHA";
-            tileMapHash["tile_set"] = tileSource(*tileset);
-
-            QString result = replaceTags(QLatin1String(tileMapTemplate), tileMapHash);
-            Tiled::SaveFile mapFile(tilemapFilePath);
-            if (!mapFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
-                return false;
-            }
-
-            QTextStream stream(mapFile.device());
-            stream << result;
+            writeTileMapFooter(stream);
 
             if (mapFile.error() != QFileDevice::NoError) {
                 mError = mapFile.errorString();
@@ -22,11 +22,13 @@
 
 #include "map.h"
 #include "savefile.h"
+#include "streamedtilereader.h"
 #include "tile.h"
 #include "tileset.h"
 #include "tilelayer.h"
 #include "compression.h"
 
+#include <QBuffer>
 #include <QCoreApplication>
 #include <QFile>
 
@@ -74,16 +76,14 @@ std::unique_ptr<Tiled::Map> DroidcraftPlugin::read(const QString &fileName)
     // Fill layer
     auto mapLayer = std::make_unique<TileLayer>("map", 0, 0, 48, 48);
 
-    // Load
-    for (int i = 0; i < 48 * 48; i++) {
-        unsigned char tileId = uncompressed.at(i);
+    // Load, streaming the tile data into the layer
+    QBuffer uncompressedBuffer(&uncompressed);
+    uncompressedBuffer.open(QIODevice::ReadOnly);
 
-        int y = i / 48;
-        int x = i - (48 * y);
-
-        Tile *tile = mapTileset->findTile(tileId);
-        mapLayer->setCell(x, y, Cell(tile));
-    }
+    StreamedTileReader tileReader(uncompressedBuffer);
+    tileReader.readLayer(*mapLayer, QRect(0, 0, 48, 48), [&] (quint8 tileId) {
+        return Cell(mapTileset->findTile(tileId));
+    });
 
     map->addLayer(std::move(mapLayer));
 
@@ -99,6 +99,7 @@ bool JsonMapFormat::write(const Tiled::Map *map,
     }
 
     Tiled::MapToVariantConverter converter;
+    converter.setTypedTileData(true);   // understood by the JsonWriter
     QVariant variant = converter.toVariant(*map, QFileInfo(fileName).dir());
 
     JsonWriter writer;
@@ -145,6 +146,11 @@ bool JsonMapFormat::write(const Tiled::Map *map,
     return true;
 }
 
+Tiled::FileFormat::Capabilities JsonMapFormat::capabilities() const
+{
+    return ReadWrite | PreservesExportTarget;
+}
+
 QString JsonMapFormat::nameFilter() const
 {
     if (mSubFormat == Json)
@@ -300,6 +306,11 @@ bool JsonTilesetFormat::write(const Tiled::Tileset &tileset,
     return true;
 }
 
+Tiled::FileFormat::Capabilities JsonTilesetFormat::capabilities() const
+{
+    return ReadWrite | PreservesExportTarget;
+}
+
 QString JsonTilesetFormat::nameFilter() const
 {
     return tr("JSON tileset files (*.tsj *.json)");
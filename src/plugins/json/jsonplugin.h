@@ -65,6 +65,8 @@ public:
 
     bool write(const Tiled::Map *map, const QString &fileName, Options options) override;
 
+    Capabilities capabilities() const override;
+
     QString nameFilter() const override;
     QString shortName() const override;
     QString errorString() const override;
@@ -88,6 +90,8 @@ public:
 
     bool write(const Tiled::Tileset &tileset, const QString &fileName, Options options) override;
 
+    Capabilities capabilities() const override;
+
     QString nameFilter() const override;
     QString shortName() const override;
     QString errorString() const override;
@@ -99,6 +99,7 @@ bool JsonMapFormat::write(const Tiled::Map *map,
     }
 
     Tiled::MapToVariantConverter converter{1};
+    converter.setTypedTileData(true);   // understood by the JsonWriter
     QVariant variant = converter.toVariant(*map, QFileInfo(fileName).dir());
 
     JsonWriter writer;
@@ -10,6 +10,7 @@
 #include "json.h"
 
 #include <QDebug>
+#include <QVector>
 #include <qnumeric.h>
 
 /*!
@@ -172,6 +173,28 @@ void JsonWriter::stringify(const QVariant &variant, int depth)
             stringify(list[i], depth+1);
         }
         m_result += QLatin1Char(']');
+    } else if (variant.userType() == qMetaTypeId<QVector<unsigned>>()) {
+        // Large numeric arrays (tile layer data) are passed as a typed
+        // vector instead of boxing every element in a QVariant; formatted
+        // exactly like a regular list
+        const QString indent = m_autoFormattingIndent.repeated(depth);
+        const auto values = variant.value<QVector<unsigned>>();
+        m_result += QLatin1Char('[');
+        for (int i = 0; i < values.count(); i++) {
+            if (i != 0) {
+                m_result += QLatin1Char(',');
+                if (m_autoFormatting) {
+                    if (m_autoFormattingWrapArrayCount && i % m_autoFormattingWrapArrayCount == 0) {
+                        m_result += QLatin1Char('\n');
+                        m_result += indent;
+                    } else {
+                        m_result += QLatin1Char(' ');
+                    }
+                }
+            }
+            m_result += QString::number(values.at(i));
+        }
+        m_result += QLatin1Char(']');
     } else if (variant.type() == QVariant::Map) {
         const QString indent = m_autoFormattingIndent.repeated(depth);
         QVariantMap map = variant.toMap();
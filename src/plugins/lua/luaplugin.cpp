@@ -556,6 +556,7 @@ void LuaWriter::writeTileLayer(const TileLayer *tileLayer,
     switch (format) {
     case Map::XML:
     case Map::CSV:
+    case Map::DeltaVLQ:
         mWriter.writeKeyAndValue("encoding", "lua");
         break;
 
@@ -613,6 +614,7 @@ void LuaWriter::writeTileLayerData(const TileLayer *tileLayer,
     switch (format) {
     case Map::XML:
     case Map::CSV:
+    case Map::DeltaVLQ:
         mWriter.writeStartTable("data");
         for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
             if (y > bounds.top())
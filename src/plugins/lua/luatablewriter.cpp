@@ -24,9 +24,20 @@
 
 namespace Lua {
 
+// The many small tokens are collected in a buffer, which is written out in
+// blocks of this size. Writing them to the device directly is very slow when
+// it is backed by a file.
+static constexpr int BlockSize = 64 * 1024;
+
 LuaTableWriter::LuaTableWriter(QIODevice *device)
     : m_device(device)
 {
+    m_buffer.reserve(BlockSize);
+}
+
+LuaTableWriter::~LuaTableWriter()
+{
+    flush();
 }
 
 void LuaTableWriter::writeStartDocument()
@@ -38,6 +49,7 @@ void LuaTableWriter::writeEndDocument()
 {
     Q_ASSERT(m_indent == 0);
     write('\n');
+    flush();
 }
 
 void LuaTableWriter::writeStartTable()
@@ -240,10 +252,20 @@ void LuaTableWriter::writeNewline()
     }
 }
 
-void LuaTableWriter::write(const char *bytes, qint64 length)
+void LuaTableWriter::flush()
 {
-    if (m_device->write(bytes, length) != length)
+    if (m_buffer.isEmpty())
+        return;
+    if (m_device->write(m_buffer) != m_buffer.size())
         m_error = true;
+    m_buffer.resize(0);
+}
+
+void LuaTableWriter::write(const char *bytes, qint64 length)
+{
+    m_buffer.append(bytes, length);
+    if (m_buffer.size() >= BlockSize)
+        flush();
 }
 
 } // namespace Lua
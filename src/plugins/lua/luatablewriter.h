@@ -35,6 +35,7 @@ class LuaTableWriter
 {
 public:
     LuaTableWriter(QIODevice *device);
+    ~LuaTableWriter();
 
     void writeStartDocument();
     void writeEndDocument();
@@ -82,12 +83,14 @@ private:
     void writeIndent();
 
     void writeNewline();
+    void flush();
     void write(const char *bytes, qint64 length);
     void write(const char *bytes);
     void write(const QByteArray &bytes);
     void write(char c);
 
     QIODevice *m_device;
+    QByteArray m_buffer;
     int m_indent { 0 };
     char m_valueSeparator { ',' };
     bool m_suppressNewlines { false };
@@ -23,6 +23,7 @@
 
 #include "map.h"
 #include "savefile.h"
+#include "streamedtilereader.h"
 #include "tile.h"
 #include "tileset.h"
 #include "tilelayer.h"
@@ -82,6 +83,12 @@ std::unique_ptr<Tiled::Map> ReplicaIslandPlugin::read(const QString &fileName)
     QVector<SharedTileset> typeTilesets, tileIndexTilesets;
     loadTilesetsFromResources(map.get(), typeTilesets, tileIndexTilesets);
 
+    // Tile data is streamed through a fixed-size buffer, so layers are read
+    // in O(buffer) memory no matter how large they are. The reader consumes
+    // exactly the tile data of each layer, so it can share the file with the
+    // QDataStream used for the headers.
+    StreamedTileReader tileReader(file);
+
     // Load each of our layers.
     for (quint8 i = 0; i < layerCount; i++) {
         // Parse layer header.
@@ -117,25 +124,15 @@ std::unique_ptr<Tiled::Map> ReplicaIslandPlugin::read(const QString &fileName)
         SharedTileset tileset =
             tilesetForLayer(type, tileIndex, typeTilesets, tileIndexTilesets);
 
-        // Read our tile data all at once.
-        QByteArray tileData(width*height, '\0');
-        int bytesRead = in.readRawData(tileData.data(), tileData.size());
-        if (bytesRead != tileData.size()) {
+        // Stream our tile data into the layer.
+        const bool ok = tileReader.readLayer(*layer, QRect(0, 0, width, height),
+                                             [&] (quint8 tileId) {
+            return tileId != 255 ? Cell(tileset->findTile(tileId)) : Cell();
+        });
+        if (!ok) {
             mError = tr("File ended in middle of layer!");
             return nullptr;
         }
-        quint8 *tp = reinterpret_cast<quint8 *>(tileData.data());
-
-        // Add the tiles to our layer.
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                quint8 tile_id = *tp++;
-                if (tile_id != 255) {
-                    Tile *tile = tileset->findTile(tile_id);
-                    layer->setCell(x, y, Cell(tile));
-                }
-            }
-        }
     }
 
     // Make sure we read the entire *.bin file.
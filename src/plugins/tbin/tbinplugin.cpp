@@ -202,7 +202,7 @@ std::unique_ptr<Tiled::Map> TbinMapFormat::read(const QString &fileName)
 
             map->addTileset(tileset);
         }
-        for (const tbin::Layer& tlayer : tmap.layers) {
+        for (tbin::Layer& tlayer : tmap.layers) {
             if (tlayer.tileSize.x != firstLayer.tileSize.x || tlayer.tileSize.y != firstLayer.tileSize.y)
                 throw std::invalid_argument(QT_TR_NOOP("Different tile sizes per layer are not supported."));
 
@@ -219,7 +219,7 @@ std::unique_ptr<Tiled::Map> TbinMapFormat::read(const QString &fileName)
 
                 Tiled::Cell cell;
                 if (ttile.animatedData.frames.size() > 0) {
-                    tbin::Tile tfirstTile = ttile.animatedData.frames[0];
+                    const tbin::Tile &tfirstTile = ttile.animatedData.frames[0];
                     Tiled::Tile* firstTile = map->tilesetAt(tmapTilesheetMapping[tfirstTile.tilesheet])->findOrCreateTile(tfirstTile.staticData.tileIndex);
                     QVector<Tiled::Frame> frames;
                     for (const tbin::Tile& tframe : ttile.animatedData.frames) {
@@ -250,6 +250,10 @@ std::unique_ptr<Tiled::Map> TbinMapFormat::read(const QString &fileName)
             }
             map->addLayer(std::move(layer));
             map->addLayer(std::move(objects));
+
+            // Release the tile data of this layer early, which reduces the
+            // peak memory usage for maps with many layers.
+            std::vector<tbin::Tile>().swap(tlayer.tiles);
         }
     }
     catch (std::exception& e) {
@@ -305,6 +309,18 @@ bool TbinMapFormat::write(const Tiled::Map *map, const QString &fileName, Option
         std::vector< Tiled::ObjectGroup* > objGroups;
         std::map< std::string, tbin::Layer* > tileLayerIdMap;
         tmap.layers.reserve(static_cast<std::size_t>(map->layers().size()));
+
+        // Tileset names and animated tiles are converted once and then
+        // reused, since the same conversion would otherwise be repeated for
+        // every cell referencing them.
+        std::map< const Tiled::Tileset*, std::string > tilesheetNames;
+        auto tilesheetName = [&] (const Tiled::Tileset *tileset) -> const std::string & {
+            auto it = tilesheetNames.find(tileset);
+            if (it == tilesheetNames.end())
+                it = tilesheetNames.emplace(tileset, tileset->name().toStdString()).first;
+            return it->second;
+        };
+        std::map< const Tiled::Tile*, tbin::Tile > animatedTiles;
         for (Tiled::Layer* rawLayer : map->layers()) {
             if (Tiled::ObjectGroup* layer = rawLayer->asObjectGroup()) {
                 objGroups.push_back(layer);
@@ -317,9 +333,10 @@ bool TbinMapFormat::write(const Tiled::Map *map, const QString &fileName, Option
                 tlayer.tileSize.x = map->tileWidth();
                 tlayer.tileSize.y = map->tileHeight();
                 //tlayer.visible = ???;
+                tlayer.tiles.reserve(static_cast<std::size_t>(tlayer.layerSize.x) * tlayer.layerSize.y);
                 for (int iy = 0; iy < tlayer.layerSize.y; ++iy) {
                     for (int ix = 0; ix < tlayer.layerSize.x; ++ix) {
-                        Tiled::Cell cell = layer->cellAt(ix, iy);
+                        const Tiled::Cell &cell = layer->cellAt(ix, iy);
                         tbin::Tile ttile;
                         ttile.staticData.tileIndex = -1;
 
@@ -329,29 +346,39 @@ bool TbinMapFormat::write(const Tiled::Map *map, const QString &fileName, Option
                         }
 
                         if (Tiled::Tile *tile = cell.tile()) {
-                            ttile.tilesheet = tile->tileset()->name().toStdString();
                             if (tile->frames().size() == 0) {
+                                ttile.tilesheet = tilesheetName(tile->tileset());
                                 ttile.staticData.tileIndex = tile->id();
                                 ttile.staticData.blendMode = 0;
                             }
                             else {
-                                ttile.animatedData.frameInterval = tile->frames().at(0).duration;
-
-                                for (Tiled::Frame frame : tile->frames()) {
-                                    if (frame.duration != ttile.animatedData.frameInterval) {
-                                        Tiled::ERROR("tBIN: Frames with different duration are not supported.",
-                                                     Tiled::SelectTile { tile });
+                                auto it = animatedTiles.find(tile);
+                                if (it == animatedTiles.end()) {
+                                    tbin::Tile tanim;
+                                    tanim.staticData.tileIndex = -1;
+                                    tanim.tilesheet = tilesheetName(tile->tileset());
+                                    tanim.animatedData.frameInterval = tile->frames().at(0).duration;
+                                    tanim.animatedData.frames.reserve(static_cast<std::size_t>(tile->frames().size()));
+
+                                    for (const Tiled::Frame &frame : tile->frames()) {
+                                        if (frame.duration != tanim.animatedData.frameInterval) {
+                                            Tiled::ERROR("tBIN: Frames with different duration are not supported.",
+                                                         Tiled::SelectTile { tile });
+                                        }
+
+                                        tbin::Tile tframe;
+                                        tframe.tilesheet = tanim.tilesheet;
+                                        tframe.staticData.tileIndex = frame.tileId;
+                                        tframe.staticData.blendMode = 0;
+                                        tanim.animatedData.frames.push_back(std::move(tframe));
                                     }
 
-                                    tbin::Tile tframe;
-                                    tframe.tilesheet = ttile.tilesheet;
-                                    tframe.staticData.tileIndex = frame.tileId;
-                                    tframe.staticData.blendMode = 0;
-                                    ttile.animatedData.frames.push_back(tframe);
+                                    it = animatedTiles.emplace(tile, std::move(tanim)).first;
                                 }
+                                ttile = it->second;
                             }
                         }
-                        tlayer.tiles.push_back(ttile);
+                        tlayer.tiles.push_back(std::move(ttile));
                     }
                 }
                 tiledToTbinProperties(layer->properties(), tlayer.props, fileDir);
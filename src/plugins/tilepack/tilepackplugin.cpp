@@ -0,0 +1,316 @@
+/*
+ * Tile Pack Tiled Plugin
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tilepackplugin.h"
+
+#include "gidmapper.h"
+#include "map.h"
+#include "mapobject.h"
+#include "objectgroup.h"
+#include "savefile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QCoreApplication>
+#include <QtEndian>
+
+using namespace Tiled;
+using namespace TilePack;
+
+namespace {
+
+constexpr quint32 FormatVersion = 1;
+constexpr int Alignment = 16;
+
+/**
+ * Builds the output file in memory. Multi-byte values are stored
+ * little-endian; section offsets in the header are patched in once their
+ * positions are known. Strings are interned into a separate section that is
+ * appended at the end, with offset 0 reserved for the empty string.
+ */
+class PackWriter
+{
+public:
+    PackWriter()
+    {
+        // The empty string record at offset 0
+        quint32 zero = 0;
+        mStrings.append(reinterpret_cast<const char*>(&zero), 4);
+        mStrings.append('\0');
+    }
+
+    quint32 pos() const { return quint32(mData.size()); }
+
+    void putU32(quint32 value)
+    {
+        char bytes[4];
+        qToLittleEndian(value, bytes);
+        mData.append(bytes, 4);
+    }
+
+    void putI32(qint32 value) { putU32(quint32(value)); }
+
+    void putF32(float value)
+    {
+        quint32 bits;
+        memcpy(&bits, &value, 4);
+        putU32(bits);
+    }
+
+    void putBytes(const char *data, qsizetype length) { mData.append(data, length); }
+
+    void patchU32(quint32 offset, quint32 value)
+    {
+        qToLittleEndian(value, mData.data() + offset);
+    }
+
+    void align()
+    {
+        while (mData.size() % Alignment)
+            mData.append('\0');
+    }
+
+    quint32 addString(const QString &string)
+    {
+        if (string.isEmpty())
+            return 0;
+
+        auto it = mStringOffsets.constFind(string);
+        if (it != mStringOffsets.constEnd())
+            return it.value();
+
+        const QByteArray utf8 = string.toUtf8();
+        const quint32 offset = quint32(mStrings.size());
+
+        char bytes[4];
+        qToLittleEndian(quint32(utf8.size()), bytes);
+        mStrings.append(bytes, 4);
+        mStrings.append(utf8);
+        mStrings.append('\0');
+
+        mStringOffsets.insert(string, offset);
+        return offset;
+    }
+
+    const QByteArray &strings() const { return mStrings; }
+    const QByteArray &data() const { return mData; }
+
+private:
+    QByteArray mData;
+    QByteArray mStrings;
+    QHash<QString, quint32> mStringOffsets;
+};
+
+} // anonymous namespace
+
+TilePackPlugin::TilePackPlugin()
+{
+}
+
+bool TilePackPlugin::write(const Map *map, const QString &fileName, Options options)
+{
+    Q_UNUSED(options)
+
+    // Assign GIDs the same way the TMX and JSON writers do
+    GidMapper gidMapper;
+    QVector<quint32> firstGids;
+    quint32 firstGid = 1;
+    for (const SharedTileset &tileset : map->tilesets()) {
+        gidMapper.insert(firstGid, tileset);
+        firstGids.append(firstGid);
+        firstGid += tileset->nextTileId();
+    }
+
+    QVector<const TileLayer*> tileLayers;
+    for (const Layer *layer : map->tileLayers())
+        tileLayers.append(static_cast<const TileLayer*>(layer));
+
+    QVector<const ObjectGroup*> objectGroups;
+    for (const Layer *layer : map->objectGroups())
+        objectGroups.append(static_cast<const ObjectGroup*>(layer));
+
+    PackWriter writer;
+
+    // Header
+    writer.putBytes("TPK1", 4);
+    writer.putU32(FormatVersion);
+    writer.putU32(quint32(map->orientation()));
+    writer.putI32(map->width());
+    writer.putI32(map->height());
+    writer.putI32(map->tileWidth());
+    writer.putI32(map->tileHeight());
+    writer.putU32(CHUNK_SIZE);
+    writer.putU32(quint32(map->tilesets().size()));
+    writer.putU32(quint32(tileLayers.size()));
+    writer.putU32(quint32(objectGroups.size()));
+
+    const quint32 tilesetsOffsetPos = writer.pos();
+    writer.putU32(0);
+    const quint32 tileLayersOffsetPos = writer.pos();
+    writer.putU32(0);
+    const quint32 objectGroupsOffsetPos = writer.pos();
+    writer.putU32(0);
+    const quint32 stringsOffsetPos = writer.pos();
+    writer.putU32(0);
+    writer.putU32(0);   // reserved, pads the header to 64 bytes
+
+    // Tileset palette
+    writer.align();
+    writer.patchU32(tilesetsOffsetPos, writer.pos());
+
+    for (int i = 0; i < map->tilesets().size(); ++i) {
+        const SharedTileset &tileset = map->tilesets().at(i);
+        const QString source = tileset->isExternal() ? tileset->fileName()
+                                                     : tileset->imageSource().toString();
+
+        writer.putU32(firstGids.at(i));
+        writer.putU32(quint32(tileset->tileCount()));
+        writer.putU32(quint32(tileset->columnCount()));
+        writer.putI32(tileset->tileWidth());
+        writer.putI32(tileset->tileHeight());
+        writer.putU32(writer.addString(tileset->name()));
+        writer.putU32(writer.addString(source));
+        writer.putU32(0);
+    }
+
+    // Tile layers as aligned chunk buffers
+    writer.align();
+    writer.patchU32(tileLayersOffsetPos, writer.pos());
+
+    const QSize chunkSize(CHUNK_SIZE, CHUNK_SIZE);
+
+    for (const TileLayer *tileLayer : tileLayers) {
+        QVector<QRect> chunks;
+        if (map->infinite()) {
+            chunks = tileLayer->sortedChunksToWrite(chunkSize);
+        } else {
+            for (int y = 0; y < tileLayer->height(); y += CHUNK_SIZE)
+                for (int x = 0; x < tileLayer->width(); x += CHUNK_SIZE)
+                    chunks.append(QRect(x, y, CHUNK_SIZE, CHUNK_SIZE));
+        }
+
+        writer.putU32(quint32(tileLayer->id()));
+        writer.putU32(writer.addString(tileLayer->name()));
+        writer.putU32(quint32(chunks.size()));
+        writer.putU32(0);
+
+        for (const QRect &chunk : std::as_const(chunks)) {
+            writer.putI32(chunk.x());
+            writer.putI32(chunk.y());
+            writer.putU32(0);
+            writer.putU32(0);
+
+            // Always a full chunk of GIDs, with cells outside the layer
+            // written as 0, so that every chunk buffer has the same size
+            for (int y = chunk.top(); y < chunk.top() + CHUNK_SIZE; ++y)
+                for (int x = chunk.left(); x < chunk.left() + CHUNK_SIZE; ++x)
+                    writer.putU32(gidMapper.cellToGid(tileLayer->cellAt(x, y)));
+        }
+    }
+
+    // Object groups as structure-of-arrays tables
+    writer.align();
+    writer.patchU32(objectGroupsOffsetPos, writer.pos());
+
+    for (const ObjectGroup *objectGroup : objectGroups) {
+        const auto &objects = objectGroup->objects();
+
+        writer.putU32(quint32(objectGroup->id()));
+        writer.putU32(writer.addString(objectGroup->name()));
+        writer.putU32(quint32(objects.size()));
+        writer.putU32(0);
+
+        for (const MapObject *object : objects)
+            writer.putU32(quint32(object->id()));
+        writer.align();
+
+        for (const MapObject *object : objects)
+            writer.putU32(gidMapper.cellToGid(object->cell()));
+        writer.align();
+
+        for (const MapObject *object : objects)
+            writer.putF32(float(object->x()));
+        writer.align();
+
+        for (const MapObject *object : objects)
+            writer.putF32(float(object->y()));
+        writer.align();
+
+        for (const MapObject *object : objects)
+            writer.putF32(float(object->width()));
+        writer.align();
+
+        for (const MapObject *object : objects)
+            writer.putF32(float(object->height()));
+        writer.align();
+
+        for (const MapObject *object : objects)
+            writer.putF32(float(object->rotation()));
+        writer.align();
+
+        for (const MapObject *object : objects)
+            writer.putU32(writer.addString(object->name()));
+        writer.align();
+
+        for (const MapObject *object : objects)
+            writer.putU32(writer.addString(object->effectiveClassName()));
+        writer.align();
+    }
+
+    // String section
+    writer.align();
+    writer.patchU32(stringsOffsetPos, writer.pos());
+    writer.putBytes(writer.strings().constData(), writer.strings().size());
+
+    SaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+        return false;
+    }
+
+    file.device()->write(writer.data());
+
+    if (file.error() != QFileDevice::NoError) {
+        mError = file.errorString();
+        return false;
+    }
+
+    if (!file.commit()) {
+        mError = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+QString TilePackPlugin::errorString() const
+{
+    return mError;
+}
+
+QString TilePackPlugin::nameFilter() const
+{
+    return tr("Packed chunk files (*.tpk)");
+}
+
+QString TilePackPlugin::shortName() const
+{
+    return QStringLiteral("tilepack");
+}
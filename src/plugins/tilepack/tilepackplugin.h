@@ -0,0 +1,120 @@
+/*
+ * Tile Pack Tiled Plugin
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "mapformat.h"
+
+#include "tilepack_global.h"
+
+namespace TilePack {
+
+/**
+ * Exports a map as a packed binary file (*.tpk) that game engines can load
+ * by reading fixed-size records, without a parsing step.
+ *
+ * The format is little-endian and versioned. All section and record starts
+ * are aligned to 16 bytes, so that GID arrays can be memcpy'd or mapped
+ * directly into aligned engine buffers. Offsets are from the start of the
+ * file; strings are referenced by offset into a single string section.
+ *
+ * Layout (version 1):
+ *
+ *   Header (64 bytes)
+ *     char   magic[4]           "TPK1"
+ *     u32    version            1
+ *     u32    orientation        Map::Orientation
+ *     i32    mapWidth           in tiles (bounding size for infinite maps)
+ *     i32    mapHeight
+ *     i32    tileWidth          in pixels
+ *     i32    tileHeight
+ *     u32    chunkSize          tiles per chunk edge
+ *     u32    tilesetCount
+ *     u32    tileLayerCount
+ *     u32    objectGroupCount
+ *     u32    tilesetsOffset
+ *     u32    tileLayersOffset
+ *     u32    objectGroupsOffset
+ *     u32    stringsOffset
+ *     u32    reserved
+ *
+ *   Tileset section: tilesetCount records (32 bytes each), the palette that
+ *   maps GID ranges back to tilesets:
+ *     u32    firstGid
+ *     u32    tileCount
+ *     u32    columns
+ *     i32    tileWidth
+ *     i32    tileHeight
+ *     u32    nameOffset
+ *     u32    imageOffset        image or tileset file name
+ *     u32    reserved
+ *
+ *   Tile layer section: tileLayerCount layers, each a 16-byte record
+ *   followed by its chunks:
+ *     u32    layerId
+ *     u32    nameOffset
+ *     u32    chunkCount
+ *     u32    reserved
+ *   Chunk (16-byte header + GID array):
+ *     i32    x                  position in tiles
+ *     i32    y
+ *     u32    reserved[2]
+ *     u32    gids[chunkSize * chunkSize]   row-major, 0 for empty cells,
+ *                                          flip flags in the top four bits
+ *
+ *   Object group section: objectGroupCount groups, each a 16-byte record
+ *   followed by structure-of-arrays object data, every array aligned:
+ *     u32    layerId
+ *     u32    nameOffset
+ *     u32    objectCount
+ *     u32    reserved
+ *   Arrays, objectCount elements each:
+ *     u32    ids[]
+ *     u32    gids[]             0 for non-tile objects
+ *     f32    x[], y[]           in pixels
+ *     f32    width[], height[]
+ *     f32    rotation[]         in degrees
+ *     u32    nameOffsets[]
+ *     u32    classOffsets[]
+ *
+ *   String section: referenced strings, each u32 length followed by that
+ *   many UTF-8 bytes and a terminating NUL. Offset 0 is the empty string.
+ */
+class TILEPACKSHARED_EXPORT TilePackPlugin : public Tiled::WritableMapFormat
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "org.mapeditor.MapFormat" FILE "plugin.json")
+
+public:
+    TilePackPlugin();
+
+    bool write(const Tiled::Map *map, const QString &fileName, Options options) override;
+    QString errorString() const override;
+
+    QString shortName() const override;
+
+protected:
+    QString nameFilter() const override;
+
+private:
+    QString mError;
+};
+
+} // namespace TilePack
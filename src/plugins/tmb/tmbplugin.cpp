@@ -0,0 +1,440 @@
+/*
+ * Tiled Binary Map Plugin
+ * Copyright 2026, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tmbplugin.h"
+
+#include "gidmapper.h"
+#include "map.h"
+#include "savefile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+#include "tilesetformat.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+
+using namespace Tiled;
+
+namespace Tmb {
+
+/*
+ * File layout (all fields little-endian 32-bit):
+ *
+ *   header           fixed 80 bytes, see field offsets below
+ *   tileset table    tilesetCount x { firstGid, sourceRef }
+ *   layer table      layerCount x { nameRef, chunkCount, chunkTableOffset,
+ *                                   reserved }
+ *   chunk tables     chunkCount x { x, y, dataOffset } per layer
+ *   chunk data       chunkWidth * chunkHeight GIDs per chunk, 4-byte aligned
+ *   string table     { length, utf8 bytes } records, referenced by offset
+ *
+ * Everything before the chunk data can be validated by reading a few pages,
+ * and each chunk is addressed by an absolute file offset, so a reader that
+ * memory-maps the file only faults in the chunks it actually touches.
+ */
+
+static const char magic[4] = { 'T', 'M', 'B', '1' };
+static const quint32 version = 1;
+static const quint32 headerSize = 80;
+
+static const quint32 tilesetEntrySize = 8;
+static const quint32 layerEntrySize = 16;
+static const quint32 chunkEntrySize = 12;
+
+namespace {
+
+class StringTable
+{
+public:
+    quint32 insert(const QString &string)
+    {
+        auto it = mOffsets.constFind(string);
+        if (it != mOffsets.constEnd())
+            return it.value();
+
+        const QByteArray utf8 = string.toUtf8();
+        const quint32 offset = mData.size();
+
+        quint32 length = qToLittleEndian(quint32(utf8.size()));
+        mData.append(reinterpret_cast<const char*>(&length), 4);
+        mData.append(utf8);
+
+        // Keep the next record 4-byte aligned
+        while (mData.size() & 3)
+            mData.append('\0');
+
+        mOffsets.insert(string, offset);
+        return offset;
+    }
+
+    const QByteArray &data() const { return mData; }
+
+private:
+    QByteArray mData;
+    QHash<QString, quint32> mOffsets;
+};
+
+class MappedReader
+{
+public:
+    MappedReader(const uchar *data, qint64 size)
+        : mData(data)
+        , mSize(size)
+    {}
+
+    // All offset and size arithmetic is done in qint64: the individual
+    // fields are 32-bit, but sizes derived from them (like count times
+    // entry size) do not fit in 32 bits for hostile counts, and letting
+    // them wrap would defeat these bounds checks.
+    bool contains(qint64 offset, qint64 size) const
+    {
+        return offset >= 0 && size >= 0 && offset <= mSize
+                && size <= mSize - offset;
+    }
+
+    quint32 u32(qint64 offset) const
+    {
+        quint32 value;
+        memcpy(&value, mData + offset, 4);
+        return qFromLittleEndian(value);
+    }
+
+    qint32 i32(qint64 offset) const
+    {
+        return qint32(u32(offset));
+    }
+
+    QString string(quint32 tableOffset, quint32 tableSize, quint32 ref) const
+    {
+        if (qint64(ref) + 4 > tableSize)
+            return QString();
+
+        const quint32 length = u32(qint64(tableOffset) + ref);
+        if (qint64(ref) + 4 + length > tableSize)
+            return QString();
+
+        return QString::fromUtf8(reinterpret_cast<const char*>(mData + qint64(tableOffset) + ref + 4),
+                                 length);
+    }
+
+private:
+    const uchar *mData;
+    qint64 mSize;
+};
+
+} // anonymous namespace
+
+TmbPlugin::TmbPlugin()
+{
+}
+
+std::unique_ptr<Tiled::Map> TmbPlugin::read(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mError = tr("Could not open file for reading.");
+        return nullptr;
+    }
+
+    const uchar *data = file.map(0, file.size());
+    if (!data) {
+        mError = tr("Could not memory-map file.");
+        return nullptr;
+    }
+
+    MappedReader reader(data, file.size());
+
+    if (!reader.contains(0, headerSize) || memcmp(data, magic, 4) != 0
+            || reader.u32(4) != version) {
+        mError = tr("This is not a valid Tiled binary map file!");
+        return nullptr;
+    }
+
+    Map::Parameters mapParameters;
+    mapParameters.orientation = Map::Orientation(reader.u32(8));
+    mapParameters.renderOrder = Map::RenderOrder(reader.u32(12));
+    mapParameters.width = reader.i32(16);
+    mapParameters.height = reader.i32(20);
+    mapParameters.tileWidth = reader.i32(24);
+    mapParameters.tileHeight = reader.i32(28);
+    mapParameters.infinite = reader.u32(32) != 0;
+    mapParameters.hexSideLength = reader.i32(36);
+    mapParameters.staggerAxis = Map::StaggerAxis(reader.u32(40));
+    mapParameters.staggerIndex = Map::StaggerIndex(reader.u32(44));
+
+    const quint32 chunkWidth = reader.u32(48);
+    const quint32 chunkHeight = reader.u32(52);
+    const quint32 tilesetCount = reader.u32(56);
+    const quint32 layerCount = reader.u32(60);
+    const quint32 tilesetTableOffset = reader.u32(64);
+    const quint32 layerTableOffset = reader.u32(68);
+    const quint32 stringTableOffset = reader.u32(72);
+    const quint32 stringTableSize = reader.u32(76);
+
+    if (chunkWidth == 0 || chunkHeight == 0
+            || qint64(chunkWidth) * chunkHeight > 65536
+            || !reader.contains(tilesetTableOffset, qint64(tilesetCount) * tilesetEntrySize)
+            || !reader.contains(layerTableOffset, qint64(layerCount) * layerEntrySize)
+            || !reader.contains(stringTableOffset, stringTableSize)) {
+        mError = tr("This is not a valid Tiled binary map file!");
+        return nullptr;
+    }
+
+    auto map = std::make_unique<Map>(mapParameters);
+
+    const QDir fileDir = QFileInfo(fileName).dir();
+    GidMapper gidMapper;
+
+    for (quint32 i = 0; i < tilesetCount; ++i) {
+        const qint64 entry = tilesetTableOffset + qint64(i) * tilesetEntrySize;
+        const quint32 firstGid = reader.u32(entry);
+        const QString source = reader.string(stringTableOffset, stringTableSize,
+                                             reader.u32(entry + 4));
+
+        QString error;
+        SharedTileset tileset = readTileset(QDir::cleanPath(fileDir.filePath(source)),
+                                            &error);
+        if (!tileset) {
+            mError = tr("Error loading tileset %1: %2").arg(source, error);
+            return nullptr;
+        }
+
+        map->addTileset(tileset);
+        gidMapper.insert(firstGid, tileset);
+    }
+
+    for (quint32 i = 0; i < layerCount; ++i) {
+        const qint64 entry = layerTableOffset + qint64(i) * layerEntrySize;
+        const QString name = reader.string(stringTableOffset, stringTableSize,
+                                           reader.u32(entry));
+        const quint32 chunkCount = reader.u32(entry + 4);
+        const quint32 chunkTableOffset = reader.u32(entry + 8);
+
+        if (!reader.contains(chunkTableOffset, qint64(chunkCount) * chunkEntrySize)) {
+            mError = tr("This is not a valid Tiled binary map file!");
+            return nullptr;
+        }
+
+        auto layer = std::make_unique<TileLayer>(name, 0, 0,
+                                                 mapParameters.width,
+                                                 mapParameters.height);
+
+        for (quint32 c = 0; c < chunkCount; ++c) {
+            const qint64 chunkEntry = chunkTableOffset + qint64(c) * chunkEntrySize;
+            const qint32 chunkX = reader.i32(chunkEntry);
+            const qint32 chunkY = reader.i32(chunkEntry + 4);
+            const quint32 dataOffset = reader.u32(chunkEntry + 8);
+
+            if (!reader.contains(dataOffset, qint64(chunkWidth) * chunkHeight * 4)) {
+                mError = tr("This is not a valid Tiled binary map file!");
+                return nullptr;
+            }
+
+            // Only the pages holding this chunk are faulted in here
+            quint32 index = 0;
+            for (quint32 y = 0; y < chunkHeight; ++y) {
+                for (quint32 x = 0; x < chunkWidth; ++x, ++index) {
+                    const quint32 gid = reader.u32(qint64(dataOffset) + index * 4);
+                    if (!gid)
+                        continue;
+
+                    bool ok;
+                    const Cell cell = gidMapper.gidToCell(gid, ok);
+                    if (ok)
+                        layer->setCell(chunkX + x, chunkY + y, cell);
+                }
+            }
+        }
+
+        map->addLayer(std::move(layer));
+    }
+
+    return map;
+}
+
+bool TmbPlugin::supportsFile(const QString &fileName) const
+{
+    if (!fileName.endsWith(QLatin1String(".tmb"), Qt::CaseInsensitive))
+        return false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    return file.read(4) == QByteArray(magic, 4);
+}
+
+bool TmbPlugin::write(const Tiled::Map *map, const QString &fileName, Options options)
+{
+    Q_UNUSED(options)
+
+    const QDir fileDir = QFileInfo(fileName).dir();
+
+    StringTable stringTable;
+    GidMapper gidMapper;
+
+    struct TilesetEntry {
+        quint32 firstGid;
+        quint32 sourceRef;
+    };
+    struct LayerEntry {
+        const TileLayer *layer;
+        quint32 nameRef;
+        QVector<QRect> chunks;
+    };
+
+    QVector<TilesetEntry> tilesetEntries;
+    quint32 firstGid = 1;
+
+    for (const SharedTileset &tileset : map->tilesets()) {
+        if (tileset->fileName().isEmpty()) {
+            mError = tr("The TMB format only supports external tilesets.");
+            return false;
+        }
+
+        const QString source = fileDir.relativeFilePath(tileset->fileName());
+        tilesetEntries.append({ firstGid, stringTable.insert(source) });
+        gidMapper.insert(firstGid, tileset);
+        firstGid += tileset->nextTileId();
+    }
+
+    const QSize chunkSize(CHUNK_SIZE, CHUNK_SIZE);
+    QVector<LayerEntry> layerEntries;
+    quint32 totalChunks = 0;
+
+    for (const Layer *layer : map->tileLayers()) {
+        const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
+        LayerEntry entry;
+        entry.layer = tileLayer;
+        entry.nameRef = stringTable.insert(tileLayer->name());
+        entry.chunks = tileLayer->sortedChunksToWrite(chunkSize);
+        totalChunks += entry.chunks.size();
+        layerEntries.append(entry);
+    }
+
+    // All offsets can be computed up front since every record has fixed size
+    const quint32 tilesetTableOffset = headerSize;
+    const quint32 layerTableOffset = tilesetTableOffset
+            + tilesetEntries.size() * tilesetEntrySize;
+    const quint32 chunkTablesOffset = layerTableOffset
+            + layerEntries.size() * layerEntrySize;
+    const quint32 chunkDataOffset = chunkTablesOffset
+            + totalChunks * chunkEntrySize;
+    const quint32 chunkDataSize = CHUNK_SIZE * CHUNK_SIZE * 4;
+    const quint32 stringTableOffset = chunkDataOffset
+            + totalChunks * chunkDataSize;
+
+    QByteArray out;
+    out.reserve(stringTableOffset + stringTable.data().size());
+
+    auto appendU32 = [&out] (quint32 value) {
+        value = qToLittleEndian(value);
+        out.append(reinterpret_cast<const char*>(&value), 4);
+    };
+
+    out.append(magic, 4);
+    appendU32(version);
+    appendU32(map->orientation());
+    appendU32(map->renderOrder());
+    appendU32(map->width());
+    appendU32(map->height());
+    appendU32(map->tileWidth());
+    appendU32(map->tileHeight());
+    appendU32(map->infinite() ? 1 : 0);
+    appendU32(map->hexSideLength());
+    appendU32(map->staggerAxis());
+    appendU32(map->staggerIndex());
+    appendU32(CHUNK_SIZE);
+    appendU32(CHUNK_SIZE);
+    appendU32(tilesetEntries.size());
+    appendU32(layerEntries.size());
+    appendU32(tilesetTableOffset);
+    appendU32(layerTableOffset);
+    appendU32(stringTableOffset);
+    appendU32(stringTable.data().size());
+
+    for (const TilesetEntry &entry : tilesetEntries) {
+        appendU32(entry.firstGid);
+        appendU32(entry.sourceRef);
+    }
+
+    quint32 chunkTableOffset = chunkTablesOffset;
+    for (const LayerEntry &entry : layerEntries) {
+        appendU32(entry.nameRef);
+        appendU32(entry.chunks.size());
+        appendU32(chunkTableOffset);
+        appendU32(0);   // reserved
+        chunkTableOffset += entry.chunks.size() * chunkEntrySize;
+    }
+
+    quint32 dataOffset = chunkDataOffset;
+    for (const LayerEntry &entry : layerEntries) {
+        for (const QRect &rect : entry.chunks) {
+            appendU32(quint32(rect.x()));
+            appendU32(quint32(rect.y()));
+            appendU32(dataOffset);
+            dataOffset += chunkDataSize;
+        }
+    }
+
+    for (const LayerEntry &entry : layerEntries) {
+        for (const QRect &rect : entry.chunks) {
+            for (int y = rect.top(); y <= rect.bottom(); ++y)
+                for (int x = rect.left(); x <= rect.right(); ++x)
+                    appendU32(gidMapper.cellToGid(entry.layer->cellAt(x, y)));
+        }
+    }
+
+    out.append(stringTable.data());
+
+    SaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        mError = tr("Could not open file for writing.");
+        return false;
+    }
+
+    file.device()->write(out);
+
+    if (file.error() != QFileDevice::NoError || !file.commit()) {
+        mError = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+QString TmbPlugin::nameFilter() const
+{
+    return tr("Tiled binary map files (*.tmb)");
+}
+
+QString TmbPlugin::shortName() const
+{
+    return QStringLiteral("tmb");
+}
+
+QString TmbPlugin::errorString() const
+{
+    return mError;
+}
+
+} // namespace Tmb
@@ -30,15 +30,27 @@
 
 namespace Yy {
 
+// The many small tokens are collected in a buffer, which is written out in
+// blocks of this size. Writing them to the device directly is very slow when
+// it is backed by a file.
+static constexpr int BlockSize = 64 * 1024;
+
 JsonWriter::JsonWriter(QIODevice *device)
     : m_device(device)
 {
+    m_buffer.reserve(BlockSize);
+}
+
+JsonWriter::~JsonWriter()
+{
+    flush();
 }
 
 void JsonWriter::writeEndDocument()
 {
     Q_ASSERT(m_scopes.isEmpty());
     write('\n');
+    flush();
 }
 
 void JsonWriter::writeStartScope(Scope scope)
@@ -258,10 +270,20 @@ void JsonWriter::writeKey(const char *key)
     write(m_minimize ? "\":" : "\": ");
 }
 
-void JsonWriter::write(const char *bytes, qint64 length)
+void JsonWriter::flush()
 {
-    if (m_device->write(bytes, length) != length)
+    if (m_buffer.isEmpty())
+        return;
+    if (m_device->write(m_buffer) != m_buffer.size())
         m_error = true;
+    m_buffer.resize(0);
+}
+
+void JsonWriter::write(const char *bytes, qint64 length)
+{
+    m_buffer.append(bytes, length);
+    if (m_buffer.size() >= BlockSize)
+        flush();
 }
 
 } // namespace Yy
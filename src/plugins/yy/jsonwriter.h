@@ -44,6 +44,7 @@ class JsonWriter
 
 public:
     JsonWriter(QIODevice *device);
+    ~JsonWriter();
 
     void writeEndDocument();
 
@@ -99,12 +100,14 @@ private:
 
     void writeNewline();
     void writeKey(const char *key);
+    void flush();
     void write(const char *bytes, qint64 length);
     void write(const char *bytes);
     void write(const QByteArray &bytes);
     void write(char c);
 
     QIODevice *m_device;
+    QByteArray m_buffer;
 
     QStack<Scope> m_scopes;
     char m_valueSeparator { ',' };
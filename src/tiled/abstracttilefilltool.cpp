@@ -189,8 +189,15 @@ void AbstractTileFillTool::updatePreview(const QRegion &fillRegion)
     if (!mRandomAndMissingCacheValid) {
         updateRandomListAndMissingTilesets();
         mRandomAndMissingCacheValid = true;
+        mLastFillRegion = QRegion();
     }
 
+    // While dragging a shape, only the moves that change the covered cells
+    // need a new preview
+    if (mPreviewMap && fillRegion == mLastFillRegion)
+        return;
+    mLastFillRegion = fillRegion;
+
     mFillBounds = fillRegion.boundingRect();
     auto preview = SharedMap::create(mapDocument()->map()->parameters());
 
@@ -231,6 +238,7 @@ void AbstractTileFillTool::clearOverlay()
 {
     brushItem()->clear();
     mPreviewMap.clear();
+    mLastFillRegion = QRegion();
 }
 
 void AbstractTileFillTool::updateRandomListAndMissingTilesets()
@@ -125,6 +125,9 @@ private:
 
     CaptureStampHelper mCaptureStampHelper;
 
+    /// The region covered by mPreviewMap, to skip regenerating an unchanged preview
+    QRegion mLastFillRegion;
+
     bool mRandomAndMissingCacheValid;
     void invalidateRandomAndMissingCache();
 
@@ -86,6 +86,80 @@ AddLayer *AddLayer::clone(QUndoCommand *parent) const
                         parent);
 }
 
+AddRemoveLayers::AddRemoveLayers(MapDocument *mapDocument,
+                                 int index,
+                                 int count,
+                                 const QList<Layer *> &layers,
+                                 GroupLayer *parentLayer,
+                                 QUndoCommand *parent)
+    : QUndoCommand(parent)
+    , mMapDocument(mapDocument)
+    , mLayers(layers)
+    , mParentLayer(parentLayer)
+    , mIndex(index)
+    , mCount(count)
+{
+}
+
+AddRemoveLayers::~AddRemoveLayers()
+{
+    qDeleteAll(mLayers);
+}
+
+void AddRemoveLayers::addLayers()
+{
+    mMapDocument->layerModel()->insertLayers(mParentLayer, mIndex, mLayers);
+    mLayers.clear();
+}
+
+void AddRemoveLayers::removeLayers()
+{
+    mLayers = mMapDocument->layerModel()->takeLayersAt(mParentLayer, mIndex, mCount);
+}
+
+AddLayers::AddLayers(MapDocument *mapDocument,
+                     int index, const QList<Layer *> &layers,
+                     GroupLayer *parentLayer,
+                     QUndoCommand *parent)
+    : AddRemoveLayers(mapDocument, index, layers.size(), layers, parentLayer, parent)
+{
+    setText(QCoreApplication::translate("Undo Commands",
+                                        "Add %n Layer(s)", "", layers.size()));
+}
+
+void AddLayers::undo()
+{
+    removeLayers();
+    QUndoCommand::undo(); // undo child commands
+}
+
+void AddLayers::redo()
+{
+    QUndoCommand::redo(); // redo child commands
+    addLayers();
+}
+
+RemoveLayers::RemoveLayers(MapDocument *mapDocument,
+                           int index, int count, GroupLayer *parentLayer,
+                           QUndoCommand *parent)
+    : AddRemoveLayers(mapDocument, index, count, {}, parentLayer, parent)
+{
+    setText(QCoreApplication::translate("Undo Commands",
+                                        "Remove %n Layer(s)", "", count));
+}
+
+void RemoveLayers::undo()
+{
+    addLayers();
+    QUndoCommand::undo(); // undo child commands
+}
+
+void RemoveLayers::redo()
+{
+    QUndoCommand::redo(); // redo child commands
+    removeLayers();
+}
+
 RemoveLayer::RemoveLayer(MapDocument *mapDocument,
                          int index, GroupLayer *parentLayer,
                          QUndoCommand *parent)
@@ -22,6 +22,7 @@
 
 #include "undocommands.h"
 
+#include <QList>
 #include <QUndoCommand>
 
 namespace Tiled {
@@ -90,4 +91,68 @@ public:
     void redo() override;
 };
 
+/**
+ * Abstract base class for AddLayers and RemoveLayers, which act on a
+ * contiguous run of sibling layers. The layer model announces the change to
+ * views with a single ranged signal, which keeps mass layer operations from
+ * triggering a view update per layer.
+ */
+class AddRemoveLayers : public QUndoCommand
+{
+public:
+    AddRemoveLayers(MapDocument *mapDocument, int index, int count,
+                    const QList<Layer *> &layers,
+                    GroupLayer *parentLayer,
+                    QUndoCommand *parent = nullptr);
+
+    ~AddRemoveLayers() override;
+
+protected:
+    void addLayers();
+    void removeLayers();
+
+    MapDocument *mMapDocument;
+    QList<Layer *> mLayers;
+    GroupLayer *mParentLayer;
+    int mIndex;
+    int mCount;
+};
+
+/**
+ * Undo command that adds a run of sibling layers to a map.
+ */
+class AddLayers : public AddRemoveLayers
+{
+public:
+    /**
+     * Creates an undo command that adds the \a layers to \a parentLayer
+     * starting at \a index.
+     */
+    AddLayers(MapDocument *mapDocument,
+              int index, const QList<Layer *> &layers,
+              GroupLayer *parentLayer,
+              QUndoCommand *parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+};
+
+/**
+ * Undo command that removes a run of sibling layers from a map.
+ */
+class RemoveLayers : public AddRemoveLayers
+{
+public:
+    /**
+     * Creates an undo command that removes \a count layers starting at
+     * \a index.
+     */
+    RemoveLayers(MapDocument *mapDocument,
+                 int index, int count, GroupLayer *parentLayer,
+                 QUndoCommand *parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+};
+
 } // namespace Tiled
@@ -110,11 +110,26 @@ void AddMapObjects::undo()
 
     emit mDocument->changed(mapObjectsEvent);
 
-    for (int i = mEntries.size() - 1; i >= 0; --i) {
-        Entry &entry = mEntries[i];
-        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAboutToBeRemoved, entry.objectGroup, entry.index));
-        entry.objectGroup->removeObjectAt(entry.index);
-        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectRemoved, entry.objectGroup, entry.index));
+    // Remove the objects in runs of consecutive indexes in the same object
+    // group, so that views get a single ranged event per run rather than one
+    // event per object (see AddMapObjects::redo).
+    for (int i = mEntries.size() - 1; i >= 0; ) {
+        int first = i;
+        while (first > 0
+               && mEntries.at(first - 1).objectGroup == mEntries.at(i).objectGroup
+               && mEntries.at(first - 1).index == mEntries.at(first).index - 1)
+            --first;
+
+        ObjectGroup *objectGroup = mEntries.at(first).objectGroup;
+        const int index = mEntries.at(first).index;
+        const int count = i - first + 1;
+
+        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAboutToBeRemoved, objectGroup, index, count));
+        for (int j = i; j >= first; --j)
+            objectGroup->removeObjectAt(mEntries.at(j).index);
+        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectRemoved, objectGroup, index, count));
+
+        i = first - 1;
     }
 
     mapObjectsEvent.type = ChangeEvent::MapObjectsRemoved;
@@ -129,13 +144,42 @@ void AddMapObjects::redo()
 {
     QUndoCommand::redo(); // redo child commands
 
-    for (Entry &entry : mEntries) {
-        if (entry.index == -1)
-            entry.index = entry.objectGroup->objectCount();
-
-        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAboutToBeAdded, entry.objectGroup, entry.index));
-        entry.objectGroup->insertObject(entry.index, entry.mapObject);
-        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAdded, entry.objectGroup, entry.index));
+    // Bulk additions (paste, merge, scripted object creation) append all
+    // objects to the same object group. Coalescing such runs of consecutive
+    // indexes into a single ranged event saves views from doing per-object
+    // work, which used to dominate when adding many objects at once.
+    for (int i = 0; i < mEntries.size(); ) {
+        Entry &firstEntry = mEntries[i];
+        if (firstEntry.index == -1)
+            firstEntry.index = firstEntry.objectGroup->objectCount();
+
+        const bool appending = firstEntry.index == firstEntry.objectGroup->objectCount();
+
+        int count = 1;
+        while (i + count < mEntries.size()) {
+            Entry &entry = mEntries[i + count];
+            if (entry.objectGroup != firstEntry.objectGroup)
+                break;
+            if (entry.index == -1) {
+                // An unset index means "append", which only continues this
+                // run when the run itself started at the end of the group.
+                if (!appending)
+                    break;
+                entry.index = firstEntry.index + count;
+            } else if (entry.index != firstEntry.index + count) {
+                break;
+            }
+            ++count;
+        }
+
+        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAboutToBeAdded, firstEntry.objectGroup, firstEntry.index, count));
+        for (int j = 0; j < count; ++j) {
+            const Entry &entry = mEntries.at(i + j);
+            entry.objectGroup->insertObject(entry.index, entry.mapObject);
+        }
+        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAdded, firstEntry.objectGroup, firstEntry.index, count));
+
+        i += count;
     }
 
     emit mDocument->changed(MapObjectsEvent(ChangeEvent::MapObjectsAdded, objects(mEntries)));
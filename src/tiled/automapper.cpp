@@ -22,6 +22,7 @@
 #include "automapper.h"
 
 #include "automappingutils.h"
+#include "chunkregion.h"
 #include "containerhelpers.h"
 #include "geometry.h"
 #include "logginginterface.h"
@@ -31,6 +32,7 @@
 #include "maprenderer.h"
 #include "object.h"
 #include "objectgroup.h"
+#include "profiler.h"
 #include "randompicker.h"
 #include "tile.h"
 
@@ -65,6 +67,13 @@ static const Cell &getCell(int x, int y, const TileLayer &tileLayer)
     return tileLayer.cellAt(x, y);
 }
 
+// Used to check whether a rule is able to match entirely empty input
+static const Cell &getEmptyCell(int, int, const TileLayer &)
+{
+    static const Cell cell;
+    return cell;
+}
+
 static double randomDouble()
 {
     thread_local std::mt19937 engine(std::random_device{}());
@@ -135,10 +144,17 @@ struct ApplyContext
     // These regions store which parts or the map have already been altered by
     // exactly this rule. We store all the altered parts to make sure there are
     // no overlaps of the same rule applied to (neighbouring) places.
-    QHash<const Layer*, QRegion> appliedRegions;
+    //
+    // ChunkRegion is used instead of QRegion because these regions are built
+    // up from many small rectangles in arbitrary order, which QRegion does
+    // not handle well.
+    QHash<const Layer*, ChunkRegion> appliedRegions;
 
     RandomPicker<const OutputSet*> outputSets;
 
+    // Accumulates the applied region for all rules, converted to a QRegion
+    // once at the end of autoMap.
+    ChunkRegion applied;
     QRegion *appliedRegion;
 };
 
@@ -979,6 +995,7 @@ void AutoMapper::autoMap(const QRegion &where,
                          QRegion *appliedRegion,
                          AutoMappingContext &context) const
 {
+    TILED_PROFILE_SCOPE("AutoMapper::autoMap");
     QRegion applyRegion;
 
     // first resize the active area if applicable
@@ -993,16 +1010,18 @@ void AutoMapper::autoMap(const QRegion &where,
         applyRegion = where;
     }
 
+    // The union of the occupied areas of the input layers, used to erase
+    // with "DeleteTiles" and to skip matching rules in empty areas.
+    QRegion inputLayersRegion;
+    for (const QString &name : std::as_const(mRuleMapSetup.mInputLayerNames)) {
+        if (const TileLayer *inputLayer = context.inputLayers.value(name))
+            inputLayersRegion |= inputLayer->region();
+    }
+
     // Delete all the relevant area, if the property "DeleteTiles" is set
     if (mOptions.deleteTiles) {
         // In principle we erase the entire applyRegion, excluding areas where
         // none of the input layers have any contents.
-        QRegion inputLayersRegion;
-        for (const QString &name : std::as_const(mRuleMapSetup.mInputLayerNames)) {
-            if (const TileLayer *inputLayer = context.inputLayers.value(name))
-                inputLayersRegion |= inputLayer->region();
-        }
-
         const QRegion regionToErase = inputLayersRegion.intersected(applyRegion);
         for (const OutputSet &ruleOutput : std::as_const(mRuleMapSetup.mOutputSets)) {
             QHashIterator<const Layer*, QString> it(ruleOutput.layers);
@@ -1049,7 +1068,7 @@ void AutoMapper::autoMap(const QRegion &where,
             if (rule.options.disabled)
                 continue;
 
-            matchRule(rule, applyRegion, get, [&] (QPoint pos) {
+            matchRule(rule, applyRegion, inputLayersRegion, get, [&] (QPoint pos) {
                 applyRule(rule, pos, applyContext, context);
             }, context);
             applyContext.appliedRegions.clear();
@@ -1058,7 +1077,7 @@ void AutoMapper::autoMap(const QRegion &where,
         auto collectMatches = [&] (const Rule &rule) {
             QVector<QPoint> positions;
             if (!rule.options.disabled)
-                matchRule(rule, applyRegion, get, [&] (QPoint pos) { positions.append(pos); }, context);
+                matchRule(rule, applyRegion, inputLayersRegion, get, [&] (QPoint pos) { positions.append(pos); }, context);
             return positions;
         };
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -1087,6 +1106,9 @@ void AutoMapper::autoMap(const QRegion &where,
             applyContext.appliedRegions.clear();
         }
     }
+
+    if (appliedRegion)
+        *appliedRegion |= applyContext.applied.toRegion();
 }
 
 /**
@@ -1138,6 +1160,7 @@ static bool matchRuleAtOffset(const QVector<RuleInputSet> &inputSets, QPoint off
 
 void AutoMapper::matchRule(const Rule &rule,
                            const QRegion &matchRegion,
+                           const QRegion &inputLayersRegion,
                            GetCell getCell,
                            const std::function<void(QPoint pos)> &matched,
                            const AutoMappingContext &context) const
@@ -1168,19 +1191,102 @@ void AutoMapper::matchRule(const Rule &rule,
                                  context.targetMap->height() - ruleHeight);
     }
 
+    // A rule that cannot match entirely empty input can only match at
+    // offsets where at least one input layer has contents within the rule's
+    // input bounds. Restricting the match region to the surroundings of the
+    // occupied areas skips the empty parts of the map without ever looking
+    // at their cells. The wrapping and bounding cell getters remap positions
+    // outside the map onto it, so the restriction only applies to the plain
+    // getter.
+    if (getCell == &Tiled::getCell
+            && !matchRuleAtOffset(inputSets, QPoint(), &getEmptyCell)) {
+        QRegion nearContents;
+        for (const QRect &rect : inputLayersRegion) {
+            nearContents |= rect.adjusted(-inputBounds.right(),
+                                          -inputBounds.bottom(),
+                                          -inputBounds.left(),
+                                          -inputBounds.top());
+        }
+        ruleMatchRegion &= nearContents;
+    }
+
+    // The rects of the region are split into bands of limited height, so
+    // that a region consisting of a single large rect (a full-map run of
+    // one rule, for example) still produces enough work items to keep all
+    // cores busy. Bands keep the scan start offsets of their originating
+    // rect and are cut along the rule's modulo grid, so exactly the same
+    // positions are visited as by an unsplit scan.
+    struct Band {
+        QRect rect;
+        int startX;
+        int startY;
+    };
+
+    constexpr int maxBandSteps = 64;    // band height, in modY steps
+
+    QVector<Band> bands;
     for (const QRect &rect : ruleMatchRegion) {
         const int startX = rect.left() + (rect.left() + rule.options.offsetX) % rule.options.modX;
         const int startY = rect.top() + (rect.top() + rule.options.offsetY) % rule.options.modY;
+        const int bandHeight = maxBandSteps * rule.options.modY;
+
+        for (int bandTop = startY; bandTop <= rect.bottom(); bandTop += bandHeight) {
+            const QRect bandRect(QPoint(rect.left(), bandTop),
+                                 QPoint(rect.right(), qMin(bandTop + bandHeight - 1,
+                                                           rect.bottom())));
+            bands.append(Band { bandRect, startX, bandTop });
+        }
+    }
+
+    auto matchInBand = [&] (const Band &band) {
+        QVector<QPoint> positions;
 
-        for (int y = startY; y <= rect.bottom(); y += rule.options.modY) {
-            for (int x = startX; x <= rect.right(); x += rule.options.modX) {
+        for (int y = band.startY; y <= band.rect.bottom(); y += rule.options.modY) {
+            for (int x = band.startX; x <= band.rect.right(); x += rule.options.modX) {
                 if (rule.options.skipChance != 0.0 && randomDouble() < rule.options.skipChance)
                     continue;
 
                 if (matchRuleAtOffset(inputSets, QPoint(x, y), getCell))
-                    matched(QPoint(x, y));
+                    positions.append(QPoint(x, y));
             }
         }
+
+        return positions;
+    };
+
+    // Match the bands in parallel. This only happens when matching in
+    // order, since otherwise the rules themselves are already matched
+    // concurrently and nesting blocking QtConcurrent calls could starve the
+    // thread pool. When a skip chance is set the matching stays sequential,
+    // to not change the order in which random numbers are drawn. The
+    // matched positions are always reported in region order, so the rule is
+    // applied deterministically either way.
+    if (mOptions.matchInOrder && bands.size() > 1 && rule.options.skipChance == 0.0) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        const auto results = QtConcurrent::blockingMapped(bands, matchInBand);
+#else
+        struct MatchInBand
+        {
+            using result_type = QVector<QPoint>;
+
+            std::function<result_type(const Band&)> matchInBand;
+
+            result_type operator()(const Band &band)
+            {
+                return matchInBand(band);
+            }
+        };
+
+        const auto results = QtConcurrent::blockingMapped<QVector<QVector<QPoint>>>(bands,
+                                                                                    MatchInBand { matchInBand });
+#endif
+        for (const auto &positions : results)
+            for (const QPoint pos : positions)
+                matched(pos);
+    } else {
+        for (const Band &band : std::as_const(bands))
+            for (const QPoint pos : matchInBand(band))
+                matched(pos);
     }
 }
 
@@ -1245,14 +1351,14 @@ void AutoMapper::applyRule(const Rule &rule, QPoint pos,
             const Layer *layer = entry.first;
             const QRegion &region = entry.second;
 
-            applyContext.appliedRegions[layer] |= region;
+            applyContext.appliedRegions[layer].add(region);
         });
     }
 
     copyMapRegion(rule, pos, ruleOutput, context);
 
     if (applyContext.appliedRegion)
-        *applyContext.appliedRegion |= rule.outputRegion.translated(pos.x(), pos.y());
+        applyContext.applied.add(rule.outputRegion.translated(pos.x(), pos.y()));
 }
 
 void AutoMapper::copyMapRegion(const Rule &rule, QPoint offset,
@@ -1275,8 +1381,9 @@ void AutoMapper::copyMapRegion(const Rule &rule, QPoint offset,
             if (!rule.options.ignoreLock && !toTileLayer->isUnlocked())
                 continue;
 
-            if (!context.touchedTileLayers.isEmpty())
-                appendUnique<const TileLayer*>(context.touchedTileLayers, toTileLayer);
+            if (!context.touchedTileLayerNames.isEmpty()
+                    && !context.touchedTileLayerNames.contains(targetName))
+                context.touchedTileLayerNames.append(targetName);
 
             to = toTileLayer;
             for (const QRect &rect : outputRegion) {
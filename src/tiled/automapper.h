@@ -32,6 +32,7 @@
 #include <QRegularExpression>
 #include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 
 #include <memory>
@@ -213,7 +214,7 @@ struct TILED_EDITOR_EXPORT AutoMappingContext
     std::unordered_map<TileLayer*, std::unique_ptr<TileLayer>> originalToOutputLayerMapping;
 
     // Used to keep track of touched tile layers (only when initially non-empty)
-    QVector<const TileLayer*> touchedTileLayers;
+    QStringList touchedTileLayerNames;
 
 private:
     friend class AutoMapper;
@@ -403,6 +404,7 @@ private:
      */
     void matchRule(const Rule &rule,
                    const QRegion &matchRegion,
+                   const QRegion &inputLayersRegion,
                    GetCell getCell,
                    const std::function<void (QPoint)> &matched,
                    const AutoMappingContext &context) const;
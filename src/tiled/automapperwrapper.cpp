@@ -26,6 +26,7 @@
 #include "addremovetileset.h"
 #include "automapper.h"
 #include "changeproperties.h"
+#include "chunkedoperation.h"
 #include "containerhelpers.h"
 #include "map.h"
 #include "mapdocument.h"
@@ -38,7 +39,8 @@ using namespace Tiled;
 AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
                                      const QVector<AutoMapper *> &autoMappers,
                                      const QRegion &where,
-                                     const TileLayer *touchedLayer)
+                                     const QStringList &touchedLayers,
+                                     ChunkedOperation *operation)
     : PaintTileLayer(mapDocument)
 {
     AutoMappingContext context(mapDocument);
@@ -48,8 +50,7 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
 
     // During "AutoMap while drawing", keep track of the touched layers, so we
     // can skip any rule maps that doesn't have these layers as input entirely.
-    if (touchedLayer)
-        context.touchedTileLayers.append(touchedLayer);
+    context.touchedTileLayerNames = touchedLayers;
 
     // use a copy of the region, so each AutoMapper can manipulate it and the
     // following AutoMappers do see the impact
@@ -64,10 +65,10 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
         if (appliedRegionPtr && (!map->infinite() && (mapRect - region).isEmpty()))
             appliedRegionPtr = nullptr;
 
-        if (touchedLayer) {
-            if (std::none_of(context.touchedTileLayers.cbegin(),
-                             context.touchedTileLayers.cend(),
-                             [&] (const TileLayer *tileLayer) { return autoMapper->ruleLayerNameUsed(tileLayer->name()); }))
+        if (!touchedLayers.isEmpty()) {
+            if (std::none_of(context.touchedTileLayerNames.cbegin(),
+                             context.touchedTileLayerNames.cend(),
+                             [&] (const QString &layerName) { return autoMapper->ruleLayerNameUsed(layerName); }))
                 continue;
         }
 
@@ -80,6 +81,13 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
             if (!map->infinite())       // but keep within map boundaries
                 region &= mapRect;
         }
+
+        // All changes so far only affect the working copies in the context,
+        // so on cancel the map is left untouched
+        if (operation && !operation->advance()) {
+            mCancelled = true;
+            return;
+        }
     }
 
     // Apply the changes to existing tile layers
@@ -28,6 +28,7 @@
 namespace Tiled {
 
 class AutoMapper;
+class ChunkedOperation;
 
 /**
  * This is a wrapper class for applying the changes by one or more AutoMapper
@@ -35,6 +36,11 @@ class AutoMapper;
  *
  * It derives from PaintTileLayer so that the changes can be merged with the
  * previous paint operation.
+ *
+ * When an \a operation is given, it is advanced after each AutoMapper.
+ * When it reports cancellation the wrapper stops and leaves the map
+ * untouched; the caller should check isCancelled() and delete the command
+ * instead of pushing it.
  */
 class AutoMapperWrapper : public PaintTileLayer
 {
@@ -42,7 +48,13 @@ public:
     AutoMapperWrapper(MapDocument *mapDocument,
                       const QVector<AutoMapper*> &autoMappers,
                       const QRegion &where,
-                      const TileLayer *touchedLayer = nullptr);
+                      const QStringList &touchedLayers = QStringList(),
+                      ChunkedOperation *operation = nullptr);
+
+    bool isCancelled() const { return mCancelled; }
+
+private:
+    bool mCancelled = false;
 };
 
 } // namespace Tiled
@@ -23,6 +23,7 @@
 
 #include "automapper.h"
 #include "automapperwrapper.h"
+#include "chunkedoperation.h"
 #include "logginginterface.h"
 #include "map.h"
 #include "mapdocument.h"
@@ -31,6 +32,7 @@
 #include "projectmanager.h"
 #include "tilelayer.h"
 
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
 #include <QFileSystemWatcher>
@@ -42,6 +44,24 @@ using namespace Tiled;
 
 SessionOption<bool> AutomappingManager::automappingWhileDrawing { "automapping.whileDrawing", false };
 
+/**
+ * A session-wide cache of compiled AutoMapper instances, so that a rule map
+ * shared by many maps only needs to be parsed and indexed once rather than
+ * once per document.
+ *
+ * Since the same rule map can be referenced by different rules files with
+ * different map name filters, entries are keyed by both the rule map file
+ * and the filter pattern. Entries are revalidated against the file's
+ * modification time on lookup.
+ */
+struct CachedRuleMap
+{
+    QDateTime lastModified;
+    std::shared_ptr<AutoMapper> autoMapper;
+};
+
+static QHash<QString, CachedRuleMap> ruleMapCache;
+
 AutomappingManager::AutomappingManager(QObject *parent)
     : QObject(parent)
 {
@@ -79,18 +99,44 @@ void AutomappingManager::autoMap()
         }
     }
 
-    autoMapInternal(region, nullptr);
+    autoMapInternal(region, QStringList());
 }
 
 void AutomappingManager::autoMapRegion(const QRegion &region)
 {
-    autoMapInternal(region, nullptr);
+    autoMapInternal(region, QStringList());
 }
 
 void AutomappingManager::onRegionEdited(const QRegion &where, TileLayer *touchedLayer)
 {
-    if (automappingWhileDrawing)
-        autoMapInternal(where, touchedLayer);
+    if (!automappingWhileDrawing)
+        return;
+
+    // A single brush stroke can report many edited regions in quick
+    // succession. Coalesce them and apply the rules at most once per event
+    // loop iteration, on the combined region.
+    mPendingRegion |= where;
+    if (!mPendingTouchedLayers.contains(touchedLayer->name()))
+        mPendingTouchedLayers.append(touchedLayer->name());
+
+    if (!mPendingAutoMap) {
+        mPendingAutoMap = true;
+        QMetaObject::invokeMethod(this, &AutomappingManager::autoMapPending,
+                                  Qt::QueuedConnection);
+    }
+}
+
+void AutomappingManager::autoMapPending()
+{
+    mPendingAutoMap = false;
+
+    const QRegion region = mPendingRegion;
+    const QStringList touchedLayers = mPendingTouchedLayers;
+    mPendingRegion = QRegion();
+    mPendingTouchedLayers.clear();
+
+    if (automappingWhileDrawing && !region.isEmpty())
+        autoMapInternal(region, touchedLayers);
 }
 
 void AutomappingManager::onMapFileNameChanged()
@@ -100,7 +146,7 @@ void AutomappingManager::onMapFileNameChanged()
 }
 
 void AutomappingManager::autoMapInternal(const QRegion &where,
-                                         const TileLayer *touchedLayer)
+                                         const QStringList &touchedLayers)
 {
     mError.clear();
     mWarning.clear();
@@ -108,7 +154,7 @@ void AutomappingManager::autoMapInternal(const QRegion &where,
     if (!mMapDocument)
         return;
 
-    const bool automatic = touchedLayer != nullptr;
+    const bool automatic = !touchedLayers.isEmpty();
 
     if (!mLoaded) {
         if (mRulesFile.isEmpty()) {
@@ -150,19 +196,34 @@ void AutomappingManager::autoMapInternal(const QRegion &where,
         return;
 
     // Skip this AutoMapping run if none of the loaded rule maps actually use
-    // the touched layer.
-    if (touchedLayer) {
-        if (std::none_of(autoMappers.cbegin(),
-                         autoMappers.cend(),
-                         [=] (AutoMapper *autoMapper) { return autoMapper->ruleLayerNameUsed(touchedLayer->name()); }))
+    // any of the touched layers.
+    if (automatic) {
+        const bool anyLayerUsed = std::any_of(autoMappers.cbegin(),
+                                              autoMappers.cend(),
+                                              [&] (AutoMapper *autoMapper) {
+            return std::any_of(touchedLayers.cbegin(),
+                               touchedLayers.cend(),
+                               [=] (const QString &layerName) { return autoMapper->ruleLayerNameUsed(layerName); });
+        });
+        if (!anyLayerUsed)
             return;
     }
 
-    AutoMapperWrapper *aw = new AutoMapperWrapper(mMapDocument, autoMappers, where, touchedLayer);
+    ChunkedOperation operation(tr("Applying AutoMap rules"), autoMappers.size());
+
+    auto aw = std::make_unique<AutoMapperWrapper>(mMapDocument, autoMappers,
+                                                  where, touchedLayers,
+                                                  &operation);
+
+    // A cancelled run hasn't touched the map, so rolling back just means
+    // discarding the command
+    if (aw->isCancelled())
+        return;
+
     aw->setMergeable(automatic);
     aw->setText(tr("Apply AutoMap rules"));
 
-    mMapDocument->undoStack()->push(aw);
+    mMapDocument->undoStack()->push(aw.release());
 }
 
 /**
@@ -254,6 +315,19 @@ bool AutomappingManager::loadRulesFile(const QString &filePath)
 
 bool AutomappingManager::loadRuleMap(const QString &filePath)
 {
+    const QFileInfo fileInfo { filePath };
+    const QString cacheKey = fileInfo.canonicalFilePath()
+            + QLatin1Char('\n') + mMapNameFilter.pattern();
+
+    const auto it = ruleMapCache.constFind(cacheKey);
+    if (it != ruleMapCache.constEnd()
+            && it->lastModified == fileInfo.lastModified()) {
+        mWarning += it->autoMapper->warningString();
+        mAutoMappers.push_back(it->autoMapper);
+        mWatcher.addPath(filePath);
+        return true;
+    }
+
     QString errorString;
     std::unique_ptr<Map> rules { readMap(filePath, &errorString) };
 
@@ -267,11 +341,12 @@ bool AutomappingManager::loadRuleMap(const QString &filePath)
         return false;
     }
 
-    std::unique_ptr<AutoMapper> autoMapper { new AutoMapper(std::move(rules), mMapNameFilter) };
+    auto autoMapper = std::make_shared<AutoMapper>(std::move(rules), mMapNameFilter);
 
     mWarning += autoMapper->warningString();
     const QString error = autoMapper->errorString();
     if (error.isEmpty()) {
+        ruleMapCache.insert(cacheKey, { fileInfo.lastModified(), autoMapper });
         mAutoMappers.push_back(std::move(autoMapper));
         mWatcher.addPath(filePath);
     } else {
@@ -295,6 +370,8 @@ void AutomappingManager::setMapDocument(MapDocument *mapDocument, const QString
             mMapDocument->disconnect(this);
 
         mMapDocument = mapDocument;
+        mPendingRegion = QRegion();
+        mPendingTouchedLayers.clear();
 
         if (mMapDocument) {
             connect(mMapDocument, &MapDocument::fileNameChanged,
@@ -28,6 +28,7 @@
 #include <QRegion>
 #include <QRegularExpression>
 #include <QString>
+#include <QStringList>
 
 #include <memory>
 #include <vector>
@@ -81,6 +82,7 @@ signals:
 
 private:
     void onRegionEdited(const QRegion &where, TileLayer *touchedLayer);
+    void autoMapPending();
     void onMapFileNameChanged();
     void onFileChanged();
 
@@ -91,10 +93,10 @@ private:
     /**
      * Applies automapping to the region \a where.
      *
-     * If a \a touchedLayer is given, only those AutoMappers will be used which
-     * have a rule layer matching the \a touchedLayer.
+     * If \a touchedLayers are given, only those AutoMappers will be used
+     * which have a rule layer matching one of the \a touchedLayers.
      */
-    void autoMapInternal(const QRegion &where, const TileLayer *touchedLayer);
+    void autoMapInternal(const QRegion &where, const QStringList &touchedLayers);
 
     /**
      * deletes all its data structures
@@ -109,8 +111,11 @@ private:
     /**
      * For each new file of rules a new AutoMapper is setup. In this vector we
      * can store all of the AutoMappers in order.
+     *
+     * The instances are shared with a session-wide cache, so that rule maps
+     * used by multiple documents are only compiled once.
      */
-    std::vector<std::unique_ptr<AutoMapper>> mAutoMappers;
+    std::vector<std::shared_ptr<AutoMapper>> mAutoMappers;
 
     /**
      * This tells you if the rules for the current map document were already
@@ -132,6 +137,14 @@ private:
 
     QFileSystemWatcher mWatcher;
 
+    /**
+     * The edited regions reported since the last automatic run, coalesced so
+     * that a single run covers all of them.
+     */
+    QRegion mPendingRegion;
+    QStringList mPendingTouchedLayers;
+    bool mPendingAutoMap = false;
+
     QString mRulesFile;
     QRegularExpression mMapNameFilter;
     bool mRulesFileOverride = false;
@@ -0,0 +1,232 @@
+/*
+ * autorecovery.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "autorecovery.h"
+
+#include "documentmanager.h"
+#include "jobscheduler.h"
+#include "map.h"
+#include "mapwriter.h"
+#include "savefile.h"
+#include "tmxmapformat.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QUndoStack>
+
+namespace Tiled {
+
+AutoRecovery::AutoRecovery(DocumentManager *documentManager)
+    : QObject(documentManager)
+{
+    // Snapshots are debounced so that rapid edits result in a single write
+    mSnapshotTimer.setSingleShot(true);
+    mSnapshotTimer.setInterval(1000);
+    connect(&mSnapshotTimer, &QTimer::timeout,
+            this, &AutoRecovery::writeSnapshots);
+
+    connect(documentManager, &DocumentManager::documentOpened,
+            this, &AutoRecovery::documentOpened);
+    connect(documentManager, &DocumentManager::documentSaved,
+            this, &AutoRecovery::documentSaved);
+    connect(documentManager, &DocumentManager::documentAboutToClose,
+            this, &AutoRecovery::documentAboutToClose);
+}
+
+QString AutoRecovery::recoveryFileName(const QString &fileName)
+{
+    return fileName + QLatin1String(".autosave");
+}
+
+MapDocumentPtr AutoRecovery::restoreDocument(const QString &fileName,
+                                             MapFormat *format,
+                                             QWidget *parent)
+{
+    const QString recoveryFile = recoveryFileName(fileName);
+    const QFileInfo recoveryInfo(recoveryFile);
+    if (!recoveryInfo.exists())
+        return MapDocumentPtr();
+
+    // A snapshot older than the map file is a leftover from a session whose
+    // changes were saved by other means
+    if (recoveryInfo.lastModified() <= QFileInfo(fileName).lastModified()) {
+        QFile::remove(recoveryFile);
+        return MapDocumentPtr();
+    }
+
+    const auto answer
+            = QMessageBox::question(parent,
+                                    tr("Restore Unsaved Changes"),
+                                    tr("Unsaved changes to '%1' were recovered from the last session. Do you want to restore them?")
+                                    .arg(QFileInfo(fileName).fileName()),
+                                    QMessageBox::Yes | QMessageBox::No,
+                                    QMessageBox::Yes);
+
+    if (answer != QMessageBox::Yes) {
+        QFile::remove(recoveryFile);
+        return MapDocumentPtr();
+    }
+
+    // Snapshots are always TMX, regardless of the map file's format
+    TmxMapFormat tmxFormat;
+    QString error;
+    MapDocumentPtr document = MapDocument::load(recoveryFile, &tmxFormat, &error);
+    if (!document)
+        return MapDocumentPtr();    // fall back to loading the map file
+
+    document->setFileName(fileName);
+    document->setReaderFormat(format);
+    if (format->hasCapabilities(MapFormat::Write))
+        document->setWriterFormat(format);
+
+    // The restored changes are not in the map file yet
+    document->undoStack()->resetClean();
+
+    return document;
+}
+
+void AutoRecovery::documentOpened(Document *document)
+{
+    auto mapDocument = qobject_cast<MapDocument*>(document);
+    if (!mapDocument)
+        return;
+
+    // A document can be re-inserted, for example after a reload
+    mapDocument->undoStack()->disconnect(this);
+
+    connect(mapDocument->undoStack(), &QUndoStack::indexChanged,
+            this, [=] { scheduleSnapshot(mapDocument); });
+}
+
+void AutoRecovery::documentSaved(Document *document)
+{
+    auto mapDocument = qobject_cast<MapDocument*>(document);
+    if (!mapDocument)
+        return;
+
+    mPendingDocuments.remove(mapDocument);
+
+    // Invalidate any snapshot still in flight before removing the file, so
+    // that it cannot reappear afterwards
+    const QString recoveryFile = recoveryFileName(mapDocument->fileName());
+    const int generation = ++mGeneration;
+
+    QMutexLocker locker(&mWriteState->mutex);
+    mWriteState->lastWrittenGeneration[recoveryFile] = generation;
+    QFile::remove(recoveryFile);
+}
+
+void AutoRecovery::documentAboutToClose(Document *document)
+{
+    auto mapDocument = qobject_cast<MapDocument*>(document);
+    if (!mapDocument)
+        return;
+
+    mPendingDocuments.remove(mapDocument);
+    mapDocument->undoStack()->disconnect(this);
+
+    // Closing either saved the changes or discarded them deliberately
+    if (!mapDocument->fileName().isEmpty()) {
+        const QString recoveryFile = recoveryFileName(mapDocument->fileName());
+        const int generation = ++mGeneration;
+
+        QMutexLocker locker(&mWriteState->mutex);
+        mWriteState->lastWrittenGeneration[recoveryFile] = generation;
+        QFile::remove(recoveryFile);
+    }
+}
+
+void AutoRecovery::scheduleSnapshot(MapDocument *mapDocument)
+{
+    if (mapDocument->fileName().isEmpty())
+        return;
+
+    mPendingDocuments.insert(mapDocument);
+    mSnapshotTimer.start();
+}
+
+void AutoRecovery::writeSnapshots()
+{
+    const auto pendingDocuments = std::move(mPendingDocuments);
+    mPendingDocuments.clear();
+
+    for (MapDocument *mapDocument : pendingDocuments)
+        writeSnapshot(mapDocument);
+}
+
+void AutoRecovery::writeSnapshot(MapDocument *mapDocument)
+{
+    const QString fileName = mapDocument->fileName();
+    if (fileName.isEmpty())
+        return;
+
+    const QString recoveryFile = recoveryFileName(fileName);
+    const int generation = ++mGeneration;
+
+    // When the document was edited back to its saved state, the snapshot is
+    // no longer needed
+    if (!mapDocument->isModified()) {
+        QMutexLocker locker(&mWriteState->mutex);
+        mWriteState->lastWrittenGeneration[recoveryFile] = generation;
+        QFile::remove(recoveryFile);
+        return;
+    }
+
+    // Serialization happens on this thread: the map references the live
+    // tilesets, which can be edited at any time (embedded tileset edits are
+    // themselves what schedules a snapshot), so a worker could read them
+    // mid-change. Only the file IO, which is where an editor stall is most
+    // likely, runs on the pool.
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+
+    MapWriter writer;
+    writer.writeMap(mapDocument->map(), &buffer,
+                    QFileInfo(recoveryFile).absolutePath());
+    buffer.close();
+
+    const QByteArray data = buffer.data();
+    const auto state = mWriteState;
+
+    JobScheduler::schedule(JobScheduler::NormalPriority,
+                           [=] (const JobScheduler::Token &) {
+        QMutexLocker locker(&state->mutex);
+        int &lastWritten = state->lastWrittenGeneration[recoveryFile];
+        if (generation <= lastWritten)
+            return;
+
+        lastWritten = generation;
+
+        SaveFile file(recoveryFile);
+        if (!file.open(QIODevice::WriteOnly))
+            return;
+
+        file.device()->write(data);
+
+        if (file.error() == QFileDevice::NoError)
+            file.commit();
+    });
+}
+
+} // namespace Tiled
+
+#include "moc_autorecovery.cpp"
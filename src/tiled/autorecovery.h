@@ -0,0 +1,94 @@
+/*
+ * autorecovery.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "mapdocument.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+
+#include <memory>
+
+namespace Tiled {
+
+class MapFormat;
+
+class DocumentManager;
+
+/**
+ * Keeps crash-recovery snapshots of modified map documents.
+ *
+ * Shortly after each edit, the current state of the map is serialized to a
+ * TMX snapshot in memory and written next to the map file on the worker
+ * thread pool. The snapshot is removed again when the document is saved or
+ * closed, so it only survives a crash.
+ *
+ * On the next start, restoreDocument() offers to open a snapshot that is
+ * newer than its map file in place of the map file, with the recovered
+ * changes showing up as unsaved changes.
+ */
+class AutoRecovery : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AutoRecovery(DocumentManager *documentManager);
+
+    /**
+     * The file the recovery snapshot for \a fileName is written to.
+     */
+    static QString recoveryFileName(const QString &fileName);
+
+    /**
+     * When a recovery snapshot newer than \a fileName exists, offers to
+     * restore it and returns the restored document when accepted. Returns
+     * null when there is nothing to restore or the offer was declined, in
+     * which case the file should be loaded normally.
+     */
+    static MapDocumentPtr restoreDocument(const QString &fileName,
+                                          MapFormat *format,
+                                          QWidget *parent);
+
+private:
+    void documentOpened(Document *document);
+    void documentSaved(Document *document);
+    void documentAboutToClose(Document *document);
+
+    void scheduleSnapshot(MapDocument *mapDocument);
+    void writeSnapshots();
+    void writeSnapshot(MapDocument *mapDocument);
+
+    QSet<MapDocument*> mPendingDocuments;
+    QTimer mSnapshotTimer;
+
+    // Guards against an older snapshot finishing after a newer one
+    struct WriteState {
+        QMutex mutex;
+        QHash<QString, int> lastWrittenGeneration;
+    };
+    std::shared_ptr<WriteState> mWriteState = std::make_shared<WriteState>();
+    int mGeneration = 0;
+};
+
+} // namespace Tiled
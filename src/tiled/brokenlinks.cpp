@@ -26,6 +26,8 @@
 #include "mainwindow.h"
 #include "map.h"
 #include "objectgroup.h"
+#include "projectmanager.h"
+#include "projectmodel.h"
 #include "replacetemplate.h"
 #include "replacetileset.h"
 #include "session.h"
@@ -98,6 +100,13 @@ BrokenLinksModel::BrokenLinksModel(QObject *parent)
     : QAbstractListModel(parent)
     , mDocument(nullptr)
 {
+    // Many change events can arrive for a single user action, so refreshes
+    // triggered by them are compressed into one rescan per event loop
+    // iteration
+    mRefreshTimer.setSingleShot(true);
+    mRefreshTimer.setInterval(0);
+    connect(&mRefreshTimer, &QTimer::timeout,
+            this, &BrokenLinksModel::refresh);
 }
 
 void BrokenLinksModel::setDocument(Document *document)
@@ -122,37 +131,40 @@ void BrokenLinksModel::setDocument(Document *document)
             connect(mapDocument, &MapDocument::tilesetRemoved,
                     this, &BrokenLinksModel::tilesetRemoved);
             connect(mapDocument, &MapDocument::objectTemplateReplaced,
-                    this, &BrokenLinksModel::refresh);
+                    this, &BrokenLinksModel::scheduleRefresh);
 
             for (const SharedTileset &tileset : mapDocument->map()->tilesets())
                 connectToTileset(tileset);
 
             connect(DocumentManager::instance(), &DocumentManager::templateTilesetReplaced,
-                    this, &BrokenLinksModel::refresh);
+                    this, &BrokenLinksModel::scheduleRefresh);
         } else if (auto tilesetDocument = qobject_cast<TilesetDocument*>(mDocument)) {
             connectToTileset(tilesetDocument->tileset());
         }
 
         connect(mDocument, &Document::ignoreBrokenLinksChanged,
-                this, &BrokenLinksModel::refresh);
+                this, &BrokenLinksModel::scheduleRefresh);
     }
 }
 
+void BrokenLinksModel::scheduleRefresh()
+{
+    mRefreshTimer.start();
+}
+
 void BrokenLinksModel::refresh()
 {
+    mRefreshTimer.stop();
+
     if (mDocument)
         mDocument->checkIssues();
 
-    bool brokenLinksBefore = hasBrokenLinks();
-
-    beginResetModel();
-
-    mBrokenLinks.clear();
+    QVector<BrokenLink> brokenLinks;
 
     if (mDocument && !mDocument->ignoreBrokenLinks()) {
         QSet<SharedTileset> processedTilesets;
 
-        auto processTileset = [this,&processedTilesets](const SharedTileset &tileset) {
+        auto processTileset = [&](const SharedTileset &tileset) {
             if (processedTilesets.contains(tileset))
                 return;
 
@@ -164,7 +176,7 @@ void BrokenLinksModel::refresh()
                         BrokenLink link;
                         link.type = TilesetTileImageSource;
                         link._tile = tile;
-                        mBrokenLinks.append(link);
+                        brokenLinks.append(link);
                     }
                 }
             } else {
@@ -172,7 +184,7 @@ void BrokenLinksModel::refresh()
                     BrokenLink link;
                     link.type = TilesetImageSource;
                     link._tileset = tileset.data();
-                    mBrokenLinks.append(link);
+                    brokenLinks.append(link);
                 }
             }
         };
@@ -183,7 +195,7 @@ void BrokenLinksModel::refresh()
                     BrokenLink link;
                     link.type = MapTilesetReference;
                     link._tileset = tileset.data();
-                    mBrokenLinks.append(link);
+                    brokenLinks.append(link);
                 } else {
                     processTileset(tileset);
                 }
@@ -220,14 +232,14 @@ void BrokenLinksModel::refresh()
                 BrokenLink link;
                 link.type = ObjectTemplateReference;
                 link._objectTemplate = objectTemplate;
-                mBrokenLinks.append(link);
+                brokenLinks.append(link);
             }
 
             for (const ObjectTemplate *objectTemplate : brokenTemplateTilesets) {
                 BrokenLink link;
                 link.type = ObjectTemplateTilesetReference;
                 link._objectTemplate = objectTemplate;
-                mBrokenLinks.append(link);
+                brokenLinks.append(link);
             }
 
         } else if (auto tilesetDocument = qobject_cast<TilesetDocument*>(mDocument)) {
@@ -235,9 +247,18 @@ void BrokenLinksModel::refresh()
         }
     }
 
+    // Most change events leave the set of broken links untouched, in which
+    // case the views don't need to repaint at all
+    if (brokenLinks == mBrokenLinks)
+        return;
+
+    const bool brokenLinksBefore = hasBrokenLinks();
+
+    beginResetModel();
+    mBrokenLinks = std::move(brokenLinks);
     endResetModel();
 
-    bool brokenLinksAfter = hasBrokenLinks();
+    const bool brokenLinksAfter = hasBrokenLinks();
     if (brokenLinksBefore != brokenLinksAfter)
         emit hasBrokenLinksChanged(brokenLinksAfter);
 }
@@ -319,7 +340,7 @@ void BrokenLinksModel::tileImageSourceChanged(Tile *tile)
             int linkIndex = it - mBrokenLinks.begin();
             emit dataChanged(index(linkIndex, 0), index(linkIndex, 1));
         } else {
-            refresh(); // lazy way of adding an entry for this tile
+            scheduleRefresh(); // lazy way of adding an entry for this tile
         }
     } else if (it != mBrokenLinks.end()) {
         removeLink(it - mBrokenLinks.begin());
@@ -332,20 +353,20 @@ void BrokenLinksModel::tilesetChanged(Tileset *tileset)
 
     // This may mean either the tileset properties changed or tiles were
     // added/removed from the tileset. Easiest to just refresh entirely.
-    refresh();
+    scheduleRefresh();
 }
 
 void BrokenLinksModel::tilesetAdded(int index, Tileset *tileset)
 {
     Q_UNUSED(index)
     connectToTileset(tileset->sharedFromThis());
-    refresh();
+    scheduleRefresh();
 }
 
 void BrokenLinksModel::tilesetRemoved(Tileset *tileset)
 {
     disconnectFromTileset(tileset->sharedFromThis());
-    refresh();
+    scheduleRefresh();
 }
 
 void BrokenLinksModel::connectToTileset(const SharedTileset &tileset)
@@ -497,6 +518,19 @@ LinkFixer::LinkFixer(Document *document)
 {
 }
 
+/**
+ * Looks for a file in the project folders with the same file name as the
+ * given \a filePath, returning its path only when there is exactly one
+ * candidate. Allows fixing links without prompting the user.
+ */
+static QString uniqueProjectFile(const QString &filePath)
+{
+    auto projectModel = ProjectManager::instance()->projectModel();
+    const QStringList candidates =
+            projectModel->filesWithFileName(QFileInfo(filePath).fileName());
+    return candidates.size() == 1 ? candidates.first() : QString();
+}
+
 void LinkFixer::tryFixLinks(const QVector<BrokenLink> &links)
 {
     if (links.isEmpty())
@@ -518,8 +552,19 @@ void LinkFixer::tryFixLinks(const QVector<BrokenLink> &links)
         }
     }
 
+    // First resolve links that match a unique file in the project folders
+    QVector<BrokenLink> remainingLinks;
+    for (const BrokenLink &link : links) {
+        const QString projectFile = uniqueProjectFile(link.filePath());
+        if (projectFile.isEmpty() || !tryFixLink(link, projectFile))
+            remainingLinks.append(link);
+    }
+
+    if (remainingLinks.isEmpty())
+        return;
+
     // todo: fix text on the button (says "Locate File")
-    static QString startingLocation = QFileInfo(links.first().filePath()).path();
+    static QString startingLocation = QFileInfo(remainingLinks.first().filePath()).path();
     const QString directory = QFileDialog::getExistingDirectory(MainWindow::instance(),
                                                                 BrokenLinksWidget::tr("Locate Directory for Files"),
                                                                 startingLocation);
@@ -540,7 +585,7 @@ void LinkFixer::tryFixLinks(const QVector<BrokenLink> &links)
 #endif
 
     // See if any of the links we're looking for is located in this directory
-    for (const BrokenLink &link : links) {
+    for (const BrokenLink &link : remainingLinks) {
         const QString fileName = QFileInfo(link.filePath()).fileName();
         if (files.contains(fileName))
             if (!tryFixLink(link, dir.filePath(fileName)))
@@ -562,7 +607,12 @@ void LinkFixer::tryFixLink(const BrokenLink &link)
             return;
         }
 
-        QUrl newFileUrl = locateImage(QFileInfo(link.filePath()).fileName());
+        QUrl newFileUrl;
+        const QString projectFile = uniqueProjectFile(link.filePath());
+        if (!projectFile.isEmpty())
+            newFileUrl = QUrl::fromLocalFile(projectFile);
+        else
+            newFileUrl = locateImage(QFileInfo(link.filePath()).fileName());
         if (newFileUrl.isEmpty())
             return;
 
@@ -699,14 +749,18 @@ QString LinkFixer::locateObjectTemplate()
 
 void LinkFixer::tryFixMapTilesetReference(const SharedTileset &tileset)
 {
-    QString fileName = locateTileset();
+    QString fileName = uniqueProjectFile(tileset->fileName());
+    if (fileName.isEmpty())
+        fileName = locateTileset();
     if (!fileName.isEmpty())
         tryFixMapTilesetReference(tileset, fileName);
 }
 
 void LinkFixer::tryFixObjectTemplateReference(const ObjectTemplate *objectTemplate)
 {
-    QString fileName = locateObjectTemplate();
+    QString fileName = uniqueProjectFile(objectTemplate->fileName());
+    if (fileName.isEmpty())
+        fileName = locateObjectTemplate();
     if (!fileName.isEmpty())
         tryFixObjectTemplateReference(objectTemplate, fileName);
 }
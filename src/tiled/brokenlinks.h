@@ -24,6 +24,7 @@
 #include "tileset.h"
 
 #include <QAbstractListModel>
+#include <QTimer>
 #include <QWidget>
 
 class QAbstractButton;
@@ -62,6 +63,13 @@ struct BrokenLink {
     QString filePath() const;
     Tileset *tileset() const;
     const ObjectTemplate *objectTemplate() const;
+
+    bool operator==(const BrokenLink &other) const
+    {
+        // All union members are pointers, so comparing one of them covers
+        // whichever member the type says is active
+        return type == other.type && _tileset == other._tileset;
+    }
 };
 
 
@@ -77,6 +85,7 @@ public:
     Document *document() const;
 
     void refresh();
+    void scheduleRefresh();
     bool hasBrokenLinks() const;
 
     const BrokenLink &brokenLink(int index) const;
@@ -103,6 +112,7 @@ private:
 
     Document *mDocument;
     QVector<BrokenLink> mBrokenLinks;
+    QTimer mRefreshTimer;
 };
 
 
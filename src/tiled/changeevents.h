@@ -76,6 +76,7 @@ class ObjectsChangeEvent : public ChangeEvent
 public:
     enum ObjectProperty {
         ClassProperty           = 1 << 0,
+        CustomProperties        = 1 << 1,
     };
 
     ObjectsChangeEvent(const QList<Object *> &objects, int properties)
@@ -208,14 +209,16 @@ public:
 class MapObjectEvent : public ChangeEvent
 {
 public:
-    MapObjectEvent(Type type, ObjectGroup *objectGroup, int index)
+    MapObjectEvent(Type type, ObjectGroup *objectGroup, int index, int count = 1)
         : ChangeEvent(type)
         , objectGroup(objectGroup)
         , index(index)
+        , count(count)
     {}
 
     ObjectGroup *objectGroup;
     int index;
+    int count;      // number of consecutive objects, starting at index
 };
 
 class TilesetChangeEvent : public ChangeEvent
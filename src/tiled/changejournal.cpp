@@ -0,0 +1,185 @@
+/*
+ * changejournal.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "changejournal.h"
+
+#include "changeevents.h"
+#include "grouplayer.h"
+#include "mapdocument.h"
+#include "objectgroup.h"
+
+namespace Tiled {
+
+// Keep a bounded window of changes; consumers that fall further behind are
+// expected to do a full sync.
+static const int MaxJournalEntries = 4096;
+
+static QJsonArray toJson(const QRegion &region)
+{
+    QJsonArray rects;
+    for (const QRect &rect : region) {
+        rects.append(QJsonArray { rect.x(), rect.y(),
+                                  rect.width(), rect.height() });
+    }
+    return rects;
+}
+
+static QJsonArray objectIds(const QList<MapObject *> &objects)
+{
+    QJsonArray ids;
+    for (const MapObject *object : objects)
+        ids.append(object->id());
+    return ids;
+}
+
+ChangeJournal::ChangeJournal(MapDocument *mapDocument)
+    : QObject(mapDocument)
+{
+    connect(mapDocument, &Document::changed,
+            this, &ChangeJournal::documentChanged);
+    connect(mapDocument, &MapDocument::regionEdited,
+            this, &ChangeJournal::regionEdited);
+    connect(mapDocument, &MapDocument::layerAdded,
+            this, &ChangeJournal::layerAdded);
+    connect(mapDocument, &MapDocument::layerRemoved,
+            this, &ChangeJournal::layerRemoved);
+}
+
+QJsonArray ChangeJournal::changesSince(qint64 sequence) const
+{
+    QJsonArray changes;
+
+    const qint64 first = qMax(sequence, oldestSequence());
+    for (qint64 seq = first; seq < mNextSequence; ++seq)
+        changes.append(mEntries.at(int(seq - oldestSequence())));
+
+    return changes;
+}
+
+void ChangeJournal::documentChanged(const ChangeEvent &change)
+{
+    switch (change.type) {
+    case ChangeEvent::MapChanged: {
+        auto &e = static_cast<const MapChangeEvent&>(change);
+        append({ { QLatin1String("type"), QLatin1String("map-changed") },
+                 { QLatin1String("property"), int(e.property) } });
+        break;
+    }
+    case ChangeEvent::LayerChanged:
+    case ChangeEvent::TileLayerChanged:
+    case ChangeEvent::ImageLayerChanged: {
+        auto &e = static_cast<const LayerChangeEvent&>(change);
+        append({ { QLatin1String("type"), QLatin1String("layer-changed") },
+                 { QLatin1String("layer"), e.layer->id() },
+                 { QLatin1String("properties"), e.properties } });
+        break;
+    }
+    case ChangeEvent::ObjectGroupChanged: {
+        auto &e = static_cast<const ObjectGroupChangeEvent&>(change);
+        append({ { QLatin1String("type"), QLatin1String("layer-changed") },
+                 { QLatin1String("layer"), e.objectGroup->id() },
+                 { QLatin1String("properties"), e.properties } });
+        break;
+    }
+    case ChangeEvent::MapObjectAdded: {
+        auto &e = static_cast<const MapObjectEvent&>(change);
+        QJsonArray ids;
+        for (int i = 0; i < e.count; ++i)
+            ids.append(e.objectGroup->objectAt(e.index + i)->id());
+        append({ { QLatin1String("type"), QLatin1String("objects-added") },
+                 { QLatin1String("layer"), e.objectGroup->id() },
+                 { QLatin1String("ids"), ids } });
+        break;
+    }
+    case ChangeEvent::MapObjectAboutToBeRemoved: {
+        // Recorded before removal, since afterwards the objects are gone
+        auto &e = static_cast<const MapObjectEvent&>(change);
+        QJsonArray ids;
+        for (int i = 0; i < e.count; ++i)
+            ids.append(e.objectGroup->objectAt(e.index + i)->id());
+        append({ { QLatin1String("type"), QLatin1String("objects-removed") },
+                 { QLatin1String("layer"), e.objectGroup->id() },
+                 { QLatin1String("ids"), ids } });
+        break;
+    }
+    case ChangeEvent::MapObjectsAdded: {
+        auto &e = static_cast<const MapObjectsEvent&>(change);
+        append({ { QLatin1String("type"), QLatin1String("objects-added") },
+                 { QLatin1String("ids"), objectIds(e.mapObjects) } });
+        break;
+    }
+    case ChangeEvent::MapObjectsAboutToBeRemoved: {
+        auto &e = static_cast<const MapObjectsEvent&>(change);
+        append({ { QLatin1String("type"), QLatin1String("objects-removed") },
+                 { QLatin1String("ids"), objectIds(e.mapObjects) } });
+        break;
+    }
+    case ChangeEvent::MapObjectsChanged: {
+        auto &e = static_cast<const MapObjectsChangeEvent&>(change);
+        append({ { QLatin1String("type"), QLatin1String("objects-changed") },
+                 { QLatin1String("ids"), objectIds(e.mapObjects) },
+                 { QLatin1String("properties"), int(e.properties) } });
+        break;
+    }
+    default:
+        // Tileset and Wang set changes concern separate documents and are
+        // not part of the map journal
+        break;
+    }
+}
+
+void ChangeJournal::regionEdited(const QRegion &region, TileLayer *layer)
+{
+    append({ { QLatin1String("type"), QLatin1String("region-edited") },
+             { QLatin1String("layer"), layer->id() },
+             { QLatin1String("rects"), toJson(region) } });
+}
+
+void ChangeJournal::layerAdded(Layer *layer)
+{
+    QJsonObject entry {
+        { QLatin1String("type"), QLatin1String("layer-added") },
+        { QLatin1String("layer"), layer->id() },
+        { QLatin1String("name"), layer->name() },
+        { QLatin1String("layerType"), int(layer->layerType()) },
+        { QLatin1String("index"), layer->siblingIndex() },
+    };
+    if (GroupLayer *parent = layer->parentLayer())
+        entry.insert(QLatin1String("parent"), parent->id());
+    append(entry);
+}
+
+void ChangeJournal::layerRemoved(Layer *layer)
+{
+    append({ { QLatin1String("type"), QLatin1String("layer-removed") },
+             { QLatin1String("layer"), layer->id() } });
+}
+
+void ChangeJournal::append(QJsonObject entry)
+{
+    entry.insert(QLatin1String("seq"), mNextSequence);
+    ++mNextSequence;
+
+    mEntries.append(std::move(entry));
+    if (mEntries.size() > MaxJournalEntries)
+        mEntries.remove(0, mEntries.size() - MaxJournalEntries);
+}
+
+} // namespace Tiled
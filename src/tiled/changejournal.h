@@ -0,0 +1,86 @@
+/*
+ * changejournal.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QVector>
+
+namespace Tiled {
+
+class Layer;
+class TileLayer;
+
+class ChangeEvent;
+class MapDocument;
+
+/**
+ * Records the changes made to a map document as an append-only journal of
+ * compact JSON entries, each tagged with an increasing sequence number.
+ *
+ * External tooling (usually through a script extension) can poll
+ * changesSince() with the last sequence number it has seen and process only
+ * the parts of the map that actually changed, instead of re-parsing a full
+ * export. Edited tile regions are recorded as rectangles; the current cell
+ * contents are read from the document when the delta is consumed.
+ *
+ * The journal is bounded. When a requested sequence number has already been
+ * dropped, the first returned entry has a higher sequence number than
+ * requested and the consumer should fall back to a full sync.
+ */
+class ChangeJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ChangeJournal(MapDocument *mapDocument);
+
+    /**
+     * The sequence number that will be assigned to the next change. A
+     * consumer that is up-to-date with the document can start from here.
+     */
+    qint64 nextSequence() const { return mNextSequence; }
+
+    /**
+     * The oldest sequence number still retained by the journal.
+     */
+    qint64 oldestSequence() const { return mNextSequence - mEntries.size(); }
+
+    /**
+     * Returns the journal entries with a sequence number of at least
+     * \a sequence, oldest first.
+     */
+    QJsonArray changesSince(qint64 sequence) const;
+
+private:
+    void documentChanged(const ChangeEvent &change);
+    void regionEdited(const QRegion &region, TileLayer *layer);
+    void layerAdded(Layer *layer);
+    void layerRemoved(Layer *layer);
+
+    void append(QJsonObject entry);
+
+    QVector<QJsonObject> mEntries;
+    qint64 mNextSequence = 0;
+};
+
+} // namespace Tiled
@@ -315,7 +315,7 @@ void ReplaceObjectsWithTemplate::redo()
         object->syncWithTemplate();
     }
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, MapObject::AllProperties));
+    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, MapObject::AllProperties | MapObject::TemplateProperty));
 }
 
 void ReplaceObjectsWithTemplate::undo()
@@ -323,5 +323,5 @@ void ReplaceObjectsWithTemplate::undo()
     for (int i = 0; i < mMapObjects.size(); ++i)
         mMapObjects.at(i)->copyPropertiesFrom(mOldMapObjects.at(i));
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, MapObject::AllProperties));
+    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, MapObject::AllProperties | MapObject::TemplateProperty));
 }
@@ -75,11 +75,25 @@ ChangeProperties::ChangeProperties(Document *document,
                                    Object *object,
                                    const Properties &newProperties,
                                    QUndoCommand *parent)
+    : ChangeProperties(document, kind,
+                       QList<Object*> { object },
+                       QVector<Properties> { newProperties },
+                       parent)
+{
+}
+
+ChangeProperties::ChangeProperties(Document *document,
+                                   const QString &kind,
+                                   const QList<Object *> &objects,
+                                   const QVector<Properties> &newProperties,
+                                   QUndoCommand *parent)
     : QUndoCommand(parent)
     , mDocument(document)
-    , mObject(object)
+    , mObjects(objects)
     , mNewProperties(newProperties)
 {
+    Q_ASSERT(objects.size() == newProperties.size());
+
     if (kind.isEmpty()) {
         setText(QCoreApplication::translate("Undo Commands",
                                             "Change Properties"));
@@ -103,7 +117,7 @@ ChangeProperties *ChangeProperties::clone(QUndoCommand *parent) const
 {
     auto clone = new ChangeProperties(mDocument,
                                       QString(),
-                                      mObject,
+                                      mObjects,
                                       mNewProperties,
                                       parent);
     clone->setText(text());
@@ -112,9 +126,19 @@ ChangeProperties *ChangeProperties::clone(QUndoCommand *parent) const
 
 void ChangeProperties::swapProperties()
 {
-    const Properties oldProperties = mObject->properties();
-    mDocument->setProperties(mObject, mNewProperties);
-    mNewProperties = oldProperties;
+    const bool bulk = mObjects.size() > 1;
+    if (bulk)
+        mDocument->beginBulkEdit();
+
+    for (int i = 0; i < mObjects.size(); ++i) {
+        Object *object = mObjects.at(i);
+        const Properties oldProperties = object->properties();
+        mDocument->setProperties(object, mNewProperties.at(i));
+        mNewProperties[i] = oldProperties;
+    }
+
+    if (bulk)
+        mDocument->endBulkEdit();
 }
 
 
@@ -154,19 +178,33 @@ SetProperty::SetProperty(Document *document,
 
 void SetProperty::undo()
 {
+    const bool bulk = mObjects.size() > 1;
+    if (bulk)
+        mDocument->beginBulkEdit();
+
     for (int i = 0; i < mObjects.size(); ++i) {
         if (mProperties.at(i).existed)
             mDocument->setProperty(mObjects.at(i), mName, mProperties.at(i).previousValue);
         else
             mDocument->removeProperty(mObjects.at(i), mName);
     }
+
+    if (bulk)
+        mDocument->endBulkEdit();
 }
 
 void SetProperty::redo()
 {
+    const bool bulk = mObjects.size() > 1;
+    if (bulk)
+        mDocument->beginBulkEdit();
+
     const QList<Object*> &objects = mObjects;
     for (Object *obj : objects)
         mDocument->setPropertyMember(obj, mPath, mValue);
+
+    if (bulk)
+        mDocument->endBulkEdit();
 }
 
 bool SetProperty::mergeWith(const QUndoCommand *other)
@@ -206,15 +244,29 @@ RemoveProperty::RemoveProperty(Document *document,
 
 void RemoveProperty::undo()
 {
+    const bool bulk = mObjects.size() > 1;
+    if (bulk)
+        mDocument->beginBulkEdit();
+
     for (int i = 0; i < mObjects.size(); ++i)
         mDocument->setProperty(mObjects.at(i), mName, mPreviousValues.at(i));
+
+    if (bulk)
+        mDocument->endBulkEdit();
 }
 
 void RemoveProperty::redo()
 {
+    const bool bulk = mObjects.size() > 1;
+    if (bulk)
+        mDocument->beginBulkEdit();
+
     const QList<Object*> &objects = mObjects;
     for (Object *obj : objects)
         mDocument->removeProperty(obj, mName);
+
+    if (bulk)
+        mDocument->endBulkEdit();
 }
 
 
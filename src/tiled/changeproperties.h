@@ -24,6 +24,7 @@
 #include "object.h"
 #include "undocommands.h"
 
+#include <QList>
 #include <QString>
 #include <QVector>
 
@@ -72,6 +73,22 @@ public:
                      const Properties &newProperties,
                      QUndoCommand *parent = nullptr);
 
+    /**
+     * Constructs a 'Change Properties' command affecting multiple objects,
+     * each getting its own new properties. The changes are applied in one
+     * pass and announced with a single aggregated change event.
+     *
+     * @param document      the document owning the objects
+     * @param kind          the kind of properties (Map, Layer, Object, etc.)
+     * @param objects       the objects of which the properties should be changed
+     * @param newProperties the new properties for each object
+     */
+    ChangeProperties(Document *document,
+                     const QString &kind,
+                     const QList<Object*> &objects,
+                     const QVector<Properties> &newProperties,
+                     QUndoCommand *parent = nullptr);
+
     void undo() override;
     void redo() override;
 
@@ -81,8 +98,8 @@ private:
     void swapProperties();
 
     Document *mDocument;
-    Object *mObject;
-    Properties mNewProperties;
+    QList<Object*> mObjects;
+    QVector<Properties> mNewProperties;
 };
 
 class SetProperty : public QUndoCommand
@@ -0,0 +1,146 @@
+/*
+ * chunkedoperation.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "chunkedoperation.h"
+
+#include "mainwindow.h"
+
+#include <QCoreApplication>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QProgressBar>
+#include <QStatusBar>
+#include <QToolButton>
+
+using namespace Tiled;
+
+// How long an operation may run before the progress bar appears, and the
+// interval at which the event loop is pumped once it has
+static constexpr int showDelayMs = 250;
+static constexpr int sliceMs = 50;
+
+ChunkedOperation::ChunkedOperation(const QString &text, int stepCount)
+    : mText(text)
+    , mStepCount(stepCount)
+{
+    mRunTime.start();
+    mSliceTime.start();
+}
+
+ChunkedOperation::~ChunkedOperation()
+{
+    if (mProgressWidget) {
+        qApp->removeEventFilter(this);
+        if (auto mainWindow = MainWindow::maybeInstance())
+            mainWindow->statusBar()->removeWidget(mProgressWidget);
+        delete mProgressWidget;
+    }
+}
+
+/**
+ * Marks the current chunk as done. Returns whether the operation should
+ * continue; when it returns false the operation was cancelled.
+ */
+bool ChunkedOperation::advance()
+{
+    ++mStep;
+
+    if (!mProgressWidget && mStep < mStepCount && mRunTime.hasExpired(showDelayMs))
+        showProgress();
+
+    if (mProgressWidget && mSliceTime.hasExpired(sliceMs)) {
+        mProgressBar->setValue(mStep);
+        QCoreApplication::processEvents();
+        mSliceTime.restart();
+    }
+
+    return !mCancelled;
+}
+
+void ChunkedOperation::showProgress()
+{
+    auto mainWindow = MainWindow::maybeInstance();
+    if (!mainWindow)
+        return;
+
+    mProgressWidget = new QWidget;
+    auto layout = new QHBoxLayout(mProgressWidget);
+    layout->setContentsMargins(6, 0, 6, 0);
+
+    mProgressBar = new QProgressBar(mProgressWidget);
+    mProgressBar->setRange(0, mStepCount);
+    mProgressBar->setValue(mStep);
+    mProgressBar->setMaximumWidth(150);
+
+    auto cancelButton = new QToolButton(mProgressWidget);
+    cancelButton->setText(tr("Cancel"));
+    connect(cancelButton, &QToolButton::clicked,
+            this, [this] { mCancelled = true; });
+
+    layout->addWidget(new QLabel(mText, mProgressWidget));
+    layout->addWidget(mProgressBar);
+    layout->addWidget(cancelButton);
+
+    // A permanent widget, so that it isn't obscured by status messages
+    mainWindow->statusBar()->addPermanentWidget(mProgressWidget);
+
+    qApp->installEventFilter(this);
+}
+
+/**
+ * While the progress widget is shown, blocks user input that isn't aimed at
+ * it, so that the document can't change under the partially prepared
+ * operation. Escape cancels, like it does for a modal progress dialog.
+ */
+bool ChunkedOperation::eventFilter(QObject *receiver, QEvent *event)
+{
+    // Only filter the widget-level delivery; input events are seen first on
+    // the window, and swallowing them there would also starve the cancel
+    // button
+    auto widget = qobject_cast<QWidget*>(receiver);
+    if (!widget)
+        return false;
+
+    switch (event->type()) {
+    case QEvent::KeyPress:
+        if (static_cast<QKeyEvent*>(event)->key() == Qt::Key_Escape) {
+            mCancelled = true;
+            return true;
+        }
+        [[fallthrough]];
+    case QEvent::KeyRelease:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::Wheel:
+    case QEvent::ShortcutOverride:
+    case QEvent::TabletPress:
+    case QEvent::TabletRelease:
+    case QEvent::Close:
+        if (widget == mProgressWidget || mProgressWidget->isAncestorOf(widget))
+            return false;
+        return true;
+    default:
+        return false;
+    }
+}
+
+#include "moc_chunkedoperation.cpp"
@@ -0,0 +1,78 @@
+/*
+ * chunkedoperation.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "tilededitor_global.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+
+class QProgressBar;
+
+namespace Tiled {
+
+/**
+ * Runs a long edit operation on the UI thread in cooperatively scheduled
+ * chunks.
+ *
+ * Operations like offsetting or resizing a huge map prepare their changes
+ * step by step, calling advance() after each step. Once the operation has
+ * been running for a noticeable while, a progress bar with a cancel button
+ * appears in the status bar and the event loop is pumped between chunks, so
+ * the UI keeps painting and the operation can be cancelled at any chunk
+ * boundary. User input that isn't aimed at the cancel button is blocked
+ * while the operation runs, so the document can't change under the
+ * partially prepared operation.
+ *
+ * When advance() returns false the operation was cancelled and the caller
+ * should discard the work prepared so far instead of applying it. Since an
+ * operation only modifies the document once its prepared undo command is
+ * pushed, rolling back amounts to deleting that command.
+ */
+class TILED_EDITOR_EXPORT ChunkedOperation : public QObject
+{
+    Q_OBJECT
+
+public:
+    ChunkedOperation(const QString &text, int stepCount);
+    ~ChunkedOperation() override;
+
+    bool advance();
+
+    bool isCancelled() const { return mCancelled; }
+
+protected:
+    bool eventFilter(QObject *receiver, QEvent *event) override;
+
+private:
+    void showProgress();
+
+    QString mText;
+    int mStepCount;
+    int mStep = 0;
+    bool mCancelled = false;
+    QElapsedTimer mRunTime;
+    QElapsedTimer mSliceTime;
+    QWidget *mProgressWidget = nullptr;
+    QProgressBar *mProgressBar = nullptr;
+};
+
+} // namespace Tiled
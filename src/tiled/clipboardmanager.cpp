@@ -21,6 +21,7 @@
 #include "clipboardmanager.h"
 
 #include "addremovemapobject.h"
+#include "compression.h"
 #include "map.h"
 #include "mapdocument.h"
 #include "mapobject.h"
@@ -183,6 +184,16 @@ bool ClipboardManager::copySelection(const MapDocument &mapDocument)
         // Resolve the set of tilesets used by the created map
         copyMap.addTilesets(copyMap.usedTilesets());
 
+        // Clipboard data is transient, so favor fast compression of the tile
+        // data over the source map's storage settings. Huge selections would
+        // otherwise produce enormous snippets and take seconds to serialize.
+        // The snippet remains a regular TMX document, readable by other
+        // tools.
+        copyMap.setLayerDataFormat(compressionSupported(Zstandard)
+                                   ? Map::Base64Zstandard
+                                   : Map::Base64Zlib);
+        copyMap.setCompressionLevel(1);
+
         setMap(copyMap);
         return true;
     }
@@ -259,6 +259,11 @@ void Document::setProperty(Object *object,
 
     object->setProperty(name, value);
 
+    if (mBulkEditDepth > 0) {
+        addBulkEditObject(object);
+        return;
+    }
+
     if (hadProperty)
         emit propertyChanged(object, name);
     else
@@ -287,15 +292,66 @@ void Document::setPropertyMember(Object *object,
 void Document::setProperties(Object *object, const Properties &properties)
 {
     object->setProperties(properties);
+
+    if (mBulkEditDepth > 0) {
+        addBulkEditObject(object);
+        return;
+    }
+
     emit propertiesChanged(object);
 }
 
 void Document::removeProperty(Object *object, const QString &name)
 {
     object->removeProperty(name);
+
+    if (mBulkEditDepth > 0) {
+        addBulkEditObject(object);
+        return;
+    }
+
     emit propertyRemoved(object, name);
 }
 
+/**
+ * Starts a bulk edit, during which the per-object property change
+ * notifications are suspended. The objects whose properties change are
+ * collected instead, and announced with a single ObjectsChangeEvent when the
+ * outermost bulk edit ends. Used to avoid flooding the views when a script
+ * modifies the properties of many objects at once.
+ *
+ * Bulk edits nest.
+ */
+void Document::beginBulkEdit()
+{
+    ++mBulkEditDepth;
+}
+
+void Document::endBulkEdit()
+{
+    Q_ASSERT(mBulkEditDepth > 0);
+    if (--mBulkEditDepth > 0)
+        return;
+
+    if (mBulkEditObjects.isEmpty())
+        return;
+
+    const QList<Object*> objects = std::move(mBulkEditObjects);
+    mBulkEditObjects.clear();
+    mBulkEditObjectSet.clear();
+
+    emit changed(ObjectsChangeEvent(objects, ObjectsChangeEvent::CustomProperties));
+}
+
+void Document::addBulkEditObject(Object *object)
+{
+    if (mBulkEditObjectSet.contains(object))
+        return;
+
+    mBulkEditObjectSet.insert(object);
+    mBulkEditObjects.append(object);
+}
+
 void Document::setIgnoreBrokenLinks(bool ignoreBrokenLinks)
 {
     if (mIgnoreBrokenLinks == ignoreBrokenLinks)
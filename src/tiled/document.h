@@ -23,7 +23,9 @@
 #include "properties.h"
 
 #include <QDateTime>
+#include <QList>
 #include <QObject>
+#include <QSet>
 #include <QSharedPointer>
 #include <QString>
 #include <QVariant>
@@ -108,6 +110,9 @@ public:
     void setProperties(Object *object, const Properties &properties);
     void removeProperty(Object *object, const QString &name);
 
+    void beginBulkEdit();
+    void endBulkEdit();
+
     bool ignoreBrokenLinks() const;
     void setIgnoreBrokenLinks(bool ignoreBrokenLinks);
 
@@ -168,6 +173,8 @@ private:
     void currentObjectDocumentChanged(const ChangeEvent &change);
     void currentObjectDocumentDestroyed();
 
+    void addBulkEditObject(Object *object);
+
     const DocumentType mType;
 
     QString mFileName;
@@ -179,6 +186,11 @@ private:
     bool mChangedOnDisk = false;
     bool mIgnoreBrokenLinks = false;
 
+    // Objects with changed properties collected during a bulk edit
+    int mBulkEditDepth = 0;
+    QList<Object*> mBulkEditObjects;
+    QSet<Object*> mBulkEditObjectSet;
+
     static QHash<QString, Document*> sDocumentInstances;
 };
 
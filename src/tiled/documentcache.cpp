@@ -0,0 +1,132 @@
+/*
+ * documentcache.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "documentcache.h"
+
+#include "map.h"
+#include "mapdocument.h"
+#include "maptovariantconverter.h"
+#include "varianttomapconverter.h"
+
+#include <QCborValue>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace Tiled {
+
+static const quint32 CacheMagic = 0x544D4331;   // "TMC1"
+static const quint32 CacheVersion = 1;
+
+/**
+ * Returns the cache file for the given map file, or an empty string when
+ * there is no writable cache location. The name is derived from the map's
+ * path only, so a newer state overwrites the previous entry.
+ */
+static QString cacheFileName(const QString &fileName)
+{
+    static const QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheLocation.isEmpty())
+        return QString();
+
+    const QString pathHash = QString::fromLatin1(
+                QCryptographicHash::hash(QFileInfo(fileName).absoluteFilePath().toUtf8(),
+                                         QCryptographicHash::Sha1).toHex());
+
+    return cacheLocation + QLatin1String("/parsed-maps/") + pathHash
+            + QLatin1String(".cbor");
+}
+
+void DocumentCache::store(const MapDocument &document)
+{
+    const QString fileName = document.fileName();
+    if (fileName.isEmpty() || document.isModified())
+        return;
+
+    const QFileInfo fileInfo(fileName);
+    if (!fileInfo.exists())
+        return;
+
+    const QString cacheFile = cacheFileName(fileName);
+    if (cacheFile.isEmpty())
+        return;
+
+    if (!QDir().mkpath(QFileInfo(cacheFile).path()))
+        return;
+
+    MapToVariantConverter converter;
+    const QVariant variant = converter.toVariant(*document.map(), fileInfo.dir());
+    const QByteArray cbor = QCborValue::fromVariant(variant).toCbor();
+
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream << CacheMagic;
+    stream << CacheVersion;
+    stream << fileInfo.size();
+    stream << fileInfo.lastModified().toMSecsSinceEpoch();
+    stream.writeRawData(cbor.constData(), cbor.size());
+
+    file.commit();
+}
+
+std::unique_ptr<Map> DocumentCache::load(const QString &fileName)
+{
+    const QString cacheFile = cacheFileName(fileName);
+    if (cacheFile.isEmpty())
+        return nullptr;
+
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint64 size = 0;
+    qint64 lastModified = 0;
+    stream >> magic >> version >> size >> lastModified;
+
+    if (magic != CacheMagic || version != CacheVersion)
+        return nullptr;
+
+    // The entry only applies as long as the source file is unchanged
+    const QFileInfo fileInfo(fileName);
+    if (fileInfo.size() != size
+            || fileInfo.lastModified().toMSecsSinceEpoch() != lastModified)
+        return nullptr;
+
+    const QByteArray cbor = file.readAll();
+
+    QCborParserError error;
+    const QCborValue value = QCborValue::fromCbor(cbor, &error);
+    if (error.error != QCborError::NoError)
+        return nullptr;
+
+    VariantToMapConverter converter;
+    return converter.toMap(value.toVariant(), fileInfo.dir());
+}
+
+} // namespace Tiled
@@ -0,0 +1,61 @@
+/*
+ * documentcache.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+
+#include <memory>
+
+namespace Tiled {
+
+class Map;
+class MapDocument;
+
+/**
+ * Persists the parsed state of map documents across editor restarts, so
+ * that restoring a session can skip re-parsing the map files.
+ *
+ * On clean shutdown, the map of each unmodified document is written to the
+ * user's cache location in binary form (CBOR of the same variant structure
+ * used by the JSON format). When a map is loaded again, a cache entry that
+ * still matches the file on disk is decoded instead of parsing the file,
+ * which skips the text parsing entirely. Entries are validated against the
+ * source file's size and modification time and are simply ignored when
+ * stale, so the cache never changes what a load returns.
+ */
+class DocumentCache
+{
+public:
+    /**
+     * Writes the parsed state of the given document to the cache. Does
+     * nothing for documents with unsaved changes, since their in-memory
+     * state no longer matches the file the cache is validated against.
+     */
+    static void store(const MapDocument &document);
+
+    /**
+     * Returns the cached map for the given file, or null when there is no
+     * cache entry that matches the current file contents.
+     */
+    static std::unique_ptr<Map> load(const QString &fileName);
+};
+
+} // namespace Tiled
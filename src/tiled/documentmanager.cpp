@@ -23,22 +23,27 @@
 
 #include "abstracttool.h"
 #include "adjusttileindexes.h"
+#include "autorecovery.h"
 #include "brokenlinks.h"
 #include "containerhelpers.h"
 #include "editableasset.h"
 #include "editor.h"
 #include "filechangedwarning.h"
 #include "filesystemwatcher.h"
+#include "jobscheduler.h"
 #include "logginginterface.h"
 #include "map.h"
 #include "mapdocument.h"
 #include "mapeditor.h"
 #include "mapformat.h"
+#include "mapobjectmodel.h"
+#include "mapreloader.h"
 #include "maprenderer.h"
 #include "mapview.h"
 #include "noeditorwidget.h"
 #include "preferences.h"
 #include "projectmanager.h"
+#include "scriptedfileformat.h"
 #include "session.h"
 #include "tabbar.h"
 #include "tilesetdocument.h"
@@ -146,6 +151,8 @@ DocumentManager::DocumentManager(QObject *parent)
     connect(Preferences::instance(), &Preferences::aboutToSwitchSession,
             this, &DocumentManager::updateSession);
 
+    new AutoRecovery(this);
+
     OpenFile::activated = [this] (const OpenFile &open) {
         openFile(open.file);
     };
@@ -167,7 +174,7 @@ DocumentManager::DocumentManager(QObject *parent)
 
     JumpToObject::activated = [this] (const JumpToObject &jump) {
         if (auto mapDocument = openMapFile(jump.mapFile)) {
-            if (auto object = mapDocument->map()->findObjectById(jump.objectId)) {
+            if (auto object = mapDocument->mapObjectModel()->findObjectById(jump.objectId)) {
                 mapDocument->focusMapObjectRequested(object);
                 mapDocument->setSelectedObjects({ object });
             }
@@ -203,7 +210,7 @@ DocumentManager::DocumentManager(QObject *parent)
                 }
                 break;
             case Object::MapObjectType:
-                if (auto object = mapDocument->map()->findObjectById(select.id)) {
+                if (auto object = mapDocument->mapObjectModel()->findObjectById(select.id)) {
                     mapDocument->focusMapObjectRequested(object);
                     mapDocument->setSelectedObjects({ object });
                     obj = object;
@@ -584,6 +591,19 @@ int DocumentManager::insertDocument(int index, const DocumentPtr &document)
     if (auto *mapDocument = qobject_cast<MapDocument*>(documentPtr)) {
         connect(mapDocument, &MapDocument::tilesetAdded, this, &DocumentManager::tilesetAdded);
         connect(mapDocument, &MapDocument::tilesetRemoved, this, &DocumentManager::tilesetRemoved);
+        connect(mapDocument, &MapDocument::backgroundSaveFinished,
+                this, [this, mapDocument] (bool success, const QString &error) {
+            if (success) {
+                emit documentSaved(mapDocument);
+                return;
+            }
+
+            // The document may have been closed while its save was running;
+            // the error still needs reporting, since the file was not written
+            if (findDocument(mapDocument) != -1)
+                switchToDocument(mapDocument);
+            QMessageBox::critical(mWidget->window(), QCoreApplication::translate("Tiled::MainWindow", "Error Saving File"), error);
+        });
     }
 
     if (auto *tilesetDocument = qobject_cast<TilesetDocument*>(documentPtr))
@@ -651,7 +671,10 @@ DocumentPtr DocumentManager::loadDocument(const QString &fileName,
     DocumentPtr document;
 
     if (MapFormat *mapFormat = qobject_cast<MapFormat*>(fileFormat)) {
-        document = MapDocument::load(fileName, mapFormat, error);
+        document = AutoRecovery::restoreDocument(fileName, mapFormat,
+                                                 mWidget->window());
+        if (!document)
+            document = MapDocument::load(fileName, mapFormat, error);
     } else if (TilesetFormat *tilesetFormat = qobject_cast<TilesetFormat*>(fileFormat)) {
         // It could be, that we have already loaded this tileset while loading some map.
         if (auto tilesetDocument = findTilesetDocument(fileName)) {
@@ -667,6 +690,12 @@ DocumentPtr DocumentManager::loadDocument(const QString &fileName,
 /**
  * Save the given document with the given file name.
  *
+ * Map documents are saved in the background from a snapshot of the map, so
+ * the editor stays responsive while a large map is serialized. In that case
+ * a return value of true means the save was started; errors are reported
+ * through a dialog once the save finishes and documentSaved is emitted only
+ * on success.
+ *
  * @return <code>true</code> on success, <code>false</code> on failure
  */
 bool DocumentManager::saveDocument(Document *document, const QString &fileName)
@@ -676,6 +705,15 @@ bool DocumentManager::saveDocument(Document *document, const QString &fileName)
 
     emit documentAboutToBeSaved(document);
 
+    if (auto mapDocument = qobject_cast<MapDocument*>(document)) {
+        // Scripted formats can only be used on the main thread
+        MapFormat *writerFormat = mapDocument->writerFormat();
+        if (writerFormat && !qobject_cast<ScriptedMapFormat*>(writerFormat)) {
+            mapDocument->saveAsync(fileName);
+            return true;
+        }
+    }
+
     QString error;
     if (!document->save(fileName, &error)) {
         switchToDocument(document);
@@ -908,9 +946,15 @@ bool DocumentManager::reloadCurrentDocument()
  * history and current selections. Will not ask the user whether to save
  * any changes!
  *
- * Returns whether the document loaded successfully.
+ * Map documents are read on the global thread pool and swapped in once
+ * the result arrives, so that reloads triggered by external tools don't
+ * block the UI. Pass \a synchronous to force the swap to have happened
+ * before this function returns, as the scripting API requires.
+ *
+ * Returns whether the document loaded successfully (when synchronous) or
+ * whether the reload was initiated.
  */
-bool DocumentManager::reloadDocumentAt(int index)
+bool DocumentManager::reloadDocumentAt(int index, bool synchronous)
 {
     const auto oldDocument = mDocuments.at(index);
     QString error;
@@ -920,36 +964,37 @@ bool DocumentManager::reloadDocumentAt(int index)
         if (!readerFormat)
             return false;
 
-        // TODO: Consider fixing the reload to avoid recreating the MapDocument
-        auto newDocument = MapDocument::load(oldDocument->fileName(),
-                                             readerFormat,
-                                             &error);
-        if (!newDocument) {
-            emit reloadError(tr("%1:\n\n%2").arg(oldDocument->fileName(), error));
-            return false;
-        }
-
-        // Save the document state, to ensure the new document will match it
-        static_cast<MapEditor*>(editor(Document::MapDocumentType))->saveDocumentState(mapDocument.data());
-
-        // Replace old tab
-        const bool isCurrent = index == mTabBar->currentIndex();
-        insertDocument(index, newDocument);
-        if (isCurrent) {
-            switchToDocument(index);
+        // Scripted formats can only be used on the main thread
+        if (qobject_cast<ScriptedMapFormat*>(readerFormat))
+            synchronous = true;
+
+        if (synchronous) {
+            // TODO: Consider fixing the reload to avoid recreating the MapDocument
+            auto newDocument = MapDocument::load(oldDocument->fileName(),
+                                                 readerFormat,
+                                                 &error);
+            if (!newDocument) {
+                emit reloadError(tr("%1:\n\n%2").arg(oldDocument->fileName(), error));
+                return false;
+            }
 
-            if (mBrokenLinksModel->hasBrokenLinks())
-                mBrokenLinksWidget->show();
+            return replaceReloadedDocument(index, mapDocument, newDocument);
         }
-        closeDocumentAt(index + 1);
 
-        checkTilesetColumns(newDocument.data());
+        // Reloads are processed one at a time, since file format instances
+        // keep state and are not safe to use from multiple threads at once.
+        if (!mPendingReloads.contains(mapDocument)) {
+            mPendingReloads.append(mapDocument);
+            if (mPendingReloads.size() == 1)
+                startNextPendingReload();
+        }
+        return true;
 
     } else if (auto tilesetDocument = qobject_cast<TilesetDocument*>(oldDocument)) {
         if (tilesetDocument->isEmbedded()) {
             // For embedded tilesets, we need to reload the map
             index = findDocument(tilesetDocument->mapDocuments().first());
-            if (!reloadDocumentAt(index))
+            if (!reloadDocumentAt(index, synchronous))
                 return false;
         } else if (!tilesetDocument->reload(&error)) {
             emit reloadError(tr("%1:\n\n%2").arg(oldDocument->fileName(), error));
@@ -965,6 +1010,109 @@ bool DocumentManager::reloadDocumentAt(int index)
     return true;
 }
 
+/**
+ * Reads the map of the first pending reload on the global thread pool.
+ *
+ * The new document is created and swapped in on the main thread once the
+ * read has finished, after which the next pending reload is started.
+ */
+void DocumentManager::startNextPendingReload()
+{
+    while (!mPendingReloads.isEmpty()) {
+        const MapDocumentPtr mapDocument = mPendingReloads.first();
+
+        // The document may have been closed or saved under a different
+        // format in the meantime
+        auto readerFormat = mapDocument->readerFormat();
+        if (mDocuments.indexOf(mapDocument) == -1 || !readerFormat) {
+            mPendingReloads.removeFirst();
+            continue;
+        }
+
+        const QString fileName = mapDocument->fileName();
+        const QPointer<DocumentManager> self = this;
+
+        JobScheduler::schedule(JobScheduler::NormalPriority,
+                               [=] (const JobScheduler::Token &) {
+            auto map = std::make_shared<std::unique_ptr<Map>>(
+                        readerFormat->read(fileName));
+            const QString error = *map ? QString() : readerFormat->errorString();
+
+            QMetaObject::invokeMethod(self, [=] {
+                Q_ASSERT(mPendingReloads.first() == mapDocument);
+                mPendingReloads.removeFirst();
+
+                const int index = mDocuments.indexOf(mapDocument);
+                if (index != -1) {
+                    if (!*map) {
+                        emit reloadError(tr("%1:\n\n%2").arg(fileName, error));
+                    } else {
+                        (*map)->fileName = fileName;
+
+                        MapDocumentPtr newDocument = MapDocumentPtr::create(std::move(*map));
+                        newDocument->setReaderFormat(readerFormat);
+                        if (readerFormat->hasCapabilities(MapFormat::Write))
+                            newDocument->setWriterFormat(readerFormat);
+
+                        replaceReloadedDocument(index, mapDocument, newDocument);
+                    }
+                }
+
+                startNextPendingReload();
+            }, Qt::QueuedConnection);
+        });
+        return;
+    }
+}
+
+/**
+ * Replaces \a oldDocument at \a index with the freshly loaded
+ * \a newDocument, carrying over the view state (selected layers, camera
+ * position) through the saved document state.
+ */
+bool DocumentManager::replaceReloadedDocument(int index,
+                                              const MapDocumentPtr &oldDocument,
+                                              const MapDocumentPtr &newDocument)
+{
+    // When the reloaded map is structurally close to the current one, apply
+    // it to the existing document as a set of small changes. This keeps the
+    // scene, models, selections and view state alive, so external edits that
+    // touch a single layer don't pay for rebuilding everything.
+    MapReloader reloader(oldDocument.data());
+    if (reloader.apply(*newDocument->map())) {
+        oldDocument->undoStack()->clear();
+        oldDocument->setChangedOnDisk(false);
+
+        checkTilesetColumns(oldDocument.data());
+
+        if (!isDocumentChangedOnDisk(currentDocument()))
+            mFileChangedWarning->setVisible(false);
+
+        return true;
+    }
+
+    // Save the document state, to ensure the new document will match it
+    static_cast<MapEditor*>(editor(Document::MapDocumentType))->saveDocumentState(oldDocument.data());
+
+    // Replace old tab
+    const bool isCurrent = index == mTabBar->currentIndex();
+    insertDocument(index, newDocument);
+    if (isCurrent) {
+        switchToDocument(index);
+
+        if (mBrokenLinksModel->hasBrokenLinks())
+            mBrokenLinksWidget->show();
+    }
+    closeDocumentAt(index + 1);
+
+    checkTilesetColumns(newDocument.data());
+
+    if (!isDocumentChangedOnDisk(currentDocument()))
+        mFileChangedWarning->setVisible(false);
+
+    return true;
+}
+
 void DocumentManager::currentIndexChanged()
 {
     auto document = currentDocument();
@@ -1121,6 +1269,12 @@ void DocumentManager::fileChanged(const QString &fileName)
     if (QFileInfo(fileName).lastModified() == document->lastSaved())
         return;
 
+    // A background save commits the file before its completion updates
+    // lastSaved on this thread, so the watcher may fire in between
+    if (auto mapDocument = qobject_cast<MapDocument*>(document.data()))
+        if (mapDocument->isSaving())
+            return;
+
     // Automatically reload when there are no unsaved changes
     if (!isDocumentModified(document.data())) {
         reloadDocumentAt(index);
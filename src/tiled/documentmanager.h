@@ -120,7 +120,7 @@ public:
     void closeDocumentAt(int index);
 
     bool reloadCurrentDocument();
-    bool reloadDocumentAt(int index);
+    bool reloadDocumentAt(int index, bool synchronous = false);
 
     void checkTilesetColumns(MapDocument *mapDocument);
     bool checkTilesetColumns(TilesetDocument *tilesetDocument);
@@ -216,6 +216,11 @@ private:
     void addToTilesetDocument(const SharedTileset &tileset, MapDocument *mapDocument);
     void removeFromTilesetDocument(const SharedTileset &tileset, MapDocument *mapDocument);
 
+    void startNextPendingReload();
+    bool replaceReloadedDocument(int index,
+                                 const MapDocumentPtr &oldDocument,
+                                 const MapDocumentPtr &newDocument);
+
     void updateSession() const;
 
     MapDocument *openMapFile(const QString &path);
@@ -223,6 +228,10 @@ private:
 
     QVector<DocumentPtr> mDocuments;
     QMap<QString, WorldDocument*> mWorldDocuments;
+
+    // Documents whose reload is pending; the first entry is being read on
+    // the global thread pool
+    QVector<MapDocumentPtr> mPendingReloads;
     TilesetDocumentsModel *mTilesetDocumentsModel;
 
     // Pointer becomes null when deleted as part of the UI, to prevent double-deletion
@@ -97,9 +97,17 @@ QJSValue EditableAsset::macro(const QString &text, QJSValue callback)
     if (stack)
         undoStack()->beginMacro(text);
 
+    // Suspend per-object property change notifications for the duration of
+    // the macro, which scripts are expected to use for bulk edits.
+    if (auto doc = document())
+        doc->beginBulkEdit();
+
     QJSValue result = callback.call();
     ScriptManager::instance().checkError(result);
 
+    if (auto doc = document())
+        doc->endBulkEdit();
+
     if (stack)
         undoStack()->endMacro();
 
@@ -25,6 +25,7 @@
 #include "addremovetileset.h"
 #include "automappingmanager.h"
 #include "changeevents.h"
+#include "changejournal.h"
 #include "changemapproperty.h"
 #include "changeselectedarea.h"
 #include "editablegrouplayer.h"
@@ -463,6 +464,64 @@ Tiled::ScriptImage *EditableMap::toImage(QSize size)
     return new ScriptImage(miniMapRenderer.render(imageSize, renderFlags));
 }
 
+/**
+ * Returns a read-only snapshot of this map.
+ *
+ * The snapshot is detached from the document, so it is unaffected by any
+ * edits made after it was taken and scripts can traverse it without worrying
+ * about the map changing under their feet. Since the tile layer data is
+ * copy-on-write, taking a snapshot is cheap even for large maps.
+ */
+EditableMap *EditableMap::snapshot() const
+{
+    auto editable = new EditableMap(map()->clone());
+    editable->mReadOnly = true;
+    QQmlEngine::setObjectOwnership(editable, QQmlEngine::JavaScriptOwnership);
+    return editable;
+}
+
+/**
+ * Returns a detached copy of this map reduced to the given \a tileArea.
+ *
+ * Tile layers are clipped to the area and objects outside of it are dropped,
+ * so writing the result with a map format stays fast regardless of the size
+ * of this map. Useful for exporting a small, playable part of a large map.
+ */
+EditableMap *EditableMap::clipped(const QRect &tileArea) const
+{
+    auto editable = new EditableMap(map()->clipped(tileArea));
+    QQmlEngine::setObjectOwnership(editable, QQmlEngine::JavaScriptOwnership);
+    return editable;
+}
+
+/**
+ * Returns the sequence number that the next change to this map will get in
+ * the change journal. Pass it to changesSince() later to retrieve only the
+ * changes made in between.
+ *
+ * Only maps open in the editor keep a journal; for detached maps 0 is
+ * returned.
+ */
+double EditableMap::changeSequence() const
+{
+    if (auto document = mapDocument())
+        return document->changeJournal()->nextSequence();
+    return 0;
+}
+
+/**
+ * Returns the journal entries recorded since the given sequence number,
+ * oldest first. The journal is bounded: when the first returned entry has a
+ * higher sequence number than requested, changes were dropped and a full
+ * sync is needed.
+ */
+QJsonArray EditableMap::changesSince(double sequence) const
+{
+    if (auto document = mapDocument())
+        return document->changeJournal()->changesSince(qint64(sequence));
+    return {};
+}
+
 QPointF EditableMap::screenToTile(qreal x, qreal y) const
 {
     return renderer()->screenToTileCoords(x, y);
@@ -25,6 +25,8 @@
 #include "regionvaluetype.h"
 #include "scriptimage.h"
 
+#include <QJsonArray>
+
 namespace Tiled {
 
 class MapObject;
@@ -80,7 +82,8 @@ public:
         Base64Gzip      = 2,
         Base64Zlib      = 3,
         Base64Zstandard = 4,
-        CSV             = 5
+        CSV             = 5,
+        DeltaVLQ        = 6
     };
     Q_ENUM(LayerDataFormat)
 
@@ -164,6 +167,12 @@ public:
 
     Q_INVOKABLE Tiled::ScriptImage *toImage(QSize size = QSize());
 
+    Q_INVOKABLE Tiled::EditableMap *snapshot() const;
+    Q_INVOKABLE Tiled::EditableMap *clipped(const QRect &tileArea) const;
+
+    Q_INVOKABLE double changeSequence() const;
+    Q_INVOKABLE QJsonArray changesSince(double sequence) const;
+
     Q_INVOKABLE QPointF screenToTile(qreal x, qreal y) const;
     Q_INVOKABLE QPointF screenToTile(const QPointF &position) const;
     Q_INVOKABLE QPointF tileToScreen(qreal x, qreal y) const;
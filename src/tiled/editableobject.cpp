@@ -25,7 +25,9 @@
 #include "editablemanager.h"
 #include "editablemapobject.h"
 #include "map.h"
+#include "mapdocument.h"
 #include "mapobject.h"
+#include "mapobjectmodel.h"
 #include "objectgroup.h"
 #include "scriptmanager.h"
 
@@ -129,7 +131,14 @@ QVariant EditableObject::toScript(const QVariant &value) const
         MapObject *referencedObject = nullptr;
 
         if (auto map = mapForObject(object())) {
-            referencedObject = map->findObjectById(ref.id);
+            // Use the document's object index when there is one, since the
+            // linear search over the map gets expensive for scripts that
+            // resolve many references.
+            auto mapDocument = qobject_cast<MapDocument*>(document());
+            if (mapDocument && mapDocument->map() == map)
+                referencedObject = mapDocument->mapObjectModel()->findObjectById(ref.id);
+            else
+                referencedObject = map->findObjectById(ref.id);
         } else if (object()->typeId() == Object::MapObjectType) {
             if (auto objectGroup = static_cast<MapObject*>(object())->objectGroup()) {
                 for (auto mapObject : *objectGroup) {
@@ -24,6 +24,7 @@
 #include "changeobjectgroupproperties.h"
 #include "editablemanager.h"
 #include "editablemap.h"
+#include "mapobjectmodel.h"
 #include "scriptmanager.h"
 
 #include <QCoreApplication>
@@ -117,8 +118,14 @@ void EditableObjectGroup::insertObjectAt(int index, EditableMapObject *editableM
 
     // Avoid duplicate IDs by resetting when needed
     if (Map *map = objectGroup()->map()) {
-        if (mapObject->id() != 0 && map->findObjectById(mapObject->id()))
-            mapObject->resetId();
+        if (mapObject->id() != 0) {
+            auto mapDocument = qobject_cast<MapDocument*>(document());
+            const MapObject *existing = mapDocument && mapDocument->map() == map
+                    ? mapDocument->mapObjectModel()->findObjectById(mapObject->id())
+                    : map->findObjectById(mapObject->id());
+            if (existing)
+                mapObject->resetId();
+        }
     }
 
     if (auto doc = document()) {
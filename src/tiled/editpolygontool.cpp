@@ -49,8 +49,105 @@
 #include <QMenu>
 #include <QUndoStack>
 
+#include <cmath>
 #include <cstdlib>
 
+namespace Tiled {
+
+/**
+ * A uniform grid over the segments of a polygon, used to answer
+ * nearest-segment queries without measuring the distance to every segment.
+ *
+ * The index keeps a reference to the polygon it was built from. Since
+ * QPolygonF is implicitly shared, the index is valid exactly as long as the
+ * object's polygon still refers to the same data, which also serves as the
+ * invalidation check after geometry changes.
+ */
+class SegmentIndex
+{
+public:
+    SegmentIndex(const QPolygonF &polygon, bool closed)
+        : mPolygon(polygon)
+        , mClosed(closed)
+        , mBounds(polygon.boundingRect())
+    {
+        const int segmentCount = this->segmentCount();
+
+        mCols = qBound(1, int(std::ceil(std::sqrt(double(segmentCount)))), 256);
+        mRows = mCols;
+        mCellWidth = qMax<qreal>(mBounds.width() / mCols, 0.000001);
+        mCellHeight = qMax<qreal>(mBounds.height() / mRows, 0.000001);
+        mCells.resize(mCols * mRows);
+        mLastVisit.fill(-1, segmentCount);
+
+        for (int i = 0; i < segmentCount; ++i) {
+            const QRectF bounds = QRectF(mPolygon.at(i),
+                                         mPolygon.at((i + 1) % mPolygon.size())).normalized();
+            forEachCell(bounds, [i](QVector<int> &cell) { cell.append(i); });
+        }
+    }
+
+    bool matches(const QPolygonF &polygon, bool closed) const
+    {
+        return mClosed == closed
+                && mPolygon.size() == polygon.size()
+                && mPolygon.constData() == polygon.constData();
+    }
+
+    /**
+     * Calls \a visit with the index and line of each segment that might lie
+     * within \a distance of \a point. Each segment is reported at most once.
+     */
+    template <typename Visitor>
+    void visitSegmentsNear(QPointF point, qreal distance, Visitor visit)
+    {
+        const QRectF area(point.x() - distance, point.y() - distance,
+                          distance * 2, distance * 2);
+
+        ++mVisit;
+
+        forEachCell(area, [&](QVector<int> &cell) {
+            for (const int i : std::as_const(cell)) {
+                if (mLastVisit[i] == mVisit)
+                    continue;
+                mLastVisit[i] = mVisit;
+                visit(i, QLineF(mPolygon.at(i),
+                                mPolygon.at((i + 1) % mPolygon.size())));
+            }
+        });
+    }
+
+private:
+    int segmentCount() const
+    { return mClosed ? mPolygon.size() : mPolygon.size() - 1; }
+
+    template <typename Callback>
+    void forEachCell(const QRectF &bounds, Callback callback)
+    {
+        const int x1 = qBound(0, int((bounds.left() - mBounds.left()) / mCellWidth), mCols - 1);
+        const int x2 = qBound(0, int((bounds.right() - mBounds.left()) / mCellWidth), mCols - 1);
+        const int y1 = qBound(0, int((bounds.top() - mBounds.top()) / mCellHeight), mRows - 1);
+        const int y2 = qBound(0, int((bounds.bottom() - mBounds.top()) / mCellHeight), mRows - 1);
+
+        for (int y = y1; y <= y2; ++y)
+            for (int x = x1; x <= x2; ++x)
+                callback(mCells[y * mCols + x]);
+    }
+
+    const QPolygonF mPolygon;
+    const bool mClosed;
+    const QRectF mBounds;
+    int mCols;
+    int mRows;
+    qreal mCellWidth;
+    qreal mCellHeight;
+    QVector<QVector<int>> mCells;
+    QVector<int> mLastVisit;
+    int mVisit = -1;
+};
+
+} // namespace Tiled
+
 using namespace Tiled;
 
 static TransformMapObjects *createChangePolygonsCommand(Document *document,
@@ -125,6 +222,8 @@ void EditPolygonTool::deactivate(MapScene *scene)
     while (i.hasNext())
         qDeleteAll(i.next().value());
 
+    mSegmentIndexes.clear();
+
     mHoveredHandle = nullptr;
     mHoveredSegment.clear();
     mHandles.clear();
@@ -412,6 +511,14 @@ void EditPolygonTool::updateHandles()
     if (mClickedSegment && !selection.contains(mClickedSegment.object))
         mClickedSegment.clear();
 
+    // Drop cached segment indexes for objects that are no longer selected
+    QMutableHashIterator<MapObject*, std::shared_ptr<SegmentIndex>> si(mSegmentIndexes);
+    while (si.hasNext()) {
+        si.next();
+        if (!selection.contains(si.key()))
+            si.remove();
+    }
+
     MapRenderer *renderer = mapDocument()->renderer();
 
     for (MapObject *object : selection) {
@@ -452,6 +559,9 @@ void EditPolygonTool::updateHandles()
 
 void EditPolygonTool::objectsAboutToBeRemoved(const QList<MapObject *> &objects)
 {
+    for (MapObject *object : objects)
+        mSegmentIndexes.remove(object);
+
     if (mAction == Moving) {
         // Make sure we're not going to try to still change these objects.
         // TODO: In addition to avoiding crashes, it would also be good to
@@ -1103,10 +1213,9 @@ void EditPolygonTool::updateHover(const QPointF &scenePos, QGraphicsSceneMouseEv
                 const QPointF localMousePixelCoords = mousePixelCoords - object->position();
 
                 const QPolygonF &polygon = object->polygon();
-                const int end = object->shape() == MapObject::Polygon ? polygon.size(): polygon.size() - 1;
+                const bool closed = object->shape() == MapObject::Polygon;
 
-                for (int i = 0; i < end; ++i) {
-                    const QLineF line(polygon.at(i), polygon.at((i + 1) % polygon.size()));
+                const auto visitSegment = [&](int i, const QLineF &line) {
                     QPointF nearestPointOnLine;
                     const qreal distance = distanceOfPointToLine(line, localMousePixelCoords, nearestPointOnLine);
                     if (distance < hoverDistance && distance < minDistance) {
@@ -1115,6 +1224,19 @@ void EditPolygonTool::updateHover(const QPointF &scenePos, QGraphicsSceneMouseEv
                         hoveredSegment.index = i;
                         hoveredSegment.nearestPointOnLine = nearestPointOnLine;
                     }
+                };
+
+                // Small polygons are cheaper to scan than to index
+                if (polygon.size() < 64) {
+                    const int end = closed ? polygon.size() : polygon.size() - 1;
+                    for (int i = 0; i < end; ++i)
+                        visitSegment(i, QLineF(polygon.at(i), polygon.at((i + 1) % polygon.size())));
+                } else {
+                    auto &index = mSegmentIndexes[object];
+                    if (!index || !index->matches(polygon, closed))
+                        index = std::make_shared<SegmentIndex>(polygon, closed);
+
+                    index->visitSegmentsNear(localMousePixelCoords, hoverDistance, visitSegment);
                 }
             }
         }
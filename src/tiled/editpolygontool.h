@@ -37,6 +37,8 @@ class SelectionRectangle;
 /**
  * A tool that allows dragging around the points of a polygon.
  */
+class SegmentIndex;
+
 class EditPolygonTool : public AbstractObjectTool
 {
     Q_OBJECT
@@ -139,6 +141,9 @@ private:
 
     /// The list of handles associated with each selected map object
     QHash<MapObject*, QList<PointHandle*> > mHandles;
+
+    /// Cached segment grids for nearest-segment queries on large polygons
+    QHash<MapObject*, std::shared_ptr<SegmentIndex>> mSegmentIndexes;
     QSet<PointHandle*> mSelectedHandles;
     QSet<PointHandle*> mHighlightedHandles;
 };
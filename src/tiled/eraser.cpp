@@ -104,11 +104,8 @@ void Eraser::doErase(bool continuation)
     QRegion globalEraseRegion(eraseArea());
     QPoint tilePos = tilePosition();
 
-    if (continuation) {
-        const QVector<QPoint> points = pointsOnLine(mLastTilePos, tilePos);
-        for (const QPoint &p : points)
-            globalEraseRegion |= QRegion(p.x(), p.y(), 1, 1);
-    }
+    if (continuation)
+        globalEraseRegion |= lineRegion(mLastTilePos, tilePos);
     mLastTilePos = tilePos;
 
     QList<QPair<QRegion, TileLayer*>> erasedRegions;
@@ -30,6 +30,7 @@
 #include "minimaprenderer.h"
 #include "objectgroup.h"
 #include "objectselectionitem.h"
+#include "pngwriter.h"
 #include "preferences.h"
 #include "session.h"
 #include "tilelayer.h"
@@ -38,6 +39,9 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QImageWriter>
+#include <QSaveFile>
+#include <QThread>
+#include <QtConcurrent>
 
 using namespace Tiled;
 
@@ -113,6 +117,56 @@ static bool smoothTransform(qreal scale)
     return scale != qreal(1) && scale < qreal(2);
 }
 
+/**
+ * Renders the map in horizontal bands, compressing finished bands on worker
+ * threads while the next band renders, and streaming the result to disk.
+ * This bounds memory usage to a handful of bands, where rendering the whole
+ * image at once takes gigabytes for huge maps.
+ */
+static bool exportStreamedPng(const QString &fileName,
+                              const MiniMapRenderer &miniMapRenderer,
+                              MiniMapRenderer::RenderFlags renderFlags,
+                              QSize imageSize)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    PngWriter writer(&file);
+    if (!writer.writeHeader(imageSize))
+        return false;
+
+    // Aim for bands of around 16 megapixels (64 MB of pixel data)
+    const int bandHeight = qBound(1, (16 * 1024 * 1024) / qMax(1, imageSize.width()),
+                                  imageSize.height());
+    const int bandCount = (imageSize.height() + bandHeight - 1) / bandHeight;
+    const int maxPendingBands = QThread::idealThreadCount() + 1;
+
+    QVector<QFuture<PngWriter::CompressedBand>> pendingBands;
+
+    for (int i = 0; i < bandCount; ++i) {
+        const int y = i * bandHeight;
+        const int height = qMin(bandHeight, imageSize.height() - y);
+        const bool last = i == bandCount - 1;
+
+        QImage band(imageSize.width(), height, QImage::Format_ARGB32_Premultiplied);
+        if (band.isNull())
+            return false;
+
+        miniMapRenderer.renderToImage(band, imageSize, QPoint(0, y), renderFlags);
+
+        pendingBands.append(QtConcurrent::run([band, last] {
+            return PngWriter::compressBand(band, last);
+        }));
+
+        while (pendingBands.size() >= maxPendingBands || (last && !pendingBands.isEmpty()))
+            if (!writer.writeCompressedBand(pendingBands.takeFirst().result()))
+                return false;
+    }
+
+    return writer.finish() && file.commit();
+}
+
 void ExportAsImageDialog::accept()
 {
     const QString fileName = mUi->fileNameEdit->text();
@@ -184,6 +238,25 @@ void ExportAsImageDialog::accept()
     if (session::useCurrentScale)
         imageSize *= mCurrentScale;
 
+    // For huge PNG exports, render and compress the image band by band
+    // instead of as a single giant image.
+    const qint64 memory = qint64(imageSize.width()) * imageSize.height() * 4;
+    const bool streamPng = memory > 256 * 1024 * 1024
+            && fileName.endsWith(QLatin1String(".png"), Qt::CaseInsensitive);
+
+    if (streamPng) {
+        if (!exportStreamedPng(fileName, miniMapRenderer, renderFlags, imageSize)) {
+            QMessageBox::critical(this,
+                                  tr("Export as Image"),
+                                  tr("Failed to export the image to:\n%1").arg(fileName));
+            return;
+        }
+
+        mPath = QFileInfo(fileName).path();
+        QDialog::accept();
+        return;
+    }
+
     try {
         QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
 
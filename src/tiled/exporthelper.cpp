@@ -43,12 +43,18 @@ FileFormat::Options ExportHelper::formatOptions() const
  * \a savingTileset means that this tileset is being saved to its own file
  * rather saved as part of a map. In this case, we want to apply some export
  * options that we would skip for external tilesets.
+ *
+ * When the target \a format is known, export settings are only stripped when
+ * that format would actually write them back out. A null format is treated
+ * conservatively, as if it preserves them.
  */
 SharedTileset ExportHelper::prepareExportTileset(const SharedTileset &tileset,
-                                                 bool savingTileset) const
+                                                 bool savingTileset,
+                                                 const FileFormat *format) const
 {
     const bool hasExportSettings = !(tileset->exportFileName.isEmpty()
-                                     && tileset->exportFormat.isEmpty());
+                                     && tileset->exportFormat.isEmpty())
+            && (!format || format->hasCapabilities(FileFormat::PreservesExportTarget));
 
     if (!mOptions && !hasExportSettings)
         return tileset;
@@ -67,8 +73,16 @@ SharedTileset ExportHelper::prepareExportTileset(const SharedTileset &tileset,
     }
 
     // Either needs to be embedded or is already embedded and we may need to
-    // make other changes to the tileset
-    SharedTileset exportTileset = tileset->clone();
+    // make other changes to the tileset. Only take a full clone when tile
+    // data is going to be modified; otherwise a snapshot sharing the tile
+    // data suffices, which keeps batch exports from duplicating every tile
+    // of every map in memory.
+    const bool modifiesTiles =
+            mOptions.testFlag(Preferences::DetachTemplateInstances) ||
+            mOptions.testFlag(Preferences::ResolveObjectTypesAndProperties);
+
+    SharedTileset exportTileset = modifiesTiles ? tileset->clone()
+                                                : tileset->snapshot();
     exportTileset->setOriginalTileset(tileset);
 
     // We don't want to save the export options in the exported file
@@ -94,10 +108,20 @@ SharedTileset ExportHelper::prepareExportTileset(const SharedTileset &tileset,
     return exportTileset;
 }
 
-const Map *ExportHelper::prepareExportMap(const Map *map, std::unique_ptr<Map> &exportMap) const
+/**
+ * Prepares a map for export.
+ *
+ * When no copy is needed, the live \a map is returned directly, otherwise a
+ * copy with the export options applied is stored in \a exportMap. Passing the
+ * target \a format allows skipping the copy for formats that don't write back
+ * the map's export settings.
+ */
+const Map *ExportHelper::prepareExportMap(const Map *map, std::unique_ptr<Map> &exportMap,
+                                          const FileFormat *format) const
 {
     const bool hasExportSettings = !(map->exportFileName.isEmpty()
-                                     && map->exportFormat.isEmpty());
+                                     && map->exportFormat.isEmpty())
+            && (!format || format->hasCapabilities(FileFormat::PreservesExportTarget));
 
     // If no export options are active, return the same map
     if (!(mOptions & ~Preferences::ExportMinimized) && !hasExportSettings)
@@ -132,7 +156,7 @@ const Map *ExportHelper::prepareExportMap(const Map *map, std::unique_ptr<Map> &
 
     const auto tilesets = exportMap->tilesets();    // needs a copy
     for (const SharedTileset &tileset : tilesets) {
-        auto exportTileset = prepareExportTileset(tileset, false);
+        auto exportTileset = prepareExportTileset(tileset, false, format);
         if (exportTileset != tileset)
             exportMap->replaceTileset(tileset, exportTileset);
     }
@@ -43,9 +43,11 @@ public:
     FileFormat::Options formatOptions() const;
 
     SharedTileset prepareExportTileset(const SharedTileset &tileset,
-                                       bool savingTileset = true) const;
+                                       bool savingTileset = true,
+                                       const FileFormat *format = nullptr) const;
 
-    const Map *prepareExportMap(const Map *map, std::unique_ptr<Map> &exportMap) const;
+    const Map *prepareExportMap(const Map *map, std::unique_ptr<Map> &exportMap,
+                                const FileFormat *format = nullptr) const;
 
 private:
     void resolveProperties(Object *object) const;
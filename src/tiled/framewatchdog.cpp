@@ -0,0 +1,173 @@
+/*
+ * framewatchdog.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framewatchdog.h"
+
+#include "logginginterface.h"
+
+#include <QDockWidget>
+#include <QEvent>
+
+#include <algorithm>
+
+namespace Tiled {
+
+// A dispatch that takes longer than this is reported as a violation. Chosen
+// as a full frame at 60 Hz, so everything reported is a guaranteed missed
+// frame regardless of display.
+static constexpr qint64 FrameBudgetNSecs = 16 * 1000 * 1000;
+
+// Rate limit for individual violation reports
+static constexpr qint64 SpikeReportIntervalMSecs = 250;
+
+FrameWatchdog::FrameWatchdog()
+{
+    mTimingEnabled = qEnvironmentVariableIsSet("TILED_FRAME_WATCHDOG");
+    mDeferDockUpdates = qEnvironmentVariableIsSet("TILED_DEFER_DOCK_UPDATES");
+    mSinceSpikeReport.start();
+}
+
+FrameWatchdog &FrameWatchdog::instance()
+{
+    static FrameWatchdog watchdog;
+    return watchdog;
+}
+
+void FrameWatchdog::setInteracting(bool interacting)
+{
+    if (mInteracting == interacting)
+        return;
+
+    mInteracting = interacting;
+
+    if (!interacting) {
+        if (mTimingEnabled)
+            reportSummary();
+
+        // Deliver the dock repaints that were held back
+        const auto deferredWidgets = std::move(mDeferredWidgets);
+        mDeferredWidgets.clear();
+        for (const QPointer<QWidget> &widget : deferredWidgets)
+            if (widget)
+                widget->update();
+    }
+}
+
+/**
+ * Returns whether the given widget is part of a dock widget. Dock contents
+ * are the non-critical part of the UI during interaction: the map view and
+ * its overlays live in the central widget.
+ */
+static bool isDockContent(QWidget *widget)
+{
+    for (QWidget *w = widget; w; w = w->parentWidget())
+        if (qobject_cast<QDockWidget*>(w))
+            return true;
+    return false;
+}
+
+bool FrameWatchdog::shouldDefer(QObject *receiver, QEvent *event)
+{
+    if (!mDeferDockUpdates || !mInteracting)
+        return false;
+
+    if (event->type() != QEvent::Paint || !receiver->isWidgetType())
+        return false;
+
+    QWidget *widget = static_cast<QWidget*>(receiver);
+    if (!isDockContent(widget))
+        return false;
+
+    // Skipping the paint leaves the widget's previous contents on screen;
+    // an update is scheduled when the interaction ends
+    mDeferredWidgets.append(widget);
+    return true;
+}
+
+void FrameWatchdog::recordDispatch(QObject *receiver, QEvent *event, qint64 nsecs)
+{
+    // Reporting a violation delivers events itself; don't time those
+    if (!mTimingEnabled || mReporting)
+        return;
+
+    if (mInteracting) {
+        Timing &timing = mTimings[QByteArray(receiver->metaObject()->className())];
+        timing.nsecs += nsecs;
+        timing.count += 1;
+    }
+
+    if (nsecs < FrameBudgetNSecs)
+        return;
+
+    mBudgetExceeded = true;
+
+    if (mSinceSpikeReport.elapsed() < SpikeReportIntervalMSecs)
+        return;
+    mSinceSpikeReport.restart();
+
+    mReporting = true;
+    WARNING(QStringLiteral("Frame budget exceeded: %1 ms in %2 (event type %3)")
+            .arg(nsecs / 1000000.0, 0, 'f', 1)
+            .arg(QLatin1String(receiver->metaObject()->className()))
+            .arg(event->type()));
+    mReporting = false;
+}
+
+/**
+ * Reports where the main-thread time went during the interaction that just
+ * ended, but only when it missed at least one frame.
+ */
+void FrameWatchdog::reportSummary()
+{
+    const bool exceeded = mBudgetExceeded;
+    mBudgetExceeded = false;
+
+    if (!exceeded || mTimings.isEmpty()) {
+        mTimings.clear();
+        return;
+    }
+
+    QVector<std::pair<QByteArray, Timing>> entries;
+    entries.reserve(mTimings.size());
+    for (auto it = mTimings.constBegin(); it != mTimings.constEnd(); ++it)
+        entries.append({ it.key(), it.value() });
+    mTimings.clear();
+
+    std::sort(entries.begin(), entries.end(),
+              [] (const auto &a, const auto &b) { return a.second.nsecs > b.second.nsecs; });
+
+    QString summary = QStringLiteral("Main-thread time during interaction:");
+    const int reported = qMin(5, int(entries.size()));
+    for (int i = 0; i < reported; ++i) {
+        const auto &entry = entries.at(i);
+        summary.append(QStringLiteral(" %1: %2 ms (%3 events)")
+                       .arg(QLatin1String(entry.first))
+                       .arg(entry.second.nsecs / 1000000.0, 0, 'f', 1)
+                       .arg(entry.second.count));
+        if (i + 1 < reported)
+            summary.append(QLatin1Char(','));
+    }
+
+    mReporting = true;
+    INFO(summary);
+    mReporting = false;
+}
+
+} // namespace Tiled
@@ -0,0 +1,95 @@
+/*
+ * framewatchdog.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "tilededitor_global.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPointer>
+#include <QVector>
+
+class QEvent;
+class QObject;
+class QWidget;
+
+namespace Tiled {
+
+/**
+ * Attributes main-thread time to event receivers, to identify which
+ * subsystem is eating the frame budget during interaction.
+ *
+ * When enabled with the TILED_FRAME_WATCHDOG environment variable,
+ * TiledApplication::notify times every top-level event dispatch on the main
+ * thread. Dispatches that blow the frame budget are reported to the Console
+ * view right away, and when an interaction (like a brush stroke) ends, a
+ * summary of where the time went - keyed by receiver class - is reported
+ * for strokes that missed frames.
+ *
+ * Setting TILED_DEFER_DOCK_UPDATES additionally suppresses repaints of
+ * widgets inside dock widgets while an interaction is active; they show
+ * their previous contents until the interaction ends and are refreshed in
+ * one batch afterwards, keeping dock updates out of the stroke's frames.
+ */
+class TILED_EDITOR_EXPORT FrameWatchdog
+{
+public:
+    static FrameWatchdog &instance();
+
+    bool isActive() const { return mTimingEnabled || mDeferDockUpdates; }
+
+    void setInteracting(bool interacting);
+    bool isInteracting() const { return mInteracting; }
+
+    /**
+     * Returns whether delivery of the given event should be deferred until
+     * the current interaction ends. Called before top-level dispatches.
+     */
+    bool shouldDefer(QObject *receiver, QEvent *event);
+
+    /**
+     * Records a finished top-level dispatch. Called with the time the
+     * receiver took to handle the event.
+     */
+    void recordDispatch(QObject *receiver, QEvent *event, qint64 nsecs);
+
+private:
+    FrameWatchdog();
+
+    void reportSummary();
+
+    struct Timing {
+        qint64 nsecs = 0;
+        int count = 0;
+    };
+
+    bool mTimingEnabled = false;
+    bool mDeferDockUpdates = false;
+    bool mInteracting = false;
+    bool mBudgetExceeded = false;
+    bool mReporting = false;
+
+    QHash<QByteArray, Timing> mTimings;
+    QElapsedTimer mSinceSpikeReport;
+    QVector<QPointer<QWidget>> mDeferredWidgets;
+};
+
+} // namespace Tiled
@@ -28,13 +28,27 @@ namespace Tiled {
  * Returns a lists of points on an ellipse.
  * (x0,y0) is the midpoint
  * (x1,y1) determines the radius.
+ */
+QVector<QPoint> pointsOnEllipse(int x0, int y0, int x1, int y1)
+{
+    QVector<QPoint> ret;
+    pointsOnEllipse(x0, y0, x1, y1, ret);
+    return ret;
+}
+
+/**
+ * Variant of pointsOnEllipse() that writes the points into the given
+ * \a points vector, overwriting its previous contents. The capacity of the
+ * vector is kept, so a caller-owned buffer makes repeated calls on the
+ * interactive stroke path allocation-free once it has grown.
  *
  * It is adapted from http://en.wikipedia.org/wiki/Midpoint_circle_algorithm
  * here is the original: http://homepage.smc.edu/kennedy_john/belipse.pdf
  */
-QVector<QPoint> pointsOnEllipse(int x0, int y0, int x1, int y1)
+void pointsOnEllipse(int x0, int y0, int x1, int y1, QVector<QPoint> &points)
 {
-    QVector<QPoint> ret;
+    points.clear();
+
     int x, y;
     int xChange, yChange;
     int ellipseError;
@@ -44,7 +58,7 @@ QVector<QPoint> pointsOnEllipse(int x0, int y0, int x1, int y1)
     int radiusY = y0 > y1 ? y0 - y1 : y1 - y0;
 
     if (radiusX == 0 && radiusY == 0)
-        return ret;
+        return;
 
     twoXSquare = 2 * radiusX * radiusX;
     twoYSquare = 2 * radiusY * radiusY;
@@ -56,10 +70,10 @@ QVector<QPoint> pointsOnEllipse(int x0, int y0, int x1, int y1)
     stoppingX = twoYSquare*radiusX;
     stoppingY = 0;
     while (stoppingX >= stoppingY) {
-        ret += QPoint(x0 + x, y0 + y);
-        ret += QPoint(x0 - x, y0 + y);
-        ret += QPoint(x0 + x, y0 - y);
-        ret += QPoint(x0 - x, y0 - y);
+        points += QPoint(x0 + x, y0 + y);
+        points += QPoint(x0 - x, y0 + y);
+        points += QPoint(x0 + x, y0 - y);
+        points += QPoint(x0 - x, y0 - y);
         y++;
         stoppingY += twoXSquare;
         ellipseError += yChange;
@@ -79,10 +93,10 @@ QVector<QPoint> pointsOnEllipse(int x0, int y0, int x1, int y1)
     stoppingX = 0;
     stoppingY = twoXSquare * radiusY;
     while (stoppingX <= stoppingY) {
-        ret += QPoint(x0 + x, y0 + y);
-        ret += QPoint(x0 - x, y0 + y);
-        ret += QPoint(x0 + x, y0 - y);
-        ret += QPoint(x0 - x, y0 - y);
+        points += QPoint(x0 + x, y0 + y);
+        points += QPoint(x0 - x, y0 + y);
+        points += QPoint(x0 + x, y0 - y);
+        points += QPoint(x0 - x, y0 - y);
         x++;
         stoppingX += twoYSquare;
         ellipseError += xChange;
@@ -94,12 +108,15 @@ QVector<QPoint> pointsOnEllipse(int x0, int y0, int x1, int y1)
             yChange += twoXSquare;
         }
     }
-
-    return ret;
 }
 
 /**
  * returns an elliptical region centered at x0,y0 with radius determinded by x1,y1
+ *
+ * The midpoint loops only record the widest span found for each scanline.
+ * The region is then built from one rectangle per scanline in a single
+ * call, which keeps large ellipses linear in their height instead of
+ * merging thousands of overlapping spans one by one.
  */
 QRegion ellipseRegion(int x0, int y0, int x1, int y1)
 {
@@ -115,6 +132,13 @@ QRegion ellipseRegion(int x0, int y0, int x1, int y1)
     if (radiusX == 0 && radiusY == 0)
         return ret;
 
+    // Widest half-width seen per scanline, symmetric in y
+    QVector<int> halfWidths(radiusY + 1, 0);
+    const auto addSpan = [&halfWidths] (int halfWidth, int line) {
+        if (line >= 0 && line < halfWidths.size())
+            halfWidths[line] = qMax(halfWidths[line], halfWidth);
+    };
+
     twoXSquare = 2 * radiusX * radiusX;
     twoYSquare = 2 * radiusY * radiusY;
     x = radiusX;
@@ -125,8 +149,7 @@ QRegion ellipseRegion(int x0, int y0, int x1, int y1)
     stoppingX = twoYSquare*radiusX;
     stoppingY = 0;
     while (stoppingX >= stoppingY) {
-        ret += QRect(-x, y, x * 2, 1);
-        ret += QRect(-x, -y, x * 2, 1);
+        addSpan(x, y);
         y++;
         stoppingY += twoXSquare;
         ellipseError += yChange;
@@ -146,8 +169,7 @@ QRegion ellipseRegion(int x0, int y0, int x1, int y1)
     stoppingX = 0;
     stoppingY = twoXSquare * radiusY;
     while (stoppingX <= stoppingY) {
-        ret += QRect(-x, y, x * 2, 1);
-        ret += QRect(-x, -y, x * 2, 1);
+        addSpan(x, y);
         x++;
         stoppingX += twoYSquare;
         ellipseError += xChange;
@@ -160,11 +182,33 @@ QRegion ellipseRegion(int x0, int y0, int x1, int y1)
         }
     }
 
-    return ret.translated(x0, y0);
+    QVector<QRect> rects;
+    rects.reserve(radiusY * 2 + 1);
+    for (y = -radiusY; y <= radiusY; ++y) {
+        const int halfWidth = halfWidths[qAbs(y)];
+        if (halfWidth > 0)
+            rects.append(QRect(x0 - halfWidth, y0 + y, halfWidth * 2, 1));
+    }
+    ret.setRects(rects.constData(), rects.size());
+
+    return ret;
 }
 
 /**
  * Returns the lists of points on a line from (x0,y0) to (x1,y1).
+ */
+QVector<QPoint> pointsOnLine(int x0, int y0, int x1, int y1, bool manhattan)
+{
+    QVector<QPoint> ret;
+    pointsOnLine(x0, y0, x1, y1, ret, manhattan);
+    return ret;
+}
+
+/**
+ * Variant of pointsOnLine() that writes the points into the given
+ * \a points vector, overwriting its previous contents. The capacity of the
+ * vector is kept, so a caller-owned buffer makes repeated calls on the
+ * interactive stroke path allocation-free once it has grown.
  *
  * This is an implementation of Bresenham's line algorithm, initially copied
  * from http://en.wikipedia.org/wiki/Bresenham's_line_algorithm#Optimization
@@ -173,9 +217,10 @@ QRegion ellipseRegion(int x0, int y0, int x1, int y1)
  * When the \a manhattan option (named after "Manhattan distance") is set to
  * true, the points on the line can't take diagonal steps.
  */
-QVector<QPoint> pointsOnLine(int x0, int y0, int x1, int y1, bool manhattan)
+void pointsOnLine(int x0, int y0, int x1, int y1, QVector<QPoint> &points,
+                  bool manhattan)
 {
-    QVector<QPoint> ret;
+    points.clear();
 
     const bool steep = qAbs(y1 - y0) > qAbs(x1 - x0);
     if (steep) {
@@ -200,22 +245,81 @@ QVector<QPoint> pointsOnLine(int x0, int y0, int x1, int y1, bool manhattan)
     else
         ystep = -1;
 
-    ret.reserve(deltax + 1 + (manhattan ? deltay : 0));
+    points.reserve(deltax + 1 + (manhattan ? deltay : 0));
 
     for (int x = x0; x <= x1; x++) {
-        ret += steep ? QPoint(y, x) : QPoint(x, y);
+        points += steep ? QPoint(y, x) : QPoint(x, y);
         error = error - deltay;
         if (error < 0) {
              y = y + ystep;
              error = error + deltax;
 
              if (manhattan && x < x1)
-                ret += steep ? QPoint(y, x) : QPoint(x, y);
+                points += steep ? QPoint(y, x) : QPoint(x, y);
         }
     }
 
     if (reverse)
-        std::reverse(ret.begin(), ret.end());
+        std::reverse(points.begin(), points.end());
+}
+
+/**
+ * Returns the region covered by a line from (x0,y0) to (x1,y1), visiting
+ * the same cells as pointsOnLine().
+ *
+ * Each maximal run of cells on a scanline (or, for steep lines, in a
+ * column) becomes a single rectangle, so consumers that operate on regions
+ * get a handful of runs instead of one rectangle per cell.
+ */
+QRegion lineRegion(int x0, int y0, int x1, int y1, bool manhattan)
+{
+    const bool steep = qAbs(y1 - y0) > qAbs(x1 - x0);
+    if (steep) {
+        qSwap(x0, y0);
+        qSwap(x1, y1);
+    }
+
+    // The order of the points doesn't matter for a region
+    if (x0 > x1) {
+        qSwap(x0, x1);
+        qSwap(y0, y1);
+    }
+
+    const int deltax = x1 - x0;
+    const int deltay = qAbs(y1 - y0);
+    int error = deltax / 2;
+    const int ystep = y0 < y1 ? 1 : -1;
+    int y = y0;
+    int runStart = x0;
+
+    QVector<QRect> rects;
+    rects.reserve(deltay + 1);
+
+    for (int x = x0; x <= x1; x++) {
+        error -= deltay;
+        if (error < 0) {
+            rects.append(steep ? QRect(y, runStart, 1, x - runStart + 1)
+                               : QRect(runStart, y, x - runStart + 1, 1));
+            y += ystep;
+            error += deltax;
+
+            // With the manhattan option the next run extends back to this
+            // column, mirroring the extra point taken by pointsOnLine()
+            runStart = (manhattan && x < x1) ? x : x + 1;
+        }
+    }
+
+    if (runStart <= x1) {
+        rects.append(steep ? QRect(y, runStart, 1, x1 - runStart + 1)
+                           : QRect(runStart, y, x1 - runStart + 1, 1));
+    }
+
+    // setRects() requires the rectangles in ascending y order
+    if (rects.size() > 1 && rects.first().y() > rects.last().y())
+        std::reverse(rects.begin(), rects.end());
+
+    QRegion ret;
+    ret.setRects(rects.constData(), rects.size());
 
     return ret;
 }
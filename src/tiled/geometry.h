@@ -28,15 +28,28 @@
 namespace Tiled {
 
 QVector<QPoint> pointsOnEllipse(int x0, int y0, int x1, int y1);
+void pointsOnEllipse(int x0, int y0, int x1, int y1, QVector<QPoint> &points);
 QRegion ellipseRegion(int x0, int y0, int x1, int y1);
 QVector<QPoint> pointsOnLine(int x0, int y0, int x1, int y1, bool manhattan = false);
+void pointsOnLine(int x0, int y0, int x1, int y1, QVector<QPoint> &points,
+                  bool manhattan = false);
+QRegion lineRegion(int x0, int y0, int x1, int y1, bool manhattan = false);
 
 inline QVector<QPoint> pointsOnEllipse(QPoint a, QPoint b)
 { return pointsOnEllipse(a.x(), a.y(), b.x(), b.y()); }
 
+inline void pointsOnEllipse(QPoint a, QPoint b, QVector<QPoint> &points)
+{ pointsOnEllipse(a.x(), a.y(), b.x(), b.y(), points); }
+
 inline QVector<QPoint> pointsOnLine(QPoint a, QPoint b, bool manhattan = false)
 { return pointsOnLine(a.x(), a.y(), b.x(), b.y(), manhattan); }
 
+inline void pointsOnLine(QPoint a, QPoint b, QVector<QPoint> &points, bool manhattan = false)
+{ pointsOnLine(a.x(), a.y(), b.x(), b.y(), points, manhattan); }
+
+inline QRegion lineRegion(QPoint a, QPoint b, bool manhattan = false)
+{ return lineRegion(a.x(), a.y(), b.x(), b.y(), manhattan); }
+
 QVector<QRegion> coherentRegions(const QRegion &region);
 
 QTransform rotateAt(const QPointF &position, qreal rotation);
@@ -0,0 +1,70 @@
+/*
+ * jobscheduler.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jobscheduler.h"
+
+#include <QRunnable>
+#include <QThreadPool>
+
+namespace Tiled {
+
+namespace {
+
+class ScheduledJob : public QRunnable
+{
+public:
+    ScheduledJob(std::function<void (const JobScheduler::Token &)> job,
+                 JobScheduler::Token token)
+        : mJob(std::move(job))
+        , mToken(std::move(token))
+    {}
+
+    void run() override
+    {
+        // A job cancelled while still queued is not started at all
+        if (!mToken.isCancelled())
+            mJob(mToken);
+    }
+
+private:
+    std::function<void (const JobScheduler::Token &)> mJob;
+    JobScheduler::Token mToken;
+};
+
+} // anonymous namespace
+
+/**
+ * Schedules \a job on the global thread pool at the given \a priority and
+ * returns a token that can be used to cancel it.
+ *
+ * The priority decides which queued job a freed-up pool thread picks next,
+ * so interactive jobs overtake queued bulk work regardless of how much of
+ * the latter is waiting.
+ */
+JobScheduler::Token JobScheduler::schedule(Priority priority,
+                                           std::function<void (const Token &)> job)
+{
+    Token token(std::make_shared<std::atomic<bool>>(false));
+    QThreadPool::globalInstance()->start(new ScheduledJob(std::move(job), token),
+                                         priority);
+    return token;
+}
+
+} // namespace Tiled
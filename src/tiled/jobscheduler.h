@@ -0,0 +1,122 @@
+/*
+ * jobscheduler.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "tilededitor_global.h"
+
+#include <QMetaObject>
+#include <QPointer>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace Tiled {
+
+/**
+ * Central entry point for scheduling editor background work on the global
+ * thread pool.
+ *
+ * Jobs are started with a priority class, so that latency-critical work
+ * never queues up behind bulk work like thumbnail renders. Each job gets a
+ * cancellation token: cancelling keeps a queued job from starting at all,
+ * lets a running job bail out early by checking the token, and drops its
+ * result delivery.
+ *
+ * Results are delivered through a callback queued on the thread of a
+ * receiver object. When the receiver is destroyed before the job finishes,
+ * the delivery is silently dropped.
+ */
+class TILED_EDITOR_EXPORT JobScheduler
+{
+public:
+    enum Priority {
+        IdlePriority = -1,          ///< Bulk work, like thumbnail renders
+        NormalPriority = 0,         ///< Regular background work, like file IO
+        InteractivePriority = 1,    ///< Latency-critical work
+    };
+
+    /**
+     * Handle to a scheduled job, shared between the scheduler and whoever
+     * wants to cancel it. Default-constructed tokens are never cancelled.
+     */
+    class Token
+    {
+    public:
+        Token() = default;
+
+        bool isCancelled() const
+        { return mCancelled && mCancelled->load(std::memory_order_relaxed); }
+
+        void cancel() const
+        { if (mCancelled) mCancelled->store(true, std::memory_order_relaxed); }
+
+    private:
+        friend class JobScheduler;
+
+        explicit Token(std::shared_ptr<std::atomic<bool>> cancelled)
+            : mCancelled(std::move(cancelled))
+        {}
+
+        std::shared_ptr<std::atomic<bool>> mCancelled;
+    };
+
+    JobScheduler() = delete;
+
+    static Token schedule(Priority priority,
+                          std::function<void (const Token &)> job);
+
+    template <typename Result>
+    static Token schedule(Priority priority,
+                          std::function<Result (const Token &)> job,
+                          QObject *receiver,
+                          std::function<void (const Result &)> deliver);
+};
+
+/**
+ * Schedules \a job and delivers its result by queueing \a deliver on the
+ * thread of \a receiver. Long-running jobs should check the token they are
+ * handed and return early when it reports cancellation; a cancelled job's
+ * result is never delivered.
+ */
+template <typename Result>
+JobScheduler::Token JobScheduler::schedule(Priority priority,
+                                           std::function<Result (const Token &)> job,
+                                           QObject *receiver,
+                                           std::function<void (const Result &)> deliver)
+{
+    const QPointer<QObject> guard(receiver);
+
+    return schedule(priority, [job = std::move(job),
+                               deliver = std::move(deliver),
+                               guard] (const Token &token) {
+        const Result result = job(token);
+        if (token.isCancelled() || !guard)
+            return;
+
+        QMetaObject::invokeMethod(guard, [result, deliver, token] {
+            if (!token.isCancelled())
+                deliver(result);
+        }, Qt::QueuedConnection);
+    });
+}
+
+} // namespace Tiled
@@ -28,6 +28,7 @@
 #include <QLibraryInfo>
 #include <QLocale>
 #include <QTranslator>
+#include <QtConcurrent>
 
 using namespace Tiled;
 
@@ -53,10 +54,12 @@ LanguageManager::LanguageManager()
 
 LanguageManager::~LanguageManager() = default;
 
-void LanguageManager::installTranslators()
+void LanguageManager::preloadTranslators()
 {
-    mQtTranslator = std::make_unique<QTranslator>();
-    mAppTranslator = std::make_unique<QTranslator>();
+    mPendingQtTranslator = std::make_unique<QTranslator>();
+    mPendingAppTranslator = std::make_unique<QTranslator>();
+    mPendingQtTranslatorLoaded = false;
+    mPendingAppTranslatorLoaded = false;
 
     const QString language = Preferences::instance()->language();
     const QLocale locale = language.isEmpty() ? QLocale()
@@ -65,19 +68,38 @@ void LanguageManager::installTranslators()
     const QString qtTranslationsDir =
             QLibraryInfo::location(QLibraryInfo::TranslationsPath);
 
-    if (mQtTranslator->load(locale,
-                            QStringLiteral("qt"),
-                            QStringLiteral("_"),
-                            qtTranslationsDir)) {
-        QCoreApplication::installTranslator(mQtTranslator.get());
-    }
+    // Only the file loading happens on the worker; the translators are
+    // created above and installed by installTranslators, on the main thread.
+    mPreloadFuture = QtConcurrent::run([=] {
+        mPendingQtTranslatorLoaded =
+                mPendingQtTranslator->load(locale,
+                                           QStringLiteral("qt"),
+                                           QStringLiteral("_"),
+                                           qtTranslationsDir);
+
+        mPendingAppTranslatorLoaded =
+                mPendingAppTranslator->load(locale,
+                                            QStringLiteral("tiled"),
+                                            QStringLiteral("_"),
+                                            mTranslationsDir);
+    });
+}
 
-    if (mAppTranslator->load(locale,
-                             QStringLiteral("tiled"),
-                             QStringLiteral("_"),
-                             mTranslationsDir)) {
+void LanguageManager::installTranslators()
+{
+    if (!mPendingQtTranslator)
+        preloadTranslators();
+
+    mPreloadFuture.waitForFinished();
+
+    // Replacing the previous translators removes them from the application
+    mQtTranslator = std::move(mPendingQtTranslator);
+    mAppTranslator = std::move(mPendingAppTranslator);
+
+    if (mPendingQtTranslatorLoaded)
+        QCoreApplication::installTranslator(mQtTranslator.get());
+    if (mPendingAppTranslatorLoaded)
         QCoreApplication::installTranslator(mAppTranslator.get());
-    }
 }
 
 QStringList LanguageManager::availableLanguages()
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <QFuture>
 #include <QStringList>
 
 #include <memory>
@@ -34,8 +35,15 @@ public:
     static LanguageManager *instance();
 
     /**
-     * Installs the translators on the application for Qt and Tiled. Should be
-     * called again when the language changes.
+     * Starts loading the translation files for Qt and Tiled on the thread
+     * pool, so that the disk access overlaps with other startup work.
+     */
+    void preloadTranslators();
+
+    /**
+     * Installs the translators on the application for Qt and Tiled, waiting
+     * for a pending preload to finish when necessary. Should be called again
+     * when the language changes.
      */
     void installTranslators();
 
@@ -54,6 +62,14 @@ private:
     QStringList mLanguages;
     std::unique_ptr<QTranslator> mQtTranslator;
     std::unique_ptr<QTranslator> mAppTranslator;
+
+    // Translators being loaded by preloadTranslators. The bools are written
+    // by the worker before the future finishes.
+    std::unique_ptr<QTranslator> mPendingQtTranslator;
+    std::unique_ptr<QTranslator> mPendingAppTranslator;
+    bool mPendingQtTranslatorLoaded = false;
+    bool mPendingAppTranslatorLoaded = false;
+    QFuture<void> mPreloadFuture;
 };
 
 } // namespace Tiled
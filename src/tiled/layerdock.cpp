@@ -51,6 +51,8 @@
 #include <QtDebug>
 #include <QMetaEnum>
 
+#include <algorithm>
+
 using namespace Tiled;
 
 LayerDock::LayerDock(QWidget *parent):
@@ -466,6 +468,27 @@ void LayerView::contextMenuEvent(QContextMenuEvent *event)
         menu.addAction(handler->actionToggleLockSelectedLayers());
         menu.addAction(handler->actionToggleOtherLayers());
         menu.addAction(handler->actionToggleLockOtherLayers());
+
+        // Freezing only applies to tile layers, since only those are
+        // rendered from a raster cache (see MapDocument::setLayerFrozen)
+        QList<Layer*> tileLayers;
+        for (Layer *layer : mMapDocument->selectedLayers())
+            if (layer->isTileLayer())
+                tileLayers.append(layer);
+
+        if (!tileLayers.isEmpty()) {
+            const bool allFrozen = std::all_of(tileLayers.begin(), tileLayers.end(),
+                                               [this] (Layer *layer) { return mMapDocument->isLayerFrozen(layer); });
+
+            QAction *frozen = menu.addAction(tr("Frozen"));
+            frozen->setCheckable(true);
+            frozen->setChecked(allFrozen);
+            connect(frozen, &QAction::triggered, this, [=] {
+                for (Layer *layer : std::as_const(tileLayers))
+                    mMapDocument->setLayerFrozen(layer, !allFrozen);
+            });
+        }
+
         menu.addSeparator();
         menu.addAction(handler->actionLayerProperties());
     }
@@ -383,14 +383,33 @@ void LayerModel::setMapDocument(MapDocument *mapDocument)
  */
 void LayerModel::insertLayer(GroupLayer *parentLayer, int index, Layer *layer)
 {
+    insertLayers(parentLayer, index, { layer });
+}
+
+/**
+ * Adds the given \a layers to this model's map, inserting them as children of
+ * \a parentLayer starting at the given \a index.
+ *
+ * The insertion is announced to views with a single ranged signal, which
+ * avoids a view update for each layer when many layers are added at once.
+ */
+void LayerModel::insertLayers(GroupLayer *parentLayer, int index, const QList<Layer *> &layers)
+{
+    if (layers.isEmpty())
+        return;
+
     QModelIndex parent = LayerModel::index(parentLayer);
-    beginInsertRows(parent, index, index);
-    if (parentLayer)
-        parentLayer->insertLayer(index, layer);
-    else
-        mMap->insertLayer(index, layer);
+    beginInsertRows(parent, index, index + layers.size() - 1);
+    for (int i = 0; i < layers.size(); ++i) {
+        if (parentLayer)
+            parentLayer->insertLayer(index + i, layers.at(i));
+        else
+            mMap->insertLayer(index + i, layers.at(i));
+    }
     endInsertRows();
-    emit layerAdded(layer);
+
+    for (Layer *layer : layers)
+        emit layerAdded(layer);
 }
 
 /**
@@ -400,17 +419,43 @@ void LayerModel::insertLayer(GroupLayer *parentLayer, int index, Layer *layer)
  */
 Layer *LayerModel::takeLayerAt(GroupLayer *parentLayer, int index)
 {
-    emit layerAboutToBeRemoved(parentLayer, index);
+    return takeLayersAt(parentLayer, index, 1).first();
+}
+
+/**
+ * Removes \a count layers starting at the given \a index from this model's
+ * map and returns them. The caller becomes responsible for the lifetime of
+ * these layers.
+ *
+ * Like insertLayers, the removal is announced to views with a single ranged
+ * signal. The layerAboutToBeRemoved signal is still emitted for each layer,
+ * before any of them is removed.
+ */
+QList<Layer *> LayerModel::takeLayersAt(GroupLayer *parentLayer, int index, int count)
+{
+    Q_ASSERT(count > 0);
+
+    for (int i = index; i < index + count; ++i)
+        emit layerAboutToBeRemoved(parentLayer, i);
+
     QModelIndex parent = LayerModel::index(parentLayer);
-    beginRemoveRows(parent, index, index);
-    Layer *layer;
-    if (parentLayer)
-        layer = parentLayer->takeLayerAt(index);
-    else
-        layer = mMap->takeLayerAt(index);
+    beginRemoveRows(parent, index, index + count - 1);
+
+    QList<Layer*> layers;
+    layers.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        if (parentLayer)
+            layers.append(parentLayer->takeLayerAt(index));
+        else
+            layers.append(mMap->takeLayerAt(index));
+    }
+
     endRemoveRows();
-    emit layerRemoved(layer);
-    return layer;
+
+    for (Layer *layer : std::as_const(layers))
+        emit layerRemoved(layer);
+
+    return layers;
 }
 
 /**
@@ -81,7 +81,9 @@ public:
     void setMapDocument(MapDocument *mapDocument);
 
     void insertLayer(GroupLayer *parentLayer, int index, Layer *layer);
+    void insertLayers(GroupLayer *parentLayer, int index, const QList<Layer *> &layers);
     Layer *takeLayerAt(GroupLayer *parentLayer, int index);
+    QList<Layer *> takeLayersAt(GroupLayer *parentLayer, int index, int count);
     void replaceLayer(Layer *layer, Layer *replacement);
     void moveLayer(GroupLayer *parentLayer, int index, GroupLayer *toParentLayer, int toIndex);
 
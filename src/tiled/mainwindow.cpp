@@ -35,6 +35,7 @@
 #include "automappingmanager.h"
 #include "commandmanager.h"
 #include "consoledock.h"
+#include "documentcache.h"
 #include "documentmanager.h"
 #include "donationpopup.h"
 #include "exportasimagedialog.h"
@@ -60,6 +61,7 @@
 #include "projectpropertiesdialog.h"
 #include "propertytypeseditor.h"
 #include "resizedialog.h"
+#include "savefile.h"
 #include "scriptmanager.h"
 #include "sentryhelper.h"
 #include "stylehelper.h"
@@ -81,7 +83,9 @@
 #include <QLabel>
 #include <QMessageBox>
 #include <QMimeData>
+#include <QProcess>
 #include <QRegularExpression>
+#include <QTemporaryFile>
 #include <QShortcut>
 #include <QStandardPaths>
 #include <QStatusBar>
@@ -299,6 +303,7 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     ActionManager::registerAction(mUi->actionSaveAs, "SaveAs");
     ActionManager::registerAction(mUi->actionShowGrid, "ShowGrid");
     ActionManager::registerAction(mUi->actionShowObjectReferences, "ShowObjectReferences");
+    ActionManager::registerAction(mUi->actionShowRenderStatistics, "ShowRenderStatistics");
     ActionManager::registerAction(mUi->actionShowTileAnimations, "ShowTileAnimations");
     ActionManager::registerAction(mUi->actionShowTileCollisionShapes, "ShowTileCollisionShapes");
     ActionManager::registerAction(mUi->actionShowTileObjectOutlines, "ShowTileObjectOutlines");
@@ -416,6 +421,7 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     mUi->actionShowObjectReferences->setChecked(preferences->showObjectReferences());
     mUi->actionShowTileAnimations->setChecked(preferences->showTileAnimations());
     mUi->actionShowTileCollisionShapes->setChecked(preferences->showTileCollisionShapes());
+    mUi->actionShowRenderStatistics->setChecked(preferences->showRenderStatistics());
     mUi->actionEnableParallax->setChecked(preferences->parallaxEnabled());
     mUi->actionSnapToGrid->setChecked(preferences->snapToGrid());
     mUi->actionSnapToFineGrid->setChecked(preferences->snapToFineGrid());
@@ -555,6 +561,8 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
             preferences, &Preferences::setShowTileAnimations);
     connect(mUi->actionShowTileCollisionShapes, &QAction::toggled,
             preferences, &Preferences::setShowTileCollisionShapes);
+    connect(mUi->actionShowRenderStatistics, &QAction::toggled,
+            preferences, &Preferences::setShowRenderStatistics);
     connect(mUi->actionEnableParallax, &QAction::toggled,
             preferences, &Preferences::setParallaxEnabled);
     connect(mUi->actionSnapToGrid, &QAction::toggled,
@@ -918,6 +926,13 @@ void MainWindow::closeEvent(QCloseEvent *event)
         // Make sure user won't end up in Clear View mode on next launch
         toggleClearView(false);
         writeSettings();
+
+        // Persist the parsed state of the open maps, so that restoring the
+        // session can skip re-parsing them
+        for (const DocumentPtr &document : mDocumentManager->documents())
+            if (auto mapDocument = qobject_cast<MapDocument*>(document.data()))
+                DocumentCache::store(*mapDocument);
+
         event->accept();
     } else {
         event->ignore();
@@ -1314,6 +1329,19 @@ void MainWindow::export_()
     }
 }
 
+/**
+ * Enables skipping of output files whose contents would not change for the
+ * duration of an export, so that repeated exports over an unchanged file
+ * preserve its modification time.
+ */
+struct SkipUnchangedFiles
+{
+    SkipUnchangedFiles() { SaveFile::setSkipUnchangedEnabled(true); }
+    ~SkipUnchangedFiles() { SaveFile::setSkipUnchangedEnabled(mPreviousValue); }
+
+    const bool mPreviousValue = SaveFile::skipUnchangedEnabled();
+};
+
 /**
  * Exports the given document to the previously used export file name and the
  * previously used export format.
@@ -1330,10 +1358,24 @@ bool MainWindow::exportDocument(Document *document)
 
     if (auto mapDocument = qobject_cast<MapDocument*>(document)) {
         if (MapFormat *exportFormat = mapDocument->exportFormat()) {
+            if (Preferences::instance()->exportInSeparateProcess()) {
+                QString errorString;
+                if (exportMapInSeparateProcess(mapDocument->map(), exportFileName,
+                                               exportFormat->shortName(), errorString)) {
+                    statusBar()->showMessage(tr("Exported to %1").arg(exportFileName), 3000);
+                } else {
+                    QMessageBox::critical(this, tr("Error Exporting Map"),
+                                          errorString);
+                }
+                return true;
+            }
+
             std::unique_ptr<Map> exportMap;
             ExportHelper exportHelper;
-            const Map *map = exportHelper.prepareExportMap(mapDocument->map(), exportMap);
+            const Map *map = exportHelper.prepareExportMap(mapDocument->map(), exportMap,
+                                                           exportFormat);
 
+            const SkipUnchangedFiles skipUnchangedFiles;
             if (exportFormat->write(map, exportFileName, exportHelper.formatOptions())) {
                 statusBar()->showMessage(tr("Exported to %1").arg(exportFileName), 3000);
                 return true;
@@ -1346,8 +1388,10 @@ bool MainWindow::exportDocument(Document *document)
     } else if (auto tilesetDocument = qobject_cast<TilesetDocument*>(document)) {
         if (TilesetFormat *exportFormat = tilesetDocument->exportFormat()) {
             ExportHelper exportHelper;
-            const SharedTileset tileset = exportHelper.prepareExportTileset(tilesetDocument->tileset());
+            const SharedTileset tileset = exportHelper.prepareExportTileset(tilesetDocument->tileset(),
+                                                                            true, exportFormat);
 
+            const SkipUnchangedFiles skipUnchangedFiles;
             if (exportFormat->write(*tileset, exportFileName, exportHelper.formatOptions())) {
                 statusBar()->showMessage(tr("Exported to %1").arg(exportFileName), 3000);
                 return true;
@@ -1362,6 +1406,76 @@ bool MainWindow::exportDocument(Document *document)
     return false;
 }
 
+/**
+ * Exports the given \a map by running a separate Tiled process with the
+ * "--export-map" option, so that a crash in a format plugin cannot take the
+ * editor and any unsaved work down with it.
+ *
+ * The current state of the map is written to a temporary TMX snapshot, which
+ * the child process loads and exports. The export options are forwarded on
+ * the command line and applied by the child while preparing the export map.
+ */
+bool MainWindow::exportMapInSeparateProcess(const Map *map,
+                                            const QString &fileName,
+                                            const QString &formatShortName,
+                                            QString &errorString)
+{
+    QTemporaryFile snapshot(QDir::temp().filePath(QStringLiteral("tiled-export-XXXXXX.tmx")));
+    if (!snapshot.open()) {
+        errorString = tr("Failed to create a temporary file.");
+        return false;
+    }
+
+    TmxMapFormat tmxFormat;
+    if (!tmxFormat.write(map, snapshot.fileName())) {
+        errorString = tmxFormat.errorString();
+        return false;
+    }
+
+    QStringList arguments {
+        QStringLiteral("--new-instance"),   // avoid forwarding to this instance
+        QStringLiteral("--export-map"),
+        formatShortName,
+        snapshot.fileName(),
+        fileName,
+    };
+
+    const Preferences::ExportOptions options = Preferences::instance()->exportOptions();
+    if (options & Preferences::EmbedTilesets)
+        arguments.append(QStringLiteral("--embed-tilesets"));
+    if (options & Preferences::DetachTemplateInstances)
+        arguments.append(QStringLiteral("--detach-templates"));
+    if (options & Preferences::ResolveObjectTypesAndProperties)
+        arguments.append(QStringLiteral("--resolve-types-and-properties"));
+    if (options & Preferences::ExportMinimized)
+        arguments.append(QStringLiteral("--minimize"));
+    arguments.append(QStringLiteral("--skip-unchanged"));
+
+    QProcess process;
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start(QApplication::applicationFilePath(), arguments);
+    if (!process.waitForStarted()) {
+        errorString = tr("Failed to start the export process.");
+        return false;
+    }
+
+    process.waitForFinished(-1);
+
+    if (process.exitStatus() != QProcess::NormalExit) {
+        errorString = tr("The export process crashed.");
+        return false;
+    }
+
+    if (process.exitCode() != 0) {
+        errorString = QString::fromLocal8Bit(process.readAll()).trimmed();
+        if (errorString.isEmpty())
+            errorString = tr("The export process failed.");
+        return false;
+    }
+
+    return true;
+}
+
 void MainWindow::exportAs()
 {
     if (auto mapDocument = qobject_cast<MapDocument*>(mDocument))
@@ -1505,7 +1619,7 @@ void MainWindow::restoreSession()
         openFile(file);
     mDocumentManager->switchToDocument(activeFile);
 
-    WorldManager::instance().loadWorlds(mLoadedWorlds);
+    WorldManager::instance().loadWorldsAsync(mLoadedWorlds);
 
     mProjectDock->setExpandedPaths(session.expandedProjectPaths);
 
@@ -2350,7 +2464,8 @@ void MainWindow::exportMapAs(MapDocument *mapDocument)
 
     std::unique_ptr<Map> exportMap;
     ExportHelper exportHelper;
-    const Map *map = exportHelper.prepareExportMap(mapDocument->map(), exportMap);
+    const Map *map = exportHelper.prepareExportMap(mapDocument->map(), exportMap,
+                                                   exportDetails.mFormat);
 
     // Check if writer will overwrite existing files here because some writers
     // could save to multiple files at the same time. For example CSV saves
@@ -2386,12 +2501,26 @@ void MainWindow::exportMapAs(MapDocument *mapDocument)
     session.setLastPath(Session::ExportedFile, QFileInfo(exportDetails.mFileName).path());
     lastUsedExportFilter = selectedFilter;
 
-    auto exportResult = exportDetails.mFormat->write(map,
-                                                     exportDetails.mFileName,
-                                                     exportHelper.formatOptions());
+    bool exportResult;
+    QString exportError;
+
+    if (Preferences::instance()->exportInSeparateProcess()) {
+        exportResult = exportMapInSeparateProcess(mapDocument->map(),
+                                                  exportDetails.mFileName,
+                                                  exportDetails.mFormat->shortName(),
+                                                  exportError);
+    } else {
+        const SkipUnchangedFiles skipUnchangedFiles;
+        exportResult = exportDetails.mFormat->write(map,
+                                                    exportDetails.mFileName,
+                                                    exportHelper.formatOptions());
+        if (!exportResult)
+            exportError = exportDetails.mFormat->errorString();
+    }
+
     if (!exportResult) {
         QMessageBox::critical(this, tr("Error Exporting Map!"),
-                              exportDetails.mFormat->errorString());
+                              exportError);
     } else {
         // Remember export parameters, so subsequent exports can be done faster
         mapDocument->setLastExportFileName(exportDetails.mFileName);
@@ -2423,8 +2552,10 @@ void MainWindow::exportTilesetAs(TilesetDocument *tilesetDocument)
     lastUsedTilesetExportFilter = selectedFilter;
 
     ExportHelper exportHelper;
-    SharedTileset exportTileset = exportHelper.prepareExportTileset(tilesetDocument->tileset());
+    SharedTileset exportTileset = exportHelper.prepareExportTileset(tilesetDocument->tileset(),
+                                                                    true, exportDetails.mFormat);
 
+    const SkipUnchangedFiles skipUnchangedFiles;
     auto exportResult = exportDetails.mFormat->write(*exportTileset,
                                                      exportDetails.mFileName,
                                                      exportHelper.formatOptions());
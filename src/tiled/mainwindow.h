@@ -45,6 +45,7 @@ class MainWindow;
 namespace Tiled {
 
 class FileFormat;
+class Map;
 class TileLayer;
 
 class AutomappingManager;
@@ -125,6 +126,10 @@ private:
     void saveAll();
     void export_(); // 'export' is a reserved word
     bool exportDocument(Document *document);
+    bool exportMapInSeparateProcess(const Map *map,
+                                    const QString &fileName,
+                                    const QString &formatShortName,
+                                    QString &errorString);
     void exportAs();
     void exportAsImage();
     void reload();
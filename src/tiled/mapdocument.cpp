@@ -26,18 +26,22 @@
 #include "addremovetileset.h"
 #include "brokenlinks.h"
 #include "changeevents.h"
+#include "changejournal.h"
 #include "changelayer.h"
 #include "changemapobject.h"
 #include "changemapobjectsorder.h"
 #include "changeproperties.h"
 #include "changeselectedarea.h"
+#include "chunkedoperation.h"
 #include "containerhelpers.h"
+#include "documentcache.h"
 #include "editablemap.h"
 #include "flipmapobjects.h"
 #include "geometry.h"
 #include "grouplayer.h"
 #include "imagelayer.h"
 #include "issuesmodel.h"
+#include "jobscheduler.h"
 #include "layermodel.h"
 #include "logginginterface.h"
 #include "mapobject.h"
@@ -54,18 +58,24 @@
 #include "reparentlayers.h"
 #include "resizemap.h"
 #include "resizetilelayer.h"
+#include "session.h"
 #include "templatemanager.h"
 #include "tile.h"
 #include "tilelayer.h"
 #include "tilesetdocument.h"
+#include "tilesetmanager.h"
 #include "transformmapobjects.h"
 
 #include <QFileInfo>
 #include <QRect>
 #include <QSet>
 #include <QString>
+#include <QTimer>
 #include <QUndoStack>
 
+#include <algorithm>
+#include <memory>
+
 using namespace Tiled;
 
 MapDocument::MapDocument(std::unique_ptr<Map> map)
@@ -108,6 +118,24 @@ MapDocument::MapDocument(std::unique_ptr<Map> map)
 
     connect(TemplateManager::instance(), &TemplateManager::objectTemplateChanged,
             this, &MapDocument::updateTemplateInstances);
+
+    // Editing a frozen layer automatically unfreezes it, so that the layer
+    // being worked on is always painted live
+    connect(this, &MapDocument::regionChanged,
+            this, [this] (const QRegion &, TileLayer *tileLayer) {
+        setLayerFrozen(tileLayer, false);
+    });
+
+    // One indexChanged is emitted per undo stack operation, no matter how
+    // many commands that operation replays, making it the natural point to
+    // deliver the repaint regions those commands accumulated
+    connect(undoStack(), &QUndoStack::indexChanged,
+            this, &MapDocument::flushChangedRegions);
+
+    // Keeps long editing sessions from accumulating uncompressed paint
+    // buffers on the undo stack
+    connect(undoStack(), &QUndoStack::indexChanged,
+            this, &MapDocument::compactColdUndoCommands);
 }
 
 MapDocument::~MapDocument()
@@ -157,11 +185,129 @@ bool MapDocument::save(const QString &fileName, QString *error)
     return true;
 }
 
+/**
+ * Saves the map to \a fileName on a thread pool thread, keeping the editor
+ * responsive while large maps are serialized.
+ *
+ * The map is snapshotted by cloning it, which is cheap since the cell data
+ * of tile layer chunks is shared copy-on-write. The snapshot is written out
+ * through the regular format plugin, which commits the file via SaveFile's
+ * atomic rename. Tilesets are referenced rather than cloned, so tileset
+ * edits made while a save is in progress may end up in the saved file.
+ *
+ * Progress is reported through backgroundSaveStarted() and
+ * backgroundSaveFinished(). When the save succeeds and no edits were made
+ * in the meantime, the undo stack is marked clean just like after a
+ * synchronous save().
+ *
+ * Requesting a save while one is still writing queues a single follow-up
+ * save, started once the running one finishes, so the newest state always
+ * reaches disk.
+ */
+void MapDocument::saveAsync(const QString &fileName)
+{
+    MapFormat *mapFormat = writerFormat();
+    if (!mapFormat) {
+        emit backgroundSaveFinished(false, tr("Map format '%1' not found").arg(mWriterFormat));
+        return;
+    }
+
+    if (mSaving) {
+        // The running save writes an older snapshot; take a fresh one when
+        // it is done
+        mPendingSaveFileName = fileName;
+        return;
+    }
+
+    mSaving = true;
+    mUndoIndexAtSaveStart = undoStack()->index();
+    emit backgroundSaveStarted();
+
+    const QSharedPointer<Map> snapshot(mMap->clone().release());
+    const auto self = sharedFromThis();
+
+    JobScheduler::schedule(JobScheduler::NormalPriority,
+                           [=] (const JobScheduler::Token &) {
+        const bool success = mapFormat->write(snapshot.data(), fileName);
+        const QString error = success ? QString() : mapFormat->errorString();
+
+        QMetaObject::invokeMethod(self.data(), [=] {
+            self->backgroundSaveDone(fileName, success, error);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MapDocument::backgroundSaveDone(const QString &fileName, bool success,
+                                     const QString &error)
+{
+    mSaving = false;
+
+    const QString pendingSave = mPendingSaveFileName;
+    mPendingSaveFileName.clear();
+
+    if (!success) {
+        emit backgroundSaveFinished(false, error);
+    } else {
+        // Only mark the current state as clean when no edits were made while
+        // the snapshot was being written
+        if (undoStack()->index() == mUndoIndexAtSaveStart)
+            undoStack()->setClean();
+
+        if (mMap->fileName != fileName) {
+            mMap->fileName = fileName;
+            mMap->exportFileName.clear();
+        }
+
+        setFileName(fileName);
+        mLastSaved = QFileInfo(fileName).lastModified();
+
+        // Mark TilesetDocuments for embedded tilesets as saved
+        for (const SharedTileset &tileset : mMap->tilesets()) {
+            if (TilesetDocument *tilesetDocument = TilesetDocument::findDocumentForTileset(tileset))
+                if (tilesetDocument->isEmbedded())
+                    tilesetDocument->setClean();
+        }
+
+        emit saved();
+        emit backgroundSaveFinished(true, QString());
+    }
+
+    if (!pendingSave.isEmpty())
+        saveAsync(pendingSave);
+}
+
+namespace {
+
+/**
+ * Makes readers leave tileset images unloaded while in scope. Used when
+ * opening a map, where prioritized background loads are scheduled once the
+ * document exists.
+ */
+struct DeferTilesetImages
+{
+    DeferTilesetImages() { TilesetManager::instance()->setDeferredImageLoading(true); }
+    ~DeferTilesetImages() { TilesetManager::instance()->setDeferredImageLoading(mPreviousValue); }
+
+    const bool mPreviousValue = TilesetManager::instance()->deferredImageLoading();
+};
+
+} // anonymous namespace
+
 MapDocumentPtr MapDocument::load(const QString &fileName,
                                  MapFormat *format,
                                  QString *error)
 {
-    auto map = format->read(fileName);
+    std::unique_ptr<Map> map;
+
+    {
+        const DeferTilesetImages deferTilesetImages;
+
+        // A cache entry left by a clean shutdown skips the parsing step.
+        // Stale entries are ignored, so this never changes what is loaded.
+        map = DocumentCache::load(fileName);
+        if (!map)
+            map = format->read(fileName);
+    }
 
     if (!map) {
         if (error)
@@ -176,9 +322,84 @@ MapDocumentPtr MapDocument::load(const QString &fileName,
     if (format->hasCapabilities(MapFormat::Write))
         document->setWriterFormat(format);
 
+    document->scheduleTilesetImageLoads();
+
     return document;
 }
 
+/**
+ * Schedules background decoding of the tileset images left unloaded by the
+ * read, putting tilesets referenced by the initially visible cells first.
+ * The visible tile area is estimated from the view state saved in the
+ * session, using the layer data that is available before any image loads.
+ */
+void MapDocument::scheduleTilesetImageLoads()
+{
+    QVector<SharedTileset> pending;
+    for (const SharedTileset &tileset : mMap->tilesets())
+        if (!tileset->isCollection() && tileset->imageStatus() == LoadingPending)
+            pending.append(tileset);
+
+    if (pending.isEmpty())
+        return;
+
+    if (pending.size() > 1) {
+        const QVariantMap fileState = Session::current().fileState(fileName());
+
+        QPointF viewCenter;
+        if (fileState.contains(QStringLiteral("viewCenter")))
+            viewCenter = fromSettingsValue<QPointF>(fileState.value(QStringLiteral("viewCenter")));
+        else
+            viewCenter = QRectF(mRenderer->mapBoundingRect()).center();
+
+        qreal scale = fileState.value(QStringLiteral("scale")).toReal();
+        if (scale <= 0)
+            scale = 1.0;
+
+        // Assume a generous screen size; over-covering only means a few more
+        // tilesets end up at the front of the queue
+        const QSizeF viewSize = QSizeF(2560, 1440) / scale;
+        const QRectF viewRect(viewCenter.x() - viewSize.width() / 2,
+                              viewCenter.y() - viewSize.height() / 2,
+                              viewSize.width(), viewSize.height());
+
+        QRectF tileRect;
+        tileRect |= QRectF(mRenderer->screenToTileCoords(viewRect.topLeft()), QSizeF(1, 1));
+        tileRect |= QRectF(mRenderer->screenToTileCoords(viewRect.topRight()), QSizeF(1, 1));
+        tileRect |= QRectF(mRenderer->screenToTileCoords(viewRect.bottomLeft()), QSizeF(1, 1));
+        tileRect |= QRectF(mRenderer->screenToTileCoords(viewRect.bottomRight()), QSizeF(1, 1));
+
+        QRect tileArea = tileRect.toAlignedRect();
+
+        // At extreme zoom-out levels, cap the scan around the view center
+        constexpr int maxVisibleSpan = 256;
+        if (tileArea.width() > maxVisibleSpan || tileArea.height() > maxVisibleSpan) {
+            const QPoint center = tileArea.center();
+            tileArea.setSize(QSize(qMin(tileArea.width(), maxVisibleSpan),
+                                   qMin(tileArea.height(), maxVisibleSpan)));
+            tileArea.moveCenter(center);
+        }
+
+        QSet<Tileset*> visibleTilesets;
+
+        LayerIterator iterator(mMap.get(), Layer::TileLayerType);
+        while (auto tileLayer = static_cast<TileLayer*>(iterator.next())) {
+            const QRect area = tileArea.translated(-tileLayer->position());
+            for (int y = area.top(); y <= area.bottom(); ++y)
+                for (int x = area.left(); x <= area.right(); ++x)
+                    if (Tileset *tileset = tileLayer->cellAt(x, y).tileset())
+                        visibleTilesets.insert(tileset);
+        }
+
+        std::stable_partition(pending.begin(), pending.end(),
+                              [&] (const SharedTileset &tileset) {
+                                  return visibleTilesets.contains(tileset.data());
+                              });
+    }
+
+    TilesetManager::instance()->loadTilesetImagesAsync(pending);
+}
+
 MapFormat *MapDocument::readerFormat() const
 {
     return findFileFormat<MapFormat>(mReaderFormat, FileFormat::Read);
@@ -336,17 +557,23 @@ void MapDocument::resizeMap(QSize size, QPoint offset, bool removeObjects)
     const QPointF pixelOffset = origin - newOrigin;
 
     // Resize the map and each layer
-    QUndoCommand *command = new QUndoCommand(tr("Resize Map"));
+    auto command = std::make_unique<QUndoCommand>(tr("Resize Map"));
 
     QList<MapObject *> objectsToRemove;
     QList<MapObject *> objectsToMove;
 
+    int layerCount = 0;
+    for (LayerIterator counter(map()); counter.next(); )
+        ++layerCount;
+
+    ChunkedOperation operation(tr("Resizing map"), layerCount);
+
     LayerIterator iterator(map());
     while (Layer *layer = iterator.next()) {
         switch (layer->layerType()) {
         case Layer::TileLayerType: {
             TileLayer *tileLayer = static_cast<TileLayer*>(layer);
-            new ResizeTileLayer(this, tileLayer, size, offset, command);
+            new ResizeTileLayer(this, tileLayer, size, offset, command.get());
             break;
         }
         case Layer::ObjectGroupType: {
@@ -366,7 +593,7 @@ void MapDocument::resizeMap(QSize size, QPoint offset, bool removeObjects)
             auto imageLayer = static_cast<ImageLayer*>(layer);
             new SetLayerOffset(this, { layer },
                                imageLayer->offset() + pixelOffset,
-                               command);
+                               command.get());
             break;
         }
         case Layer::GroupLayerType: {
@@ -374,10 +601,15 @@ void MapDocument::resizeMap(QSize size, QPoint offset, bool removeObjects)
             break;
         }
         }
+
+        // Nothing has been applied to the map yet, so cancelling just
+        // discards the partially prepared command
+        if (!operation.advance())
+            return;
     }
 
     if (!objectsToRemove.isEmpty())
-        new RemoveMapObjects(this, objectsToRemove, command);
+        new RemoveMapObjects(this, objectsToRemove, command.get());
 
     if (!objectsToMove.isEmpty()) {
         QVector<TransformState> states;
@@ -385,13 +617,13 @@ void MapDocument::resizeMap(QSize size, QPoint offset, bool removeObjects)
             states.append(TransformState(o));
             states.last().setPosition(o->position() + pixelOffset);
         }
-        new TransformMapObjects(this, objectsToMove, states, command);
+        new TransformMapObjects(this, objectsToMove, states, command.get());
     }
 
-    new ResizeMap(this, size, command);
-    new ChangeSelectedArea(this, movedSelection, command);
+    new ResizeMap(this, size, command.get());
+    new ChangeSelectedArea(this, movedSelection, command.get());
 
-    undoStack()->push(command);
+    undoStack()->push(command.release());
 
     // TODO: Handle layers that don't match the map size correctly
 }
@@ -418,11 +650,26 @@ void MapDocument::offsetMap(const QList<Layer*> &layers,
     if (layers.empty())
         return;
 
-    undoStack()->beginMacro(tr("Offset Map"));
+    ChunkedOperation operation(tr("Offsetting map"), layers.size());
+
+    QVector<QUndoCommand*> commands;
+    commands.reserve(layers.size());
+
     for (auto layer : layers) {
-        undoStack()->push(new OffsetLayer(this, layer, offset,
-                                          bounds, wrapX, wrapY));
+        commands.append(new OffsetLayer(this, layer, offset,
+                                        bounds, wrapX, wrapY));
+
+        // The commands only take effect once pushed, so cancelling just
+        // discards the ones prepared so far
+        if (!operation.advance()) {
+            qDeleteAll(commands);
+            return;
+        }
     }
+
+    undoStack()->beginMacro(tr("Offset Map"));
+    for (auto command : std::as_const(commands))
+        undoStack()->push(command);
     undoStack()->endMacro();
 }
 
@@ -697,8 +944,7 @@ void MapDocument::mergeLayersDown(const QList<Layer *> &layers)
         GroupLayer *parentLayer = layer->parentLayer();
 
         undoStack()->push(new AddLayer(this, index - 1, merged, parentLayer));
-        undoStack()->push(new RemoveLayer(this, index, parentLayer));
-        undoStack()->push(new RemoveLayer(this, index, parentLayer));
+        undoStack()->push(new RemoveLayers(this, index, 2, parentLayer));
 
         // If the layer we've merged with was also scheduled to get merged down,
         // we need to update the pointer to the new layer.
@@ -789,16 +1035,38 @@ void MapDocument::removeLayers(const QList<Layer *> &layers)
         Layer *layer = layersToRemove.takeFirst();
         Q_ASSERT(layer->map() == mMap.get());
 
-        undoStack()->push(new RemoveLayer(this,
-                                          layer->siblingIndex(),
-                                          layer->parentLayer()));
+        GroupLayer *parentLayer = layer->parentLayer();
+        int index = layer->siblingIndex();
+        QList<Layer *> run = { layer };
+
+        // Extend over directly adjacent siblings that are also scheduled for
+        // removal, so that a contiguous run is removed with a single command
+        auto adjacentLayer = [&] (int siblingIndex) -> Layer * {
+            for (Layer *candidate : std::as_const(layersToRemove))
+                if (candidate->parentLayer() == parentLayer && candidate->siblingIndex() == siblingIndex)
+                    return candidate;
+            return nullptr;
+        };
+        while (Layer *next = adjacentLayer(index + run.size())) {
+            layersToRemove.removeOne(next);
+            run.append(next);
+        }
+        while (Layer *previous = adjacentLayer(index - 1)) {
+            layersToRemove.removeOne(previous);
+            run.prepend(previous);
+            --index;
+        }
+
+        undoStack()->push(new RemoveLayers(this, index, run.size(), parentLayer));
 
         // If a group layer gets removed, make sure any children are removed
         // from the remaining list of layers to remove
-        if (layer->isGroupLayer()) {
-            for (int i = layersToRemove.size() - 1; i >= 0; --i)
-                if (layersToRemove.at(i)->isParentOrSelf(layer))
-                    layersToRemove.removeAt(i);
+        for (Layer *removedLayer : std::as_const(run)) {
+            if (removedLayer->isGroupLayer()) {
+                for (int i = layersToRemove.size() - 1; i >= 0; --i)
+                    if (layersToRemove.at(i)->isParentOrSelf(removedLayer))
+                        layersToRemove.removeAt(i);
+            }
         }
     }
 
@@ -1074,16 +1342,72 @@ void MapDocument::paintTileLayers(const Map &map, bool mergeable,
     }
 }
 
+void MapDocument::emitRegionChanged(const QRegion &region, TileLayer *tileLayer)
+{
+    mChangedRegions[tileLayer] |= region;
+
+    // The flush is normally driven by QUndoStack::indexChanged. The timer
+    // only catches changes that are made outside of any undo command, like
+    // an in-place map reload.
+    if (!mChangedRegionsFlushScheduled) {
+        mChangedRegionsFlushScheduled = true;
+        QTimer::singleShot(0, this, &MapDocument::flushChangedRegions);
+    }
+}
+
+void MapDocument::flushChangedRegions()
+{
+    mChangedRegionsFlushScheduled = false;
+
+    const auto changedRegions = std::move(mChangedRegions);
+    mChangedRegions.clear();
+
+    QHashIterator<TileLayer*, QRegion> it(changedRegions);
+    while (it.hasNext()) {
+        TileLayer *layer = it.next().key();
+        if (layer->map() != map())  // a later command in the replay removed the layer
+            continue;
+
+        emit regionChanged(it.value(), layer);
+    }
+}
+
 void MapDocument::replaceObjectTemplate(const ObjectTemplate *oldObjectTemplate,
                                         const ObjectTemplate *newObjectTemplate)
 {
     auto changedObjects = mMap->replaceObjectTemplate(oldObjectTemplate, newObjectTemplate);
 
     // Update the objects in the map scene
-    emit changed(MapObjectsChangeEvent(std::move(changedObjects)));
+    emit changed(MapObjectsChangeEvent(std::move(changedObjects),
+                                       MapObject::AllProperties | MapObject::TemplateProperty));
     emit objectTemplateReplaced(newObjectTemplate, oldObjectTemplate);
 }
 
+/**
+ * Returns the objects in this map that are instances of the given
+ * \a objectTemplate.
+ *
+ * The instances of all templates are indexed in a single pass and the index
+ * is rebuilt on demand after objects were added, removed or attached to a
+ * different template. This way a template change only needs to visit its
+ * actual instances, instead of every object in every open map.
+ */
+QList<MapObject *> MapDocument::templateInstances(const ObjectTemplate *objectTemplate) const
+{
+    if (mTemplateInstancesDirty) {
+        mTemplateInstances.clear();
+
+        for (Layer *layer : mMap->objectGroups())
+            for (MapObject *object : static_cast<ObjectGroup*>(layer)->objects())
+                if (const ObjectTemplate *usedTemplate = object->objectTemplate())
+                    mTemplateInstances[usedTemplate].append(object);
+
+        mTemplateInstancesDirty = false;
+    }
+
+    return mTemplateInstances.value(objectTemplate);
+}
+
 void MapDocument::setSelectedArea(const QRegion &selection)
 {
     if (mSelectedArea != selection) {
@@ -1230,6 +1554,28 @@ void MapDocument::setHoveredMapObject(MapObject *object)
     emit hoveredMapObjectChanged(object, previous);
 }
 
+/**
+ * Freezes or unfreezes the given \a layer.
+ *
+ * A frozen layer is rendered from cached raster tiles instead of being drawn
+ * tile-by-tile on every repaint, which makes repaints of maps with many
+ * static decoration layers much cheaper. Freezing is a view-only setting: it
+ * is not saved with the map and does not go through the undo stack, and a
+ * frozen layer is automatically unfrozen when it is edited.
+ */
+void MapDocument::setLayerFrozen(Layer *layer, bool frozen)
+{
+    if (frozen == mFrozenLayers.contains(layer))
+        return;
+
+    if (frozen)
+        mFrozenLayers.insert(layer);
+    else
+        mFrozenLayers.remove(layer);
+
+    emit layerFrozenChanged(layer);
+}
+
 /**
  * Makes sure the all tilesets which are used at the given \a map will be
  * present in the map document.
@@ -1344,6 +1690,30 @@ void MapDocument::onChanged(const ChangeEvent &change)
 
         break;
     }
+    case ChangeEvent::MapObjectAdded:
+    case ChangeEvent::MapObjectRemoved:
+    case ChangeEvent::MapObjectsAdded:
+    case ChangeEvent::MapObjectsRemoved:
+        mTemplateInstancesDirty = true;
+        break;
+    case ChangeEvent::MapObjectsChanged: {
+        auto &objectsChange = static_cast<const MapObjectsChangeEvent&>(change);
+
+        if (objectsChange.properties & MapObject::TemplateProperty)
+            mTemplateInstancesDirty = true;
+
+        // Geometry changes invalidate the spatial index of the object's group
+        const MapObject::ChangedProperties geometryProperties {
+            MapObject::PositionProperty | MapObject::SizeProperty |
+            MapObject::RotationProperty | MapObject::ShapeProperty
+        };
+        if (objectsChange.properties & geometryProperties) {
+            for (MapObject *mapObject : objectsChange.mapObjects)
+                if (ObjectGroup *objectGroup = mapObject->objectGroup())
+                    objectGroup->invalidateObjectIndex();
+        }
+        break;
+    }
     default:
         break;
     }
@@ -1383,11 +1753,13 @@ void MapDocument::onObjectsMoved(const QModelIndex &parent, int start, int end,
 
     ObjectGroup *objectGroup = mMapObjectModel->toObjectGroup(parent);
 
-    // Determine the full range over which object indexes changed
-    const int first = qMin(start, row);
-    const int last = qMax(end, row - 1);
-
-    emit objectsIndexChanged(objectGroup, first, last);
+    // Only the moved objects need attention, since the relative order of the
+    // objects they jumped over is unaffected.
+    const int count = end - start + 1;
+    if (row > end)
+        emit objectsReordered(objectGroup, row - count, row - 1);
+    else
+        emit objectsReordered(objectGroup, row, row + count - 1);
 }
 
 void MapDocument::onLayerAdded(Layer *layer)
@@ -1447,9 +1819,44 @@ void MapDocument::onLayerRemoved(Layer *layer)
             selectedLayers.removeAt(i);
     switchSelectedLayers(selectedLayers);
 
+    for (auto it = mFrozenLayers.begin(); it != mFrozenLayers.end();) {
+        if ((*it)->isParentOrSelf(layer))
+            it = mFrozenLayers.erase(it);
+        else
+            ++it;
+    }
+
     emit layerRemoved(layer);
 }
 
+static void compactPaintCommands(const QUndoCommand *command)
+{
+    if (command->id() == Cmd_PaintTileLayer)
+        const_cast<PaintTileLayer*>(static_cast<const PaintTileLayer*>(command))->compact();
+
+    for (int i = 0; i < command->childCount(); ++i)
+        compactPaintCommands(command->child(i));
+}
+
+/**
+ * Compacts the tile buffers of paint commands that have moved far enough
+ * away from the current undo index that they are unlikely to be needed
+ * soon. The buffers are transparently expanded again when the command is
+ * undone or redone.
+ *
+ * Only the commands crossing the distance threshold are visited, so each
+ * undo index change does a constant amount of work.
+ */
+void MapDocument::compactColdUndoCommands(int index)
+{
+    constexpr int hotCommands = 8;
+
+    if (const QUndoCommand *command = undoStack()->command(index - hotCommands - 1))
+        compactPaintCommands(command);
+    if (const QUndoCommand *command = undoStack()->command(index + hotCommands))
+        compactPaintCommands(command);
+}
+
 QString MapDocument::newLayerName(Layer::TypeFlag layerType) const
 {
     const char *parametricName = nullptr;
@@ -1532,27 +1939,19 @@ void MapDocument::checkIssues()
 
 void MapDocument::updateTemplateInstances(const ObjectTemplate *objectTemplate)
 {
-    QList<MapObject*> objectList;
-    for (Layer *layer : mMap->objectGroups()) {
-        for (auto object : static_cast<ObjectGroup*>(layer)->objects()) {
-            if (object->objectTemplate() == objectTemplate) {
-                object->syncWithTemplate();
-                objectList.append(object);
-            }
-        }
-    }
-    emit changed(MapObjectsChangeEvent(std::move(objectList)));
+    const QList<MapObject*> objectList = templateInstances(objectTemplate);
+    if (objectList.isEmpty())
+        return;
+
+    for (MapObject *object : objectList)
+        object->syncWithTemplate();
+
+    emit changed(MapObjectsChangeEvent(objectList));
 }
 
 void MapDocument::selectAllInstances(const ObjectTemplate *objectTemplate)
 {
-    QList<MapObject*> objectList;
-    for (Layer *layer : mMap->objectGroups()) {
-        for (auto object : static_cast<ObjectGroup*>(layer)->objects())
-            if (object->objectTemplate() == objectTemplate)
-                objectList.append(object);
-    }
-    setSelectedObjects(objectList);
+    setSelectedObjects(templateInstances(objectTemplate));
 }
 
 /**
@@ -1742,4 +2141,11 @@ void MapDocument::createRenderer()
     mRenderer = MapRenderer::create(mMap.get());
 }
 
+ChangeJournal *MapDocument::changeJournal()
+{
+    if (!mChangeJournal)
+        mChangeJournal = new ChangeJournal(this);
+    return mChangeJournal;
+}
+
 #include "moc_mapdocument.cpp"
@@ -30,6 +30,7 @@
 #include "tilededitor_global.h"
 #include "tileset.h"
 
+#include <QHash>
 #include <QList>
 #include <QRegion>
 #include <QSet>
@@ -51,6 +52,7 @@ class ObjectTemplate;
 class Tile;
 class WangSet;
 
+class ChangeJournal;
 class LayerModel;
 class MapDocument;
 class MapObjectModel;
@@ -92,6 +94,14 @@ public:
 
     bool save(const QString &fileName, QString *error = nullptr) override;
 
+    void saveAsync(const QString &fileName);
+
+    /**
+     * Returns whether a background save started by saveAsync() is still in
+     * progress.
+     */
+    bool isSaving() const { return mSaving; }
+
     /**
      * Loads a map and returns a MapDocument instance on success. Returns null
      * on error and sets the \a error message.
@@ -178,9 +188,23 @@ public:
                          QVector<SharedTileset> *missingTilesets = nullptr,
                          QHash<TileLayer *, QRegion> *paintedRegions = nullptr);
 
+    /**
+     * Requests a repaint of the given \a region of \a tileLayer, given in
+     * tile coordinates.
+     *
+     * The regions are merged per layer and delivered as a single
+     * regionChanged once the current undo stack operation finishes, so that
+     * an operation replaying many commands at once - jumping around in the
+     * history, for example - triggers one invalidation per touched layer
+     * instead of one per command.
+     */
+    void emitRegionChanged(const QRegion &region, TileLayer *tileLayer);
+
     void replaceObjectTemplate(const ObjectTemplate *oldObjectTemplate,
                                const ObjectTemplate *newObjectTemplate);
 
+    QList<MapObject*> templateInstances(const ObjectTemplate *objectTemplate) const;
+
     void duplicateObjects(const QList<MapObject*> &objects);
     void removeObjects(const QList<MapObject*> &objects);
     void moveObjectsToGroup(const QList<MapObject*> &objects,
@@ -208,6 +232,12 @@ public:
      */
     void createRenderer();
 
+    /**
+     * Returns the change journal for this document, creating it on first
+     * use. Documents that nothing subscribes to don't pay for journaling.
+     */
+    ChangeJournal *changeJournal();
+
     /**
      * Returns the selected area of tiles.
      */
@@ -246,6 +276,9 @@ public:
     MapObject *hoveredMapObject() const { return mHoveredMapObject; }
     void setHoveredMapObject(MapObject *object);
 
+    bool isLayerFrozen(Layer *layer) const { return mFrozenLayers.contains(layer); }
+    void setLayerFrozen(Layer *layer, bool frozen);
+
     void unifyTilesets(Map &map);
     void unifyTilesets(Map &map, QVector<SharedTileset> &missingTilesets) const;
 
@@ -263,6 +296,17 @@ public:
     QSet<int> expandedObjectLayers;
 
 signals:
+    /**
+     * Emitted when a background save started by saveAsync() begins writing.
+     */
+    void backgroundSaveStarted();
+
+    /**
+     * Emitted when a background save started by saveAsync() has finished,
+     * either successfully or with an \a error.
+     */
+    void backgroundSaveFinished(bool success, const QString &error);
+
     /**
      * Emitted when the selected tile region changes. Sends the currently
      * selected region and the previously selected region.
@@ -331,6 +375,11 @@ signals:
      */
     void currentLayerChanged(Layer *layer);
 
+    /**
+     * Emitted when a layer was frozen or unfrozen (see setLayerFrozen).
+     */
+    void layerFrozenChanged(Layer *layer);
+
     /**
      * Emitted when a certain \a region of a \a tileLayer changes. The region
      * is given in tile coordinates.
@@ -359,6 +408,10 @@ signals:
     void objectsInserted(ObjectGroup *objectGroup, int first, int last);
     void objectsIndexChanged(ObjectGroup *objectGroup, int first, int last);
 
+    // emitted with the final range of a block of objects that was moved
+    // within its group
+    void objectsReordered(ObjectGroup *objectGroup, int first, int last);
+
     // emitted from the TilesetDocument
     void tilesetNameChanged(Tileset *tileset);
     void tilesetTilePositioningChanged(Tileset *tileset);
@@ -386,10 +439,19 @@ private:
     void onLayerAboutToBeRemoved(GroupLayer *groupLayer, int index);
     void onLayerRemoved(Layer *layer);
 
+    void compactColdUndoCommands(int index);
+
+    void flushChangedRegions();
+
     void moveObjectIndex(const MapObject *object, int count);
 
     QString newLayerName(Layer::TypeFlag layerType) const;
 
+    void backgroundSaveDone(const QString &fileName, bool success,
+                            const QString &error);
+
+    void scheduleTilesetImageLoads();
+
     /*
      * QString is used since the formats referenced here may be dynamically
      * added by a plugin, and can also be removed again.
@@ -403,11 +465,31 @@ private:
     QList<MapObject*> mSelectedObjects;
     QList<MapObject*> mAboutToBeSelectedObjects;
     MapObject *mHoveredMapObject;       /**< Map object with mouse on top. */
+    QSet<Layer*> mFrozenLayers;         /**< Layers rendered from a raster cache. */
     std::unique_ptr<MapRenderer> mRenderer;
+    ChangeJournal *mChangeJournal = nullptr;
     Layer *mCurrentLayer = nullptr;
     MapObjectModel *mMapObjectModel;
+
+    /**
+     * Lazily rebuilt index of template instances, used to avoid visiting
+     * every object in the map when a template changes.
+     */
+    mutable QHash<const ObjectTemplate*, QList<MapObject*>> mTemplateInstances;
+    mutable bool mTemplateInstancesDirty = true;
+
+    /**
+     * Repaint regions accumulated by emitRegionChanged, waiting to be
+     * flushed as regionChanged signals.
+     */
+    QHash<TileLayer*, QRegion> mChangedRegions;
+    bool mChangedRegionsFlushScheduled = false;
+
     bool mAllowHidingObjects = true;
     bool mAllowTileObjects = true;
+    bool mSaving = false;
+    int mUndoIndexAtSaveStart = -1;
+    QString mPendingSaveFileName;
 };
 
 } // namespace Tiled
@@ -74,6 +74,7 @@
 #include "undodock.h"
 #include "wangbrush.h"
 #include "wangdock.h"
+#include "worldoverviewdock.h"
 #include "wangset.h"
 #include "zoomable.h"
 #include "worldmovemaptool.h"
@@ -86,9 +87,11 @@
 #include <QLabel>
 #include <QMainWindow>
 #include <QMessageBox>
+#include <QPointer>
 #include <QQmlEngine>
 #include <QShortcut>
 #include <QStackedWidget>
+#include <QTimer>
 #include <QToolBar>
 #include <QUndoGroup>
 #include <QWindow>
@@ -149,6 +152,7 @@ MapEditor::MapEditor(QObject *parent)
     , mTilesetDock(new TilesetDock(mMainWindow))
     , mWangDock(new WangDock(mMainWindow))
     , mMiniMapDock(new MiniMapDock(mMainWindow))
+    , mWorldOverviewDock(new WorldOverviewDock(mMainWindow))
     , mLayerComboBox(new TreeViewComboBox)
     , mComboBoxProxyModel(new ComboBoxProxyModel(this))
     , mReversingProxyModel(new ReversingProxyModel(this))
@@ -383,6 +387,15 @@ void MapEditor::setCurrentDocument(Document *document)
     if (mCurrentMapDocument) {
         saveDocumentState(mCurrentMapDocument);
         mCurrentMapDocument->disconnect(this);
+
+        // Give the cell storage of the map we're switching away from a chance
+        // to shrink, once the user has settled elsewhere. Chunks are
+        // transparently expanded again when their cells are accessed.
+        const QPointer<MapDocument> coldDocument(mCurrentMapDocument);
+        QTimer::singleShot(10000, this, [coldDocument] {
+            if (coldDocument && DocumentManager::instance()->currentDocument() != coldDocument)
+                coldDocument->map()->compactLayers();
+        });
     }
 
     mCurrentMapDocument = mapDocument;
@@ -404,6 +417,7 @@ void MapEditor::setCurrentDocument(Document *document)
     mTilesetDock->setMapDocument(mapDocument);
     mWangDock->setDocument(mapDocument);
     mMiniMapDock->setMapDocument(mapDocument);
+    mWorldOverviewDock->setMapDocument(mapDocument);
 
     if (mapDocument) {
         connect(mapDocument, &MapDocument::currentLayerChanged,
@@ -483,6 +497,7 @@ QList<QDockWidget *> MapEditor::dockWidgets() const
         mTilesetDock,
         mWangDock,
         mMiniMapDock,
+        mWorldOverviewDock,
         mTileStampsDock
     };
 }
@@ -577,6 +592,8 @@ void MapEditor::resetLayout()
     mMainWindow->addDockWidget(Qt::RightDockWidgetArea, mLayerDock);
     mMainWindow->addDockWidget(Qt::RightDockWidgetArea, mObjectsDock);
     mMainWindow->addDockWidget(Qt::RightDockWidgetArea, mMiniMapDock);
+    mMainWindow->addDockWidget(Qt::RightDockWidgetArea, mWorldOverviewDock);
+    mMainWindow->tabifyDockWidget(mWorldOverviewDock, mMiniMapDock);
     mMainWindow->tabifyDockWidget(mMiniMapDock, mObjectsDock);
     mMainWindow->tabifyDockWidget(mObjectsDock, mLayerDock);
 
@@ -588,6 +605,7 @@ void MapEditor::resetLayout()
     // they are hidden by default.
     mUndoDock->setVisible(false);
     mTemplatesDock->setVisible(false);
+    mWorldOverviewDock->setVisible(false);
     mTileStampsDock->setVisible(false);
 }
 
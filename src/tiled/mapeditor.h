@@ -58,6 +58,7 @@ class ShapeFillTool;
 class StampBrush;
 class TemplatesDock;
 class TileStamp;
+class WorldOverviewDock;
 class TileStampManager;
 class TileStampsDock;
 class TilesetDock;
@@ -183,6 +184,7 @@ private:
     TilesetDock *mTilesetDock;
     WangDock *mWangDock;
     MiniMapDock* mMiniMapDock;
+    WorldOverviewDock *mWorldOverviewDock;
     TileStampsDock *mTileStampsDock;
 
     std::unique_ptr<TreeViewComboBox> mLayerComboBox;
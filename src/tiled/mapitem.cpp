@@ -32,9 +32,11 @@
 #include "maprenderer.h"
 #include "mapscene.h"
 #include "mapview.h"
+#include "objectgroup.h"
 #include "objectgroupitem.h"
 #include "objectselectionitem.h"
 #include "preferences.h"
+#include "tile.h"
 #include "tilelayer.h"
 #include "tilelayeritem.h"
 #include "tileselectionitem.h"
@@ -42,6 +44,7 @@
 #include "zoomable.h"
 
 #include <QCursor>
+#include <QElapsedTimer>
 #include <QGraphicsSceneMouseEvent>
 #include <QPen>
 #include <QStyleOptionGraphicsItem>
@@ -150,6 +153,7 @@ MapItem::MapItem(const MapDocumentPtr &mapDocument, DisplayMode displayMode,
     connect(prefs, &Preferences::showTileObjectOutlinesChanged, this, &MapItem::setShowTileObjectOutlines);
     connect(prefs, &Preferences::highlightCurrentLayerChanged, this, &MapItem::updateSelectedLayersHighlight);
     connect(prefs, &Preferences::propertyTypesChanged, this, &MapItem::syncAllObjectItems);
+    connect(prefs, &Preferences::softwareCompositingChanged, this, &MapItem::softwareCompositingChanged);
     connect(prefs, &Preferences::backgroundFadeColorChanged, this, [this] (QColor color) { mDarkRectangle->setBrush(color); });
 
     connect(mapDocument.data(), &Document::changed, this, &MapItem::documentChanged);
@@ -160,12 +164,14 @@ MapItem::MapItem(const MapDocumentPtr &mapDocument, DisplayMode displayMode,
     connect(mapDocument.data(), &MapDocument::layerAboutToBeRemoved, this, &MapItem::layerAboutToBeRemoved);
     connect(mapDocument.data(), &MapDocument::layerRemoved, this, &MapItem::layerRemoved);
     connect(mapDocument.data(), &MapDocument::selectedLayersChanged, this, &MapItem::updateSelectedLayersHighlight);
+    connect(mapDocument.data(), &MapDocument::layerFrozenChanged, this, &MapItem::layerFrozenChanged);
     connect(mapDocument.data(), &MapDocument::tilesetTilePositioningChanged, this, &MapItem::adaptToTilesetTileSizeChanges);
     connect(mapDocument.data(), &MapDocument::tileImageSourceChanged, this, &MapItem::adaptToTileSizeChanges);
     connect(mapDocument.data(), &MapDocument::tileObjectGroupChanged, this, &MapItem::tileObjectGroupChanged);
     connect(mapDocument.data(), &MapDocument::tilesetReplaced, this, &MapItem::tilesetReplaced);
     connect(mapDocument.data(), &MapDocument::objectsInserted, this, &MapItem::objectsInserted);
     connect(mapDocument.data(), &MapDocument::objectsIndexChanged, this, &MapItem::objectsIndexChanged);
+    connect(mapDocument.data(), &MapDocument::objectsReordered, this, &MapItem::objectsReordered);
 
     updateBoundingRect();
 
@@ -204,6 +210,7 @@ MapItem::MapItem(const MapDocumentPtr &mapDocument, DisplayMode displayMode,
 
 MapItem::~MapItem()
 {
+    mCollisionShapesJob.cancel();
 }
 
 void MapItem::setDisplayMode(DisplayMode displayMode)
@@ -249,6 +256,10 @@ void MapItem::setShowTileCollisionShapes(bool enabled)
 {
     mapDocument()->renderer()->setFlag(ShowTileCollisionShapes, enabled);
 
+    mCollisionShapesJob.cancel();
+    if (enabled)
+        warmTileCollisionShapes();
+
     for (MapObjectItem *item : std::as_const(mObjectItems))
         if (Tile *tile = item->mapObject()->cell().tile())
             if (tile->objectGroup() && !tile->objectGroup()->isEmpty())
@@ -259,13 +270,80 @@ void MapItem::setShowTileCollisionShapes(bool enabled)
             item->update();
 }
 
+/**
+ * Builds the collision shapes of all tiles that have any, on a worker, so
+ * that they are ready by the time scrolling brings their tiles into view.
+ * The visible tiles may beat the worker to it and build their shapes on
+ * first paint, which is fine since that covers far fewer tiles.
+ */
+void MapItem::warmTileCollisionShapes()
+{
+    struct Entry {
+        Tile *tile;
+        ObjectGroup *objectGroup;           // identity check on delivery
+        std::shared_ptr<ObjectGroup> clone;
+        SharedTileset tileset;              // keeps the tile alive
+        QVector<QPainterPath> shapes;
+    };
+    using Entries = std::shared_ptr<QVector<Entry>>;
+
+    // Snapshot the collision object groups, so that the worker doesn't read
+    // tile data the user may be editing meanwhile
+    auto entries = std::make_shared<QVector<Entry>>();
+    for (const SharedTileset &tileset : mapDocument()->map()->tilesets()) {
+        for (Tile *tile : tileset->tiles()) {
+            ObjectGroup *objectGroup = tile->objectGroup();
+            if (!objectGroup || objectGroup->isEmpty())
+                continue;
+
+            entries->append({ tile, objectGroup,
+                              std::shared_ptr<ObjectGroup>(objectGroup->clone()),
+                              tileset, {} });
+        }
+    }
+
+    if (entries->isEmpty())
+        return;
+
+    mCollisionShapesJob = JobScheduler::schedule<Entries>(
+                JobScheduler::IdlePriority,
+                [entries] (const JobScheduler::Token &token) {
+        for (Entry &entry : *entries) {
+            if (token.isCancelled())
+                break;
+            entry.shapes = Tile::buildCollisionShapes(*entry.clone,
+                                                      *entry.tileset);
+        }
+        return entries;
+    }, this, [] (const Entries &entries) {
+        for (Entry &entry : *entries) {
+            // Skip tiles whose collision changed since the snapshot
+            if (entry.tile->objectGroup() != entry.objectGroup)
+                continue;
+            entry.tile->setCollisionShapes(std::move(entry.shapes));
+        }
+    });
+}
+
 void MapItem::updateLayerPositions()
 {
     const MapScene *mapScene = static_cast<MapScene*>(scene());
 
+    // This runs for every layer item on each scroll tick when parallax is
+    // enabled, so compute the shared part of the parallax offsets only once.
+    // Layers with the default parallax factor resolve to their unchanged
+    // position, which setPos ignores.
+    const bool parallaxEnabled = mapScene->isParallaxEnabled();
+    const QPointF referencePoint = parallaxEnabled
+            ? mapScene->parallaxReferencePoint(mapDocument()->map())
+            : QPointF();
+
     for (LayerItem *layerItem : std::as_const(mLayerItems)) {
         const Layer &layer = *layerItem->layer();
-        layerItem->setPos(mapScene->layerItemPosition(layer));
+        QPointF pos = layer.offset();
+        if (parallaxEnabled && !layer.isGroupLayer())
+            pos += MapScene::parallaxOffset(layer, referencePoint);
+        layerItem->setPos(pos);
     }
 
     if (mDisplayMode == Editable) {
@@ -342,13 +420,98 @@ void MapItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
     QGraphicsItem::mouseReleaseEvent(event);
 }
 
+/**
+ * Drops the cached composited chunks of all tile layers referencing the
+ * given \a tileset. Called when the tileset repaints, for example because a
+ * tile animation advanced.
+ */
+void MapItem::invalidateTileLayerRenderCaches(Tileset *tileset)
+{
+    for (QGraphicsItem *item : std::as_const(mLayerItems))
+        if (TileLayerItem *tileLayerItem = dynamic_cast<TileLayerItem*>(item))
+            if (tileLayerItem->tileLayer()->referencesTileset(tileset))
+                tileLayerItem->invalidateRenderCache();
+}
+
+/**
+ * Pre-renders chunk pixmaps in a ring just outside the given view rectangle
+ * for all visible tile layers that draw from the render cache, prioritized
+ * by the recent scroll \a velocity (in scene coordinates per second).
+ *
+ * Spends at most a few milliseconds per call, so that it can run between
+ * frames without delaying input handling. Returns whether uncached chunks
+ * remain, in which case another call should be scheduled.
+ */
+bool MapItem::prefetchRenderCaches(const QRectF &viewRect, QPointF velocity)
+{
+    constexpr qint64 budgetMs = 10;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (QGraphicsItem *item : std::as_const(mLayerItems)) {
+        if (!item->isVisible())
+            continue;
+        if (TileLayerItem *tileLayerItem = dynamic_cast<TileLayerItem*>(item))
+            if (tileLayerItem->prefetchRenderCache(viewRect, velocity, timer, budgetMs))
+                return true;
+    }
+
+    return false;
+}
+
+void MapItem::softwareCompositingChanged()
+{
+    // Drop the chunk pixmaps so that layers which no longer use them don't
+    // keep them in memory; layers that still qualify rebuild them lazily
+    for (QGraphicsItem *item : std::as_const(mLayerItems)) {
+        if (TileLayerItem *tileLayerItem = dynamic_cast<TileLayerItem*>(item)) {
+            tileLayerItem->invalidateRenderCache();
+            tileLayerItem->update();
+        }
+    }
+}
+
+/**
+ * Rebuilds the render cache of the given \a layer when it was frozen or
+ * unfrozen (see MapDocument::setLayerFrozen).
+ */
+void MapItem::layerFrozenChanged(Layer *layer)
+{
+    if (auto item = mLayerItems.value(layer)) {
+        if (auto tileLayerItem = dynamic_cast<TileLayerItem*>(item)) {
+            tileLayerItem->invalidateRenderCache();
+            tileLayerItem->update();
+        }
+    }
+}
+
 void MapItem::repaintRegion(const QRegion &region, TileLayer *tileLayer)
 {
     const MapRenderer *renderer = mapDocument()->renderer();
     const QMargins margins = mapDocument()->map()->drawMargins();
     TileLayerItem *tileLayerItem = static_cast<TileLayerItem*>(mLayerItems.value(tileLayer));
 
-    for (const QRect &r : region) {
+    tileLayerItem->invalidateRenderCache(region);
+
+    // Coalesce fragmented regions to chunk-aligned rects. Brush strokes and
+    // undo commands can report hundreds of small rects, and snapping them to
+    // the chunk grid merges those into a few update requests. Small regions
+    // are repainted exactly, so single-cell edits don't repaint whole chunks.
+    QRegion repaintRegion = region;
+    if (repaintRegion.rectCount() > 16) {
+        QRegion chunkRegion;
+        for (const QRect &r : region) {
+            const int left = r.left() & ~CHUNK_MASK;
+            const int top = r.top() & ~CHUNK_MASK;
+            const int right = r.right() | CHUNK_MASK;
+            const int bottom = r.bottom() | CHUNK_MASK;
+            chunkRegion += QRect(QPoint(left, top), QPoint(right, bottom));
+        }
+        repaintRegion = chunkRegion;
+    }
+
+    for (const QRect &r : repaintRegion) {
         QRectF boundingRect = renderer->boundingRect(r).marginsAdded(margins);
         tileLayerItem->update(boundingRect);
     }
@@ -388,7 +551,8 @@ void MapItem::documentChanged(const ChangeEvent &change)
         break;
     case ChangeEvent::MapObjectAboutToBeRemoved: {
         auto &e = static_cast<const MapObjectEvent&>(change);
-        deleteObjectItem(e.objectGroup->objectAt(e.index));
+        for (int i = 0; i < e.count; ++i)
+            deleteObjectItem(e.objectGroup->objectAt(e.index + i));
         break;
     }
     case ChangeEvent::MapObjectsChanged:
@@ -492,7 +656,22 @@ void MapItem::layerAboutToBeRemoved(GroupLayer *parentLayer, int index)
 
 void MapItem::layerRemoved(Layer *layer)
 {
-    deleteLayerItems(layer);
+    // A layer that is being moved or reparented is removed and immediately
+    // re-inserted. Keep its items around until the end of the event loop
+    // cycle, so that createLayerItem can rebind them instead of recreating
+    // the entire item hierarchy.
+    if (LayerItem *layerItem = mLayerItems.value(layer)) {
+        unregisterLayerItems(layer);
+        layerItem->setVisible(false);
+        layerItem->setParentItem(this);
+
+        if (mPooledLayerItems.isEmpty())
+            QMetaObject::invokeMethod(this, &MapItem::deletePooledLayerItems,
+                                      Qt::QueuedConnection);
+
+        mPooledLayerItems.insert(layer, layerItem);
+    }
+
     updateBoundingRect();
     updateSelectedLayersHighlight();
 }
@@ -548,6 +727,9 @@ void MapItem::layerTintColorChanged(Layer *layer)
 {
     switch (layer->layerType()) {
     case Layer::TileLayerType:
+        static_cast<TileLayerItem*>(mLayerItems.value(layer))->invalidateRenderCache();
+        mLayerItems.value(layer)->update();
+        break;
     case Layer::ImageLayerType:
         mLayerItems.value(layer)->update();
         break;
@@ -680,6 +862,14 @@ void MapItem::objectsIndexChanged(ObjectGroup *objectGroup,
     if (objectGroup->drawOrder() != ObjectGroup::IndexOrder)
         return;
 
+    // Once objects in this group have fractional Z values, a partial
+    // re-assignment of index-based values could order items incorrectly
+    // relative to the untouched ones, so renumber the entire group.
+    if (mFractionalObjectZ.remove(objectGroup)) {
+        first = 0;
+        last = objectGroup->objectCount() - 1;
+    }
+
     for (int i = first; i <= last; ++i) {
         MapObjectItem *item = mObjectItems.value(objectGroup->objectAt(i));
         Q_ASSERT(item);
@@ -688,6 +878,58 @@ void MapItem::objectsIndexChanged(ObjectGroup *objectGroup,
     }
 }
 
+/**
+ * Re-assigns the Z values of a block of objects that was moved to a new
+ * position within its group.
+ *
+ * Since the Z values only need to be monotonic with the object index, the
+ * moved items get fractional values between those of their new neighbors.
+ * This keeps reordering proportional to the number of moved objects rather
+ * than the number of objects they jumped over. When repeated moves into the
+ * same gap exhaust its precision, the entire group falls back to its
+ * canonical index-based values.
+ */
+void MapItem::objectsReordered(ObjectGroup *objectGroup, int first, int last)
+{
+    if (objectGroup->drawOrder() != ObjectGroup::IndexOrder)
+        return;
+
+    const int lastIndex = objectGroup->objectCount() - 1;
+
+    // The open interval between the Z values of the new neighbors. Items
+    // always keep a Z value below the object count, so that newly appended
+    // objects can take their index as Z value.
+    const qreal zBefore = first > 0
+            ? mObjectItems.value(objectGroup->objectAt(first - 1))->zValue()
+            : -1.0;
+    const qreal zAfter = last < lastIndex
+            ? mObjectItems.value(objectGroup->objectAt(last + 1))->zValue()
+            : lastIndex + 1.0;
+
+    const int count = last - first + 1;
+    const qreal step = (zAfter - zBefore) / (count + 1);
+
+    qreal previous = zBefore;
+
+    for (int i = first; i <= last; ++i) {
+        const qreal z = zBefore + step * (i - first + 1);
+        if (!(z > previous && z < zAfter)) {
+            // The gap can no longer represent distinct positions
+            mFractionalObjectZ.insert(objectGroup);
+            objectsIndexChanged(objectGroup, 0, lastIndex);
+            return;
+        }
+
+        MapObjectItem *item = mObjectItems.value(objectGroup->objectAt(i));
+        Q_ASSERT(item);
+
+        item->setZValue(z);
+        previous = z;
+    }
+
+    mFractionalObjectZ.insert(objectGroup);
+}
+
 void MapItem::syncAllObjectItems()
 {
     for (MapObjectItem *item : std::as_const(mObjectItems))
@@ -730,12 +972,26 @@ void MapItem::createLayerItems(const QList<Layer *> &layers)
 
 LayerItem *MapItem::createLayerItem(Layer *layer)
 {
-    LayerItem *layerItem = nullptr;
-
     QGraphicsItem *parent = this;
     if (layer->parentLayer())
         parent = mLayerItems.value(layer->parentLayer());
 
+    // Reuse the items of a layer that was removed earlier in this event loop
+    // cycle, which happens when a layer is moved or reparented.
+    if (LayerItem *layerItem = mPooledLayerItems.take(layer)) {
+        registerLayerItems(layerItem);
+        layerItem->setParentItem(parent);
+
+        if (const MapScene *mapScene = static_cast<MapScene*>(scene()))
+            layerItem->setPos(mapScene->layerItemPosition(*layer));
+
+        layerItem->setVisible(layer->isVisible());
+        layerItem->setEnabled(mDisplayMode == Editable);
+        return layerItem;
+    }
+
+    LayerItem *layerItem = nullptr;
+
     switch (layer->layerType()) {
     case Layer::TileLayerType:
         layerItem = new TileLayerItem(static_cast<TileLayer*>(layer), mapDocument(), parent);
@@ -757,6 +1013,7 @@ LayerItem *MapItem::createLayerItem(Layer *layer)
             mObjectItems.insert(object, item);
             ++objectIndex;
         }
+        mFractionalObjectZ.remove(og);
         layerItem = ogItem;
         break;
     }
@@ -789,25 +1046,56 @@ LayerItem *MapItem::createLayerItem(Layer *layer)
     return layerItem;
 }
 
-void MapItem::deleteLayerItems(Layer *layer)
+/**
+ * Re-inserts the given \a layerItem and any of its descendant items into
+ * mLayerItems and mObjectItems, when rebinding a pooled item hierarchy.
+ */
+void MapItem::registerLayerItems(LayerItem *layerItem)
+{
+    Layer *layer = layerItem->layer();
+    mLayerItems.insert(layer, layerItem);
+
+    switch (layer->layerType()) {
+    case Layer::TileLayerType:
+    case Layer::ImageLayerType:
+        break;
+    case Layer::ObjectGroupType:
+        for (QGraphicsItem *child : layerItem->childItems())
+            if (MapObjectItem *objectItem = dynamic_cast<MapObjectItem*>(child))
+                mObjectItems.insert(objectItem->mapObject(), objectItem);
+        break;
+    case Layer::GroupLayerType:
+        for (QGraphicsItem *child : layerItem->childItems())
+            if (LayerItem *childLayerItem = dynamic_cast<LayerItem*>(child))
+                registerLayerItems(childLayerItem);
+        break;
+    }
+}
+
+void MapItem::unregisterLayerItems(Layer *layer)
 {
     switch (layer->layerType()) {
     case Layer::TileLayerType:
     case Layer::ImageLayerType:
         break;
     case Layer::ObjectGroupType:
-        // Delete any object items
         for (auto object : static_cast<ObjectGroup*>(layer)->objects())
-            delete mObjectItems.take(object);
+            mObjectItems.remove(object);
         break;
     case Layer::GroupLayerType:
         // Recurse into group layers
         for (auto childLayer : static_cast<GroupLayer*>(layer)->layers())
-            deleteLayerItems(childLayer);
+            unregisterLayerItems(childLayer);
         break;
     }
 
-    delete mLayerItems.take(layer);
+    mLayerItems.remove(layer);
+}
+
+void MapItem::deletePooledLayerItems()
+{
+    qDeleteAll(mPooledLayerItems);
+    mPooledLayerItems.clear();
 }
 
 void MapItem::updateBoundingRect()
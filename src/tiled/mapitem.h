@@ -20,10 +20,12 @@
 
 #pragma once
 
+#include "jobscheduler.h"
 #include "mapdocument.h"
 
 #include <QGraphicsObject>
 #include <QMap>
+#include <QSet>
 
 #include <memory>
 
@@ -76,6 +78,9 @@ public:
 
     void updateLayerPositions();
 
+    void invalidateTileLayerRenderCaches(Tileset *tileset);
+    bool prefetchRenderCaches(const QRectF &viewRect, QPointF velocity);
+
     // QGraphicsItem
     QRectF boundingRect() const override;
     void paint(QPainter *, const QStyleOptionGraphicsItem *,
@@ -97,6 +102,7 @@ private:
      * Repaints the specified \a region of the given \a tileLayer. The region
      * is in tile coordinates.
      */
+    void layerFrozenChanged(Layer *layer);
     void repaintRegion(const QRegion &region, TileLayer *tileLayer);
 
     void documentChanged(const ChangeEvent &change);
@@ -121,15 +127,20 @@ private:
     void deleteObjectItem(MapObject *object);
     void syncObjectItems(const QList<MapObject*> &objects);
     void objectsIndexChanged(ObjectGroup *objectGroup, int first, int last);
+    void objectsReordered(ObjectGroup *objectGroup, int first, int last);
 
     void syncAllObjectItems();
 
     void setObjectLineWidth(qreal lineWidth);
     void setShowTileObjectOutlines(bool enabled);
+    void softwareCompositingChanged();
+    void warmTileCollisionShapes();
 
     void createLayerItems(const QList<Layer *> &layers);
     LayerItem *createLayerItem(Layer *layer);
-    void deleteLayerItems(Layer *layer);
+    void registerLayerItems(LayerItem *layerItem);
+    void unregisterLayerItems(Layer *layer);
+    void deletePooledLayerItems();
 
     void updateBoundingRect();
     void updateSelectedLayersHighlight();
@@ -141,10 +152,13 @@ private:
     std::unique_ptr<TileGridItem> mTileGridItem;
     std::unique_ptr<ObjectSelectionItem> mObjectSelectionItem;
     QMap<Layer*, LayerItem*> mLayerItems;
+    QMap<Layer*, LayerItem*> mPooledLayerItems;
     QMap<MapObject*, MapObjectItem*> mObjectItems;
+    QSet<ObjectGroup*> mFractionalObjectZ;
     DisplayMode mDisplayMode;
     QRectF mBoundingRect;
     bool mIsHovered = false;
+    JobScheduler::Token mCollisionShapesJob;
 };
 
 inline MapDocument *MapItem::mapDocument() const
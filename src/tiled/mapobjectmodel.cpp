@@ -394,10 +394,14 @@ void MapObjectModel::setMapDocument(MapDocument *mapDocument)
     mMap = nullptr;
 
     mFilteredLayers.clear();
+    mObjectsById.clear();
 
     if (mMapDocument) {
         mMap = mMapDocument->map();
 
+        for (Layer *layer : mMap->layers())
+            registerObjects(layer);
+
         connect(mMapDocument, &MapDocument::layerAdded,
                 this, &MapObjectModel::layerAdded);
         connect(mMapDocument, &MapDocument::layerAboutToBeRemoved,
@@ -412,6 +416,8 @@ void MapObjectModel::setMapDocument(MapDocument *mapDocument)
 
 void MapObjectModel::layerAdded(Layer *layer)
 {
+    registerObjects(layer);
+
     if (layer->isObjectGroup() || layer->isGroupLayer()) {
         auto &filtered = filteredChildLayers(layer->parentLayer());
         if (filtered.contains(layer))
@@ -445,6 +451,8 @@ void MapObjectModel::layerAboutToBeRemoved(GroupLayer *groupLayer, int index)
     const auto &layers = groupLayer ? groupLayer->layers() : mMap->layers();
     Layer *layer = layers.at(index);
 
+    deregisterObjects(layer);
+
     if (layer->isObjectGroup() || layer->isGroupLayer()) {
         auto &filtered = filteredChildLayers(groupLayer);
         const int row = filtered.indexOf(layer);
@@ -488,6 +496,38 @@ void MapObjectModel::classChanged(const QList<Object *> &objects)
     emitDataChanged(affectedObjects, columns);
 }
 
+void MapObjectModel::registerObjects(Layer *layer)
+{
+    switch (layer->layerType()) {
+    case Layer::ObjectGroupType:
+        for (MapObject *mapObject : static_cast<ObjectGroup*>(layer)->objects())
+            mObjectsById.insert(mapObject->id(), mapObject);
+        break;
+    case Layer::GroupLayerType:
+        for (Layer *childLayer : static_cast<GroupLayer*>(layer)->layers())
+            registerObjects(childLayer);
+        break;
+    default:
+        break;
+    }
+}
+
+void MapObjectModel::deregisterObjects(Layer *layer)
+{
+    switch (layer->layerType()) {
+    case Layer::ObjectGroupType:
+        for (MapObject *mapObject : static_cast<ObjectGroup*>(layer)->objects())
+            mObjectsById.remove(mapObject->id());
+        break;
+    case Layer::GroupLayerType:
+        for (Layer *childLayer : static_cast<GroupLayer*>(layer)->layers())
+            deregisterObjects(childLayer);
+        break;
+    default:
+        break;
+    }
+}
+
 QList<Layer *> &MapObjectModel::filteredChildLayers(GroupLayer *parentLayer) const
 {
     if (!mFilteredLayers.contains(parentLayer)) {
@@ -538,18 +578,26 @@ void MapObjectModel::documentChanged(const ChangeEvent &change)
         break;
     }
     case ChangeEvent::MapObjectsAboutToBeRemoved:
+        // rows are handled by the individual events instead
+        for (MapObject *mapObject : static_cast<const MapObjectsEvent&>(change).mapObjects)
+            mObjectsById.remove(mapObject->id());
+        break;
     case ChangeEvent::MapObjectsAdded:
+        // rows are handled by the individual events instead
+        for (MapObject *mapObject : static_cast<const MapObjectsEvent&>(change).mapObjects)
+            mObjectsById.insert(mapObject->id(), mapObject);
+        break;
     case ChangeEvent::MapObjectsRemoved:
         // handled individually instead
         break;
     case ChangeEvent::MapObjectAboutToBeAdded: {
         auto &e = static_cast<const MapObjectEvent&>(change);
-        beginInsertRows(index(e.objectGroup), e.index, e.index);
+        beginInsertRows(index(e.objectGroup), e.index, e.index + e.count - 1);
         break;
     }
     case ChangeEvent::MapObjectAboutToBeRemoved: {
         auto &e = static_cast<const MapObjectEvent&>(change);
-        beginRemoveRows(index(e.objectGroup), e.index, e.index);
+        beginRemoveRows(index(e.objectGroup), e.index, e.index + e.count - 1);
         break;
     }
     case ChangeEvent::MapObjectAdded:
@@ -24,6 +24,7 @@
 #include "mapobject.h"
 
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QIcon>
 
 namespace Tiled {
@@ -106,11 +107,20 @@ public:
     void setMapDocument(MapDocument *mapDocument);
     MapDocument *mapDocument() const { return mMapDocument; }
 
+    /**
+     * Returns the object with the given \a id, or nullptr when no such
+     * object exists. Backed by an index over all objects on the map, making
+     * it much faster than Map::findObjectById for maps with many objects.
+     */
+    MapObject *findObjectById(int id) const { return mObjectsById.value(id); }
+
     void moveObjects(ObjectGroup *og, int from, int to, int count);
 
 private:
     void layerAdded(Layer *layer);
     void layerAboutToBeRemoved(GroupLayer *groupLayer, int index);
+    void registerObjects(Layer *layer);
+    void deregisterObjects(Layer *layer);
     void classChanged(const QList<Object *> &objects);
     void documentChanged(const ChangeEvent &change);
 
@@ -125,6 +135,9 @@ private:
     mutable QMap<GroupLayer*, QList<Layer*>> mFilteredLayers;
     QList<Layer *> &filteredChildLayers(GroupLayer *parentLayer) const;
 
+    // index of objects by ID (see findObjectById)
+    QHash<int, MapObject*> mObjectsById;
+
     QIcon mObjectGroupIcon;
 };
 
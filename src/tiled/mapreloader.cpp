@@ -0,0 +1,497 @@
+/*
+ * mapreloader.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mapreloader.h"
+
+#include "changeevents.h"
+#include "grouplayer.h"
+#include "imagelayer.h"
+#include "layermodel.h"
+#include "map.h"
+#include "mapdocument.h"
+#include "objectgroup.h"
+#include "tilelayer.h"
+
+#include <QHash>
+#include <QSet>
+
+using namespace Tiled;
+
+static bool compatibleParameters(const Map::Parameters &a,
+                                 const Map::Parameters &b)
+{
+    return a.orientation == b.orientation
+            && a.renderOrder == b.renderOrder
+            && a.width == b.width
+            && a.height == b.height
+            && a.tileWidth == b.tileWidth
+            && a.tileHeight == b.tileHeight
+            && a.infinite == b.infinite
+            && a.hexSideLength == b.hexSideLength
+            && a.staggerAxis == b.staggerAxis
+            && a.staggerIndex == b.staggerIndex
+            && a.parallaxOrigin == b.parallaxOrigin
+            && a.backgroundColor == b.backgroundColor;
+}
+
+/**
+ * Whether the objects of \a newGroup can be applied to \a oldGroup. Objects
+ * are matched by id, so each group may only have unique, valid ids and the
+ * matched objects need to be in the same relative order.
+ */
+static bool compatibleObjects(const ObjectGroup &oldGroup,
+                              const ObjectGroup &newGroup)
+{
+    QHash<int, int> oldIndexById;
+    for (int i = 0; i < oldGroup.objectCount(); ++i) {
+        const int id = oldGroup.objectAt(i)->id();
+        if (id <= 0 || oldIndexById.contains(id))
+            return false;
+        oldIndexById.insert(id, i);
+    }
+
+    QSet<int> seen;
+    int lastMatched = -1;
+
+    for (const MapObject *object : newGroup.objects()) {
+        const int id = object->id();
+        if (id <= 0 || seen.contains(id))
+            return false;
+        seen.insert(id);
+
+        const int oldIndex = oldIndexById.value(id, -1);
+        if (oldIndex == -1)
+            continue;           // added object
+
+        if (oldIndex <= lastMatched)
+            return false;       // objects were reordered
+
+        lastMatched = oldIndex;
+    }
+
+    return true;
+}
+
+/**
+ * Whether \a newLayers can be applied to \a oldLayers. Layers are matched by
+ * id and must keep their type and relative order; additions and removals are
+ * fine.
+ */
+static bool compatibleLayers(const QList<Layer *> &oldLayers,
+                             const QList<Layer *> &newLayers)
+{
+    QHash<int, int> oldIndexById;
+    for (int i = 0; i < oldLayers.size(); ++i) {
+        const int id = oldLayers.at(i)->id();
+        if (id <= 0 || oldIndexById.contains(id))
+            return false;
+        oldIndexById.insert(id, i);
+    }
+
+    QSet<int> seen;
+    int lastMatched = -1;
+
+    for (Layer *newLayer : newLayers) {
+        const int id = newLayer->id();
+        if (id <= 0 || seen.contains(id))
+            return false;
+        seen.insert(id);
+
+        const int oldIndex = oldIndexById.value(id, -1);
+        if (oldIndex == -1)
+            continue;           // added layer
+
+        if (oldIndex <= lastMatched)
+            return false;       // layers were reordered
+
+        lastMatched = oldIndex;
+
+        Layer *oldLayer = oldLayers.at(oldIndex);
+        if (oldLayer->layerType() != newLayer->layerType())
+            return false;
+
+        switch (oldLayer->layerType()) {
+        case Layer::TileLayerType:
+            if (oldLayer->position() != newLayer->position())
+                return false;
+            break;
+        case Layer::ObjectGroupType:
+            if (!compatibleObjects(*static_cast<ObjectGroup*>(oldLayer),
+                                   *static_cast<ObjectGroup*>(newLayer)))
+                return false;
+            break;
+        case Layer::GroupLayerType:
+            if (!compatibleLayers(static_cast<GroupLayer*>(oldLayer)->layers(),
+                                  static_cast<GroupLayer*>(newLayer)->layers()))
+                return false;
+            break;
+        case Layer::ImageLayerType:
+            break;
+        }
+    }
+
+    return true;
+}
+
+MapReloader::MapReloader(MapDocument *mapDocument)
+    : mMapDocument(mapDocument)
+{
+}
+
+/**
+ * Applies the given freshly loaded \a map to the document.
+ *
+ * Returns false without modifying anything when the map is structurally too
+ * different to be expressed as changes to the current map, in which case the
+ * caller should fall back to replacing the document.
+ */
+bool MapReloader::apply(const Map &map)
+{
+    Map *target = mMapDocument->map();
+
+    // External tilesets resolve to the same shared instances, so a changed
+    // list means tilesets were added, removed, reordered or are embedded.
+    if (target->tilesets() != map.tilesets())
+        return false;
+
+    if (!compatibleParameters(target->parameters(), map.parameters()))
+        return false;
+
+    if (!compatibleLayers(target->layers(), map.layers()))
+        return false;
+
+    syncLayers(nullptr, map.layers());
+
+    if (target->properties() != map.properties())
+        mMapDocument->setProperties(target, map.properties());
+
+    if (target->className() != map.className()) {
+        target->setClassName(map.className());
+        emit mMapDocument->changed(ObjectsChangeEvent({ target },
+                                                      ObjectsChangeEvent::ClassProperty));
+    }
+
+    // Carry over the editor settings and id counters, which nothing observes
+    // but which affect how the map is saved and extended.
+    target->setCompressionLevel(map.compressionLevel());
+    target->setChunkSize(map.chunkSize());
+    target->setLayerDataFormat(map.layerDataFormat());
+    target->setNextLayerId(qMax(target->nextLayerId(), map.nextLayerId()));
+    target->setNextObjectId(qMax(target->nextObjectId(), map.nextObjectId()));
+
+    mRemovedLayers.clear();
+    mRemovedObjects.clear();
+
+    return true;
+}
+
+/**
+ * Brings the child layers of \a parentLayer (the map itself when null) in
+ * sync with \a newLayers, removing, inserting and updating layers through
+ * the layer model so that all views adjust incrementally.
+ */
+void MapReloader::syncLayers(GroupLayer *parentLayer,
+                             const QList<Layer *> &newLayers)
+{
+    LayerModel *layerModel = mMapDocument->layerModel();
+
+    const auto currentLayers = [&] {
+        return parentLayer ? parentLayer->layers()
+                           : mMapDocument->map()->layers();
+    };
+
+    QSet<int> newIds;
+    for (Layer *newLayer : newLayers)
+        newIds.insert(newLayer->id());
+
+    // Remove layers that are no longer present
+    const auto oldLayers = currentLayers();
+    for (int i = oldLayers.size() - 1; i >= 0; --i)
+        if (!newIds.contains(oldLayers.at(i)->id()))
+            mRemovedLayers.emplace_back(layerModel->takeLayerAt(parentLayer, i));
+
+    // The remaining layers match the new list in order, so a new layer at a
+    // position where the ids differ is an insertion.
+    for (int i = 0; i < newLayers.size(); ++i) {
+        Layer *newLayer = newLayers.at(i);
+        const auto layers = currentLayers();
+        Layer *oldLayer = i < layers.size() ? layers.at(i) : nullptr;
+
+        if (oldLayer && oldLayer->id() == newLayer->id())
+            syncLayer(oldLayer, newLayer);
+        else
+            layerModel->insertLayer(parentLayer, i, newLayer->clone());
+    }
+}
+
+void MapReloader::syncLayer(Layer *target, const Layer *source)
+{
+    int changedProperties = 0;
+
+    if (target->name() != source->name()) {
+        target->setName(source->name());
+        changedProperties |= LayerChangeEvent::NameProperty;
+    }
+    if (target->opacity() != source->opacity()) {
+        target->setOpacity(source->opacity());
+        changedProperties |= LayerChangeEvent::OpacityProperty;
+    }
+    if (target->isVisible() != source->isVisible()) {
+        target->setVisible(source->isVisible());
+        changedProperties |= LayerChangeEvent::VisibleProperty;
+    }
+    if (target->isLocked() != source->isLocked()) {
+        target->setLocked(source->isLocked());
+        changedProperties |= LayerChangeEvent::LockedProperty;
+    }
+    if (target->tintColor() != source->tintColor()) {
+        target->setTintColor(source->tintColor());
+        changedProperties |= LayerChangeEvent::TintColorProperty;
+    }
+    if (target->offset() != source->offset()) {
+        target->setOffset(source->offset());
+        changedProperties |= LayerChangeEvent::OffsetProperty;
+    }
+    if (target->parallaxFactor() != source->parallaxFactor()) {
+        target->setParallaxFactor(source->parallaxFactor());
+        changedProperties |= LayerChangeEvent::ParallaxFactorProperty;
+    }
+
+    if (changedProperties)
+        emit mMapDocument->changed(LayerChangeEvent(target, changedProperties));
+
+    if (target->className() != source->className()) {
+        target->setClassName(source->className());
+        emit mMapDocument->changed(ObjectsChangeEvent({ target },
+                                                      ObjectsChangeEvent::ClassProperty));
+    }
+
+    if (target->properties() != source->properties())
+        mMapDocument->setProperties(target, source->properties());
+
+    switch (target->layerType()) {
+    case Layer::TileLayerType:
+        syncTileLayer(static_cast<TileLayer*>(target),
+                      static_cast<const TileLayer*>(source));
+        break;
+    case Layer::ObjectGroupType:
+        syncObjectGroup(static_cast<ObjectGroup*>(target),
+                        static_cast<const ObjectGroup*>(source));
+        break;
+    case Layer::ImageLayerType:
+        syncImageLayer(static_cast<ImageLayer*>(target),
+                       static_cast<const ImageLayer*>(source));
+        break;
+    case Layer::GroupLayerType:
+        syncLayers(static_cast<GroupLayer*>(target),
+                   static_cast<const GroupLayer*>(source)->layers());
+        break;
+    }
+}
+
+void MapReloader::syncTileLayer(TileLayer *target, const TileLayer *source)
+{
+    if (target->size() != source->size()) {
+        target->setSize(source->size());
+        emit mMapDocument->changed(TileLayerChangeEvent(target,
+                                                        TileLayerChangeEvent::SizeProperty));
+    }
+
+    const QRegion diff = target->computeDiffRegion(*source);
+    if (!diff.isEmpty()) {
+        target->setCells(0, 0, source, diff);
+        mMapDocument->emitRegionChanged(diff.translated(target->position()),
+                                        target);
+    }
+}
+
+void MapReloader::syncImageLayer(ImageLayer *target, const ImageLayer *source)
+{
+    int changedProperties = 0;
+
+    if (target->transparentColor() != source->transparentColor()) {
+        target->setTransparentColor(source->transparentColor());
+        changedProperties |= ImageLayerChangeEvent::TransparentColorProperty;
+    }
+    if (target->imageSource() != source->imageSource())
+        changedProperties |= ImageLayerChangeEvent::ImageSourceProperty;
+
+    if (changedProperties)
+        target->loadFromImage(source->imageSource());
+
+    if (target->repeatX() != source->repeatX()
+            || target->repeatY() != source->repeatY()) {
+        target->setRepeatX(source->repeatX());
+        target->setRepeatY(source->repeatY());
+        changedProperties |= ImageLayerChangeEvent::RepeatProperty;
+    }
+
+    if (changedProperties)
+        emit mMapDocument->changed(ImageLayerChangeEvent(target, changedProperties));
+}
+
+void MapReloader::syncObjectGroup(ObjectGroup *target, const ObjectGroup *source)
+{
+    if (target->color() != source->color()) {
+        target->setColor(source->color());
+        emit mMapDocument->changed(ObjectGroupChangeEvent(target,
+                                                          ObjectGroupChangeEvent::ColorProperty));
+    }
+    if (target->drawOrder() != source->drawOrder()) {
+        target->setDrawOrder(source->drawOrder());
+        emit mMapDocument->changed(ObjectGroupChangeEvent(target,
+                                                          ObjectGroupChangeEvent::DrawOrderProperty));
+    }
+
+    QSet<int> newIds;
+    for (const MapObject *object : source->objects())
+        newIds.insert(object->id());
+
+    // Remove objects that are no longer present
+    for (int i = target->objectCount() - 1; i >= 0; --i) {
+        MapObject *object = target->objectAt(i);
+        if (newIds.contains(object->id()))
+            continue;
+
+        emit mMapDocument->changed(MapObjectsEvent(ChangeEvent::MapObjectsAboutToBeRemoved,
+                                                   { object }));
+        emit mMapDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAboutToBeRemoved,
+                                                  target, i, 1));
+        target->removeObjectAt(i);
+        emit mMapDocument->changed(MapObjectEvent(ChangeEvent::MapObjectRemoved,
+                                                  target, i, 1));
+        emit mMapDocument->changed(MapObjectsEvent(ChangeEvent::MapObjectsRemoved,
+                                                   { object }));
+        mRemovedObjects.emplace_back(object);
+    }
+
+    // Insert added objects and update matching ones in place
+    QList<MapObject*> addedObjects;
+    QList<MapObject*> changedObjects;
+    MapObject::ChangedProperties changedProperties;
+
+    for (int i = 0; i < source->objectCount(); ++i) {
+        const MapObject *sourceObject = source->objectAt(i);
+        MapObject *targetObject = i < target->objectCount() ? target->objectAt(i)
+                                                            : nullptr;
+
+        if (targetObject && targetObject->id() == sourceObject->id()) {
+            const auto changed = syncObject(targetObject, sourceObject);
+            if (changed) {
+                changedObjects.append(targetObject);
+                changedProperties |= changed;
+            }
+        } else {
+            MapObject *clone = sourceObject->clone();
+
+            emit mMapDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAboutToBeAdded,
+                                                      target, i, 1));
+            target->insertObject(i, clone);
+            emit mMapDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAdded,
+                                                      target, i, 1));
+
+            addedObjects.append(clone);
+        }
+    }
+
+    if (!addedObjects.isEmpty())
+        emit mMapDocument->changed(MapObjectsEvent(ChangeEvent::MapObjectsAdded,
+                                                   addedObjects));
+
+    if (!changedObjects.isEmpty())
+        emit mMapDocument->changed(MapObjectsChangeEvent(changedObjects,
+                                                         changedProperties));
+}
+
+/**
+ * Updates \a target to match \a source, returning which properties changed.
+ */
+MapObject::ChangedProperties MapReloader::syncObject(MapObject *target,
+                                                     const MapObject *source)
+{
+    MapObject::ChangedProperties changed;
+
+    if (target->name() != source->name()) {
+        target->setName(source->name());
+        changed |= MapObject::NameProperty;
+    }
+    if (target->position() != source->position()) {
+        target->setPosition(source->position());
+        changed |= MapObject::PositionProperty;
+    }
+    if (target->size() != source->size()) {
+        target->setSize(source->size());
+        changed |= MapObject::SizeProperty;
+    }
+    if (target->rotation() != source->rotation()) {
+        target->setRotation(source->rotation());
+        changed |= MapObject::RotationProperty;
+    }
+    if (target->isVisible() != source->isVisible()) {
+        target->setVisible(source->isVisible());
+        changed |= MapObject::VisibleProperty;
+    }
+    if (target->cell() != source->cell()) {
+        target->setCell(source->cell());
+        changed |= MapObject::CellProperty;
+    }
+    if (target->shape() != source->shape()
+            || target->polygon() != source->polygon()) {
+        target->setShape(source->shape());
+        target->setPolygon(source->polygon());
+        changed |= MapObject::ShapeProperty;
+    }
+
+    const TextData &targetText = target->textData();
+    const TextData &sourceText = source->textData();
+    if (targetText.text != sourceText.text)
+        changed |= MapObject::TextProperty;
+    if (targetText.font != sourceText.font)
+        changed |= MapObject::TextFontProperty;
+    if (targetText.alignment != sourceText.alignment)
+        changed |= MapObject::TextAlignmentProperty;
+    if (targetText.wordWrap != sourceText.wordWrap)
+        changed |= MapObject::TextWordWrapProperty;
+    if (targetText.color != sourceText.color)
+        changed |= MapObject::TextColorProperty;
+    if (changed & (MapObject::TextProperty
+                   | MapObject::TextFontProperty
+                   | MapObject::TextAlignmentProperty
+                   | MapObject::TextWordWrapProperty
+                   | MapObject::TextColorProperty))
+        target->setTextData(sourceText);
+
+    if (target->objectTemplate() != source->objectTemplate()) {
+        target->setObjectTemplate(source->objectTemplate());
+        changed |= MapObject::TemplateProperty;
+    }
+    if (target->properties() != source->properties()) {
+        target->setProperties(source->properties());
+        changed |= MapObject::CustomProperties;
+    }
+
+    if (target->className() != source->className()) {
+        target->setClassName(source->className());
+        emit mMapDocument->changed(ObjectsChangeEvent({ target },
+                                                      ObjectsChangeEvent::ClassProperty));
+    }
+
+    return changed;
+}
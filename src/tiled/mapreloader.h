@@ -0,0 +1,76 @@
+/*
+ * mapreloader.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "mapobject.h"
+
+#include <QList>
+
+#include <memory>
+#include <vector>
+
+namespace Tiled {
+
+class GroupLayer;
+class ImageLayer;
+class Layer;
+class Map;
+class ObjectGroup;
+class TileLayer;
+
+class MapDocument;
+
+/**
+ * Applies a freshly loaded map to an existing document as a minimal set of
+ * changes, so that graphics items, models, selections and view state survive
+ * a reload triggered by an external edit.
+ *
+ * Layers are matched by id, objects by id and tile layer contents by their
+ * diff region. When the new map is structurally too different (changed map
+ * parameters, a different tileset list, or reordered layers or objects),
+ * apply() refuses and the caller falls back to replacing the document.
+ */
+class MapReloader
+{
+public:
+    explicit MapReloader(MapDocument *mapDocument);
+
+    bool apply(const Map &map);
+
+private:
+    void syncLayers(GroupLayer *parentLayer, const QList<Layer *> &newLayers);
+    void syncLayer(Layer *target, const Layer *source);
+    void syncTileLayer(TileLayer *target, const TileLayer *source);
+    void syncImageLayer(ImageLayer *target, const ImageLayer *source);
+    void syncObjectGroup(ObjectGroup *target, const ObjectGroup *source);
+    MapObject::ChangedProperties syncObject(MapObject *target,
+                                            const MapObject *source);
+
+    MapDocument *mMapDocument;
+
+    // Keeps removed layers alive until the whole map is applied, so that no
+    // newly inserted layer can reuse the address of a layer that views may
+    // still refer to while processing the removal.
+    std::vector<std::unique_ptr<Layer>> mRemovedLayers;
+    std::vector<std::unique_ptr<MapObject>> mRemovedObjects;
+};
+
+} // namespace Tiled
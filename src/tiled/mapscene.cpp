@@ -28,12 +28,14 @@
 #include "containerhelpers.h"
 #include "debugdrawitem.h"
 #include "documentmanager.h"
+#include "framewatchdog.h"
 #include "map.h"
 #include "mapobject.h"
 #include "maprenderer.h"
 #include "objectgroup.h"
 #include "objecttemplate.h"
 #include "preferences.h"
+#include "profiler.h"
 #include "snaphelper.h"
 #include "stylehelper.h"
 #include "templatemanager.h"
@@ -47,6 +49,7 @@
 #include <QKeyEvent>
 #include <QMimeData>
 #include <QPalette>
+#include <QScreen>
 
 using namespace Tiled;
 
@@ -70,6 +73,15 @@ MapScene::MapScene(QObject *parent)
     WorldManager &worldManager = WorldManager::instance();
     connect(&worldManager, &WorldManager::worldsChanged, this, &MapScene::refreshScene);
 
+    mPendingMapsTimer.setSingleShot(true);
+    mPendingMapsTimer.setInterval(0);
+    connect(&mPendingMapsTimer, &QTimer::timeout, this, &MapScene::loadNextPendingMap);
+
+    mLastToolUpdate.start();
+    mPendingToolUpdateTimer.setSingleShot(true);
+    connect(&mPendingToolUpdateTimer, &QTimer::timeout,
+            this, &MapScene::dispatchToolMouseMoved);
+
     // Install an event filter so that we can get key events on behalf of the
     // active tool without having to have the current focus.
     qApp->installEventFilter(this);
@@ -84,6 +96,10 @@ MapScene::MapScene(QObject *parent)
 
 MapScene::~MapScene()
 {
+    auto tilesetManager = TilesetManager::instance();
+    for (const SharedTileset &tileset : std::as_const(mVisibleTilesets))
+        tilesetManager->removeVisibleTileset(tileset.data());
+
     enableWorlds.unregister(mEnableWorldsCallback);
 
     qApp->removeEventFilter(this);
@@ -108,6 +124,10 @@ void MapScene::setMapDocument(MapDocument *mapDocument)
                 this, [this] { update(); });
         connect(mMapDocument, &MapDocument::tileImageSourceChanged,
                 this, [this] { update(); });
+        connect(mMapDocument, &MapDocument::tilesetAdded,
+                this, &MapScene::updateVisibleTilesets);
+        connect(mMapDocument, &MapDocument::tilesetRemoved,
+                this, &MapScene::updateVisibleTilesets);
         connect(mMapDocument, &MapDocument::tilesetReplaced,
                 this, &MapScene::tilesetReplaced);
     }
@@ -165,6 +185,7 @@ void MapScene::setSelectedTool(AbstractTool *tool)
         return;
 
     if (mSelectedTool) {
+        mPendingToolUpdateTimer.stop();
         if (mUnderMouse)
             mSelectedTool->mouseLeft();
         mSelectedTool->deactivate(this);
@@ -193,9 +214,16 @@ void MapScene::setViewRect(const QRectF &rect)
     if (mViewRect == rect)
         return;
 
+    const bool centerChanged = mViewRect.center() != rect.center();
+
     mViewRect = rect;
 
-    if (mParallaxEnabled)
+    updateVisibleTilesets();
+
+    emit viewRectChanged();
+
+    // The parallax offsets only depend on the center of the view rect
+    if (mParallaxEnabled && centerChanged)
         emit parallaxParametersChanged();
 }
 
@@ -242,15 +270,37 @@ QPointF MapScene::parallaxOffset(const Layer &layer) const
     if (!mParallaxEnabled)
         return {};
 
+    return parallaxOffset(layer, parallaxReferencePoint(layer.map()));
+}
+
+/**
+ * Returns the point the parallax offsets for layers of the given \a map are
+ * relative to: the center of the view rect, made relative to the map's
+ * position and parallax origin.
+ *
+ * Callers that need the parallax offset of many layers can compute this point
+ * once and pass it to the static parallaxOffset overload, instead of having
+ * it derived again for each layer.
+ */
+QPointF MapScene::parallaxReferencePoint(Map *map) const
+{
     QPointF viewCenter = mViewRect.center();
 
-    Map *map = layer.map();
     if (const MapItem *mapItem = mMapItems.value(map))
         viewCenter -= mapItem->pos() + map->parallaxOrigin();
 
+    return viewCenter;
+}
+
+/**
+ * Returns the parallax offset of the given \a layer against a precomputed
+ * \a referencePoint (see parallaxReferencePoint).
+ */
+QPointF MapScene::parallaxOffset(const Layer &layer, QPointF referencePoint)
+{
     const QPointF parallaxFactor = layer.effectiveParallaxFactor();
-    return QPointF((1.0 - parallaxFactor.x()) * viewCenter.x(),
-                   (1.0 - parallaxFactor.y()) * viewCenter.y());
+    return QPointF((1.0 - parallaxFactor.x()) * referencePoint.x(),
+                   (1.0 - parallaxFactor.y()) * referencePoint.y());
 }
 
 /**
@@ -260,6 +310,9 @@ void MapScene::refreshScene()
 {
     QHash<Map*, MapItem*> mapItems;
 
+    mPendingMaps.clear();
+    mPendingMapsTimer.stop();
+
     if (!mMapDocument) {
         mMapItems.swap(mapItems);
         qDeleteAll(mapItems);
@@ -271,17 +324,29 @@ void MapScene::refreshScene()
     const QString currentMapFile = mMapDocument->canonicalFilePath();
 
     if (const World *world = worldManager.worldForMap(currentMapFile)) {
-        const QPoint currentMapPosition = world->mapRect(currentMapFile).topLeft();
+        const QRect currentMapRect = world->mapRect(currentMapFile);
+        const QPoint currentMapPosition = currentMapRect.topLeft();
         auto const contextMaps = world->contextMaps(currentMapFile);
 
+        mCurrentMapPosition = currentMapPosition;
+
         for (const World::MapEntry &mapEntry : contextMaps) {
             MapDocumentPtr mapDocument;
 
             if (mapEntry.fileName == currentMapFile) {
                 mapDocument = mMapDocument->sharedFromThis();
             } else {
-                auto doc = DocumentManager::instance()->loadDocument(mapEntry.fileName);
-                mapDocument = doc.objectCast<MapDocument>();
+                // Maps whose documents are already loaded show up right
+                // away. The rest is queued and loaded incrementally, so
+                // that showing a map of a large world does not block on
+                // loading every other map in it.
+                const QString canonicalFilePath = QFileInfo(mapEntry.fileName).canonicalFilePath();
+                if (Document *doc = Document::documentInstances().value(canonicalFilePath)) {
+                    mapDocument = doc->sharedFromThis().objectCast<MapDocument>();
+                } else {
+                    mPendingMaps.append(mapEntry);
+                    continue;
+                }
             }
 
             if (mapDocument) {
@@ -295,6 +360,19 @@ void MapScene::refreshScene()
                 mapItems.insert(mapDocument->map(), mapItem);
             }
         }
+
+        if (!mPendingMaps.isEmpty()) {
+            // Load nearby maps first, since they are the ones most likely
+            // to be panned to
+            const QPoint center = currentMapRect.center();
+            std::sort(mPendingMaps.begin(), mPendingMaps.end(),
+                      [center] (const World::MapEntry &a, const World::MapEntry &b) {
+                return (a.rect.center() - center).manhattanLength()
+                        < (b.rect.center() - center).manhattanLength();
+            });
+
+            mPendingMapsTimer.start();
+        }
     } else {
         auto mapItem = takeOrCreateMapItem(mMapDocument->sharedFromThis(), MapItem::Editable);
         mapItems.insert(mMapDocument->map(), mapItem);
@@ -308,6 +386,7 @@ void MapScene::refreshScene()
 
     updateBackgroundColor();
     updateSceneRect();
+    updateVisibleTilesets();
 
     emit sceneRefreshed();
 }
@@ -347,6 +426,36 @@ void MapScene::updateSceneRect()
         sceneRect |= mapItem->boundingRect().translated(mapItem->pos());
 
     setSceneRect(sceneRect);
+    updateItemIndexDepth();
+}
+
+/**
+ * Derives the BSP tree depth of the item index from the content bounds.
+ *
+ * By default, QGraphicsScene grows the depth with the number of items, which
+ * makes every item insertion and geometry change more expensive on scenes
+ * with many objects. Since tile layers are painted by a single item per layer
+ * (their chunks never enter the item index), the item count says little about
+ * how finely the scene area should be partitioned. Instead, split until the
+ * leaves are roughly screen-sized, so that view queries touch a handful of
+ * leaves regardless of how large the world is.
+ */
+void MapScene::updateItemIndexDepth()
+{
+    const QRectF rect = sceneRect();
+
+    // Splits alternate between the horizontal and vertical axis, halving one
+    // of them per level. Aim for leaves of about 1024x1024 pixels.
+    constexpr qreal leafSize = 1024.0;
+
+    int depth = 0;
+    for (qreal size = qMax(rect.width(), rect.height()); size > leafSize; size /= 2)
+        ++depth;
+
+    depth = qBound(4, depth, 16);
+
+    if (bspTreeDepth() != depth)
+        setBspTreeDepth(depth);
 }
 
 void MapScene::setWorldsEnabled(bool enabled)
@@ -360,6 +469,34 @@ void MapScene::setWorldsEnabled(bool enabled)
         mapItem->setVisible(mWorldsEnabled || mapItem->mapDocument() == mMapDocument);
 }
 
+/**
+ * Loads the next queued world map and schedules the one after it, returning
+ * to the event loop in between so that the editor stays responsive while a
+ * large world streams in.
+ */
+void MapScene::loadNextPendingMap()
+{
+    if (mPendingMaps.isEmpty() || !mMapDocument)
+        return;
+
+    const World::MapEntry mapEntry = mPendingMaps.takeFirst();
+
+    auto doc = DocumentManager::instance()->loadDocument(mapEntry.fileName);
+    if (auto mapDocument = doc.objectCast<MapDocument>()) {
+        auto mapItem = takeOrCreateMapItem(mapDocument, MapItem::ReadOnly);
+        mapItem->setPos(mapEntry.rect.topLeft() - mCurrentMapPosition);
+        mapItem->setVisible(mWorldsEnabled);
+        mMapItems.insert(mapDocument->map(), mapItem);
+        mapItem->updateLayerPositions();
+
+        updateSceneRect();
+        updateVisibleTilesets();
+    }
+
+    if (!mPendingMaps.isEmpty())
+        mPendingMapsTimer.start();
+}
+
 MapItem *MapScene::takeOrCreateMapItem(const MapDocumentPtr &mapDocument, MapItem::DisplayMode displayMode)
 {
     // Try to reuse an existing map item
@@ -378,6 +515,8 @@ MapItem *MapScene::takeOrCreateMapItem(const MapDocumentPtr &mapDocument, MapIte
 
 void MapScene::changeEvent(const ChangeEvent &change)
 {
+    TILED_PROFILE_SCOPE("MapScene::changeEvent");
+
     switch (change.type) {
     case ChangeEvent::MapChanged:
         if (static_cast<const MapChangeEvent&>(change).property == Map::ParallaxOriginProperty)
@@ -408,12 +547,17 @@ void MapScene::mapChanged()
 
 void MapScene::repaintTileset(Tileset *tileset)
 {
+    bool repaint = false;
+
     for (MapItem *mapItem : std::as_const(mMapItems)) {
         if (contains(mapItem->mapDocument()->map()->tilesets(), tileset)) {
-            update();
-            return;
+            mapItem->invalidateTileLayerRenderCaches(tileset);
+            repaint = true;
         }
     }
+
+    if (repaint)
+        update();
 }
 
 void MapScene::tilesetReplaced(int index, Tileset *tileset, Tileset *oldTileset)
@@ -421,9 +565,53 @@ void MapScene::tilesetReplaced(int index, Tileset *tileset, Tileset *oldTileset)
     Q_UNUSED(index)
     Q_UNUSED(oldTileset)
 
+    updateVisibleTilesets();
     repaintTileset(tileset);
 }
 
+/**
+ * Updates the set of tilesets registered with the TilesetManager as visible
+ * in this scene's view, so that tile animations can be paused for tilesets
+ * that are currently not seen anywhere.
+ *
+ * Visibility is tracked at map granularity: a tileset counts as visible when
+ * it is referenced by a map whose item intersects the view rect. Scanning
+ * the exposed cells to narrow this down further would cost more than it
+ * saves.
+ */
+void MapScene::updateVisibleTilesets()
+{
+    QSet<SharedTileset> visibleTilesets;
+
+    if (!mViewRect.isEmpty()) {
+        for (MapItem *mapItem : std::as_const(mMapItems)) {
+            if (!mapItem->isVisible())
+                continue;
+            if (!mapItem->sceneBoundingRect().intersects(mViewRect))
+                continue;
+
+            const auto &tilesets = mapItem->mapDocument()->map()->tilesets();
+            for (const SharedTileset &tileset : tilesets)
+                visibleTilesets.insert(tileset);
+        }
+    }
+
+    if (visibleTilesets == mVisibleTilesets)
+        return;
+
+    auto tilesetManager = TilesetManager::instance();
+
+    for (const SharedTileset &tileset : std::as_const(mVisibleTilesets))
+        if (!visibleTilesets.contains(tileset))
+            tilesetManager->removeVisibleTileset(tileset.data());
+
+    for (const SharedTileset &tileset : std::as_const(visibleTilesets))
+        if (!mVisibleTilesets.contains(tileset))
+            tilesetManager->addVisibleTileset(tileset.data());
+
+    mVisibleTilesets.swap(visibleTilesets);
+}
+
 /**
  * Override for handling enter and leave events.
  */
@@ -484,13 +672,57 @@ void MapScene::mouseMoveEvent(QGraphicsSceneMouseEvent *mouseEvent)
             mCurrentModifiers = newModifiers;
         }
 
-        mSelectedTool->mouseMoved(mouseEvent->scenePos(), mCurrentModifiers);
+        // High-rate mice deliver far more moves than there are rendered
+        // frames, and each forwarded move makes the tool redo coordinate
+        // conversion, snapping and preview updates. Forward at most one move
+        // per display frame, deferring the latest position to a timer when
+        // moves arrive faster. Strokes lose no fidelity, because the brushes
+        // interpolate the tile path between consecutive positions.
+        const auto screen = QGuiApplication::primaryScreen();
+        const qreal refreshRate = screen ? screen->refreshRate() : 60.0;
+        const int interval = qMax(1, qRound(1000.0 / qMax(30.0, refreshRate)));
+
+        if (mLastToolUpdate.hasExpired(interval)) {
+            mPendingToolUpdateTimer.stop();
+            dispatchToolMouseMoved();
+        } else if (!mPendingToolUpdateTimer.isActive()) {
+            mPendingToolUpdateTimer.start(interval - mLastToolUpdate.elapsed());
+        }
+
         mouseEvent->accept();
     }
 }
 
+/**
+ * Forwards the most recent mouse position to the active tool.
+ */
+void MapScene::dispatchToolMouseMoved()
+{
+    if (mSelectedTool)
+        mSelectedTool->mouseMoved(mLastMousePos, mCurrentModifiers);
+    mLastToolUpdate.restart();
+}
+
+/**
+ * Delivers a deferred mouse move right away. Called before forwarding press
+ * and release events, which act on the position the tool saw last.
+ */
+void MapScene::flushPendingToolUpdate()
+{
+    if (mPendingToolUpdateTimer.isActive()) {
+        mPendingToolUpdateTimer.stop();
+        dispatchToolMouseMoved();
+    }
+}
+
 void MapScene::mousePressEvent(QGraphicsSceneMouseEvent *mouseEvent)
 {
+    flushPendingToolUpdate();
+
+    // Lets the frame watchdog attribute main-thread time to the stroke and
+    // optionally hold back dock repaints until the mouse is released
+    FrameWatchdog::instance().setInteracting(true);
+
     QGraphicsScene::mousePressEvent(mouseEvent);
     if (mouseEvent->isAccepted())
         return;
@@ -503,6 +735,11 @@ void MapScene::mousePressEvent(QGraphicsSceneMouseEvent *mouseEvent)
 
 void MapScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *mouseEvent)
 {
+    flushPendingToolUpdate();
+
+    if (mouseEvent->buttons() == Qt::NoButton)
+        FrameWatchdog::instance().setInteracting(false);
+
     QGraphicsScene::mouseReleaseEvent(mouseEvent);
     if (mouseEvent->isAccepted())
         return;
@@ -26,14 +26,19 @@
 #include "mapdocument.h"
 #include "mapitem.h"
 #include "session.h"
+#include "worldmanager.h"
 
 #include <QColor>
+#include <QElapsedTimer>
 #include <QGraphicsScene>
 #include <QHash>
+#include <QSet>
+#include <QTimer>
 
 namespace Tiled {
 
 class Layer;
+class Map;
 class MapObject;
 class ObjectGroup;
 class Tile;
@@ -64,6 +69,7 @@ public:
 
     void setShowTileCollisionShapes(bool enabled);
     void setParallaxEnabled(bool enabled);
+    bool isParallaxEnabled() const { return mParallaxEnabled; }
     void setPainterScale(qreal painterScale);
 
     QRectF mapBoundingRect() const;
@@ -82,6 +88,8 @@ public:
     QPointF absolutePositionForLayer(const Layer &layer) const;
     QPointF layerItemPosition(const Layer &layer) const;
     QPointF parallaxOffset(const Layer &layer) const;
+    QPointF parallaxReferencePoint(Map *map) const;
+    static QPointF parallaxOffset(const Layer &layer, QPointF referencePoint);
 
     static SessionOption<bool> enableWorlds;
 
@@ -90,6 +98,7 @@ signals:
 
     void sceneRefreshed();
 
+    void viewRectChanged();
     void parallaxParametersChanged();
 
 protected:
@@ -118,8 +127,14 @@ private:
     void updateDefaultBackgroundColor();
     void updateBackgroundColor();
     void updateSceneRect();
+    void updateItemIndexDepth();
+    void updateVisibleTilesets();
 
     void setWorldsEnabled(bool enabled);
+    void loadNextPendingMap();
+
+    void dispatchToolMouseMoved();
+    void flushPendingToolUpdate();
 
     MapItem *takeOrCreateMapItem(const MapDocumentPtr &mapDocument,
                                  MapItem::DisplayMode displayMode);
@@ -128,6 +143,7 @@ private:
 
     MapDocument *mMapDocument = nullptr;
     QHash<Map*, MapItem*> mMapItems;
+    QSet<SharedTileset> mVisibleTilesets;
     AbstractTool *mSelectedTool = nullptr;
     DebugDrawItem *mDebugDrawItem = nullptr;
     bool mUnderMouse = false;
@@ -137,9 +153,20 @@ private:
     Session::CallbackIterator mEnableWorldsCallback;
     Qt::KeyboardModifiers mCurrentModifiers = Qt::NoModifier;
     QPointF mLastMousePos;
+
+    // Coalesces mouse moves to one tool update per display frame (see
+    // mouseMoveEvent)
+    QElapsedTimer mLastToolUpdate;
+    QTimer mPendingToolUpdateTimer;
     QRectF mViewRect;
     QColor mDefaultBackgroundColor;
     QColor mOverrideBackgroundColor;
+
+    // World maps whose documents still need to be loaded, nearest first
+    // (see refreshScene and loadNextPendingMap)
+    QVector<World::MapEntry> mPendingMaps;
+    QPoint mCurrentMapPosition;
+    QTimer mPendingMapsTimer;
 };
 
 /**
@@ -22,9 +22,11 @@
 
 #include "flexiblescrollbar.h"
 #include "mapdocument.h"
+#include "mapitem.h"
 #include "mapobject.h"
 #include "maprenderer.h"
 #include "mapscene.h"
+#include "memorybudget.h"
 #include "objectgroup.h"
 #include "preferences.h"
 #include "tileanimationdriver.h"
@@ -33,6 +35,7 @@
 
 #include <QApplication>
 #include <QCursor>
+#include <QElapsedTimer>
 #include <QGesture>
 #include <QGestureEvent>
 #include <QPinchGesture>
@@ -60,6 +63,11 @@ using namespace Tiled;
 Preference<bool> MapView::ourAutoScrollingEnabled { "Interface/AutoScrolling", false };
 Preference<bool> MapView::ourSmoothScrollingEnabled { "Interface/SmoothScrolling", true };
 
+// How long the view needs to rest before speculative chunk rendering starts,
+// and the interval between the time-sliced prefetch passes
+static constexpr int prefetchDelayMs = 150;
+static constexpr int prefetchIntervalMs = 30;
+
 MapView::MapView(QWidget *parent, Mode mode)
     : QGraphicsView(parent)
     , mMode(mode)
@@ -104,6 +112,12 @@ MapView::MapView(QWidget *parent, Mode mode)
     connect(mZoomable, &Zoomable::scaleChanged, this, &MapView::adjustScale);
 
     connect(mPanningDriver, &TileAnimationDriver::update, this, &MapView::updatePanning);
+
+    connect(Preferences::instance(), &Preferences::showRenderStatisticsChanged,
+            this, [this] { viewport()->update(); });
+
+    mPrefetchTimer.setSingleShot(true);
+    connect(&mPrefetchTimer, &QTimer::timeout, this, &MapView::prefetchChunks);
 }
 
 MapView::~MapView()
@@ -241,14 +255,51 @@ void MapView::updateViewRect()
     if (mViewRect == viewRect)
         return;
 
+    // Estimate the scroll velocity in scene coordinates per second, which
+    // guides the direction of the idle-time chunk prefetch
+    if (mScrollTimer.isValid()) {
+        const qint64 elapsed = mScrollTimer.restart();
+        if (elapsed > 0 && elapsed < 500)
+            mScrollVelocity = (viewRect.center() - mViewRect.center()) * (1000.0 / elapsed);
+        else
+            mScrollVelocity = QPointF();
+    } else {
+        mScrollTimer.start();
+    }
+
     mViewRect = viewRect;
 
     if (MapScene *scene = mapScene())
         scene->setViewRect(viewRect);
 
+    mPrefetchTimer.start(prefetchDelayMs);
+
     emit viewRectChanged();
 }
 
+/**
+ * Pre-renders chunk pixmaps just outside the viewport while the view is at
+ * rest, so that continued panning hits warm cache instead of showing a
+ * checkerboard that fills in. Reschedules itself in small slices until the
+ * ring around the viewport is fully cached.
+ */
+void MapView::prefetchChunks()
+{
+    if (!isVisible())
+        return;
+
+    MapScene *scene = mapScene();
+    if (!scene)
+        return;
+
+    MapItem *mapItem = scene->mapItem(mMapDocument);
+    if (!mapItem)
+        return;
+
+    if (mapItem->prefetchRenderCaches(mViewRect, mScrollVelocity))
+        mPrefetchTimer.start(prefetchIntervalMs);
+}
+
 void MapView::focusMapObject(MapObject *mapObject)
 {
     // FIXME: This is not always the visual center
@@ -468,13 +519,139 @@ void MapView::paintEvent(QPaintEvent *event)
     if (auto scene = mapScene())
         scene->setPainterScale(scale());
 
-    QGraphicsView::paintEvent(event);
+    const bool showStatistics = Preferences::instance()->showRenderStatistics();
+    RenderStatistics::enabled = showStatistics;
+
+    if (!showStatistics) {
+        mRenderStatisticsRect = QRect();
+        QGraphicsView::paintEvent(event);
+        return;
+    }
+
+    // Repaints covering only the statistics overlay would otherwise end up
+    // measuring themselves, so for those the previous numbers are kept.
+    const bool statisticsOnlyRepaint = !mRenderStatisticsRect.isEmpty() &&
+            mRenderStatisticsRect.contains(event->rect());
+
+    if (statisticsOnlyRepaint) {
+        QGraphicsView::paintEvent(event);
+    } else {
+        const qint64 cellsBefore = RenderStatistics::cellsDrawn;
+        const qint64 batchesBefore = RenderStatistics::batchesDrawn;
+        const qint64 hitsBefore = RenderStatistics::pixmapCacheHits;
+        const qint64 missesBefore = RenderStatistics::pixmapCacheMisses;
+        const qint64 blitsBefore = RenderStatistics::chunkBlits;
+        const qint64 rendersBefore = RenderStatistics::chunkRenders;
+
+        QElapsedTimer timer;
+        timer.start();
+        QGraphicsView::paintEvent(event);
+        mFrameNsecs = timer.nsecsElapsed();
+
+        mCellsDrawn = RenderStatistics::cellsDrawn - cellsBefore;
+        mBatchesDrawn = RenderStatistics::batchesDrawn - batchesBefore;
+        mPixmapCacheHits = RenderStatistics::pixmapCacheHits - hitsBefore;
+        mPixmapCacheMisses = RenderStatistics::pixmapCacheMisses - missesBefore;
+        mChunkBlits = RenderStatistics::chunkBlits - blitsBefore;
+        mChunkRenders = RenderStatistics::chunkRenders - rendersBefore;
+    }
+
+    drawRenderStatistics();
+
+    // After a real frame the overlay area needs a follow-up repaint, since
+    // the new numbers may not have been part of the exposed region.
+    if (!statisticsOnlyRepaint)
+        viewport()->update(mRenderStatisticsRect);
+}
+
+/**
+ * Paints the render statistics overlay in the top-left corner of the
+ * viewport, showing the timing and counters captured for the last frame.
+ */
+void MapView::drawRenderStatistics()
+{
+    const int itemCount = scene() ? items(viewport()->rect()).size() : 0;
+
+    QStringList lines;
+    lines.append(QStringLiteral("frame: %1 ms")
+                 .arg(mFrameNsecs / 1000000.0, 0, 'f', 2));
+    lines.append(QStringLiteral("items in view: %1").arg(itemCount));
+    lines.append(QStringLiteral("cells: %1 in %2 batches")
+                 .arg(mCellsDrawn).arg(mBatchesDrawn));
+
+    const qint64 lookups = mPixmapCacheHits + mPixmapCacheMisses;
+    if (lookups > 0) {
+        lines.append(QStringLiteral("pixmap cache: %1% hits (%2 lookups)")
+                     .arg(100.0 * mPixmapCacheHits / lookups, 0, 'f', 0)
+                     .arg(lookups));
+    }
+
+    if (mChunkBlits > 0 || mChunkRenders > 0) {
+        lines.append(QStringLiteral("chunks: %1 blitted, %2 rendered")
+                     .arg(mChunkBlits).arg(mChunkRenders));
+    }
+
+    const auto memoryUsages = MemoryBudget::usageReport();
+    if (!memoryUsages.isEmpty()) {
+        qint64 totalBytes = 0;
+        QStringList parts;
+        for (const MemoryBudget::Usage &usage : memoryUsages) {
+            totalBytes += usage.bytes;
+            parts.append(QStringLiteral("%1 %2")
+                         .arg(usage.name)
+                         .arg(usage.bytes / (1024.0 * 1024.0), 0, 'f', 1));
+        }
+        QString line = QStringLiteral("cache MB: %1 (%2)")
+                .arg(totalBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                .arg(parts.join(QStringLiteral(", ")));
+        if (const qint64 budget = MemoryBudget::budget())
+            line.append(QStringLiteral(" of %1").arg(budget / (1024.0 * 1024.0), 0, 'f', 0));
+        lines.append(line);
+    }
+
+    QPainter painter(viewport());
+    const QFontMetrics metrics = painter.fontMetrics();
+
+    int textWidth = 0;
+    for (const QString &line : std::as_const(lines))
+        textWidth = std::max(textWidth, metrics.horizontalAdvance(line));
+
+    const int margin = metrics.height() / 2;
+    QRect rect(0, 0,
+               textWidth + margin * 2,
+               metrics.lineSpacing() * lines.size() + margin * 2);
+
+    if (rect != mRenderStatisticsRect) {
+        viewport()->update(mRenderStatisticsRect);
+        mRenderStatisticsRect = rect;
+    }
+
+    painter.fillRect(rect, QColor(0, 0, 0, 160));
+    painter.setPen(Qt::white);
+
+    int y = margin + metrics.ascent();
+    for (const QString &line : std::as_const(lines)) {
+        painter.drawText(margin, y, line);
+        y += metrics.lineSpacing();
+    }
+}
+
+void MapView::showEvent(QShowEvent *event)
+{
+    if (auto scene = mapScene())
+        scene->setViewRect(mViewRect);
+    QGraphicsView::showEvent(event);
 }
 
 void MapView::hideEvent(QHideEvent *event)
 {
     // Disable hand scrolling when the view gets hidden in any way
     setScrollingMode(NoScrolling);
+
+    // Tell the scene nothing is visible, so that tile animations can pause
+    if (auto scene = mapScene())
+        scene->setViewRect(QRectF());
+
     QGraphicsView::hideEvent(event);
 }
 
@@ -22,8 +22,10 @@
 
 #include "preferences.h"
 
+#include <QElapsedTimer>
 #include <QGraphicsView>
 #include <QPinchGesture>
+#include <QTimer>
 
 namespace Tiled {
 
@@ -102,6 +104,7 @@ protected:
     bool event(QEvent *event) override;
 
     void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *) override;
     void hideEvent(QHideEvent *) override;
     void resizeEvent(QResizeEvent *event) override;
 
@@ -129,6 +132,7 @@ private:
     void updateSceneRect(const QRectF &sceneRect);
     void updateSceneRect(const QRectF &sceneRect, const QTransform &transform);
     void updateViewRect();
+    void prefetchChunks();
     void focusMapObject(MapObject *mapObject);
 
     enum PanDirectionFlag {
@@ -143,6 +147,8 @@ private:
     void updatePanningDriverState();
     void updatePanning(int deltaTime);
 
+    void drawRenderStatistics();
+
     void scrollBy(QPoint distance);
 
     void setMapDocument(MapDocument *mapDocument);
@@ -161,6 +167,21 @@ private:
 
     PanDirections mPanDirections;
     TileAnimationDriver *mPanningDriver;
+
+    // State of the idle-time chunk prefetch (see prefetchChunks)
+    QTimer mPrefetchTimer;
+    QElapsedTimer mScrollTimer;
+    QPointF mScrollVelocity;
+
+    // State of the render statistics overlay (see drawRenderStatistics)
+    QRect mRenderStatisticsRect;
+    qint64 mFrameNsecs = 0;
+    qint64 mCellsDrawn = 0;
+    qint64 mBatchesDrawn = 0;
+    qint64 mPixmapCacheHits = 0;
+    qint64 mPixmapCacheMisses = 0;
+    qint64 mChunkBlits = 0;
+    qint64 mChunkRenders = 0;
 };
 
 /**
@@ -24,13 +24,16 @@
 #include "documentmanager.h"
 #include "map.h"
 #include "mapdocument.h"
+#include "mapobjectmodel.h"
 #include "maprenderer.h"
 #include "mapscene.h"
 #include "mapview.h"
+#include "tilelayer.h"
 #include "utils.h"
 #include "zoomable.h"
 
 #include <QCursor>
+#include <QElapsedTimer>
 #include <QResizeEvent>
 #include <QScrollBar>
 #include <QUndoStack>
@@ -42,7 +45,6 @@ MiniMap::MiniMap(QWidget *parent)
     , mMapDocument(nullptr)
     , mDragging(false)
     , mMouseMoveCursorState(false)
-    , mRedrawMapImage(false)
     , mRenderFlags(MiniMapRenderer::DrawTileLayers
                    | MiniMapRenderer::DrawMapObjects
                    | MiniMapRenderer::DrawImageLayers
@@ -58,6 +60,16 @@ MiniMap::MiniMap(QWidget *parent)
     mMapImageUpdateTimer.setSingleShot(true);
     connect(&mMapImageUpdateTimer, &QTimer::timeout,
             this, &MiniMap::redrawTimeout);
+
+    mRenderTimer.setInterval(0);
+    connect(&mRenderTimer, &QTimer::timeout,
+            this, &MiniMap::renderPendingBands);
+
+    connect(DocumentManager::instance(), &DocumentManager::documentAboutToClose,
+            this, [this] (Document *document) {
+        if (auto mapDocument = qobject_cast<MapDocument*>(document))
+            mMapImageCache.remove(mapDocument);
+    });
 }
 
 void MiniMap::setMapDocument(MapDocument *map)
@@ -65,23 +77,88 @@ void MiniMap::setMapDocument(MapDocument *map)
     const DocumentManager *dm = DocumentManager::instance();
 
     if (mMapDocument) {
+        storeMapImage();
+
         mMapDocument->disconnect(this);
+        mMapDocument->undoStack()->disconnect(this);
+        mMapDocument->mapObjectModel()->disconnect(this);
 
         if (MapView *mapView = dm->viewForDocument(mMapDocument))
             mapView->disconnect(this);
     }
 
     mMapDocument = map;
+    mDirtyMapRegion = QRegion();
+    mRegionChangedSinceUndoIndex = false;
+    mRenderTimer.stop();
+    mPendingMapImage = QImage();
 
     if (mMapDocument) {
+        // Tile edits report the changed region, which allows re-rendering
+        // only that part of the image. Everything else triggers a full
+        // redraw.
         connect(mMapDocument->undoStack(), &QUndoStack::indexChanged,
+                this, &MiniMap::undoIndexChanged);
+        connect(mMapDocument, &MapDocument::regionChanged,
+                this, &MiniMap::mapRegionChanged);
+        connect(mMapDocument, &Document::changed,
+                this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument->mapObjectModel(), &QAbstractItemModel::rowsInserted,
+                this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument->mapObjectModel(), &QAbstractItemModel::rowsRemoved,
                 this, &MiniMap::scheduleMapImageUpdate);
 
         if (MapView *mapView = dm->viewForDocument(mMapDocument))
             connect(mapView, &MapView::viewRectChanged, this, [this] { update(); });
     }
 
-    scheduleMapImageUpdate();
+    if (mMapDocument && restoreMapImage())
+        update();
+    else
+        scheduleMapImageUpdate();
+}
+
+/**
+ * Keeps the rendered image of the current document around, so that switching
+ * back to it doesn't require re-rendering the whole map.
+ */
+void MiniMap::storeMapImage()
+{
+    // Only a fully up-to-date image is worth keeping
+    if (mMapImage.isNull() || mMapImageUpdateTimer.isActive() || mRenderTimer.isActive())
+        return;
+
+    mMapImageCache.insert(mMapDocument,
+                          new CachedMapImage { mMapImage,
+                                               mLastMapBoundingRect,
+                                               contentsRect().size(),
+                                               mMapDocument->undoStack()->index() });
+}
+
+/**
+ * Restores a previously rendered image of the current document, when one is
+ * available and still valid. Returns whether that was the case.
+ */
+bool MiniMap::restoreMapImage()
+{
+    const CachedMapImage *cached = mMapImageCache.object(mMapDocument);
+    if (!cached)
+        return false;
+
+    // The image is only valid when neither the document nor the widget have
+    // changed since it was rendered
+    if (cached->undoIndex != mMapDocument->undoStack()->index()
+            || cached->viewSize != contentsRect().size()) {
+        mMapImageCache.remove(mMapDocument);
+        return false;
+    }
+
+    mMapImage = cached->image;
+    mLastMapBoundingRect = cached->mapBoundingRect;
+    mFullRedrawPending = false;
+    mMapImageUpdateTimer.stop();
+    updateImageRect();
+    return true;
 }
 
 QSize MiniMap::sizeHint() const
@@ -91,6 +168,34 @@ QSize MiniMap::sizeHint() const
 
 void MiniMap::scheduleMapImageUpdate()
 {
+    mFullRedrawPending = true;
+    mMapImageUpdateTimer.start(100);
+}
+
+void MiniMap::mapRegionChanged(const QRegion &region, TileLayer *tileLayer)
+{
+    mRegionChangedSinceUndoIndex = true;
+
+    QRect dirty = mMapDocument->renderer()->boundingRect(region.boundingRect());
+    dirty += tileLayer->drawMargins();
+    dirty.translate(tileLayer->totalOffset().toPoint());
+
+    // Account for rounding of the layer offset and of the scaled-down
+    // rendering
+    mDirtyMapRegion |= dirty.adjusted(-1, -1, 1, 1);
+
+    mMapImageUpdateTimer.start(100);
+}
+
+void MiniMap::undoIndexChanged()
+{
+    // Tile edits report their changed region through regionChanged before
+    // the undo stack index changes; any other kind of change needs the
+    // whole image re-rendered.
+    if (!mRegionChangedSinceUndoIndex)
+        mFullRedrawPending = true;
+    mRegionChangedSinceUndoIndex = false;
+
     mMapImageUpdateTimer.start(100);
 }
 
@@ -98,11 +203,6 @@ void MiniMap::paintEvent(QPaintEvent *pe)
 {
     QFrame::paintEvent(pe);
 
-    if (mRedrawMapImage) {
-        renderMapToImage();
-        mRedrawMapImage = false;
-    }
-
     if (mMapImage.isNull() || mImageRect.isEmpty())
         return;
 
@@ -155,18 +255,25 @@ void MiniMap::updateImageRect()
     mImageRect = imageRect;
 }
 
-void MiniMap::renderMapToImage()
+void MiniMap::startMapImageRender()
 {
     if (!mMapDocument) {
         mMapImage = QImage();
+        mPendingMapImage = QImage();
+        mDirtyMapRegion = QRegion();
+        mRenderTimer.stop();
         return;
     }
 
     MiniMapRenderer miniMapRenderer(mMapDocument->map());
 
-    const QSize mapSize = miniMapRenderer.mapSize();
+    const QRect mapBoundingRect = miniMapRenderer.mapBoundingRect();
+    const QSize mapSize = mapBoundingRect.size();
     if (mapSize.isEmpty()) {
         mMapImage = QImage();
+        mPendingMapImage = QImage();
+        mDirtyMapRegion = QRegion();
+        mRenderTimer.stop();
         return;
     }
 
@@ -181,16 +288,90 @@ void MiniMap::renderMapToImage()
     if (imageSize.width() < 512 && imageSize.height() < 512)
         imageSize *= 2;
 
-    // Allocate a new image when the size changed
-    if (mMapImage.size() != imageSize) {
-        mMapImage = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
-        updateImageRect();
+    // Only the reported dirty region needs re-rendering as long as the
+    // image and the rendered map bounds are unchanged, and no full redraw
+    // is in progress
+    const bool partialUpdate = !mFullRedrawPending
+            && !mDirtyMapRegion.isEmpty()
+            && mPendingMapImage.isNull()
+            && mMapImage.size() == imageSize
+            && mLastMapBoundingRect == mapBoundingRect;
+
+    if (partialUpdate) {
+        const QRectF exposed(mDirtyMapRegion.boundingRect());
+        mDirtyMapRegion = QRegion();
+        miniMapRenderer.renderToImage(mMapImage, mRenderFlags, exposed);
+        update();
+        return;
     }
 
-    if (imageSize.isEmpty())
+    mDirtyMapRegion = QRegion();
+    mFullRedrawPending = false;
+    mLastMapBoundingRect = mapBoundingRect;
+
+    if (imageSize.isEmpty()) {
+        mMapImage = QImage();
+        mPendingMapImage = QImage();
+        mRenderTimer.stop();
         return;
+    }
 
-    miniMapRenderer.renderToImage(mMapImage, mRenderFlags);
+    // Full redraws can take a while for large maps, so they are rendered in
+    // bands. A fresh image is used to keep showing the previous one until
+    // the new image is complete.
+    mPendingMapImage = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+    mPendingMapImage.fill(Qt::transparent);
+    mPendingMapBoundingRect = mapBoundingRect;
+    mPendingBandY = mapBoundingRect.top();
+    mRenderTimer.start();
+
+    renderPendingBands();
+}
+
+void MiniMap::renderPendingBands()
+{
+    if (!mMapDocument || mPendingMapImage.isNull()) {
+        mRenderTimer.stop();
+        return;
+    }
+
+    MiniMapRenderer miniMapRenderer(mMapDocument->map());
+
+    // When the map bounds changed while rendering, the scale no longer
+    // matches and the render is restarted
+    const QRect mapBoundingRect = miniMapRenderer.mapBoundingRect();
+    if (mapBoundingRect != mPendingMapBoundingRect) {
+        mRenderTimer.stop();
+        mPendingMapImage = QImage();
+        scheduleMapImageUpdate();
+        return;
+    }
+
+    const qreal scale = static_cast<qreal>(mPendingMapImage.width()) / mapBoundingRect.width();
+    const int bandHeight = qMax(1, qRound(256 / scale));
+
+    // Render bands until the time budget runs out, so that input and
+    // repaints of the map view stay responsive in between
+    QElapsedTimer timer;
+    timer.start();
+
+    while (mPendingBandY <= mapBoundingRect.bottom()) {
+        // Adjacent bands overlap a little to avoid seams due to rounding
+        const QRectF band(QRect(mapBoundingRect.left(), mPendingBandY,
+                                mapBoundingRect.width(), bandHeight).adjusted(-1, -1, 1, 1));
+
+        miniMapRenderer.renderToImage(mPendingMapImage, mRenderFlags, band);
+        mPendingBandY += bandHeight;
+
+        if (timer.hasExpired(5))
+            return;
+    }
+
+    mRenderTimer.stop();
+    mMapImage = mPendingMapImage;
+    mPendingMapImage = QImage();
+    updateImageRect();
+    update();
 }
 
 void MiniMap::centerViewOnLocalPixel(const QPointF &centerPos, int delta)
@@ -207,8 +388,7 @@ void MiniMap::centerViewOnLocalPixel(const QPointF &centerPos, int delta)
 
 void MiniMap::redrawTimeout()
 {
-    mRedrawMapImage = true;
-    update();
+    startMapImageRender();
 }
 
 void MiniMap::wheelEvent(QWheelEvent *event)
@@ -23,13 +23,16 @@
 
 #include "minimaprenderer.h"
 
+#include <QCache>
 #include <QFrame>
 #include <QImage>
+#include <QRegion>
 #include <QTimer>
 
 namespace Tiled {
 
 class MapDocument;
+class TileLayer;
 
 class MiniMap : public QFrame
 {
@@ -46,7 +49,7 @@ public:
     QSize sizeHint() const override;
 
 public slots:
-    /** Schedules a redraw of the minimap image. */
+    /** Schedules a full redraw of the minimap image. */
     void scheduleMapImageUpdate();
 
 protected:
@@ -59,6 +62,10 @@ protected:
 
 private:
     void redrawTimeout();
+    void mapRegionChanged(const QRegion &region, TileLayer *tileLayer);
+    void undoIndexChanged();
+    void storeMapImage();
+    bool restoreMapImage();
 
     MapDocument *mMapDocument;
     QImage mMapImage;
@@ -67,13 +74,36 @@ private:
     bool mDragging;
     QPoint mDragOffset;
     bool mMouseMoveCursorState;
-    bool mRedrawMapImage;
+    bool mFullRedrawPending = true;
+    bool mRegionChangedSinceUndoIndex = false;
+    QRegion mDirtyMapRegion;
+    QRect mLastMapBoundingRect;
     MiniMapRenderer::RenderFlags mRenderFlags;
 
+    // Full redraws are rendered band by band into this image, driven by a
+    // zero-interval timer so that input and repaints of the map view get
+    // processed in between. The previous image stays on screen meanwhile.
+    QImage mPendingMapImage;
+    QRect mPendingMapBoundingRect;
+    int mPendingBandY = 0;
+    QTimer mRenderTimer;
+
+    // Rendered images of recently shown documents, kept so that switching
+    // between documents does not re-render the whole map each time. The
+    // images are dock-sized, so keeping a handful around is cheap.
+    struct CachedMapImage {
+        QImage image;
+        QRect mapBoundingRect;
+        QSize viewSize;
+        int undoIndex;
+    };
+    QCache<MapDocument*, CachedMapImage> mMapImageCache { 8 };
+
     QRect viewportRect() const;
     QPointF mapToScene(QPointF p) const;
     void updateImageRect();
-    void renderMapToImage();
+    void startMapImageRender();
+    void renderPendingBands();
     void centerViewOnLocalPixel(const QPointF &centerPos, int delta = 0);
 };
 
@@ -35,7 +35,9 @@
 #include "utils.h"
 #include "variantpropertymanager.h"
 
+#include <QGraphicsView>
 #include <QGuiApplication>
+#include <QSet>
 #include <QTimerEvent>
 #include <QVector2D>
 
@@ -348,6 +350,130 @@ const MapRenderer &ObjectSelectionItem::mapRenderer() const
     return *mMapDocument->renderer();
 }
 
+QVariant ObjectSelectionItem::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    if (change == ItemSceneHasChanged) {
+        if (auto mapScene = qobject_cast<MapScene*>(qvariant_cast<QGraphicsScene*>(value))) {
+            connect(mapScene, &MapScene::viewRectChanged,
+                    this, &ObjectSelectionItem::sceneViewRectChanged);
+            updateVisibleItems();
+        }
+    }
+    return QGraphicsObject::itemChange(change, value);
+}
+
+void ObjectSelectionItem::sceneViewRectChanged()
+{
+    // Scrolling and zooming deliver many small view rect changes, so batch
+    // the re-filtering of the overlay items.
+    if (mVisibleItemsUpdatePending)
+        return;
+
+    mVisibleItemsUpdatePending = true;
+    QMetaObject::invokeMethod(this, &ObjectSelectionItem::updateVisibleItems,
+                              Qt::QueuedConnection);
+}
+
+void ObjectSelectionItem::updateVisibleItems()
+{
+    mVisibleItemsUpdatePending = false;
+
+    addRemoveObjectLabels();
+    addRemoveObjectOutlines();
+    addRemoveObjectHoverItems();
+}
+
+/**
+ * Returns whether the given object is close enough to the area visible in
+ * the view for its overlay items to be worth creating.
+ *
+ * Keeping the graphics items limited to the objects in view keeps huge
+ * selections responsive. The objects scrolled out of view are still tracked
+ * in the document's plain object lists, and their items are created once
+ * they come into view.
+ */
+bool ObjectSelectionItem::objectNearView(const MapObject *object) const
+{
+    auto mapScene = qobject_cast<MapScene*>(scene());
+    if (!mapScene)
+        return true;
+
+    const QRectF &viewRect = mapScene->viewRect();
+    if (viewRect.isNull())
+        return true;    // no view information available
+
+    // Margin so that items slightly outside are ready when scrolling
+    const QRectF visibleRect = mapRectFromScene(viewRect).adjusted(-64, -64,
+                                                                   64, 64);
+
+    QRectF bounds = object->screenBounds(*mMapDocument->renderer());
+    bounds.translate(mapScene->absolutePositionForLayer(*object->objectGroup()));
+    return bounds.intersects(visibleRect);
+}
+
+/**
+ * Returns the objects of the given group that are close enough to the area
+ * visible in the view for their overlay items to be worth creating, using
+ * the group's spatial index instead of scanning all objects.
+ *
+ * The index stores conservative pixel-space bounds, so the result is a
+ * superset that callers refine per object. Falls back to all objects when no
+ * view information is available.
+ */
+QList<MapObject*> ObjectSelectionItem::objectsNearView(const ObjectGroup &objectGroup) const
+{
+    auto mapScene = qobject_cast<MapScene*>(scene());
+    if (!mapScene)
+        return objectGroup.objects();
+
+    const QRectF &viewRect = mapScene->viewRect();
+    if (viewRect.isNull())
+        return objectGroup.objects();
+
+    // Same margin as used by objectNearView
+    QRectF visibleRect = mapRectFromScene(viewRect).adjusted(-64, -64, 64, 64);
+    visibleRect.translate(-mapScene->absolutePositionForLayer(objectGroup));
+
+    // The index is queried in pixel coordinates
+    const MapRenderer &renderer = *mMapDocument->renderer();
+    QPolygonF pixelBounds;
+    pixelBounds.append(renderer.screenToPixelCoords(visibleRect.topLeft()));
+    pixelBounds.append(renderer.screenToPixelCoords(visibleRect.topRight()));
+    pixelBounds.append(renderer.screenToPixelCoords(visibleRect.bottomRight()));
+    pixelBounds.append(renderer.screenToPixelCoords(visibleRect.bottomLeft()));
+
+    return objectGroup.objectsIntersecting(pixelBounds.boundingRect());
+}
+
+/**
+ * Returns the size of the grid cells used to declutter the labels shown in
+ * "show all object names" mode, in scene coordinates.
+ *
+ * Labels ignore transformations, so when zooming out each one covers an ever
+ * larger part of the map and dense maps turn into solid label noise. Showing
+ * at most one label per screen-space cell keeps them readable, while zooming
+ * in shrinks the cells and reveals more labels.
+ *
+ * Returns 0 when there is no view to relate screen space to, in which case
+ * no decluttering is done.
+ */
+qreal ObjectSelectionItem::labelDeclutterCellSize() const
+{
+    auto mapScene = qobject_cast<MapScene*>(scene());
+    if (!mapScene || mapScene->viewRect().isNull())
+        return 0;
+
+    const auto views = mapScene->views();
+    if (views.isEmpty())
+        return 0;
+
+    const qreal scale = views.first()->transform().m11();
+    if (scale <= 0)
+        return 0;
+
+    return Utils::dpiScaled(48) / scale;
+}
+
 void ObjectSelectionItem::changeEvent(const ChangeEvent &event)
 {
     switch (event.type) {
@@ -613,6 +739,9 @@ void ObjectSelectionItem::objectsAdded(const QList<MapObject *> &objects)
         for (MapObject *object : objects) {
             Q_ASSERT(!mObjectLabels.contains(object));
 
+            if (!objectNearView(object))
+                continue;
+
             MapObjectLabel *labelItem = new MapObjectLabel(object, this);
             labelItem->syncWithMapObject(renderer);
             mObjectLabels.insert(object, labelItem);
@@ -732,6 +861,9 @@ void ObjectSelectionItem::addRemoveObjectLabels()
         if (labelItems.contains(object))
             return;
 
+        if (!objectNearView(object))
+            return;
+
         MapObjectLabel *labelItem = mObjectLabels.take(object);
         if (!labelItem) {
             labelItem = new MapObjectLabel(object, this);
@@ -748,13 +880,40 @@ void ObjectSelectionItem::addRemoveObjectLabels()
 
     switch (objectLabelVisibility()) {
     case Preferences::AllObjectLabels: {
+        // At most one label is created per screen-space grid cell. The grid
+        // is anchored in scene coordinates, so the chosen labels are stable
+        // while panning. Earlier layers and objects take priority, matching
+        // the order in which overlapping labels used to pile up.
+        const qreal cellSize = labelDeclutterCellSize();
+        QSet<quint64> occupiedCells;
+
+        auto mapScene = qobject_cast<MapScene*>(scene());
+
         LayerIterator iterator(mMapDocument->map(), Layer::ObjectGroupType);
         while (auto objectGroup = static_cast<ObjectGroup*>(iterator.next())) {
             if (objectGroup->isHidden())
                 continue;
 
-            for (MapObject *object : objectGroup->objects())
+            const QPointF layerPos = mapScene ? mapScene->absolutePositionForLayer(*objectGroup)
+                                              : QPointF();
+
+            const auto objects = objectsNearView(*objectGroup);
+            for (MapObject *object : objects) {
+                if (cellSize > 0) {
+                    if (object->name().isEmpty() || !object->isVisible())
+                        continue;   // wouldn't get a visible label anyway
+
+                    const QPointF pos = renderer.pixelToScreenCoords(object->position()) + layerPos;
+                    const int cellX = static_cast<int>(std::floor(pos.x() / cellSize));
+                    const int cellY = static_cast<int>(std::floor(pos.y() / cellSize));
+                    const quint64 cell = (quint64(quint32(cellX)) << 32) | quint32(cellY);
+                    if (occupiedCells.contains(cell))
+                        continue;
+                    occupiedCells.insert(cell);
+                }
+
                 ensureLabel(object);
+            }
         }
     }
         // We want labels on selected objects regardless layer visibility
@@ -779,6 +938,9 @@ void ObjectSelectionItem::addRemoveObjectOutlines()
     const MapRenderer &renderer = *mMapDocument->renderer();
 
     for (MapObject *mapObject : mMapDocument->selectedObjects()) {
+        if (!objectNearView(mapObject))
+            continue;
+
         MapObjectOutline *outlineItem = mObjectOutlines.take(mapObject);
         if (!outlineItem) {
             outlineItem = new MapObjectOutline(mapObject, MapObjectOutline::SelectionIndicator, this);
@@ -797,6 +959,9 @@ void ObjectSelectionItem::addRemoveObjectHoverItems()
     const MapRenderer &renderer = *mMapDocument->renderer();
 
     for (MapObject *mapObject : mMapDocument->aboutToBeSelectedObjects()) {
+        if (!objectNearView(mapObject))
+            continue;
+
         auto hoverItem = mObjectHoverItems.take(mapObject);
         if (!hoverItem) {
             hoverItem = new MapObjectOutline(mapObject, MapObjectOutline::HoverIndicator, this);
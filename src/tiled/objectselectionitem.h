@@ -33,6 +33,7 @@ class GroupLayer;
 class Layer;
 class MapObject;
 class MapRenderer;
+class ObjectGroup;
 class Tile;
 class Tileset;
 
@@ -85,6 +86,9 @@ public:
     QRectF boundingRect() const override { return QRectF(); }
     void paint(QPainter *, const QStyleOptionGraphicsItem *, QWidget *) override {}
 
+protected:
+    QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
+
 private:
     void changeEvent(const ChangeEvent &event);
     void propertyRemoved(Object *object, const QString &name);
@@ -108,6 +112,12 @@ private:
     void showObjectReferencesChanged();
     void objectLineWidthChanged();
 
+    void sceneViewRectChanged();
+    void updateVisibleItems();
+    bool objectNearView(const MapObject *object) const;
+    QList<MapObject*> objectsNearView(const ObjectGroup &objectGroup) const;
+    qreal labelDeclutterCellSize() const;
+
     void addRemoveObjectLabels();
     void addRemoveObjectOutlines();
     void addRemoveObjectHoverItems();
@@ -121,6 +131,7 @@ private:
     QHash<MapObject*, QList<ObjectReferenceItem*>> mReferencesBySourceObject;
     QHash<MapObject*, QList<ObjectReferenceItem*>> mReferencesByTargetObject;
     std::unique_ptr<MapObjectItem> mHoveredMapObjectItem;
+    bool mVisibleItemsUpdatePending = false;
 };
 
 } // namespace Tiled
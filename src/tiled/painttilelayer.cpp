@@ -77,6 +77,16 @@ void PaintTileLayer::erase(TileLayer *target, const QRegion &eraseRegion)
     paint(target, 0, 0, &empty, eraseRegion);
 }
 
+void PaintTileLayer::compact()
+{
+    for (const auto &[tileLayer, data] : mLayerData) {
+        if (data.mSource)
+            data.mSource->compact();
+        if (data.mErased)
+            data.mErased->compact();
+    }
+}
+
 void PaintTileLayer::undo()
 {
     for (const auto& [tileLayer, data] : mLayerData) {
@@ -97,18 +107,6 @@ void PaintTileLayer::redo()
     }
 }
 
-void PaintTileLayer::LayerData::mergeWith(const LayerData &o)
-{
-    if (!mSource) {
-        mSource.reset(o.mSource->clone());
-        mErased.reset(o.mErased->clone());
-        mPaintedRegion = o.mPaintedRegion;
-        return;
-    }
-
-    copy(o);
-}
-
 void PaintTileLayer::LayerData::mergeWith(LayerData &&o)
 {
     if (!mSource)
@@ -121,7 +119,16 @@ void PaintTileLayer::LayerData::copy(const LayerData &o)
 {
     // Copy the newly painted tiles as well as the newly erased tiles over
     mSource->setCells(0, 0, o.mSource.get(), o.mPaintedRegion);
-    mErased->setCells(0, 0, o.mErased.get(), o.mPaintedRegion - mPaintedRegion);
+
+    // Only cells that were not painted on before contribute their erased
+    // state. The region subtraction gets expensive once a long stroke has
+    // accumulated many rectangles, so it is skipped when the regions can't
+    // overlap.
+    if (mPaintedRegion.boundingRect().intersects(o.mPaintedRegion.boundingRect()))
+        mErased->setCells(0, 0, o.mErased.get(), o.mPaintedRegion - mPaintedRegion);
+    else
+        mErased->setCells(0, 0, o.mErased.get(), o.mPaintedRegion);
+
     mPaintedRegion |= o.mPaintedRegion;
 }
 
@@ -133,8 +140,11 @@ bool PaintTileLayer::mergeWith(const QUndoCommand *other)
     if (!cloneChildren(other, this))
         return false;
 
-    for (const auto& [tileLayer, data] : o->mLayerData)
-        mLayerData[tileLayer].mergeWith(data);
+    // The undo stack deletes the given command when the merge succeeds, so
+    // its layer data can be taken over instead of copied.
+    auto &otherLayerData = const_cast<PaintTileLayer*>(o)->mLayerData;
+    for (auto& [tileLayer, data] : otherLayerData)
+        mLayerData[tileLayer].mergeWith(std::move(data));
 
     return true;
 }
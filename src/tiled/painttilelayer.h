@@ -84,6 +84,13 @@ public:
     void erase(TileLayer *target,
                const QRegion &eraseRegion);
 
+    /**
+     * Packs the stored tile buffers into their compact form, releasing most
+     * of the memory held by this command. They are expanded again when the
+     * command is undone or redone.
+     */
+    void compact();
+
     void undo() override;
     void redo() override;
 
@@ -93,7 +100,6 @@ public:
 private:
     struct LayerData
     {
-        void mergeWith(const LayerData &o);
         void mergeWith(LayerData &&o);
 
         std::unique_ptr<TileLayer> mSource;
@@ -22,6 +22,7 @@
 #include "preferences.h"
 
 #include "languagemanager.h"
+#include "memorybudget.h"
 #include "pluginmanager.h"
 #include "savefile.h"
 #include "session.h"
@@ -99,6 +100,8 @@ void Preferences::initialize()
     tilesetManager->setReloadTilesetsOnChange(reloadTilesetsOnChange());
     tilesetManager->setAnimateTiles(showTileAnimations());
 
+    MemoryBudget::setBudget(qint64(memoryBudget()) * 1024 * 1024);
+
     // Read the lists of enabled and disabled plugins
     const auto disabledPlugins = get<QStringList>("Plugins/Disabled");
     const auto enabledPlugins = get<QStringList>("Plugins/Enabled");
@@ -160,6 +163,11 @@ bool Preferences::showObjectReferences() const
     return get("Interface/ShowObjectReferences", true);
 }
 
+bool Preferences::showRenderStatistics() const
+{
+    return get("Interface/ShowRenderStatistics", false);
+}
+
 bool Preferences::parallaxEnabled() const
 {
     return get("Interface/ParallaxEnabled", true);
@@ -338,6 +346,12 @@ void Preferences::setShowObjectReferences(bool enabled)
     emit showObjectReferencesChanged(enabled);
 }
 
+void Preferences::setShowRenderStatistics(bool enabled)
+{
+    setValue(QLatin1String("Interface/ShowRenderStatistics"), enabled);
+    emit showRenderStatisticsChanged(enabled);
+}
+
 void Preferences::setParallaxEnabled(bool enabled)
 {
     setValue(QLatin1String("Interface/ParallaxEnabled"), enabled);
@@ -505,6 +519,31 @@ bool Preferences::exportOption(Preferences::ExportOption option) const
     return false;
 }
 
+bool Preferences::exportInSeparateProcess() const
+{
+    return get("Export/SeparateProcess", false);
+}
+
+void Preferences::setExportInSeparateProcess(bool enabled)
+{
+    setValue(QLatin1String("Export/SeparateProcess"), enabled);
+}
+
+/**
+ * The memory budget for the caches in megabytes, with 0 meaning unlimited.
+ */
+int Preferences::memoryBudget() const
+{
+    return get("Interface/MemoryBudget", 0);
+}
+
+void Preferences::setMemoryBudget(int megabytes)
+{
+    setValue(QLatin1String("Interface/MemoryBudget"), megabytes);
+    MemoryBudget::setBudget(qint64(megabytes) * 1024 * 1024);
+    MemoryBudget::enforce();
+}
+
 QString Preferences::language() const
 {
     return get<QString>("Interface/Language");
@@ -539,6 +578,17 @@ void Preferences::setUseOpenGL(bool useOpenGL)
     emit useOpenGLChanged(useOpenGL);
 }
 
+bool Preferences::softwareCompositing() const
+{
+    return get("Interface/SoftwareCompositing", false);
+}
+
+void Preferences::setSoftwareCompositing(bool enabled)
+{
+    setValue(QLatin1String("Interface/SoftwareCompositing"), enabled);
+    emit softwareCompositingChanged(enabled);
+}
+
 void Preferences::setPropertyTypes(const SharedPropertyTypes &propertyTypes)
 {
     Object::setPropertyTypes(propertyTypes);
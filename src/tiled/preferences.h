@@ -60,6 +60,7 @@ public:
     bool showTileAnimations() const;
     bool showTileCollisionShapes() const;
     bool showObjectReferences() const;
+    bool showRenderStatistics() const;
     bool parallaxEnabled() const;
     bool snapToGrid() const;
     bool snapToFineGrid() const;
@@ -130,6 +131,12 @@ public:
     void setExportOption(ExportOption option, bool value);
     bool exportOption(ExportOption option) const;
 
+    bool exportInSeparateProcess() const;
+    void setExportInSeparateProcess(bool enabled);
+
+    int memoryBudget() const;
+    void setMemoryBudget(int megabytes);
+
     QString language() const;
     void setLanguage(const QString &language);
 
@@ -139,6 +146,9 @@ public:
     bool useOpenGL() const;
     void setUseOpenGL(bool useOpenGL);
 
+    bool softwareCompositing() const;
+    void setSoftwareCompositing(bool enabled);
+
     void setPropertyTypes(const SharedPropertyTypes &propertyTypes);
 
     void setObjectTypesFile(const QString &filePath);
@@ -190,6 +200,7 @@ public slots:
     void setShowTileAnimations(bool enabled);
     void setShowTileCollisionShapes(bool enabled);
     void setShowObjectReferences(bool enabled);
+    void setShowRenderStatistics(bool enabled);
     void setParallaxEnabled(bool enabled);
     void setSnapToGrid(bool snapToGrid);
     void setSnapToFineGrid(bool snapToFineGrid);
@@ -217,6 +228,7 @@ signals:
     void showTileAnimationsChanged(bool enabled);
     void showTileCollisionShapesChanged(bool enabled);
     void showObjectReferencesChanged(bool enabled);
+    void showRenderStatisticsChanged(bool enabled);
     void parallaxEnabledChanged(bool enabled);
     void snapToGridChanged(bool snapToGrid);
     void snapToFineGridChanged(bool snapToFineGrid);
@@ -238,6 +250,7 @@ signals:
     void applicationFontChanged();
 
     void useOpenGLChanged(bool useOpenGL);
+    void softwareCompositingChanged(bool enabled);
 
     void languageChanged();
 
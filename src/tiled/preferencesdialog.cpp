@@ -105,6 +105,11 @@ PreferencesDialog::PreferencesDialog(QWidget *parent)
     connect(mUi->minimizeOutput, &QCheckBox::toggled, preferences, [preferences] (bool value) {
         preferences->setExportOption(Preferences::ExportMinimized, value);
     });
+    connect(mUi->exportInSeparateProcess, &QCheckBox::toggled,
+            preferences, &Preferences::setExportInSeparateProcess);
+
+    connect(mUi->memoryBudget, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            preferences, &Preferences::setMemoryBudget);
 
 #ifdef TILED_SENTRY
     connect(mUi->sendCrashReports, &QCheckBox::toggled, [] (bool value) {
@@ -133,6 +138,8 @@ PreferencesDialog::PreferencesDialog(QWidget *parent)
             this, [] (bool checked) { MapObjectItem::preciseTileObjectSelection = checked; });
     connect(mUi->openGL, &QCheckBox::toggled,
             preferences, &Preferences::setUseOpenGL);
+    connect(mUi->softwareCompositing, &QCheckBox::toggled,
+            preferences, &Preferences::setSoftwareCompositing);
     connect(mUi->wheelZoomsByDefault, &QCheckBox::toggled,
             preferences, &Preferences::setWheelZoomsByDefault);
     connect(mUi->autoScrolling, &QCheckBox::toggled,
@@ -218,6 +225,9 @@ void PreferencesDialog::fromPreferences()
     mUi->detachTemplateInstances->setChecked(prefs->exportOption(Preferences::DetachTemplateInstances));
     mUi->resolveObjectTypesAndProperties->setChecked(prefs->exportOption(Preferences::ResolveObjectTypesAndProperties));
     mUi->minimizeOutput->setChecked(prefs->exportOption(Preferences::ExportMinimized));
+    mUi->exportInSeparateProcess->setChecked(prefs->exportInSeparateProcess());
+
+    mUi->memoryBudget->setValue(prefs->memoryBudget());
 
 #ifdef TILED_SENTRY
     mUi->sendCrashReports->setChecked(Sentry::instance()->userConsent() == Sentry::ConsentGiven);
@@ -227,6 +237,7 @@ void PreferencesDialog::fromPreferences()
     mUi->preciseTileObjectSelection->setChecked(MapObjectItem::preciseTileObjectSelection);
     if (mUi->openGL->isEnabled())
         mUi->openGL->setChecked(prefs->useOpenGL());
+    mUi->softwareCompositing->setChecked(prefs->softwareCompositing());
     mUi->wheelZoomsByDefault->setChecked(prefs->wheelZoomsByDefault());
     mUi->autoScrolling->setChecked(MapView::ourAutoScrollingEnabled);
     mUi->smoothScrolling->setChecked(MapView::ourSmoothScrollingEnabled);
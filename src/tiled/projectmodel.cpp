@@ -29,6 +29,7 @@
 #include <QFileInfo>
 #include <QMimeData>
 #include <QSet>
+#include <QVarLengthArray>
 #include <QUrl>
 
 namespace Tiled {
@@ -78,26 +79,39 @@ static void collectDirectories(const FolderEntry &entry, QStringList &filePaths)
     }
 }
 
-static void findFiles(const FolderEntry &entry, int offset, const QStringList &words, QVector<ProjectModel::Match> &result)
+// Returns a bitmask telling which characters occur in \a string: a bit per
+// letter, one bit for digits and one for any other character. Since the fuzzy
+// match requires every character of a word to occur in the matched string, a
+// word whose mask has bits that the string's mask lacks cannot match, which
+// lets findFiles reject most files with a single bit test.
+static quint32 characterMask(const QChar *string, int size)
+{
+    quint32 mask = 0;
+    for (int i = 0; i < size; ++i) {
+        const auto c = string[i].toLower().unicode();
+        if (c >= u'a' && c <= u'z')
+            mask |= 1u << (c - u'a');
+        else if (c >= u'0' && c <= u'9')
+            mask |= 1u << 26;
+        else
+            mask |= 1u << 27;
+    }
+    return mask;
+}
+
+static void collectLocatorFiles(const FolderEntry &entry, int offset, QVector<ProjectModel::LocatorFile> &index)
 {
     for (const auto &childEntry : entry.entries) {
         if (childEntry->entries.empty()) {
-#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
-            const auto relativePath = QStringView(childEntry->filePath).mid(offset);
-#else
-            const auto relativePath = childEntry->filePath.midRef(offset);
-#endif
-            const int totalScore = Utils::matchingScore(words, relativePath);
-
-            if (totalScore > 0) {
-                result.append(ProjectModel::Match {
-                                   totalScore,
-                                   offset,
-                                   childEntry->filePath
-                               });
-            }
+            const QString &filePath = childEntry->filePath;
+            index.append(ProjectModel::LocatorFile {
+                             characterMask(filePath.constData() + offset,
+                                           filePath.size() - offset),
+                             offset,
+                             filePath
+                         });
         } else {
-            findFiles(*childEntry, offset, words, result);
+            collectLocatorFiles(*childEntry, offset, index);
         }
     }
 }
@@ -151,6 +165,8 @@ void ProjectModel::setProject(Project project)
     mProject = std::move(project);
     mFolders.clear();
     mFoldersPendingScan.clear();
+    mFileNameIndexDirty = true;
+    mLocatorIndexDirty = true;
 
     for (const QString &folder : mProject.folders()) {
         mFolders.push_back(std::make_unique<FolderEntry>(folder));
@@ -171,6 +187,8 @@ void ProjectModel::addFolder(const QString &folder)
 
     mProject.addFolder(folder);
     mFolders.push_back(std::make_unique<FolderEntry>(folder));
+    mFileNameIndexDirty = true;
+    mLocatorIndexDirty = true;
     mWatcher.addPath(folder);
     scheduleFolderScan(folder);
 
@@ -190,6 +208,8 @@ void ProjectModel::removeFolder(int row)
     beginRemoveRows(QModelIndex(), row, row);
     mProject.removeFolder(row);
     mFolders.erase(mFolders.begin() + row);
+    mFileNameIndexDirty = true;
+    mLocatorIndexDirty = true;
     mWatcher.removePaths(watchedFilePaths);
     endRemoveRows();
 
@@ -211,12 +231,87 @@ void ProjectModel::refreshFolders()
 
 QVector<ProjectModel::Match> ProjectModel::findFiles(const QStringList &words) const
 {
+    if (mLocatorIndexDirty)
+        rebuildLocatorIndex();
+
+    QVarLengthArray<quint32, 8> wordMasks;
+    for (const QString &word : words)
+        wordMasks.append(characterMask(word.constData(), word.size()));
+
     QVector<Match> result;
-    for (const auto &entry : mFolders)
-        Tiled::findFiles(*entry, entry->filePath.lastIndexOf(QLatin1Char('/')) + 1, words, result);
+
+    for (const LocatorFile &file : mLocatorIndex) {
+        bool possibleMatch = true;
+        for (const quint32 wordMask : wordMasks) {
+            if (wordMask & ~file.charMask) {
+                possibleMatch = false;
+                break;
+            }
+        }
+        if (!possibleMatch)
+            continue;
+
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+        const auto relativePath = QStringView(file.path).mid(file.offset);
+#else
+        const auto relativePath = file.path.midRef(file.offset);
+#endif
+        const int totalScore = Utils::matchingScore(words, relativePath);
+
+        if (totalScore > 0) {
+            result.append(Match {
+                              totalScore,
+                              file.offset,
+                              file.path
+                          });
+        }
+    }
+
     return result;
 }
 
+void ProjectModel::rebuildLocatorIndex() const
+{
+    mLocatorIndex.clear();
+    for (const auto &entry : mFolders)
+        collectLocatorFiles(*entry, entry->filePath.lastIndexOf(QLatin1Char('/')) + 1, mLocatorIndex);
+    mLocatorIndexDirty = false;
+}
+
+static void collectFileNames(const FolderEntry &entry,
+                             QMultiHash<QString, QString> &index)
+{
+    for (const auto &childEntry : entry.entries) {
+        if (childEntry->entries.empty()) {
+            const int slash = childEntry->filePath.lastIndexOf(QLatin1Char('/'));
+            index.insert(childEntry->filePath.mid(slash + 1),
+                         childEntry->filePath);
+        } else {
+            collectFileNames(*childEntry, index);
+        }
+    }
+}
+
+/**
+ * Returns the paths of all scanned files in the project folders that have
+ * the given \a fileName.
+ */
+QStringList ProjectModel::filesWithFileName(const QString &fileName) const
+{
+    if (mFileNameIndexDirty)
+        rebuildFileNameIndex();
+
+    return mFileNameIndex.values(fileName);
+}
+
+void ProjectModel::rebuildFileNameIndex() const
+{
+    mFileNameIndex.clear();
+    for (const auto &entry : mFolders)
+        collectFileNames(*entry, mFileNameIndex);
+    mFileNameIndexDirty = false;
+}
+
 QString ProjectModel::filePath(const QModelIndex &index) const
 {
     if (!index.isValid())
@@ -450,6 +545,9 @@ void ProjectModel::folderScanned(FolderEntry *resultPointer)
         endInsertRows();
     }
 
+    mFileNameIndexDirty = true;
+    mLocatorIndexDirty = true;
+
     emit refreshed();
 
     if (!mFoldersPendingScan.isEmpty()) {
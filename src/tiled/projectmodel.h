@@ -25,6 +25,7 @@
 
 #include <QAbstractListModel>
 #include <QFileIconProvider>
+#include <QHash>
 #include <QThread>
 #include <QTimer>
 
@@ -75,7 +76,14 @@ public:
 #endif
     };
 
+    struct LocatorFile {
+        quint32 charMask;   // set bit per character class in relativePath()
+        int offset;
+        QString path;
+    };
+
     QVector<Match> findFiles(const QStringList &words) const;
+    QStringList filesWithFileName(const QString &fileName) const;
 
     QString filePath(const QModelIndex &index) const;
 
@@ -113,6 +121,8 @@ private:
 
     void scheduleFolderScan(const QString &folder);
     void folderScanned(FolderEntry *entry);
+    void rebuildFileNameIndex() const;
+    void rebuildLocatorIndex() const;
 
     Project mProject;
     QFileIconProvider mFileIconProvider;
@@ -121,6 +131,14 @@ private:
 
     std::vector<std::unique_ptr<FolderEntry>> mFolders;
 
+    // File name -> absolute paths of the scanned files, rebuilt on demand
+    mutable QMultiHash<QString, QString> mFileNameIndex;
+    mutable bool mFileNameIndexDirty = true;
+
+    // Flat list of the scanned files used by findFiles, rebuilt on demand
+    mutable QVector<LocatorFile> mLocatorIndex;
+    mutable bool mLocatorIndexDirty = true;
+
     QThread mScanningThread;
     QString mScanningFolder;
     QStringList mFoldersPendingScan;
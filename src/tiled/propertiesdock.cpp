@@ -230,27 +230,25 @@ void PropertiesDock::pasteProperties()
     if (objects.isEmpty())
         return;
 
-    QList<QUndoCommand*> commands;
+    QList<Object*> changedObjects;
+    QVector<Properties> newProperties;
 
     for (Object *object : objects) {
         Properties properties = object->properties();
         mergeProperties(properties, pastedProperties);
 
         if (object->properties() != properties) {
-            commands.append(new ChangeProperties(mDocument, QString(), object,
-                                                 properties));
+            changedObjects.append(object);
+            newProperties.append(properties);
         }
     }
 
-    if (!commands.isEmpty()) {
-        QUndoStack *undoStack = mDocument->undoStack();
-        undoStack->beginMacro(tr("Paste Property/Properties", nullptr,
-                                 pastedProperties.size()));
-
-        for (QUndoCommand *command : commands)
-            undoStack->push(command);
-
-        undoStack->endMacro();
+    if (!changedObjects.isEmpty()) {
+        auto command = new ChangeProperties(mDocument, QString(),
+                                            changedObjects, newProperties);
+        command->setText(tr("Paste Property/Properties", nullptr,
+                            pastedProperties.size()));
+        mDocument->undoStack()->push(command);
     }
 }
 
@@ -70,6 +70,8 @@
 
 namespace Tiled {
 
+static bool objectPropertiesRelevant(Document *document, Object *object);
+
 namespace {
 
 /**
@@ -269,6 +271,9 @@ bool PropertyBrowser::allCustomPropertyItems(const QList<QtBrowserItem *> &items
  */
 void PropertyBrowser::selectCustomProperty(const QString &name)
 {
+    if (mUpdateCustomPropertiesPending)
+        updateCustomPropertiesNow();
+
     QtVariantProperty *property = mCustomPropertiesHelper.property(name);
     if (!property)
         return;
@@ -284,6 +289,9 @@ void PropertyBrowser::selectCustomProperty(const QString &name)
  */
 void PropertyBrowser::editCustomProperty(const QString &name)
 {
+    if (mUpdateCustomPropertiesPending)
+        updateCustomPropertiesNow();
+
     QtVariantProperty *property = mCustomPropertiesHelper.property(name);
     if (!property)
         return;
@@ -339,6 +347,11 @@ void PropertyBrowser::documentChanged(const ChangeEvent &change)
             }
         }
 
+        if (objectsChange.properties & ObjectsChangeEvent::CustomProperties)
+            if (std::any_of(objectsChange.objects.begin(), objectsChange.objects.end(),
+                            [this] (Object *object) { return objectPropertiesRelevant(mDocument, object); }))
+                updateCustomProperties();
+
         break;
     }
     case ChangeEvent::LayerChanged:
@@ -2058,27 +2071,63 @@ Properties PropertyBrowser::combinedProperties() const
     return combinedProperties;
 }
 
+/**
+ * Schedules an update of the custom properties. Since this update covers all
+ * custom properties, it is delayed until the next event loop iteration, so
+ * that it happens only once when many objects change at the same time (for
+ * example when changing the selection).
+ */
 void PropertyBrowser::updateCustomProperties()
 {
-    if (!mObject)
+    if (mUpdateCustomPropertiesPending)
+        return;
+    mUpdateCustomPropertiesPending = true;
+
+    QMetaObject::invokeMethod(this, &PropertyBrowser::updateCustomPropertiesNow,
+                              Qt::QueuedConnection);
+}
+
+void PropertyBrowser::updateCustomPropertiesNow()
+{
+    mUpdateCustomPropertiesPending = false;
+
+    if (!mObject || !mCustomPropertiesGroup)
         return;
 
     UpdatingProperties updatingProperties(this, mUpdating);
 
-    mCustomPropertiesHelper.clear();
+    const Properties combined = combinedProperties();
+
+    // Delete properties that are no longer present, keeping the others to
+    // avoid rebuilding the entire tree.
+    const QHash<QString, QtVariantProperty*> existingProperties = mCustomPropertiesHelper.properties();
+    for (auto it = existingProperties.constBegin(); it != existingProperties.constEnd(); ++it)
+        if (!combined.contains(it.key()))
+            mCustomPropertiesHelper.deleteProperty(it.value());
+
+    QtProperty *precedingProperty = nullptr;
 
-    QMapIterator<QString,QVariant> it(combinedProperties());
+    QMapIterator<QString,QVariant> it(combined);
     while (it.hasNext()) {
         it.next();
 
-        QtVariantProperty *property = createCustomProperty(it.key(), it.value());
-        mCustomPropertiesGroup->addSubProperty(property);
+        QtVariantProperty *property = mCustomPropertiesHelper.property(it.key());
+        if (property) {
+            setCustomPropertyValue(property, it.value());
 
-        // Collapse custom color properties, to save space
-        if (property->valueType() == QMetaType::QColor)
-            setExpanded(items(property).constFirst(), false);
+            // The property might have been re-created to change its type
+            property = mCustomPropertiesHelper.property(it.key());
+        } else {
+            property = createCustomProperty(it.key(), it.value());
+            mCustomPropertiesGroup->insertSubProperty(property, precedingProperty);
+
+            // Collapse custom color properties, to save space
+            if (property->valueType() == QMetaType::QColor)
+                setExpanded(items(property).constFirst(), false);
+        }
 
         updateCustomPropertyColor(it.key());
+        precedingProperty = property;
     }
 }
 
@@ -2192,6 +2241,9 @@ void PropertyBrowser::retranslateUi()
     mLayerFormatNames.append(QCoreApplication::translate("PreferencesDialog", "CSV"));
     mLayerFormatValues.append(Map::CSV);
 
+    mLayerFormatNames.append(QCoreApplication::translate("PreferencesDialog", "Delta-encoded (VLQ)"));
+    mLayerFormatValues.append(Map::DeltaVLQ);
+
     mRenderOrderNames.clear();
     mRenderOrderNames.append(QCoreApplication::translate("PreferencesDialog", "Right Down"));
     mRenderOrderNames.append(QCoreApplication::translate("PreferencesDialog", "Right Up"));
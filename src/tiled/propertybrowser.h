@@ -207,6 +207,7 @@ private:
     void updateProperties();
     Properties combinedProperties() const;
     void updateCustomProperties();
+    void updateCustomPropertiesNow();
 
     void updateCustomPropertyColor(const QString &name);
     void updateCustomPropertyColors();
@@ -218,6 +219,7 @@ private:
     void retranslateUi();
 
     bool mUpdating = false;
+    bool mUpdateCustomPropertiesPending = false;
     int mMapObjectFlags = 0;
     Object *mObject = nullptr;
     Document *mDocument = nullptr;
@@ -399,10 +399,14 @@ void PropertyTypesEditor::applyMemberToSelectedType(const QString &name, const Q
 
 void PropertyTypesEditor::applyPropertyTypes()
 {
+    Project &project = ProjectManager::instance()->project();
+
+    // Types may have been adjusted in place
+    project.propertyTypes()->invalidateClassLookupCache();
+
     QScopedValueRollback<bool> settingPrefPropertyTypes(mSettingPrefPropertyTypes, true);
     emit Preferences::instance()->propertyTypesChanged();
 
-    Project &project = ProjectManager::instance()->project();
     project.save();
 }
 
@@ -23,6 +23,7 @@
 #include <QMap>
 
 #include <random>
+#include <vector>
 
 namespace Tiled {
 
@@ -35,6 +36,10 @@ inline std::default_random_engine &globalRandomEngine()
 /**
  * A class that helps pick random things that each have a probability
  * assigned.
+ *
+ * The first pick builds an alias table (Vose's method), which makes each
+ * pick constant-time regardless of the number of entries. This matters when
+ * sampling once per cell while filling large regions.
  */
 template<typename T, typename Real = qreal>
 class RandomPicker
@@ -49,6 +54,7 @@ public:
         if (probability > 0) {
             mSum += probability;
             mThresholds.insert(mSum, value);
+            mAliasTableValid = false;
         }
     }
 
@@ -64,13 +70,20 @@ public:
         if (mThresholds.size() == 1)
             return mThresholds.first();
 
-        std::uniform_real_distribution<Real> dis(0, mSum);
+        if (!mAliasTableValid)
+            buildAliasTable();
+
+        // Pick a bucket, then either its own value or its alias based on a
+        // biased coin flip.
+        std::uniform_real_distribution<Real> dis(0, static_cast<Real>(mValues.size()));
         const Real random = dis(globalRandomEngine());
-        auto it = mThresholds.lowerBound(random);
-        if (it == mThresholds.end())
-            --it;
+        const auto bucket = qMin(static_cast<std::size_t>(random),
+                                 mValues.size() - 1);
+        const Real coin = random - static_cast<Real>(bucket);
 
-        return it.value();
+        if (coin < mBuckets[bucket].threshold)
+            return mValues[bucket];
+        return mValues[mBuckets[bucket].alias];
     }
 
     //same as pick, but removes the selected element.
@@ -86,6 +99,7 @@ public:
 
         const T result = it.value();
         mThresholds.erase(it);
+        mAliasTableValid = false;
         return result;
     }
 
@@ -93,11 +107,74 @@ public:
     {
         mSum = 0.0;
         mThresholds.clear();
+        mAliasTableValid = false;
     }
 
 private:
+    void buildAliasTable() const
+    {
+        const std::size_t count = static_cast<std::size_t>(mThresholds.size());
+
+        mValues.clear();
+        mValues.reserve(count);
+
+        // Each entry's probability, scaled so that the average is 1
+        std::vector<Real> scaled;
+        scaled.reserve(count);
+
+        Real previousThreshold = 0.0;
+        for (auto it = mThresholds.cbegin(); it != mThresholds.cend(); ++it) {
+            mValues.push_back(it.value());
+            scaled.push_back((it.key() - previousThreshold) * count / mSum);
+            previousThreshold = it.key();
+        }
+
+        mBuckets.resize(count);
+
+        std::vector<std::size_t> small;
+        std::vector<std::size_t> large;
+        for (std::size_t i = 0; i < count; ++i)
+            (scaled[i] < 1.0 ? small : large).push_back(i);
+
+        // Top up each under-full bucket from an over-full one
+        while (!small.empty() && !large.empty()) {
+            const std::size_t s = small.back();
+            const std::size_t l = large.back();
+            small.pop_back();
+            large.pop_back();
+
+            mBuckets[s].threshold = scaled[s];
+            mBuckets[s].alias = l;
+
+            scaled[l] -= 1.0 - scaled[s];
+            (scaled[l] < 1.0 ? small : large).push_back(l);
+        }
+
+        // Whatever remains is full up to rounding errors
+        for (const std::size_t i : small) {
+            mBuckets[i].threshold = 1.0;
+            mBuckets[i].alias = i;
+        }
+        for (const std::size_t i : large) {
+            mBuckets[i].threshold = 1.0;
+            mBuckets[i].alias = i;
+        }
+
+        mAliasTableValid = true;
+    }
+
+    struct AliasBucket {
+        Real threshold;
+        std::size_t alias;
+    };
+
     Real mSum;
     QMap<Real, T> mThresholds;
+
+    // Alias table, built lazily from mThresholds (see buildAliasTable)
+    mutable std::vector<T> mValues;
+    mutable std::vector<AliasBucket> mBuckets;
+    mutable bool mAliasTableValid = false;
 };
 
 } // namespace Tiled
@@ -53,9 +53,11 @@
 #include "tileseteditor.h"
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDesktopServices>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QQmlEngine>
 #include <QStandardPaths>
 #if QT_VERSION < QT_VERSION_CHECK(6,0,0)
@@ -246,8 +248,19 @@ QString ScriptManager::createTempValue(const QJSValue &value)
     return name;
 }
 
+static QByteArray scriptFileHash(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly))
+        return QByteArray();
+    return QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+}
+
 void ScriptManager::loadExtensions()
 {
+    mScriptFileHashes.clear();
+    mExtensionDirScripts.clear();
+
     QStringList extensionSearchPaths;
 
     for (const QString &extensionsPath : std::as_const(mExtensionsPaths)) {
@@ -279,8 +292,11 @@ void ScriptManager::loadExtension(const QString &path)
     const QStringList jsFiles = dir.entryList(nameFilters,
                                               QDir::Files | QDir::Readable);
 
+    mExtensionDirScripts.insert(path, jsFiles);
+
     for (const QString &jsFile : jsFiles) {
         const QString absolutePath = dir.filePath(jsFile);
+        mScriptFileHashes.insert(absolutePath, scriptFileHash(absolutePath));
         evaluateFileOrLoadModule(absolutePath);
         mWatcher.addPath(absolutePath);
     }
@@ -417,10 +433,50 @@ void ScriptManager::onScriptWarnings(const QList<QQmlError> &warnings)
 
 void ScriptManager::scriptFilesChanged(const QStringList &scriptFiles)
 {
+    if (!scriptContentChanged(scriptFiles))
+        return;
+
     Tiled::INFO(tr("Script files changed: %1").arg(scriptFiles.join(QLatin1String(", "))));
     reset();
 }
 
+/**
+ * Returns whether any of the given changed paths affects the loaded scripts.
+ *
+ * Editors that save by atomic rename and extensions writing data files into
+ * their own directory trigger change notifications without changing any
+ * script content. Since reacting means re-creating the entire script engine
+ * and re-evaluating every extension, such notifications are filtered out by
+ * comparing a content hash recorded when each script was loaded.
+ */
+bool ScriptManager::scriptContentChanged(const QStringList &scriptFiles) const
+{
+    const QStringList nameFilters = {
+        QLatin1String("*.js"),
+        QLatin1String("*.mjs")
+    };
+
+    for (const QString &path : scriptFiles) {
+        if (QFileInfo(path).isDir()) {
+            // For directories only the set of script files matters. A deleted
+            // directory no longer lists any scripts, so it is covered too.
+            const QStringList jsFiles = QDir(path).entryList(nameFilters,
+                                                             QDir::Files | QDir::Readable);
+            if (mExtensionDirScripts.value(path) != jsFiles)
+                return true;
+        } else {
+            const auto it = mScriptFileHashes.constFind(path);
+            if (it == mScriptFileHashes.constEnd())
+                return true;    // not a file we loaded, play it safe
+            if (scriptFileHash(path) != it.value())
+                return true;
+        }
+    }
+
+    Tiled::INFO(tr("Ignoring file change that did not affect script content"));
+    return false;
+}
+
 void ScriptManager::refreshExtensionsPaths()
 {
     QStringList extensionsPaths;
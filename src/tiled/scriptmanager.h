@@ -23,6 +23,7 @@
 #include "filesystemwatcher.h"
 #include "tilededitor_global.h"
 
+#include <QHash>
 #include <QJSValue>
 #include <QObject>
 #include <QQmlError>
@@ -108,10 +109,13 @@ private:
     void loadExtension(const QString &path);
 
     QJSValue evaluateFile(const QString &fileName);
+    bool scriptContentChanged(const QStringList &scriptFiles) const;
 
     QJSEngine *mEngine = nullptr;
     ScriptModule *mModule = nullptr;
     FileSystemWatcher mWatcher;
+    QHash<QString, QByteArray> mScriptFileHashes;
+    QHash<QString, QStringList> mExtensionDirScripts;
     QString mExtensionsPath;
     QStringList mExtensionsPaths;
     int mTempCount = 0;
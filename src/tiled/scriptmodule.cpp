@@ -28,7 +28,10 @@
 #include "issuesmodel.h"
 #include "logginginterface.h"
 #include "mainwindow.h"
+#include "map.h"
 #include "mapeditor.h"
+#include "mapformat.h"
+#include "minimaprenderer.h"
 #include "projectmanager.h"
 #include "scriptdialog.h"
 #include "scriptedaction.h"
@@ -45,7 +48,9 @@
 #include <QLibraryInfo>
 #include <QMenu>
 #include <QMessageBox>
+#include <QPointer>
 #include <QQmlEngine>
+#include <QThreadPool>
 #include <QVersionNumber>
 
 namespace Tiled {
@@ -333,7 +338,7 @@ EditableAsset *ScriptModule::reload(EditableAsset *asset) const
     // possibly also its document. We'll try to find it by its file name.
     const auto fileName = asset->fileName();
 
-    if (documentManager->reloadDocumentAt(index)) {
+    if (documentManager->reloadDocumentAt(index, true)) {
         int newIndex = documentManager->findDocument(fileName);
         if (newIndex != -1)
             return documentManager->documents().at(newIndex)->editable();
@@ -534,6 +539,127 @@ QByteArray ScriptModule::decompress(const QByteArray &data, CompressionMethod me
     return Tiled::decompress(data, data.size(), static_cast<Tiled::CompressionMethod>(method));
 }
 
+/**
+ * Renders each map in \a mapFiles to the corresponding image file in
+ * \a imageFiles.
+ *
+ * The maps are read one at a time on the main thread, so that external
+ * tilesets are loaded only once and shared read-only between all maps, while
+ * the rendering and image encoding run in parallel on the global thread
+ * pool. The optional \a rendered callback is called on the main thread once
+ * for each map, with the map file name and an error string that is empty on
+ * success. The optional \a size sets the size of the rendered images, which
+ * defaults to the full size of each map.
+ */
+void ScriptModule::renderMaps(const QStringList &mapFiles,
+                              const QStringList &imageFiles,
+                              QJSValue rendered,
+                              QSize size)
+{
+    if (mapFiles.size() != imageFiles.size()) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Expected as many image files as map files"));
+        return;
+    }
+    if (!rendered.isUndefined() && !rendered.isCallable()) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Invalid callback function"));
+        return;
+    }
+    if (!mPendingMapRenders.isEmpty() || mActiveMapRenders > 0) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "A batch render is already in progress"));
+        return;
+    }
+
+    mMapRenderCallback = rendered;
+    mMapRenderSize = size;
+
+    for (int i = 0; i < mapFiles.size(); ++i)
+        mPendingMapRenders.append({ mapFiles.at(i), imageFiles.at(i) });
+
+    startPendingMapRenders();
+}
+
+/**
+ * Reads the next pending map and hands it to the thread pool for rendering.
+ *
+ * Only a single map is read per call to keep the main thread responsive
+ * during a batch render. While there are more pending maps and free slots on
+ * the thread pool, another call is scheduled through the event loop.
+ */
+void ScriptModule::startPendingMapRenders()
+{
+    const auto threadPool = QThreadPool::globalInstance();
+
+    if (mPendingMapRenders.isEmpty() || mActiveMapRenders >= threadPool->maxThreadCount())
+        return;
+
+    const MapRenderJob job = mPendingMapRenders.takeFirst();
+
+    QString error;
+    const std::shared_ptr<Map> map { readMap(job.mapFile, &error) };
+    if (!map) {
+        mapRenderFinished(job.mapFile, error);
+    } else {
+        ++mActiveMapRenders;
+
+        const QPointer<ScriptModule> self = this;
+        const QSize size = mMapRenderSize;
+
+        threadPool->start([=] {
+            const MiniMapRenderer renderer(map.get());
+            const QSize imageSize = size.isValid() ? size : renderer.mapSize();
+            const MiniMapRenderer::RenderFlags renderFlags(MiniMapRenderer::DrawTileLayers |
+                                                           MiniMapRenderer::DrawMapObjects |
+                                                           MiniMapRenderer::DrawImageLayers |
+                                                           MiniMapRenderer::IgnoreInvisibleLayer |
+                                                           MiniMapRenderer::DrawBackground);
+
+            const QImage image = renderer.render(imageSize, renderFlags);
+
+            QString saveError;
+            if (!image.save(job.imageFile))
+                saveError = QCoreApplication::translate("Script Errors", "Failed to save image %1").arg(job.imageFile);
+
+            QMetaObject::invokeMethod(self, [=] {
+                --self->mActiveMapRenders;
+                self->mapRenderFinished(job.mapFile, saveError);
+                self->startPendingMapRenders();
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    if (!mPendingMapRenders.isEmpty())
+        QMetaObject::invokeMethod(this, &ScriptModule::startPendingMapRenders, Qt::QueuedConnection);
+}
+
+/**
+ * Returns the number of times maps, layers and objects have been cloned
+ * since the application started (see CloneStatistics).
+ *
+ * Useful for checking whether an operation copies more data than expected,
+ * for example by comparing the counters before and after triggering it from
+ * the console.
+ */
+QVariantMap ScriptModule::cloneStatistics() const
+{
+    return {
+        { QStringLiteral("mapClones"), QVariant::fromValue(CloneStatistics::mapClones.load()) },
+        { QStringLiteral("layerClones"), QVariant::fromValue(CloneStatistics::layerClones.load()) },
+        { QStringLiteral("objectClones"), QVariant::fromValue(CloneStatistics::objectClones.load()) },
+    };
+}
+
+void ScriptModule::mapRenderFinished(const QString &mapFile, const QString &error)
+{
+    if (mMapRenderCallback.isCallable()) {
+        QJSValue result = mMapRenderCallback.call({ mapFile, error });
+        ScriptManager::instance().checkError(result);
+    }
+
+    // Release the callback once the whole batch has finished
+    if (mPendingMapRenders.isEmpty() && mActiveMapRenders == 0)
+        mMapRenderCallback = QJSValue();
+}
+
 void ScriptModule::trigger(const QByteArray &actionName) const
 {
     if (QAction *action = ActionManager::findAction(actionName))
@@ -134,6 +134,13 @@ public:
     Q_INVOKABLE QByteArray compress(const QByteArray &data, CompressionMethod method = Zlib, int compressionLevel = -1);
     Q_INVOKABLE QByteArray decompress(const QByteArray &data, CompressionMethod method = Zlib);
 
+    Q_INVOKABLE void renderMaps(const QStringList &mapFiles,
+                                const QStringList &imageFiles,
+                                QJSValue rendered = QJSValue(),
+                                QSize size = QSize());
+
+    Q_INVOKABLE QVariantMap cloneStatistics() const;
+
 signals:
     void assetCreated(Tiled::EditableAsset *asset);
     void assetOpened(Tiled::EditableAsset *asset);
@@ -166,11 +173,24 @@ private:
 
     void setCallback(Issue &issue, QJSValue activated);
 
+    void startPendingMapRenders();
+    void mapRenderFinished(const QString &mapFile, const QString &error);
+
     std::map<Id, std::unique_ptr<ScriptedAction>> mRegisteredActions;
     std::map<QString, std::unique_ptr<ScriptedMapFormat>> mRegisteredMapFormats;
     std::map<QString, std::unique_ptr<ScriptedTilesetFormat>> mRegisteredTilesetFormats;
     std::map<Id, std::unique_ptr<ScriptedTool>> mRegisteredTools;
 
+    // State of the batch render started by renderMaps()
+    struct MapRenderJob {
+        QString mapFile;
+        QString imageFile;
+    };
+    QVector<MapRenderJob> mPendingMapRenders;
+    QJSValue mMapRenderCallback;
+    QSize mMapRenderSize;
+    int mActiveMapRenders = 0;
+
     QStringList mScriptArguments;
 };
 
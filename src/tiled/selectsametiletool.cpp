@@ -55,7 +55,8 @@ void SelectSameTileTool::tilePositionChanged(QPoint tilePos)
             resultRegion = infinite ? tileLayer->bounds() : tileLayer->rect();
             resultRegion -= tileLayer->region();
         } else {
-            resultRegion = tileLayer->region([&] (const Cell &cell) { return cell == matchCell; });
+            // Only scans the chunks known to contain the matched tile
+            resultRegion = tileLayer->region(matchCell);
         }
     }
     setSelectedRegion(resultRegion);
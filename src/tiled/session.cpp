@@ -21,10 +21,15 @@
 #include "session.h"
 
 #include "documentmanager.h"
+#include "jobscheduler.h"
 #include "preferences.h"
-#include "utils.h"
+#include "savefile.h"
 
+#include <QFile>
 #include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
 
 namespace Tiled {
 
@@ -58,14 +63,50 @@ QStringList FileHelper::resolve(const QStringList &fileNames) const
 QHash<QLatin1String, Session::Callbacks> Session::mChangedCallbacks;
 std::unique_ptr<Session> Session::mCurrent;
 
+/**
+ * Keeps track of the last session state written to each file, so that
+ * overlapping writes scheduled on the thread pool can never replace newer
+ * state with older state. Shared with the write tasks, since they may
+ * outlive the Session instance.
+ */
+struct Session::WriteState
+{
+    QMutex mutex;
+    QHash<QString, int> lastWrittenGeneration;
+};
+
+static QVariantMap readSessionFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QVariantMap();
+
+    return QJsonDocument::fromJson(file.readAll()).toVariant().toMap();
+}
+
+static bool writeSessionFile(const QString &fileName, const QVariantMap &values)
+{
+    SaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    const QByteArray json = QJsonDocument { QJsonObject::fromVariantMap(values) }.toJson();
+    if (file.device()->write(json) != json.size())
+        return false;
+
+    return file.commit();
+}
+
 Session::Session(const QString &fileName)
     : FileHelper            { fileName }
-    , settings              { Utils::jsonSettings(fileName) }
+    , mFileName             { fileName }
+    , mValues               { readSessionFile(fileName) }
     , project               { resolve(get<QString>("project")) }
     , recentFiles           { resolve(get<QStringList>("recentFiles")) }
     , openFiles             { resolve(get<QStringList>("openFiles")) }
     , expandedProjectPaths  { resolve(get<QStringList>("expandedProjectPaths")) }
     , activeFile            { resolve(get<QString>("activeFile")) }
+    , mWriteState           { std::make_shared<WriteState>() }
 {
     const auto states = get<QVariantMap>("fileStates");
     for (auto it = states.constBegin(); it != states.constEnd(); ++it)
@@ -73,19 +114,20 @@ Session::Session(const QString &fileName)
 
     mSyncSettingsTimer.setInterval(1000);
     mSyncSettingsTimer.setSingleShot(true);
-    QObject::connect(&mSyncSettingsTimer, &QTimer::timeout, [this] { sync(); });
+    QObject::connect(&mSyncSettingsTimer, &QTimer::timeout, [this] {
+        sync();
+        writeAsync();
+    });
 }
 
 Session::~Session()
 {
     if (mSyncSettingsTimer.isActive())
-        sync();
+        save();
 }
 
 void Session::sync()
 {
-    mSyncSettingsTimer.stop();
-
     set("project",              relative(project));
     set("recentFiles",          relative(recentFiles));
     set("openFiles",            relative(openFiles));
@@ -96,13 +138,53 @@ void Session::sync()
     for (auto it = fileStates.constBegin(); it != fileStates.constEnd(); ++it)
         states.insert(relative(it.key()), it.value());
     set("fileStates", states);
+
+    // The calls above re-arm the timer, but the state they recorded is
+    // covered by the write that follows this function.
+    mSyncSettingsTimer.stop();
 }
 
 bool Session::save()
 {
     sync();
-    settings->sync();
-    return settings->status() == QSettings::NoError;
+    return writeNow();
+}
+
+/**
+ * Schedules writing out the current state as a background job, so that
+ * frequent state changes (like switching documents) never touch the disk
+ * synchronously.
+ */
+void Session::writeAsync()
+{
+    const QString fileName = mFileName;
+    const QVariantMap values = mValues;
+    const int generation = ++mSyncGeneration;
+    const auto state = mWriteState;
+
+    JobScheduler::schedule(JobScheduler::NormalPriority,
+                           [=] (const JobScheduler::Token &) {
+        QMutexLocker locker(&state->mutex);
+        int &lastWritten = state->lastWrittenGeneration[fileName];
+        if (generation <= lastWritten)
+            return;
+
+        lastWritten = generation;
+        writeSessionFile(fileName, values);
+    });
+}
+
+/**
+ * Writes out the current state immediately, used at shutdown and when the
+ * session moves to a different file.
+ */
+bool Session::writeNow()
+{
+    const int generation = ++mSyncGeneration;
+
+    QMutexLocker locker(&mWriteState->mutex);
+    mWriteState->lastWrittenGeneration[mFileName] = generation;
+    return writeSessionFile(mFileName, mValues);
 }
 
 /**
@@ -114,16 +196,9 @@ void Session::setFileName(const QString &fileName)
 {
     // Make sure we have no pending changes to save to our old location
     if (mSyncSettingsTimer.isActive())
-        sync();
-
-    auto newSettings = Utils::jsonSettings(fileName);
+        save();
 
-    // Copy over all settings
-    const auto keys = settings->allKeys();
-    for (const auto &key : keys)
-        newSettings->setValue(key, settings->value(key));
-
-    settings = std::move(newSettings);
+    mFileName = fileName;
 
     FileHelper::setFileName(fileName);
 
@@ -234,7 +309,7 @@ static QString lastPathKey(Session::FileType fileType)
 QString Session::lastPath(FileType fileType, QStandardPaths::StandardLocation fallbackLocation) const
 {
     // First see if we can return the last used location for this file type
-    QString path = settings->value(lastPathKey(fileType)).toString();
+    QString path = mValues.value(lastPathKey(fileType)).toString();
     if (!path.isEmpty())
         return path;
 
@@ -268,7 +343,8 @@ void Session::setLastPath(FileType fileType, const QString &path)
     if (path.isEmpty())
         return;
 
-    settings->setValue(lastPathKey(fileType), path);
+    mValues.insert(lastPathKey(fileType), path);
+    scheduleSync();
 }
 
 QString Session::defaultFileName()
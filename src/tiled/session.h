@@ -139,7 +139,8 @@ inline QVariant toSettingsValue<QSet<int>>(const QSet<int> &set)
 
 class TILED_EDITOR_EXPORT Session : protected FileHelper
 {
-    std::unique_ptr<QSettings> settings;
+    QString mFileName;
+    QVariantMap mValues;
 
 public:
     explicit Session(const QString &fileName);
@@ -181,20 +182,21 @@ public:
     template <typename T>
     T get(const char *key, const T &defaultValue = T()) const
     {
-        return fromSettingsValue<T>(settings->value(QLatin1String(key),
-                                                    toSettingsValue(defaultValue)));
+        return fromSettingsValue<T>(mValues.value(QLatin1String(key),
+                                                  toSettingsValue(defaultValue)));
     }
 
     template <typename T>
-    void set(const char *key, const T &value) const
+    void set(const char *key, const T &value)
     {
         const QLatin1String latin1Key(key);
         const QString stringKey(latin1Key);
         const auto settingsValue = toSettingsValue(value);
-        if (settings->value(stringKey) == settingsValue)
+        if (mValues.value(stringKey) == settingsValue)
             return;
 
-        settings->setValue(stringKey, settingsValue);
+        mValues.insert(stringKey, settingsValue);
+        scheduleSync();
 
         const auto it = Session::mChangedCallbacks.constFind(latin1Key);
         if (it != Session::mChangedCallbacks.constEnd())
@@ -204,7 +206,7 @@ public:
 
     bool isSet(const char *key) const
     {
-        return settings->contains(QLatin1String(key));
+        return mValues.contains(QLatin1String(key));
     }
 
     static QString defaultFileName();
@@ -229,10 +231,16 @@ public:
 private:
     template<typename T> friend class SessionOption;
 
+    struct WriteState;
+
     void scheduleSync() { mSyncSettingsTimer.start(); }
     void sync();
+    void writeAsync();
+    bool writeNow();
 
     QTimer mSyncSettingsTimer;
+    int mSyncGeneration = 0;
+    std::shared_ptr<WriteState> mWriteState;
 
     static std::unique_ptr<Session> mCurrent;
     static QHash<QLatin1String, Callbacks> mChangedCallbacks;
@@ -240,7 +248,7 @@ private:
 
 inline QString Session::fileName() const
 {
-    return settings->fileName();
+    return mFileName;
 }
 
 
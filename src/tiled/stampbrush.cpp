@@ -41,6 +41,7 @@
 #include <QVector>
 
 #include <memory>
+#include <utility>
 
 using namespace Tiled;
 
@@ -93,11 +94,14 @@ void StampBrush::tilePositionChanged(QPoint pos)
         // Draw a line from the previous point to avoid gaps, skipping the
         // first point, since it was painted when the mouse was pressed, or the
         // last time the mouse was moved.
-        QVector<QPoint> points = pointsOnLine(mPrevTilePosition, pos);
+        pointsOnLine(mPrevTilePosition, pos, mLineBuffer);
+        const QVector<QPoint> &points = mLineBuffer;
         QHash<TileLayer*, QRegion> paintedRegions;
 
         for (int i = 1; i < points.size(); ++i) {
-            drawPreviewLayer(QVector<QPoint>() << points.at(i));
+            mPointBuffer.clear();
+            mPointBuffer.append(points.at(i));
+            drawPreviewLayer(mPointBuffer);
 
             // Only update the brush item for the last drawn piece
             if (i == points.size() - 1)
@@ -294,6 +298,10 @@ void StampBrush::setStamp(const TileStamp &stamp)
 
     mStamp = stamp;
 
+    // The maps of the previous stamp are deleted, so a pointer comparison
+    // against them is no longer meaningful
+    mPreviewStamp = nullptr;
+
     invalidateRandomCache();
     updatePreview();
 }
@@ -403,7 +411,8 @@ static void shiftColumns(TileLayer *tileLayer, Map::StaggerIndex staggerIndex)
 
 void StampBrush::drawPreviewLayer(const QVector<QPoint> &points)
 {
-    mPreviewMap.clear();
+    const SharedMap previousPreview = std::move(mPreviewMap);
+    Map * const previousStamp = std::exchange(mPreviewStamp, nullptr);
 
     if (mStamp.isEmpty() && !mIsWangFill)
         return;
@@ -487,6 +496,27 @@ void StampBrush::drawPreviewLayer(const QVector<QPoint> &points)
         Map *variation = randomVariations.pick();
         mapDocument()->unifyTilesets(*variation, mMissingTilesets);
 
+        // Moving a single stamp only changes the position of the preview, so
+        // when the same variation is placed again the existing preview is
+        // translated rather than rebuilt. Staggered maps are excluded since
+        // the stamp contents depend on the position there.
+        if (points.size() == 1 && previousPreview
+                && variation == previousStamp
+                && !mapDocument()->map()->isStaggered()) {
+            const QPoint centered(points.first().x() - variation->width() / 2,
+                                  points.first().y() - variation->height() / 2);
+            const QPoint delta = centered - mPreviewCenter;
+
+            LayerIterator it(previousPreview.data(), Layer::TileLayerType);
+            while (auto tileLayer = static_cast<TileLayer*>(it.next()))
+                tileLayer->setPosition(tileLayer->position() + delta);
+
+            mPreviewMap = previousPreview;
+            mPreviewStamp = variation;
+            mPreviewCenter = centered;
+            return;
+        }
+
         for (const QPoint &p : points) {
             Map *map = variation;
 
@@ -565,6 +595,36 @@ void StampBrush::drawPreviewLayer(const QVector<QPoint> &points)
         mapParameters.infinite = false;
         SharedMap preview = SharedMap::create(mapParameters);
 
+        if (operations.size() == 1) {
+            // Fast path for a single stamp placement, the common case while
+            // moving the mouse: clones of the stamp's layers share their
+            // chunk data, so the preview is set up without copying any cells
+            // no matter how big the stamp is.
+            const PaintOperation &op = operations.first();
+
+            LayerIterator layerIterator(op.stamp, Layer::TileLayerType);
+            while (auto tileLayer = static_cast<TileLayer*>(layerIterator.next())) {
+                auto clone = tileLayer->clone();
+                clone->setPosition(op.pos + tileLayer->position());
+                clone->setVisible(true);
+                preview->addLayer(clone);
+            }
+
+            qDeleteAll(shiftedCopies);
+
+            // Remember what this preview shows, so that the next update can
+            // reuse it. Shifted copies are deleted above, so they are never
+            // remembered.
+            if (op.stamp == variation) {
+                mPreviewStamp = variation;
+                mPreviewCenter = op.pos;
+            }
+
+            preview->addTilesets(preview->usedTilesets());
+            mPreviewMap = preview;
+            return;
+        }
+
         QHash<QString, QList<TileLayer*>> targetLayersByName;
 
         for (const PaintOperation &op : operations) {
@@ -618,10 +678,12 @@ void StampBrush::updatePreview(QPoint tilePos)
     } else {
         switch (mBrushBehavior) {
         case LineStartSet:
-            drawPreviewLayer(pointsOnLine(mStampReference, tilePos));
+            pointsOnLine(mStampReference, tilePos, mLineBuffer);
+            drawPreviewLayer(mLineBuffer);
             break;
         case CircleMidSet:
-            drawPreviewLayer(pointsOnEllipse(mStampReference, tilePos));
+            pointsOnEllipse(mStampReference, tilePos, mLineBuffer);
+            drawPreviewLayer(mLineBuffer);
             break;
         case Capture:
             // already handled above
@@ -634,7 +696,9 @@ void StampBrush::updatePreview(QPoint tilePos)
         case Line:
         case Free:
         case Paint:
-            drawPreviewLayer(QVector<QPoint>() << tilePos);
+            mPointBuffer.clear();
+            mPointBuffer.append(tilePos);
+            drawPreviewLayer(mPointBuffer);
             break;
         }
 
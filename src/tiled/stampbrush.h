@@ -114,11 +114,18 @@ private:
 
     TileStamp mStamp;
     SharedMap mPreviewMap;
+    Map *mPreviewStamp = nullptr;   // only compared, never dereferenced
+    QPoint mPreviewCenter;
     QVector<SharedTileset> mMissingTilesets;
 
     CaptureStampHelper mCaptureStampHelper;
     QPoint mPrevTilePosition;
 
+    // Reusable buffers for the interactive stroke path, so painting while
+    // dragging doesn't allocate a point vector per mouse move
+    QVector<QPoint> mLineBuffer;
+    QVector<QPoint> mPointBuffer;
+
     void drawPreviewLayer(const QVector<QPoint> &points);
 
     /**
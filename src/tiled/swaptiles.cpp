@@ -72,7 +72,7 @@ void SwapTiles::swap()
             tileLayer->setTiles(region1, tile2);
             tileLayer->setTiles(region2, tile1);
 
-            emit mMapDocument->regionChanged(region1 | region2, tileLayer);
+            mMapDocument->emitRegionChanged(region1 | region2, tileLayer);
 
             break;
         }
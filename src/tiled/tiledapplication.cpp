@@ -21,6 +21,7 @@
 #include "tiledapplication.h"
 
 #include "documentmanager.h"
+#include "framewatchdog.h"
 #include "languagemanager.h"
 #include "newsfeed.h"
 #include "newversionchecker.h"
@@ -31,9 +32,11 @@
 #include "templatemanager.h"
 #include "tilesetmanager.h"
 
+#include <QElapsedTimer>
 #include <QFileOpenEvent>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QThread>
 
 using namespace Tiled;
 
@@ -52,7 +55,10 @@ TiledApplication::TiledApplication(int &argc, char **argv)
     setApplicationDisplayName(QLatin1String("Tiled"));
     setApplicationVersion(QLatin1String(AS_STRING(TILED_VERSION)));
 
-    LanguageManager::instance()->installTranslators();
+    // The translation files load on the thread pool while the rest of the
+    // startup proceeds; they are installed before the first user-visible
+    // strings are created.
+    LanguageManager::instance()->preloadTranslators();
 
     connect(this, &QtSingleApplication::messageReceived,
             this, &TiledApplication::onMessageReceived);
@@ -82,6 +88,32 @@ NewsFeed &TiledApplication::newsFeed()
     return *mNewsFeed;
 }
 
+bool TiledApplication::notify(QObject *receiver, QEvent *event)
+{
+    auto &watchdog = FrameWatchdog::instance();
+    if (!watchdog.isActive())
+        return QtSingleApplication::notify(receiver, event);
+
+    // Only top-level dispatches on the main thread are timed, so that time
+    // spent in nested event deliveries is attributed to the outer receiver
+    static int depth = 0;
+    if (QThread::currentThread() != thread() || depth > 0)
+        return QtSingleApplication::notify(receiver, event);
+
+    if (watchdog.shouldDefer(receiver, event))
+        return true;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    ++depth;
+    const bool result = QtSingleApplication::notify(receiver, event);
+    --depth;
+
+    watchdog.recordDispatch(receiver, event, timer.nsecsElapsed());
+    return result;
+}
+
 bool TiledApplication::event(QEvent *event)
 {
     // Handle the QFileOpenEvent to open files on MacOS X.
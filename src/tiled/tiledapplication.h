@@ -43,6 +43,8 @@ public:
     NewVersionChecker &newVersionChecker();
     NewsFeed &newsFeed();
 
+    bool notify(QObject *receiver, QEvent *event) override;
+
 protected:
     bool event(QEvent *) override;
 
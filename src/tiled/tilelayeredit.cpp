@@ -24,9 +24,12 @@
 #include "editablemap.h"
 #include "editabletile.h"
 #include "editabletilelayer.h"
+#include "editabletileset.h"
 #include "painttilelayer.h"
 #include "scriptmanager.h"
 
+#include <QCoreApplication>
+
 namespace Tiled {
 
 TileLayerEdit::TileLayerEdit(EditableTileLayer *tileLayer, QObject *parent)
@@ -58,6 +61,114 @@ void TileLayerEdit::setTile(int x, int y, EditableTile *tile, int flags)
     mChanges.setCell(x, y, cell);
 }
 
+/**
+ * Sets all cells in \a rect from \a tiles, a row-major array with one entry
+ * per cell. Null entries erase their cell.
+ *
+ * Like setTile, the changes are only staged until apply is called, but the
+ * array is decoded in a single native pass rather than one scripting call
+ * per cell.
+ */
+void TileLayerEdit::setTiles(const QRect &rect, const QList<QObject *> &tiles)
+{
+    if (tiles.size() != rect.width() * rect.height()) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
+                                                                         "Array length does not match the size of the area"));
+        return;
+    }
+
+    TileLayer::CellWriter writer(mChanges);
+    auto it = tiles.begin();
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        for (int x = rect.left(); x <= rect.right(); ++x) {
+            auto object = *it++;
+            auto editableTile = qobject_cast<EditableTile*>(object);
+
+            if (object && !editableTile) {
+                ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
+                                                                                 "Not a tile"));
+                return;
+            }
+
+            Cell cell(editableTile ? editableTile->tile() : nullptr);
+            cell.setChecked(true);  // Used to find painted region later (allows erasing)
+
+            writer.setCell(x, y, cell);
+        }
+    }
+}
+
+/**
+ * Applies packed cell values from \a cells, a buffer as seen through a
+ * Uint32Array, to \a rect as a single undo command.
+ *
+ * The lower 28 bits of each value hold a tile ID from \a tileset, while any
+ * flip flags are shifted into the upper four bits (flags * 0x10000000). The
+ * value 0xFFFFFFFF erases the cell.
+ */
+void TileLayerEdit::applyCells(const QRect &rect, const QByteArray &cells,
+                               EditableTileset *tileset)
+{
+    if (!tileset) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
+                                                                         "Invalid tileset"));
+        return;
+    }
+
+    if (cells.size() < rect.width() * rect.height() * 4) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
+                                                                         "Buffer too small for the given area"));
+        return;
+    }
+
+    constexpr quint32 emptyCell = 0xFFFFFFFF;
+    constexpr quint32 tileIdMask = 0x0FFFFFFF;
+
+    auto value = reinterpret_cast<const quint32*>(cells.constData());
+    TileLayer::CellWriter writer(mChanges);
+
+    // Tile lookups are cached, since runs of the same value are common
+    quint32 lastTileId = emptyCell;
+    Tile *lastTile = nullptr;
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        for (int x = rect.left(); x <= rect.right(); ++x) {
+            const quint32 packedCell = *value++;
+
+            Cell cell;
+            if (packedCell != emptyCell) {
+                const quint32 tileId = packedCell & tileIdMask;
+                if (tileId != lastTileId) {
+                    lastTile = tileset->tileset()->findTile(tileId);
+                    if (!lastTile) {
+                        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
+                                                                                         "Invalid tile ID"));
+                        return;
+                    }
+                    lastTileId = tileId;
+                }
+                cell.setTile(lastTile);
+
+                const int flags = packedCell >> 28;
+                if (flags & EditableTile::FlippedHorizontally)
+                    cell.setFlippedHorizontally(true);
+                if (flags & EditableTile::FlippedVertically)
+                    cell.setFlippedVertically(true);
+                if (flags & EditableTile::FlippedAntiDiagonally)
+                    cell.setFlippedAntiDiagonally(true);
+                if (flags & EditableTile::RotatedHexagonal120)
+                    cell.setRotatedHexagonal120(true);
+            }
+            cell.setChecked(true);  // Used to find painted region later (allows erasing)
+
+            writer.setCell(x, y, cell);
+        }
+    }
+
+    apply();
+}
+
 void TileLayerEdit::apply()
 {
     // Applying an edit automatically makes it mergeable, so that further
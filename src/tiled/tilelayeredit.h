@@ -28,6 +28,7 @@
 namespace Tiled {
 
 class EditableTileLayer;
+class EditableTileset;
 
 class TileLayerEdit : public QObject
 {
@@ -54,6 +55,9 @@ public:
 
 public slots:
     void setTile(int x, int y, EditableTile *tile, int flags = 0);
+    void setTiles(const QRect &rect, const QList<QObject *> &tiles);
+    void applyCells(const QRect &rect, const QByteArray &cells,
+                    EditableTileset *tileset);
     void apply();
 
 private:
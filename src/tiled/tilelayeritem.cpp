@@ -23,8 +23,14 @@
 #include "map.h"
 #include "mapdocument.h"
 #include "maprenderer.h"
+#include "preferences.h"
 
+#include <QPainter>
 #include <QStyleOptionGraphicsItem>
+#include <QtMath>
+
+#include <algorithm>
+#include <memory>
 
 using namespace Tiled;
 
@@ -55,6 +61,8 @@ void TileLayerItem::syncWithTileLayer()
     }
 
     mBoundingRect = boundingRect.marginsAdded(margins);
+
+    invalidateRenderCache();
 }
 
 QRectF TileLayerItem::boundingRect() const
@@ -68,5 +76,234 @@ void TileLayerItem::paint(QPainter *painter,
 {
     MapRenderer *renderer = mMapDocument->renderer();
     // TODO: Display a border around the layer when selected
-    renderer->drawTileLayer(painter, tileLayer(), option->exposedRect);
+
+    // The composited result of a layer can be cached in chunk-sized pixmaps
+    // that are blitted on subsequent repaints. This is done for tinted
+    // layers, where tinting multiplies a color into every tile as it is
+    // drawn and makes repaints fill-rate bound, and for layers the user has
+    // frozen (see MapDocument::setLayerFrozen), which are typically static
+    // decoration layers. With software compositing enabled (see
+    // Preferences::softwareCompositing) it is done for every tile layer, so
+    // that repaints reduce to one blit per chunk regardless of how many
+    // cells are visible. The cache is limited to orthogonal maps, where the
+    // screen areas of adjacent chunks don't overlap, and to plain scaling
+    // transforms so that the pixmaps map 1:1 to device pixels.
+    const QTransform &transform = painter->worldTransform();
+    const qreal scale = transform.m11();
+
+    const bool softwareCompositing = Preferences::instance()->softwareCompositing();
+    const bool cacheable = softwareCompositing
+            || tileLayer()->effectiveTintColor().isValid()
+            || mMapDocument->isLayerFrozen(tileLayer());
+
+    const bool useCache = cacheable
+            && mMapDocument->map()->orientation() == Map::Orthogonal
+            && transform.type() <= QTransform::TxScale
+            && transform.m22() == scale
+            && scale > 0;
+
+    if (!useCache) {
+        renderer->drawTileLayer(painter, tileLayer(), option->exposedRect);
+        return;
+    }
+
+    if (scale != mCacheScale) {
+        mChunkPixmaps.clear();
+        mCacheScale = scale;
+    }
+
+    // The pixmaps are rendered at the current scale and blitted 1:1 to
+    // device pixels, so smooth transformation cannot improve the result and
+    // only adds per-pixel filtering cost. The painter state is restored by
+    // the view after each item.
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+
+    // Extend the exposed area by the draw margins, so that chunks whose
+    // tiles extend into the exposed area are blitted as well
+    QMargins margins = tileLayer()->drawMargins();
+    if (const Map *map = tileLayer()->map()) {
+        margins.setTop(qMax(0, margins.top() - map->tileHeight()));
+        margins.setRight(qMax(0, margins.right() - map->tileWidth()));
+    }
+
+    const QRectF exposed = option->exposedRect.marginsAdded(QMarginsF(margins));
+
+    QRect tileRect(renderer->screenToTileCoords(exposed.topLeft()).toPoint(),
+                   renderer->screenToTileCoords(exposed.bottomRight()).toPoint());
+    tileRect &= tileLayer()->bounds();
+
+    if (tileRect.isEmpty())
+        return;
+
+    const int startX = tileRect.left() >> CHUNK_BITS;
+    const int startY = tileRect.top() >> CHUNK_BITS;
+    const int endX = tileRect.right() >> CHUNK_BITS;
+    const int endY = tileRect.bottom() >> CHUNK_BITS;
+
+    for (int cy = startY; cy <= endY; ++cy) {
+        for (int cx = startX; cx <= endX; ++cx) {
+            const QPoint key(cx, cy);
+            const QRect chunkRect(cx * CHUNK_SIZE, cy * CHUNK_SIZE,
+                                  CHUNK_SIZE, CHUNK_SIZE);
+            const QRect screenRect = renderer->boundingRect(chunkRect);
+            const QSizeF deviceSize = QSizeF(screenRect.size()) * scale;
+
+            QPixmap *pixmap = mChunkPixmaps.object(key);
+            if (!pixmap)
+                pixmap = renderChunk(key);
+
+            if (!pixmap) {
+                // Too big for the cache, draw this chunk directly
+                renderer->drawTileLayer(painter, tileLayer(), screenRect & exposed);
+                continue;
+            }
+
+            if (RenderStatistics::enabled)
+                ++RenderStatistics::chunkBlits;
+
+            painter->drawPixmap(QRectF(screenRect), *pixmap,
+                                QRectF(QPointF(), deviceSize));
+        }
+    }
+}
+
+/**
+ * Renders the chunk at the given \a key into the pixmap cache at the current
+ * cache scale and returns the cached pixmap, or nullptr when the pixmap is
+ * too big to cache.
+ */
+QPixmap *TileLayerItem::renderChunk(QPoint key)
+{
+    MapRenderer *renderer = mMapDocument->renderer();
+
+    const QRect chunkRect(key.x() * CHUNK_SIZE, key.y() * CHUNK_SIZE,
+                          CHUNK_SIZE, CHUNK_SIZE);
+    const QRect screenRect = renderer->boundingRect(chunkRect);
+    const QSizeF deviceSize = QSizeF(screenRect.size()) * mCacheScale;
+
+    if (RenderStatistics::enabled)
+        ++RenderStatistics::chunkRenders;
+
+    auto pixmap = std::make_unique<QPixmap>(qCeil(deviceSize.width()),
+                                            qCeil(deviceSize.height()));
+    pixmap->fill(Qt::transparent);
+
+    QPainter chunkPainter(pixmap.get());
+    chunkPainter.scale(mCacheScale, mCacheScale);
+    chunkPainter.translate(-screenRect.topLeft());
+    renderer->drawTileLayer(&chunkPainter, tileLayer(), screenRect);
+    chunkPainter.end();
+
+    const int cost = qMax(1, pixmap->width() * pixmap->height() * 4 / 1024);
+    QPixmap *result = pixmap.get();
+    if (!mChunkPixmaps.insert(key, pixmap.release(), cost))
+        return nullptr;
+
+    return result;
+}
+
+/**
+ * Speculatively renders uncached chunks in a one-chunk ring just outside the
+ * given view rectangle (in scene coordinates), so that continued panning
+ * blits warm pixmaps instead of compositing chunks on demand.
+ *
+ * When \a velocity is non-null, chunks ahead of the scroll direction are
+ * rendered first. Rendering stops once \a timer exceeds \a budgetMs.
+ *
+ * Returns whether uncached chunks remain, in which case another call should
+ * be scheduled.
+ */
+bool TileLayerItem::prefetchRenderCache(const QRectF &viewRect,
+                                        QPointF velocity,
+                                        const QElapsedTimer &timer,
+                                        qint64 budgetMs)
+{
+    // Only prefetch for layers that are currently drawn from the cache; the
+    // conditions mirror those in paint()
+    if (mCacheScale <= 0)
+        return false;
+
+    const bool cacheable = Preferences::instance()->softwareCompositing()
+            || tileLayer()->effectiveTintColor().isValid()
+            || mMapDocument->isLayerFrozen(tileLayer());
+
+    if (!cacheable || mMapDocument->map()->orientation() != Map::Orthogonal)
+        return false;
+
+    const MapRenderer *renderer = mMapDocument->renderer();
+    const QRectF exposed = mapFromScene(viewRect).boundingRect();
+
+    const QRect tileRect(renderer->screenToTileCoords(exposed.topLeft()).toPoint(),
+                         renderer->screenToTileCoords(exposed.bottomRight()).toPoint());
+
+    const QRect visibleChunks(tileRect.left() >> CHUNK_BITS,
+                              tileRect.top() >> CHUNK_BITS,
+                              (tileRect.right() >> CHUNK_BITS) - (tileRect.left() >> CHUNK_BITS) + 1,
+                              (tileRect.bottom() >> CHUNK_BITS) - (tileRect.top() >> CHUNK_BITS) + 1);
+
+    const QRect layerBounds = tileLayer()->bounds();
+    const QRect layerChunks(layerBounds.left() >> CHUNK_BITS,
+                            layerBounds.top() >> CHUNK_BITS,
+                            (layerBounds.right() >> CHUNK_BITS) - (layerBounds.left() >> CHUNK_BITS) + 1,
+                            (layerBounds.bottom() >> CHUNK_BITS) - (layerBounds.top() >> CHUNK_BITS) + 1);
+
+    const QRect ring = visibleChunks.adjusted(-1, -1, 1, 1) & layerChunks;
+
+    QVector<QPoint> missing;
+    for (int cy = ring.top(); cy <= ring.bottom(); ++cy)
+        for (int cx = ring.left(); cx <= ring.right(); ++cx)
+            if (!visibleChunks.contains(cx, cy) && !mChunkPixmaps.contains(QPoint(cx, cy)))
+                missing.append(QPoint(cx, cy));
+
+    if (missing.isEmpty())
+        return false;
+
+    // Render the chunks the view is heading towards first. For orthogonal
+    // maps the scroll direction in scene coordinates matches the direction
+    // in chunk coordinates.
+    if (!velocity.isNull()) {
+        const qreal length = qSqrt(QPointF::dotProduct(velocity, velocity));
+        const QPointF direction = velocity / length;
+        const QPointF center = QRectF(visibleChunks).center();
+
+        const auto advance = [&] (QPoint key) {
+            return QPointF::dotProduct(QPointF(key) - center, direction);
+        };
+        std::stable_sort(missing.begin(), missing.end(),
+                         [&] (QPoint a, QPoint b) { return advance(a) > advance(b); });
+    }
+
+    for (const QPoint &key : std::as_const(missing)) {
+        if (timer.hasExpired(budgetMs))
+            return true;
+        renderChunk(key);
+    }
+
+    return false;
+}
+
+/**
+ * Drops all cached chunk pixmaps of this layer.
+ */
+void TileLayerItem::invalidateRenderCache()
+{
+    mChunkPixmaps.clear();
+}
+
+/**
+ * Drops the cached pixmaps of the chunks intersecting the given region, in
+ * tile coordinates.
+ */
+void TileLayerItem::invalidateRenderCache(const QRegion &tileRegion)
+{
+    for (const QRect &r : tileRegion) {
+        const int startX = r.left() >> CHUNK_BITS;
+        const int startY = r.top() >> CHUNK_BITS;
+        const int endX = r.right() >> CHUNK_BITS;
+        const int endY = r.bottom() >> CHUNK_BITS;
+
+        for (int cy = startY; cy <= endY; ++cy)
+            for (int cx = startX; cx <= endX; ++cx)
+                mChunkPixmaps.remove(QPoint(cx, cy));
+    }
 }
@@ -24,6 +24,10 @@
 
 #include "tilelayer.h"
 
+#include <QCache>
+#include <QElapsedTimer>
+#include <QPixmap>
+
 namespace Tiled {
 
 class MapDocument;
@@ -60,9 +64,25 @@ public:
                const QStyleOptionGraphicsItem *option,
                QWidget *widget = nullptr) override;
 
+    void invalidateRenderCache();
+    void invalidateRenderCache(const QRegion &tileRegion);
+
+    bool prefetchRenderCache(const QRectF &viewRect,
+                             QPointF velocity,
+                             const QElapsedTimer &timer,
+                             qint64 budgetMs);
+
 private:
+    QPixmap *renderChunk(QPoint key);
+
     MapDocument *mMapDocument;
     QRectF mBoundingRect;
+
+    // Composited chunk pixmaps, used for tinted and frozen layers on
+    // orthogonal maps, and for all tile layers when software compositing
+    // is enabled
+    QCache<QPoint, QPixmap> mChunkPixmaps { 32 * 1024 };    // cost in KB
+    qreal mCacheScale = 0.0;
 };
 
 inline TileLayer *TileLayerItem::tileLayer() const
@@ -26,6 +26,8 @@
 
 #include <QQueue>
 
+#include <climits>
+
 using namespace Tiled;
 
 namespace {
@@ -95,7 +97,7 @@ void TilePainter::setCell(int x, int y, const Cell &cell)
 
     TileLayerChangeWatcher watcher(mMapDocument, mTileLayer);
     mTileLayer->setCell(layerX, layerY, cell);
-    emit mMapDocument->regionChanged(QRegion(x, y, 1, 1), mTileLayer);
+    mMapDocument->emitRegionChanged(QRegion(x, y, 1, 1), mTileLayer);
 }
 
 void TilePainter::setCells(int x, int y,
@@ -112,7 +114,7 @@ void TilePainter::setCells(int x, int y,
                          tileLayer,
                          region.translated(-mTileLayer->position()));
 
-    emit mMapDocument->regionChanged(region, mTileLayer);
+    mMapDocument->emitRegionChanged(region, mTileLayer);
 }
 
 void TilePainter::drawCells(int x, int y, TileLayer *tileLayer)
@@ -122,6 +124,7 @@ void TilePainter::drawCells(int x, int y, TileLayer *tileLayer)
         return;
 
     TileLayerChangeWatcher watcher(mMapDocument, mTileLayer);
+    TileLayer::CellWriter writer(*mTileLayer);
 
     for (const QRect &rect : region) {
         for (int _y = rect.top(); _y <= rect.bottom(); ++_y) {
@@ -130,14 +133,14 @@ void TilePainter::drawCells(int x, int y, TileLayer *tileLayer)
                 if (cell.isEmpty())
                     continue;
 
-                mTileLayer->setCell(_x - mTileLayer->x(),
-                                    _y - mTileLayer->y(),
-                                    cell);
+                writer.setCell(_x - mTileLayer->x(),
+                               _y - mTileLayer->y(),
+                               cell);
             }
         }
     }
 
-    emit mMapDocument->regionChanged(region, mTileLayer);
+    mMapDocument->emitRegionChanged(region, mTileLayer);
 }
 
 void TilePainter::drawStamp(const TileLayer *stamp,
@@ -152,6 +155,7 @@ void TilePainter::drawStamp(const TileLayer *stamp,
         return;
 
     TileLayerChangeWatcher watcher(mMapDocument, mTileLayer);
+    TileLayer::CellWriter writer(*mTileLayer);
 
     const int w = stamp->width();
     const int h = stamp->height();
@@ -166,14 +170,14 @@ void TilePainter::drawStamp(const TileLayer *stamp,
                 if (cell.isEmpty())
                     continue;
 
-                mTileLayer->setCell(_x - mTileLayer->x(),
-                                    _y - mTileLayer->y(),
-                                    cell);
+                writer.setCell(_x - mTileLayer->x(),
+                               _y - mTileLayer->y(),
+                               cell);
             }
         }
     }
 
-    emit mMapDocument->regionChanged(region, mTileLayer);
+    mMapDocument->emitRegionChanged(region, mTileLayer);
 }
 
 void TilePainter::erase(const QRegion &region)
@@ -183,11 +187,45 @@ void TilePainter::erase(const QRegion &region)
         return;
 
     mTileLayer->erase(paintable.translated(-mTileLayer->position()));
-    emit mMapDocument->regionChanged(paintable, mTileLayer);
+    mMapDocument->emitRegionChanged(paintable, mTileLayer);
 }
 
+/**
+ * Resolves cells through the chunk of the current position, so that span
+ * scans over a scanline do one chunk lookup per crossed chunk instead of a
+ * hash lookup per cell.
+ */
+class ChunkCellReader
+{
+public:
+    explicit ChunkCellReader(const TileLayer *layer)
+        : mLayer(layer)
+    {}
+
+    const Cell &cellAt(int x, int y)
+    {
+        const int chunkX = x >> CHUNK_BITS;
+        const int chunkY = y >> CHUNK_BITS;
+
+        if (chunkX != mChunkX || chunkY != mChunkY) {
+            mChunkX = chunkX;
+            mChunkY = chunkY;
+            mChunk = mLayer->findChunk(x, y);
+        }
+
+        return mChunk ? mChunk->cellAt(x & CHUNK_MASK, y & CHUNK_MASK)
+                      : Cell::empty;
+    }
+
+private:
+    const TileLayer *mLayer;
+    const Chunk *mChunk = nullptr;
+    int mChunkX = INT_MIN;
+    int mChunkY = INT_MIN;
+};
+
 static QRegion fillRegion(const TileLayer *layer,
-                          const QRegion &region,
+                          QRegion region,
                           QPoint fillOrigin,
                           Map::Orientation orientation,
                           Map::StaggerAxis staggerAxis,
@@ -200,6 +238,23 @@ static QRegion fillRegion(const TileLayer *layer,
     // Cache cell that we will match other cells against
     const Cell matchCell = layer->cellAt(fillOrigin);
 
+    // When filling on a tile, the fill can never leave the chunks that
+    // contain that tile, so the search (and the processed-cells array
+    // spanning its bounds) is confined to them
+    if (!matchCell.isEmpty()) {
+        QRegion tileChunks;
+        const auto chunkKeys = layer->occurrenceChunks(matchCell);
+        for (const QPoint &key : chunkKeys)
+            tileChunks += QRect(key.x() * CHUNK_SIZE, key.y() * CHUNK_SIZE,
+                                CHUNK_SIZE, CHUNK_SIZE);
+        region &= tileChunks;
+
+        if (!region.contains(fillOrigin))
+            return QRegion();
+    }
+
+    ChunkCellReader cells(layer);
+
     const QRect bounds = region.boundingRect();
     const int width = bounds.width();
     const int height = bounds.height();
@@ -225,14 +280,14 @@ static QRegion fillRegion(const TileLayer *layer,
 
         // Seek as far left as we can
         int left = currentPoint.x();
-        while (left > bounds.left() && layer->cellAt(left - 1, currentPoint.y()) == matchCell) {
+        while (left > bounds.left() && cells.cellAt(left - 1, currentPoint.y()) == matchCell) {
             --left;
             processedCells[indexOffset + startOfLine + left] = true;
         }
 
         // Seek as far right as we can
         int right = currentPoint.x();
-        while (right < bounds.right() && layer->cellAt(right + 1, currentPoint.y()) == matchCell) {
+        while (right < bounds.right() && cells.cellAt(right + 1, currentPoint.y()) == matchCell) {
             ++right;
             processedCells[indexOffset + startOfLine + right] = true;
         }
@@ -259,13 +314,13 @@ static QRegion fillRegion(const TileLayer *layer,
 
         // Loop between left and right and check if cells above or below need
         // to be added to the queue.
-        auto findFillPositions = [=,&fillPositions](int left, int right, int y) {
+        auto findFillPositions = [=,&fillPositions,&cells](int left, int right, int y) {
             bool adjacentCellAdded = false;
 
             for (int x = left; x <= right; ++x) {
                 const int index = y * width + x;
 
-                if (!processedCells[indexOffset + index] && layer->cellAt(x, y) == matchCell) {
+                if (!processedCells[indexOffset + index] && cells.cellAt(x, y) == matchCell) {
                     // Do not add the cell to the queue if an adjacent cell was added.
                     if (!adjacentCellAdded) {
                         fillPositions.enqueue(QPoint(x, y));
@@ -28,6 +28,7 @@
 #include "mapdocument.h"
 #include "tile.h"
 #include "tilesetformat.h"
+#include "tilesetreloader.h"
 #include "tilesetwangsetmodel.h"
 #include "wangcolormodel.h"
 #include "wangset.h"
@@ -85,6 +86,8 @@ TilesetDocument::TilesetDocument(const SharedTileset &tileset)
             this, &TilesetDocument::onPropertyChanged);
     connect(this, &TilesetDocument::propertiesChanged,
             this, &TilesetDocument::onPropertiesChanged);
+    connect(this, &TilesetDocument::changed,
+            this, &TilesetDocument::onChanged);
 
     connect(mWangSetModel, &TilesetWangSetModel::wangSetRemoved,
             this, &TilesetDocument::onWangSetRemoved);
@@ -161,7 +164,16 @@ bool TilesetDocument::reload(QString *error)
     tileset->setFileName(fileName());
     tileset->setFormat(format->shortName());
 
-    undoStack()->push(new ReloadTileset(this, tileset));
+    // When the reloaded tileset is structurally close to the current one,
+    // patch the changed tiles in place. This keeps the Tile instances
+    // stable, so open maps don't need to re-resolve their cells and views
+    // update only for the tiles that actually changed.
+    TilesetReloader reloader(this);
+    if (reloader.apply(*tileset))
+        undoStack()->clear();
+    else
+        undoStack()->push(new ReloadTileset(this, tileset));
+
     undoStack()->setClean();
     mLastSaved = QFileInfo(fileName()).lastModified();
 
@@ -411,6 +423,17 @@ void TilesetDocument::setTileImage(Tile *tile,
         emit mapDocument->tileImageSourceChanged(tile);
 }
 
+void TilesetDocument::setTileImageRect(Tile *tile, const QRect &imageRect)
+{
+    Q_ASSERT(tile->tileset() == mTileset.data());
+
+    mTileset->setTileImageRect(tile, imageRect);
+    emit tileImageSourceChanged(tile);
+
+    for (MapDocument *mapDocument : mapDocuments())
+        emit mapDocument->tileImageSourceChanged(tile);
+}
+
 void TilesetDocument::setTileProbability(Tile *tile, qreal probability)
 {
     Q_ASSERT(tile->tileset() == mTileset.data());
@@ -489,6 +512,20 @@ void TilesetDocument::onPropertiesChanged(Object *object)
         emit mapDocument->propertiesChanged(object);
 }
 
+void TilesetDocument::onChanged(const ChangeEvent &event)
+{
+    // The aggregated event emitted at the end of a bulk edit is forwarded to
+    // the maps using this tileset, like the per-object notifications are.
+    // Other object change events are not, since their handlers expect the
+    // objects to belong to the receiving document.
+    if (event.type == ChangeEvent::ObjectsChanged) {
+        auto &objectsChange = static_cast<const ObjectsChangeEvent&>(event);
+        if (objectsChange.properties & ObjectsChangeEvent::CustomProperties)
+            for (MapDocument *mapDocument : mapDocuments())
+                emit mapDocument->changed(event);
+    }
+}
+
 void TilesetDocument::onWangSetRemoved(WangSet *wangSet)
 {
     mWangColorModels.erase(wangSet);
@@ -112,6 +112,7 @@ public:
     WangColorModel *wangColorModel(WangSet *wangSet);
 
     void setTileImage(Tile *tile, const QPixmap &image, const QUrl &source);
+    void setTileImageRect(Tile *tile, const QRect &imageRect);
     void setTileProbability(Tile *tile, qreal probability);
     void swapTileObjectGroup(Tile *tile, std::unique_ptr<ObjectGroup> &objectGroup);
 
@@ -172,6 +173,7 @@ private:
     void onPropertyRemoved(Object *object, const QString &name);
     void onPropertyChanged(Object *object, const QString &name);
     void onPropertiesChanged(Object *object);
+    void onChanged(const ChangeEvent &event);
 
     void onWangSetRemoved(WangSet *wangSet);
 
@@ -174,7 +174,7 @@ bool TilesetModel::dropMimeData(const QMimeData *data, Qt::DropAction action,
 
     if (!sourceTiles.isEmpty()) {
         Tile *destinationTile = tileAt(parent);
-        int destinationIndex = destinationTile ? mTileIds.indexOf(destinationTile->id())
+        int destinationIndex = destinationTile ? mTileIdToIndex.value(destinationTile->id(), -1)
                                                : mTileIds.size() - 1;
 
         mTilesetDocument->undoStack()->push(new RelocateTiles(mTilesetDocument,
@@ -210,7 +210,7 @@ QModelIndex TilesetModel::tileIndex(const Tile *tile) const
     if (columnCount <= 0)
         return QModelIndex();
 
-    const int tileIndex = mTileIds.indexOf(tile->id());
+    const int tileIndex = mTileIdToIndex.value(tile->id(), -1);
     // todo: this assertion was hit when testing tileset image size changes
     Q_ASSERT(tileIndex != -1);
 
@@ -281,8 +281,11 @@ void TilesetModel::tileChanged(Tile *tile)
 void TilesetModel::refreshTileIds()
 {
     mTileIds.clear();
-    for (Tile *tile : tileset()->tiles())
+    mTileIdToIndex.clear();
+    for (Tile *tile : tileset()->tiles()) {
+        mTileIdToIndex.insert(tile->id(), mTileIds.size());
         mTileIds.append(tile->id());
+    }
 }
 
 #include "moc_tilesetmodel.cpp"
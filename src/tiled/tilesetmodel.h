@@ -24,6 +24,7 @@
 #include "tile.h"
 
 #include <QAbstractListModel>
+#include <QHash>
 
 namespace Tiled {
 
@@ -130,6 +131,7 @@ private:
 
     TilesetDocument *mTilesetDocument;
     QList<int> mTileIds;
+    QHash<int, int> mTileIdToIndex;    // reverse of mTileIds
     int mColumnCountOverride = 0;
 };
 
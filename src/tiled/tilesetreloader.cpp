@@ -0,0 +1,257 @@
+/*
+ * tilesetreloader.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tilesetreloader.h"
+
+#include "changeevents.h"
+#include "mapobject.h"
+#include "objectgroup.h"
+#include "tile.h"
+#include "tileset.h"
+#include "tilesetchanges.h"
+#include "tilesetdocument.h"
+#include "tilesetmanager.h"
+#include "wangset.h"
+
+using namespace Tiled;
+
+/**
+ * Whether the collision shapes of two tiles are the same. A missing object
+ * group is treated as an empty one.
+ */
+static bool sameObjects(const ObjectGroup *a, const ObjectGroup *b)
+{
+    const int countA = a ? a->objectCount() : 0;
+    const int countB = b ? b->objectCount() : 0;
+    if (countA != countB)
+        return false;
+
+    for (int i = 0; i < countA; ++i) {
+        const MapObject *objectA = a->objectAt(i);
+        const MapObject *objectB = b->objectAt(i);
+
+        if (objectA->name() != objectB->name()
+                || objectA->className() != objectB->className()
+                || objectA->position() != objectB->position()
+                || objectA->size() != objectB->size()
+                || objectA->rotation() != objectB->rotation()
+                || objectA->shape() != objectB->shape()
+                || objectA->polygon() != objectB->polygon()
+                || objectA->isVisible() != objectB->isVisible()
+                || objectA->properties() != objectB->properties())
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Whether two tiles carry the same metadata, apart from their image and
+ * probability, which are patched in place.
+ */
+static bool sameTileMetadata(const Tile &a, const Tile &b)
+{
+    return a.className() == b.className()
+            && a.properties() == b.properties()
+            && a.frames() == b.frames()
+            && sameObjects(a.objectGroup(), b.objectGroup());
+}
+
+/**
+ * Whether the given tile carries no metadata, so that it can appear on only
+ * one side of the diff without losing anything.
+ */
+static bool defaultTileMetadata(const Tile &tile)
+{
+    return tile.className().isEmpty()
+            && tile.properties().isEmpty()
+            && tile.frames().isEmpty()
+            && !tile.objectGroup()
+            && tile.probability() == 1.0;
+}
+
+static bool sameWangSets(const Tileset &target, const Tileset &source)
+{
+    if (target.wangSetCount() != source.wangSetCount())
+        return false;
+
+    for (int i = 0; i < target.wangSetCount(); ++i) {
+        const WangSet *a = target.wangSets().at(i);
+        const WangSet *b = source.wangSets().at(i);
+
+        if (a->name() != b->name()
+                || a->type() != b->type()
+                || a->imageTileId() != b->imageTileId()
+                || a->colorCount() != b->colorCount()
+                || a->className() != b->className()
+                || a->properties() != b->properties())
+            return false;
+
+        for (int c = 1; c <= a->colorCount(); ++c) {
+            const auto &colorA = a->colorAt(c);
+            const auto &colorB = b->colorAt(c);
+            if (colorA->name() != colorB->name()
+                    || colorA->color() != colorB->color()
+                    || colorA->imageId() != colorB->imageId()
+                    || colorA->probability() != colorB->probability()
+                    || colorA->properties() != colorB->properties())
+                return false;
+        }
+
+        for (const Tile *tile : target.tiles()) {
+            const Tile *other = source.findTile(tile->id());
+            if (a->wangIdOfTile(tile) != (other ? b->wangIdOfTile(other)
+                                                : WangId()))
+                return false;
+        }
+        for (const Tile *tile : source.tiles())
+            if (!target.findTile(tile->id()) && b->wangIdOfTile(tile) != WangId())
+                return false;
+    }
+
+    return true;
+}
+
+TilesetReloader::TilesetReloader(TilesetDocument *tilesetDocument)
+    : mTilesetDocument(tilesetDocument)
+{
+}
+
+/**
+ * Applies the given freshly loaded \a tileset to the document.
+ *
+ * Returns false without modifying anything when the tileset is structurally
+ * too different to be expressed as changes to the current tileset, in which
+ * case the caller should fall back to swapping it in.
+ */
+bool TilesetReloader::apply(const Tileset &tileset)
+{
+    Tileset *target = mTilesetDocument->tileset().data();
+
+    if (target->isCollection() != tileset.isCollection())
+        return false;
+
+    if (target->orientation() != tileset.orientation()
+            || target->gridSize() != tileset.gridSize()
+            || target->tileRenderSize() != tileset.tileRenderSize()
+            || target->fillMode() != tileset.fillMode()
+            || target->backgroundColor() != tileset.backgroundColor())
+        return false;
+
+    if (tileset.isCollection()) {
+        // Adding or removing collection tiles is a structural change, as is
+        // changing the column count of the tileset view.
+        if (target->columnCount() != tileset.columnCount())
+            return false;
+        if (target->tileCount() != tileset.tileCount())
+            return false;
+        for (const Tile *tile : target->tiles())
+            if (!tileset.findTile(tile->id()))
+                return false;
+    }
+
+    // Tile metadata is not patched, so it needs to match. Tiles that exist
+    // on only one side (an atlas that grew or shrank) may not carry any.
+    for (const Tile *targetTile : target->tiles()) {
+        if (const Tile *sourceTile = tileset.findTile(targetTile->id())) {
+            if (!sameTileMetadata(*targetTile, *sourceTile))
+                return false;
+        } else if (!defaultTileMetadata(*targetTile)) {
+            return false;
+        }
+    }
+    for (const Tile *sourceTile : tileset.tiles())
+        if (!target->findTile(sourceTile->id()) && !defaultTileMetadata(*sourceTile))
+            return false;
+
+    if (!sameWangSets(*target, tileset))
+        return false;
+
+    // The remaining differences can all be expressed as plain changes
+    if (target->name() != tileset.name())
+        mTilesetDocument->setTilesetName(tileset.name());
+    if (target->tileOffset() != tileset.tileOffset())
+        mTilesetDocument->setTilesetTileOffset(tileset.tileOffset());
+    if (target->objectAlignment() != tileset.objectAlignment())
+        mTilesetDocument->setTilesetObjectAlignment(tileset.objectAlignment());
+    if (target->transformationFlags() != tileset.transformationFlags())
+        mTilesetDocument->setTilesetTransformationFlags(tileset.transformationFlags());
+
+    if (target->properties() != tileset.properties())
+        mTilesetDocument->setProperties(target, tileset.properties());
+
+    if (target->className() != tileset.className()) {
+        target->setClassName(tileset.className());
+        emit mTilesetDocument->changed(ObjectsChangeEvent({ target },
+                                                          ObjectsChangeEvent::ClassProperty));
+    }
+
+    if (tileset.isCollection()) {
+        syncTileImages(tileset);
+    } else {
+        // Image, transparent color and tile geometry changes reload the
+        // atlas, re-cutting the existing Tile instances in place.
+        const TilesetParameters parameters(tileset);
+        if (TilesetParameters(*target) != parameters) {
+            target->setImageSource(parameters.imageSource);
+            target->setTransparentColor(parameters.transparentColor);
+            target->setTileSize(parameters.tileSize);
+            target->setTileSpacing(parameters.tileSpacing);
+            target->setMargin(parameters.margin);
+
+            if (target->loadImage())
+                emit TilesetManager::instance()->tilesetImagesChanged(target);
+
+            emit mTilesetDocument->tilesetChanged(target);
+        }
+    }
+
+    for (Tile *targetTile : target->tiles()) {
+        const Tile *sourceTile = tileset.findTile(targetTile->id());
+        if (sourceTile && targetTile->probability() != sourceTile->probability())
+            mTilesetDocument->setTileProbability(targetTile, sourceTile->probability());
+    }
+
+    return true;
+}
+
+/**
+ * Patches the images of the matching tiles of a collection tileset,
+ * notifying only for the tiles that actually changed.
+ */
+void TilesetReloader::syncTileImages(const Tileset &tileset)
+{
+    Tileset *target = mTilesetDocument->tileset().data();
+
+    for (Tile *targetTile : target->tiles()) {
+        const Tile *sourceTile = tileset.findTile(targetTile->id());
+        if (!sourceTile)
+            continue;
+
+        if (targetTile->imageSource() != sourceTile->imageSource())
+            mTilesetDocument->setTileImage(targetTile,
+                                           sourceTile->image(),
+                                           sourceTile->imageSource());
+
+        if (targetTile->imageRect() != sourceTile->imageRect())
+            mTilesetDocument->setTileImageRect(targetTile,
+                                               sourceTile->imageRect());
+    }
+}
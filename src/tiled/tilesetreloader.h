@@ -0,0 +1,53 @@
+/*
+ * tilesetreloader.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+namespace Tiled {
+
+class Tileset;
+class TilesetDocument;
+
+/**
+ * Applies a freshly loaded tileset to an existing document as a minimal set
+ * of changes, so that the Tile instances stay stable and open maps don't
+ * need to re-resolve their cells when a tileset is reloaded after an
+ * external edit.
+ *
+ * Tiles are matched by id and patched in place when only their images,
+ * rects or probabilities changed. When the new tileset is structurally too
+ * different (changed grid settings, added or removed collection tiles, or
+ * changed per-tile metadata or Wang sets), apply() refuses and the caller
+ * falls back to swapping in the new tileset.
+ */
+class TilesetReloader
+{
+public:
+    explicit TilesetReloader(TilesetDocument *tilesetDocument);
+
+    bool apply(const Tileset &tileset);
+
+private:
+    void syncTileImages(const Tileset &tileset);
+
+    TilesetDocument *mTilesetDocument;
+};
+
+} // namespace Tiled
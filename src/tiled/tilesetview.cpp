@@ -908,6 +908,7 @@ void TilesetView::refreshColumnCount()
 
     if (!dynamicWrapping()) {
         tilesetModel()->setColumnCountOverride(0);
+        updateSectionSizes();
         return;
     }
 
@@ -917,6 +918,37 @@ void TilesetView::refreshColumnCount()
     const int scaledTileSize = std::max<int>(tileWidth * scale(), 1) + gridSpace;
     const int columnCount = std::max(maxSize.width() / scaledTileSize, 1);
     tilesetModel()->setColumnCountOverride(columnCount);
+    updateSectionSizes();
+}
+
+/**
+ * For tileset-image based tilesets all cells have the same size, so the
+ * headers can use fixed section sizes. This avoids per-section size queries,
+ * which take a noticeable amount of time to lay out tilesets with hundreds
+ * of thousands of tiles. Image collections keep resize-to-contents, since
+ * their tiles can all have different sizes.
+ */
+void TilesetView::updateSectionSizes()
+{
+    const TilesetModel *model = tilesetModel();
+    QHeaderView *hHeader = horizontalHeader();
+    QHeaderView *vHeader = verticalHeader();
+
+    const bool uniform = model && !model->tileset()->isCollection();
+
+    if (uniform) {
+        hHeader->setDefaultSectionSize(sizeHintForColumn(0));
+        vHeader->setDefaultSectionSize(sizeHintForRow(0));
+    }
+
+    if (mUniformSectionSizes != uniform) {
+        mUniformSectionSizes = uniform;
+
+        const auto resizeMode = uniform ? QHeaderView::Fixed
+                                        : QHeaderView::ResizeToContents;
+        hHeader->setSectionResizeMode(resizeMode);
+        vHeader->setSectionResizeMode(resizeMode);
+    }
 }
 
 void TilesetView::applyWangId()
@@ -129,6 +129,7 @@ private:
 
     void adjustScale();
     void refreshColumnCount();
+    void updateSectionSizes();
 
     void applyWangId();
     void finishWangIdChange();
@@ -149,6 +150,7 @@ private:
     Zoomable *mZoomable;
     TilesetDocument *mTilesetDocument = nullptr;
     bool mDrawGrid;
+    bool mUniformSectionSizes = false;
     bool mMarkAnimatedTiles = true;
     bool mRelocateTiles = false;
     bool mEditWangSet = false;
@@ -20,12 +20,15 @@
 
 #include "tilestamp.h"
 
+#include "compression.h"
 #include "maptovariantconverter.h"
 #include "tilelayer.h"
 #include "varianttomapconverter.h"
 
 #include <QDebug>
+#include <QFile>
 #include <QJsonArray>
+#include <QJsonDocument>
 
 namespace Tiled {
 
@@ -40,6 +43,12 @@ public:
     QString name;
     QString fileName;
     QVector<TileStampVariation> variations;
+
+    // Set for stamps created by TileStamp::deferred, whose variations are
+    // loaded from this file the first time they are needed
+    QString loadFilePath;
+    QDir loadDir;
+    int deferredVariationCount = 0;
 };
 
 TileStampData::TileStampData()
@@ -52,6 +61,9 @@ TileStampData::TileStampData(const TileStampData &other)
     , name(other.name)
     , fileName()                        // not copied
     , variations(other.variations)
+    , loadFilePath(other.loadFilePath)
+    , loadDir(other.loadDir)
+    , deferredVariationCount(other.deferredVariationCount)
 {
     // deep-copy the map data
     for (TileStampVariation &variation : variations)
@@ -122,16 +134,19 @@ void TileStamp::setFileName(const QString &fileName)
 
 qreal TileStamp::probability(int index) const
 {
+    ensureLoaded();
     return d->variations.at(index).probability;
 }
 
 void TileStamp::setProbability(int index, qreal probability)
 {
+    ensureLoaded();
     d->variations[index].probability = probability;
 }
 
 QSize TileStamp::maxSize() const
 {
+    ensureLoaded();
     QSize size;
     for (const TileStampVariation &variation : std::as_const(d->variations))
         size = size.expandedTo(variation.map->size());
@@ -140,15 +155,35 @@ QSize TileStamp::maxSize() const
 
 const QVector<TileStampVariation> &TileStamp::variations() const
 {
+    ensureLoaded();
     return d->variations;
 }
 
+/**
+ * Returns the number of variations without loading a deferred stamp, so that
+ * the stamp library can show its structure before the bodies are read.
+ */
+int TileStamp::variationCount() const
+{
+    if (!isLoaded())
+        return d->deferredVariationCount;
+    return d->variations.size();
+}
+
 /**
  * Adds a variation \a map to this tile stamp with a given \a probability.
  */
 void TileStamp::addVariation(std::unique_ptr<Map> map, qreal probability)
 {
     Q_ASSERT(map);
+
+    // Stamps are stored as JSON, where the tile data would otherwise be
+    // written out as a plain array of numbers. Compressed base64 keeps
+    // stamps with big variations small and fast to save and load.
+    map->setLayerDataFormat(compressionSupported(Zstandard)
+                            ? Map::Base64Zstandard
+                            : Map::Base64Zlib);
+
     d->variations.append(TileStampVariation(map.release(), probability));
 }
 
@@ -158,15 +193,26 @@ void TileStamp::addVariation(std::unique_ptr<Map> map, qreal probability)
  */
 Map *TileStamp::takeVariation(int index)
 {
+    ensureLoaded();
     return d->variations.takeAt(index).map;
 }
 
 /**
- * A stamp is considered empty when it has no variations.
+ * A stamp is considered empty when it has no variations, neither in memory
+ * nor waiting to be loaded from its file.
  */
 bool TileStamp::isEmpty() const
 {
-    return d->variations.isEmpty();
+    return d->variations.isEmpty() && d->loadFilePath.isEmpty();
+}
+
+/**
+ * Returns whether the variations of this stamp are in memory. Only false for
+ * stamps created by deferred() that haven't been used yet.
+ */
+bool TileStamp::isLoaded() const
+{
+    return d->loadFilePath.isEmpty();
 }
 
 int TileStamp::quickStampIndex() const
@@ -181,6 +227,7 @@ void TileStamp::setQuickStampIndex(int quickStampIndex)
 
 RandomPicker<Map *> TileStamp::randomVariations() const
 {
+    ensureLoaded();
     Q_ASSERT(!d->variations.isEmpty());
 
     RandomPicker<Map *> randomPicker;
@@ -284,6 +331,8 @@ TileStamp TileStamp::clone() const
 
 QJsonObject TileStamp::toJson(const QDir &dir) const
 {
+    ensureLoaded();
+
     QJsonObject json;
     json.insert(QLatin1String("name"), d->name);
 
@@ -306,13 +355,10 @@ QJsonObject TileStamp::toJson(const QDir &dir) const
     return json;
 }
 
-TileStamp TileStamp::fromJson(const QJsonObject &json, const QDir &mapDir)
+static void addVariationsFromJson(TileStamp &stamp,
+                                  const QJsonObject &json,
+                                  const QDir &mapDir)
 {
-    TileStamp stamp;
-
-    stamp.setName(json.value(QLatin1String("name")).toString());
-    stamp.setQuickStampIndex(static_cast<int>(json.value(QLatin1String("quickStampIndex")).toDouble(-1)));
-
     const QJsonArray variations = json.value(QLatin1String("variations")).toArray();
     for (const QJsonValue &value : variations) {
         QJsonObject variationJson = value.toObject();
@@ -329,8 +375,70 @@ TileStamp TileStamp::fromJson(const QJsonObject &json, const QDir &mapDir)
 
         stamp.addVariation(std::move(map), probability);
     }
+}
+
+TileStamp TileStamp::fromJson(const QJsonObject &json, const QDir &mapDir)
+{
+    TileStamp stamp;
+
+    stamp.setName(json.value(QLatin1String("name")).toString());
+    stamp.setQuickStampIndex(static_cast<int>(json.value(QLatin1String("quickStampIndex")).toDouble(-1)));
+
+    addVariationsFromJson(stamp, json, mapDir);
 
     return stamp;
 }
 
+/**
+ * Creates a stamp whose variations are loaded from \a fileName in \a mapDir
+ * the first time they are needed, based on metadata from the stamp index.
+ * This allows the stamp library to load without parsing every stamp file.
+ */
+TileStamp TileStamp::deferred(const QString &name,
+                              int quickStampIndex,
+                              int variationCount,
+                              const QString &fileName,
+                              const QDir &mapDir)
+{
+    TileStamp stamp;
+
+    stamp.setName(name);
+    stamp.setQuickStampIndex(quickStampIndex);
+    stamp.setFileName(fileName);
+
+    stamp.d->loadFilePath = mapDir.filePath(fileName);
+    stamp.d->loadDir = mapDir;
+    stamp.d->deferredVariationCount = variationCount;
+
+    return stamp;
+}
+
+/**
+ * Loads the variations of a stamp created by deferred().
+ */
+void TileStamp::ensureLoaded() const
+{
+    if (d->loadFilePath.isEmpty())
+        return;
+
+    auto self = const_cast<TileStamp*>(this);
+    const QString filePath = std::exchange(self->d->loadFilePath, QString());
+
+    QFile stampFile(filePath);
+    if (!stampFile.open(QIODevice::ReadOnly)) {
+        qDebug() << "Failed to open stamp file" << filePath;
+        return;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(stampFile.readAll(),
+                                                           &error);
+    if (error.error != QJsonParseError::NoError) {
+        qDebug() << "Failed to parse stamp file:" << error.errorString();
+        return;
+    }
+
+    addVariationsFromJson(*self, document.object(), d->loadDir);
+}
+
 } // namespace Tiled
@@ -77,10 +77,12 @@ public:
     QSize maxSize() const;
 
     const QVector<TileStampVariation> &variations() const;
+    int variationCount() const;
     void addVariation(std::unique_ptr<Map> map, qreal probability = 1.0);
     void addVariation(const TileStampVariation &variation);
     Map *takeVariation(int index);
     bool isEmpty() const;
+    bool isLoaded() const;
 
     int quickStampIndex() const;
     void setQuickStampIndex(int quickStampIndex);
@@ -96,8 +98,15 @@ public:
 
     static TileStamp fromJson(const QJsonObject &json,
                               const QDir &mapDir);
+    static TileStamp deferred(const QString &name,
+                              int quickStampIndex,
+                              int variationCount,
+                              const QString &fileName,
+                              const QDir &mapDir);
 
 private:
+    void ensureLoaded() const;
+
     QExplicitlySharedDataPointer<TileStampData> d;
 };
 
@@ -201,9 +201,49 @@ void TileStampManager::loadStamps()
                          QDir::Name | QDir::IgnoreCase,
                          QDir::Files | QDir::Readable);
 
+    mTileStampModel->setStampsDirectory(stampsDirectory);
+
+    // The index stores the metadata of all stamps in a single file, so that
+    // showing the stamp library doesn't require parsing every stamp file
+    QJsonObject index;
+    {
+        QFile indexFile(indexFilePath());
+        if (indexFile.open(QIODevice::ReadOnly))
+            index = QJsonDocument::fromJson(indexFile.readAll()).object();
+    }
+
+    bool indexDirty = false;
+    int indexedCount = 0;
+
     QDirIterator iterator(stampsDir);
     while (iterator.hasNext()) {
         const QString &stampFileName = iterator.next();
+        const QString fileName = iterator.fileName();
+        const qint64 fileTime = iterator.fileInfo().lastModified().toMSecsSinceEpoch();
+
+        // An up-to-date index entry means the stamp body can be loaded when
+        // the stamp is first used
+        const QJsonObject entry = index.value(fileName).toObject();
+        if (!entry.isEmpty()
+                && entry.value(QLatin1String("fileTime")).toDouble() == fileTime) {
+            TileStamp stamp = TileStamp::deferred(
+                        entry.value(QLatin1String("name")).toString(),
+                        static_cast<int>(entry.value(QLatin1String("quickStampIndex")).toDouble(-1)),
+                        static_cast<int>(entry.value(QLatin1String("variationCount")).toDouble(1)),
+                        fileName,
+                        stampsDir);
+
+            mTileStampModel->addStamp(stamp);
+
+            int quickIndex = stamp.quickStampIndex();
+            if (quickIndex >= 0 && quickIndex < mQuickStamps.size())
+                mQuickStamps[quickIndex] = stamp;
+
+            ++indexedCount;
+            continue;
+        }
+
+        indexDirty = true;
 
         QFile stampFile(stampFileName);
         if (!stampFile.open(QIODevice::ReadOnly))
@@ -229,6 +269,10 @@ void TileStampManager::loadStamps()
         if (index >= 0 && index < mQuickStamps.size())
             mQuickStamps[index] = stamp;
     }
+
+    // Also rewrite the index when it has entries for removed files
+    if (indexDirty || indexedCount != index.size())
+        saveIndex();
 }
 
 void TileStampManager::stampAdded(TileStamp stamp)
@@ -294,6 +338,8 @@ void TileStampManager::saveStamp(const TileStamp &stamp)
 
     if (!file.commit())
         qDebug() << "Failed to write stamp" << filePath;
+
+    saveIndex();
 }
 
 void TileStampManager::deleteStamp(const TileStamp &stamp)
@@ -302,6 +348,55 @@ void TileStampManager::deleteStamp(const TileStamp &stamp)
 
     mStampsByName.remove(stamp.name());
     QFile::remove(stampFilePath(stamp.fileName()));
+
+    saveIndex();
+}
+
+QString TileStampManager::indexFilePath() const
+{
+    return QDir { stampsDirectory }.filePath(QLatin1String("index.json"));
+}
+
+/**
+ * Writes the metadata of all stamps to the index file. Only metadata is
+ * needed, so stamps whose bodies haven't been loaded stay unloaded.
+ */
+void TileStampManager::saveIndex()
+{
+    const QDir stampsDir(stampsDirectory);
+
+    QJsonObject index;
+
+    for (const TileStamp &stamp : mTileStampModel->stamps()) {
+        const QString fileName = stamp.fileName();
+        if (fileName.isEmpty())
+            continue;
+
+        const QFileInfo fileInfo(stampsDir.filePath(fileName));
+        if (!fileInfo.exists())
+            continue;
+
+        QJsonObject entry;
+        entry.insert(QLatin1String("name"), stamp.name());
+        entry.insert(QLatin1String("fileTime"),
+                     static_cast<double>(fileInfo.lastModified().toMSecsSinceEpoch()));
+        entry.insert(QLatin1String("variationCount"), stamp.variationCount());
+        if (stamp.quickStampIndex() != -1)
+            entry.insert(QLatin1String("quickStampIndex"), stamp.quickStampIndex());
+
+        index.insert(fileName, entry);
+    }
+
+    SaveFile file(indexFilePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Failed to open stamp index for writing" << indexFilePath();
+        return;
+    }
+
+    file.device()->write(QJsonDocument(index).toJson(QJsonDocument::Compact));
+
+    if (!file.commit())
+        qDebug() << "Failed to write stamp index" << indexFilePath();
 }
 
 QString TileStampManager::stampFilePath(const QString &name)
@@ -84,6 +84,9 @@ private:
     void saveStamp(const TileStamp &stamp);
     void deleteStamp(const TileStamp &stamp);
 
+    QString indexFilePath() const;
+    void saveIndex();
+
     QString stampFilePath(const QString &name);
     QString findStampFileName(const QString &name, const QString &currentFileName = QString());
 
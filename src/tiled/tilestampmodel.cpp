@@ -22,6 +22,9 @@
 
 #include "minimaprenderer.h"
 
+#include <QElapsedTimer>
+#include <QFileInfo>
+
 namespace Tiled {
 
 TileStampModel::TileStampModel(QObject *parent)
@@ -56,7 +59,8 @@ int TileStampModel::rowCount(const QModelIndex &parent) const
         return mStamps.size();
     } else if (isStamp(parent)) {
         const TileStamp &stamp = mStamps.at(parent.row());
-        const int count = stamp.variations().size();
+        // variationCount doesn't load deferred stamps
+        const int count = stamp.variationCount();
         // it does not make much sense to expand single variations
         return count == 1 ? 0 : count;
     }
@@ -139,21 +143,15 @@ QVariant TileStampModel::data(const QModelIndex &index, int role) const
             case Qt::DisplayRole:
             case Qt::EditRole:
                 return stamp.name();
-            case Qt::DecorationRole: {
-                Map *map = stamp.variations().first().map;
-                QPixmap thumbnail = mThumbnailCache.value(map);
-                if (thumbnail.isNull()) {
-                    MiniMapRenderer renderer(map);
-                    thumbnail = renderThumbnail(renderer);
-                    mThumbnailCache.insert(map, thumbnail);
-                }
-                return thumbnail;
-            }
+            case Qt::DecorationRole:
+                return thumbnail(stamp, index);
             }
         } else if (index.column() == 1) {   // sum of probabilities
             switch (role) {
             case Qt::DisplayRole:
-                if (stamp.variations().size() > 1) {
+                // shown once the stamp is loaded, since the probabilities
+                // are stored in the stamp bodies
+                if (stamp.isLoaded() && stamp.variations().size() > 1) {
                     qreal sum = 0;
                     for (const TileStampVariation &variation : stamp.variations())
                         sum += variation.probability;
@@ -187,6 +185,127 @@ QVariant TileStampModel::data(const QModelIndex &index, int role) const
     return QVariant();
 }
 
+/**
+ * Returns the thumbnail for the given \a stamp, rendering it on demand.
+ *
+ * For stamps whose bodies haven't been loaded yet, the thumbnail cached on
+ * disk is used when it is still up-to-date. Otherwise the render is queued,
+ * so that showing the stamp library doesn't block on loading and rendering
+ * every stamp.
+ */
+QVariant TileStampModel::thumbnail(const TileStamp &stamp,
+                                   const QModelIndex &index) const
+{
+    const QString fileName = stamp.fileName();
+
+    if (stamp.isLoaded()) {
+        Map *map = stamp.variations().first().map;
+        QPixmap thumbnail = mThumbnailCache.value(map);
+        if (thumbnail.isNull())
+            thumbnail = mThumbnailByFileName.value(fileName);
+        if (thumbnail.isNull()) {
+            MiniMapRenderer renderer(map);
+            thumbnail = renderThumbnail(renderer);
+            writeThumbnail(fileName, thumbnail);
+        }
+        mThumbnailCache.insert(map, thumbnail);
+        return thumbnail;
+    }
+
+    auto it = mThumbnailByFileName.constFind(fileName);
+    if (it != mThumbnailByFileName.constEnd())
+        return it.value();
+
+    const QFileInfo thumbnailInfo(mThumbnailsDir.filePath(fileName + QLatin1String(".png")));
+    const QFileInfo stampInfo(mStampsDir.filePath(fileName));
+
+    if (thumbnailInfo.exists()
+            && thumbnailInfo.lastModified() >= stampInfo.lastModified()) {
+        const QPixmap thumbnail(thumbnailInfo.filePath());
+        if (!thumbnail.isNull()) {
+            mThumbnailByFileName.insert(fileName, thumbnail);
+            return thumbnail;
+        }
+    }
+
+    queueThumbnailRender(index);
+    return QVariant();
+}
+
+void TileStampModel::writeThumbnail(const QString &fileName,
+                                    const QPixmap &thumbnail) const
+{
+    if (fileName.isEmpty() || mThumbnailsDir.path().isEmpty())
+        return;
+
+    if (!mThumbnailsDir.exists() && !mThumbnailsDir.mkpath(QLatin1String(".")))
+        return;
+
+    thumbnail.save(mThumbnailsDir.filePath(fileName + QLatin1String(".png")),
+                   "PNG");
+}
+
+void TileStampModel::queueThumbnailRender(const QModelIndex &index) const
+{
+    const QPersistentModelIndex persistentIndex(index);
+    if (mPendingThumbnails.contains(persistentIndex))
+        return;
+
+    mPendingThumbnails.append(persistentIndex);
+
+    if (!mRenderScheduled) {
+        mRenderScheduled = true;
+        QMetaObject::invokeMethod(const_cast<TileStampModel*>(this),
+                                  &TileStampModel::renderPendingThumbnails,
+                                  Qt::QueuedConnection);
+    }
+}
+
+/**
+ * Renders queued thumbnails for a limited amount of time, rescheduling
+ * itself when more remain, so that large stamp libraries don't block the
+ * event loop.
+ */
+void TileStampModel::renderPendingThumbnails()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!mPendingThumbnails.isEmpty()) {
+        const QPersistentModelIndex index = mPendingThumbnails.takeFirst();
+        if (!index.isValid() || !isStamp(index))
+            continue;
+
+        const TileStamp &stamp = mStamps.at(index.row());
+
+        // Loads the stamp body when necessary
+        if (stamp.variations().isEmpty())
+            continue;
+
+        Map *map = stamp.variations().first().map;
+        QPixmap thumbnail = mThumbnailCache.value(map);
+        if (thumbnail.isNull()) {
+            MiniMapRenderer renderer(map);
+            thumbnail = renderThumbnail(renderer);
+            mThumbnailCache.insert(map, thumbnail);
+            writeThumbnail(stamp.fileName(), thumbnail);
+        }
+
+        emit dataChanged(QModelIndex(index), QModelIndex(index),
+                         { Qt::DecorationRole });
+
+        if (timer.elapsed() >= 15)
+            break;
+    }
+
+    if (mPendingThumbnails.isEmpty())
+        mRenderScheduled = false;
+    else
+        QMetaObject::invokeMethod(this,
+                                  &TileStampModel::renderPendingThumbnails,
+                                  Qt::QueuedConnection);
+}
+
 Qt::ItemFlags TileStampModel::flags(const QModelIndex &index) const
 {
     Qt::ItemFlags rc = QAbstractItemModel::flags(index);
@@ -213,6 +332,7 @@ bool TileStampModel::removeRows(int row, int count, const QModelIndex &parent)
             mThumbnailCache.remove(stamp.variations().at(row).map);
             delete stamp.takeVariation(row);
         }
+        mThumbnailByFileName.remove(stamp.fileName());
         endRemoveRows();
 
         if (stamp.variations().isEmpty()) {
@@ -235,9 +355,12 @@ bool TileStampModel::removeRows(int row, int count, const QModelIndex &parent)
         // removing stamps
         beginRemoveRows(parent, row, row + count - 1);
         for (; count > 0; --count) {
-            for (const TileStampVariation &variation : mStamps.at(row).variations())
-                mThumbnailCache.remove(variation.map);
-            emit stampRemoved(mStamps.at(row));
+            const TileStamp &stamp = mStamps.at(row);
+            if (stamp.isLoaded())
+                for (const TileStampVariation &variation : stamp.variations())
+                    mThumbnailCache.remove(variation.map);
+            mThumbnailByFileName.remove(stamp.fileName());
+            emit stampRemoved(stamp);
             mStamps.removeAt(row);
         }
         endRemoveRows();
@@ -296,8 +419,10 @@ void TileStampModel::removeStamp(const TileStamp &stamp)
     mStamps.removeAt(index);
     endRemoveRows();
 
-    for (const TileStampVariation &variation : stamp.variations())
-        mThumbnailCache.remove(variation.map);
+    if (stamp.isLoaded())
+        for (const TileStampVariation &variation : stamp.variations())
+            mThumbnailCache.remove(variation.map);
+    mThumbnailByFileName.remove(stamp.fileName());
 
     emit stampRemoved(stamp);
 }
@@ -326,11 +451,25 @@ void TileStampModel::addVariation(const TileStamp &stamp,
     emit stampChanged(stamp);
 }
 
+/**
+ * Sets the directory the stamps are loaded from, which determines where the
+ * thumbnails are cached on disk (in a "thumbnails" subdirectory).
+ */
+void TileStampModel::setStampsDirectory(const QString &stampsDirectory)
+{
+    mStampsDir.setPath(stampsDirectory);
+    mThumbnailsDir.setPath(stampsDirectory + QLatin1String("/thumbnails"));
+    mThumbnailByFileName.clear();
+    mPendingThumbnails.clear();
+}
+
 void TileStampModel::clear()
 {
     beginResetModel();
     mStamps.clear();
     mThumbnailCache.clear();
+    mThumbnailByFileName.clear();
+    mPendingThumbnails.clear();
     endResetModel();
 }
 
@@ -23,6 +23,7 @@
 #include "tilestamp.h"
 
 #include <QAbstractItemModel>
+#include <QDir>
 
 namespace Tiled {
 
@@ -76,6 +77,8 @@ public:
     void addVariation(const TileStamp &stamp,
                       const TileStampVariation &variation);
 
+    void setStampsDirectory(const QString &stampsDirectory);
+
     void clear();
 
 signals:
@@ -85,9 +88,20 @@ signals:
     void stampRemoved(const TileStamp &stamp);
 
 private:
+    QVariant thumbnail(const TileStamp &stamp, const QModelIndex &index) const;
+    void writeThumbnail(const QString &fileName, const QPixmap &thumbnail) const;
+    void queueThumbnailRender(const QModelIndex &index) const;
+    void renderPendingThumbnails();
+
     QList<TileStamp> mStamps;
 
+    QDir mStampsDir;
+    QDir mThumbnailsDir;
+
     mutable QHash<Map *, QPixmap> mThumbnailCache;
+    mutable QHash<QString, QPixmap> mThumbnailByFileName;
+    mutable QVector<QPersistentModelIndex> mPendingThumbnails;
+    mutable bool mRenderScheduled = false;
 };
 
 
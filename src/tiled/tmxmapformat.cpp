@@ -41,6 +41,12 @@ std::unique_ptr<Map> TmxMapFormat::read(const QString &fileName)
     mError.clear();
 
     MapReader reader;
+
+    // Let whole chunks of tile data be decoded on first access, so that large
+    // maps become visible quickly and only the viewed chunks pay the decoding
+    // cost up front.
+    reader.setDeferredChunkDecoding(true);
+
     std::unique_ptr<Map> map(reader.readMap(fileName));
     if (!map)
         mError = reader.errorString();
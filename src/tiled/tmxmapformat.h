@@ -62,6 +62,8 @@ public:
      */
     std::unique_ptr<Map> fromByteArray(const QByteArray &data);
 
+    Capabilities capabilities() const override { return ReadWrite | PreservesExportTarget; }
+
     QString nameFilter() const override { return tr("Tiled map files (*.tmx *.xml)"); }
 
     QString shortName() const override { return QStringLiteral("tmx"); }
@@ -89,6 +91,8 @@ public:
 
     bool write(const Tileset &tileset, const QString &fileName, Options options) override;
 
+    Capabilities capabilities() const override { return ReadWrite | PreservesExportTarget; }
+
     QString nameFilter() const override { return tr("Tiled tileset files (*.tsx *.xml)"); }
 
     QString shortName() const override { return QStringLiteral("tsx"); }
@@ -549,13 +549,14 @@ void WangBrush::updateBrush()
 
     FillRegion fill;
 
-    QVector<QPoint> points;
+    QVector<QPoint> &points = mPointBuffer;
+    points.clear();
     bool ignoreFirst = false;
 
     if (mBrushBehavior == Line && mLineStartSet) {
-        points = pointsOnLine(mLineStartPos, mPaintPoint, !mIsTileMode && mBrushMode != PaintEdgeAndCorner);
+        pointsOnLine(mLineStartPos, mPaintPoint, points, !mIsTileMode && mBrushMode != PaintEdgeAndCorner);
     } else if (mBrushBehavior == Paint && (mBrushMode == PaintEdge || mBrushMode == PaintCorner || mIsTileMode)) {
-        points = pointsOnLine(mPrevPaintPoint, mPaintPoint, !mIsTileMode);
+        pointsOnLine(mPrevPaintPoint, mPaintPoint, points, !mIsTileMode);
         ignoreFirst = points.size() > 1; // first point has already been painted last time
     } else {
         points.append(mPaintPoint);
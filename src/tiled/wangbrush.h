@@ -91,6 +91,9 @@ private:
     QPoint mPrevPaintPoint;
     QPoint mPaintPoint;
     QPoint mLineStartPos;
+
+    // Reusable buffer for the points painted per mouse move
+    QVector<QPoint> mPointBuffer;
     WangId::Index mWangIndex = WangId::Top;
 
     const WangSet *mWangSet = nullptr;
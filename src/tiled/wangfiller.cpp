@@ -104,13 +104,15 @@ void WangFiller::fillRegion(TileLayer &target,
                             const QRegion &region,
                             Grid<CellInfo> grid) const
 {
+    TileLayer::NeighborhoodReader backReader(back);
+
     if (mCorrectionsEnabled) {
         // Determine the desired WangId for all tiles in the region.
         for (const QRect &rect : region) {
             for (int y = rect.top(); y <= rect.bottom(); ++y) {
                 for (int x = rect.left(); x <= rect.right(); ++x) {
                     CellInfo info = grid.get(x, y);
-                    const auto currentWangId = mWangSet.wangIdOfCell(back.cellAt(x, y));
+                    const auto currentWangId = mWangSet.wangIdOfCell(backReader.cellAt(x, y));
 
                     for (int i = 0; i < WangId::NumIndexes; ++i)
                         if (!info.mask.indexColor(i))
@@ -124,7 +126,7 @@ void WangFiller::fillRegion(TileLayer &target,
         // Set the Wang IDs at the border of the region to make sure the tiles in
         // the filled region connect with those outside of it.
         auto setDesiredWangId = [&] (int x, int y) {
-            const WangId source = wangIdFromSurroundings(back, region, QPoint(x, y));
+            const WangId source = wangIdFromSurroundings(backReader, region, QPoint(x, y));
             CellInfo info = grid.get(x, y);
             for (int i = 0; i < WangId::NumIndexes; ++i) {
                 if (!info.mask.indexColor(i)) {
@@ -231,7 +233,7 @@ void WangFiller::fillRegion(TileLayer &target,
     }
 }
 
-WangId WangFiller::wangIdFromSurroundings(const TileLayer &back,
+WangId WangFiller::wangIdFromSurroundings(TileLayer::NeighborhoodReader &back,
                                           const QRegion &region,
                                           QPoint point) const
 {
@@ -239,9 +241,11 @@ WangId WangFiller::wangIdFromSurroundings(const TileLayer &back,
     QPoint adjacentPoints[8];
     getSurroundingPoints(point, mStaggeredRenderer, adjacentPoints);
 
+    back.centerOn(point);
+
     for (int i = 0; i < 8; ++i) {
         if (!region.contains(adjacentPoints[i]))
-            surroundingCells[i] = back.cellAt(adjacentPoints[i]);
+            surroundingCells[i] = back.neighbor(adjacentPoints[i] - point);
     }
 
     return mWangSet.wangIdFromSurrounding(surroundingCells);
@@ -253,61 +257,22 @@ bool WangFiller::findBestMatch(const TileLayer &target,
                                Cell &result) const
 {
     const CellInfo info = grid.get(position);
-    const quint64 maskedWangId = info.desired & info.mask;
-
-    RandomPicker<Cell> matches;
-    int lowestPenalty = INT_MAX;
-
-    auto processCandidate = [&] (WangId wangId, const Cell &cell) {
-        if ((wangId & info.mask) != maskedWangId)
-            return;
-
-        int totalPenalty = 0;
-
-        for (int i = 0; i < WangId::NumIndexes; ++i) {
-            const int desiredColor = info.desired.indexColor(i);
-            const int candidateColor = wangId.indexColor(i);
-
-            if (candidateColor != desiredColor) {
-                int penalty = mWangSet.transitionPenalty(desiredColor, candidateColor);
-
-                // If there is no path to the desired color, this isn't a useful transition
-                if (penalty < 0) {
-                    if (mCorrectionsEnabled) {
-                        // When we're doing corrections, we'd rather not choose
-                        // this candidate at all because it's impossible to
-                        // transition to the desired color.
-                        return;
-                    } else {
-                        penalty = mWangSet.maximumColorDistance() + 1;
-                    }
-                }
-
-                totalPenalty += penalty;
-            }
-        }
-
-        // Add tile to the candidate list
-        if (totalPenalty <= lowestPenalty) {
-            if (totalPenalty < lowestPenalty) {
-                matches.clear();
-                lowestPenalty = totalPenalty;
-            }
 
-            qreal probability = mWangSet.wangIdProbability(wangId);
-            if (Tile *tile = cell.tile())
-                probability *= tile->probability();
+    // Many cells share the same constraint signature, so the ranked
+    // candidate lists are memoized for the duration of this operation, on
+    // top of the cache the WangSet keeps across operations.
+    const QPair<quint64, quint64> key(info.desired, info.mask);
+    auto it = mCandidates.constFind(key);
+    if (it == mCandidates.constEnd())
+        it = mCandidates.insert(key, mWangSet.cellCandidates(info.desired,
+                                                             info.mask,
+                                                             mCorrectionsEnabled));
 
-            matches.add(cell, probability);
-        }
-    };
+    const WangSet::CellCandidates &candidates = it.value();
 
-    const auto &wangIdsAndCells = mWangSet.wangIdsAndCells();
-    for (int i = 0, i_end = wangIdsAndCells.size(); i < i_end; ++i)
-        processCandidate(wangIdsAndCells[i].wangId, wangIdsAndCells[i].cell);
-
-    if (mCorrectionsEnabled)
-        processCandidate(WangId(), Cell());
+    RandomPicker<Cell> matches;
+    for (int i = 0, i_end = candidates.cells.size(); i < i_end; ++i)
+        matches.add(candidates.cells.at(i), candidates.probabilities.at(i));
 
     // Choose a candidate at random, with consideration for probability
     while (!matches.isEmpty()) {
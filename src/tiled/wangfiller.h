@@ -22,8 +22,10 @@
 
 #include "grid.h"
 #include "map.h"
+#include "tilelayer.h"
 #include "wangset.h"
 
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QPoint>
@@ -76,7 +78,7 @@ private:
      * Returns a wangId based on cells from \a back which are not in the
      * \a region. \a point and \a region are relative to \a back.
      */
-    WangId wangIdFromSurroundings(const TileLayer &back,
+    WangId wangIdFromSurroundings(TileLayer::NeighborhoodReader &back,
                                   const QRegion &region,
                                   QPoint point) const;
 
@@ -90,6 +92,11 @@ private:
     const StaggeredRenderer * const mStaggeredRenderer;
     bool mCorrectionsEnabled = false;
 
+    // Ranked candidate lists by constraint signature, memoized for the
+    // duration of the operation. Since mCorrectionsEnabled doesn't change
+    // per filler, it doesn't need to be part of the key.
+    mutable QHash<QPair<quint64, quint64>, WangSet::CellCandidates> mCandidates;
+
     QPainter *mDebugPainter = nullptr;
 };
 
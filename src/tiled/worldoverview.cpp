@@ -0,0 +1,296 @@
+/*
+ * worldoverview.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "worldoverview.h"
+
+#include "documentmanager.h"
+#include "mapdocument.h"
+#include "mapformat.h"
+#include "minimaprenderer.h"
+#include "utils.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStandardPaths>
+
+using namespace Tiled;
+
+// Maps are rendered at this maximum dimension. At overview zoom levels more
+// detail is not visible, and it keeps the cached previews small.
+static const int previewExtent = 256;
+
+WorldOverview::WorldOverview(QWidget *parent)
+    : QFrame(parent)
+{
+    setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
+    setMinimumSize(50, 50);
+
+    WorldManager &worldManager = WorldManager::instance();
+    connect(&worldManager, &WorldManager::worldsChanged,
+            this, &WorldOverview::refreshWorld);
+    connect(&worldManager, &WorldManager::worldLoaded,
+            this, &WorldOverview::refreshWorld);
+    connect(&worldManager, &WorldManager::worldReloaded,
+            this, &WorldOverview::refreshWorld);
+    connect(&worldManager, &WorldManager::worldUnloaded,
+            this, &WorldOverview::refreshWorld);
+
+    connect(DocumentManager::instance(), &DocumentManager::documentSaved,
+            this, &WorldOverview::documentSaved);
+}
+
+WorldOverview::~WorldOverview()
+{
+    cancelPendingPreviews();
+}
+
+void WorldOverview::setMapDocument(MapDocument *mapDocument)
+{
+    if (mMapDocument == mapDocument)
+        return;
+
+    mMapDocument = mapDocument;
+    refreshWorld();
+}
+
+QSize WorldOverview::sizeHint() const
+{
+    return Utils::dpiScaled(QSize(200, 200));
+}
+
+void WorldOverview::refreshWorld()
+{
+    // Renders still in flight are for maps that may no longer be relevant
+    cancelPendingPreviews();
+
+    mWorldFileName.clear();
+    mEntries.clear();
+    mWorldBounds = QRect();
+
+    if (mMapDocument) {
+        const QString currentMapFile = mMapDocument->canonicalFilePath();
+        const WorldManager &worldManager = WorldManager::instance();
+
+        if (const World *world = worldManager.worldForMap(currentMapFile)) {
+            mWorldFileName = world->fileName;
+            mEntries = world->allMaps();
+
+            for (const World::MapEntry &entry : std::as_const(mEntries))
+                mWorldBounds |= entry.rect;
+        }
+    }
+
+    update();
+}
+
+void WorldOverview::cancelPendingPreviews()
+{
+    for (const JobScheduler::Token &token : std::as_const(mPendingPreviews))
+        token.cancel();
+    mPendingPreviews.clear();
+}
+
+void WorldOverview::documentSaved(Document *document)
+{
+    const QString fileName = document->canonicalFilePath();
+    if (fileName.isEmpty())
+        return;
+
+    // A render still in flight is of the pre-save map, and would write a
+    // stale image into the cache file removed below. Cancelling a default
+    // token is a no-op.
+    mPendingPreviews.take(fileName).cancel();
+
+    // The next request re-renders this map rather than using a stale preview
+    QFile::remove(previewCacheFilePath(fileName));
+    mPreviews.remove(fileName);
+
+    for (const World::MapEntry &entry : std::as_const(mEntries)) {
+        if (entry.fileName == fileName) {
+            update();
+            break;
+        }
+    }
+}
+
+void WorldOverview::paintEvent(QPaintEvent *event)
+{
+    QFrame::paintEvent(event);
+
+    if (mEntries.isEmpty() || mWorldBounds.isEmpty())
+        return;
+
+    const QString currentMapFile = mMapDocument ? mMapDocument->canonicalFilePath()
+                                                : QString();
+
+    QPainter painter(this);
+    painter.setRenderHints(QPainter::Antialiasing |
+                           QPainter::SmoothPixmapTransform);
+
+    for (const World::MapEntry &entry : std::as_const(mEntries)) {
+        const QRectF target = mapToWidget(entry.rect);
+
+        if (const QImage *preview = mPreviews.object(entry.fileName)) {
+            if (!preview->isNull())
+                painter.drawImage(target, *preview);
+        } else {
+            painter.fillRect(target, palette().mid());
+
+            if (!mPendingPreviews.contains(entry.fileName))
+                requestPreview(entry);
+        }
+
+        if (entry.fileName == currentMapFile) {
+            painter.setPen(QPen(palette().highlight(), 2));
+            painter.setBrush(Qt::NoBrush);
+            painter.drawRect(target);
+        } else {
+            painter.setPen(palette().dark().color());
+            painter.setBrush(Qt::NoBrush);
+            painter.drawRect(target);
+        }
+    }
+}
+
+void WorldOverview::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        if (const World::MapEntry *entry = entryAt(event->pos())) {
+            DocumentManager::instance()->openFile(entry->fileName);
+            return;
+        }
+    }
+
+    QFrame::mouseDoubleClickEvent(event);
+}
+
+/**
+ * Kicks off rendering of the preview for the given map as an idle-priority
+ * job, so a world full of maps never delays interactive background work.
+ * The result arrives back in previewRendered.
+ *
+ * The job only re-renders the map when the on-disk cache has no preview
+ * that is newer than the map file.
+ *
+ * Reading and rendering the map off the main thread relies on ImageCache
+ * and the renderer's pixmap caches being thread-safe.
+ */
+void WorldOverview::requestPreview(const World::MapEntry &entry)
+{
+    const QString fileName = entry.fileName;
+    const QString cacheFile = previewCacheFilePath(fileName);
+
+    const auto token = JobScheduler::schedule<QImage>(
+                JobScheduler::IdlePriority,
+                [=] (const JobScheduler::Token &token) {
+        QImage image;
+
+        const QFileInfo cacheInfo(cacheFile);
+        if (cacheInfo.exists() &&
+                cacheInfo.lastModified() >= QFileInfo(fileName).lastModified())
+            image.load(cacheFile);
+
+        if (image.isNull() && !token.isCancelled()) {
+            QString error;
+            if (auto map = readMap(fileName, &error)) {
+                MiniMapRenderer renderer(map.get());
+
+                QSize size = renderer.mapSize();
+                if (size.width() > previewExtent || size.height() > previewExtent)
+                    size.scale(previewExtent, previewExtent, Qt::KeepAspectRatio);
+
+                image = renderer.render(size,
+                                        MiniMapRenderer::DrawTileLayers |
+                                        MiniMapRenderer::DrawMapObjects |
+                                        MiniMapRenderer::DrawImageLayers |
+                                        MiniMapRenderer::IgnoreInvisibleLayer |
+                                        MiniMapRenderer::DrawBackground |
+                                        MiniMapRenderer::SmoothPixmapTransform);
+
+                // Don't cache the render of a map that changed meanwhile
+                if (!token.isCancelled()) {
+                    QDir().mkpath(cacheInfo.path());
+                    image.save(cacheFile, "PNG");
+                }
+            }
+        }
+
+        return image;
+    },
+                this,
+                [this, fileName] (const QImage &image) {
+        previewRendered(fileName, image);
+    });
+
+    mPendingPreviews.insert(entry.fileName, token);
+}
+
+void WorldOverview::previewRendered(const QString &fileName, const QImage &image)
+{
+    mPendingPreviews.remove(fileName);
+
+    // A null image is cached as well, so that a map that failed to load is
+    // not retried on every repaint.
+    const int cost = int(qMax<qint64>(1, image.sizeInBytes() / 1024));
+    mPreviews.insert(fileName, new QImage(image), cost);
+
+    update();
+}
+
+QRectF WorldOverview::mapToWidget(const QRect &rect) const
+{
+    const QRect content = contentsRect().adjusted(2, 2, -2, -2);
+
+    const qreal scale = qMin(static_cast<qreal>(content.width()) / mWorldBounds.width(),
+                             static_cast<qreal>(content.height()) / mWorldBounds.height());
+
+    const QPointF offset(content.x() + (content.width() - mWorldBounds.width() * scale) / 2,
+                         content.y() + (content.height() - mWorldBounds.height() * scale) / 2);
+
+    return QRectF(offset.x() + (rect.x() - mWorldBounds.x()) * scale,
+                  offset.y() + (rect.y() - mWorldBounds.y()) * scale,
+                  rect.width() * scale,
+                  rect.height() * scale);
+}
+
+const World::MapEntry *WorldOverview::entryAt(QPoint pos) const
+{
+    for (const World::MapEntry &entry : mEntries)
+        if (mapToWidget(entry.rect).contains(pos))
+            return &entry;
+
+    return nullptr;
+}
+
+QString WorldOverview::previewCacheFilePath(const QString &fileName)
+{
+    const QByteArray hash = QCryptographicHash::hash(fileName.toUtf8(),
+                                                     QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + QLatin1String("/map-previews/")
+            + QLatin1String(hash)
+            + QLatin1String(".png");
+}
+
+#include "moc_worldoverview.cpp"
@@ -0,0 +1,83 @@
+/*
+ * worldoverview.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "jobscheduler.h"
+#include "worldmanager.h"
+
+#include <QCache>
+#include <QFrame>
+#include <QHash>
+#include <QImage>
+
+namespace Tiled {
+
+class Document;
+class MapDocument;
+
+/**
+ * Shows all maps of the world the current map is part of, without requiring
+ * those maps to be open.
+ *
+ * Map previews are rendered on the global thread pool and cached on disk, so
+ * that showing the overview of a large world only renders the maps that
+ * changed since the last time it was shown.
+ */
+class WorldOverview : public QFrame
+{
+    Q_OBJECT
+
+public:
+    WorldOverview(QWidget *parent);
+    ~WorldOverview() override;
+
+    void setMapDocument(MapDocument *mapDocument);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private:
+    void refreshWorld();
+    void cancelPendingPreviews();
+    void documentSaved(Document *document);
+    void requestPreview(const World::MapEntry &entry);
+    void previewRendered(const QString &fileName, const QImage &image);
+
+    QRectF mapToWidget(const QRect &rect) const;
+    const World::MapEntry *entryAt(QPoint pos) const;
+
+    static QString previewCacheFilePath(const QString &fileName);
+
+    MapDocument *mMapDocument = nullptr;
+    QString mWorldFileName;
+    QVector<World::MapEntry> mEntries;
+    QRect mWorldBounds;
+
+    // In-memory previews, bounded since the on-disk cache makes evicted
+    // entries cheap to restore (cost is in kilobytes)
+    QCache<QString, QImage> mPreviews { 32 * 1024 };
+    QHash<QString, JobScheduler::Token> mPendingPreviews;
+};
+
+} // namespace Tiled
@@ -0,0 +1,62 @@
+/*
+ * worldoverviewdock.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "worldoverviewdock.h"
+
+#include "worldoverview.h"
+
+#include <QEvent>
+
+using namespace Tiled;
+
+WorldOverviewDock::WorldOverviewDock(QWidget *parent)
+    : QDockWidget(parent)
+{
+    setObjectName(QLatin1String("worldOverviewDock"));
+
+    mWorldOverview = new WorldOverview(this);
+
+    setWidget(mWorldOverview);
+    retranslateUi();
+}
+
+void WorldOverviewDock::setMapDocument(MapDocument *map)
+{
+    mWorldOverview->setMapDocument(map);
+}
+
+void WorldOverviewDock::changeEvent(QEvent *e)
+{
+    QDockWidget::changeEvent(e);
+    switch (e->type()) {
+    case QEvent::LanguageChange:
+        retranslateUi();
+        break;
+    default:
+        break;
+    }
+}
+
+void WorldOverviewDock::retranslateUi()
+{
+    setWindowTitle(tr("World Overview"));
+}
+
+#include "moc_worldoverviewdock.cpp"
@@ -0,0 +1,51 @@
+/*
+ * worldoverviewdock.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QDockWidget>
+
+namespace Tiled {
+
+class WorldOverview;
+class MapDocument;
+
+/**
+ * Shows an overview of the world the current map is part of.
+ */
+class WorldOverviewDock : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    WorldOverviewDock(QWidget *parent = nullptr);
+
+    void setMapDocument(MapDocument *);
+
+protected:
+    void changeEvent(QEvent *e) override;
+
+private:
+    void retranslateUi();
+
+    WorldOverview *mWorldOverview;
+};
+
+} // namespace Tiled
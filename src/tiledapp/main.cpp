@@ -22,6 +22,7 @@
 
 #include "commandlineparser.h"
 #include "exporthelper.h"
+#include "imagecache.h"
 #include "languagemanager.h"
 #include "logginginterface.h"
 #include "mainwindow.h"
@@ -30,15 +31,24 @@
 #include "mapreader.h"
 #include "pluginmanager.h"
 #include "preferences.h"
+#include "savefile.h"
 #include "scriptmanager.h"
 #include "sentryhelper.h"
 #include "stylehelper.h"
 #include "tiledapplication.h"
 #include "tileset.h"
 #include "tmxmapformat.h"
+#include "utils.h"
 
+#include <QDateTime>
 #include <QDebug>
+#include <QDir>
 #include <QFileInfo>
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <algorithm>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QtPlugin>
@@ -88,6 +98,9 @@ public:
     bool exportMap = false;
     bool exportTileset = false;
     bool newInstance = false;
+    bool sharedImageCache = false;
+    bool exportSkipUnchanged = false;
+    QRect exportArea;
     Preferences::ExportOptions exportOptions;
 
 private:
@@ -100,6 +113,9 @@ private:
     void setExportDetachTemplateInstances();
     void setExportResolveObjectTypesAndProperties();
     void setExportMinimized();
+    void setExportSkipUnchanged();
+    void setExportArea();
+    void setSharedImageCache();
     void showExportFormats();
     void setCompatibilityVersion();
     void evaluateScript();
@@ -174,6 +190,96 @@ inline T *findExportFormat(const QString *filter,
     return outputFormat;
 }
 
+/**
+ * Exports all maps in \a sourceDir to \a targetDir using \a outputFormat.
+ *
+ * The maps are loaded one by one, so that external tilesets and object
+ * templates are shared through their usual caches, while the write jobs run
+ * concurrently on the global thread pool. This assumes the write path of the
+ * output format is reentrant, which holds for the built-in formats since
+ * they only use local state while writing.
+ *
+ * Returns the exit code for the process.
+ */
+int exportMapsInDirectory(MapFormat *outputFormat,
+                          const QString &sourceDir,
+                          const QString &targetDir,
+                          Preferences::ExportOptions exportOptions)
+{
+    if (!QFileInfo(targetDir).isDir()) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Target of a directory export must be a directory.");
+        return 1;
+    }
+
+    const QString extension = Utils::firstExtension(outputFormat->nameFilter());
+    const auto readerFormats = PluginManager::objects<MapFormat>();
+    const QDir target(targetDir);
+
+    const ExportHelper exportHelper(exportOptions);
+    const FileFormat::Options formatOptions = exportHelper.formatOptions();
+
+    QThreadPool * const threadPool = QThreadPool::globalInstance();
+    QSemaphore finished;
+    QAtomicInt failures;
+    int jobs = 0;
+
+    const auto files = QDir(sourceDir).entryInfoList(QDir::Files | QDir::Readable,
+                                                     QDir::Name);
+    for (const QFileInfo &fileInfo : files) {
+        const QString sourceFile = fileInfo.filePath();
+
+        const bool isMap = std::any_of(readerFormats.begin(), readerFormats.end(),
+                                       [&] (MapFormat *format) {
+            return format->hasCapabilities(MapFormat::Read) && format->supportsFile(sourceFile);
+        });
+        if (!isMap)
+            continue;
+
+        QString errorMsg;
+        std::shared_ptr<Map> sourceMap(readMap(sourceFile, &errorMsg).release());
+        if (!sourceMap) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load map %1.").arg(sourceFile);
+            if (!errorMsg.isEmpty())
+                qWarning().noquote() << errorMsg;
+            ++failures;
+            continue;
+        }
+
+        // Apply export options (the prepared map may be the source map)
+        auto preparedMap = std::make_shared<std::unique_ptr<Map>>();
+        const Map *map = exportHelper.prepareExportMap(sourceMap.get(), *preparedMap,
+                                                       outputFormat);
+
+        const QString targetFile = target.filePath(fileInfo.completeBaseName() + extension);
+
+        threadPool->start([=, &finished, &failures] {
+            const QDateTime lastModified = QFileInfo(targetFile).lastModified();
+
+            if (!outputFormat->write(map, targetFile, formatOptions)) {
+                qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to export map to %1.").arg(targetFile);
+                ++failures;
+            } else if (SaveFile::skipUnchangedEnabled()
+                       && lastModified.isValid()
+                       && QFileInfo(targetFile).lastModified() == lastModified) {
+                qInfo().noquote() << QCoreApplication::translate("Command line", "Target %1 unchanged.").arg(targetFile);
+            }
+
+            Q_UNUSED(sourceMap)
+            Q_UNUSED(preparedMap)
+            finished.release();
+        });
+        ++jobs;
+    }
+
+    finished.acquire(jobs);
+
+    if (jobs == 0 && failures == 0) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "No maps found in %1.").arg(sourceDir);
+        return 1;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
 
 } // anonymous namespace
 
@@ -235,6 +341,21 @@ CommandLineHandler::CommandLineHandler()
                 QLatin1String("--minimize"),
                 tr("Minimize the exported file by omitting unnecessary whitespace"));
 
+    option<&CommandLineHandler::setExportSkipUnchanged>(
+                QChar(),
+                QLatin1String("--skip-unchanged"),
+                tr("Skip writing export targets whose contents would not change"));
+
+    option<&CommandLineHandler::setExportArea>(
+                QChar(),
+                QLatin1String("--export-area"),
+                tr("Limit a map export to the given tile area (x,y,width,height)"));
+
+    option<&CommandLineHandler::setSharedImageCache>(
+                QChar(),
+                QLatin1String("--shared-image-cache"),
+                tr("Share decoded tileset images with other Tiled processes"));
+
     option<&CommandLineHandler::startNewInstance>(
                 QChar(),
                 QLatin1String("--new-instance"),
@@ -296,6 +417,35 @@ void CommandLineHandler::setExportMinimized()
     exportOptions |= Preferences::ExportMinimized;
 }
 
+void CommandLineHandler::setExportSkipUnchanged()
+{
+    exportSkipUnchanged = true;
+}
+
+void CommandLineHandler::setExportArea()
+{
+    const QString areaString = nextArgument();
+    const QStringList parts = areaString.split(QLatin1Char(','));
+
+    bool ok = parts.size() == 4;
+    int values[4] = {};
+    for (int i = 0; ok && i < 4; ++i)
+        values[i] = parts.at(i).toInt(&ok);
+
+    if (!ok || values[2] <= 0 || values[3] <= 0) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Specify the area using: --export-area <x,y,width,height>");
+        justQuit();
+        return;
+    }
+
+    exportArea = QRect(values[0], values[1], values[2], values[3]);
+}
+
+void CommandLineHandler::setSharedImageCache()
+{
+    sharedImageCache = true;
+}
+
 void CommandLineHandler::showExportFormats()
 {
     initializePluginsAndExtensions();
@@ -439,6 +589,11 @@ int main(int argc, char *argv[])
     XmlObjectTemplateFormat xmlObjectTemplateFormat;
     PluginManager::addObject(&xmlObjectTemplateFormat);
 
+    // The command line handler creates translated help texts, so this is the
+    // last moment to install the translators started loading by the
+    // application constructor
+    LanguageManager::instance()->installTranslators();
+
     CommandLineHandler commandLine;
 
     if (!commandLine.parse(QCoreApplication::arguments()))
@@ -447,6 +602,11 @@ int main(int argc, char *argv[])
         return 0;
     if (commandLine.disableOpenGL)
         Preferences::instance()->setUseOpenGL(false);
+    if (commandLine.sharedImageCache)
+        ImageCache::setProcessSharingEnabled(true);
+
+    if (commandLine.exportSkipUnchanged)
+        SaveFile::setSkipUnchangedEnabled(true);
 
     if (commandLine.exportMap) {
         // Get the path to the source file and target file
@@ -470,6 +630,13 @@ int main(int argc, char *argv[])
             return 1;
         }
 
+        // When the source is a directory, export all maps it contains. This
+        // requires an explicit format, since the target file extension can't
+        // determine it.
+        if (QFileInfo(sourceFile).isDir())
+            return exportMapsInDirectory(outputFormat, sourceFile, targetFile,
+                                         commandLine.exportOptions);
+
         // Load the source file
         const std::unique_ptr<Map> sourceMap(readMap(sourceFile, &errorMsg));
         if (!sourceMap) {
@@ -479,18 +646,34 @@ int main(int argc, char *argv[])
             return 1;
         }
 
+        // Reduce the map to the requested area, so that iterating on a small
+        // part of a large map doesn't pay for a full export
+        std::unique_ptr<Map> clippedMap;
+        const Map *sourceOrClippedMap = sourceMap.get();
+        if (!commandLine.exportArea.isNull()) {
+            clippedMap = sourceMap->clipped(commandLine.exportArea);
+            sourceOrClippedMap = clippedMap.get();
+        }
+
         // Apply export options
         std::unique_ptr<Map> exportMap;
         ExportHelper exportHelper(commandLine.exportOptions);
-        const Map *map = exportHelper.prepareExportMap(sourceMap.get(), exportMap);
+        const Map *map = exportHelper.prepareExportMap(sourceOrClippedMap, exportMap,
+                                                       outputFormat);
 
         // Write out the file
+        const QDateTime lastModified = QFileInfo(targetFile).lastModified();
         bool success = outputFormat->write(map, targetFile, exportHelper.formatOptions());
 
         if (!success) {
             qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to export map to target file.");
             return 1;
         }
+        if (SaveFile::skipUnchangedEnabled()
+                && lastModified.isValid()
+                && QFileInfo(targetFile).lastModified() == lastModified) {
+            qInfo().noquote() << QCoreApplication::translate("Command line", "Target %1 unchanged.").arg(targetFile);
+        }
         return 0;
     }
 
@@ -527,15 +710,22 @@ int main(int argc, char *argv[])
 
         // Apply export options
         ExportHelper exportHelper(commandLine.exportOptions);
-        SharedTileset exportTileset = exportHelper.prepareExportTileset(sourceTileset);
+        SharedTileset exportTileset = exportHelper.prepareExportTileset(sourceTileset, true,
+                                                                        outputFormat);
 
         // Write out the file
+        const QDateTime lastModified = QFileInfo(targetFile).lastModified();
         bool success = outputFormat->write(*exportTileset, targetFile, exportHelper.formatOptions());
 
         if (!success) {
             qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to export tileset to target file.");
             return 1;
         }
+        if (SaveFile::skipUnchangedEnabled()
+                && lastModified.isValid()
+                && QFileInfo(targetFile).lastModified() == lastModified) {
+            qInfo().noquote() << QCoreApplication::translate("Command line", "Target %1 unchanged.").arg(targetFile);
+        }
         return 0;
     }
 
@@ -590,12 +780,18 @@ int main(int argc, char *argv[])
     QObject::connect(&a, &TiledApplication::fileOpenRequest,
                      &w, [&] (const QString &file) { w.openFile(file); });
 
-    PluginManager::instance()->loadPlugins();
+    // Let the window show in a skeleton state right away. Loading the
+    // plugins and scripted extensions, restoring the session and opening the
+    // requested files happens from the event loop, after the first frame has
+    // been presented.
+    QMetaObject::invokeMethod(&w, [&w, filesToOpen] {
+        PluginManager::instance()->loadPlugins();
 
-    w.initializeSession();
+        w.initializeSession();
 
-    for (const QString &fileName : std::as_const(filesToOpen))
-        w.openFile(fileName);
+        for (const QString &fileName : filesToOpen)
+            w.openFile(fileName);
+    }, Qt::QueuedConnection);
 
     return a.exec();
 }
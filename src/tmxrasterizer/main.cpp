@@ -65,6 +65,8 @@ int main(int argc, char *argv[])
                           { QStringLiteral("size"),
                             QCoreApplication::translate("main", "The output image fits within a SIZE x SIZE square (overrides the --scale and --tilesize options)."),
                             QCoreApplication::translate("main", "size") },
+                          { QStringLiteral("opengl"),
+                            QCoreApplication::translate("main", "Render on the GPU using an offscreen OpenGL context (falls back to software rendering when no context is available).") },
                           { { QStringLiteral("a"), QStringLiteral("anti-aliasing") },
                             QCoreApplication::translate("main", "Antialias edges of primitives.") },
                           { QStringLiteral("no-smoothing"),
@@ -85,23 +87,28 @@ int main(int argc, char *argv[])
                             QCoreApplication::translate("main", "Don't render image layers.") },
                           { QStringLiteral("advance-animations"),
                             QCoreApplication::translate("main", "If used, tile animations are advanced by the specified duration."),
-                            QCoreApplication::translate("main", "duration") }
+                            QCoreApplication::translate("main", "duration") },
+                          { QStringLiteral("batch"),
+                            QCoreApplication::translate("main", "Render a batch of maps listed in a manifest file with one \"input output\" pair per line (lines starting with # are ignored)."),
+                            QCoreApplication::translate("main", "manifest") },
+                          { { QStringLiteral("j"), QStringLiteral("jobs") },
+                            QCoreApplication::translate("main", "The number of worker threads used in batch mode (default: number of CPU cores)."),
+                            QCoreApplication::translate("main", "count") },
+                          { QStringLiteral("pin-workers"),
+                            QCoreApplication::translate("main", "Pin each batch worker thread to a CPU core (only supported on Linux).") }
                       });
     parser.addPositionalArgument(QStringLiteral("map|world"), QCoreApplication::translate("main", "Map or world file to render."));
     parser.addPositionalArgument(QStringLiteral("image"), QCoreApplication::translate("main", "Image file to output."));
     parser.process(app);
 
-    const QStringList args = parser.positionalArguments();
-    if (args.size() != 2)
-        parser.showHelp(1);
-
-    const QString &fileToOpen = localFile(args.at(0));
-    const QString &fileToSave = args.at(1);
+    const bool batchMode = parser.isSet(QLatin1String("batch"));
 
-    if (fileToOpen.isEmpty() || fileToSave.isEmpty())
+    const QStringList args = parser.positionalArguments();
+    if (batchMode ? !args.isEmpty() : args.size() != 2)
         parser.showHelp(1);
 
     TmxRasterizer w;
+    w.setOpenGL(parser.isSet(QLatin1String("opengl")));
     w.setAntiAliasing(parser.isSet(QLatin1String("anti-aliasing")));
     w.setSmoothImages(!parser.isSet(QLatin1String("no-smoothing")));
     w.setIgnoreVisibility(parser.isSet(QLatin1String("ignore-visibility")));
@@ -147,5 +154,27 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (batchMode) {
+        int jobs = 0;
+        if (parser.isSet(QLatin1String("jobs"))) {
+            bool ok;
+            jobs = parser.value(QLatin1String("jobs")).toInt(&ok);
+            if (!ok || jobs <= 0) {
+                qWarning().noquote() << QCoreApplication::translate("main", "Invalid number of jobs specified: \"%1\"").arg(parser.value(QLatin1String("jobs")));
+                exit(1);
+            }
+        }
+
+        return w.renderBatch(localFile(parser.value(QLatin1String("batch"))),
+                             jobs,
+                             parser.isSet(QLatin1String("pin-workers")));
+    }
+
+    const QString &fileToOpen = localFile(args.at(0));
+    const QString &fileToSave = args.at(1);
+
+    if (fileToOpen.isEmpty() || fileToSave.isEmpty())
+        parser.showHelp(1);
+
     return w.render(fileToOpen, fileToSave);
 }
@@ -38,20 +38,54 @@
 #include "tilesetmanager.h"
 #include "worldmanager.h"
 
+#include <QAtomicInt>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QImageWriter>
+#include <QMutex>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLPaintDevice>
+#include <QSemaphore>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtMath>
 
 #include <memory>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 using namespace Tiled;
 
+// Map loading goes through the process-wide ImageCache and the shared
+// tileset registry, which are not thread-safe. Batch workers serialize the
+// loading, which also makes them share decoded tileset images, while the
+// rendering runs in parallel.
+static QMutex sMapLoadMutex;
+
+static std::unique_ptr<Map> loadMap(const QString &fileName,
+                                    QString *errorString)
+{
+    QMutexLocker locker(&sMapLoadMutex);
+    return readMap(fileName, errorString);
+}
+
 TmxRasterizer::TmxRasterizer()
 {
 }
 
 void TmxRasterizer::drawMapLayers(const MapRenderer &renderer,
                                   QPainter &painter,
-                                  QPoint mapOffset) const
+                                  QPoint mapOffset,
+                                  const QRectF &exposed) const
 {
     // Perform a similar rendering than found in minimaprenderer.cpp
     LayerIterator iterator(renderer.map());
@@ -68,7 +102,9 @@ void TmxRasterizer::drawMapLayers(const MapRenderer &renderer,
         const ObjectGroup *objectGroup = dynamic_cast<const ObjectGroup*>(layer);
 
         if (tileLayer) {
-            renderer.drawTileLayer(&painter, tileLayer);
+            renderer.drawTileLayer(&painter, tileLayer,
+                                   exposed.isValid() ? exposed.translated(-offset)
+                                                     : QRectF());
         } else if (imageLayer) {
             renderer.drawImageLayer(&painter, imageLayer);
         } else if (objectGroup) {
@@ -127,11 +163,148 @@ int TmxRasterizer::render(const QString &fileName,
         return renderMap(fileName, imageFileName);
 }
 
+#ifdef Q_OS_LINUX
+static void pinCurrentThreadToCore(int core)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<size_t>(core) % CPU_SETSIZE, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+#endif
+
+/**
+ * Processes a manifest of "input output" lines with a fixed pool of worker
+ * threads in this process, so that decoded tileset images are shared
+ * between the jobs instead of being decoded again by a process per map.
+ *
+ * Each worker renders one map at a time without parallel bands; the
+ * parallelism comes from the number of workers. When \a pinWorkers is set,
+ * each worker is pinned to a CPU core (one socket's caches keep serving the
+ * same worker), which is only supported on Linux.
+ *
+ * The time spent on each map is reported, so that shards can be balanced
+ * across machines.
+ */
+int TmxRasterizer::renderBatch(const QString &manifestFileName,
+                               int jobCount,
+                               bool pinWorkers)
+{
+    struct Job {
+        QString fileName;
+        QString imageFileName;
+    };
+
+    QVector<Job> jobs;
+
+    QFile manifestFile(manifestFileName);
+    if (!manifestFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning("Error opening manifest file \"%s\"",
+                 qUtf8Printable(manifestFileName));
+        return 1;
+    }
+
+    QTextStream stream(&manifestFile);
+    QString line;
+    while (stream.readLineInto(&line)) {
+        const QString trimmed = line.trimmed();
+        if (trimmed.isEmpty() || trimmed.startsWith(QLatin1Char('#')))
+            continue;
+
+        const QStringList fields = trimmed.split(QLatin1Char(' '),
+#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
+                                                 QString::SkipEmptyParts);
+#else
+                                                 Qt::SkipEmptyParts);
+#endif
+        if (fields.size() != 2) {
+            qWarning("Invalid manifest line: \"%s\"", qUtf8Printable(trimmed));
+            return 1;
+        }
+
+        jobs.append(Job { fields.at(0), fields.at(1) });
+    }
+
+    if (jobs.isEmpty()) {
+        qWarning("No jobs in manifest file \"%s\"",
+                 qUtf8Printable(manifestFileName));
+        return 1;
+    }
+
+    if (jobCount < 1)
+        jobCount = QThread::idealThreadCount();
+    jobCount = qMin(jobCount, jobs.size());
+
+#ifndef Q_OS_LINUX
+    if (pinWorkers) {
+        qWarning("Pinning workers to cores is not supported on this platform");
+        pinWorkers = false;
+    }
+#endif
+
+    QAtomicInt nextJob(0);
+    QAtomicInt failures(0);
+
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    std::vector<std::unique_ptr<QThread>> workers;
+    workers.reserve(jobCount);
+
+    for (int workerIndex = 0; workerIndex < jobCount; ++workerIndex) {
+        workers.emplace_back(QThread::create([=, &jobs, &nextJob, &failures] {
+#ifdef Q_OS_LINUX
+            if (pinWorkers)
+                pinCurrentThreadToCore(workerIndex % QThread::idealThreadCount());
+#else
+            Q_UNUSED(workerIndex)
+#endif
+
+            // Each worker renders with its own settings copy
+            TmxRasterizer rasterizer(*this);
+            rasterizer.mSequentialRendering = true;
+
+            QElapsedTimer timer;
+
+            for (;;) {
+                const int jobIndex = nextJob.fetchAndAddRelaxed(1);
+                if (jobIndex >= jobs.size())
+                    break;
+
+                const Job &job = jobs.at(jobIndex);
+
+                timer.start();
+                const int result = rasterizer.render(job.fileName,
+                                                     job.imageFileName);
+                if (result != 0)
+                    failures.fetchAndAddRelaxed(1);
+
+                qInfo("%s -> %s: %lld ms%s",
+                      qUtf8Printable(job.fileName),
+                      qUtf8Printable(job.imageFileName),
+                      static_cast<long long>(timer.elapsed()),
+                      result == 0 ? "" : " (failed)");
+            }
+        }));
+        workers.back()->start();
+    }
+
+    for (const auto &worker : workers)
+        worker->wait();
+
+    qInfo("Rendered %d maps with %d workers in %lld ms (%d failed)",
+          int(jobs.size()), jobCount,
+          static_cast<long long>(totalTimer.elapsed()),
+          int(failures.loadAcquire()));
+
+    return failures.loadAcquire() == 0 ? 0 : 1;
+}
+
 int TmxRasterizer::renderMap(const QString &mapFileName,
                              const QString &imageFileName)
 {
     QString errorString;
-    std::unique_ptr<Map> map { readMap(mapFileName, &errorString) };
+    std::unique_ptr<Map> map = loadMap(mapFileName, &errorString);
     if (!map) {
         qWarning("Error while reading \"%s\":\n%s",
                  qUtf8Printable(mapFileName),
@@ -156,25 +329,188 @@ int TmxRasterizer::renderMap(const QString &mapFileName,
         xScale = yScale = mScale;
     }
 
-    if (mAdvanceAnimations > 0) 
+    if (mAdvanceAnimations > 0) {
+        QMutexLocker locker(&sMapLoadMutex);
         TilesetManager::instance()->advanceTileAnimations(mAdvanceAnimations);
+    }
 
     mapSize.rwidth() *= xScale;
     mapSize.rheight() *= yScale;
 
-    QImage image(mapSize, QImage::Format_ARGB32);
+    QImage image = renderToImage(*renderer, mapSize,
+                                 xScale, yScale,
+                                 -mapBoundingRect.topLeft());
+    map.reset();
+    return saveImage(imageFileName, image);
+}
+
+/**
+ * Renders the map in horizontal bands, one band per worker thread. Each
+ * band is drawn into its own image, since QPainter can only be used on one
+ * thread per paint device, and the bands are composited afterwards. Tile
+ * images are only read during rendering, as they were all decoded while
+ * reading the map.
+ */
+QImage TmxRasterizer::renderToImage(const MapRenderer &renderer,
+                                    QSize imageSize,
+                                    qreal xScale, qreal yScale,
+                                    QPoint origin) const
+{
+    if (mUseOpenGL) {
+        QImage image = renderToImageGpu(renderer, imageSize,
+                                        xScale, yScale, origin);
+        if (!image.isNull())
+            return image;
+
+        qWarning("OpenGL rendering unavailable, falling back to software rendering");
+    }
+
+    // Bands below a sensible height only add threading overhead
+    const int minBandHeight = 128;
+    const int maxBands = qMax(1, imageSize.height() / minBandHeight);
+    const int bandCount = mSequentialRendering
+            ? 1 : qMin(QThread::idealThreadCount(), maxBands);
+
+    QImage image(imageSize, QImage::Format_ARGB32);
     image.fill(Qt::transparent);
-    QPainter painter(&image);
 
-    painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
-    painter.setTransform(QTransform::fromScale(xScale, yScale));
+    const int bandHeight = (imageSize.height() + bandCount - 1) / bandCount;
 
-    painter.translate(-mapBoundingRect.left(), -mapBoundingRect.top());
+    auto renderBand = [&] (int bandTop, QImage &target) {
+        QPainter painter(&target);
 
-    drawMapLayers(*renderer, painter);
-    map.reset();
-    return saveImage(imageFileName, image);
+        painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
+
+        QTransform transform;
+        transform.translate(0, -bandTop);
+        transform.scale(xScale, yScale);
+        transform.translate(origin.x(), origin.y());
+        painter.setTransform(transform);
+
+        const QRectF exposed = transform.inverted().mapRect(
+                    QRectF(0, 0, target.width(), target.height()));
+
+        drawMapLayers(renderer, painter, QPoint(), exposed);
+    };
+
+    if (bandCount == 1) {
+        renderBand(0, image);
+        return image;
+    }
+
+    QVector<QImage> bands(bandCount);
+    QSemaphore done;
+
+    for (int i = 0; i < bandCount; ++i) {
+        const int bandTop = i * bandHeight;
+        QImage &band = bands[i];
+        band = QImage(imageSize.width(),
+                      qMin(bandHeight, imageSize.height() - bandTop),
+                      QImage::Format_ARGB32);
+        band.fill(Qt::transparent);
+
+        QThreadPool::globalInstance()->start([&renderBand, &band, &done, bandTop] {
+            renderBand(bandTop, band);
+            done.release();
+        });
+    }
+
+    done.acquire(bandCount);
+
+    QPainter compositor(&image);
+    compositor.setCompositionMode(QPainter::CompositionMode_Source);
+    for (int i = 0; i < bandCount; ++i)
+        compositor.drawImage(0, i * bandHeight, bands.at(i));
+
+    return image;
+}
+
+/**
+ * Renders the map on the GPU, using QPainter's OpenGL paint engine on an
+ * offscreen framebuffer. Tileset images are uploaded as textures on first
+ * use and stay resident in the context for the rest of the run, so the tile
+ * drawing reduces to textured quads and the CPU cost is mostly the final
+ * framebuffer readback.
+ *
+ * Since the framebuffer cannot exceed the GPU's texture size limit, images
+ * larger than that are rendered in framebuffer-sized tiles that are read
+ * back into the result image one by one.
+ *
+ * Returns a null image when no OpenGL context could be created, for example
+ * on a headless machine without GPU drivers, in which case the caller falls
+ * back to software rendering.
+ */
+QImage TmxRasterizer::renderToImageGpu(const MapRenderer &renderer,
+                                       QSize imageSize,
+                                       qreal xScale, qreal yScale,
+                                       QPoint origin) const
+{
+    QOpenGLContext context;
+    if (!context.create())
+        return QImage();
+
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+    if (!surface.isValid() || !context.makeCurrent(&surface))
+        return QImage();
+
+    GLint maxSize = 0;
+    context.functions()->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (maxSize <= 0)
+        return QImage();
+
+    QOpenGLFramebufferObject fbo(qMin(imageSize.width(), static_cast<int>(maxSize)),
+                                 qMin(imageSize.height(), static_cast<int>(maxSize)),
+                                 QOpenGLFramebufferObject::CombinedDepthStencil);
+    if (!fbo.isValid())
+        return QImage();
+
+    QImage image(imageSize, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+
+    QPainter compositor(&image);
+    compositor.setCompositionMode(QPainter::CompositionMode_Source);
+
+    QOpenGLPaintDevice device(fbo.size());
+
+    for (int y = 0; y < imageSize.height(); y += fbo.height()) {
+        for (int x = 0; x < imageSize.width(); x += fbo.width()) {
+            fbo.bind();
+
+            auto gl = context.functions();
+            gl->glClearColor(0, 0, 0, 0);
+            gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+            QPainter painter(&device);
+            painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
+
+            QTransform transform;
+            transform.translate(-x, -y);
+            transform.scale(xScale, yScale);
+            transform.translate(origin.x(), origin.y());
+            painter.setTransform(transform);
+
+            const QRectF exposed = transform.inverted().mapRect(
+                        QRectF(0, 0, fbo.width(), fbo.height()));
+
+            drawMapLayers(renderer, painter, QPoint(), exposed);
+            painter.end();
+
+            const QImage tile = fbo.toImage();
+            compositor.drawImage(x, y, tile, 0, 0,
+                                 qMin(fbo.width(), imageSize.width() - x),
+                                 qMin(fbo.height(), imageSize.height() - y));
+        }
+    }
+
+    compositor.end();
+    fbo.release();
+    context.doneCurrent();
+
+    return image;
 }
 
 
@@ -217,7 +553,7 @@ int TmxRasterizer::renderWorld(const QString &worldFileName,
     }
     QRect worldBoundingRect;
     for (const World::MapEntry &mapEntry : maps) {
-        std::unique_ptr<Map> map { readMap(mapEntry.fileName, &errorString) };
+        std::unique_ptr<Map> map = loadMap(mapEntry.fileName, &errorString);
         if (!map) {
             qWarning("Error while reading \"%s\":\n%s",
                      qUtf8Printable(mapEntry.fileName),
@@ -254,18 +590,44 @@ int TmxRasterizer::renderWorld(const QString &worldFileName,
     painter.translate(-worldBoundingRect.topLeft());
 
     for (const World::MapEntry &mapEntry : maps) {
-        std::unique_ptr<Map> map { readMap(mapEntry.fileName, &errorString) };
+        std::unique_ptr<Map> map = loadMap(mapEntry.fileName, &errorString);
         if (!map) {
             qWarning("Error while reading \"%s\":\n%s",
                     qUtf8Printable(mapEntry.fileName),
                     qUtf8Printable(errorString));
             continue;
         }
-        if (mAdvanceAnimations > 0) 
+        if (mAdvanceAnimations > 0) {
+            QMutexLocker locker(&sMapLoadMutex);
             TilesetManager::instance()->advanceTileAnimations(mAdvanceAnimations);
-        
+        }
+
         const auto renderer = MapRenderer::create(map.get());
-        drawMapLayers(*renderer, painter, mapEntry.rect.topLeft());
+
+        if (mUseOpenGL) {
+            // Render each map separately, so that the framebuffer tiling can
+            // work with the already decoded tilesets of one map at a time
+            // instead of re-reading every map for each framebuffer tile.
+            QRect mapBoundingRect = renderer->mapBoundingRect();
+            map->adjustBoundingRectForOffsetsAndImageLayers(mapBoundingRect);
+
+            const QSize mapImageSize(qCeil(mapBoundingRect.width() * xScale),
+                                     qCeil(mapBoundingRect.height() * yScale));
+            const QImage mapImage = renderToImage(*renderer, mapImageSize,
+                                                  xScale, yScale,
+                                                  -mapBoundingRect.topLeft());
+
+            const QPointF dest((mapBoundingRect.left() + mapEntry.rect.left() - worldBoundingRect.left()) * xScale,
+                               (mapBoundingRect.top() + mapEntry.rect.top() - worldBoundingRect.top()) * yScale);
+
+            painter.save();
+            painter.resetTransform();
+            painter.drawImage(dest, mapImage);
+            painter.restore();
+        } else {
+            drawMapLayers(*renderer, painter, mapEntry.rect.topLeft());
+        }
+
         TilesetManager::instance()->resetTileAnimations();
     }
 
@@ -32,6 +32,8 @@
 
 #include "map.h"
 #include "mapreader.h"
+#include <QImage>
+#include <QRectF>
 #include <QString>
 #include <QStringList>
 
@@ -49,6 +51,7 @@ public:
     int tileSize() const { return mTileSize; }
     int size() const { return mSize; }
     int advanceAnimations() const { return mAdvanceAnimations; }
+    bool useOpenGL() const { return mUseOpenGL; }
     bool useAntiAliasing() const { return mUseAntiAliasing; }
     bool smoothImages() const { return mSmoothImages; }
     bool ignoreVisibility() const { return mIgnoreVisibility; }
@@ -57,6 +60,7 @@ public:
     void setTileSize(int tileSize) { mTileSize = tileSize; }
     void setSize(int size) { mSize = size; }
     void setAdvanceAnimations(int duration) { mAdvanceAnimations = duration; }
+    void setOpenGL(bool useOpenGL) { mUseOpenGL = useOpenGL; }
     void setAntiAliasing(bool useAntiAliasing) { mUseAntiAliasing = useAntiAliasing; }
     void setSmoothImages(bool smoothImages) { mSmoothImages = smoothImages; }
     void setIgnoreVisibility(bool IgnoreVisibility) { mIgnoreVisibility = IgnoreVisibility; }
@@ -67,12 +71,15 @@ public:
     void setLayerTypeVisible(Layer::TypeFlag layerType, bool visible);
 
     int render(const QString &fileName, const QString &imageFileName);
+    int renderBatch(const QString &manifestFileName, int jobCount,
+                    bool pinWorkers);
 
 private:
     qreal mScale = 1.0;
     int mTileSize = 0;
     int mSize = 0;
     int mAdvanceAnimations = 0;
+    bool mUseOpenGL = false;
     bool mUseAntiAliasing = false;
     bool mSmoothImages = true;
     bool mIgnoreVisibility = false;
@@ -80,7 +87,17 @@ private:
     QStringList mLayersToShow;
     int mLayerTypesToShow = Layer::AnyLayerType & ~Layer::GroupLayerType;
 
-    void drawMapLayers(const MapRenderer &renderer, QPainter &painter, QPoint mapOffset = QPoint(0, 0)) const;
+    // Set on batch workers, which get their parallelism from processing
+    // multiple maps rather than from rendering one map in parallel bands
+    bool mSequentialRendering = false;
+
+    void drawMapLayers(const MapRenderer &renderer, QPainter &painter,
+                       QPoint mapOffset = QPoint(0, 0),
+                       const QRectF &exposed = QRectF()) const;
+    QImage renderToImage(const MapRenderer &renderer, QSize imageSize,
+                         qreal xScale, qreal yScale, QPoint origin) const;
+    QImage renderToImageGpu(const MapRenderer &renderer, QSize imageSize,
+                            qreal xScale, qreal yScale, QPoint origin) const;
     int renderMap(const QString &mapFileName, const QString &imageFileName);
     int renderWorld(const QString &worldFileName, const QString &imageFileName);
     int saveImage(const QString &imageFileName, const QImage &image) const;
@@ -0,0 +1,198 @@
+#include "compression.h"
+#include "gidmapper.h"
+#include "grid.h"
+#include "map.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+/**
+ * Benchmarks for the libtiled hot paths: whole-layer cell iteration,
+ * usedTilesets(), region computation, layer data encoding and compression.
+ *
+ * Run with "-iterations N" or let QBENCHMARK pick the iteration count.
+ */
+class benchmark_LibTiled : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void iterateCells();
+    void cellAt();
+    void usedTilesets();
+    void region();
+    void setCells();
+    void gridSet();
+    void gridGet();
+    void encodeLayerData();
+    void decodeLayerData();
+    void compressZlib();
+    void decompressZlib();
+
+private:
+    SharedTileset mTileset;
+    std::unique_ptr<TileLayer> mLayer;
+    QByteArray mEncodedData;
+    QByteArray mCompressedData;
+};
+
+static const int layerSize = 1024;
+
+void benchmark_LibTiled::initTestCase()
+{
+    mTileset = Tileset::create(QStringLiteral("benchmark"), 32, 32);
+    mTileset->loadFromImage(QImage(256, 256, QImage::Format_ARGB32),
+                            QUrl(QStringLiteral("dummy://tileset")));
+
+    mLayer = std::make_unique<TileLayer>(QStringLiteral("benchmark"),
+                                         0, 0, layerSize, layerSize);
+
+    // Fill with a mix of tiles and some gaps, so the scans don't run over
+    // uniform data
+    for (int y = 0; y < layerSize; ++y)
+        for (int x = 0; x < layerSize; ++x)
+            if ((x + y) % 7 != 0)
+                mLayer->setCell(x, y, Cell(mTileset.data(), (x * 31 + y) % 64));
+
+    GidMapper gidMapper;
+    gidMapper.insert(1, mTileset);
+    mEncodedData = gidMapper.encodeLayerData(*mLayer, Map::Base64,
+                                             QRect(0, 0, layerSize, layerSize));
+
+    QByteArray rawData(layerSize * layerSize * 4, Qt::Uninitialized);
+    for (int i = 0; i < rawData.size(); ++i)
+        rawData[i] = char(i * 13);
+    mCompressedData = compress(rawData, Zlib);
+}
+
+void benchmark_LibTiled::iterateCells()
+{
+    QBENCHMARK {
+        int count = 0;
+        for (auto it = mLayer->begin(); it != mLayer->end(); ++it)
+            if (!it->isEmpty())
+                ++count;
+        QVERIFY(count > 0);
+    }
+}
+
+void benchmark_LibTiled::cellAt()
+{
+    QBENCHMARK {
+        int count = 0;
+        for (int y = 0; y < layerSize; ++y)
+            for (int x = 0; x < layerSize; ++x)
+                if (!mLayer->cellAt(x, y).isEmpty())
+                    ++count;
+        QVERIFY(count > 0);
+    }
+}
+
+void benchmark_LibTiled::usedTilesets()
+{
+    QBENCHMARK {
+        // Force a recomputation, since the result is cached
+        mLayer->setCell(0, 0, Cell(mTileset.data(), 0));
+        mLayer->setCell(0, 0, Cell());
+        QCOMPARE(mLayer->usedTilesets().size(), 1);
+    }
+}
+
+void benchmark_LibTiled::region()
+{
+    QBENCHMARK {
+        QVERIFY(!mLayer->region().isEmpty());
+    }
+}
+
+void benchmark_LibTiled::setCells()
+{
+    TileLayer target(QString(), 0, 0, layerSize, layerSize);
+
+    QBENCHMARK {
+        target.setCells(0, 0, mLayer.get());
+    }
+}
+
+static const int gridSize = 256;
+
+void benchmark_LibTiled::gridSet()
+{
+    QBENCHMARK {
+        Grid<int> grid;
+        for (int y = 0; y < gridSize; ++y)
+            for (int x = 0; x < gridSize; ++x)
+                grid.set(x, y, x * 31 + y);
+        QVERIFY(!grid.isEmpty());
+    }
+}
+
+void benchmark_LibTiled::gridGet()
+{
+    Grid<int> grid;
+    for (int y = 0; y < gridSize; ++y)
+        for (int x = 0; x < gridSize; ++x)
+            grid.set(x, y, x * 31 + y);
+
+    QBENCHMARK {
+        int sum = 0;
+        for (int y = 0; y < gridSize; ++y)
+            for (int x = 0; x < gridSize; ++x)
+                sum += grid.get(x, y);
+        QVERIFY(sum > 0);
+    }
+}
+
+void benchmark_LibTiled::encodeLayerData()
+{
+    GidMapper gidMapper;
+    gidMapper.insert(1, mTileset);
+
+    QBENCHMARK {
+        const QByteArray data =
+                gidMapper.encodeLayerData(*mLayer, Map::Base64,
+                                          QRect(0, 0, layerSize, layerSize));
+        QVERIFY(!data.isEmpty());
+    }
+}
+
+void benchmark_LibTiled::decodeLayerData()
+{
+    GidMapper gidMapper;
+    gidMapper.insert(1, mTileset);
+
+    TileLayer target(QString(), 0, 0, layerSize, layerSize);
+
+    QBENCHMARK {
+        const auto error = gidMapper.decodeLayerData(target, mEncodedData,
+                                                     Map::Base64,
+                                                     QRect(0, 0, layerSize, layerSize));
+        QCOMPARE(error, GidMapper::NoError);
+    }
+}
+
+void benchmark_LibTiled::compressZlib()
+{
+    QByteArray rawData(layerSize * layerSize * 4, Qt::Uninitialized);
+    for (int i = 0; i < rawData.size(); ++i)
+        rawData[i] = char(i * 13);
+
+    QBENCHMARK {
+        QVERIFY(!compress(rawData, Zlib).isEmpty());
+    }
+}
+
+void benchmark_LibTiled::decompressZlib()
+{
+    QBENCHMARK {
+        QVERIFY(!decompress(mCompressedData, layerSize * layerSize * 4).isEmpty());
+    }
+}
+
+QTEST_MAIN(benchmark_LibTiled)
+#include "benchmark_libtiled.moc"